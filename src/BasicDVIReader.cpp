@@ -20,20 +20,42 @@
 
 #include <algorithm>
 #include "BasicDVIReader.hpp"
+#include "SignalHandler.hpp"
 
 using namespace std;
 
 
 BasicDVIReader::BasicDVIReader (std::istream &is) : StreamReader(is), _dviVersion(DVI_NONE)
 {
+	buildOpcodeTable();
 }
 
 
 /** Evaluates the next DVI command, and computes the corresponding handler.
+ *  The handlers and parameters of all opcodes are precomputed in a flat
+ *  dispatch table, so processing a command just requires a single table lookup.
  *  @param[out] handler handler for current DVI command
  *  @param[out] param the handler must be called with this parameter
  *  @return opcode of current DVI command */
 int BasicDVIReader::evalCommand (CommandHandler &handler, int &param) {
+	SignalHandler::instance().check();
+	const int opcode = readByte();
+	if (!isStreamValid() || opcode < 0)  // at end of file
+		throw DVIPrematureEOFException();
+	const OpcodeEntry &entry = _opcodeTable[opcode];
+	if (!entry.handler)
+		throw DVIException("undefined DVI command (opcode " + to_string(opcode) + ")");
+	handler = entry.handler;
+	param = entry.param;
+	return opcode;
+}
+
+
+/** Creates the flat dispatch table that maps each of the 256 opcodes to its
+ *  command handler and the parameter the handler must be called with. Since
+ *  some opcodes are only defined for certain DVI versions, the table is
+ *  rebuilt whenever the version of the file being processed changes. */
+void BasicDVIReader::buildOpcodeTable () {
 	struct DVICommand {
 		CommandHandler handler;
 		int length;  // number of parameter bytes
@@ -79,36 +101,31 @@ int BasicDVIReader::evalCommand (CommandHandler &handler, int &param) {
 		{&BasicDVIReader::cmdPostPost, 0},                                    // 249
 	};
 
-	const int opcode = readByte();
-	if (!isStreamValid() || opcode < 0)  // at end of file
-		throw DVIPrematureEOFException();
-
-	int num_param_bytes = 0;
-	param = -1;
-	if (opcode >= OP_SETCHAR0 && opcode <= OP_SETCHAR127) {
-		handler = &BasicDVIReader::cmdSetChar0;
-		param = opcode;
-	}
-	else if (opcode >= OP_FNTNUM0 && opcode <= OP_FNTNUM63) {
-		handler = &BasicDVIReader::cmdFontNum0;
-		param = opcode-OP_FNTNUM0;
-	}
-	else if (evalXDVOpcode(opcode, handler))
-		num_param_bytes = 0;
-	else if (_dviVersion == DVI_PTEX && opcode == OP_DIR) {  // direction command set by pTeX?
-		handler = &BasicDVIReader::cmdDir;
-		num_param_bytes = 1;
-	}
-	else if (opcode > OP_POSTPOST)
-		throw DVIException("undefined DVI command (opcode " + to_string(opcode) + ")");
-	else {
-		const int offset = opcode < OP_FNTNUM0 ? OP_SET1 : (OP_FNTNUM63+1)-(OP_FNTNUM0-OP_SET1);
-		handler = commands[opcode-offset].handler;
-		num_param_bytes = commands[opcode-offset].length;
+	for (int opcode=0; opcode < 256; opcode++) {
+		OpcodeEntry &entry = _opcodeTable[opcode];
+		entry.handler = nullptr;
+		entry.param = 0;
+		if (opcode >= OP_SETCHAR0 && opcode <= OP_SETCHAR127) {
+			entry.handler = &BasicDVIReader::cmdSetChar0;
+			entry.param = opcode;
+		}
+		else if (opcode >= OP_FNTNUM0 && opcode <= OP_FNTNUM63) {
+			entry.handler = &BasicDVIReader::cmdFontNum0;
+			entry.param = opcode-OP_FNTNUM0;
+		}
+		else if (evalXDVOpcode(opcode, entry.handler))
+			entry.param = 0;
+		else if (_dviVersion == DVI_PTEX && opcode == OP_DIR) {  // direction command set by pTeX?
+			entry.handler = &BasicDVIReader::cmdDir;
+			entry.param = 1;
+		}
+		else if (opcode <= OP_POSTPOST) {
+			const int offset = opcode < OP_FNTNUM0 ? OP_SET1 : (OP_FNTNUM63+1)-(OP_FNTNUM0-OP_SET1);
+			entry.handler = commands[opcode-offset].handler;
+			entry.param = commands[opcode-offset].length;
+		}
 	}
-	if (param < 0)
-		param = num_param_bytes;
-	return opcode;
+	_tableVersion = _dviVersion;
 }
 
 
@@ -221,7 +238,13 @@ void BasicDVIReader::executeFontDefs () {
 }
 
 
-/** Collects and records the file offsets of all bop commands. */
+/** Collects and records the file offsets of all bop commands. Instead of
+ *  scanning the DVI byte stream command by command, the offsets are gathered
+ *  by following the chain of previous-bop pointers starting at the postamble,
+ *  so only the postamble and the bop headers are touched. This way, the page
+ *  index of a large DVI file is available after O(pages) small reads, and
+ *  converting a page near the end of the file doesn't require reading the
+ *  pages before it. */
 vector<uint32_t> BasicDVIReader::collectBopOffsets () {
 	std::vector<uint32_t> bopOffsets;
 	goToPostamble();
@@ -264,6 +287,8 @@ void BasicDVIReader::setDVIVersion (DVIVersion version) {
 		default:
 			throw DVIException("DVI version " + to_string(_dviVersion) + " not supported");
 	}
+	if (_dviVersion != _tableVersion)  // opcode table still built for a different DVI version?
+		buildOpcodeTable();
 }
 
 /////////////////////////////////////
@@ -114,7 +114,16 @@ class BasicDVIReader : public StreamReader {
 		virtual void cmdXTextAndGlyphs (int len); // XDV version 7 only
 
 	private:
-		DVIVersion _dviVersion;  ///< DVI version of file being processed
+		void buildOpcodeTable ();
+
+		/** A single entry of the flat opcode dispatch table. */
+		struct OpcodeEntry {
+			CommandHandler handler;  ///< handler that processes the command (nullptr if opcode is undefined)
+			int param;               ///< parameter the handler must be called with
+		};
+		DVIVersion _dviVersion;            ///< DVI version of file being processed
+		DVIVersion _tableVersion=DVI_NONE; ///< DVI version the opcode table was built for
+		OpcodeEntry _opcodeTable[256];     ///< maps each opcode to its handler and parameter
 };
 
 #endif
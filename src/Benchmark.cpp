@@ -0,0 +1,247 @@
+/*************************************************************************
+** Benchmark.cpp                                                        **
+**                                                                      **
+** This file is part of dvisvgm -- a fast DVI to SVG converter          **
+** Copyright (C) 2005-2024 Martin Gieseking <martin.gieseking@uos.de>   **
+**                                                                      **
+** This program is free software; you can redistribute it and/or        **
+** modify it under the terms of the GNU General Public License as       **
+** published by the Free Software Foundation; either version 3 of       **
+** the License, or (at your option) any later version.                  **
+**                                                                      **
+** This program is distributed in the hope that it will be useful, but  **
+** WITHOUT ANY WARRANTY; without even the implied warranty of           **
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the         **
+** GNU General Public License for more details.                         **
+**                                                                      **
+** You should have received a copy of the GNU General Public License    **
+** along with this program; if not, see <http://www.gnu.org/licenses/>. **
+*************************************************************************/
+
+#include <iomanip>
+#include <sstream>
+#include <streambuf>
+#include <utility>
+#include "Benchmark.hpp"
+#include "DVIActions.hpp"
+#include "DVIToSVG.hpp"
+#include "StreamWriter.hpp"
+#include "SVGOutput.hpp"
+#include "System.hpp"
+#include "utility.hpp"
+
+using namespace std;
+
+
+/** Output target that discards the generated SVG data but counts its size. */
+class BitBucketSVGOutput : public SVGOutputBase {
+	class CountingStreamBuffer : public streambuf {
+		public:
+			size_t count () const {return _count;}
+
+		protected:
+			int_type overflow (int_type c) override {
+				if (c != traits_type::eof())
+					_count++;
+				return c;
+			}
+
+			streamsize xsputn (const char*, streamsize n) override {
+				_count += size_t(n);
+				return n;
+			}
+
+		private:
+			size_t _count=0;
+	};
+
+	public:
+		ostream& getPageStream (int, int, const HashTriple&) const override {return _os;}
+		FilePath filepath (int, int, const HashTriple&) const override {return FilePath("benchmark.svg");}
+		void finish () override {}
+		size_t bytes () const {return _buffer.count();}
+
+	private:
+		mutable CountingStreamBuffer _buffer;
+		mutable ostream _os{&_buffer};
+};
+
+
+/** Parses a comma-separated list of benchmark parameters of the form
+ *  "key=value", e.g. "pages=100,glyphs=500,segments=50". Unknown keys and
+ *  negative values are rejected; omitted keys keep their default values.
+ *  @param[in] str parameter string to parse
+ *  @param[out] params the resulting benchmark parameters
+ *  @return true if the string could be parsed successfully */
+bool Benchmark::parseParameters (const string &str, Parameters &params) {
+	for (const string &entry : util::split(str, ",")) {
+		auto pos = entry.find('=');
+		if (pos == string::npos || pos == 0)
+			return false;
+		string key = entry.substr(0, pos);
+		int value;
+		try {
+			value = stoi(entry.substr(pos+1));
+		}
+		catch (exception&) {
+			return false;
+		}
+		if (value < 0)
+			return false;
+		if (key == "pages")
+			params.pages = unsigned(value);
+		else if (key == "glyphs")
+			params.glyphs = unsigned(value);
+		else if (key == "specials")
+			params.specials = unsigned(value);
+		else if (key == "segments")
+			params.segments = unsigned(value);
+		else if (key == "shadings")
+			params.shadings = unsigned(value);
+		else
+			return false;
+	}
+	return params.pages > 0;
+}
+
+
+/** Creates a synthetic DVI file matching the benchmark parameters. The file
+ *  consists of the requested number of pages, each typesetting the given
+ *  number of cmr10 glyphs and carrying raw path specials and shading patch
+ *  specials of parameterized complexity. The coordinates are generated by a
+ *  fixed linear congruential sequence, so the same parameters always produce
+ *  the identical workload.
+ *  @return the DVI data as a byte string */
+string Benchmark::createDVI () const {
+	ostringstream oss;
+	StreamWriter writer(oss);
+	uint32_t rng=1;
+	auto next_coord = [&rng]() {
+		rng = rng*1664525+1013904223;
+		return int(rng % 1000);
+	};
+	auto write_fontdef = [&writer]() {
+		const string fontname = "cmr10";
+		writer.writeUnsigned(243, 1);       // fnt_def1
+		writer.writeUnsigned(0, 1);         // font number
+		writer.writeUnsigned(0, 4);         // checksum (0 = don't verify)
+		writer.writeUnsigned(10*65536, 4);  // scale factor (10pt)
+		writer.writeUnsigned(10*65536, 4);  // design size (10pt)
+		writer.writeUnsigned(0, 1);         // length of area path
+		writer.writeUnsigned(5, 1);         // length of font name
+		writer.writeString(fontname);
+	};
+	auto write_special = [&writer](const string &text) {
+		if (text.length() < 256) {
+			writer.writeUnsigned(239, 1);    // xxx1
+			writer.writeUnsigned(uint32_t(text.length()), 1);
+		}
+		else {
+			writer.writeUnsigned(242, 1);    // xxx4
+			writer.writeUnsigned(uint32_t(text.length()), 4);
+		}
+		writer.writeString(text);
+	};
+	// preamble
+	const string comment = "dvisvgm benchmark";
+	writer.writeUnsigned(247, 1);          // pre
+	writer.writeUnsigned(2, 1);            // DVI version
+	writer.writeUnsigned(25400000, 4);     // numerator
+	writer.writeUnsigned(473628672, 4);    // denominator
+	writer.writeUnsigned(1000, 4);         // magnification
+	writer.writeUnsigned(uint32_t(comment.length()), 1);
+	writer.writeString(comment);
+	// pages
+	int32_t prevBopOffset = -1;
+	for (unsigned page=1; page <= _params.pages; page++) {
+		auto bopOffset = int32_t(oss.tellp());
+		writer.writeUnsigned(139, 1);       // bop
+		writer.writeSigned(int32_t(page), 4);  // \count0 = page number
+		writer.writeBytes(0, 36);           // \count1 ... \count9
+		writer.writeSigned(prevBopOffset, 4);
+		prevBopOffset = bopOffset;
+		if (_params.glyphs > 0) {
+			if (page == 1)
+				write_fontdef();
+			writer.writeUnsigned(171, 1);    // fnt_num_0
+			// typeset the glyphs in lines of 60 characters each
+			for (unsigned i=0; i < _params.glyphs; i++) {
+				if (i % 60 == 0) {
+					if (i > 0)
+						writer.writeUnsigned(142, 1);  // pop
+					writer.writeUnsigned(160, 1);     // down4
+					writer.writeSigned(12*65536, 4);  // baseline skip of 12pt
+					writer.writeUnsigned(141, 1);     // push
+				}
+				writer.writeUnsigned(33+(i%94), 1);  // set_char
+			}
+			writer.writeUnsigned(142, 1);    // pop
+		}
+		for (unsigned i=0; i < _params.specials; i++) {
+			string pathdata = "M0 0";
+			for (unsigned j=0; j < _params.segments; j++) {
+				pathdata += 'L';
+				pathdata += to_string(next_coord())+" "+to_string(next_coord());
+			}
+			write_special("dvisvgm:raw <path d='"+pathdata+"' fill='none' stroke='black'/>");
+		}
+		for (unsigned i=0; i < _params.shadings; i++) {
+			// free-form triangle patch (PS shading type 4) with random vertices
+			string ps = "ps: << /ShadingType 4 /ColorSpace /DeviceRGB /DataSource [";
+			const char *colors[3] = {"1 0 0", "0 1 0", "0 0 1"};
+			for (int vertex=0; vertex < 3; vertex++)
+				ps += "0 "+to_string(next_coord())+" "+to_string(next_coord())+" "+colors[vertex]+" ";
+			ps += "] >> shfill";
+			write_special(ps);
+		}
+		writer.writeUnsigned(140, 1);       // eop
+	}
+	// postamble
+	auto postOffset = int32_t(oss.tellp());
+	writer.writeUnsigned(248, 1);          // post
+	writer.writeSigned(prevBopOffset, 4);  // pointer to final bop
+	writer.writeUnsigned(25400000, 4);     // numerator
+	writer.writeUnsigned(473628672, 4);    // denominator
+	writer.writeUnsigned(1000, 4);         // magnification
+	writer.writeUnsigned(0, 4);            // height+depth of tallest page
+	writer.writeUnsigned(0, 4);            // width of widest page
+	writer.writeUnsigned(2, 2);            // maximum stack depth
+	writer.writeUnsigned(_params.pages, 2);  // number of pages
+	if (_params.glyphs > 0)
+		write_fontdef();
+	writer.writeUnsigned(249, 1);          // post_post
+	writer.writeSigned(postOffset, 4);     // pointer to post
+	writer.writeUnsigned(2, 1);            // DVI version
+	writer.writeBytes(223, 4);             // at least four padding bytes,
+	while (size_t(oss.tellp()) % 4 != 0)   // file size must be a multiple of 4
+		writer.writeUnsigned(223, 1);
+	return oss.str();
+}
+
+
+/** Synthesizes the DVI workload and converts all of its pages through the
+ *  regular pipeline. The generated SVG data is discarded but its size is
+ *  counted. Afterwards, the workload composition and the resulting throughput
+ *  are written as tab-separated name/value lines.
+ *  @param[in] os stream the benchmark report is written to */
+void Benchmark::run (ostream &os) const {
+	string dvi = createDVI();
+	istringstream iss(dvi);
+	BitBucketSVGOutput out;
+	DVIToSVG dvi2svg(iss, out);
+	dvi2svg.setProcessSpecials(nullptr, true);
+	double startTime = System::time();
+	pair<int,int> pageinfo;
+	dvi2svg.convert("1-", &pageinfo);
+	double seconds = System::time()-startTime;
+	ios::fmtflags osflags(os.flags());
+	os << fixed << setprecision(6);
+	os << "pages\t" << _params.pages << '\n';
+	os << "glyphs\t" << _params.pages*_params.glyphs << '\n';
+	os << "specials\t" << _params.pages*(_params.specials+_params.shadings) << '\n';
+	os << "dvibytes\t" << dvi.length() << '\n';
+	os << "svgbytes\t" << out.bytes() << '\n';
+	os << "seconds\t" << seconds << '\n';
+	os << "pagespersecond\t" << (seconds > 0 ? _params.pages/seconds : 0) << '\n';
+	os.flags(osflags);
+}
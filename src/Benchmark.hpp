@@ -0,0 +1,55 @@
+/*************************************************************************
+** Benchmark.hpp                                                        **
+**                                                                      **
+** This file is part of dvisvgm -- a fast DVI to SVG converter          **
+** Copyright (C) 2005-2024 Martin Gieseking <martin.gieseking@uos.de>   **
+**                                                                      **
+** This program is free software; you can redistribute it and/or        **
+** modify it under the terms of the GNU General Public License as       **
+** published by the Free Software Foundation; either version 3 of       **
+** the License, or (at your option) any later version.                  **
+**                                                                      **
+** This program is distributed in the hope that it will be useful, but  **
+** WITHOUT ANY WARRANTY; without even the implied warranty of           **
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the         **
+** GNU General Public License for more details.                         **
+**                                                                      **
+** You should have received a copy of the GNU General Public License    **
+** along with this program; if not, see <http://www.gnu.org/licenses/>. **
+*************************************************************************/
+
+#ifndef BENCHMARK_HPP
+#define BENCHMARK_HPP
+
+#include <ostream>
+#include <string>
+
+/** Synthesizes a parameterized DVI workload in memory and converts it through
+ *  the regular processing pipeline. The benchmark allows to reproduce and
+ *  report performance characteristics without access to the original (and
+ *  possibly confidential) documents: a workload is fully described by a small
+ *  set of numbers, like the page count or the number of path segments per
+ *  special. */
+class Benchmark {
+	public:
+		/** Parameters describing the composition of the synthetic workload. */
+		struct Parameters {
+			unsigned pages=10;     ///< number of pages to synthesize
+			unsigned glyphs=100;   ///< number of glyphs typeset per page
+			unsigned specials=10;  ///< number of raw path specials per page
+			unsigned segments=100; ///< number of path segments per raw special
+			unsigned shadings=0;   ///< number of shading patch specials per page
+		};
+
+		explicit Benchmark (const Parameters &params) : _params(params) {}
+		void run (std::ostream &os) const;
+
+		static bool parseParameters (const std::string &str, Parameters &params);
+
+	private:
+		std::string createDVI () const;
+
+		Parameters _params;
+};
+
+#endif
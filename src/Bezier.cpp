@@ -159,11 +159,32 @@ void CubicBezier::subdivide (double t, CubicBezier *bezier1, CubicBezier *bezier
 }
 
 
+/** Returns true if the curve deviates from the line through its end points
+ *  by delta at most. The deviation is bounded by the distance of the inner
+ *  control points from that line: the curve is flat enough if
+ *  \f$\max(|3p_1-2p_0-p_3|^2_x, |3p_2-p_0-2p_3|^2_x)
+ *  + \max(|3p_1-2p_0-p_3|^2_y, |3p_2-p_0-2p_3|^2_y) \le 16\delta^2\f$.
+ *  In contrast to comparing the lengths of the control polygon and the chord,
+ *  this criterion gets by without square roots. */
+bool CubicBezier::isFlat (double delta) const {
+	double ux = 3.0*_points[1].x() - 2.0*_points[0].x() - _points[3].x();
+	double uy = 3.0*_points[1].y() - 2.0*_points[0].y() - _points[3].y();
+	double vx = 3.0*_points[2].x() - _points[0].x() - 2.0*_points[3].x();
+	double vy = 3.0*_points[2].y() - _points[0].y() - 2.0*_points[3].y();
+	ux *= ux;
+	uy *= uy;
+	vx *= vx;
+	vy *= vy;
+	return max(ux, vx) + max(uy, vy) <= 16.0*delta*delta;
+}
+
+
 /** Approximates the current Bézier curve by a sequence of line segments.
- *  This is done by subdividing the curve several times using De Casteljau's algorithm.
- *  If a sub-curve is almost flat, i.e. \f$\sum\limits_{k=0}^2 |p_{k+1}-p_k| - |p_3-p_0| < \delta\f$,
- *  the curve is not further subdivided.
- *  @param[in] delta threshold where to stop further subdivisions (see description above)
+ *  This is done by adaptively subdividing the curve using De Casteljau's algorithm
+ *  until each sub-curve deviates from its chord by less than delta. Thus, nearly
+ *  straight (sections of) curves produce only few points while strongly bent ones
+ *  are refined further.
+ *  @param[in] delta maximum allowed distance of the line segments from the curve
  *  @param[out] p the resulting sequence of points defining the start/end points of the line segments
  *  @param[out] t corresponding curve parameters of the approximated points p: \f$ b(t_i)=p_i \f$
  *  @return number of points in vector p */
@@ -176,23 +197,32 @@ int CubicBezier::approximate (double delta, std::vector<DPair> &p, vector<double
 
 
 int CubicBezier::approximate (double delta, double t0, double t1, vector<DPair> &p, vector<double> *t) const {
-	// compute distance of adjacent control points
-	const double l01 = (_points[1]-_points[0]).length();
-	const double l12 = (_points[2]-_points[1]).length();
-	const double l23 = (_points[3]-_points[2]).length();
-	const double l03 = (_points[3]-_points[0]).length();
-	if (l01+l12+l23-l03 < delta) { // is curve flat enough?
-		p.push_back(_points[3]);    // => store endpoint
-		if (t)
-			t->push_back(t1);
-	}
-	else {
-		// subdivide curve at b(0.5) and approximate the resulting parts separately
-		CubicBezier b1, b2;
-		subdivide(0.5, &b1, &b2);
-		double tmid = (t0+t1)/2;
-		b1.approximate(delta, t0, tmid, p, t);
-		b2.approximate(delta, tmid, t1, p, t);
+	struct Segment {
+		CubicBezier bezier;
+		double t0, t1;
+	};
+	// replace the former recursion by an explicit stack to avoid the
+	// call overhead of two recursive descents per subdivision
+	vector<Segment> stack;
+	stack.push_back({*this, t0, t1});
+	while (!stack.empty()) {
+		Segment segment = stack.back();
+		stack.pop_back();
+		// stop subdividing if the sub-curve is flat enough or covers a tiny parameter
+		// range only (the latter prevents infinite loops on degenerate curves)
+		if (segment.bezier.isFlat(delta) || segment.t1-segment.t0 < 1e-6) {
+			p.push_back(segment.bezier._points[3]);  // => store endpoint
+			if (t)
+				t->push_back(segment.t1);
+		}
+		else {
+			// subdivide curve at b(0.5) and approximate the resulting parts separately
+			CubicBezier b1, b2;
+			segment.bezier.subdivide(0.5, &b1, &b2);
+			double tmid = (segment.t0+segment.t1)/2;
+			stack.push_back({b2, tmid, segment.t1});  // processed after b1
+			stack.push_back({b1, segment.t0, tmid});
+		}
 	}
 	return static_cast<int>(p.size());
 }
@@ -63,6 +63,7 @@ class CubicBezier {
 		BoundingBox getBBox () const;
 
 	protected:
+		bool isFlat (double delta) const;
 		int approximate (double delta, double t0, double t1, std::vector<DPair> &p, std::vector<double> *t) const;
 		void toQuadBeziers (double t0, double t1, double precision, std::vector<QuadBezier> &qbeziers, std::vector<double> *startParams) const;
 		QuadBezier midpointApproximation () const;
@@ -53,6 +53,13 @@ void BgColorSpecialHandler::dviBeginPage (unsigned pageno, SpecialActions &actio
 	// See the documentation of the color package, section 3.5.
 	if (_pageColors.empty())
 		return;
+	if (_pageColors.size() == 1) {
+		// preprocess() drops repetitions of the same color, so a single background
+		// color set for the whole document is represented by just one entry
+		if (_pageColors.front().first <= pageno)
+			actions.setBgColor(_pageColors.front().second);
+		return;
+	}
 	// find number of page with bg color change not lower than the current one
 	auto it = lower_bound(_pageColors.begin(), _pageColors.end(), PageColor(pageno, Color::BLACK));
 	if (it != _pageColors.end() && it->first == pageno)
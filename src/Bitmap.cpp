@@ -42,30 +42,34 @@ void Bitmap::resize (int minx, int maxx, int miny , int maxy) {
 	_cols = abs(maxx-minx)+1;
 	_xshift = minx;
 	_yshift = miny;
-	_bpr  = _cols/8 + (_cols % 8 ? 1 : 0);  // bytes per row
-	_bytes.resize(_rows*_bpr);
-	std::fill(_bytes.begin(), _bytes.end(), 0);
+	_wpr  = _cols/64 + (_cols % 64 ? 1 : 0);  // 64-bit words per row
+	_words.assign(_rows*_wpr, 0);
 }
 
 
-/** Sets n pixels of row r to 1 starting at pixel c.
+/** Sets n pixels of row r to 1 starting at pixel c. Pixels outside the
+ *  bitmap area are clipped. Since a row is stored as a sequence of 64-bit
+ *  words, even long runs require only a few mask operations.
  *  @param[in] row number of row
  *  @param[in] col number of column (pixel)
  *  @param[in] n number of bits to be set */
 void Bitmap::setBits (int row, int col, int n) {
 	row -= _yshift;
 	col -= _xshift;
-	uint8_t *byte = &_bytes[row*_bpr + col/8];
-	if (byte < &_bytes[0])
+	if (row < 0 || row >= _rows)
 		return;
-	const uint8_t *maxptr = &_bytes[0]+_bytes.size()-1;
-	while (n > 0 && byte <= maxptr) {
-		int b = 7 - col%8;          // number of leftmost bit in current byte to be set
-		int m = min(n, b+1);        // number of bits to be set in current byte
-		int bitseq = (1 << m)-1;    // sequence of n set bits (bits 0..n-1 are set)
-		bitseq <<= b-m+1;           // move bit sequence so that bit b is the leftmost set bit
-		*byte |= uint8_t(bitseq);   // apply bit sequence to current byte
-		byte++;
+	if (col < 0) {  // clip run at the left border
+		n += col;
+		col = 0;
+	}
+	n = min(n, _cols-col);  // clip run at the right border
+	uint64_t *word = &_words[row*_wpr + col/64];
+	while (n > 0) {
+		int b = 63 - col%64;  // number of leftmost bit in current word to be set
+		int m = min(n, b+1);  // number of bits to be set in current word
+		// m set bits, the leftmost of them moved to bit position b
+		uint64_t mask = (~uint64_t(0) << (64-m)) >> (63-b);
+		*word++ |= mask;
 		n -= m;
 		col += m;
 	}
@@ -74,56 +78,65 @@ void Bitmap::setBits (int row, int col, int n) {
 
 void Bitmap::forAllPixels (Callback &data) const {
 	for (int row=0; row < _rows ; row++) {
-		for (int col=0; col < _bpr; col++) {
-			uint8_t byte = _bytes[row*_bpr+col];
-			int x;
-			for (int b=7; (b >= 0) && ((x = 8*col+(7-b)) < _cols); b--)
-				data.pixel(x, row, bool(byte & (1 << b)), *this);
-		}
+		const uint64_t *words = &_words[row*_wpr];
+		for (int col=0; col < _cols; col++)
+			data.pixel(col, row, bool(words[col/64] & (uint64_t(1) << (63-col%64))), *this);
 	}
 	data.finish();
 }
 
 
-class BBoxCallback : public Bitmap::Callback {
-	public:
-		int minx () const   {return _minx;}
-		int miny () const   {return _miny;}
-		int maxx () const   {return _maxx;}
-		int maxy () const   {return _maxy;}
-		bool empty () const {return !_changed;}
-
-		void pixel (int x, int y, bool set, const Bitmap&) override {
-			if (set) {
-				_minx = min(_minx, x);
-				_miny = min(_miny, y);
-				_maxx = max(_maxx, x);
-				_maxy = max(_maxy, y);
-				_changed = true;
-			}
+/** Returns the number of leading zero bits of a 64-bit word (64 if none is set). */
+static int count_leading_zeros (uint64_t word) {
+	if (word == 0)
+		return 64;
+	int n = 0;
+	for (int shift = 32; shift > 0; shift /= 2) {
+		if ((word >> (64-shift)) == 0) {
+			n += shift;
+			word <<= shift;
 		}
+	}
+	return n;
+}
 
-		void finish () override {
-			if (empty())
-				_minx = _miny = 0;
-		}
 
-	private:
-		bool _changed = false;
-		int _minx = numeric_limits<int>::max(), _miny=_minx;
-		int _maxx = 0, _maxy = 0;
-};
+/** Returns the number of trailing zero bits of a 64-bit word (64 if none is set). */
+static int count_trailing_zeros (uint64_t word) {
+	if (word == 0)
+		return 64;
+	int n = 0;
+	for (int shift = 32; shift > 0; shift /= 2) {
+		if ((word << (64-shift)) == 0) {
+			n += shift;
+			word >>= shift;
+		}
+	}
+	return n;
+}
 
 
-/** Computes the bounding box that spans all set pixels. */
+/** Computes the bounding box that spans all set pixels. Entirely white
+ *  64-pixel blocks are skipped with a single word comparison. */
 bool Bitmap::getBBox (int &minx, int &miny, int &maxx, int &maxy) const {
-	BBoxCallback bboxCallback;
-	forAllPixels(bboxCallback);
-	minx = bboxCallback.minx();
-	miny = bboxCallback.miny();
-	maxx = bboxCallback.maxx();
-	maxy = bboxCallback.maxy();
-	return !bboxCallback.empty();
+	minx = miny = numeric_limits<int>::max();
+	maxx = maxy = 0;
+	bool changed = false;
+	for (int row=0; row < _rows; row++) {
+		const uint64_t *words = &_words[row*_wpr];
+		for (int w=0; w < _wpr; w++) {
+			if (words[w] == 0)
+				continue;
+			changed = true;
+			miny = min(miny, row);
+			maxy = row;
+			minx = min(minx, 64*w + count_leading_zeros(words[w]));
+			maxx = max(maxx, 64*w + 63 - count_trailing_zeros(words[w]));
+		}
+	}
+	if (!changed)
+		minx = miny = 0;
+	return changed;
 }
 
 
@@ -137,19 +150,3 @@ void Bitmap::getExtent (int &w, int &h) const {
 	else
 		w = h = 0;
 }
-
-
-#if 0
-ostream& Bitmap::write (ostream &os) const {
-	for (int r=_rows-1; r >= 0 ; r--) {
-		for (int c=0; c < _bpr; c++) {
-			uint8_t byte = _bytes[r*_bpr+c];
-			for (int b=128; b; b>>=1)
-				os << (byte & b ? '*' : '-');
-			os << ' ';
-		}
-		os << endl;
-	}
-	return os;
-}
-#endif
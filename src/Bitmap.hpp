@@ -40,13 +40,12 @@ class Bitmap {
 		Bitmap (int minx, int maxx, int miny , int maxy);
 		void resize (int minx, int maxx, int miny , int maxy);
 		void setBits(int row, int col, int n);
-		const uint8_t* rowPtr (int row) const {return &_bytes[row*_bpr];}
 		int height () const                   {return _rows;}
 		int width () const                    {return _cols;}
 		int xshift () const                   {return _xshift;}
 		int yshift () const                   {return _yshift;}
-		int bytesPerRow () const              {return _bpr;}
-		bool empty () const                   {return (!_rows && !_cols) || _bytes.empty();}
+		int bytesPerRow () const              {return _cols/8 + (_cols%8 ? 1 : 0);}
+		bool empty () const                   {return (!_rows && !_cols) || _words.empty();}
 		bool getBBox (int &minx, int &miny, int &maxx, int &maxy) const;
 		void getExtent (int &w, int &h) const;
 		void forAllPixels (Callback &callback) const;
@@ -54,16 +53,21 @@ class Bitmap {
 		template <typename T>
 		int copy (std::vector<T> &target, bool vflip=false) const;
 
-//		template <typename T>
-//		void write (std::ostream &os, const std::vector<T> &v) const;
-
-//		std::ostream& write (std::ostream &os) const;
+	protected:
+		/** Returns byte b of a row, with byte 0 containing the leftmost eight
+		 *  pixels of the row and the MSB denoting the leftmost pixel of a byte. */
+		uint8_t byteAt (int row, int b) const {
+			return uint8_t(_words[row*_wpr + b/8] >> (56 - 8*(b%8)));
+		}
 
 	private:
 		int _rows=0, _cols=0;     ///< number of rows, columns
 		int _xshift=0, _yshift=0; ///< horizontal/vertical shift
-		int _bpr=0;               ///< number of bytes per row
-		std::vector<uint8_t> _bytes;
+		int _wpr=0;               ///< number of 64-bit words per row
+		/** Pixel data as a sequence of _wpr 64-bit words per row. The MSB of a
+		 *  word denotes the leftmost pixel of its 64-pixel block, so that runs of
+		 *  pixels can be set and scanned with a few word operations. */
+		std::vector<uint64_t> _words;
 };
 
 
@@ -75,13 +79,14 @@ class Bitmap {
 template <typename T>
 int Bitmap::copy (std::vector<T> &target, bool vflip) const {
 	const int s = sizeof(T);
-	const int tpr = _bpr/s + (_bpr%s ? 1 : 0); // number of Ts per row
+	const int bpr = bytesPerRow();
+	const int tpr = bpr/s + (bpr%s ? 1 : 0); // number of Ts per row
 	target.resize(_rows*tpr);
 	for (int r=0; r < _rows; r++) {
 		int targetrow = vflip ? _rows-r-1 : r;
-		for (int b=0; b < _bpr; b++) {
+		for (int b=0; b < bpr; b++) {
 			T &t = target[targetrow*tpr + b/s];
-			T chunk = static_cast<T>(_bytes[r*_bpr+b]) << (8*(s-1-b%s));
+			T chunk = static_cast<T>(byteAt(r, b)) << (8*(s-1-b%s));
 			if (b % s == 0)
 				t = chunk;
 			else
@@ -91,20 +96,4 @@ int Bitmap::copy (std::vector<T> &target, bool vflip) const {
 	return tpr;
 }
 
-
-/*
-template <typename T>
-void Bitmap::write (std::ostream &os, const std::vector<T> &v) const {
-	const int s = sizeof(T);
-	const int tpr = _bpr/s + (_bpr%s ? 1 : 0); // number of Ts per row
-	for (int r=_rows-1; r >= 0; r--) {
-		for (int t=0; t < tpr; t++) {
-			for (T b=(T)1<<(8*s-1); b; b>>=1)
-				os << ((v[r*tpr+t] & b) ? '*' : '-');
-			os << ' ';
-		}
-		os << std::endl;
-	}
-}*/
-
 #endif
@@ -52,6 +52,16 @@ class BoundingBox {
 		void embed (const BoundingBox &bb);
 		void embed (const DPair &p) {embed(p.x(), p.y());}
 		void embed (const DPair &c, double r);
+		void embed (const double *coords, size_t count);
+		void embed (const std::vector<double> &coords) {embed(coords.data(), coords.size());}
+
+		/** Embeds a sequence of points given by a flat array of interleaved
+		 *  x/y coordinate values of arbitrary numeric type. */
+		template <typename T>
+		void embed (const std::vector<T> &coords) {
+			for (size_t i=0; i+1 < coords.size(); i+=2)
+				embed(double(coords[i]), double(coords[i+1]));
+		}
 
 		static std::vector<Length> extractLengths (std::string boxstr);
 
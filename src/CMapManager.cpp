@@ -19,6 +19,7 @@
 *************************************************************************/
 
 #include <array>
+#include <mutex>
 #include <sstream>
 #include "CMap.hpp"
 #include "CMapManager.hpp"
@@ -38,6 +39,7 @@ CMapManager& CMapManager::instance () {
 
 /** Loads a cmap and returns the corresponding object. */
 CMap* CMapManager::lookup (const string &name) {
+	lock_guard<recursive_mutex> lock(_mutex);
 	auto it = _cmaps.find(name);
 	if (it != _cmaps.end())
 		return it->second.get();
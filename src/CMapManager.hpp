@@ -22,6 +22,7 @@
 #define CMAPMANAGER_HPP
 
 #include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
@@ -43,6 +44,8 @@ class CMapManager
 		CMapManager () : _level(0) {}
 
 	private:
+		/// serializes concurrent lookups; recursive because "usecmap" leads to nested lookup() calls
+		std::recursive_mutex _mutex;
 		std::unordered_map<std::string, std::unique_ptr<CMap>> _cmaps;  ///< loaded cmaps
 		std::unordered_set<std::string> _includedCMaps;  ///< names of cmaps loaded by "usecmap"
 		int _level;    ///< current inclusion depth; >0 if a cmap loaded by "usecmap" is being processed
@@ -26,26 +26,154 @@
 #include "CMapManager.hpp"
 #include "CMapReader.hpp"
 #include "FileFinder.hpp"
+#include "FilePath.hpp"
+#include "FileSystem.hpp"
+#include "Font.hpp"
 #include "InputReader.hpp"
+#include "StreamReader.hpp"
+#include "StreamWriter.hpp"
 #include "utility.hpp"
+#include "XXHashFunction.hpp"
 
 using namespace std;
 
+const uint8_t CMAPCACHE_FORMAT_VERSION = 1;
+
+// Only cache CMap files of a certain minimum size. Parsing smaller files
+// doesn't take long enough to benefit from a binary representation.
+const uint64_t MIN_CACHEABLE_CMAPFILE_SIZE = 16384;
+
 
 /** Reads a cmap file and returns the corresponding CMap object.
  *  @param fname[in] name/path of cmap file
  *  @return CMap object representing the read data, or 0 if file could not be read */
 unique_ptr<CMap> CMapReader::read (const string &fname) {
 	if (const char *path = FileFinder::instance().lookup(fname, "cmap", false)) {
+		if (auto cmap = readFromCache(fname, path))
+			return std::move(cmap);
 		ifstream ifs(path);
-		if (ifs)
-			return read(ifs, fname);
+		if (ifs) {
+			unique_ptr<CMap> cmap = read(ifs, fname);
+			// Large CMap files, like the CJK encodings, take a while to tokenize, so
+			// their parsed range data is cached in a compact binary representation
+			// restorable by bulk reads on subsequent runs.
+			if (cmap && !PhysicalFont::CACHE_PATH.empty() && FileSystem::filesize(path) >= MIN_CACHEABLE_CMAPFILE_SIZE)
+				writeCache(static_cast<SegmentedCMap&>(*cmap), path);
+			return cmap;
+		}
 	}
 	_tokens.clear();
 	return unique_ptr<CMap>();
 }
 
 
+static void write_uint64 (StreamWriter &sw, HashFunction &hashfunc, uint64_t val) {
+	sw.writeUnsigned(uint32_t(val >> 32), 4, hashfunc);
+	sw.writeUnsigned(uint32_t(val & 0xFFFFFFFF), 4, hashfunc);
+}
+
+
+static uint64_t read_uint64 (StreamReader &sr) {
+	uint64_t val = uint64_t(sr.readUnsigned(4)) << 32;
+	return val | sr.readUnsigned(4);
+}
+
+
+/** Returns the path of the binary cache file assigned to a given CMap file. */
+static string cache_file_path (const string &path) {
+	FilePath fpath(path);
+	XXH64HashFunction hashfunc(fpath.absolute());
+	ostringstream oss;
+	oss << PhysicalFont::CACHE_PATH << '/' << fpath.filename() << '-' << hex << hashfunc.digestValue() << ".bin";
+	return oss.str();
+}
+
+
+/** Tries to restore a parsed CMap from its binary cache representation. The
+ *  cached data is only used if its checksum is valid and if it still refers to
+ *  the current contents of the CMap file.
+ *  @param[in] fname name of the CMap
+ *  @param[in] path path of the CMap file the cache entry was created from
+ *  @return the restored CMap object, or nullptr if the cache couldn't be applied */
+unique_ptr<SegmentedCMap> CMapReader::readFromCache (const string &fname, const string &path) {
+	if (PhysicalFont::CACHE_PATH.empty())
+		return nullptr;
+	ifstream ifs(cache_file_path(path), ios::binary);
+	if (!ifs)
+		return nullptr;
+	StreamReader sr(ifs);
+	if (sr.readUnsigned(1) != CMAPCACHE_FORMAT_VERSION)
+		return nullptr;
+	uint32_t checksum = sr.readUnsigned(4);
+	XXH32HashFunction hashfunc;
+	hashfunc.update(ifs);
+	if (hashfunc.digestValue() != checksum)
+		return nullptr;
+	ifs.clear();
+	ifs.seekg(5);  // continue reading after the checksum
+	if (sr.readString() != FilePath(path).absolute())
+		return nullptr;
+	if (int64_t(read_uint64(sr)) != FileSystem::mtime(path) || read_uint64(sr) != FileSystem::filesize(path))
+		return nullptr;  // CMap file has changed? => cached data is stale
+	auto cmap = util::make_unique<SegmentedCMap>(fname);
+	cmap->_registry = sr.readString();
+	cmap->_ordering = sr.readString();
+	cmap->_cmaptype = sr.readString();
+	cmap->_vertical = (sr.readUnsigned(1) != 0);
+	cmap->_mapsToCID = (sr.readUnsigned(1) != 0);
+	string basemapName = sr.readString();
+	if (!basemapName.empty()) {
+		// resolve the base CMap referenced by operator "usecmap" like op_usecmap() does
+		if ((cmap->_basemap = CMapManager::instance().lookup(basemapName)) == nullptr)
+			return nullptr;
+	}
+	for (RangeMap *rangeMap : {&cmap->_cidranges, &cmap->_bfranges}) {
+		auto numRanges = sr.readUnsigned(4);
+		while (numRanges-- > 0) {
+			uint32_t min = sr.readUnsigned(4);
+			uint32_t max = sr.readUnsigned(4);
+			uint32_t minval = sr.readUnsigned(4);
+			rangeMap->addRange(min, max, minval);  // ranges are stored in ascending order
+		}
+	}
+	return cmap;
+}
+
+
+/** Writes the binary representation of a parsed CMap to the cache directory.
+ *  @param[in] cmap parsed CMap data to be cached
+ *  @param[in] path path of the CMap file the data was read from */
+void CMapReader::writeCache (const SegmentedCMap &cmap, const string &path) {
+	ofstream ofs(cache_file_path(path), ios::binary);
+	if (!ofs)
+		return;
+	StreamWriter sw(ofs);
+	XXH32HashFunction hashfunc;
+	sw.writeUnsigned(CMAPCACHE_FORMAT_VERSION, 1);
+	sw.writeUnsigned(0, 4);  // space for checksum to be written below
+	sw.writeString(FilePath(path).absolute(), hashfunc, true);
+	write_uint64(sw, hashfunc, uint64_t(FileSystem::mtime(path)));
+	write_uint64(sw, hashfunc, FileSystem::filesize(path));
+	sw.writeString(cmap._registry, hashfunc, true);
+	sw.writeString(cmap._ordering, hashfunc, true);
+	sw.writeString(cmap._cmaptype, hashfunc, true);
+	sw.writeUnsigned(cmap._vertical ? 1 : 0, 1, hashfunc);
+	sw.writeUnsigned(cmap._mapsToCID ? 1 : 0, 1, hashfunc);
+	sw.writeString(cmap._basemap ? cmap._basemap->name() : "", hashfunc, true);
+	for (const RangeMap *rangeMap : {&cmap._cidranges, &cmap._bfranges}) {
+		sw.writeUnsigned(uint32_t(rangeMap->numRanges()), 4, hashfunc);
+		for (size_t i=0; i < rangeMap->numRanges(); i++) {
+			const auto &range = rangeMap->getRange(i);
+			sw.writeUnsigned(range.min(), 4, hashfunc);
+			sw.writeUnsigned(range.max(), 4, hashfunc);
+			sw.writeUnsigned(range.minval(), 4, hashfunc);
+		}
+	}
+	ofs.seekp(1);
+	sw.writeUnsigned(hashfunc.digestValue(), 4);  // patch checksum of the data written
+}
+
+
 /** Reads cmap data from a given stream and returns the corresponding CMap object.
  *  @param is[in] cmap data input stream
  *  @param is[in] name name of CMap to be read
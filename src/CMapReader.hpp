@@ -31,6 +31,7 @@
 
 struct CMap;
 class InputReader;
+class SegmentedCMap;
 
 class CMapReader {
 	class Token	{
@@ -55,6 +56,8 @@ class CMapReader {
 
 	protected:
 		Token popToken () {Token t=_tokens.back(); _tokens.pop_back(); return t;}
+		static std::unique_ptr<SegmentedCMap> readFromCache (const std::string &fname, const std::string &path);
+		static void writeCache (const SegmentedCMap &cmap, const std::string &path);
 		void executeOperator (const std::string &op, InputReader &ir);
 		void parseCIDChars (InputReader &ir, bool isRange);
 		void op_beginbfchar (InputReader &ir);
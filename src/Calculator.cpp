@@ -25,20 +25,85 @@
 
 using namespace std;
 
-/** Evaluates a given arithmetic expression and returns its value.
- *  The evaluator is implemented as a recursive descent parser.
- *  @param[in] is reads expression from this stream
+/** Evaluates a compiled expression with the variable bindings of a given Calculator.
+ *  @param[in] calc calculator object providing the variable values
  *  @return expression value */
-double Calculator::eval (istream &is) const {
-	double ret = expr(is, false);
+double Calculator::Expression::evaluate (const Calculator &calc) const {
+	vector<double> stack;
+	stack.reserve(8);
+	for (const Instruction &instr : _instructions) {
+		switch (instr.opcode) {
+			case OpCode::PUSH_NUMBER:
+				stack.push_back(instr.value);
+				break;
+			case OpCode::PUSH_VARIABLE:
+				stack.push_back(calc.getVariable(instr.name));
+				break;
+			case OpCode::NEG:
+				stack.back() = -stack.back();
+				break;
+			default: {
+				double right = stack.back();
+				stack.pop_back();
+				double &left = stack.back();
+				switch (instr.opcode) {
+					case OpCode::ADD: left += right; break;
+					case OpCode::SUB: left -= right; break;
+					case OpCode::MUL: left *= right; break;
+					case OpCode::DIV:
+						if (right == 0)
+							throw CalculatorException("division by zero");
+						left /= right;
+						break;
+					case OpCode::MOD:
+						if (right == 0)
+							throw CalculatorException("division by zero");
+						left -= right * floor(left / right);
+						break;
+					default: ;
+				}
+			}
+		}
+	}
+	return stack.back();
+}
+
+
+/** Compiles a given arithmetic expression to a sequence of stack machine
+ *  instructions which can be evaluated repeatedly with changed variable bindings.
+ *  The compiler is implemented as a recursive descent parser.
+ *  @param[in] is reads expression from this stream
+ *  @return the compiled expression */
+Calculator::Expression Calculator::compile (istream &is) {
+	Expression expression;
+	expr(is, false, expression);
 	try {
-		// check if expression has been fully evaluated (next token is of type bool)
+		// check if expression has been fully parsed (next token is of type bool)
 		mpark::get<bool>(lookAhead(is));
 	}
 	catch (mpark::bad_variant_access &e) {
 		throw CalculatorException("expression syntax error");
 	}
-	return ret;
+	return expression;
+}
+
+
+/** Compiles a given arithmetic expression to a sequence of stack machine
+ *  instructions which can be evaluated repeatedly with changed variable bindings.
+ *  @param[in] expr expression to compile
+ *  @return the compiled expression */
+Calculator::Expression Calculator::compile (const string &expr) {
+	istringstream iss;
+	iss.str(expr);
+	return compile(iss);
+}
+
+
+/** Evaluates a given arithmetic expression and returns its value.
+ *  @param[in] is reads expression from this stream
+ *  @return expression value */
+double Calculator::eval (istream &is) const {
+	return compile(is).evaluate(*this);
 }
 
 
@@ -52,9 +117,9 @@ double Calculator::eval (const string &expr) const {
 }
 
 
-/** Evaluates the root rule of the expression grammar. */
-double Calculator::expr (istream &is, bool skip) const {    // expr:
-	double left = term(is, skip);
+/** Compiles the root rule of the expression grammar. */
+void Calculator::expr (istream &is, bool skip, Expression &expression) {    // expr:
+	term(is, skip, expression);
 	bool ready=false;
 	while (!ready) {
 		Token token = lookAhead(is);
@@ -63,18 +128,24 @@ double Calculator::expr (istream &is, bool skip) const {    // expr:
 			ready = true;
 		else {
 			switch (*op) {
-				case '+': left += term(is, true); break;  // term '+' term => $1 + $3
-				case '-': left -= term(is, true); break;  // term '-' term => $1 - $3
-				default : ready = true;
+				case '+':   // term '+' term => $1 + $3
+					term(is, true, expression);
+					expression._instructions.emplace_back(Expression::Instruction(Expression::OpCode::ADD));
+					break;
+				case '-':   // term '-' term => $1 - $3
+					term(is, true, expression);
+					expression._instructions.emplace_back(Expression::Instruction(Expression::OpCode::SUB));
+					break;
+				default:
+					ready = true;
 			}
 		}
 	}
-	return left;  // term => $1
 }
 
 
-double Calculator::term (istream &is, bool skip) const {    // term:
-	double left = prim(is, skip);
+void Calculator::term (istream &is, bool skip, Expression &expression) {    // term:
+	prim(is, skip, expression);
 	bool ready=false;
 	while (!ready) {
 		Token token = lookAhead(is);
@@ -83,51 +154,56 @@ double Calculator::term (istream &is, bool skip) const {    // term:
 			ready = true;
 		else {
 			switch (*op) {
-				case '*': left *= prim(is, true); break;  // prim '*' prim => $1 * $3
-				case '(': left *= prim(is, false); break; // prim '(' prim => $1 * $3
-				case '/': {                               // prim '/' prim => $1 / $3
-					double denom = prim(is, true);
-					if (denom == 0)
-						throw CalculatorException("division by zero");
-					left /= denom;
+				case '*':   // prim '*' prim => $1 * $3
+					prim(is, true, expression);
+					expression._instructions.emplace_back(Expression::Instruction(Expression::OpCode::MUL));
 					break;
-				}
-				case '%': {                               // prim '%' prim => $1 mod $3
-					double denom = prim(is, true);
-					if (denom == 0)
-						throw CalculatorException("division by zero");
-					left -= denom * floor(left / denom);
+				case '(':   // prim '(' prim => $1 * $3
+					prim(is, false, expression);
+					expression._instructions.emplace_back(Expression::Instruction(Expression::OpCode::MUL));
+					break;
+				case '/':   // prim '/' prim => $1 / $3
+					prim(is, true, expression);
+					expression._instructions.emplace_back(Expression::Instruction(Expression::OpCode::DIV));
+					break;
+				case '%':   // prim '%' prim => $1 mod $3
+					prim(is, true, expression);
+					expression._instructions.emplace_back(Expression::Instruction(Expression::OpCode::MOD));
 					break;
-				}
 				default:
 					ready = true;
 			}
 		}
 	}
-	return left;
 }
 
 
-/** Evaluates a primary expression of the grammar which doesn't contain any binary operators. */
-double Calculator::prim (istream &is, bool skip) const { // prim:
+/** Compiles a primary expression of the grammar which doesn't contain any binary operators. */
+void Calculator::prim (istream &is, bool skip, Expression &expression) { // prim:
 	if (skip)
 		lex(is);
 	Token token = lookAhead(is);
 	if (mpark::get_if<double>(&token)) {               //  NUMBER => $1
-		double ret = mpark::get<double>(lex(is));
+		expression._instructions.emplace_back(Expression::Instruction(mpark::get<double>(lex(is))));
 		token = lookAhead(is);
-		if (mpark::get_if<string>(&token))              // NUMBER STRING => $1 * $2
-			ret *= getVariable(mpark::get<string>(lex(is)));
-		return ret;
+		if (mpark::get_if<string>(&token)) {            // NUMBER STRING => $1 * $2
+			expression._instructions.emplace_back(Expression::Instruction(mpark::get<string>(lex(is))));
+			expression._instructions.emplace_back(Expression::Instruction(Expression::OpCode::MUL));
+		}
+		return;
+	}
+	if (mpark::get_if<string>(&token)) {               // STRING => getVariable($1)
+		expression._instructions.emplace_back(Expression::Instruction(mpark::get<string>(lex(is))));
+		return;
 	}
-	if (mpark::get_if<string>(&token))                 // STRING => getVariable($1)
-		return getVariable(mpark::get<string>(lex(is)));
 	if (char *op = mpark::get_if<char>(&token)) {
 		switch (*op) {
 			case '-':                                    // '-' prim => -$2
-				return -prim(is, true);
+				prim(is, true, expression);
+				expression._instructions.emplace_back(Expression::Instruction(Expression::OpCode::NEG));
+				return;
 			case '(': {                                  // '(' expr ')' => $2
-				double e = expr(is, true);
+				expr(is, true, expression);
 				try {
 					if (mpark::get<char>(lookAhead(is)) != ')')
 						throw CalculatorException("')' expected");
@@ -136,7 +212,7 @@ double Calculator::prim (istream &is, bool skip) const { // prim:
 					throw CalculatorException("')' expected");
 				}
 				is.get();   // skip processed char
-				return e;
+				return;
 			}
 		}
 	}
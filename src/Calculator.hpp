@@ -24,6 +24,7 @@
 #include <istream>
 #include <map>
 #include <string>
+#include <vector>
 #include <mpark/variant.hpp>
 #include "MessageException.hpp"
 
@@ -33,15 +34,41 @@ struct CalculatorException : public MessageException {
 
 class Calculator {
 	public:
+		/** Compiled form of an arithmetic expression. The expression string is
+		 *  parsed once into a sequence of stack machine instructions (reverse
+		 *  Polish order) which can be re-evaluated cheaply with changed variable
+		 *  bindings, e.g. once per page. */
+		class Expression {
+			friend class Calculator;
+			public:
+				double evaluate (const Calculator &calc) const;
+
+			private:
+				enum class OpCode : char {PUSH_NUMBER, PUSH_VARIABLE, ADD, SUB, MUL, DIV, MOD, NEG};
+
+				struct Instruction {
+					explicit Instruction (OpCode op) : opcode(op), value(0) {}
+					explicit Instruction (double val) : opcode(OpCode::PUSH_NUMBER), value(val) {}
+					explicit Instruction (std::string varname) : opcode(OpCode::PUSH_VARIABLE), value(0), name(std::move(varname)) {}
+					OpCode opcode;
+					double value;      ///< number pushed by PUSH_NUMBER
+					std::string name;  ///< name of the variable referenced by PUSH_VARIABLE
+				};
+
+				std::vector<Instruction> _instructions;
+		};
+
 		double eval (std::istream &is) const;
 		double eval (const std::string &expr) const;
+		static Expression compile (std::istream &is);
+		static Expression compile (const std::string &expr);
 		void setVariable (const std::string &name, double value) {_variables[name] = value;}
 		double getVariable (const std::string &name) const;
 
 	protected:
-		double expr (std::istream &is, bool skip) const;
-		double term (std::istream &is, bool skip) const;
-		double prim (std::istream &is, bool skip) const;
+		static void expr (std::istream &is, bool skip, Expression &expression);
+		static void term (std::istream &is, bool skip, Expression &expression);
+		static void prim (std::istream &is, bool skip, Expression &expression);
 
 		using Token = mpark::variant<bool, char, double, std::string>;
 		static Token lex (std::istream &is);
@@ -0,0 +1,51 @@
+/*************************************************************************
+** CallbackSVGOutput.cpp                                                **
+**                                                                      **
+** This file is part of dvisvgm -- a fast DVI to SVG converter          **
+** Copyright (C) 2005-2024 Martin Gieseking <martin.gieseking@uos.de>   **
+**                                                                      **
+** This program is free software; you can redistribute it and/or        **
+** modify it under the terms of the GNU General Public License as       **
+** published by the Free Software Foundation; either version 3 of       **
+** the License, or (at your option) any later version.                  **
+**                                                                      **
+** This program is distributed in the hope that it will be useful, but  **
+** WITHOUT ANY WARRANTY; without even the implied warranty of           **
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the         **
+** GNU General Public License for more details.                         **
+**                                                                      **
+** You should have received a copy of the GNU General Public License    **
+** along with this program; if not, see <http://www.gnu.org/licenses/>. **
+*************************************************************************/
+
+#include <config.h>
+#include "CallbackSVGOutput.hpp"
+
+using namespace std;
+
+
+/** Returns the stream collecting the data of the given page.
+ *  @param[in] page number of current page
+ *  @param[in] numPages total number of pages in the DVI file
+ *  @param[in] hashes hash values of the current page
+ *  @return output stream for the given page */
+ostream& CallbackSVGOutput::getPageStream (int page, int numPages, const HashTriple &hashes) const {
+	_pageOpen = true;
+	_info.pageno = page;
+	_info.numPages = numPages;
+	_info.hashes = hashes;
+	return _os;
+}
+
+
+/** Flushes the collected page data to the callback. The function is called
+ *  after the serialization of each page, so the callback receives the pages
+ *  one by one and in page order. */
+void CallbackSVGOutput::finish () {
+	if (_pageOpen) {
+		_pageOpen = false;
+		if (_callback)
+			_callback(_streambuf.take(), _info);
+		_info = PageInfo();
+	}
+}
@@ -0,0 +1,88 @@
+/*************************************************************************
+** CallbackSVGOutput.hpp                                                **
+**                                                                      **
+** This file is part of dvisvgm -- a fast DVI to SVG converter          **
+** Copyright (C) 2005-2024 Martin Gieseking <martin.gieseking@uos.de>   **
+**                                                                      **
+** This program is free software; you can redistribute it and/or        **
+** modify it under the terms of the GNU General Public License as       **
+** published by the Free Software Foundation; either version 3 of       **
+** the License, or (at your option) any later version.                  **
+**                                                                      **
+** This program is distributed in the hope that it will be useful, but  **
+** WITHOUT ANY WARRANTY; without even the implied warranty of           **
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the         **
+** GNU General Public License for more details.                         **
+**                                                                      **
+** You should have received a copy of the GNU General Public License    **
+** along with this program; if not, see <http://www.gnu.org/licenses/>. **
+*************************************************************************/
+
+#ifndef CALLBACKSVGOUTPUT_HPP
+#define CALLBACKSVGOUTPUT_HPP
+
+#include <functional>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include "BoundingBox.hpp"
+#include "SVGOutput.hpp"
+
+/** Output sink handing each completed SVG page to a callback function
+ *  instead of writing it to a file or stream. The serialized page data is
+ *  collected in a string that's moved (not copied) to the callback together
+ *  with the page metadata, so embedding applications can pass the pages on
+ *  to their own I/O machinery without an intermediate file or stream copy.
+ *  The page hashes ride along and can serve as cache keys. */
+class CallbackSVGOutput : public SVGOutputBase {
+	public:
+		/** Metadata of a completed page passed to the callback. */
+		struct PageInfo {
+			int pageno=0;       ///< number of the page
+			int numPages=0;     ///< total number of pages in the DVI file
+			BoundingBox bbox;   ///< bounding box of the page (in final coordinates)
+			HashTriple hashes;  ///< hashes of the page's DVI data and the conversion options
+		};
+
+		using PageCallback = std::function<void (std::string &&svg, const PageInfo &info)>;
+
+		explicit CallbackSVGOutput (PageCallback callback) : _callback(std::move(callback)) {}
+		std::ostream& getPageStream (int page, int numPages, const HashTriple &hashes=HashTriple()) const override;
+		FilePath filepath (int page, int numPages, const HashTriple &hashes=HashTriple()) const override {return FilePath();}
+		void setPageBBox (int page, const BoundingBox &bbox) override {_info.bbox = bbox;}
+		void finish () override;
+		bool ignoresHashes () const override {return false;}
+
+	protected:
+		/** Stream buffer appending the serialized page data directly to a string
+		 *  which can afterwards be moved out without a further copy. */
+		class StringStreamBuffer : public std::streambuf {
+			public:
+				std::string take ()  {std::string data = std::move(_data); _data.clear(); return data;}
+				bool empty () const  {return _data.empty();}
+
+			protected:
+				int_type overflow (int_type c) override {
+					if (c != traits_type::eof())
+						_data.push_back(traits_type::to_char_type(c));
+					return c;
+				}
+
+				std::streamsize xsputn (const char *buf, std::streamsize count) override {
+					_data.append(buf, size_t(count));
+					return count;
+				}
+
+			private:
+				std::string _data;  ///< serialized data of the current page
+		};
+
+	private:
+		PageCallback _callback;    ///< function receiving the completed pages
+		mutable PageInfo _info;    ///< metadata of the page currently being collected
+		mutable bool _pageOpen=false;  ///< true if page data was collected since the last flush
+		mutable StringStreamBuffer _streambuf;  ///< collects the data of the current page
+		mutable std::ostream _os{&_streambuf};  ///< stream interface the serializer writes to
+};
+
+#endif
@@ -43,6 +43,23 @@ inline uint8_t double_to_byte (double v) {
 }
 
 
+/** Table that maps 8-bit color components to their normalized
+ *  double representation, i.e. values[i] == i/255.0. */
+struct ByteToDoubleTable {
+	constexpr ByteToDoubleTable () : values() {
+		for (int i=0; i < 256; i++)
+			values[i] = i/255.0;
+	}
+	double values[256];
+};
+
+static constexpr ByteToDoubleTable BYTE_AS_DOUBLE;
+
+inline double byte_to_double (uint32_t byteval) {
+	return BYTE_AS_DOUBLE.values[byteval & 0xff];
+}
+
+
 /** Reads n double values from input stream is. The values may be
  *  separated by whitespace and/or commas. */
 static valarray<double> read_doubles (istream &is, int n) {
@@ -129,26 +146,66 @@ bool Color::setRGBHexString (string hexString) {
 }
 
 
-/** Expects a PostScript color name and sets the color accordingly.
- *  @param[in] name PS color name
- *  @param[in] case_sensitive if true, upper/lower case spelling is significant
- *  @return true if color name could be applied properly */
-bool Color::setPSName (string name, bool case_sensitive) {
-	_cspace = ColorSpace::RGB;
-	if (name[0] == '#') {
-		char *p=nullptr;
-		_value = uint32_t(strtol(name.c_str()+1, &p, 16));
-		while (isspace(*p))
-			p++;
-		return (*p == 0 && _value <= 0xFFFFFF);
+/** Returns the lowercase variant of an ASCII character. */
+constexpr char tolower_ascii (char c) {
+	return c >= 'A' && c <= 'Z' ? char(c-'A'+'a') : c;
+}
+
+
+/** Computes the FNV-1a hash of a zero-terminated string. The characters
+ *  are lowercased before being hashed so that strings differing in case
+ *  only are mapped to the same hash value. */
+constexpr uint32_t hash_color_name (const char *name) {
+	uint32_t hash = 2166136261u;
+	for (; *name; name++)
+		hash = (hash ^ uint32_t(uint8_t(tolower_ascii(*name)))) * 16777619u;
+	return hash;
+}
+
+
+/** Compares two strings ignoring the case of ASCII characters. */
+static bool equals_icase (const char *str1, const char *str2) {
+	while (*str1 && tolower_ascii(*str1) == tolower_ascii(*str2)) {
+		str1++;
+		str2++;
+	}
+	return tolower_ascii(*str1) == tolower_ascii(*str2);
+}
+
+
+struct ColorConstant {
+	const char *name;
+	uint32_t rgb;
+};
+
+
+template <size_t NUM_SLOTS>
+struct ColorConstantTable {
+	ColorConstant slots[NUM_SLOTS];
+};
+
+
+/** Distributes the given color constants over the slots of a hash table
+ *  addressed by the hash values of the color names. Collisions are resolved
+ *  by linear probing. Since the table is created at compile time, the name
+ *  lookups performed by Color::setPSName require neither runtime setup nor
+ *  heap allocations. */
+template <size_t NUM_SLOTS, size_t N>
+constexpr ColorConstantTable<NUM_SLOTS> create_color_table (const ColorConstant (&constants)[N]) {
+	static_assert(N < NUM_SLOTS, "number of colors exceeds table capacity");
+	ColorConstantTable<NUM_SLOTS> table{};
+	for (size_t i=0; i < N; i++) {
+		uint32_t index = hash_color_name(constants[i].name) % NUM_SLOTS;
+		while (table.slots[index].name != nullptr)
+			index = (index+1) % NUM_SLOTS;
+		table.slots[index] = constants[i];
 	}
+	return table;
+}
+
 
-	struct ColorConstant {
-		const char *name;
-		const uint32_t rgb;
-	};
-	// converted color constants from color.pro
-	static const array<ColorConstant, 68> constants {{
+// converted color constants from color.pro
+constexpr ColorConstant PS_COLOR_CONSTANTS[68] {
 		{"Apricot",        0xFFAD7A},
 		{"Aquamarine",     0x2DFFB2},
 		{"Bittersweet",    0xC10200},
@@ -217,28 +274,32 @@ bool Color::setPSName (string name, bool case_sensitive) {
 		{"Yellow",         0xFFFF00},
 		{"YellowGreen",    0x8EFF42},
 		{"YellowOrange",   0xFF9300},
-	}};
-	if (case_sensitive) {
-		const ColorConstant cmppair = {name.c_str(), 0};
-		auto it = lower_bound(constants.begin(), constants.end(), cmppair,
-			[](const ColorConstant &c1, const ColorConstant &c2) {
-				return strcmp(c1.name, c2.name) < 0;
-			}
-		);
-		if (it != constants.end() && it->name == name) {
-			_value = it->rgb;
-			return true;
-		}
+};
+
+constexpr size_t COLOR_TABLE_SLOTS = 128;
+constexpr auto PS_COLOR_TABLE = create_color_table<COLOR_TABLE_SLOTS>(PS_COLOR_CONSTANTS);
+
+
+/** Expects a PostScript color name and sets the color accordingly.
+ *  @param[in] name PS color name
+ *  @param[in] case_sensitive if true, upper/lower case spelling is significant
+ *  @return true if color name could be applied properly */
+bool Color::setPSName (string name, bool case_sensitive) {
+	_cspace = ColorSpace::RGB;
+	if (name[0] == '#') {
+		char *p=nullptr;
+		_value = uint32_t(strtol(name.c_str()+1, &p, 16));
+		while (isspace(*p))
+			p++;
+		return (*p == 0 && _value <= 0xFFFFFF);
 	}
-	else {
-		name = util::tolower(name);
-		auto it = find_if(constants.begin(), constants.end(), [&](const ColorConstant &cc) {
-			return name == util::tolower(cc.name);
-		});
-		if (it != constants.end()) {
-			_value = it->rgb;
+	size_t index = hash_color_name(name.c_str()) % COLOR_TABLE_SLOTS;
+	while (const char *slotname = PS_COLOR_TABLE.slots[index].name) {
+		if (case_sensitive ? name == slotname : equals_icase(name.c_str(), slotname)) {
+			_value = PS_COLOR_TABLE.slots[index].rgb;
 			return true;
 		}
+		index = (index+1) % COLOR_TABLE_SLOTS;
 	}
 	return false;
 }
@@ -485,7 +546,7 @@ valarray<double> Color::getDoubleValues () const {
 	valarray<double> values(n);
 	int i=0;
 	for (int shift= (n-1)*8; shift >= 0; shift-=8)
-		values[i++] = ((_value >> shift) & 0xff)/255.0;
+		values[i++] = byte_to_double(_value >> shift);
 	return values;
 }
 
@@ -510,9 +571,9 @@ void Color::CMYK2RGB (const valarray<double> &cmyk, valarray<double> &rgb) {
 		rgb[i] = min(1.0, max(0.0, rgb[i]*kc));
 #else
 	uint32_t rgb32 = interpolate_cmyk2rgb(cmyk);
-	rgb[0] = (rgb32 >> 16) / 255.0;
-	rgb[1] = ((rgb32 >> 8) & 0xff) / 255.0;
-	rgb[2] = (rgb32 & 0xff) / 255.0;
+	rgb[0] = byte_to_double(rgb32 >> 16);
+	rgb[1] = byte_to_double(rgb32 >> 8);
+	rgb[2] = byte_to_double(rgb32);
 #endif
 }
 
@@ -544,6 +605,8 @@ void Color::HSB2RGB (const valarray<double> &hsb, valarray<double> &rgb) {
 
 
 double Color::getGray () const {
+	if (_cspace == ColorSpace::GRAY)  // shortcut: component is the gray value itself
+		return byte_to_double(_value);
 	double r, g, b;
 	getRGB(r, g, b);
 	return r*0.3 + g*0.59 + b*0.11; // gray value according to NTSC video standard
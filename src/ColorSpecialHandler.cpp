@@ -161,15 +161,26 @@ char ColorSpecialHandler::processPush (istream &is) {
  *  color values (usually black) are changed.
  *  @return color type specified in the special command ('f'=fill, 's'=stroke, 0=none specified) */
 char ColorSpecialHandler::processSet (istream &is) {
-	char type;
-	Color color = read_color_and_type(is, type);
+	// Documents created with color packages tend to push/set the same few colors
+	// over and over again, so look up the parsed form of the spec string before
+	// tokenizing it from scratch.
+	string spec;
+	getline(is, spec);
+	auto it = _parsedSpecs.find(spec);
+	if (it == _parsedSpecs.end()) {
+		istringstream iss(spec);
+		char type;
+		Color color = read_color_and_type(iss, type);
+		it = _parsedSpecs.emplace(std::move(spec), ColorSpec{color, type}).first;
+	}
+	const ColorSpec &colorSpec = it->second;
 	Color &fillColor = _colorStack.empty() ? _defaultFillColor : _colorStack.back().fillColor;
 	Color &strokeColor = _colorStack.empty() ? _defaultStrokeColor : _colorStack.back().strokeColor;
-	if (type == 0 || type == 'f')
-		fillColor = color;
-	if (type == 0 || type == 's')
-		strokeColor = color;
-	return type;
+	if (colorSpec.type == 0 || colorSpec.type == 'f')
+		fillColor = colorSpec.color;
+	if (colorSpec.type == 0 || colorSpec.type == 's')
+		strokeColor = colorSpec.color;
+	return colorSpec.type;
 }
 
 
@@ -23,6 +23,7 @@
 
 #include <stack>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include "Color.hpp"
 #include "SpecialHandler.hpp"
@@ -35,7 +36,14 @@ class ColorSpecialHandler : public SpecialHandler {
 			Color strokeColor;
 		};
 
+		/** Parsed form of "[fill|stroke] <model> <params>". */
+		struct ColorSpec {
+			Color color;
+			char type;  ///< 'f'=fill, 's'=stroke, 0=none specified
+		};
+
 	public:
+		ColorSpecialHandler () {_colorStack.reserve(8);}
 		bool process (const std::string &prefix, std::istream &is, SpecialActions &actions) override;
 		static Color readColor (std::istream &is);
 		static Color readColor (const std::string &model, std::istream &is);
@@ -53,6 +61,7 @@ class ColorSpecialHandler : public SpecialHandler {
 		Color _defaultFillColor = Color::BLACK;
 		Color _defaultStrokeColor = Color::BLACK;
 		std::vector<ColorPair> _colorStack;
+		std::unordered_map<std::string,ColorSpec> _parsedSpecs;  ///< maps color spec strings to their parsed form
 };
 
 #endif
@@ -19,7 +19,7 @@ class CommandLine : public CL::CommandLine {
 	public:
 		CommandLine () : CL::CommandLine(
 			"This program converts DVI files, as created by TeX/LaTeX, as well as\nEPS and PDF files to the XML-based scalable vector graphics format SVG.",
-			"[options] dvifile\n--eps [options] epsfile\n--pdf [options] pdffile",
+			"[options] dvifile(s)\n--eps [options] epsfile(s)\n--pdf [options] pdffile(s)",
 			"Copyright (C) 2005-2024 Martin Gieseking <martin.gieseking@uos.de>"
 		) {}
 
@@ -28,30 +28,48 @@ class CommandLine : public CL::CommandLine {
 		}
 
 		// option variables
+		TypedOption<std::string, Option::ArgMode::REQUIRED> affinityOpt {"affinity", '\0', "cpus", "bind the worker threads to the given CPUs"};
 		TypedOption<std::string, Option::ArgMode::REQUIRED> bboxOpt {"bbox", 'b', "size", "min", "set size of bounding box"};
+		TypedOption<std::string, Option::ArgMode::OPTIONAL> benchOpt {"bench", '\0', "params", "convert a synthetic workload and report the throughput"};
 		TypedOption<std::string, Option::ArgMode::REQUIRED> bitmapFormatOpt {"bitmap-format", 'B', "fmt", "jpeg", "set format used to embed PS/EPS bitmaps"};
+		TypedOption<std::string, Option::ArgMode::REQUIRED> bundleOpt {"bundle", '\0', "dirname", "write page SVGs, shared font CSS, and an index file to the given directory"};
 		TypedOption<std::string, Option::ArgMode::OPTIONAL> cacheOpt {"cache", 'C', "dir", "set/print path of cache directory"};
+		TypedOption<unsigned, Option::ArgMode::REQUIRED> cacheLimitOpt {"cache-limit", '\0', "size", 0, "limit size of cache directory to <size> MB (0=unlimited)"};
+		Option cacheResultsOpt {"cache-results", '\0', "store conversion results of EPS/PDF files for reuse"};
 		Option clipjoinOpt {"clipjoin", 'j', "compute intersection of clipping paths"};
 		Option colorOpt {"color", '\0', "colorize messages"};
 		Option colornamesOpt {"colornames", '\0', "prefer color names to RGB values if possible"};
 		Option commentsOpt {"comments", '\0', "add comments with additional information"};
+		Option compactOpt {"compact", '\0', "omit all formatting whitespace in the SVG output"};
 		TypedOption<std::string, Option::ArgMode::OPTIONAL> currentcolorOpt {"currentcolor", '\0', "color", "#000", "replace given color with 'currentColor'"};
 		Option debugGlyphsOpt {"debug-glyphs", '\0', "create PS files for all glyphs converted to TTF"};
 		Option embedBitmapsOpt {"embed-bitmaps", '\0', "prevent references to external bitmap files"};
 		Option epsOpt {"eps", 'E', "convert EPS file to SVG"};
 		Option exactBboxOpt {"exact-bbox", 'e', "compute exact glyph bounding boxes"};
+		TypedOption<int, Option::ArgMode::REQUIRED> fontCompressionOpt {"font-compression", '\0', "level", 11, "set compression level of embedded WOFF/WOFF2 fonts"};
+		TypedOption<std::string, Option::ArgMode::REQUIRED> fontCssOpt {"font-css", '\0', "filename", "write font CSS rules to a shared file referenced by all pages"};
 		TypedOption<std::string, Option::ArgMode::REQUIRED> fontFormatOpt {"font-format", 'f', "format", "svg", "set file format of embedded fonts"};
 		TypedOption<std::string, Option::ArgMode::REQUIRED> fontmapOpt {"fontmap", 'm', "filenames", "evaluate (additional) font map files"};
+		TypedOption<int, Option::ArgMode::REQUIRED> gradLimitOpt {"grad-limit", '\0', "number", 0, "rasterize shadings producing more than <number> gradient segments"};
+		TypedOption<double, Option::ArgMode::REQUIRED> gradLodOpt {"grad-lod", '\0', "factor", 1, "set level of detail of color gradient approximations"};
+		Option gradMeshOpt {"grad-mesh", '\0', "create SVG 2 mesh gradients instead of approximating shadings"};
 		Option gradOverlapOpt {"grad-overlap", '\0', "create overlapping color gradient segments"};
 		TypedOption<int, Option::ArgMode::REQUIRED> gradSegmentsOpt {"grad-segments", '\0', "number", 20, "number of color gradient segments per row"};
 		TypedOption<double, Option::ArgMode::REQUIRED> gradSimplifyOpt {"grad-simplify", '\0', "delta", 0.05, "reduce level of detail for small segments"};
 		TypedOption<int, Option::ArgMode::OPTIONAL> helpOpt {"help", 'h', "mode", 0, "print this summary of options and exit"};
+		Option isolateSpecialsOpt {"isolate-specials", '\0', "don't abort page conversion if a special fails but drop its output"};
+		TypedOption<unsigned, Option::ArgMode::REQUIRED> jobsOpt {"jobs", '\0', "number", 1, "number of threads used to convert pages"};
+		Option jobserverOpt {"jobserver", '\0', "acquire additional worker threads from the GNU make jobserver"};
 		Option keepOpt {"keep", '\0', "keep temporary files"};
 		TypedOption<std::string, Option::ArgMode::REQUIRED> libgsOpt {"libgs", '\0', "filename", "set name of Ghostscript shared library"};
 		TypedOption<std::string, Option::ArgMode::REQUIRED> linkmarkOpt {"linkmark", 'L', "style", "box", "select how to mark hyperlinked areas"};
 		Option listSpecialsOpt {"list-specials", 'l', "print supported special sets and exit"};
 		TypedOption<double, Option::ArgMode::REQUIRED> magOpt {"mag", 'M', "factor", 4, "magnification of Metafont output"};
+		TypedOption<std::string, Option::ArgMode::REQUIRED> manifestOpt {"manifest", '\0', "filename", "write a JSON manifest of the converted pages to the given file"};
+		TypedOption<unsigned, Option::ArgMode::REQUIRED> maxMemoryOpt {"max-memory", '\0', "size", 0, "limit memory used for buffered pages and glyphs to <size> MB (0=unlimited)"};
+		Option memStatsOpt {"mem-stats", '\0', "print per-subsystem memory usage statistics"};
 		TypedOption<std::string, Option::ArgMode::REQUIRED> messageOpt {"message", '\0', "text", "print message text after writing an SVG file"};
+		Option multipageOpt {"multipage", '\0', "combine all converted pages into a single SVG file"};
 		TypedOption<int, Option::ArgMode::OPTIONAL> noFontsOpt {"no-fonts", 'n', "variant", 0, "draw glyphs by using path elements"};
 		Option noMergeOpt {"no-merge", '\0', "don't merge adjacent text elements"};
 		Option noMktexmfOpt {"no-mktexmf", '\0', "don't try to create missing fonts"};
@@ -60,22 +78,31 @@ class CommandLine : public CL::CommandLine {
 		TypedOption<std::string, Option::ArgMode::OPTIONAL> optimizeOpt {"optimize", 'O', "modules", "all", "perform several SVG optimizations"};
 		TypedOption<std::string, Option::ArgMode::REQUIRED> outputOpt {"output", 'o', "pattern", "set name pattern of output files"};
 		TypedOption<std::string, Option::ArgMode::REQUIRED> pageOpt {"page", 'p', "ranges", "1", "choose page(s) to convert"};
+		Option pageFramesOpt {"page-frames", '\0', "write pages as length-prefixed records to stdout"};
 		TypedOption<std::string, Option::ArgMode::OPTIONAL> pageHashesOpt {"page-hashes", 'H', "params", "xxh64", "activate usage of page hashes"};
 		Option pdfOpt {"pdf", 'P', "convert PDF file to SVG"};
 		TypedOption<int, Option::ArgMode::REQUIRED> precisionOpt {"precision", 'd', "number", 0, "set number of decimal points (0-6)"};
+		Option prefetchFontsOpt {"prefetch-fonts", '\0', "load font files and metrics concurrently before the page conversion"};
 		TypedOption<double, Option::ArgMode::OPTIONAL> progressOpt {"progress", '\0', "delay", 0.5, "enable progress indicator"};
 		Option relativeOpt {"relative", 'R', "create relative path commands"};
 		TypedOption<double, Option::ArgMode::REQUIRED> rotateOpt {"rotate", 'r', "angle", "rotate page content clockwise"};
+		Option runStatsOpt {"run-stats", '\0', "print event counters of the conversion run"};
 		TypedOption<std::string, Option::ArgMode::REQUIRED> scaleOpt {"scale", 'c', "sx[,sy]", "scale page content"};
 		Option stdinOpt {"stdin", '\0', "read input file from stdin"};
 		Option stdoutOpt {"stdout", 's', "write SVG output to stdout"};
+		Option streamPagesOpt {"stream-pages", '\0', "serialize finished page parts early to reduce memory usage"};
+		TypedOption<double, Option::ArgMode::REQUIRED> timeoutOpt {"timeout", '\0', "seconds", 0.0, "limit the conversion time per page to <seconds> (0=unlimited)"};
+		TypedOption<std::string, Option::ArgMode::OPTIONAL> timingsOpt {"timings", '\0', "file", "print wall times of the processing stages and optionally write a trace-event timeline to <file>"};
 		TypedOption<std::string, Option::ArgMode::OPTIONAL> tmpdirOpt {"tmpdir", '\0', "path", "set/print the directory for temporary files"};
 		TypedOption<bool, Option::ArgMode::OPTIONAL> traceAllOpt {"trace-all", 'a', "retrace", false, "trace all glyphs of bitmap fonts"};
 		TypedOption<std::string, Option::ArgMode::REQUIRED> transformOpt {"transform", 'T', "commands", "transform page content"};
 		TypedOption<std::string, Option::ArgMode::REQUIRED> translateOpt {"translate", 't', "tx[,ty]", "shift page content"};
 		TypedOption<unsigned, Option::ArgMode::REQUIRED> verbosityOpt {"verbosity", 'v', "level", 15, "set verbosity level (0-15)"};
 		TypedOption<bool, Option::ArgMode::OPTIONAL> versionOpt {"version", 'V', "extended", false, "print version and exit"};
+		Option watchOpt {"watch", '\0', "keep running and reconvert the input file whenever it changes"};
 		TypedOption<int, Option::ArgMode::OPTIONAL> zipOpt {"zip", 'z', "level", 9, "create compressed .svgz file"};
+		Option zipRsyncableOpt {"zip-rsyncable", '\0', "make compressed .svgz files rsync-friendly"};
+		TypedOption<int, Option::ArgMode::REQUIRED> zipThreadsOpt {"zip-threads", '\0', "number", 1, "set number of threads used for gzip compression"};
 		TypedOption<double, Option::ArgMode::REQUIRED> zoomOpt {"zoom", 'Z', "factor", 1.0, "zoom page content"};
 
 	protected:
@@ -93,6 +120,7 @@ class CommandLine : public CL::CommandLine {
 
 		mutable std::vector<OptSectPair> _options = {
 			{&pageOpt, 0},
+			{&benchOpt, 0},
 			{&fontmapOpt, 0},
 #if !defined(DISABLE_GS)
 			{&epsOpt, 0},
@@ -105,16 +133,33 @@ class CommandLine : public CL::CommandLine {
 #if !defined(DISABLE_GS)
 			{&bitmapFormatOpt, 1},
 #endif
+			{&bundleOpt, 1},
 #if !defined(DISABLE_GS)
 			{&clipjoinOpt, 1},
 #endif
 			{&colornamesOpt, 1},
 			{&commentsOpt, 1},
+			{&compactOpt, 1},
 			{&currentcolorOpt, 1},
 			{&embedBitmapsOpt, 1},
+#if !defined(DISABLE_WOFF)
+			{&fontCompressionOpt, 1},
+#endif
+#if !defined(DISABLE_WOFF)
+			{&fontCssOpt, 1},
+#endif
 #if !defined(DISABLE_WOFF)
 			{&fontFormatOpt, 1},
 #endif
+#if !defined(DISABLE_GS)
+			{&gradLimitOpt, 1},
+#endif
+#if !defined(DISABLE_GS)
+			{&gradLodOpt, 1},
+#endif
+#if !defined(DISABLE_GS)
+			{&gradMeshOpt, 1},
+#endif
 #if !defined(DISABLE_GS)
 			{&gradOverlapOpt, 1},
 #endif
@@ -125,35 +170,54 @@ class CommandLine : public CL::CommandLine {
 			{&gradSimplifyOpt, 1},
 #endif
 			{&linkmarkOpt, 1},
+			{&multipageOpt, 1},
 			{&optimizeOpt, 1},
 			{&outputOpt, 1},
+			{&pageFramesOpt, 1},
 			{&precisionOpt, 1},
 			{&relativeOpt, 1},
 			{&stdoutOpt, 1},
+			{&streamPagesOpt, 1},
 			{&tmpdirOpt, 1},
 			{&noFontsOpt, 1},
 			{&noMergeOpt, 1},
 			{&noStylesOpt, 1},
 			{&zipOpt, 1},
+			{&zipRsyncableOpt, 1},
+			{&zipThreadsOpt, 1},
 			{&rotateOpt, 2},
 			{&scaleOpt, 2},
 			{&translateOpt, 2},
 			{&transformOpt, 2},
 			{&zoomOpt, 2},
+			{&affinityOpt, 3},
 			{&cacheOpt, 3},
+			{&cacheLimitOpt, 3},
+			{&cacheResultsOpt, 3},
 #if defined(TTFDEBUG)
 			{&debugGlyphsOpt, 3},
 #endif
 			{&exactBboxOpt, 3},
+			{&isolateSpecialsOpt, 3},
+			{&jobsOpt, 3},
+			{&jobserverOpt, 3},
 			{&keepOpt, 3},
 #if !defined(HAVE_LIBGS) && !defined(DISABLE_GS)
 			{&libgsOpt, 3},
 #endif
 			{&magOpt, 3},
+			{&manifestOpt, 3},
+			{&maxMemoryOpt, 3},
+			{&memStatsOpt, 3},
 			{&noMktexmfOpt, 3},
 			{&noSpecialsOpt, 3},
 			{&pageHashesOpt, 3},
+			{&prefetchFontsOpt, 3},
+			{&runStatsOpt, 3},
+			{&timeoutOpt, 3},
+			{&timingsOpt, 3},
 			{&traceAllOpt, 3},
+			{&watchOpt, 3},
 			{&colorOpt, 4},
 			{&helpOpt, 4},
 			{&listSpecialsOpt, 4},
@@ -0,0 +1,191 @@
+/*************************************************************************
+** ConversionContext.cpp                                                **
+**                                                                      **
+** This file is part of dvisvgm -- a fast DVI to SVG converter          **
+** Copyright (C) 2005-2024 Martin Gieseking <martin.gieseking@uos.de>   **
+**                                                                      **
+** This program is free software; you can redistribute it and/or        **
+** modify it under the terms of the GNU General Public License as       **
+** published by the Free Software Foundation; either version 3 of       **
+** the License, or (at your option) any later version.                  **
+**                                                                      **
+** This program is distributed in the hope that it will be useful, but  **
+** WITHOUT ANY WARRANTY; without even the implied warranty of           **
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the         **
+** GNU General Public License for more details.                         **
+**                                                                      **
+** You should have received a copy of the GNU General Public License    **
+** along with this program; if not, see <http://www.gnu.org/licenses/>. **
+*************************************************************************/
+
+#include <config.h>
+#include <cstring>
+#include "ConversionContext.hpp"
+#include "DVIActions.hpp"
+#include "DVIToSVG.hpp"
+#include "FileFinder.hpp"
+#include "Font.hpp"
+#include "FontManager.hpp"
+#include "FontMap.hpp"
+#include "HyperlinkManager.hpp"
+#include "MappedInputStream.hpp"
+#include "Message.hpp"
+#include "SpecialManager.hpp"
+#include "SVGOutput.hpp"
+#include "SVGTree.hpp"
+#include "XMLString.hpp"
+
+using namespace std;
+
+unsigned ConversionContext::_conversions = 0;
+mutex ConversionContext::_convMutex;
+
+
+/** Captures the current values of the static conversion options. */
+ConversionContext::Options ConversionContext::Options::capture () {
+	Options opts;
+	opts.useFonts = SVGTree::USE_FONTS;
+	opts.createStyles = SVGTree::CREATE_CSS;
+	opts.createUseElements = SVGTree::CREATE_USE_ELEMENTS;
+	opts.fontFormat = SVGTree::FONT_FORMAT;
+	opts.relativePathCommands = SVGTree::RELATIVE_PATH_CMDS;
+	opts.mergeChars = SVGTree::MERGE_CHARS;
+	opts.addComments = SVGTree::ADD_COMMENTS;
+	opts.embedBitmapData = SVGTree::EMBED_BITMAP_DATA;
+	opts.zoomFactor = SVGTree::ZOOM_FACTOR;
+	opts.precision = XMLString::DECIMAL_PLACES;
+	opts.exactBbox = PhysicalFont::EXACT_BBOX;
+	opts.metafontMag = PhysicalFont::METAFONT_MAG;
+	opts.cachePath = PhysicalFont::CACHE_PATH;
+	opts.messageLevel = Message::LEVEL;
+	return opts;
+}
+
+
+/** Copies the option values of this snapshot into the static variables
+ *  the pipeline classes read during conversion. */
+void ConversionContext::Options::apply () const {
+	SVGTree::USE_FONTS = useFonts;
+	SVGTree::CREATE_CSS = createStyles;
+	SVGTree::CREATE_USE_ELEMENTS = createUseElements;
+	SVGTree::FONT_FORMAT = fontFormat;
+	SVGTree::RELATIVE_PATH_CMDS = relativePathCommands;
+	SVGTree::MERGE_CHARS = mergeChars;
+	SVGTree::ADD_COMMENTS = addComments;
+	SVGTree::EMBED_BITMAP_DATA = embedBitmapData;
+	SVGTree::ZOOM_FACTOR = zoomFactor;
+	XMLString::DECIMAL_PLACES = precision;
+	PhysicalFont::EXACT_BBOX = exactBbox;
+	PhysicalFont::METAFONT_MAG = metafontMag;
+	PhysicalFont::CACHE_PATH = cachePath;
+	Message::LEVEL = messageLevel;
+}
+
+
+/** Applies an options snapshot for the lifetime of the object and restores
+ *  the previous static values afterwards, also if an exception is thrown. */
+class ScopedOptions {
+	public:
+		explicit ScopedOptions (const ConversionContext::Options &opts)
+			: _previous(ConversionContext::Options::capture())
+		{
+			opts.apply();
+		}
+
+		~ScopedOptions () {
+			_previous.apply();
+		}
+
+	private:
+		ConversionContext::Options _previous;
+};
+
+
+/** Initializes the process-wide file lookup machinery (kpathsea/MiKTeX).
+ *  The function is called implicitly by the first conversion but may be
+ *  called earlier to move the setup costs out of the first request. It's
+ *  idempotent, so embedding applications don't have to track whether the
+ *  frontend has already initialized the FileFinder.
+ *  @param[in] progname program name used for the kpathsea lookups
+ *  @param[in] enableMktexmf if true, missing font files may be generated by calling mktexmf */
+void ConversionContext::init (const string &progname, bool enableMktexmf) {
+	static bool initialized = false;
+	if (!initialized) {
+		initialized = true;
+		FileFinder::init(progname, "dvisvgm", enableMktexmf);
+	}
+}
+
+
+/** Loads the font map files the conversions are based on. Analogous to the
+ *  command-line frontend, the default map files are only parsed once per
+ *  process since their contents don't change between conversions. */
+void ConversionContext::loadFontMaps () const {
+	static bool mapsLoaded = false;
+	if (mapsLoaded)
+		return;
+	mapsLoaded = true;
+	bool additional = !_fontmapSeq.empty() && strchr("+-=", _fontmapSeq[0]);
+	if (_fontmapSeq.empty() || additional) {
+		bool found = false;
+		for (const string &mapfile : {"dvisvgm", "ps2pk", "pdftex", "dvipdfm", "psfonts"}) {
+			if ((found = FontMap::instance().read(mapfile+".map")))
+				break;
+		}
+		if (!found)
+			Message::wstream(true) << "none of the default map files could be found\n";
+	}
+	if (!_fontmapSeq.empty())
+		FontMap::instance().read(_fontmapSeq, true);
+}
+
+
+/** Converts the pages of a DVI stream to SVG.
+ *  @param[in] is stream providing the DVI data to convert
+ *  @param[in] out sink receiving the generated SVG pages
+ *  @param[in] range descriptor of the page ranges to convert, e.g. "1-3,5"
+ *  @return (number of converted pages, number of total pages) */
+pair<int,int> ConversionContext::convert (istream &is, SVGOutputBase &out, const string &range) {
+	init();
+	loadFontMaps();
+	// Conversions may be requested from multiple threads, but the pipeline still
+	// relies on process-wide components (fonts, specials, Ghostscript). They are
+	// therefore executed one at a time, each under its context's options snapshot
+	// which is reverted to the process defaults afterwards.
+	lock_guard<mutex> lock(_convMutex);
+	ScopedOptions scopedOptions(_options);
+	if (_conversions++ > 0) {
+		// drop the document-specific state left behind by the previous conversion;
+		// the shared read-only state (font maps, loaded fonts, kpathsea lookups,
+		// and the Ghostscript instance) stays warm across the documents
+		FontManager::instance().resetFontNumbers();
+		HyperlinkManager::instance().reset();
+		SpecialManager::instance().unregisterHandlers();
+	}
+	DVIToSVG dvi2svg(is, out);
+	const char *ignoredSpecials = nullptr;
+	if (!_ignoredSpecials.empty())
+		ignoredSpecials = _ignoredSpecials == "*" ? "*" : _ignoredSpecials.c_str();
+	DVIToSVG::setProcessSpecials(ignoredSpecials, false);
+	dvi2svg.setPageTransformation(_transCmds);
+	dvi2svg.setPageSize(_pageFormat);
+	dvi2svg.setUserMessage(_userMessage);
+	pair<int,int> pageinfo;
+	dvi2svg.convert(range, &pageinfo);
+	return pageinfo;
+}
+
+
+/** Converts the pages of a DVI document located in a memory buffer to SVG.
+ *  The buffer is read in place without an intermediate copy, so DVI data
+ *  received over RPC or assembled in memory can be converted directly. It
+ *  must stay valid and unchanged until the function returns.
+ *  @param[in] data start of the buffer holding the DVI data
+ *  @param[in] size number of bytes in the buffer
+ *  @param[in] out sink receiving the generated SVG pages
+ *  @param[in] range descriptor of the page ranges to convert, e.g. "1-3,5"
+ *  @return (number of converted pages, number of total pages) */
+pair<int,int> ConversionContext::convert (const char *data, size_t size, SVGOutputBase &out, const string &range) {
+	MemoryInputStream is(data, size);
+	return convert(is, out, range);
+}
@@ -0,0 +1,98 @@
+/*************************************************************************
+** ConversionContext.hpp                                                **
+**                                                                      **
+** This file is part of dvisvgm -- a fast DVI to SVG converter          **
+** Copyright (C) 2005-2024 Martin Gieseking <martin.gieseking@uos.de>   **
+**                                                                      **
+** This program is free software; you can redistribute it and/or        **
+** modify it under the terms of the GNU General Public License as       **
+** published by the Free Software Foundation; either version 3 of       **
+** the License, or (at your option) any later version.                  **
+**                                                                      **
+** This program is distributed in the hope that it will be useful, but  **
+** WITHOUT ANY WARRANTY; without even the implied warranty of           **
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the         **
+** GNU General Public License for more details.                         **
+**                                                                      **
+** You should have received a copy of the GNU General Public License    **
+** along with this program; if not, see <http://www.gnu.org/licenses/>. **
+*************************************************************************/
+
+#ifndef CONVERSIONCONTEXT_HPP
+#define CONVERSIONCONTEXT_HPP
+
+#include <cstddef>
+#include <istream>
+#include <mutex>
+#include <string>
+#include <utility>
+#include "FontWriter.hpp"
+
+struct SVGOutputBase;
+
+/** Embeddable entry point to the DVI-to-SVG pipeline (libdvisvgm).
+ *  While the command-line frontend drives the conversion through main(),
+ *  host applications can link against libdvisvgm and convert in-process:
+ *  create a context, adjust the options, and convert one or more DVI
+ *  streams into an SVGOutputBase sink. The expensive process-wide state
+ *  (kpathsea, the font map files, the Ghostscript instance, and the fonts
+ *  loaded by the FontManager) is set up lazily on the first conversion and
+ *  stays warm afterwards, so repeated conversions in a long-running process
+ *  don't pay the startup costs again. */
+class ConversionContext {
+	public:
+		/** Snapshot of the conversion options that are kept in static variables
+		 *  of the pipeline classes. The statics act as process-wide defaults set
+		 *  up by the command-line frontend; each context holds its own copy taken
+		 *  at construction time, which is applied for the duration of its
+		 *  conversions and reverted afterwards. This way, contexts with different
+		 *  settings can be used interleaved in the same process without
+		 *  clobbering each other's options. */
+		struct Options {
+			static Options capture ();
+			void apply () const;
+
+			bool useFonts;            ///< create font references instead of drawing the glyph paths directly?
+			bool createStyles;        ///< define and use CSS classes to reference the fonts?
+			bool createUseElements;   ///< allow the generation of <use/> elements?
+			FontWriter::FontFormat fontFormat;  ///< format of the fonts to be embedded
+			bool relativePathCommands;///< create relative rather than absolute SVG path commands?
+			bool mergeChars;          ///< merge chars with common properties into the same <text> element?
+			bool addComments;         ///< add comments with additional information?
+			bool embedBitmapData;     ///< embed bitmaps into the SVG documents?
+			double zoomFactor;        ///< factor applied to the width/height attributes
+			int precision;            ///< maximal number of decimal places of the coordinates
+			bool exactBbox;           ///< compute the precise bounding box of each glyph?
+			double metafontMag;       ///< magnification factor applied to Metafont calls
+			std::string cachePath;    ///< path of the glyph cache directory ("" = caching disabled)
+			int messageLevel;         ///< verbosity level of the messages printed during conversion
+		};
+
+	public:
+		ConversionContext () : _options(Options::capture()) {}
+		ConversionContext (const ConversionContext&) =delete;
+		Options& options ()  {return _options;}
+		void setPageFormat (const std::string &format)        {_pageFormat = format;}
+		void setPageTransformation (const std::string &cmds)  {_transCmds = cmds;}
+		void setUserMessage (const std::string &msg)          {_userMessage = msg;}
+		void setFontMapSequence (const std::string &mapseq)   {_fontmapSeq = mapseq;}
+		void ignoreSpecials (const std::string &prefixes="*") {_ignoredSpecials = prefixes;}
+		std::pair<int,int> convert (std::istream &is, SVGOutputBase &out, const std::string &range="1-");
+		std::pair<int,int> convert (const char *data, size_t size, SVGOutputBase &out, const std::string &range="1-");
+		static void init (const std::string &progname="dvisvgm", bool enableMktexmf=false);
+
+	protected:
+		void loadFontMaps () const;
+
+	private:
+		Options _options;              ///< per-context copy of the static conversion options
+		std::string _pageFormat;       ///< bounding box size/format string ("min" if empty)
+		std::string _transCmds;        ///< page transformation commands
+		std::string _userMessage;      ///< message printed after conversion of a page
+		std::string _fontmapSeq;       ///< sequence of font map files/entries to load
+		std::string _ignoredSpecials;  ///< comma-separated prefixes of specials to ignore
+		static unsigned _conversions;  ///< number of conversions started in this process
+		static std::mutex _convMutex;  ///< serializes the conversions of concurrently used contexts
+};
+
+#endif
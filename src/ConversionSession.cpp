@@ -0,0 +1,89 @@
+/*************************************************************************
+** ConversionSession.cpp                                                **
+**                                                                      **
+** This file is part of dvisvgm -- a fast DVI to SVG converter          **
+** Copyright (C) 2005-2024 Martin Gieseking <martin.gieseking@uos.de>   **
+**                                                                      **
+** This program is free software; you can redistribute it and/or        **
+** modify it under the terms of the GNU General Public License as       **
+** published by the Free Software Foundation; either version 3 of       **
+** the License, or (at your option) any later version.                  **
+**                                                                      **
+** This program is distributed in the hope that it will be useful, but  **
+** WITHOUT ANY WARRANTY; without even the implied warranty of           **
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the         **
+** GNU General Public License for more details.                         **
+**                                                                      **
+** You should have received a copy of the GNU General Public License    **
+** along with this program; if not, see <http://www.gnu.org/licenses/>. **
+*************************************************************************/
+
+#include <config.h>
+#include <fstream>
+#include "ConversionSession.hpp"
+#include "Font.hpp"
+#include "ImageToSVG.hpp"
+#include "MessageException.hpp"
+
+using namespace std;
+
+
+/** Enables the store keeping the SVG results of converted EPS/PDF figures
+ *  across the documents of the session. Documents embedding the same figure
+ *  then reuse the stored conversion result instead of running the PS
+ *  interpreter again.
+ *  @param[in] dirname directory the conversion results are stored in
+ *  @param[in] optionsHash hash of the options affecting the SVG output,
+ *    used to invalidate stored results created with different settings */
+void ConversionSession::enableResultStore (const string &dirname, const string &optionsHash) {
+	ImageToSVG::RESULT_STORE_DIR = dirname;
+	ImageToSVG::OPTIONS_HASH = optionsHash;
+}
+
+
+/** Converts the pages of a DVI file to SVG.
+ *  @param[in] fname name/path of the DVI file to convert
+ *  @param[in] out sink receiving the generated SVG pages
+ *  @param[in] range descriptor of the page ranges to convert, e.g. "1-3,5"
+ *  @return (number of converted pages, number of total pages) */
+pair<int,int> ConversionSession::convertFile (const string &fname, SVGOutputBase &out, const string &range) {
+	ifstream ifs(fname, ios::binary);
+	if (!ifs)
+		throw MessageException("can't open file '"+fname+"' for reading");
+	return convertStream(ifs, out, range);
+}
+
+
+/** Converts the pages of a DVI stream to SVG.
+ *  @param[in] is stream providing the DVI data to convert
+ *  @param[in] out sink receiving the generated SVG pages
+ *  @param[in] range descriptor of the page ranges to convert, e.g. "1-3,5"
+ *  @return (number of converted pages, number of total pages) */
+pair<int,int> ConversionSession::convertStream (istream &is, SVGOutputBase &out, const string &range) {
+	_numDocuments++;
+	return _context.convert(is, out, range);
+}
+
+
+/** Converts the pages of a DVI document located in a memory buffer to SVG.
+ *  The buffer is read in place without a copy and must stay valid and
+ *  unchanged until the function returns.
+ *  @param[in] data start of the buffer holding the DVI data
+ *  @param[in] size number of bytes in the buffer
+ *  @param[in] out sink receiving the generated SVG pages
+ *  @param[in] range descriptor of the page ranges to convert, e.g. "1-3,5"
+ *  @return (number of converted pages, number of total pages) */
+pair<int,int> ConversionSession::convertBuffer (const char *data, size_t size, SVGOutputBase &out, const string &range) {
+	_numDocuments++;
+	return _context.convert(data, size, out, range);
+}
+
+
+/** Releases the memory-intensive parts of the warm state, i.e. the glyph
+ *  outlines cached by the fonts. They are re-read from the font cache files
+ *  when needed again, so dropping them between batches trades a bit of
+ *  rewarming time for memory. The font map entries and the font objects
+ *  themselves stay available. */
+void ConversionSession::releaseWarmState () {
+	PhysicalFont::releaseCachedGlyphs();
+}
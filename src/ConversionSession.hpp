@@ -0,0 +1,55 @@
+/*************************************************************************
+** ConversionSession.hpp                                                **
+**                                                                      **
+** This file is part of dvisvgm -- a fast DVI to SVG converter          **
+** Copyright (C) 2005-2024 Martin Gieseking <martin.gieseking@uos.de>   **
+**                                                                      **
+** This program is free software; you can redistribute it and/or        **
+** modify it under the terms of the GNU General Public License as       **
+** published by the Free Software Foundation; either version 3 of       **
+** the License, or (at your option) any later version.                  **
+**                                                                      **
+** This program is distributed in the hope that it will be useful, but  **
+** WITHOUT ANY WARRANTY; without even the implied warranty of           **
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the         **
+** GNU General Public License for more details.                         **
+**                                                                      **
+** You should have received a copy of the GNU General Public License    **
+** along with this program; if not, see <http://www.gnu.org/licenses/>. **
+*************************************************************************/
+
+#ifndef CONVERSIONSESSION_HPP
+#define CONVERSIONSESSION_HPP
+
+#include <string>
+#include <utility>
+#include "ConversionContext.hpp"
+
+/** Batch conversion of multiple documents sharing the warm process state.
+ *  Converting N documents through separate processes re-traces the shared
+ *  fonts and re-reads shared figures N times. A session keeps the state
+ *  that's independent of a particular document — the font map entries, the
+ *  fonts and glyphs loaded by the FontManager, the parsed CMaps, the
+ *  kpathsea lookup results, and the EPS/PDF result store — warm across the
+ *  documents of a batch, so each font is looked up, parsed, and traced only
+ *  once per session no matter how many documents reference it. The shared
+ *  components are read-mostly after warmup; concurrent convert calls are
+ *  serialized by the underlying ConversionContext. */
+class ConversionSession {
+	public:
+		ConversionSession () =default;
+		ConversionSession (const ConversionSession&) =delete;
+		ConversionContext& context ()  {return _context;}
+		void enableResultStore (const std::string &dirname, const std::string &optionsHash);
+		std::pair<int,int> convertFile (const std::string &fname, SVGOutputBase &out, const std::string &range="1-");
+		std::pair<int,int> convertStream (std::istream &is, SVGOutputBase &out, const std::string &range="1-");
+		std::pair<int,int> convertBuffer (const char *data, size_t size, SVGOutputBase &out, const std::string &range="1-");
+		void releaseWarmState ();
+		unsigned numDocuments () const  {return _numDocuments;}
+
+	private:
+		ConversionContext _context;   ///< context holding the conversion options of the batch
+		unsigned _numDocuments=0;     ///< number of documents converted in this session
+};
+
+#endif
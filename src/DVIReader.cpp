@@ -27,6 +27,7 @@
 #include "Font.hpp"
 #include "FontManager.hpp"
 #include "HashFunction.hpp"
+#include "MappedInputStream.hpp"
 #include "utility.hpp"
 
 using namespace std;
@@ -87,10 +88,18 @@ bool DVIReader::computePageHash (size_t pageno, HashFunction &hashFunc) {
 
 	hashFunc.reset();
 	clearStream();
-	seek(_bopOffsets[pageno-1]+45);  // now on first command after bop of selected page
+	auto start = size_t(_bopOffsets[pageno-1]+45);       // offset of first command after bop of selected page
+	size_t numBytes = numberOfPageBytes(pageno-1)-46;    // number of bytes excluding bop and eop
+	// If the DVI data is mapped into memory, hash the page bytes directly from
+	// the mapped window instead of copying them through the stream buffer.
+	auto *mis = dynamic_cast<MappedInputStream*>(&getInputStream());
+	if (mis && mis->mapped() && start+numBytes <= mis->size()) {
+		hashFunc.update(mis->data()+start, numBytes);
+		return true;
+	}
+	seek(streampos(start));
 	const size_t BUFSIZE = 4096;
 	char buf[BUFSIZE];
-	size_t numBytes = numberOfPageBytes(pageno-1)-46;  // number of bytes excluding bop and eop
 	while (numBytes > 0) {
 		getInputStream().read(buf, min(numBytes, BUFSIZE));
 		hashFunc.update(buf, getInputStream().gcount());
@@ -184,6 +193,8 @@ void DVIReader::cmdEop (int) {
 void DVIReader::cmdPush (int) {
 	_stateStack.push(_dviState);
 	dviPush();
+	if (_vfRecorder)
+		recordVFOp(VFCharOp::Type::PUSH);
 }
 
 
@@ -194,49 +205,150 @@ void DVIReader::cmdPop (int) {
 	_dviState = _stateStack.top();
 	_stateStack.pop();
 	dviPop();
+	if (_vfRecorder)
+		recordVFOp(VFCharOp::Type::POP);
 }
 
 
 /** Helper function that handles charaters from virtual fonts (VF).
- *  It is called by the cmdSetChar and cmdPutChar methods.
+ *  It is called by the cmdSetChar and cmdPutChar methods. The expansion of each
+ *  (font, char) pair is recorded during its first interpretation; further
+ *  occurrences of the character replay the recorded op sequence instead of
+ *  re-interpreting the DVI packet.
  *  @param[in] font current font (corresponding to _currFontNum)
  *  @param[in] c character to typeset */
 void DVIReader::putVFChar (Font *font, uint32_t c) {
-	if (auto vf = font_cast<VirtualFont*>(font)) { // is current font a virtual font?
-		FontManager &fm = FontManager::instance();
-		const auto *dvi = vf->getDVI(c);    // try to get DVI snippet that represents character c
-		Font *firstFont = fm.vfFirstFont(vf);
-		if (!dvi) {
-			const FontMetrics *ffm = firstFont ? firstFont->getMetrics() : nullptr;
-			if (!ffm || (!ffm->isJFM() && !ffm->isOFM()))
-				return;
+	auto vf = font_cast<VirtualFont*>(font);
+	if (!vf)  // current font not a virtual font?
+		return;
+	if (_vfRecorder) {
+		// A character of a nested virtual font is executed while an expansion is being
+		// recorded. Its ops refer to the font number context of the inner font and thus
+		// can't be replayed from the outer expansion => drop the recording.
+		_vfRecorder->valid = false;
+		execVFChar(vf, c, nullptr);
+	}
+	else {
+		VFCharExpansion &expansion = _vfCharExpansions[make_pair(static_cast<const VirtualFont*>(vf), c)];
+		if (!expansion.recorded)
+			execVFChar(vf, c, &expansion);
+		else if (expansion.valid)
+			replayVFChar(vf, expansion);
+		else
+			execVFChar(vf, c, nullptr);
+	}
+}
+
+
+/** Interprets the DVI packet of a virtual font character and optionally records
+ *  the sequence of executed operations.
+ *  @param[in] vf virtual font the character belongs to
+ *  @param[in] c character to typeset
+ *  @param[in] expansion if not null, the executed operations are recorded here */
+void DVIReader::execVFChar (VirtualFont *vf, uint32_t c, VFCharExpansion *expansion) {
+	FontManager &fm = FontManager::instance();
+	const auto *dvi = vf->getDVI(c);    // try to get DVI snippet that represents character c
+	Font *firstFont = fm.vfFirstFont(vf);
+	if (!dvi) {
+		const FontMetrics *ffm = firstFont ? firstFont->getMetrics() : nullptr;
+		if (!ffm || (!ffm->isJFM() && !ffm->isOFM()))
+			return;
+	}
+	fm.enterVF(vf);                              // enter VF font number context
+	int savedFontNum = _currFontNum;             // save current font number
+	setFont(fm.vfFirstFontNum(vf), SetFontMode::VF_ENTER);
+	if (!dvi) {                                  // no definition present for current (Japanese) char?
+		dviPutChar(c, firstFont);                 // fallback for JFM-based virtual fonts
+		if (expansion) {
+			VFCharOp op;
+			op.type = VFCharOp::Type::PUTCHAR;
+			op.dir = _dviState.d;
+			op.code = c;
+			op.font = firstFont;
+			expansion->ops.push_back(std::move(op));
 		}
-		fm.enterVF(vf);                              // enter VF font number context
-		int savedFontNum = _currFontNum;             // save current font number
-		setFont(fm.vfFirstFontNum(vf), SetFontMode::VF_ENTER);
-		if (!dvi)                                    // no definition present for current (Japanese) char?
-			dviPutChar(c, firstFont);                 // fallback for JFM-based virtual fonts
-		else {
-			// DVI units in virtual fonts are multiples of 1^(-20) times the scaled size of the VF
-			double savedScale = _dvi2bp;
-			_dvi2bp = vf->scaledSize()/(1 << 20);
-			DVIState savedState = _dviState;  // save current cursor position
-			_dviState.x = _dviState.y = _dviState.w = _dviState.z = 0;
-			ivectorstream<vector<char>> vis(*dvi);
-			auto &is = replaceStream(vis);
-			try {
-				executeAll();  // execute DVI fragment
-			}
-			catch (const DVIException &e) {
-				// Message::estream(true) << "invalid dvi in vf: " << e.getMessage() << endl; // @@
-			}
-			replaceStream(is);       // restore previous input stream
-			_dviState = savedState;  // restore previous cursor position
-			_dvi2bp = savedScale;    // restore previous scale factor
+	}
+	else {
+		// DVI units in virtual fonts are multiples of 1^(-20) times the scaled size of the VF
+		double savedScale = _dvi2bp;
+		_dvi2bp = vf->scaledSize()/(1 << 20);
+		DVIState savedState = _dviState;  // save current cursor position
+		_dviState.x = _dviState.y = _dviState.w = _dviState.z = 0;
+		if (expansion) {
+			_vfRecorder = expansion;
+			_vfOriginH = _dviState.h;
+			_vfOriginV = _dviState.v;
+		}
+		ivectorstream<vector<char>> vis(*dvi);
+		auto &is = replaceStream(vis);
+		try {
+			executeAll();  // execute DVI fragment
+		}
+		catch (const DVIException &e) {
+			// Message::estream(true) << "invalid dvi in vf: " << e.getMessage() << endl; // @@
+		}
+		if (expansion)
+			_vfRecorder = nullptr;
+		replaceStream(is);       // restore previous input stream
+		_dviState = savedState;  // restore previous cursor position
+		_dvi2bp = savedScale;    // restore previous scale factor
+	}
+	if (expansion)
+		expansion->recorded = true;
+	fm.leaveVF();          // restore previous font number context
+	setFont(savedFontNum, SetFontMode::VF_LEAVE);  // restore previous font number
+}
+
+
+/** Replays the previously recorded expansion of a virtual font character. The
+ *  recorded operations invoke the same template methods as the interpretation
+ *  of the character's DVI packet but without parsing the byte code again.
+ *  @param[in] vf virtual font the character belongs to
+ *  @param[in] expansion recorded operation sequence */
+void DVIReader::replayVFChar (VirtualFont *vf, const VFCharExpansion &expansion) {
+	FontManager &fm = FontManager::instance();
+	fm.enterVF(vf);                              // enter VF font number context
+	int savedFontNum = _currFontNum;             // save current font number
+	setFont(fm.vfFirstFontNum(vf), SetFontMode::VF_ENTER);
+	double savedScale = _dvi2bp;
+	_dvi2bp = vf->scaledSize()/(1 << 20);
+	DVIState savedState = _dviState;  // save current cursor position
+	_dviState.x = _dviState.y = _dviState.w = _dviState.z = 0;
+	for (const VFCharOp &op : expansion.ops) {
+		_dviState.h = savedState.h + op.h;
+		_dviState.v = savedState.v + op.v;
+		_dviState.d = op.dir;
+		switch (op.type) {
+			case VFCharOp::Type::SETCHAR0: dviSetChar0(op.code, op.font); break;
+			case VFCharOp::Type::SETCHAR:  dviSetChar(op.code, op.font); break;
+			case VFCharOp::Type::PUTCHAR:  dviPutChar(op.code, op.font); break;
+			case VFCharOp::Type::SETRULE:  dviSetRule(op.height, op.width); break;
+			case VFCharOp::Type::PUTRULE:  dviPutRule(op.height, op.width); break;
+			case VFCharOp::Type::PUSH:     dviPush(); break;
+			case VFCharOp::Type::POP:      dviPop(); break;
+			case VFCharOp::Type::DIR:      dviDir(op.dir); break;
+			case VFCharOp::Type::FONTNUM:  setFont(int(op.code), op.mode); break;
 		}
-		fm.leaveVF();          // restore previous font number context
-		setFont(savedFontNum, SetFontMode::VF_LEAVE);  // restore previous font number
 	}
+	_dviState = savedState;  // restore previous cursor position
+	_dvi2bp = savedScale;    // restore previous scale factor
+	fm.leaveVF();            // restore previous font number context
+	setFont(savedFontNum, SetFontMode::VF_LEAVE);  // restore previous font number
+}
+
+
+/** Appends an operation to the virtual font character expansion currently being
+ *  recorded. The cursor position is stored relative to the character origin.
+ *  @param[in] type type of the operation to append
+ *  @return reference to the new entry to fill in op-specific values */
+DVIReader::VFCharOp& DVIReader::recordVFOp (VFCharOp::Type type) {
+	_vfRecorder->ops.emplace_back();
+	VFCharOp &op = _vfRecorder->ops.back();
+	op.type = type;
+	op.h = _dviState.h - _vfOriginH;
+	op.v = _dviState.v - _vfOriginV;
+	op.dir = _dviState.d;
+	return op;
 }
 
 
@@ -249,6 +361,11 @@ void DVIReader::cmdSetChar0 (int c) {
 		throw DVIException("setchar outside of page");
 	Font *font = FontManager::instance().getFont(_currFontNum);
 	dviSetChar0(c, font); // template method that may trigger further actions
+	if (_vfRecorder) {
+		VFCharOp &op = recordVFOp(VFCharOp::Type::SETCHAR0);
+		op.code = uint32_t(c);
+		op.font = font;
+	}
 	putVFChar(font, c);   // further character processing if current font is a virtual font
 	moveRight(font->charWidth(c)*font->scaleFactor()*_mag/1000.0, MoveMode::SETCHAR);
 }
@@ -266,6 +383,11 @@ void DVIReader::cmdSetChar (int len) {
 	uint32_t c = readUnsigned(len); // if len == 4 c may be signed
 	Font *font = FontManager::instance().getFont(_currFontNum);
 	dviSetChar(c, font); // template method that may trigger further actions
+	if (_vfRecorder) {
+		VFCharOp &op = recordVFOp(VFCharOp::Type::SETCHAR);
+		op.code = c;
+		op.font = font;
+	}
 	putVFChar(font, c);  // further character processing if current font is a virtual font
 	moveRight(font->charWidth(c)*font->scaleFactor()*_mag/1000.0, MoveMode::SETCHAR);
 }
@@ -283,6 +405,11 @@ void DVIReader::cmdPutChar (int len) {
 	int32_t c = readUnsigned(len);
 	Font *font = FontManager::instance().getFont(_currFontNum);
 	dviPutChar(c, font);
+	if (_vfRecorder) {
+		VFCharOp &op = recordVFOp(VFCharOp::Type::PUTCHAR);
+		op.code = uint32_t(c);
+		op.font = font;
+	}
 	putVFChar(font, c);
 }
 
@@ -297,6 +424,11 @@ void DVIReader::cmdSetRule (int) {
 	double height = _dvi2bp*readSigned(4);
 	double width  = _dvi2bp*readSigned(4);
 	dviSetRule(height, width);
+	if (_vfRecorder) {
+		VFCharOp &op = recordVFOp(VFCharOp::Type::SETRULE);
+		op.height = height;
+		op.width = width;
+	}
 	moveRight(width, MoveMode::CHANGEPOS);
 }
 
@@ -311,6 +443,11 @@ void DVIReader::cmdPutRule (int) {
 	double height = _dvi2bp*readSigned(4);
 	double width  = _dvi2bp*readSigned(4);
 	dviPutRule(height, width);
+	if (_vfRecorder) {
+		VFCharOp &op = recordVFOp(VFCharOp::Type::PUTRULE);
+		op.height = height;
+		op.width = width;
+	}
 }
 
 
@@ -395,6 +532,8 @@ void DVIReader::cmdDir (int) {
 		throw DVIException("invalid writing mode value " + std::to_string(wmode) + " (0, 1, 3, or 4 expected)");
 	_dviState.d = (WritingMode)wmode;
 	dviDir(_dviState.d);
+	if (_vfRecorder)
+		recordVFOp(VFCharOp::Type::DIR);
 }
 
 
@@ -403,6 +542,11 @@ void DVIReader::cmdXXX (int len) {
 		throw DVIException("special outside of page");
 	uint32_t numBytes = readUnsigned(len);
 	string str = readString(numBytes);
+	if (_vfRecorder) {
+		// specials may depend on and modify state outside the DVI registers,
+		// so an expansion containing them isn't replayed
+		_vfRecorder->valid = false;
+	}
 	dviXXX(str);
 }
 
@@ -415,6 +559,12 @@ void DVIReader::setFont (int fontnum, SetFontMode mode) {
 	if (const Font *font = FontManager::instance().getFont(fontnum)) {
 		_currFontNum = fontnum;
 		dviFontNum(uint32_t(fontnum), mode, font);
+		if (_vfRecorder) {
+			VFCharOp &op = recordVFOp(VFCharOp::Type::FONTNUM);
+			op.code = uint32_t(fontnum);
+			op.font = font;
+			op.mode = mode;
+		}
 	}
 	else
 		throw DVIException("undefined font number " + std::to_string(fontnum));
@@ -515,6 +665,8 @@ void DVIReader::cmdFontDef (int len) {
 	string fontname   = readString(namelen);
 	const Font *font  = defineFont(fontnum, fontname, checksum, dsize*_dvi2bp, ssize*_dvi2bp);
 	dviFontDef(fontnum, checksum, font);
+	if (_vfRecorder)  // font definitions aren't covered by the recorded op set
+		_vfRecorder->valid = false;
 }
 
 
@@ -542,6 +694,8 @@ void DVIReader::defineVFChar (uint32_t c, vector<char> &&dvi) {
 /** XDV extension: includes image or pdf file.
  *  parameters: box[1] matrix[4][6] p[2] len[2] path[l] */
 void DVIReader::cmdXPic (int) {
+	if (_vfRecorder)  // picture inclusions aren't covered by the recorded op set
+		_vfRecorder->valid = false;
 	uint8_t box = readUnsigned(1);    // box
 	vector<int32_t> matrix(6);
 	for (int i=0; i < 6; i++)       // matrix
@@ -555,6 +709,8 @@ void DVIReader::cmdXPic (int) {
 
 /** XDV extension: defines a native font */
 void DVIReader::cmdXFontDef (int) {
+	if (_vfRecorder)  // native font definitions aren't covered by the recorded op set
+		_vfRecorder->valid = false;
 	int32_t fontnum = readSigned(4);
 	double ptsize = _dvi2bp*readUnsigned(4);
 	uint16_t flags = readUnsigned(2);
@@ -680,6 +836,8 @@ void DVIReader::cmdXTextAndGlyphs (int) {
  *  @param[out] glyphs FreeType indices of the glyphs to typeset
  *  @return total width of the glyph array */
 double DVIReader::putGlyphArray (bool xonly, vector<double> &dx, vector<double> &dy, vector<uint16_t> &glyphs) {
+	if (_vfRecorder)  // native font glyphs aren't covered by the recorded op set
+		_vfRecorder->valid = false;
 	double strwidth = _dvi2bp*readSigned(4);
 	uint16_t num_glyphs = readUnsigned(2);
 	dx.resize(num_glyphs);
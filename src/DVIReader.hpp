@@ -50,6 +50,29 @@ class DVIReader : public BasicDVIReader, public VFActions {
 			void reset () {h = v = x = w = y = z = 0.0; d=WritingMode::LR;}
 		};
 
+		/** Single operation of a recorded virtual font character expansion. Each entry
+		 *  stores the cursor state present when the operation was executed, relative to
+		 *  the origin of the character, so replaying it doesn't require interpreting the
+		 *  DVI byte code of the character packet again. */
+		struct VFCharOp {
+			enum class Type {SETCHAR0, SETCHAR, PUTCHAR, SETRULE, PUTRULE, PUSH, POP, DIR, FONTNUM};
+			Type type=Type::SETCHAR0;
+			double h=0, v=0;           ///< cursor position relative to the character origin
+			WritingMode dir=WritingMode::LR;  ///< writing direction active when the op was executed
+			uint32_t code=0;           ///< character code or font number
+			const Font *font=nullptr;  ///< font the op refers to
+			double height=0, width=0;  ///< dimensions of a rule
+			SetFontMode mode=SetFontMode::SF_SHORT;  ///< mode of a font change
+		};
+
+		/** Expansion of a (virtual font, character) pair recorded during the first
+		 *  interpretation of the character's DVI packet. */
+		struct VFCharExpansion {
+			std::vector<VFCharOp> ops;
+			bool recorded=false;  ///< true if the packet has been interpreted and recorded before
+			bool valid=true;      ///< false if the packet contains ops that can't be replayed reliably
+		};
+
 	public:
 		explicit DVIReader (std::istream &is);
 		bool executeDocument ();
@@ -68,6 +91,9 @@ class DVIReader : public BasicDVIReader, public VFActions {
 		virtual void moveRight (double dx, MoveMode mode);
 		virtual void moveDown (double dy, MoveMode mode);
 		void putVFChar (Font *font, uint32_t c);
+		void execVFChar (VirtualFont *vf, uint32_t c, VFCharExpansion *expansion);
+		void replayVFChar (VirtualFont *vf, const VFCharExpansion &expansion);
+		VFCharOp& recordVFOp (VFCharOp::Type type);
 		double putGlyphArray (bool xonly, std::vector<double> &dx, std::vector<double> &dy, std::vector<uint16_t> &glyphs);
 		const Font* defineFont (uint32_t fontnum, const std::string &name, uint32_t cs, double dsize, double ssize);
 		void setFont (int num, SetFontMode mode);
@@ -163,6 +189,12 @@ class DVIReader : public BasicDVIReader, public VFActions {
 		DVIState _dviState;          ///< current state of the DVI registers
 		std::stack<DVIState> _stateStack;
 		std::vector<uint32_t> _bopOffsets;
+		VFCharExpansion *_vfRecorder=nullptr;  ///< VF char expansion currently being recorded (nullptr = no recording)
+		double _vfOriginH=0, _vfOriginV=0;     ///< char origin the positions of the recorded ops refer to
+		/** Caches the expanded DVI packets of the virtual font characters used in the
+		 *  document, keyed by font and character code. Frequently typeset VF characters
+		 *  are replayed from the recorded op sequence instead of being re-interpreted. */
+		std::map<std::pair<const VirtualFont*,uint32_t>, VFCharExpansion> _vfCharExpansions;
 };
 
 #endif
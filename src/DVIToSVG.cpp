@@ -19,10 +19,13 @@
 *************************************************************************/
 
 #include <config.h>
+#include <chrono>
 #include <cstdlib>
 #include <ctime>
 #include <fstream>
+#include <unordered_set>
 #include <iomanip>
+#include <iostream>
 #include <set>
 #include <sstream>
 #include "Calculator.hpp"
@@ -31,15 +34,21 @@
 #include "FileSystem.hpp"
 #include "Font.hpp"
 #include "FontManager.hpp"
+#include "FontWriter.hpp"
 #include "GlyphTracerMessages.hpp"
 #include "InputBuffer.hpp"
 #include "InputReader.hpp"
+#include "MemoryStats.hpp"
+#include "PageHashIndex.hpp"
 #include "PageRanges.hpp"
 #include "PageSize.hpp"
+#include "PageTimeout.hpp"
 #include "PreScanDVIReader.hpp"
-#include "SignalHandler.hpp"
 #include "optimizer/SVGOptimizer.hpp"
 #include "SVGOutput.hpp"
+#include "System.hpp"
+#include "ThreadPool.hpp"
+#include "Timing.hpp"
 #include "utility.hpp"
 #include "version.hpp"
 #include "XXHashFunction.hpp"
@@ -54,8 +63,12 @@
 #include "HtmlSpecialHandler.hpp"
 #include "PapersizeSpecialHandler.hpp"
 #include "PdfSpecialHandler.hpp"
+#ifndef DISABLE_GS
+	#include "PsSpecialHandler.hpp"
+#endif
 #include "PsSpecialHandlerProxy.hpp"
 #include "TpicSpecialHandler.hpp"
+#include "Tracepoints.hpp"
 
 ///////////////////////////////////
 
@@ -65,8 +78,18 @@ using namespace std;
  *  'm': trace missing glyphs, i.e. glyphs not yet cached
  *   0 : only trace actually required glyphs */
 char DVIToSVG::TRACE_MODE = 0;
+bool DVIToSVG::PREFETCH_FONTS = false;
 bool DVIToSVG::COMPUTE_PROGRESS = false;
+bool DVIToSVG::COMBINE_PAGES = false;
+unsigned DVIToSVG::NUM_JOBS = 1;
+string DVIToSVG::FONT_CSS_FILE;
+string DVIToSVG::PAGE_MANIFEST_FILE;
+size_t DVIToSVG::MAX_MEMORY_BYTES = 0;
 DVIToSVG::HashSettings DVIToSVG::PAGE_HASH_SETTINGS;
+mutex DVIToSVG::_conversionMutex;
+unique_ptr<PageHashIndex> DVIToSVG::_hashIndex;
+vector<DVIToSVG::ManifestEntry> DVIToSVG::_manifestEntries;
+mutex DVIToSVG::_manifestMutex;
 
 
 DVIToSVG::DVIToSVG (istream &is, SVGOutputBase &out)
@@ -77,6 +100,19 @@ DVIToSVG::DVIToSVG (istream &is, SVGOutputBase &out)
 }
 
 
+/** Returns the number of nodes of an XML subtree including its root node. */
+static long long count_nodes (const XMLNode *node) {
+	if (!node)
+		return 0;
+	long long count=1;
+	if (const XMLElement *elem = node->toElement()) {
+		for (const XMLNode *child=elem->firstChild(); child; child = child->next())
+			count += count_nodes(child);
+	}
+	return count;
+}
+
+
 /** Starts the conversion process.
  *  @param[in] first number of first page to convert
  *  @param[in] last number of last page to convert
@@ -92,9 +128,27 @@ void DVIToSVG::convert (unsigned first, unsigned last, HashFunction *hashFunc) {
 		throw DVIException(oss.str());
 	}
 	last = min(last, numberOfPages());
-	bool computeHashes = (hashFunc && !_out.ignoresHashes());
+	if (COMBINE_PAGES) {
+		// page hashes are bound to the one-file-per-page layout, so they don't
+		// apply to the combined document
+		convertCombined(first, last);
+		return;
+	}
+	// Pages skipped due to unchanged hashes wouldn't contribute their characters
+	// to the shared font CSS file, so the hashes are ignored in that mode.
+	bool computeHashes = (hashFunc && !_out.ignoresHashes() && FONT_CSS_FILE.empty());
 	string shortenedOptHash = XXH32HashFunction(PAGE_HASH_SETTINGS.optionsHash()).digestString();
+	// maximum number of finished pages whose optimization and serialization may
+	// still be in flight; bounds the memory held by the detached page documents
+	const size_t MAX_PENDING_PAGES = 3;
 	for (unsigned i=first; i <= last; ++i) {
+		// Report the pages whose background processing has finished in the meantime,
+		// and wait for the oldest one if the maximum number of pages in flight is reached.
+		while (!_pendingPages.empty()
+				&& (_pendingPages.size() >= MAX_PENDING_PAGES
+					|| _pendingPages.front()->written.wait_for(chrono::seconds(0)) == future_status::ready)) {
+			finishPendingPage();
+		}
 		string dviHash, combinedHash;
 		if (computeHashes) {
 			computePageHash(i, *hashFunc);
@@ -102,38 +156,288 @@ void DVIToSVG::convert (unsigned first, unsigned last, HashFunction *hashFunc) {
 			hashFunc->update(PAGE_HASH_SETTINGS.optionsHash());
 			combinedHash = hashFunc->digestString();
 		}
-		const SVGOutput::HashTriple hashTriple(dviHash, shortenedOptHash, std::move(combinedHash));
+		const SVGOutput::HashTriple hashTriple(dviHash, shortenedOptHash, combinedHash);
 		FilePath path = _out.filepath(i, numberOfPages(), hashTriple);
-		if (!dviHash.empty() && !PAGE_HASH_SETTINGS.isSet(HashSettings::P_REPLACE) && path.exists()) {
+		if (computeHashes && _hashIndex && !PAGE_HASH_SETTINGS.isSet(HashSettings::P_REPLACE)
+				&& _hashIndex->unchanged(i, dviHash, shortenedOptHash)) {
+			Message::mstream(false, Message::MC_PAGE_NUMBER) << "skipping page " << i;
+			Message::mstream().indent(1);
+			Message::mstream(false, Message::MC_PAGE_WRITTEN) << "\nhashes of file " << _hashIndex->filename(i) << " unchanged\n";
+			Message::mstream().indent(0);
+			if (!PAGE_MANIFEST_FILE.empty()) {
+				string fname = _hashIndex->filename(i);
+				addManifestEntry(i, combinedHash, fname, FileSystem::filesize(fname), 0, false);
+			}
+		}
+		else if (!dviHash.empty() && !PAGE_HASH_SETTINGS.isSet(HashSettings::P_REPLACE) && path.exists()) {
 			Message::mstream(false, Message::MC_PAGE_NUMBER) << "skipping page " << i;
 			Message::mstream().indent(1);
 			Message::mstream(false, Message::MC_PAGE_WRITTEN) << "\nfile " << path.shorterAbsoluteOrRelative() << " exists\n";
 			Message::mstream().indent(0);
+			if (!PAGE_MANIFEST_FILE.empty())
+				addManifestEntry(i, combinedHash, path.absolute(), FileSystem::filesize(path.absolute()), 0, false);
 		}
 		else {
-			executePage(i);
-			SVGOptimizer(_svg).execute();
-			embedFonts(_svg.rootNode());
-			bool success = _svg.write(_out.getPageStream(currentPageNumber(), numberOfPages(), hashTriple));
-			_out.finish();
-			string fname = path.shorterAbsoluteOrRelative();
-			if (fname.empty())
-				fname = "<stdout>";
-			if (!success)
-				Message::wstream(true) << "failed to write output to " << fname << '\n';
-			else {
-				Message::mstream(false, Message::MC_PAGE_WRITTEN) << "\noutput written to " << fname << '\n';
-				if (!_userMessage.empty()) {
-					if (auto specialActions = dynamic_cast<SpecialActions*>(_actions.get())) {
-						string msg = specialActions->expandText(_userMessage);
-						Message::ustream(true) << msg << "\n";
-					}
+			auto pageStartTime = chrono::steady_clock::now();
+			string userMessage;
+			function<void ()> appendFontFaces;
+			bool timedOut = false;
+			{
+				// The DVI commands and specials are evaluated by process-wide components
+				// (e.g. FontManager and the special handlers) which aren't thread-safe yet.
+				// Thus, the page execution must be serialized if multiple conversion threads
+				// are active, while the optimization, serialization, and compression of the
+				// finished pages below may run concurrently.
+				unique_lock<mutex> lock(_conversionMutex, defer_lock);
+				if (NUM_JOBS > 1)
+					lock.lock();
+				PageTimeout::start();
+				try {
+					Timing::Scope timer("pages");
+					Timing::Scope pageTimer(Timing::TRACING ? "page:"+to_string(i) : (Timing::ENABLED ? "execute" : string()), i);
+					DVISVGM_PROBE1(page_begin, i);
+					executePage(i);
+					DVISVGM_PROBE1(page_end, i);
+				}
+				catch (TimeoutException &e) {
+					timedOut = true;
+				}
+				catch (MessageException &e) {
+					// A Ghostscript interrupt triggered by the poll callback surfaces
+					// as a PSException; any error not caused by the deadline is
+					// propagated as usual.
+					if (!PageTimeout::expired())
+						throw;
+					timedOut = true;
+				}
+				PageTimeout::stop();
+				if (timedOut) {
+					// Discard the partially built page and the PostScript state the
+					// aborted code left behind; the next page starts from a fresh bop.
+#ifndef DISABLE_GS
+					PsSpecialHandler::sharedInterpreter().resetVMState();
+#endif
+					_svg.reset();
+					_actions->reset();
+				}
+				else if (FONT_CSS_FILE.empty()) {
+					// The font embedding depends on the glyphs and CSS data collected by
+					// process-wide components, so it must stay inside the locked section.
+					// The font encoders keep running on worker threads, though; they are
+					// joined by the background task right before the page is serialized.
+					Timing::Scope timer("fonts");
+					appendFontFaces = embedFonts(_svg.rootNode());
+				}
+				if (!timedOut && !_userMessage.empty()) {
+					if (auto specialActions = dynamic_cast<SpecialActions*>(_actions.get()))
+						userMessage = specialActions->expandText(_userMessage);
+				}
+				if (timedOut)
+					;  // the page was already discarded above
+				else if (FONT_CSS_FILE.empty())
+					_actions->reset();
+				else {
+					// keep the used-character records; they accumulate until the shared
+					// font CSS file is written after the last page
+					_actions->bbox().invalidate();
 				}
 			}
+			if (timedOut) {
+				Message::estream(true) << "page " << i << " timed out after " << PageTimeout::SECONDS
+					<< " seconds; emitting placeholder\n";
+				// The placeholder must be written in page order like any other page, so
+				// the pages still in flight are drained first.
+				while (!_pendingPages.empty())
+					finishPendingPage();
+				ostream &os = _out.getPageStream(int(i), int(numberOfPages()), hashTriple);
+				os << "<?xml version='1.0' encoding='UTF-8'?>\n"
+					<< "<svg xmlns='http://www.w3.org/2000/svg'>"
+					<< "<!-- page " << i << " skipped after timeout -->"
+					<< "</svg>\n";
+				_out.finish();
+				continue;
+			}
+			// Hand the finished page over to a background task that optimizes and writes it
+			// while the conversion of the following pages already proceeds on this thread.
+			// The pending pages form a bounded FIFO queue so that they are reported in
+			// order and the memory usage stays limited.
+			XMLElement *defs = _svg.defsNode();
+			XMLElement *page = _svg.pageNode();
+			XMLDocument doc = _svg.detachDocument();
+			auto pendingPage = util::make_unique<PendingPage>();
+			pendingPage->pageno = i;
+			pendingPage->path = path;
+			pendingPage->userMessage = std::move(userMessage);
+			pendingPage->startTime = pageStartTime;
+			if (computeHashes) {
+				pendingPage->dviHash = dviHash;
+				pendingPage->optHash = shortenedOptHash;
+				pendingPage->cmbHash = combinedHash;
+			}
+			// The optimization of the pending pages may run concurrently, but the
+			// serialization stage must be entered one page at a time and in page order
+			// since SVGOutput buffers a single page and may write to a common stream
+			// (e.g. stdout). Each task therefore waits for the serialization of its
+			// predecessor, which the latter signals through a promise.
+			auto serialized = make_shared<promise<void>>();
+			shared_future<void> prevSerialized = std::move(_prevSerialized);
+			_prevSerialized = serialized->get_future().share();
+			pendingPage->written = async(launch::async,
+				[this, doc=std::move(doc), defs, page, pageno=i, numPages=numberOfPages(), hashTriple, bbox=_pageBBox,
+						appendFontFaces=std::move(appendFontFaces), prevSerialized, serialized,
+						pending=pendingPage.get(), containsText=_svg.containsText()]() mutable {
+					bool success = false;
+					try {
+						if (appendFontFaces) {  // wait for the font encoders and add the font-face rules
+							Timing::Scope timer("fontenc", pageno);
+							appendFontFaces();
+						}
+						{
+							Timing::Scope timer("optimize", pageno);
+							SVGOptimizer().execute(defs, page, containsText);
+						}
+						if (Timing::ENABLED)
+							Timing::setPageElements(pageno, count_nodes(doc.getRootElement()));
+						if (prevSerialized.valid())  // wait until the preceding page has been serialized
+							prevSerialized.wait();
+						Timing::Scope timer("output", pageno);
+						_out.setPageBBox(pageno, bbox);
+						success = bool(doc.write(_out.getPageStream(pageno, numPages, hashTriple)));
+						_out.finish();
+						// finishPendingPage() reads the duration after waiting for this task,
+						// so the write is synchronized through the future's shared state
+						pending->seconds = chrono::duration<double>(chrono::steady_clock::now()-pending->startTime).count();
+					}
+					catch (...) {
+						serialized->set_value();  // unblock the subsequent pages before propagating the error
+						throw;
+					}
+					serialized->set_value();
+					return success;
+				});
+			_pendingPages.push_back(std::move(pendingPage));
 			_svg.reset();
-			_actions->reset();
+			if (MAX_MEMORY_BYTES > 0 && MemoryStats::currentTotal() > MAX_MEMORY_BYTES) {
+				// The memory budget is exceeded. First serialize all completed pages
+				// immediately and release their trees. If that doesn't suffice, drop the
+				// glyph outlines held in the glyph cache; they can be re-read from the
+				// cache files. The pages must be drained first since their background
+				// tasks may still wait for font encoders accessing the glyph cache.
+				while (!_pendingPages.empty())
+					finishPendingPage();
+				if (MemoryStats::currentTotal() > MAX_MEMORY_BYTES)
+					PhysicalFont::releaseCachedGlyphs();
+			}
 		}
 	}
+	while (!_pendingPages.empty())
+		finishPendingPage();
+}
+
+
+/** Converts a consecutive range of pages into a single SVG document. The pages
+ *  are stacked vertically and share one defs section, so fonts, patterns, and
+ *  identical clip paths are embedded only once rather than per page.
+ *  @param[in] first number of first page to convert
+ *  @param[in] last number of last page to convert */
+void DVIToSVG::convertCombined (unsigned first, unsigned last) {
+	BoundingBox combinedBBox;
+	double bottom=0;  // y coordinate below the bottommost page added so far
+	for (unsigned i=first; i <= last; ++i) {
+		{
+			Timing::Scope timer("pages");
+			Timing::Scope pageTimer(Timing::TRACING ? "page:"+to_string(i) : (Timing::ENABLED ? "execute" : string()), i);
+			DVISVGM_PROBE1(page_begin, i);
+			executePage(i);
+			DVISVGM_PROBE1(page_end, i);
+		}
+		// stack the page below the ones already present and update the combined bounding box
+		BoundingBox bbox = _pageBBox;
+		if (i > first) {
+			Matrix matrix = getPageTransformation();
+			matrix.translate(0, bottom-bbox.minY());
+			_svg.transformPage(matrix);
+			bbox = BoundingBox(bbox.minX(), bottom, bbox.maxX(), bottom+bbox.height());
+		}
+		combinedBBox.embed(bbox);
+		bottom = bbox.maxY();
+		// start a fresh bounding box for the next page but keep the used-character
+		// records so that the fonts referenced anywhere are embedded once below
+		_actions->bbox().invalidate();
+	}
+	string userMessage;
+	if (!_userMessage.empty()) {
+		if (auto specialActions = dynamic_cast<SpecialActions*>(_actions.get()))
+			userMessage = specialActions->expandText(_userMessage);
+	}
+	function<void ()> appendFontFaces;
+	{
+		Timing::Scope timer("fonts");
+		appendFontFaces = embedFonts(_svg.rootNode());
+	}
+	if (appendFontFaces) {  // wait for the font encoders and add the font-face rules
+		Timing::Scope timer("fontenc");
+		appendFontFaces();
+	}
+	if (_bboxFormatString != "none")
+		_svg.setBBox(combinedBBox);
+	{
+		Timing::Scope timer("optimize");
+		SVGOptimizer().execute(_svg.defsNode(), _svg.rootNode(), _svg.containsText());
+	}
+	bool success;
+	{
+		Timing::Scope timer("output");
+		success = _svg.write(_out.getPageStream(int(first), int(numberOfPages())));
+		_out.finish();
+	}
+	_svg.reset();
+	_generatorCommentAdded = false;
+	_actions->reset();
+	string fname = _out.filepath(int(first), int(numberOfPages())).shorterAbsoluteOrRelative();
+	if (fname.empty())
+		fname = "<stdout>";
+	if (!success)
+		Message::wstream(true) << "failed to write output to " << fname << '\n';
+	else {
+		Message::mstream(false, Message::MC_PAGE_WRITTEN) << "\noutput written to " << fname << '\n';
+		if (!userMessage.empty())
+			Message::ustream(true) << userMessage << "\n";
+	}
+}
+
+
+/** Waits for the completion of the background task that optimizes and writes the
+ *  oldest pending page, and reports its outcome. Exceptions thrown by the task are
+ *  rethrown on the calling thread. */
+void DVIToSVG::finishPendingPage () {
+	if (_pendingPages.empty())
+		return;
+	auto pending = std::move(_pendingPages.front());
+	_pendingPages.pop_front();
+	bool success = pending->written.get();
+	DVISVGM_PROBE1(page_flush, pending->pageno);
+	string fname = pending->path.shorterAbsoluteOrRelative();
+	if (fname.empty())
+		fname = "<stdout>";
+	if (!success)
+		Message::wstream(true) << "failed to write output to " << fname << '\n';
+	else {
+		Message::mstream(false, Message::MC_PAGE_WRITTEN) << "\noutput written to " << fname << '\n';
+		if (Timing::ENABLED && !pending->path.empty())
+			Timing::setPageOutputSize(pending->pageno, static_cast<long long>(FileSystem::filesize(pending->path.absolute())));
+		if (!pending->userMessage.empty())
+			Message::ustream(true) << pending->userMessage << "\n";
+		if (_hashIndex && !pending->dviHash.empty())
+			_hashIndex->update(pending->pageno, pending->dviHash, pending->optHash, pending->path.absolute());
+		if (!PAGE_MANIFEST_FILE.empty()) {
+			string abspath = pending->path.empty() ? "" : pending->path.absolute();
+			uint64_t numBytes = abspath.empty() ? 0 : FileSystem::filesize(abspath);
+			addManifestEntry(pending->pageno, pending->cmbHash, abspath, numBytes, pending->seconds, true);
+		}
+	}
+	if (MemoryStats::REPORT)
+		MemoryStats::write(cout, "page "+to_string(pending->pageno));
 }
 
 
@@ -154,6 +458,68 @@ static unique_ptr<HashFunction> create_hash_function (const string &algo) {
 }
 
 
+/** Traces the glyphs of all Metafont-based fonts defined in the DVI file ahead
+ *  of the page conversion. The fonts are distributed to a pool of worker threads,
+ *  each of which stores the traced glyphs in the corresponding font cache file.
+ *  The GF files are created up front because Metafont calls and kpathsea lookups
+ *  must stay on the main thread. */
+static void pretrace_metafont_glyphs () {
+	if (PhysicalFont::CACHE_PATH.empty())
+		return;
+	vector<pair<const PhysicalFont*, string>> jobs;
+	unordered_set<const Font*> uniqueFonts;
+	for (const auto &font : FontManager::instance().getFonts()) {
+		auto ph_font = font_cast<const PhysicalFont*>(font->uniqueFont());
+		if (ph_font && ph_font->type() == PhysicalFont::Type::MF && uniqueFonts.insert(ph_font).second) {
+			string gfname;
+			if (ph_font->prepareGlyphTracing(gfname))
+				jobs.emplace_back(ph_font, std::move(gfname));
+		}
+	}
+	if (jobs.empty())
+		return;
+	Timing::Scope timer("fonts");
+	ThreadPool pool(ThreadPool::preferredThreadCount(jobs.size()));
+	for (auto &job : jobs) {
+		pool.enqueue([&job] {
+			try {
+				Timing::Scope timer(Timing::TRACING ? "fonttrace:"+job.first->name() : string());
+				FontCache cache;
+				job.first->traceGlyphs(job.second, cache, DVIToSVG::TRACE_MODE == 'a', nullptr);
+			}
+			catch (MessageException &e) {
+				// glyphs that couldn't be traced here are retried on demand later
+			}
+		});
+	}
+	// the pool destructor waits for the pending tracing tasks
+}
+
+
+/** Loads the lazily created per-font data of all fonts defined in the DVI file
+ *  ahead of the page conversion. Without prefetching, the font file lookups and
+ *  metrics reads happen on first use of each font, i.e. mostly while converting
+ *  the first page. Distributing them to a pool of worker threads directly after
+ *  the font definitions have been executed reduces the time until the first
+ *  page is completed. */
+static void prefetch_font_data () {
+	unordered_set<const Font*> uniqueFonts;
+	for (const auto &font : FontManager::instance().getFonts())
+		uniqueFonts.insert(font->uniqueFont());
+	if (uniqueFonts.empty())
+		return;
+	Timing::Scope timer("fonts");
+	ThreadPool pool(ThreadPool::preferredThreadCount(uniqueFonts.size()));
+	for (const Font *font : uniqueFonts) {
+		pool.enqueue([font] {
+			font->path();        // trigger the lookup of the font file
+			font->getMetrics();  // trigger reading the font metrics
+		});
+	}
+	// the pool destructor waits for the pending prefetch tasks
+}
+
+
 /** Convert DVI pages specified by a page range string.
  *  @param[in] rangestr string describing the pages to convert
  *  @param[out] pageinfo (number of converted pages, number of total pages) */
@@ -162,22 +528,49 @@ void DVIToSVG::convert (const string &rangestr, pair<int,int> *pageinfo) {
 	if (!ranges.parse(rangestr, numberOfPages()))
 		throw MessageException("invalid page range format");
 
-	Message::mstream(false, Message::MC_PAGE_NUMBER) << "pre-processing DVI file (format version "  << getDVIVersion() << ")\n";
 	if (auto actions = dynamic_cast<DVIToSVGActions*>(_actions.get())) {
-		PreScanDVIReader prescan(getInputStream(), actions);
-		actions->setDVIReader(prescan);
-		prescan.executeAllPages();
-		actions->setDVIReader(*this);
+		// the prescan accesses the global font and special components => serialize it
+		unique_lock<mutex> lock(_conversionMutex, defer_lock);
+		if (NUM_JOBS > 1)
+			lock.lock();
+		// Scanning the whole file ahead of the conversion is only required if one of
+		// the registered special handlers collects data in a preprocessing step. The
+		// font definitions are always retrieved from the postamble afterwards.
+		if (SpecialManager::instance().preprocessingRequired()) {
+			Timing::Scope timer("prescan");
+			Message::mstream(false, Message::MC_PAGE_NUMBER) << "pre-processing DVI file (format version "  << getDVIVersion() << ")\n";
+			PreScanDVIReader prescan(getInputStream(), actions);
+			actions->setDVIReader(prescan);
+			prescan.executeAllPages();
+			actions->setDVIReader(*this);
+		}
 		SpecialManager::instance().notifyPreprocessingFinished();
 		executeFontDefs();
+		if (PREFETCH_FONTS)
+			prefetch_font_data();
+		if (TRACE_MODE != 0)
+			pretrace_metafont_glyphs();
 	}
 
 	unique_ptr<HashFunction> hashFunc;
 	if (!PAGE_HASH_SETTINGS.algorithm().empty())  // name of hash algorithm present?
 		hashFunc = create_hash_function(PAGE_HASH_SETTINGS.algorithm());
 
+	if (hashFunc && PAGE_HASH_SETTINGS.isSet(HashSettings::P_INDEX) && !PAGE_HASH_SETTINGS.indexPath().empty()) {
+		static once_flag initIndexOnce;
+		call_once(initIndexOnce, [] {
+			_hashIndex = util::make_unique<PageHashIndex>(PAGE_HASH_SETTINGS.indexPath(), PAGE_HASH_SETTINGS.algorithm());
+			_hashIndex->read();
+		});
+	}
 	for (const auto &range : ranges)
 		convert(range.first, range.second, hashFunc.get());
+	if (!FONT_CSS_FILE.empty())
+		writeFontCSS();
+	if (!PAGE_MANIFEST_FILE.empty())
+		writeManifest();
+	if (_hashIndex)
+		_hashIndex->write();
 	if (pageinfo) {
 		pageinfo->first = ranges.numberOfPages();
 		pageinfo->second = numberOfPages();
@@ -202,14 +595,12 @@ void DVIToSVG::listHashes (const string &rangestr, std::ostream &os) {
 	string shortenedOptHash = XXH32HashFunction(PAGE_HASH_SETTINGS.optionsHash()).digestString();
 	os << string(spaces1, ' ') << "DVI"
 		<< string(spaces2, ' ') << "DVI+opt\n";
-	for (const auto &range : ranges) {
-		for (int i=range.first; i <= range.second; i++) {
-			computePageHash(i, *hashFunc);
-			os << setw(width1) << i;
-			os << ": " << hashFunc->digestString();
-			hashFunc->update(PAGE_HASH_SETTINGS.optionsHash());
-			os << ", " << hashFunc->digestString() << '\n';
-		}
+	for (auto it = ranges.valuesBegin(); it != ranges.valuesEnd(); ++it) {
+		computePageHash(*it, *hashFunc);
+		os << setw(width1) << *it;
+		os << ": " << hashFunc->digestString();
+		hashFunc->update(PAGE_HASH_SETTINGS.optionsHash());
+		os << ", " << hashFunc->digestString() << '\n';
 	}
 	os << "hash algorithm: " << PAGE_HASH_SETTINGS.algorithm()
 		<< ", options hash: " << shortenedOptHash << '\n';
@@ -217,7 +608,8 @@ void DVIToSVG::listHashes (const string &rangestr, std::ostream &os) {
 
 
 int DVIToSVG::executeCommand () {
-	SignalHandler::instance().check();
+	if (PageTimeout::SECONDS > 0 && inPage())
+		PageTimeout::check();
 	const streampos cmdpos = tell();
 	int opcode = DVIReader::executeCommand();
 	if (dviState().v+_ty != _prevYPos) {
@@ -246,7 +638,19 @@ void DVIToSVG::enterBeginPage (unsigned pageno, const vector<int32_t> &c) {
 		if (pageno != (unsigned)c[0])  // Does page number shown on page differ from physical page number?
 			Message::mstream(false) << " [" << c[0] << ']';
 		Message::mstream().indent(1);
-		_svg.appendToDoc(util::make_unique<XMLComment>(" This file was generated by dvisvgm " + string(PROGRAM_VERSION) + " "));
+		if (!COMBINE_PAGES || !_generatorCommentAdded) {
+			_svg.appendToDoc(util::make_unique<XMLComment>(" This file was generated by dvisvgm " + string(PROGRAM_VERSION) + " "));
+			_generatorCommentAdded = true;
+		}
+		if (!FONT_CSS_FILE.empty()) {
+			// reference the shared font CSS file instead of embedding the rules into each page;
+			// the reference is resolved relative to the location of the page file
+			string href = FONT_CSS_FILE;
+			FilePath pagePath = _out.filepath(int(pageno), numberOfPages());
+			if (!pagePath.empty())
+				href = FilePath(FONT_CSS_FILE).relative(pagePath);
+			_svg.appendToDoc(util::make_unique<XMLText>("<?xml-stylesheet type='text/css' href='"+href+"'?>"));
+		}
 	}
 }
 
@@ -254,6 +658,11 @@ void DVIToSVG::enterBeginPage (unsigned pageno, const vector<int32_t> &c) {
 /** This template method is called by DVIReader::cmdEop() after
  *  executing the EOP actions. */
 void DVIToSVG::leaveEndPage (unsigned) {
+	if (MemoryStats::REPORT) {
+		// sample the resident set size at the page boundary so that memory spikes
+		// can be attributed to the page that caused them
+		MemoryStats::set(MemoryStats::Unit::PROCESS, System::processMemory());
+	}
 	if (!dynamic_cast<DVIToSVGActions*>(_actions.get()))
 		return;
 
@@ -296,6 +705,7 @@ void DVIToSVG::leaveEndPage (unsigned) {
 			}
 		}
 	}
+	_pageBBox = bbox;
 	if (bbox.width() == 0)
 		Message::wstream(false) << "\npage is empty\n";
 	if (_bboxFormatString != "none") {
@@ -326,7 +736,11 @@ Matrix DVIToSVG::getPageTransformation () const {
 		// add constants for length units to calculator
 		for (const auto &unit : Length::getUnits())
 			calc.setVariable(unit.first, Length(1, unit.second).pt());
-		matrix.set(_transCmds, calc);
+		// compile the command string once and only re-evaluate the argument
+		// expressions with the current variable values per page
+		if (!_transPipeline)
+			_transPipeline = util::make_unique<Matrix::Pipeline>(_transCmds);
+		matrix = _transPipeline->evaluate(calc);
 	}
 	return matrix;
 }
@@ -346,15 +760,32 @@ static void collect_chars (unordered_map<const Font*, set<int>> &fontmap) {
 }
 
 
-/** Adds the font information to the SVG tree.
- *  @param[in] svgElement the font nodes are added to this node */
-void DVIToSVG::embedFonts (XMLElement *svgElement) {
+/** Adds the font information to the SVG tree. Fonts requiring conversion to a
+ *  target format (e.g. WOFF/WOFF2) are encoded on worker threads that keep
+ *  running after this function returns, so that the encoding overlaps with the
+ *  optimization and serialization of the page body.
+ *  @param[in] svgElement the font nodes are added to this node
+ *  @return completion function joining the workers and adding the computed
+ *    font-face rules to the tree; it must be called before the document is
+ *    written (the returned object is empty if there's nothing to wait for) */
+function<void ()> DVIToSVG::embedFonts (XMLElement *svgElement) {
 	if (!svgElement || !_actions) // no dvi actions => no chars written => no fonts to embed
-		return;
+		return function<void ()>();
 
 	auto &usedCharsMap = FontManager::instance().getUsedChars();
 	collect_chars(usedCharsMap);
 
+	// Embedded font files are created in two stages: The subsetted TTF files are
+	// written sequentially since the glyph tracing involved accesses shared state
+	// like the font cache. The CPU-bound conversion to the target format (e.g. the
+	// brotli compression of WOFF2) and the base64 encoding run in worker threads.
+	struct FontFaceJob {
+		const PhysicalFont *font;
+		string ttfname;
+		string cssRule;
+	};
+	vector<FontFaceJob> fontFaceJobs;
+
 	GlyphTracerMessages messages;
 	unordered_set<const Font*> tracedFonts;  // collect unique fonts already traced
 	for (const auto &fontchar : usedCharsMap) {
@@ -366,15 +797,194 @@ void DVIToSVG::embedFonts (XMLElement *svgElement) {
 				ph_font->traceAllGlyphs(TRACE_MODE == 'a', &messages);
 				tracedFonts.insert(ph_font->uniqueFont());
 			}
-			if (font->path())  // does font file exist?
-				_svg.append(*ph_font, fontchar.second, &messages);
-			else
+			if (!font->path())  // font file doesn't exist?
 				Message::wstream(true) << "can't embed font '" << font->name() << "'\n";
+			else if (SVGTree::USE_FONTS && SVGTree::FONT_FORMAT != FontWriter::FontFormat::SVG && !fontchar.second.empty()) {
+				try {
+					FontWriter fontWriter(*ph_font);
+					fontFaceJobs.push_back({ph_font, fontWriter.createTTF(fontchar.second, &messages), ""});
+				}
+				catch (FontWriterException &e) {
+					Message::wstream(true) << "can't embed font '" << font->name() << "'\n";
+				}
+			}
+			else
+				_svg.append(*ph_font, fontchar.second, &messages);
 		}
 		else
 			Message::wstream(true) << "can't embed font '" << font->name() << "'\n";
 	}
+	function<void ()> completion;
+	if (!fontFaceJobs.empty()) {
+		// The jobs and the pool are kept in shared state since the completion function
+		// outlives this call and std::function requires copyable closures.
+		auto jobs = make_shared<vector<FontFaceJob>>(std::move(fontFaceJobs));
+		auto pool = make_shared<ThreadPool>(ThreadPool::preferredThreadCount(jobs->size()));
+		auto futures = make_shared<vector<future<void>>>();
+		for (FontFaceJob &job : *jobs) {
+			futures->push_back(pool->enqueue([&job] {
+				try {
+					job.cssRule = FontWriter(*job.font).cssFontFaceRule(SVGTree::FONT_FORMAT, job.ttfname);
+				}
+				catch (MessageException &) {
+					job.cssRule.clear();
+				}
+			}));
+		}
+		// Create the style node now while the SVG tree still owns the document. The node
+		// pointer stays valid after the document was detached for the background output.
+		XMLCData *styleCData = _svg.styleCDataNode();
+		completion = [jobs, pool, futures, styleCData] {
+			for (future<void> &taskFuture : *futures)
+				taskFuture.get();
+			for (FontFaceJob &job : *jobs) {
+				if (job.cssRule.empty())
+					Message::wstream(true) << "can't embed font '" << job.font->name() << "'\n";
+				else
+					styleCData->append(std::move(job.cssRule));
+			}
+		};
+	}
 	_svg.appendFontStyles(FontManager::instance().getUsedFonts());
+	return completion;
+}
+
+
+/** Writes the font-face and text style rules of all fonts used in the document
+ *  to the shared CSS file referenced by the generated pages. Since the
+ *  used-character records accumulate across the pages in this mode, each font
+ *  is subsetted and encoded only once per document rather than once per page. */
+void DVIToSVG::writeFontCSS () {
+	ofstream ofs(FONT_CSS_FILE);
+	if (!ofs) {
+		Message::wstream(true) << "failed to write font CSS to " << FONT_CSS_FILE << '\n';
+		return;
+	}
+	Timing::Scope timer("fonts");
+	auto &usedCharsMap = FontManager::instance().getUsedChars();
+	collect_chars(usedCharsMap);
+	struct FontFaceJob {
+		const PhysicalFont *font;
+		string ttfname;
+		string cssRule;
+	};
+	vector<FontFaceJob> fontFaceJobs;
+	GlyphTracerMessages messages;
+	for (const auto &fontchar : usedCharsMap) {
+		const Font *font = fontchar.first;
+		auto ph_font = font_cast<const PhysicalFont*>(font);
+		if (!ph_font || !font->path())
+			Message::wstream(true) << "can't embed font '" << font->name() << "'\n";
+		else if (!fontchar.second.empty()) {
+			try {
+				FontWriter fontWriter(*ph_font);
+				fontFaceJobs.push_back({ph_font, fontWriter.createTTF(fontchar.second, &messages), ""});
+			}
+			catch (FontWriterException &e) {
+				Message::wstream(true) << "can't embed font '" << font->name() << "'\n";
+			}
+		}
+	}
+	if (!fontFaceJobs.empty()) {
+		// convert and encode the subsetted fonts on worker threads; there's no page
+		// output to overlap with here, but the fonts can be processed concurrently
+		vector<future<void>> futures;
+		ThreadPool pool(ThreadPool::preferredThreadCount(fontFaceJobs.size()));
+		for (FontFaceJob &job : fontFaceJobs) {
+			futures.push_back(pool.enqueue([&job] {
+				try {
+					job.cssRule = FontWriter(*job.font).cssFontFaceRule(SVGTree::FONT_FORMAT, job.ttfname);
+				}
+				catch (MessageException &) {
+					job.cssRule.clear();
+				}
+			}));
+		}
+		for (future<void> &taskFuture : futures)
+			taskFuture.get();
+	}
+	for (FontFaceJob &job : fontFaceJobs) {
+		if (job.cssRule.empty())
+			Message::wstream(true) << "can't embed font '" << job.font->name() << "'\n";
+		else
+			ofs << job.cssRule;
+	}
+	ofs << SVGTree::fontStyleCSS(FontManager::instance().getUsedFonts());
+	Message::mstream(false, Message::MC_PAGE_WRITTEN) << "font CSS written to " << FilePath(FONT_CSS_FILE).shorterAbsoluteOrRelative() << '\n';
+}
+
+
+/** Records the manifest data of a processed page.
+ *  @param[in] pageno number of the page
+ *  @param[in] hash combined hash of the page's DVI data and the conversion options
+ *  @param[in] path absolute path of the output file
+ *  @param[in] numBytes size of the output file in bytes
+ *  @param[in] seconds time spent to convert and write the page
+ *  @param[in] written false if the page was skipped due to an unchanged hash */
+void DVIToSVG::addManifestEntry (unsigned pageno, string hash, string path, uint64_t numBytes, double seconds, bool written) {
+	lock_guard<mutex> lock(_manifestMutex);
+	_manifestEntries.push_back({pageno, std::move(hash), std::move(path), numBytes, seconds, written});
+}
+
+
+/** Quotes and escapes a string so that it can be used as a JSON string value. */
+static string json_quoted (const string &str) {
+	string ret = "\"";
+	for (char c : str) {
+		switch (c) {
+			case '"' : ret += "\\\""; break;
+			case '\\': ret += "\\\\"; break;
+			default:
+				if (uint8_t(c) >= 0x20)
+					ret += c;
+				else {
+					ostringstream oss;
+					oss << "\\u" << hex << setw(4) << setfill('0') << int(c);
+					ret += oss.str();
+				}
+		}
+	}
+	return ret+'"';
+}
+
+
+/** Writes a JSON manifest describing the pages processed so far to the file
+ *  given by PAGE_MANIFEST_FILE. Each page entry provides the page number, the
+ *  combined content/options hash, the path and size of the output file, the
+ *  conversion time, and whether the file was (re)written or skipped due to an
+ *  unchanged hash, so that publishing tools can determine the affected files
+ *  without re-hashing the outputs. */
+void DVIToSVG::writeManifest () {
+	ofstream ofs(PAGE_MANIFEST_FILE);
+	if (!ofs) {
+		Message::wstream(true) << "failed to write manifest to " << PAGE_MANIFEST_FILE << '\n';
+		return;
+	}
+	lock_guard<mutex> lock(_manifestMutex);
+	// the ranges processed by concurrent conversion threads may finish out of order
+	sort(_manifestEntries.begin(), _manifestEntries.end(), [](const ManifestEntry &e1, const ManifestEntry &e2) {
+		return e1.pageno < e2.pageno;
+	});
+	ofs << "{\n";
+	ofs << " \"hashAlgorithm\": \"" << PAGE_HASH_SETTINGS.algorithm() << "\",\n";
+	ofs << " \"optionsHash\": \"" << XXH32HashFunction(PAGE_HASH_SETTINGS.optionsHash()).digestString() << "\",\n";
+	if (!FONT_CSS_FILE.empty())
+		ofs << " \"fontCSS\": " << json_quoted(FilePath(FONT_CSS_FILE).absolute()) << ",\n";
+	ofs << " \"pages\": [";
+	bool first=true;
+	for (const ManifestEntry &entry : _manifestEntries) {
+		if (!first)
+			ofs << ',';
+		first = false;
+		ofs << "\n  {\"page\": " << entry.pageno
+			<< ", \"hash\": \"" << entry.hash << '"'
+			<< ", \"file\": " << json_quoted(entry.path)
+			<< ", \"bytes\": " << entry.numBytes
+			<< ", \"seconds\": " << fixed << setprecision(3) << entry.seconds << defaultfloat
+			<< ", \"written\": " << (entry.written ? "true" : "false") << '}';
+	}
+	ofs << "\n ]\n}\n";
+	Message::mstream(false, Message::MC_PAGE_WRITTEN) << "manifest written to " << FilePath(PAGE_MANIFEST_FILE).shorterAbsoluteOrRelative() << '\n';
 }
 
 
@@ -561,6 +1171,7 @@ void DVIToSVG::dviXTextAndGlyphs (vector<double> &dx, vector<double> &dy, vector
 void DVIToSVG::HashSettings::setParameters (const string &paramstr) {
 	auto paramnames = util::split(paramstr, ",");
 	map<string, Parameter> paramMap = {
+		{"index", P_INDEX},
 		{"list", P_LIST},
 		{"replace", P_REPLACE}
 	};
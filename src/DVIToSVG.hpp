@@ -21,9 +21,17 @@
 #ifndef DVITOSVG_HPP
 #define DVITOSVG_HPP
 
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
 #include <set>
 #include <string>
 #include <utility>
+#include <vector>
+#include "BoundingBox.hpp"
 #include "DVIReader.hpp"
 #include "FilePath.hpp"
 #include "SVGTree.hpp"
@@ -31,21 +39,25 @@
 struct DVIActions;
 struct SVGOutputBase;
 class HashFunction;
+class PageHashIndex;
 
 class DVIToSVG : public DVIReader {
 	public:
 		class HashSettings {
 			public:
-				enum Parameter {P_LIST, P_REPLACE};
+				enum Parameter {P_LIST, P_REPLACE, P_INDEX};
 				void setParameters (const std::string &paramstr);
 				void setOptionHash (const std::string &optHash) {_optHash = optHash;}
+				void setIndexPath (const std::string &path)     {_indexPath = path;}
 				const std::string& algorithm () const {return _algo;}
 				const std::string& optionsHash () const {return _optHash;}
+				const std::string& indexPath () const {return _indexPath;}
 				bool isSet (Parameter param) {return _params.find(param) != _params.end();}
 
 			private:
 				std::string _algo;
 				std::string _optHash;
+				std::string _indexPath;
 				std::set<Parameter> _params;
 		};
 
@@ -54,7 +66,7 @@ class DVIToSVG : public DVIReader {
 		DVIToSVG (const DVIToSVG&) =delete;
 		void convert (const std::string &range, std::pair<int,int> *pageinfo=nullptr);
 		void setPageSize (const std::string &format)         {_bboxFormatString = format;}
-		void setPageTransformation (const std::string &cmds) {_transCmds = cmds;}
+		void setPageTransformation (const std::string &cmds) {_transCmds = cmds; _transPipeline.reset();}
 		void setUserMessage (const std::string &msg)         {_userMessage = msg;}
 		Matrix getPageTransformation () const override;
 		void translateToX (double x) override {_tx = x-dviState().h-_tx;}
@@ -70,15 +82,25 @@ class DVIToSVG : public DVIReader {
 
 	public:
 		static bool COMPUTE_PROGRESS;  ///< if true, an action to handle the progress ratio of a page is triggered
+		static bool COMBINE_PAGES;     ///< if true, all converted pages are combined into a single SVG file
+		static std::string FONT_CSS_FILE; ///< if not empty, the font CSS rules are written to this file instead of each page
+		static std::string PAGE_MANIFEST_FILE; ///< if not empty, a JSON manifest of the converted pages is written to this file
 		static char TRACE_MODE;
+		static bool PREFETCH_FONTS;    ///< if true, font file lookups and metrics are loaded concurrently ahead of the page conversion
+		static unsigned NUM_JOBS;      ///< number of threads used to convert pages concurrently
+		static size_t MAX_MEMORY_BYTES; ///< memory budget for buffered pages and glyphs (0=unlimited)
 		static HashSettings PAGE_HASH_SETTINGS;
 
 	protected:
 		void convert (unsigned firstPage, unsigned lastPage, HashFunction *hashFunc);
+		void convertCombined (unsigned firstPage, unsigned lastPage);
+		void writeFontCSS ();
+		void writeManifest ();
+		void finishPendingPage ();
 		int executeCommand () override;
 		void enterBeginPage (unsigned pageno, const std::vector<int32_t> &c);
 		void leaveEndPage (unsigned pageno);
-		void embedFonts (XMLElement *svgElement);
+		std::function<void ()> embedFonts (XMLElement *svgElement);
 		void moveRight (double dx, MoveMode mode) override;
 		void moveDown (double dy, MoveMode mode) override;
 
@@ -99,17 +121,52 @@ class DVIToSVG : public DVIReader {
 		void dviXTextAndGlyphs (std::vector<double> &dx, std::vector<double> &dy, std::vector<uint16_t> &chars, std::vector<uint16_t> &glyphs, const Font &font) override;
 
 	private:
+		/** Keeps track of a page whose optimization and output is still running in the
+		 *  background while the conversion of the following pages already proceeds. */
+		struct PendingPage {
+			std::future<bool> written;   ///< indicates whether the page was written successfully
+			unsigned pageno;             ///< number of the page being written
+			FilePath path;               ///< path of the output file
+			std::string userMessage;     ///< expanded user message to print after the page was written
+			std::string dviHash;         ///< hash of the page's DVI data (empty if hashing is disabled)
+			std::string optHash;         ///< shortened hash of the conversion options
+			std::string cmbHash;         ///< combined hash of DVI data and conversion options
+			std::chrono::steady_clock::time_point startTime;  ///< time the conversion of the page started
+			double seconds=0;            ///< time spent to convert and write the page
+		};
+
+		/** Entry of the JSON manifest describing a single converted page. */
+		struct ManifestEntry {
+			unsigned pageno;      ///< number of the page
+			std::string hash;     ///< combined hash of the page's DVI data and the conversion options
+			std::string path;     ///< absolute path of the output file
+			uint64_t numBytes;    ///< size of the output file in bytes
+			double seconds;       ///< time spent to convert and write the page
+			bool written;         ///< false if the page was skipped due to an unchanged hash
+		};
+
+		static void addManifestEntry (unsigned pageno, std::string hash, std::string path, uint64_t numBytes, double seconds, bool written);
+
 		SVGTree _svg;
 		SVGOutputBase &_out;
 		std::unique_ptr<DVIActions> _actions;
 		std::string _bboxFormatString;      ///< bounding box size/format set by the user
 		std::string _transCmds;             ///< page transformation commands set by the user
+		mutable std::unique_ptr<Matrix::Pipeline> _transPipeline;  ///< compiled page transformation commands (created on first use)
 		std::string _userMessage;           ///< message printed after conversion of a page
+		BoundingBox _pageBBox;              ///< bounding box of the most recently finished page (in final coordinates)
+		bool _generatorCommentAdded=false;  ///< true if the generator comment was added to the current document
 		double _pageHeight=0, _pageWidth=0; ///< global page height and width stored in the postamble
 		double _tx=0, _ty=0;                ///< translation of cursor position
 		double _prevXPos, _prevYPos;        ///< previous cursor position
 		WritingMode _prevWritingMode;       ///< previous writing mode
 		std::streampos _pageByte=0;         ///< position of the stream pointer relative to the preceding bop (in bytes)
+		std::deque<std::unique_ptr<PendingPage>> _pendingPages;  ///< pages optimized and written in the background, in page order
+		std::shared_future<void> _prevSerialized;  ///< signals the completed serialization of the most recently queued page
+		static std::mutex _conversionMutex; ///< serializes access to the process-wide components (fonts, specials) if NUM_JOBS > 1
+		static std::unique_ptr<PageHashIndex> _hashIndex;  ///< hash index used to skip unchanged pages across runs
+		static std::vector<ManifestEntry> _manifestEntries;  ///< manifest data of the pages processed so far
+		static std::mutex _manifestMutex;  ///< protects the manifest entries against concurrent conversion threads
 };
 
 #endif
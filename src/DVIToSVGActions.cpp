@@ -20,17 +20,23 @@
 
 #include <cstring>
 #include <ctime>
+#include <mutex>
+#include <sstream>
+#include <unordered_map>
 #include "BoundingBox.hpp"
 #include "DVIToSVG.hpp"
 #include "DVIToSVGActions.hpp"
 #include "Font.hpp"
 #include "FontManager.hpp"
 #include "GlyphTracerMessages.hpp"
+#include "PageTimeout.hpp"
 #include "System.hpp"
 #include "utility.hpp"
 
 using namespace std;
 
+bool DVIToSVGActions::ISOLATE_SPECIALS = false;
+
 
 void DVIToSVGActions::reset () {
 	FontManager::instance().resetUsedChars();
@@ -192,6 +198,9 @@ void DVIToSVGActions::setFont (int num, const Font &font) {
  *  @param[in] dvi2bp factor to scale DVI units to PS points
  *  @param[in] preprocessing if true, the DVI file is being pre-processed */
 void DVIToSVGActions::special (const string &spc, double dvi2bp, bool preprocessing) {
+	SVGTree::Checkpoint checkpoint;
+	if (ISOLATE_SPECIALS && !preprocessing)
+		checkpoint = _svg.createCheckpoint();
 	try {
 		if (preprocessing)
 			SpecialManager::instance().preprocess(spc, *this);
@@ -200,8 +209,19 @@ void DVIToSVGActions::special (const string &spc, double dvi2bp, bool preprocess
 		// @@ output message in case of unsupported specials?
 	}
 	catch (const SpecialException &e) {
+		if (ISOLATE_SPECIALS && !preprocessing)
+			_svg.rollbackTo(checkpoint);
 		Message::estream(true) << "error in special: " << e.what() << '\n';
 	}
+	catch (const TimeoutException&) {
+		throw;  // page deadline expirations must not be absorbed here
+	}
+	catch (const MessageException &e) {
+		if (!ISOLATE_SPECIALS || preprocessing || PageTimeout::expired())
+			throw;
+		_svg.rollbackTo(checkpoint);
+		Message::estream(true) << "error in special: " << e.what() << " (output of special dropped)\n";
+	}
 }
 
 
@@ -276,14 +296,8 @@ BoundingBox& DVIToSVGActions::bbox (const string& name, bool reset) {
  *  can't be determined in advance, we don't show a percent value but
  *  a rotating dash. */
 void DVIToSVGActions::progress (const char *id) {
-	if (PROGRESSBAR_DELAY < 1000) {
-		static double time=System::time();
-		// slow down updating the progress indicator to prevent flickering
-		if (System::time() - time > 0.1) {
-			progress(0, 0, id);
-			time = System::time();
-		}
-	}
+	if (PROGRESSBAR_DELAY < 1000)
+		progress(0, 0, id);  // the display updates are rate-limited there
 }
 
 
@@ -297,55 +311,78 @@ static int digits (int n) {
 }
 
 
+/** State of the progress display shared by all conversion threads. The counters
+ *  of the concurrently processed pages are aggregated into a single indicator,
+ *  and the display updates are rate-limited so that the terminal I/O never
+ *  serializes the workers. */
+struct ProgressState {
+	std::mutex mtx;        ///< serializes access to the display state
+	double startTime=0;    ///< time the current progress sequence started
+	double updateTime=0;   ///< time of the last display update
+	bool draw=false;       ///< show progress indicator?
+	int step=-1;           ///< >=0: rotating dash
+	const char *prevID=nullptr;  ///< ID of the subprocess that triggered the last update
+	std::unordered_map<const void*, std::pair<size_t,size_t>> counters;  ///< (current, total) per worker
+};
+
+static ProgressState progressState;
+static const double PROGRESS_UPDATE_INTERVAL = 0.1;  ///< min. time between two display updates (in sec)
+
+
 /** Draws a simple progress indicator.
  *  @param[in] current current iteration step (of 'total' steps)
  *  @param[in] total total number of iteration steps
  *  @param[in] id ID of the subprocess providing the information */
 void DVIToSVGActions::progress (size_t current, size_t total, const char *id) {
-	static double time=0;
-	static bool draw=false; // show progress indicator?
-	static const char *prev_id=nullptr;
-	if (current == 0 && total > 0) {
-		time = System::time();
-		draw = false;
+	ProgressState &state = progressState;
+	lock_guard<mutex> lock(state.mtx);
+	if (current == 0 && total > 0 && state.counters.empty()) {
+		state.startTime = System::time();
+		state.draw = false;
 		Message::mstream() << '\n';
 	}
+	if (total > 0)
+		state.counters[this] = {current, total};
 	// don't show the progress indicator before the given time has elapsed
-	if (!draw && System::time()-time > PROGRESSBAR_DELAY) {
-		draw = true;
+	const double now = System::time();
+	if (!state.draw && now-state.startTime > PROGRESSBAR_DELAY) {
+		state.draw = true;
 		Terminal::cursor(false);
 	}
-	if (draw && (System::time() - time > 0.1 || (total > 0 && current == total) || prev_id != id)) {
-		static int step = -1;   // >=0: rotating dash
-		static size_t prev_current=0, prev_total=1;
+	// aggregate the counters of all workers into a single progress value
+	size_t sumCurrent=0, sumTotal=0;
+	for (const auto &workerCounter : state.counters) {
+		sumCurrent += workerCounter.second.first;
+		sumTotal += workerCounter.second.second;
+	}
+	if (sumTotal == 0)
+		sumTotal = 1;
+	const bool pageComplete = (total > 0 && current == total);
+	if (pageComplete)
+		state.counters.erase(this);
+	const bool allComplete = pageComplete && state.counters.empty();
+	if (state.draw && (now-state.updateTime > PROGRESS_UPDATE_INTERVAL || allComplete || state.prevID != id)) {
 		const char *tips = "-\\|/";
-		if (total == 0) {
-			current = prev_current;
-			total = prev_total;
-			step = (step+1) % 4;
-		}
-		else {
-			prev_current = current;
-			prev_total = total;
-			step = -1;
-		}
+		state.step = (total == 0 ? (state.step+1) % 4 : -1);
 		// adapt length of progress indicator to terminal width
 		int cols = Terminal::columns();
 		int width = (cols == 0 || cols > 60) ? 50 : 49-60+cols;
-		double factor = double(current)/double(total);
+		double factor = double(sumCurrent)/double(sumTotal);
 		int length = int(width*factor);
-		Message::mstream(false, Message::MC_PROGRESS)
-			<< '[' << string(length, '=')
-			<< (factor < 1.0 ? (step < 0 ? ' ' : tips[step]) : '=')
+		// compose the whole line up front so that it's written in a single atomic chunk
+		ostringstream oss;
+		oss << '[' << string(length, '=')
+			<< (factor < 1.0 ? (state.step < 0 ? ' ' : tips[state.step]) : '=')
 			<< string(width-length, ' ')
 			<< "] " << string(3-digits(int(100*factor)), ' ') << int(100*factor)
 			<< "%\r";
+		Message::mstream(false, Message::MC_PROGRESS) << oss.str();
 		// overprint indicator when finished
-		if (factor == 1.0) {
+		if (allComplete) {
 			Message::estream().clearline();
 			Terminal::cursor(true);
 		}
-		time = System::time();
-		prev_id = id;
+		state.updateTime = now;
+		state.prevID = id;
 	}
 }
@@ -82,6 +82,8 @@ class DVIToSVGActions : public DVIActions, public SpecialActions {
 		std::string getBBoxFormatString () const override;
 		void setDVIReader (BasicDVIReader &r) {_dvireader = &r;}
 
+		static bool ISOLATE_SPECIALS;  ///< if true, the effects of a failing special are dropped and the page conversion continues
+
 	private:
 		SVGTree &_svg;
 		BasicDVIReader *_dvireader;
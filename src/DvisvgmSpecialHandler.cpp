@@ -54,9 +54,7 @@ XMLElement* SVGParser::openElement (const std::string &tag) {
 			try {
 				// parse and reformat path definition
 				auto path = GraphicsPathParser<double>().parse(d);
-				ostringstream oss;
-				path.writeSVG(oss, SVGTree::RELATIVE_PATH_CMDS);
-				elem->addAttribute("d", oss.str());
+				elem->addAttribute("d", path.svgPathData(SVGTree::RELATIVE_PATH_CMDS));
 			}
 			catch (const GraphicsPathParserException &e) {
 				throw XMLParserException(string("error in path data: ")+e.what());
@@ -68,11 +66,16 @@ XMLElement* SVGParser::openElement (const std::string &tag) {
 
 
 void SVGParser::appendNode (unique_ptr<XMLNode> node) {
-	(_svg->*_append)(std::move(node));
+	if (_svg)
+		(_svg->*_append)(std::move(node));
+	else  // no SVG tree assigned => collect the nodes below the root element
+		XMLParser::appendNode(std::move(node));
 }
 
 
 XMLElement* SVGParser::finishPushContext (unique_ptr<XMLElement> elem) {
+	if (!_svg)
+		return XMLParser::finishPushContext(std::move(elem));
 	unique_ptr<SVGElement> svgElement{static_cast<SVGElement*>(elem.release())};
 	XMLElement *elemPtr = svgElement.get();
 	(_svg->*_pushContext)(std::move(svgElement));
@@ -81,7 +84,8 @@ XMLElement* SVGParser::finishPushContext (unique_ptr<XMLElement> elem) {
 
 
 void SVGParser::finishPopContext () {
-	(_svg->*_popContext)();
+	if (_svg)
+		(_svg->*_popContext)();
 }
 
 
@@ -133,7 +137,7 @@ void DvisvgmSpecialHandler::preprocessRawSet (InputReader &ir) {
 		_currentMacro = _macros.end();
 		throw SpecialException("redefinition of SVG fragment '" + id + "'");
 	}
-	pair<MacroMap::iterator, bool> state = _macros.emplace(id, StringVector());
+	pair<MacroMap::iterator, bool> state = _macros.emplace(id, vector<Fragment>());
 	_currentMacro = state.first;
 }
 
@@ -149,7 +153,7 @@ void DvisvgmSpecialHandler::preprocessRaw (InputReader &ir) {
 		return;
 	string str = ir.getLine();
 	if (!str.empty())
-		_currentMacro->second.emplace_back("P"+str);
+		_currentMacro->second.emplace_back('P', std::move(str));
 }
 
 
@@ -158,7 +162,7 @@ void DvisvgmSpecialHandler::preprocessRawDef (InputReader &ir) {
 		return;
 	string str = ir.getLine();
 	if (!str.empty())
-		_currentMacro->second.emplace_back("D"+str);
+		_currentMacro->second.emplace_back('D', std::move(str));
 }
 
 
@@ -210,7 +214,7 @@ void DvisvgmSpecialHandler::processRaw (InputReader &ir, SpecialActions &actions
 		string xml = ir.getLine();
 		if (!xml.empty()) {
 			xml = actions.expandText(xml);
-			_pageParser.parse(std::move(xml));
+			parseXML(std::move(xml), _pageParser);
 		}
 	}
 }
@@ -221,7 +225,7 @@ void DvisvgmSpecialHandler::processRawDef (InputReader &ir, SpecialActions &acti
 		string xml = ir.getLine();
 		if (!xml.empty()) {
 			xml = actions.expandText(xml);
-			_defsParser.parse(std::move(xml));
+			parseXML(std::move(xml), _defsParser);
 		}
 	}
 }
@@ -246,23 +250,69 @@ void DvisvgmSpecialHandler::processRawPut (InputReader &ir, SpecialActions &acti
 	if (it == _macros.end())
 		throw SpecialException("undefined SVG fragment '" + id + "' referenced");
 
-	StringVector &defvector = it->second;
-	for (string &defstr : defvector) {
-		char &type = defstr[0];
-		string def = defstr.substr(1);
-		if ((type == 'P' || type == 'D') && !def.empty()) {
-			def = actions.expandText(def);
-			if (type == 'P')
-				_pageParser.parse(std::move(def));
+	for (Fragment &fragment : it->second) {
+		if ((fragment.type == 'P' || fragment.type == 'D') && !fragment.textTemplate.empty()) {
+			string def = fragment.textTemplate.expand(actions);
+			if (fragment.type == 'P')
+				parseXML(std::move(def), _pageParser);
 			else {          // type == 'D'
-				_defsParser.parse(std::move(def));
-				type = 'L';  // locked
+				parseXML(std::move(def), _defsParser);
+				fragment.type = 'L';  // locked
 			}
 		}
 	}
 }
 
 
+/** Creates a deep copy of an XML node. Element nodes are recreated as SVGElements
+ *  so that cloned fragments don't differ from those built by the SVG parsers. */
+static unique_ptr<XMLNode> clone_node (const XMLNode &node) {
+	if (const XMLElement *elem = node.toElement())
+		return util::make_unique<SVGElement>(XMLElement(*elem));
+	return node.clone();
+}
+
+
+/** Sends an XML fragment to one of the SVG parsers. Since identical raw specials,
+ *  e.g. watermarks or icons created by diagram generators, often occur on many pages,
+ *  the nodes created for a self-contained fragment are cached and cloned when the
+ *  same text shows up again. This avoids re-parsing the same data on every page.
+ *  @param[in] xml XML fragment to process
+ *  @param[in] parser SVG parser the fragment is assigned to */
+void DvisvgmSpecialHandler::parseXML (string xml, SVGParser &parser) {
+	if (parser.pending()) {  // fragment continues a previously opened element or tag?
+		parser.parse(std::move(xml));
+		return;
+	}
+	auto it = _parsedFragments.find(xml);
+	if (it == _parsedFragments.end()) {
+		// Try to parse the fragment as a self-contained unit. If it opens or closes
+		// elements beyond its own boundaries, it can't be cached and must be handed
+		// to the streaming parser instead.
+		vector<unique_ptr<XMLNode>> nodes;
+		try {
+			XMLElement root("root");
+			SVGParser fragmentParser;
+			fragmentParser.setRootElement(&root);
+			fragmentParser.parse(xml, true);
+			fragmentParser.finish();
+			while (XMLNode *child = root.firstChild())
+				nodes.push_back(XMLElement::detach(child));
+		}
+		catch (const XMLParserException &) {
+			nodes.clear();  // fragment not self-contained => stream it below
+		}
+		it = _parsedFragments.emplace(xml, std::move(nodes)).first;
+	}
+	if (it->second.empty())  // fragment not self-contained?
+		parser.parse(std::move(xml));
+	else {
+		for (const auto &node : it->second)
+			parser.append(clone_node(*node));
+	}
+}
+
+
 /** Embeds the virtual rectangle (x, y ,w , h) into the current bounding box,
  *  where (x,y) is the lower left vertex composed of the current DVI position.
  *  @param[in] w width of the rectangle in PS point units
@@ -458,12 +508,11 @@ void DvisvgmSpecialHandler::dviEndPage (unsigned, SpecialActions &actions) {
 	_defsParser.finish();
 	_pageParser.finish();
 	actions.bbox().unlock();
-	for (auto &strvecpair : _macros) {
-		StringVector &vec = strvecpair.second;
-		for (string &str : vec) {
+	for (auto &macroentry : _macros) {
+		for (Fragment &fragment : macroentry.second) {
 			// activate locked parts of a pattern again
-			if (str[0] == 'L')
-				str[0] = 'D';
+			if (fragment.type == 'L')
+				fragment.type = 'D';
 		}
 	}
 }
@@ -26,6 +26,7 @@
 #include <unordered_map>
 #include <vector>
 #include "SpecialHandler.hpp"
+#include "TextTemplate.hpp"
 #include "XMLParser.hpp"
 
 class InputReader;
@@ -51,6 +52,7 @@ class SVGParser : public XMLParser {
 	public:
 		SVGParser () : XMLParser() {}
 		void assign (SVGTree &svg, Append append, PushContext pushContext, PopContext popContext);
+		void append (std::unique_ptr<XMLNode> node) {appendNode(std::move(node));}
 
 	protected:
 		XMLElement* openElement (const std::string &tag) override;
@@ -68,11 +70,20 @@ class SVGParser : public XMLParser {
 
 
 class DvisvgmSpecialHandler : public SpecialHandler {
-	using StringVector = std::vector<std::string>;
-	using MacroMap = std::unordered_map<std::string, StringVector>;
+	/** Part of an SVG fragment defined between rawset and endrawset. The text
+	 *  is compiled into a template on the first rawput so that putting the
+	 *  fragment on further pages only re-expands the macro values. */
+	struct Fragment {
+		Fragment (char t, std::string text) : type(t), textTemplate(std::move(text)) {}
+		char type;  ///< 'P': page fragment, 'D': defs fragment, 'L': locked defs fragment
+		TextTemplate textTemplate;
+	};
+	using MacroMap = std::unordered_map<std::string, std::vector<Fragment>>;
+	using FragmentNodeMap = std::unordered_map<std::string, std::vector<std::unique_ptr<XMLNode>>>;
 
 	public:
 		DvisvgmSpecialHandler ();
+		bool requiresPreprocessing () const override {return true;}
 		void preprocess (const std::string &prefix, std::istream &is, SpecialActions &actions) override;
 		bool process (const std::string &prefix, std::istream &is, SpecialActions &actions) override;
 		const char* info () const override {return "special set for embedding raw SVG snippets";}
@@ -95,6 +106,7 @@ class DvisvgmSpecialHandler : public SpecialHandler {
 		void processImg (InputReader &ir, SpecialActions &actions);
 		void processCurrentColor (InputReader &ir, SpecialActions &actions);
 		void processMessage (InputReader &ir, SpecialActions &actions);
+		void parseXML (std::string xml, SVGParser &parser);
 		void dviPreprocessingFinished () override;
 		void dviBeginPage (unsigned pageno, SpecialActions &actions) override;
 		void dviEndPage (unsigned pageno, SpecialActions &actions) override;
@@ -102,6 +114,7 @@ class DvisvgmSpecialHandler : public SpecialHandler {
 	private:
 		MacroMap _macros;
 		MacroMap::iterator _currentMacro;
+		FragmentNodeMap _parsedFragments;  ///< caches the nodes created for self-contained raw fragments
 		int _nestingLevel=0;    ///< nesting depth of rawset specials
 		SVGParser _defsParser;  ///< parses XML added by 'rawdef' specials
 		SVGParser _pageParser;  ///< parses XML added by 'raw' specials
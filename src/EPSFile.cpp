@@ -18,10 +18,12 @@
 ** along with this program; if not, see <http://www.gnu.org/licenses/>. **
 *************************************************************************/
 
+#include <algorithm>
 #include <array>
 #include <cstring>
 #include <istream>
 #include <limits>
+#include <vector>
 #include "EPSFile.hpp"
 #include "InputBuffer.hpp"
 #include "InputReader.hpp"
@@ -84,30 +86,79 @@ istream& EPSFile::istream () const {
 }
 
 
+/** Parses the arguments of a %%BoundingBox comment.
+ *  @param[in] ir reader positioned right after the "%%BoundingBox:" keyword
+ *  @param[out] box assigned the parsed values on success
+ *  @return 1 if a bounding box was read, -1 if "(atend)" was found, 0 otherwise */
+static int parse_bbox_args (BufferInputReader &ir, BoundingBox &box) {
+	ir.skipSpace();
+	if (ir.check("(atend)", true))
+		return -1;
+	array<int, 4> values;
+	for (int &v : values) {
+		ir.skipSpace();
+		ir.parseInt(v);
+	}
+	box = BoundingBox(values[0], values[1], values[2], values[3]);
+	return 1;
+}
+
+
 /** Extracts the bounding box information from the DSC header/footer (if present).
+ *  Only the header comments and, if the values are deferred with "(atend)", the
+ *  last chunk of the PS section are scanned; the document body in between is
+ *  skipped entirely.
  *  @return the extracted bounding box */
 BoundingBox EPSFile::bbox () const {
 	BoundingBox box;
 	std::istream &is = EPSFile::istream();
 	if (is) {
 		char buf[64];
+		bool atend=false;
 		while (is) {
 			size_t linelen = getline(is, buf, 64);
 			if (strncmp(buf, "%%BoundingBox:", 14) == 0) {
 				CharInputBuffer ib(buf, linelen);
 				BufferInputReader ir(ib);
 				ir.skip(14);
-				ir.skipSpace();
-				if (!ir.check("(atend)", true)) {
-					array<int, 4> values;
-					for (int &v : values) {
-						ir.skipSpace();
-						ir.parseInt(v);
-					}
-					box = BoundingBox(values[0], values[1], values[2], values[3]);
+				int state = parse_bbox_args(ir, box);
+				if (state > 0)
+					return box;
+				if (state < 0) {
+					atend = true;
 					break;
 				}
 			}
+			else if (strncmp(buf, "%%EndComments", 13) == 0)
+				break;
+			else if (linelen > 0 && buf[0] != '%')  // end of DSC header comments?
+				break;
+		}
+		if (atend) {
+			// The values are given in the trailer section near the end of the file.
+			// Search the last chunk of the PS section for the rightmost occurrence
+			// of the comment and leave the body bytes untouched.
+			const streamoff CHUNKSIZE = 8192;
+			is.clear();
+			is.seekg(0, ios::end);
+			streamoff end = is.tellg();
+			if (_pslength > 0)
+				end = min(end, streamoff(_offset)+streamoff(_pslength));
+			streamoff start = max(streamoff(_offset), end-CHUNKSIZE);
+			vector<char> chunk(size_t(end-start));
+			is.seekg(start);
+			is.read(chunk.data(), streamsize(chunk.size()));
+			const char *pattern = "%%BoundingBox:";
+			auto it = chunk.end();
+			for (auto pos = search(chunk.begin(), chunk.end(), pattern, pattern+14); pos != chunk.end(); pos = search(pos+1, chunk.end(), pattern, pattern+14))
+				it = pos;
+			if (it != chunk.end()) {
+				auto avail = size_t(chunk.end()-it);
+				CharInputBuffer ib(&*it, min(avail, size_t(64)));
+				BufferInputReader ir(ib);
+				ir.skip(14);
+				parse_bbox_args(ir, box);
+			}
 		}
 	}
 	return box;
@@ -84,8 +84,13 @@ static inline double angle (const DPair &p) {
 }
 
 
-/** Computes the center parameterization of the arc. */
+/** Computes the center parameterization of the arc. Since the conversion requires
+ *  several trigonometric operations and the result is needed by both approximate()
+ *  and getBBox(), it's computed only once and cached afterwards. transform()
+ *  invalidates the cached data. */
 EllipticalArc::CenterParams EllipticalArc::getCenterParams () const {
+	if (_centerParamsValid)
+		return _centerParams;
 	EllipticalArc::CenterParams params;
 	if (isStraightLine()) {
 		params.center = (_endPoint-_startPoint)/2.0;
@@ -117,6 +122,8 @@ EllipticalArc::CenterParams EllipticalArc::getCenterParams () const {
 		else if (!_sweepPositive && params.deltaAngle > 0)
 			params.deltaAngle -= math::TWO_PI;
 	}
+	_centerParams = params;
+	_centerParamsValid = true;
 	return params;
 }
 
@@ -150,6 +157,7 @@ void EllipticalArc::transform (const Matrix &matrix) {
 		_sweepPositive = !_sweepPositive;
 	_startPoint = matrix * _startPoint;
 	_endPoint = matrix * _endPoint;
+	_centerParamsValid = false;
 }
 
 
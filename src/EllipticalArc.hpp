@@ -55,5 +55,7 @@ class EllipticalArc {
 		bool _largeArc;        ///< if true, the longer arc from start to end point is chosen, else the shorter one
 		bool _sweepPositive;   ///< if true, arc is drawn in direction of positive angles, else the opposite direction
 		DPair _startPoint, _endPoint;  ///< absolute coordinates of start and end point
+		mutable CenterParams _centerParams;      ///< cached center parameterization of the arc
+		mutable bool _centerParamsValid = false; ///< true if the cached center parameters are up-to-date
 };
 
@@ -66,28 +66,47 @@ static DPair cut_vector (char cuttype, const DPair &linedir, double linewidth) {
 }
 
 
-/** Creates the SVG element that will a the line.
+/** Creates the SVG objects that draw the line.
+ *  Regular lines are collected in a shared path element as long as they are emitted
+ *  consecutively and drawn with the same stroke attributes, so that documents with
+ *  many line specials don't create one SVG element per line. The collected path data
+ *  is written to the element when the sequence ends (flushLinePath).
  * @param[in] p1 first endpoint in PS point units
  * @param[in] p2 second endpoint in PS point units
  * @param[in] c1 cut method of first endpoint ('h', 'v' or 'p')
  * @param[in] c2 cut method of second endpoint ('h', 'v' or 'p')
  * @param[in] lw line width in PS point units
  * @param[in] actions object providing the actions that can be performed by the SpecialHandler */
-static void create_line (const DPair &p1, const DPair &p2, char c1, char c2, double lw, SpecialActions &actions) {
+void EmSpecialHandler::createLine (const DPair &p1, const DPair &p2, char c1, char c2, double lw, SpecialActions &actions) {
 	if (actions.outputLocked())
 		return;
-	unique_ptr<SVGElement> node;
 	DPair dir = p2-p1;
 	if (dir.x() == 0 || dir.y() == 0 || (c1 == 'p' && c2 == 'p')) {
-		// draw regular line
-		node = util::make_unique<SVGElement>("line");
-		node->addAttribute("x1", p1.x());
-		node->addAttribute("y1", p1.y());
-		node->addAttribute("x2", p2.x());
-		node->addAttribute("y2", p2.y());
-		node->setStrokeWidth(lw);
-		node->setStrokeColor(actions.getStrokeColor());
-		node->setStrokeOpacity(actions.getOpacity());
+		// draw regular line; extend the open path element if the line continues
+		// the current sequence and shares its stroke attributes
+		XMLElement *pageNode = actions.svgTree().pageNode();
+		bool extend = _linePathElem
+			&& pageNode && pageNode->lastChild() == _linePathElem
+			&& lw == _linePathWidth
+			&& actions.getStrokeColor() == _linePathColor
+			&& actions.getOpacity() == _linePathOpacity;
+		if (!extend) {
+			flushLinePath();
+			auto node = util::make_unique<SVGElement>("path");
+			node->setNoFillColor();
+			node->setStrokeWidth(lw);
+			node->setStrokeColor(actions.getStrokeColor());
+			node->setStrokeOpacity(actions.getOpacity());
+			_linePathElem = node.get();
+			_linePathWidth = lw;
+			_linePathColor = actions.getStrokeColor();
+			_linePathOpacity = actions.getOpacity();
+			actions.svgTree().appendToPage(std::move(node));
+		}
+		if (!extend || p1 != _linePathEnd)
+			_linePath.moveto(p1);
+		_linePath.lineto(p2);
+		_linePathEnd = p2;
 
 		// update bounding box
 		DPair cv = cut_vector('p', dir, lw);
@@ -106,7 +125,7 @@ static void create_line (const DPair &p1, const DPair &p2, char c1, char c2, dou
 		points.push_back(p2-cv2);
 		points.push_back(p2+cv2);
 
-		node = util::make_unique<SVGElement>("polygon");
+		auto node = util::make_unique<SVGElement>("polygon");
 		node->setPoints(points);
 		node->setFillColor(actions.getFillColor());
 		node->setFillOpacity(actions.getOpacity());
@@ -116,8 +135,18 @@ static void create_line (const DPair &p1, const DPair &p2, char c1, char c2, dou
 		actions.embed(points[1]);
 		actions.embed(points[2]);
 		actions.embed(points[3]);
+		actions.svgTree().appendToPage(std::move(node));
+	}
+}
+
+
+/** Writes the collected line segments to the open path element and closes it. */
+void EmSpecialHandler::flushLinePath () {
+	if (_linePathElem) {
+		_linePathElem->addAttribute("d", _linePath.svgPathData(SVGTree::RELATIVE_PATH_CMDS));
+		_linePathElem = nullptr;
+		_linePath.clear();
 	}
-	actions.svgTree().appendToPage(std::move(node));
 }
 
 
@@ -189,7 +218,7 @@ void EmSpecialHandler::moveto (InputReader&, SpecialActions &actions) {
  *  to the current DVI position, and sets the drawing position to the DVI position afterwards. */
 void EmSpecialHandler::lineto (InputReader&, SpecialActions &actions) {
 	DPair currpos(actions.getX(), actions.getY());
-	create_line(_pos, currpos, 'p', 'p', _linewidth, actions);
+	createLine(_pos, currpos, 'p', 'p', _linewidth, actions);
 	_pos = currpos;
 }
 
@@ -232,7 +261,7 @@ void EmSpecialHandler::line (InputReader &ir, SpecialActions& actions) {
 	auto it1=_points.find(pointnum1);
 	auto it2=_points.find(pointnum2);
 	if (it1 != _points.end() && it2 != _points.end())
-		create_line(it1->second, it2->second, char(cut1), char(cut2), linewidth, actions);
+		createLine(it1->second, it2->second, char(cut1), char(cut2), linewidth, actions);
 	else {
 		// Line endpoints don't necessarily have to be defined before
 		// a line definition. If a point isn't defined yet, we put the line
@@ -249,9 +278,10 @@ void EmSpecialHandler::dviEndPage (unsigned pageno, SpecialActions &actions) {
 		auto pit1=_points.find(line.p1);
 		auto pit2=_points.find(line.p2);
 		if (pit1 != _points.end() && pit2 != _points.end())
-			create_line(pit1->second, pit2->second, line.c1, line.c2, line.width, actions);
+			createLine(pit1->second, pit2->second, line.c1, line.c2, line.width, actions);
 		// all lines with still undefined points are ignored
 	}
+	flushLinePath();
 	// line and point definitions are local to a page
 	_lines.clear();
 	_points.clear();
@@ -23,11 +23,15 @@
 
 #include <unordered_map>
 #include <vector>
+#include "Color.hpp"
+#include "GraphicsPath.hpp"
+#include "Opacity.hpp"
 #include "Pair.hpp"
 #include "SpecialHandler.hpp"
 
 class InputReader;
 class SpecialActions;
+class SVGElement;
 
 class EmSpecialHandler : public SpecialHandler {
 	struct Line {
@@ -51,12 +55,20 @@ class EmSpecialHandler : public SpecialHandler {
 		void lineto (InputReader &ir, SpecialActions &actions);
 		void line (InputReader &ir, SpecialActions &actions);
 		void point (InputReader &ir, SpecialActions &actions);
+		void createLine (const DPair &p1, const DPair &p2, char c1, char c2, double lw, SpecialActions &actions);
+		void flushLinePath ();
 
 	private:
 		std::unordered_map<int, DPair> _points; ///< points defined by special em:point
 		std::vector<Line> _lines;       ///< list of lines with undefined end points
 		double _linewidth=0.4*72/72.27; ///< global line width
 		DPair _pos;                     ///< current position of "graphic cursor"
+		SVGElement *_linePathElem=nullptr; ///< open path element collecting consecutive line segments
+		GraphicsPath<double> _linePath; ///< segments not yet written to the open path element
+		DPair _linePathEnd;             ///< endpoint of the last segment added to the open path element
+		double _linePathWidth=0;        ///< stroke width of the open path element
+		Color _linePathColor;           ///< stroke color of the open path element
+		Opacity _linePathOpacity;       ///< stroke opacity of the open path element
 };
 
 #endif
@@ -19,6 +19,7 @@
 *************************************************************************/
 
 #include <fstream>
+#include <unordered_set>
 #include "Font.hpp"
 #include "EncFile.hpp"
 #include "InputBuffer.hpp"
@@ -32,6 +33,15 @@ static string read_entry (InputReader &in);
 static bool valid_name_char (int c);
 
 
+/** Returns a pointer to a pooled instance of a glyph name. Since most encodings
+ *  assign largely identical sets of standard glyph names, the names are interned
+ *  in a common pool so that all encoding tables share their storage. */
+static const string* intern_name (string name) {
+	static unordered_set<string> pool;
+	return &*pool.emplace(std::move(name)).first;
+}
+
+
 EncFile::EncFile (string encname) : _encname(std::move(encname))
 {
 	read();
@@ -59,7 +69,7 @@ void EncFile::read () {
 void EncFile::read (istream &is) {
 	StreamInputBuffer ib(is, 256);
 	BufferInputReader in(ib);
-	_table.resize(256);
+	_table.assign(256, nullptr);
 
 	// find beginning of vector
 	while (!in.eof()) {
@@ -83,14 +93,12 @@ void EncFile::read (istream &is) {
 		}
 		else {
 			string entry = read_entry(in);
-			if (entry == ".notdef")
-				entry.clear();
 			if (n < 256)
-				_table[n++] = std::move(entry);
+				_table[n++] = (entry == ".notdef" ? nullptr : intern_name(std::move(entry)));
 		}
 	}
 	// remove trailing .notdef names
-	for (n--; n > 0 && _table[n].empty(); n--);
+	for (n--; n > 0 && !_table[n]; n--);
 	_table.resize(n+1);
 }
 
@@ -127,6 +135,6 @@ static bool valid_name_char (int c) {
  * @return character name assigned to character code c*/
 const char* EncFile::charName (uint32_t c) const {
 	if (c < _table.size())
-		return !_table[c].empty() ? _table[c].c_str() : nullptr;
+		return _table[c] ? _table[c]->c_str() : nullptr;
 	return nullptr;
 }
@@ -42,7 +42,7 @@ class EncFile : public NamedFontEncoding {
 
 	private:
 		std::string _encname;
-		std::vector<std::string> _table;
+		std::vector<const std::string*> _table;  ///< interned glyph names, nullptr for unmapped codes
 };
 
 #endif
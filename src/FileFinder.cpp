@@ -46,8 +46,9 @@
 
 std::string FileFinder::_argv0;
 std::string FileFinder::_progname;
-std::string FileFinder::_pathbuf;
+thread_local std::string FileFinder::_pathbuf;
 bool FileFinder::_enableMktex = false;
+std::mutex FileFinder::_kpseMutex;
 
 
 /** Constructs a new file finder.
@@ -68,6 +69,11 @@ FileFinder::FileFinder () {
 }
 
 
+FileFinder::~FileFinder () {
+	saveLookupCache();
+}
+
+
 void FileFinder::init (const std::string &argv0, const std::string &progname, bool enable_mktexmf) {
 	_argv0 = argv0;
 	_progname = progname;
@@ -101,6 +107,46 @@ void FileFinder::addLookupDir (const std::string &path) {
 }
 
 
+/** Enables the persistent lookup cache and reads the entries collected by
+ *  previous runs from file "lookup.cache" located in the given cache directory.
+ *  Each cached path is validated against the modification time recorded with it,
+ *  so updated or removed files lead to a fresh kpathsea search.
+ *  @param[in] cachedir directory the cache file is located in */
+void FileFinder::enableLookupCache (const std::string &cachedir) {
+	_lookupCachePath = cachedir + "/lookup.cache";
+	std::ifstream ifs(_lookupCachePath);
+	std::string line;
+	while (std::getline(ifs, line)) {
+		auto tab1 = line.find('\t');
+		auto tab2 = (tab1 == std::string::npos) ? tab1 : line.find('\t', tab1+1);
+		if (tab2 == std::string::npos)
+			continue;
+		LookupCacheEntry entry;
+		entry.path = line.substr(tab1+1, tab2-tab1-1);
+		try {
+			entry.mtime = std::stoll(line.substr(tab2+1));
+		}
+		catch (std::exception&) {
+			continue;
+		}
+		_lookupCache.emplace(line.substr(0, tab1), std::move(entry));
+	}
+}
+
+
+/** Writes the collected lookup results back to the cache file if they
+ *  changed since it was read. */
+void FileFinder::saveLookupCache () const {
+	std::unique_lock<std::shared_timed_mutex> lock(_cacheMutex);
+	if (_lookupCacheChanged && !_lookupCachePath.empty()) {
+		std::ofstream ofs(_lookupCachePath);
+		for (const auto &entry : _lookupCache)
+			ofs << entry.first << '\t' << entry.second.path << '\t' << entry.second.mtime << '\n';
+		_lookupCacheChanged = false;
+	}
+}
+
+
 /** Determines filetype by the filename extension and calls kpse_find_file
  *  to actually look up the file.
  *  @param[in] fname name of file to look up
@@ -159,6 +205,30 @@ const char* FileFinder::findFile (const std::string &fname, const char *ftype) c
 #endif  // MIKTEX
 #endif  // _WIN32
 #ifndef MIKTEX
+	std::string cacheKey;
+	if (!_lookupCachePath.empty()) {
+		cacheKey = ext+"/"+fname;
+		bool stale = false;
+		{
+			// Cache hits, the overwhelming majority of the lookups after warmup, only
+			// take the lock shared, so concurrent lookups don't serialize on each other.
+			std::shared_lock<std::shared_timed_mutex> lock(_cacheMutex);
+			auto cacheIt = _lookupCache.find(cacheKey);
+			if (cacheIt != _lookupCache.end()) {
+				// validate the cached path; the file may have been updated or removed meanwhile
+				if (FileSystem::mtime(cacheIt->second.path) == cacheIt->second.mtime) {
+					_pathbuf = cacheIt->second.path;
+					return _pathbuf.c_str();
+				}
+				stale = true;
+			}
+		}
+		if (stale) {
+			std::unique_lock<std::shared_timed_mutex> lock(_cacheMutex);
+			_lookupCache.erase(cacheKey);
+			_lookupCacheChanged = true;
+		}
+	}
 	static std::map<std::string, kpse_file_format_type> types = {
 		{"tfm",  kpse_tfm_format},
 		{"ofm",  kpse_ofm_format},
@@ -185,12 +255,24 @@ const char* FileFinder::findFile (const std::string &fname, const char *ftype) c
 	if (it == types.end())
 		return nullptr;
 
-	if (char *path = kpse_find_file(fname.c_str(), it->second, 0)) {
+	char *path;
+	{
+		// kpathsea isn't thread-safe, so cache misses queue through this mutex
+		// while the cache hits above keep proceeding concurrently
+		std::lock_guard<std::mutex> kpseLock(_kpseMutex);
+		path = kpse_find_file(fname.c_str(), it->second, 0);
+	}
+	if (path) {
 		// In the current version of libkpathsea, each call of kpse_find_file produces
 		// a memory leak since the path buffer is not freed. I don't think we can do
 		// anything against it here...
 		_pathbuf = path;
 		std::free(path);
+		if (!_lookupCachePath.empty()) {
+			std::unique_lock<std::shared_timed_mutex> lock(_cacheMutex);
+			_lookupCache[cacheKey] = {_pathbuf, FileSystem::mtime(_pathbuf)};
+			_lookupCacheChanged = true;
+		}
 		return _pathbuf.c_str();
 	}
 #endif  // !MIKTEX
@@ -242,6 +324,7 @@ const char* FileFinder::mktex (const std::string &fname) const {
 	path = findFile(fname, nullptr);
 #else
 	kpse_file_format_type type = (ext == "tfm" ? kpse_tfm_format : kpse_mf_format);
+	std::lock_guard<std::mutex> kpseLock(_kpseMutex);
 	path = kpse_make_tex(type, fname.c_str());
 #endif
 	return path;
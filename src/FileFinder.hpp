@@ -21,8 +21,12 @@
 #ifndef FILEFINDER_HPP
 #define FILEFINDER_HPP
 
+#include <cstdint>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <set>
+#include <shared_mutex>
 #include <string>
 
 class MiKTeXCom;
@@ -31,24 +35,38 @@ class FileFinder {
 	public:
 		static void init (const std::string &argv0, const std::string &progname, bool enable_mktexmf);
 		static FileFinder& instance ();
+		~FileFinder ();
 		std::string version () const;
 		void addLookupDir (const std::string &path);
+		void enableLookupCache (const std::string &cachedir);
 		const char* lookup (const std::string &fname, const char *ftype, bool extended=true) const;
 		const char* lookup (const std::string &fname, bool extended=true) const {return lookup(fname, nullptr, extended);}
 		const char* lookupExecutable (const std::string &fname, bool addSuffix=false) const;
 
 	protected:
 		FileFinder ();
+		void saveLookupCache () const;
 		const char* findFile (const std::string &fname, const char *ftype) const;
 		const char* findMappedFile (std::string fname) const;
 		const char* mktex (const std::string &fname) const;
 
 	private:
+		struct LookupCacheEntry {
+			std::string path;  ///< path of the file found by a previous lookup
+			int64_t mtime;     ///< modification time of the file when it was cached
+		};
+
 		static std::string _argv0;
 		static std::string _progname;
-		static std::string _pathbuf;  ///< buffer holding the path of the last search
+		static thread_local std::string _pathbuf;  ///< per-thread buffer holding the path of the last search
 		static bool _enableMktex;
+		static std::mutex _kpseMutex;  ///< serializes the calls into kpathsea, which isn't thread-safe
 		std::set<std::string> _additionalDirs;
+		mutable std::map<std::string, LookupCacheEntry> _lookupCache;  ///< maps "ext/fname" to previous lookup results
+		mutable bool _lookupCacheChanged=false;  ///< true if the cache differs from its on-disk state
+		/// protects the lookup cache; C++14 lacks std::shared_mutex, hence the timed variant
+		mutable std::shared_timed_mutex _cacheMutex;
+		std::string _lookupCachePath;  ///< path of the cache file; empty if the persistent cache is disabled
 #ifdef MIKTEX
 		std::unique_ptr<MiKTeXCom> _miktex;
 #endif
@@ -45,6 +45,7 @@
 	#include <pwd.h>
 	#include <sys/stat.h>
 	#include <sys/types.h>
+	#include <utime.h>
 	const char *FileSystem::DEVNULL = "/dev/null";
 	const char FileSystem::PATHSEP = '/';
 #endif
@@ -127,6 +128,43 @@ uint64_t FileSystem::filesize (const string &fname) {
 }
 
 
+/** Returns the time of the last modification of a file.
+ *  @param[in] fname name/path of the file to inspect
+ *  @return modification time in seconds since epoch, or 0 if the file doesn't exist */
+int64_t FileSystem::mtime (const string &fname) {
+#ifdef _WIN32
+	WIN32_FILE_ATTRIBUTE_DATA attr;
+	if (!GetFileAttributesExA(fname.c_str(), GetFileExInfoStandard, &attr))
+		return 0;
+	// convert FILETIME (100ns units since 1601-01-01) to Unix epoch seconds
+	auto ticks = (static_cast<uint64_t>(attr.ftLastWriteTime.dwHighDateTime) << 32) | attr.ftLastWriteTime.dwLowDateTime;
+	return static_cast<int64_t>(ticks/10000000ULL)-11644473600LL;
+#else
+	struct stat attr;
+	return (stat(fname.c_str(), &attr) == 0) ? static_cast<int64_t>(attr.st_mtime) : 0;
+#endif
+}
+
+
+/** Sets the modification time of a file to the current time.
+ *  @param[in] fname name/path of the file
+ *  @return true on success */
+bool FileSystem::touch (const string &fname) {
+#ifdef _WIN32
+	HANDLE handle = CreateFileA(fname.c_str(), FILE_WRITE_ATTRIBUTES, FILE_SHARE_READ|FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (handle == INVALID_HANDLE_VALUE)
+		return false;
+	FILETIME ftime;
+	GetSystemTimeAsFileTime(&ftime);
+	bool ok = SetFileTime(handle, nullptr, nullptr, &ftime);
+	CloseHandle(handle);
+	return ok;
+#else
+	return utime(fname.c_str(), nullptr) == 0;
+#endif
+}
+
+
 string FileSystem::ensureForwardSlashes (string path) {
 #ifdef _WIN32
 	std::replace(path.begin(), path.end(), PATHSEP, '/');
@@ -47,6 +47,8 @@ class FileSystem {
 		static bool rename (const std::string &oldname, const std::string &newname);
 		static bool copy (const std::string &src, const std::string &dest, bool remove_src=false);
 		static uint64_t filesize (const std::string &fname);
+		static int64_t mtime (const std::string &fname);
+		static bool touch (const std::string &fname);
 		static std::string ensureForwardSlashes (std::string path);
 		static std::string ensureSystemSlashes (std::string path);
 		static std::string getcwd ();
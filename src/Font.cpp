@@ -19,6 +19,7 @@
 *************************************************************************/
 
 #include <algorithm>
+#include <chrono>
 #include <cstdlib>
 #include <set>
 #include <sstream>
@@ -29,8 +30,10 @@
 #include "FontEngine.hpp"
 #include "Message.hpp"
 #include "MetafontWrapper.hpp"
+#include "RunStats.hpp"
 #include "SignalHandler.hpp"
 #include "Subfont.hpp"
+#include "Tracepoints.hpp"
 #include "Unicode.hpp"
 #include "utility.hpp"
 
@@ -343,6 +346,8 @@ bool PhysicalFont::getGlyph (int c, GraphicsPath<int32_t> &glyph, GFGlyphTracer:
 			cached_glyph = _cache.getGlyph(c);
 		}
 		if (cached_glyph) {
+			FontCache::STATS.hits++;
+			RunStats::count(RunStats::Counter::CACHE_HITS);
 			glyph = *cached_glyph;
 			return true;
 		}
@@ -350,13 +355,20 @@ bool PhysicalFont::getGlyph (int c, GraphicsPath<int32_t> &glyph, GFGlyphTracer:
 			string gfname;
 			if (createGF(gfname)) {
 				try {
+					DVISVGM_PROBE2(glyph_trace, name().c_str(), c);
+					auto startTime = chrono::steady_clock::now();
 					double ds = getMetrics() ? getMetrics()->getDesignSize() : 1;
 					GFGlyphTracer tracer(gfname, unitsPerEm()/ds, callback);
 					tracer.setGlyph(glyph);
 					tracer.executeChar(c);
 					glyph.closeOpenSubPaths();
-					if (!CACHE_PATH.empty())
+					RunStats::count(RunStats::Counter::GLYPH_TRACES);
+					if (!CACHE_PATH.empty()) {
+						FontCache::STATS.misses++;
+						RunStats::count(RunStats::Counter::CACHE_MISSES);
+						FontCache::STATS.traceTime += chrono::duration<double>(chrono::steady_clock::now()-startTime).count();
 						_cache.setGlyph(c, glyph);
+					}
 					return true;
 				}
 				catch (GFException &e) {
@@ -366,13 +378,39 @@ bool PhysicalFont::getGlyph (int c, GraphicsPath<int32_t> &glyph, GFGlyphTracer:
 		}
 	}
 	else { // vector fonts (OTF, PFB, TTF, TTC)
-		bool ok=true;
 		FontEngine::instance().setFont(*this);
 		if (const FontMap::Entry *entry = fontMapEntry())
 			if (Subfont *sf = entry->subfont)
 				c = sf->decode(c);
-		ok = FontEngine::instance().traceOutline(decodeChar(c), glyph, false);
+		// The outlines of unstyled vector fonts are deterministic per font and
+		// character code, so they can be shared through the glyph cache like the
+		// METAFONT outlines above. This way, jobs converting separate page ranges
+		// of the same document don't re-trace identical glyphs. Styled fonts
+		// (extend/slant/bold) are excluded since their outlines additionally
+		// depend on the style parameters and the font size.
+		const bool cacheable = !CACHE_PATH.empty() && !style();
+		if (cacheable) {
+			_cache.write(CACHE_PATH);
+			_cache.read(name(), CACHE_PATH);
+			if (const Glyph *cached_glyph = _cache.getGlyph(c)) {
+				FontCache::STATS.hits++;
+				RunStats::count(RunStats::Counter::CACHE_HITS);
+				glyph = *cached_glyph;
+				return true;
+			}
+		}
+		DVISVGM_PROBE2(glyph_trace, name().c_str(), c);
+		auto startTime = chrono::steady_clock::now();
+		bool ok = FontEngine::instance().traceOutline(decodeChar(c), glyph, false);
 		glyph.closeOpenSubPaths();
+		RunStats::count(RunStats::Counter::GLYPH_TRACES);
+		if (cacheable) {
+			FontCache::STATS.misses++;
+			RunStats::count(RunStats::Counter::CACHE_MISSES);
+			FontCache::STATS.traceTime += chrono::duration<double>(chrono::steady_clock::now()-startTime).count();
+			if (ok)
+				_cache.setGlyph(c, glyph);
+		}
 		return ok;
 	}
 	return false;
@@ -399,54 +437,91 @@ bool PhysicalFont::createGF (string &gfname) const {
 }
 
 
-/** Traces all glyphs of the current font and stores them in the cache. If caching is disabled, nothing happens.
+/** Checks whether the glyphs of this font can be traced and creates the GF file
+ *  required to do so. Since this function may invoke Metafont and performs
+ *  kpathsea lookups, it must not be called from a worker thread.
+ *  @param[out] gfname name of the generated GF font file
+ *  @return true if the font is ready for glyph tracing */
+bool PhysicalFont::prepareGlyphTracing (string &gfname) const {
+	return type() == Type::MF && !CACHE_PATH.empty() && getMetrics() && createGF(gfname);
+}
+
+
+/** Traces all glyphs of this font missing in the given cache and stores them there.
+ *  The font must have been prepared by a preceding call of prepareGlyphTracing().
+ *  @param[in] gfname name of the GF file the glyphs are traced from
+ *  @param[in,out] cache cache object the traced glyphs are added to
  *  @param[in] includeCached if true, glyphs already cached are traced again
  *  @param[in] cb optional callback methods called by the tracer
  *  @return number of glyphs traced */
-int PhysicalFont::traceAllGlyphs (bool includeCached, GFGlyphTracer::Callback *cb) const {
+int PhysicalFont::traceGlyphs (const string &gfname, FontCache &cache, bool includeCached, GFGlyphTracer::Callback *cb) const {
 	int count = 0;
-	if (type() == Type::MF && !CACHE_PATH.empty()) {
-		if (const FontMetrics *metrics = getMetrics()) {
-			int fchar = metrics->firstChar();
-			int lchar = metrics->lastChar();
-			string gfname;
-			Glyph glyph;
-			if (createGF(gfname)) {
-				_cache.read(name(), CACHE_PATH);
-				double ds = getMetrics() ? getMetrics()->getDesignSize() : 1;
-				GFGlyphTracer tracer(gfname, unitsPerEm()/ds, cb);
-				tracer.setGlyph(glyph);
-				for (int i=fchar; i <= lchar; i++) {
-					if (includeCached || !_cache.getGlyph(i)) {
-						glyph.clear();
-						tracer.executeChar(i);
-						glyph.closeOpenSubPaths();
-						_cache.setGlyph(i, glyph);
-						++count;
-					}
-				}
-				_cache.write(CACHE_PATH);
+	if (const FontMetrics *metrics = getMetrics()) {
+		int fchar = metrics->firstChar();
+		int lchar = metrics->lastChar();
+		Glyph glyph;
+		cache.read(name(), CACHE_PATH);
+		GFGlyphTracer tracer(gfname, unitsPerEm()/metrics->getDesignSize(), cb);
+		tracer.setGlyph(glyph);
+		for (int i=fchar; i <= lchar; i++) {
+			if (includeCached || !cache.getGlyph(i)) {
+				glyph.clear();
+				tracer.executeChar(i);
+				glyph.closeOpenSubPaths();
+				cache.setGlyph(i, glyph);
+				++count;
 			}
 		}
+		cache.write(CACHE_PATH);
 	}
 	return count;
 }
 
 
+/** Traces all glyphs of the current font and stores them in the cache. If caching is disabled, nothing happens.
+ *  @param[in] includeCached if true, glyphs already cached are traced again
+ *  @param[in] cb optional callback methods called by the tracer
+ *  @return number of glyphs traced */
+int PhysicalFont::traceAllGlyphs (bool includeCached, GFGlyphTracer::Callback *cb) const {
+	string gfname;
+	if (prepareGlyphTracing(gfname))
+		return traceGlyphs(gfname, _cache, includeCached, cb);
+	return 0;
+}
+
+
+/** Releases the glyph outlines currently held in the glyph cache to reduce the
+ *  memory usage. Outlines traced since the last write are persisted in the cache
+ *  file first, so all released glyphs can be re-read lazily on their next access.
+ *  If caching is disabled, nothing happens since there is no file to restore the
+ *  outlines from. */
+void PhysicalFont::releaseCachedGlyphs () {
+	if (!CACHE_PATH.empty()) {
+		_cache.write(CACHE_PATH);
+		_cache.clear();
+	}
+}
+
+
 /** Computes the exact bounding box of a glyph.
  *  @param[in]  c character code of the glyph
  *  @param[out] bbox the computed bounding box
  *  @param[in]  cb optional calback object forwarded to the tracer
  *  @return true if the box could be computed successfully */
 bool PhysicalFont::getExactGlyphBox (int c, BoundingBox& bbox, GFGlyphTracer::Callback* cb) const {
-	Glyph glyph;
-	if (getGlyph(c, glyph, cb)) {
-		bbox = glyph.computeBBox();
-		double s = scaledSize()/unitsPerEm();
-		bbox.scale(s, s);
-		return true;
+	auto it = _glyphBoxCache.find(c);
+	if (it == _glyphBoxCache.end()) {
+		// compute the box in font units once per font and character; it only
+		// needs to be scaled on subsequent occurrences of the character
+		Glyph glyph;
+		if (!getGlyph(c, glyph, cb))
+			return false;
+		it = _glyphBoxCache.emplace(c, glyph.computeBBox()).first;
 	}
-	return false;
+	bbox = it->second;
+	double s = scaledSize()/unitsPerEm();
+	bbox.scale(s, s);
+	return true;
 }
 
 
@@ -672,23 +747,45 @@ NativeFontImpl::NativeFontImpl (string fname, string fontname, double ptsize)
 
 
 bool NativeFontImpl::findAndAssignBaseFontMap () {
-	FontEngine &fe = FontEngine::instance();
-	fe.setFont(*this);
-	fe.setUnicodeCharMap();
-	fe.buildGidToCharCodeMap(_toUnicodeMap);
-	if (!_toUnicodeMap.addMissingMappings(fe.getNumGlyphs()))
-		Message::wstream(true) << "incomplete Unicode mapping for native font " << name() << " (" << filename() << ")\n";
+	// nothing to do here; the Unicode mappings are created on demand by toUnicodeMap()
 	return true;
 }
 
 
+/** Returns the map assigning Unicode points to the glyph indexes of the font.
+ *  Creating the map requires walking the font's entire character map, which is
+ *  noticeably slow for large (e.g. CJK) fonts, while typical documents only use
+ *  a small fraction of the available characters. Thus, the walk is deferred until
+ *  a mapping is actually requested, so that fonts that are defined but never
+ *  queried don't add any overhead. */
+const ToUnicodeMap& NativeFontImpl::toUnicodeMap () const {
+	if (!_builtToUnicodeMap) {
+		_builtToUnicodeMap = true;
+		// preserve mappings explicitly registered via mapCharToUnicode() before the
+		// cmap was evaluated; they take precedence over the values derived from it
+		ToUnicodeMap explicitMappings = std::move(_toUnicodeMap);
+		FontEngine &fe = FontEngine::instance();
+		fe.setFont(*this);
+		fe.setUnicodeCharMap();
+		fe.buildGidToCharCodeMap(_toUnicodeMap);
+		if (!_toUnicodeMap.addMissingMappings(fe.getNumGlyphs()))
+			Message::wstream(true) << "incomplete Unicode mapping for native font " << name() << " (" << filename() << ")\n";
+		for (size_t i=0; i < explicitMappings.numRanges(); i++) {
+			const auto &range = explicitMappings.getRange(i);
+			_toUnicodeMap.addRange(range.min(), range.max(), range.minval());
+		}
+	}
+	return _toUnicodeMap;
+}
+
+
 Character NativeFontImpl::decodeChar (uint32_t c) const {
 	return {Character::INDEX, c};
 }
 
 
 uint32_t NativeFontImpl::unicode (uint32_t c) const {
-	uint32_t ucode = _toUnicodeMap.valueAt(c);
+	uint32_t ucode = toUnicodeMap().valueAt(c);
 	return Unicode::charToCodepoint(ucode, true);
 }
 
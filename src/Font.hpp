@@ -135,6 +135,8 @@ class PhysicalFont : public virtual Font {
 		virtual int ascent () const;
 		virtual int descent () const;
 		virtual int traceAllGlyphs (bool includeCached, GFGlyphTracer::Callback *cb) const;
+		bool prepareGlyphTracing (std::string &gfname) const;
+		int traceGlyphs (const std::string &gfname, FontCache &cache, bool includeCached, GFGlyphTracer::Callback *cb) const;
 		virtual int collectCharMapIDs (std::vector<CharMapID> &charmapIDs) const;
 		virtual CharMapID getCharMapID () const =0;
 		virtual void setCharMapID (const CharMapID &id) {}
@@ -143,6 +145,7 @@ class PhysicalFont : public virtual Font {
 		const char* path () const override;
 		void visit (FontVisitor &visitor) override;
 		void visit (FontVisitor &visitor) const override;
+		static void releaseCachedGlyphs ();
 
 	protected:
 		bool createGF (std::string &gfname) const;
@@ -155,6 +158,12 @@ class PhysicalFont : public virtual Font {
 
 	protected:
 		static FontCache _cache;
+
+	private:
+		/** Caches the glyph bounding boxes (in font units) computed for exact bbox
+		 *  lookups, so that each box is computed at most once per font and character
+		 *  rather than per character occurrence. */
+		mutable std::unordered_map<int,BoundingBox> _glyphBoxCache;
 };
 
 
@@ -360,10 +369,13 @@ class NativeFontImpl : public NativeFont {
 		void mapCharToUnicode (uint32_t c, uint32_t codepoint) override;
 
 	private:
+		const ToUnicodeMap& toUnicodeMap () const;
+
 		std::string _path;
 		std::string _name;
 		int _fontIndex = 0;
-		ToUnicodeMap _toUnicodeMap; ///< maps from char indexes to unicode points
+		mutable ToUnicodeMap _toUnicodeMap;    ///< maps from char indexes to unicode points
+		mutable bool _builtToUnicodeMap=false; ///< true if the font's cmap has been evaluated
 };
 
 
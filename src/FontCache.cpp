@@ -19,20 +19,48 @@
 *************************************************************************/
 
 #include <algorithm>
+#include <chrono>
 #include <cstring>
 #include <fstream>
+#include <future>
 #include <iomanip>
 #include <sstream>
+#include <thread>
 #include "FileSystem.hpp"
 #include "FontCache.hpp"
+#include "MappedInputStream.hpp"
+#include "MemoryStats.hpp"
 #include "Pair.hpp"
 #include "StreamReader.hpp"
 #include "StreamWriter.hpp"
+#include "utility.hpp"
 #include "XXHashFunction.hpp"
 
 using namespace std;
 
-const uint8_t FontCache::FORMAT_VERSION = 5;
+const uint8_t FontCache::FORMAT_VERSION = 6;
+
+uint64_t FontCache::MAX_DISK_SIZE = 0;
+FontCache::Statistics FontCache::STATS;
+
+/** Name of the file keeping the cumulative cache statistics of previous runs. */
+static const char *STATS_FILENAME = "cache.stats";
+
+/** Magic bytes identifying a font cache archive file. */
+static const char *ARCHIVE_MAGIC = "fgca";
+
+
+/** Returns a unique temporary file name derived from the given path. The
+ *  temporary files are created in the target directory so that they can be
+ *  moved to their final name atomically. */
+static string temp_path (const string &pathstr) {
+	using namespace std::chrono;
+	auto now_ms = duration_cast<milliseconds>(system_clock::now().time_since_epoch()).count();
+	auto hash = XXH64HashFunction(to_string(now_ms)).digestValue();
+	ostringstream oss;
+	oss << pathstr << '-' << hex << hash;
+	return oss.str();
+}
 
 
 static Pair32 read_pair (int bytes, StreamReader &sr) {
@@ -44,7 +72,14 @@ static Pair32 read_pair (int bytes, StreamReader &sr) {
 
 /** Removes all data from the cache. This does not affect the cache files. */
 void FontCache::clear () {
+	if (MemoryStats::ENABLED) {
+		for (const auto &charglyphpair : _glyphs)
+			MemoryStats::sub(MemoryStats::Unit::GLYPHS, charglyphpair.second.memSize());
+	}
 	_glyphs.clear();
+	_glyphOffsets.clear();
+	_is.reset();
+	_glyphDataPos = 0;
 	_fontname.clear();
 }
 
@@ -53,36 +88,93 @@ void FontCache::clear () {
  *  @param[in] c character code
  *  @param[in] glyph font glyph data */
 void FontCache::setGlyph (int c, const Glyph &glyph) {
-	_glyphs[c] = glyph;
+	Glyph &cachedGlyph = _glyphs[c];
+	if (MemoryStats::ENABLED)
+		MemoryStats::sub(MemoryStats::Unit::GLYPHS, cachedGlyph.memSize());
+	cachedGlyph = glyph;
+	if (MemoryStats::ENABLED)
+		MemoryStats::add(MemoryStats::Unit::GLYPHS, cachedGlyph.memSize());
 	_changed = true;
 }
 
 
 /** Returns the corresponding glyph data of a given character of the current font.
+ *  Glyphs still pending in the cache stream are decoded on first access.
  *  @param[in] c character code
  *  @return font glyph data (0 if no matching data was found) */
 const Glyph* FontCache::getGlyph (int c) const {
 	auto it = _glyphs.find(c);
-	return (it != _glyphs.end()) ? &it->second : nullptr;
+	if (it != _glyphs.end())
+		return &it->second;
+	auto offsetIt = _glyphOffsets.find(c);
+	if (offsetIt == _glyphOffsets.end() || !_is)
+		return nullptr;
+	_is->clear();
+	_is->seekg(_glyphDataPos+streamoff(offsetIt->second));
+	StreamReader sr(*_is);
+	Glyph &glyph = _glyphs[c];
+	decodeGlyph(sr, glyph);
+	if (MemoryStats::ENABLED)
+		MemoryStats::add(MemoryStats::Unit::GLYPHS, glyph.memSize());
+	_glyphOffsets.erase(offsetIt);
+	return &glyph;
 }
 
 
 /** Writes the current cache data to a file (only if anything changed after
- *  the last call of read()).
+ *  the last call of read()). To let concurrent dvisvgm processes share a cache
+ *  directory safely, glyphs added to the cache file in the meantime are merged
+ *  in before writing, and the file is replaced atomically through a uniquely
+ *  named temporary file, so readers never see a partially written cache file.
  *  @param[in] fontname name of current font
  *  @param[in] dir directory where the cache file should go
  *  @return true if writing was successful */
 bool FontCache::write (const string &fontname, const string &dir) const {
 	if (!_changed)
 		return true;
+	if (fontname.empty())
+		return false;
 
-	if (!fontname.empty()) {
-		string pathstr = dir.empty() ? FileSystem::getcwd() : dir;
-		pathstr += "/" + fontname + ".fgd";
-		ofstream ofs(pathstr, ios::binary);
-		return write(fontname, ofs);
+	string pathstr = dir.empty() ? FileSystem::getcwd() : dir;
+	pathstr += "/" + fontname + ".fgd";
+
+	// materialize all glyphs still pending in the current cache stream
+	if (_is) {
+		decodeGlyphs(*_is);
+		_is.reset();
 	}
-	return false;
+	// merge glyphs traced by other processes in the meantime; locally traced
+	// glyphs take precedence
+	FontCache diskCache;
+	if (diskCache.read(fontname, dir)) {
+		vector<int> diskChars;
+		for (const auto &charoffsetpair : diskCache._glyphOffsets)
+			diskChars.push_back(charoffsetpair.first);
+		for (int c : diskChars) {
+			if (_glyphs.find(c) == _glyphs.end()) {
+				if (const Glyph *glyph = diskCache.getGlyph(c)) {
+					_glyphs.emplace(c, *glyph);
+					if (MemoryStats::ENABLED)
+						MemoryStats::add(MemoryStats::Unit::GLYPHS, glyph->memSize());
+				}
+			}
+		}
+	}
+	// create a uniquely named temporary file in the cache directory
+	const string tmppathstr = temp_path(pathstr);
+	bool ok;
+	{
+		ofstream ofs(tmppathstr, ios::binary);
+		ok = write(fontname, ofs);
+	}
+	if (ok && !FileSystem::rename(tmppathstr, pathstr)) {
+		// rename can't replace existing files on Windows
+		FileSystem::remove(pathstr);
+		ok = FileSystem::rename(tmppathstr, pathstr);
+	}
+	if (!ok)
+		FileSystem::remove(tmppathstr);
+	return ok;
 }
 
 
@@ -156,6 +248,25 @@ bool FontCache::write (const string &fontname, ostream &os) const {
 	if (!os)
 		return false;
 
+	// ensure all pending glyphs are present in _glyphs since the cache
+	// file is rewritten from scratch
+	if (_is)
+		decodeGlyphs(*_is);
+
+	// serialize the glyph records first to get the offsets for the index
+	ostringstream dataStream;
+	StreamWriter dataWriter(dataStream);
+	XXH32HashFunction dataHash;  // required by WriteActions, digest unused
+	WriteActions actions(dataWriter, dataHash);
+	map<int, uint32_t> offsets;
+	for (const auto &charglyphpair : _glyphs) {
+		const Glyph &glyph = charglyphpair.second;
+		offsets.emplace(charglyphpair.first, uint32_t(dataStream.tellp()));
+		dataWriter.writeUnsigned(glyph.size(), 2);
+		glyph.iterate(actions, false);
+	}
+	const string glyphData = dataStream.str();
+
 	StreamWriter sw(os);
 	XXH32HashFunction hashfunc;
 
@@ -163,13 +274,12 @@ bool FontCache::write (const string &fontname, ostream &os) const {
 	sw.writeBytes(hashfunc.digestBytes());  // space for checksum
 	sw.writeString(fontname, hashfunc, true);
 	sw.writeUnsigned(_glyphs.size(), 4, hashfunc);
-	WriteActions actions(sw, hashfunc);
-	for (const auto &charglyphpair : _glyphs) {
-		const Glyph &glyph = charglyphpair.second;
-		sw.writeUnsigned(charglyphpair.first, 4, hashfunc);
-		sw.writeUnsigned(glyph.size(), 2, hashfunc);
-		glyph.iterate(actions, false);
+	for (const auto &charoffsetpair : offsets) {
+		sw.writeUnsigned(charoffsetpair.first, 4, hashfunc);
+		sw.writeUnsigned(charoffsetpair.second, 4, hashfunc);
 	}
+	sw.writeString(glyphData);
+	hashfunc.update(glyphData);
 	os.seekp(1);
 	auto digest = hashfunc.digestBytes();
 	sw.writeBytes(digest);  // insert checksum
@@ -178,7 +288,10 @@ bool FontCache::write (const string &fontname, ostream &os) const {
 }
 
 
-/** Reads font glyph information from a file.
+/** Reads font glyph information from a file. The glyph outlines are not decoded
+ *  up front but on first access in getGlyph(). The cache file is memory-mapped
+ *  if the platform allows it, so that only the actually requested glyph records
+ *  are paged in.
  *  @param[in] fontname name of font data to read
  *  @param[in] dir directory where the cache files are located
  *  @return true if reading was successful */
@@ -188,15 +301,26 @@ bool FontCache::read (const string &fontname, const string &dir) {
 	if (_fontname == fontname)
 		return true;
 	clear();
+	_fontname = fontname;
 	string dirstr = dir.empty() ? FileSystem::getcwd() : dir;
-	ostringstream oss;
-	oss << dirstr << '/' << fontname << ".fgd";
-	ifstream ifs(oss.str(), ios::binary);
-	return read(fontname, ifs);
+	string pathstr = dirstr+"/"+fontname+".fgd";
+	auto mis = util::make_unique<MappedInputStream>(pathstr);
+	if (mis->mapped())
+		_is = std::move(mis);
+	else
+		_is = util::make_unique<ifstream>(pathstr, ios::binary);
+	if (readIndex(fontname, *_is)) {
+		if (MAX_DISK_SIZE > 0)
+			FileSystem::touch(pathstr);  // record access time for LRU eviction
+		return true;
+	}
+	_is.reset();
+	return false;
 }
 
 
-/** Reads font glyph information from a stream.
+/** Reads font glyph information from a stream. Since the stream isn't owned
+ *  by the cache object, all glyphs are decoded immediately.
  *  @param[in] fontname name of font data to read
  *  @param[in] is input stream to read the glyph data from
  *  @return true if reading was successful */
@@ -205,6 +329,19 @@ bool FontCache::read (const string &fontname, istream &is) {
 		return true;
 	clear();
 	_fontname = fontname;
+	if (!readIndex(fontname, is))
+		return false;
+	decodeGlyphs(is);
+	return true;
+}
+
+
+/** Reads the header and the glyph index of a cache stream. The glyph outlines
+ *  themselves are left undecoded; their offsets are kept in _glyphOffsets.
+ *  @param[in] fontname name of font data to read
+ *  @param[in] is input stream to read the index from
+ *  @return true if reading was successful */
+bool FontCache::readIndex (const string &fontname, istream &is) {
 	if (!is)
 		return false;
 
@@ -227,44 +364,77 @@ bool FontCache::read (const string &fontname, istream &is) {
 
 	uint32_t num_glyphs = sr.readUnsigned(4);
 	while (num_glyphs-- > 0) {
-		uint32_t c = sr.readUnsigned(4);  // character code
-		uint16_t s = sr.readUnsigned(2);  // number of path commands
-		Glyph &glyph = _glyphs[c];
-		while (s-- > 0) {
-			uint8_t cmdval = sr.readUnsigned(1);
-			uint8_t cmdchar = (cmdval & 0x1f) + 'A';
-			int bytes = cmdval >> 5;
-			switch (cmdchar) {
-				case 'C': {
-					Pair32 p1 = read_pair(bytes, sr);
-					Pair32 p2 = read_pair(bytes, sr);
-					Pair32 p3 = read_pair(bytes, sr);
-					glyph.cubicto(p1, p2, p3);
-					break;
-				}
-				case 'L':
-					glyph.lineto(read_pair(bytes, sr));
-					break;
-				case 'M':
-					glyph.moveto(read_pair(bytes, sr));
-					break;
-				case 'Q': {
-					Pair32 p1 = read_pair(bytes, sr);
-					Pair32 p2 = read_pair(bytes, sr);
-					glyph.quadto(p1, p2);
-					break;
-				}
-				case 'Z':
-					glyph.closepath();
-			}
-		}
+		uint32_t c = sr.readUnsigned(4);       // character code
+		uint32_t offset = sr.readUnsigned(4);  // offset of glyph record relative to start of glyph data
+		_glyphOffsets.emplace(int(c), offset);
 	}
+	_glyphDataPos = is.tellg();
 	_changed = false;
 	return true;
 }
 
 
-/** Collects font cache information.
+/** Decodes a single glyph record at the current stream position.
+ *  @param[in] sr reader the glyph data is read from
+ *  @param[out] glyph the decoded glyph outline */
+void FontCache::decodeGlyph (StreamReader &sr, Glyph &glyph) {
+	uint16_t s = sr.readUnsigned(2);  // number of path commands
+	while (s-- > 0) {
+		uint8_t cmdval = sr.readUnsigned(1);
+		uint8_t cmdchar = (cmdval & 0x1f) + 'A';
+		int bytes = cmdval >> 5;
+		switch (cmdchar) {
+			case 'C': {
+				Pair32 p1 = read_pair(bytes, sr);
+				Pair32 p2 = read_pair(bytes, sr);
+				Pair32 p3 = read_pair(bytes, sr);
+				glyph.cubicto(p1, p2, p3);
+				break;
+			}
+			case 'L':
+				glyph.lineto(read_pair(bytes, sr));
+				break;
+			case 'M':
+				glyph.moveto(read_pair(bytes, sr));
+				break;
+			case 'Q': {
+				Pair32 p1 = read_pair(bytes, sr);
+				Pair32 p2 = read_pair(bytes, sr);
+				glyph.quadto(p1, p2);
+				break;
+			}
+			case 'Z':
+				glyph.closepath();
+		}
+	}
+}
+
+
+/** Decodes all glyphs that haven't been accessed through getGlyph() yet.
+ *  @param[in] is stream the glyph data is read from */
+void FontCache::decodeGlyphs (istream &is) const {
+	StreamReader sr(is);
+	for (const auto &charoffsetpair : _glyphOffsets) {
+		is.clear();
+		is.seekg(_glyphDataPos+streamoff(charoffsetpair.second));
+		Glyph &glyph = _glyphs[charoffsetpair.first];
+		decodeGlyph(sr, glyph);
+		if (MemoryStats::ENABLED)
+			MemoryStats::add(MemoryStats::Unit::GLYPHS, glyph.memSize());
+	}
+	_glyphOffsets.clear();
+}
+
+
+/** Minimum number of cache files assigned to each thread scanning the
+ *  cache directory. Prevents spawning threads for tiny caches where the
+ *  thread startup costs would outweigh the parallel processing. */
+constexpr size_t MIN_FILES_PER_THREAD = 16;
+
+
+/** Collects font cache information. Since the cache files are independent of
+ *  each other, they are scanned by multiple concurrent tasks, which speeds up
+ *  the processing of large caches, especially on network file systems.
  *  @param[in]  dirname path to font cache directory
  *  @param[out] infos the collected font information
  *  @param[out] invalid names of outdated/corrupted cache files
@@ -275,17 +445,41 @@ bool FontCache::fontinfo (const string &dirname, vector<FontInfo> &infos, vector
 	if (!dirname.empty()) {
 		vector<string> fnames;
 		FileSystem::collect(dirname, fnames);
-		for (const string &fname : fnames) {
-			if (fname[0] == 'f' && fname.length() > 5 && fname.substr(fname.length()-4) == ".fgd") {
+		vector<string> cachefiles;
+		for (string &fname : fnames) {
+			if (fname[0] == 'f' && fname.length() > 5 && fname.substr(fname.length()-4) == ".fgd")
+				cachefiles.push_back(fname.substr(1));
+		}
+		struct ScanResult {
+			vector<FontInfo> infos;
+			vector<string> invalid;
+		};
+		// each task processes the files at positions first, first+stride, first+2*stride, ...
+		auto scanTask = [&dirname, &cachefiles](size_t first, size_t stride) {
+			ScanResult result;
+			for (size_t i=first; i < cachefiles.size(); i += stride) {
 				FontInfo info;
-				string path = dirname+"/"+(fname.substr(1));
-				ifstream ifs(path, ios::binary);
+				ifstream ifs(dirname+"/"+cachefiles[i], ios::binary);
 				if (fontinfo(ifs, info))
-					infos.push_back(std::move(info));
+					result.infos.push_back(std::move(info));
 				else
-					invalid.push_back(fname.substr(1));
+					result.invalid.push_back(cachefiles[i]);
 			}
+			return result;
+		};
+		size_t numThreads = max(size_t(1), size_t(thread::hardware_concurrency()));
+		numThreads = min(numThreads, max(size_t(1), cachefiles.size()/MIN_FILES_PER_THREAD));
+		vector<future<ScanResult>> futures;
+		for (size_t i=1; i < numThreads; i++)
+			futures.push_back(async(launch::async, scanTask, i, numThreads));
+		ScanResult result = scanTask(0, numThreads);
+		for (auto &f : futures) {
+			ScanResult taskResult = f.get();
+			move(taskResult.infos.begin(), taskResult.infos.end(), back_inserter(result.infos));
+			move(taskResult.invalid.begin(), taskResult.invalid.end(), back_inserter(result.invalid));
 		}
+		infos = std::move(result.infos);
+		invalid = std::move(result.invalid);
 	}
 	return !infos.empty();
 }
@@ -317,8 +511,8 @@ bool FontCache::fontinfo (std::istream &is, FontInfo &info) {
 
 			info.name = sr.readString();
 			info.numchars = sr.readUnsigned(4);
+			is.seekg(8*streamoff(info.numchars), ios::cur);  // skip glyph index
 			for (uint32_t i=0; i < info.numchars; i++) {
-				sr.readUnsigned(4);  // character code
 				uint16_t s = sr.readUnsigned(2);  // number of path commands
 				while (s-- > 0) {
 					uint8_t cmdval = sr.readUnsigned(1);
@@ -341,7 +535,7 @@ bool FontCache::fontinfo (std::istream &is, FontInfo &info) {
 					info.numcmds++;
 					is.seekg(bc, ios::cur);
 				}
-				info.numbytes += 6; // number of path commands + char code
+				info.numbytes += 10; // number of path commands + index entry (char code + offset)
 			}
 			info.numbytes += 6+info.name.length(); // version + 0-byte + fontname + number of chars
 		}
@@ -353,6 +547,79 @@ bool FontCache::fontinfo (std::istream &is, FontInfo &info) {
 }
 
 
+/** Reads the cumulative cache statistics of previous runs from the cache directory.
+ *  @param[in] dirname path to font cache directory
+ *  @param[out] stats the statistics read
+ *  @return true on success */
+static bool read_stats (const string &dirname, FontCache::Statistics &stats) {
+	ifstream ifs(dirname+"/"+STATS_FILENAME);
+	return bool(ifs >> stats.hits >> stats.misses >> stats.traceTime);
+}
+
+
+/** Adds the statistics collected during the current run to the statistics file in
+ *  the cache directory. Concurrent processes updating the file simultaneously may
+ *  drop a few counts; since the numbers are only used to assess the cache
+ *  effectiveness, this inaccuracy is acceptable and not worth a lock file.
+ *  @param[in] dirname path to font cache directory */
+void FontCache::updateStatistics (const string &dirname) {
+	if (dirname.empty() || (STATS.hits == 0 && STATS.misses == 0))
+		return;
+	Statistics total;
+	read_stats(dirname, total);
+	total.hits += STATS.hits;
+	total.misses += STATS.misses;
+	total.traceTime += STATS.traceTime;
+	ofstream ofs(dirname+"/"+STATS_FILENAME);
+	if (ofs)
+		ofs << total.hits << ' ' << total.misses << ' ' << total.traceTime << '\n';
+}
+
+
+/** Removes the least recently used cache files until the total size of the cache
+ *  directory no longer exceeds MAX_DISK_SIZE. Since reading a cache file updates
+ *  its modification time, the file times reflect the access order.
+ *  @param[in] dirname path to font cache directory
+ *  @param[in] os if set, a message about the removed files is written to this stream */
+void FontCache::trim (const string &dirname, ostream *os) {
+	if (dirname.empty() || MAX_DISK_SIZE == 0)
+		return;
+	struct FileEntry {
+		string path;
+		int64_t mtime;
+		uint64_t size;
+	};
+	vector<string> entries;
+	FileSystem::collect(dirname, entries);
+	vector<FileEntry> files;
+	uint64_t total=0;
+	for (const string &entry : entries) {
+		if (entry[0] != 'f' || entry.substr(1) == STATS_FILENAME)
+			continue;
+		string path = dirname+"/"+entry.substr(1);
+		FileEntry file{path, FileSystem::mtime(path), FileSystem::filesize(path)};
+		total += file.size;
+		files.push_back(std::move(file));
+	}
+	if (total <= MAX_DISK_SIZE)
+		return;
+	sort(files.begin(), files.end(), [](const FileEntry &f1, const FileEntry &f2) {
+		return f1.mtime < f2.mtime;
+	});
+	size_t numRemoved=0;
+	for (const FileEntry &file : files) {
+		if (total <= MAX_DISK_SIZE)
+			break;
+		if (FileSystem::remove(file.path)) {
+			total -= file.size;
+			numRemoved++;
+		}
+	}
+	if (os && numRemoved > 0)
+		*os << numRemoved << " cache file" << (numRemoved == 1 ? "" : "s") << " removed to keep the size limit\n";
+}
+
+
 /** Collects font cache information and write it to a stream.
  *  @param[in] dirname path to font cache directory
  *  @param[in] os output is written to this stream
@@ -381,6 +648,12 @@ void FontCache::fontinfo (const string &dirname, ostream &os, bool purge) {
 				os << '\n';
 			}
 		}
+		Statistics stats;
+		if (read_stats(dirname, stats) && stats.hits+stats.misses > 0) {
+			os	<< dec << "cumulative statistics: " << stats.hits << " hits, " << stats.misses << " misses ("
+				<< fixed << setprecision(1) << (100.0*double(stats.hits)/double(stats.hits+stats.misses)) << "% hit rate), "
+				<< setprecision(2) << stats.traceTime << "s spent tracing glyphs\n";
+		}
 		if (purge) {
 			for (const string &str : invalid_files) {
 				string path=dirname+"/"+str;
@@ -391,3 +664,126 @@ void FontCache::fontinfo (const string &dirname, ostream &os, bool purge) {
 		os.flags(osflags);  // restore format flags
 	}
 }
+
+
+/** Packs the valid cache files of a cache directory into a single archive file.
+ *  The archive can be imported into the cache directories of other machines,
+ *  e.g. to prewarm freshly set up nodes with a cache built elsewhere. Outdated
+ *  and corrupted cache files are excluded from the archive.
+ *  @param[in] dirname path to font cache directory
+ *  @param[in] archivename name of the archive file to create
+ *  @param[in] os progress and result messages are written to this stream
+ *  @return true on success */
+bool FontCache::exportArchive (const string &dirname, const string &archivename, ostream &os) {
+	struct ArchiveEntry {
+		string fontname;
+		string data;
+	};
+	vector<ArchiveEntry> archiveEntries;
+	vector<string> entries;
+	FileSystem::collect(dirname, entries);
+	for (const string &entry : entries) {
+		if (entry[0] != 'f' || entry.length() <= 5 || entry.substr(entry.length()-4) != ".fgd")
+			continue;
+		string fontname = entry.substr(1, entry.length()-5);
+		ifstream ifs(dirname+"/"+entry.substr(1), ios::binary);
+		FontInfo info;
+		if (!fontinfo(ifs, info) || info.name != fontname)
+			os << "skipping invalid cache file " << entry.substr(1) << '\n';
+		else {
+			// the payload keeps the cache file as is, including its checksum,
+			// so that the imported data can be validated again
+			ifs.clear();
+			ifs.seekg(0);
+			ostringstream data;
+			data << ifs.rdbuf();
+			archiveEntries.push_back({std::move(fontname), data.str()});
+		}
+	}
+	if (archiveEntries.empty()) {
+		os << "cache is empty\n";
+		return false;
+	}
+	ofstream ofs(archivename, ios::binary);
+	if (!ofs) {
+		os << "failed to create cache archive " << archivename << '\n';
+		return false;
+	}
+	StreamWriter sw(ofs);
+	sw.writeString(ARCHIVE_MAGIC);
+	sw.writeUnsigned(FORMAT_VERSION, 1);
+	sw.writeUnsigned(archiveEntries.size(), 4);
+	for (const ArchiveEntry &entry : archiveEntries) {
+		sw.writeString(entry.fontname, true);
+		sw.writeUnsigned(entry.data.size(), 4);
+		sw.writeString(entry.data);
+	}
+	os << archiveEntries.size() << " cache file" << (archiveEntries.size() == 1 ? "" : "s")
+		<< " exported to " << archivename << '\n';
+	return true;
+}
+
+
+/** Unpacks a cache archive created by exportArchive() into a cache directory.
+ *  Each entry is validated against its checksum before it's written; invalid
+ *  entries and fonts already present in the directory are skipped. The latter
+ *  may contain glyphs traced locally that are not part of the archive.
+ *  @param[in] archivename name of the archive file to read
+ *  @param[in] dirname path to font cache directory
+ *  @param[in] os progress and result messages are written to this stream
+ *  @return true on success */
+bool FontCache::importArchive (const string &archivename, const string &dirname, ostream &os) {
+	ifstream ifs(archivename, ios::binary);
+	if (!ifs) {
+		os << "failed to open cache archive " << archivename << '\n';
+		return false;
+	}
+	try {
+		StreamReader sr(ifs);
+		if (sr.readString(strlen(ARCHIVE_MAGIC)) != ARCHIVE_MAGIC || sr.readUnsigned(1) != FORMAT_VERSION) {
+			os << "invalid or incompatible cache archive " << archivename << '\n';
+			return false;
+		}
+		uint32_t numEntries = sr.readUnsigned(4);
+		size_t numImported=0, numPresent=0, numInvalid=0;
+		while (numEntries-- > 0) {
+			string fontname = sr.readString();
+			uint32_t size = sr.readUnsigned(4);
+			string data = sr.readString(int(size));
+			istringstream iss(data);
+			FontInfo info;
+			if (!fontinfo(iss, info) || info.name != fontname)
+				numInvalid++;
+			else {
+				string pathstr = dirname+"/"+fontname+".fgd";
+				if (FileSystem::exists(pathstr))
+					numPresent++;
+				else {
+					// write through a uniquely named temporary file so that concurrent
+					// readers never see a partially written cache file
+					const string tmppathstr = temp_path(pathstr);
+					bool ok;
+					{
+						ofstream entryStream(tmppathstr, ios::binary);
+						entryStream.write(data.data(), streamsize(data.size()));
+						ok = bool(entryStream);
+					}
+					if (ok && FileSystem::rename(tmppathstr, pathstr))
+						numImported++;
+					else
+						FileSystem::remove(tmppathstr);
+				}
+			}
+		}
+		os << numImported << " cache file" << (numImported == 1 ? "" : "s") << " imported\n";
+		if (numPresent > 0)
+			os << numPresent << " cache file" << (numPresent == 1 ? "" : "s") << " skipped (already present)\n";
+		if (numInvalid > 0)
+			os << numInvalid << " invalid archive entr" << (numInvalid == 1 ? "y" : "ies") << " ignored\n";
+	}
+	catch (StreamReaderException &e) {
+		os << "failed reading cache archive " << archivename << '\n';
+		return false;
+	}
+	return true;
+}
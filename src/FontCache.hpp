@@ -21,11 +21,15 @@
 #ifndef FONTCACHE_HPP
 #define FONTCACHE_HPP
 
+#include <istream>
 #include <map>
+#include <memory>
 #include <string>
 #include <vector>
 #include "Glyph.hpp"
 
+class StreamReader;
+
 
 class FontCache {
 	public:
@@ -38,6 +42,13 @@ class FontCache {
 			uint32_t numcmds;               // number of path commands
 		};
 
+		/** Cache effectiveness data used to size the cache for maximum hit rate. */
+		struct Statistics {
+			size_t hits=0;      ///< number of glyphs taken from the cache
+			size_t misses=0;    ///< number of glyphs that had to be traced
+			double traceTime=0; ///< seconds spent tracing glyphs missing in the cache
+		};
+
 	public:
 		~FontCache () {clear();}
 		bool read (const std::string &fontname, const std::string &dir);
@@ -53,11 +64,25 @@ class FontCache {
 		static bool fontinfo (const std::string &dirname, std::vector<FontInfo> &infos, std::vector<std::string> &invalid);
 		static bool fontinfo (std::istream &is, FontInfo &info);
 		static void fontinfo (const std::string &dirname, std::ostream &os, bool purge=false);
+		static void trim (const std::string &dirname, std::ostream *os=nullptr);
+		static void updateStatistics (const std::string &dirname);
+		static bool exportArchive (const std::string &dirname, const std::string &archivename, std::ostream &os);
+		static bool importArchive (const std::string &archivename, const std::string &dirname, std::ostream &os);
+
+		static uint64_t MAX_DISK_SIZE;  ///< maximum size of the cache directory in bytes (0=unlimited)
+		static Statistics STATS;        ///< effectiveness data collected during the current run
 
 	private:
+		bool readIndex (const std::string &fontname, std::istream &is);
+		void decodeGlyphs (std::istream &is) const;
+		static void decodeGlyph (StreamReader &sr, Glyph &glyph);
+
 		static const uint8_t FORMAT_VERSION;
 		std::string _fontname;
-		std::map<int, Glyph> _glyphs;
+		mutable std::map<int, Glyph> _glyphs;        ///< glyphs decoded so far
+		mutable std::map<int, uint32_t> _glyphOffsets;  ///< offsets of the glyphs not decoded yet
+		mutable std::unique_ptr<std::istream> _is;   ///< stream the pending glyphs are read from
+		std::streamoff _glyphDataPos=0;              ///< position of the glyph data section in the cache stream
 		bool _changed=false;
 };
 
@@ -18,6 +18,7 @@
 ** along with this program; if not, see <http://www.gnu.org/licenses/>. **
 *************************************************************************/
 
+#include <mutex>
 #include "CMap.hpp"
 #include "CMapManager.hpp"
 #include "EncFile.hpp"
@@ -36,6 +37,8 @@ FontEncoding* FontEncoding::encoding (const string &encname) {
 
 	using EncodingMap = unordered_map<string, unique_ptr<EncFile>>;
 	static EncodingMap encmap;
+	static mutex encmapMutex;  // the map is populated lazily and may be accessed by concurrent workers
+	lock_guard<mutex> lock(encmapMutex);
 	// initially, try to find an .enc file with the given name
 	auto it = encmap.find(encname);
 	if (it != encmap.end())
@@ -65,9 +65,12 @@ FontEngine::~FontEngine () {
 }
 
 
-/** Returns the singleton instance of this class. */
+/** Returns the engine instance assigned to the calling thread. Each thread
+ *  operates on its own engine with an independent FT_Library handle because
+ *  FreeType's library and face objects must not be accessed by multiple
+ *  threads without external locking. */
 FontEngine& FontEngine::instance () {
-	static FontEngine engine;
+	static thread_local FontEngine engine;
 	return engine;
 }
 
@@ -450,6 +453,12 @@ static bool trace_outline (FT_Face face, const Font *font, int index, Glyph &gly
 					FT_Outline_Embolden(&outline, style->bold/font->scaledSize()*face->units_per_EM);
 			}
 		}
+		// The number of outline points and contours is known in advance, so the
+		// path storage can be preallocated: each point starts at most one drawing
+		// command contributing up to two coordinate values, and each contour adds
+		// an extra moveto.
+		auto numSegments = size_t(outline.n_points) + size_t(outline.n_contours);
+		glyph.reserve(numSegments, 2*numSegments);
 		const FT_Outline_Funcs funcs = {moveto, lineto, quadto, cubicto, 0, 0};
 		FT_Outline_Decompose(&outline, &funcs, &glyph);
 		return true;
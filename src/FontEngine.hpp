@@ -36,7 +36,9 @@
 class Font;
 
 /** This class provides methods to handle font files and font data.
- *  It's a wrapper for the Freetype font library. */
+ *  It's a wrapper for the Freetype font library. Each thread works on
+ *  its own engine instance (see instance()), so glyph outlines can be
+ *  extracted from different fonts concurrently. */
 class FontEngine {
 	public:
 		~FontEngine ();
@@ -21,7 +21,9 @@
 #include <cstring>
 #include <cstdlib>
 #include <fstream>
+#include <mutex>
 #include <set>
+#include <shared_mutex>
 #include "CMap.hpp"
 #include "Font.hpp"
 #include "fonts/Base14Fonts.hpp"
@@ -42,20 +44,40 @@ FontManager& FontManager::instance () {
 }
 
 
-/** Returns a unique ID that identifies the font.
+/** Returns a unique ID that identifies the font. Since the font selection
+ *  commands of DVI files frequently address the same font several times in
+ *  a row, the result of the most recent lookup is kept and reused until a
+ *  different font number is requested or the mapping changes.
  *  @param[in] n local font number, as used in DVI and VF files
  *  @return non-negative font ID if font was found, -1 otherwise */
 int FontManager::fontID (int n) const {
+	// exclusive lock because the lookup updates the memoized result
+	unique_lock<shared_timed_mutex> lock(_mutex);
+	return lookupFontID(n);
+}
+
+
+/** Like fontID(int) but must be called with the registry lock held. */
+int FontManager::lookupFontID (int n) const {
+	if (_lastLookupValid && n == _lastLookupNum)
+		return _lastLookupID;
+	int id = -1;
 	if (_vfStack.empty()) {
 		auto it = _num2id.find(n);
-		return (it == _num2id.end()) ? -1 : it->second;
+		id = (it == _num2id.end()) ? -1 : it->second;
 	}
-	auto vit = _vfnum2id.find(_vfStack.top());
-	if (vit == _vfnum2id.end())
-		return -1;
-	const Num2IdMap &num2id = vit->second;
-	auto it = num2id.find(n);
-	return (it == num2id.end()) ? -1 : it->second;
+	else {
+		auto vit = _vfnum2id.find(_vfStack.top());
+		if (vit != _vfnum2id.end()) {
+			const Num2IdMap &num2id = vit->second;
+			auto it = num2id.find(n);
+			id = (it == num2id.end()) ? -1 : it->second;
+		}
+	}
+	_lastLookupNum = n;
+	_lastLookupID = id;
+	_lastLookupValid = true;
+	return id;
 }
 
 
@@ -65,10 +87,9 @@ int FontManager::fontID (int n) const {
  *  @param[in] font pointer to font object to be identified
  *  @return non-negative font ID if font was found, -1 otherwise */
 int FontManager::fontID (const Font *font) const {
-	for (size_t i=0; i < _fonts.size(); i++)
-		if (_fonts[i].get() == font)
-			return i;
-	return -1;
+	shared_lock<shared_timed_mutex> lock(_mutex);
+	auto it = _font2id.find(font);
+	return (it == _font2id.end()) ? -1 : it->second;
 }
 
 
@@ -76,6 +97,7 @@ int FontManager::fontID (const Font *font) const {
  *  @param[in] name name of font to be identified, e.g. cmr10
  *  @return non-negative font ID if font was found, -1 otherwise */
 int FontManager::fontID (const string &name) const {
+	shared_lock<shared_timed_mutex> lock(_mutex);
 	auto it = _name2id.find(name);
 	if (it == _name2id.end())
 		return -1;
@@ -84,6 +106,13 @@ int FontManager::fontID (const string &name) const {
 
 
 int FontManager::fontID (string name, double ptsize) const {
+	shared_lock<shared_timed_mutex> lock(_mutex);
+	return lookupNativeFontID(std::move(name), ptsize);
+}
+
+
+/** Like fontID(string, double) but must be called with the registry lock held. */
+int FontManager::lookupNativeFontID (string name, double ptsize) const {
 	std::replace(name.begin(), name.end(), '+', '-');
 	for (auto it = _fonts.begin(); it != _fonts.end(); ++it) {
 		if (auto nativeFont = font_cast<NativeFont*>(it->get())) {
@@ -96,6 +125,7 @@ int FontManager::fontID (string name, double ptsize) const {
 
 
 int FontManager::fontnum (int id) const {
+	shared_lock<shared_timed_mutex> lock(_mutex);
 	if (id < 0 || size_t(id) > _fonts.size())
 		return -1;
 	if (_vfStack.empty()) {
@@ -116,12 +146,14 @@ int FontManager::fontnum (int id) const {
 
 
 int FontManager::vfFirstFontNum (const VirtualFont *vf) const {
+	shared_lock<shared_timed_mutex> lock(_mutex);
 	auto it = _vfFirstFontNumMap.find(vf);
 	return (it == _vfFirstFontNumMap.end()) ? -1 : (int) it->second;
 }
 
 
 Font* FontManager::vfFirstFont (const VirtualFont *vf) const {
+	shared_lock<shared_timed_mutex> lock(_mutex);
 	auto it = _vfFirstFontMap.find(vf);
 	return (it == _vfFirstFontMap.end()) ? nullptr : it->second;
 }
@@ -131,21 +163,24 @@ Font* FontManager::vfFirstFont (const VirtualFont *vf) const {
  *  @param[in] n local font number, as used in DVI and VF files
  *  @return pointer to font if font was found, 0 otherwise */
 Font* FontManager::getFont (int n) const {
-	int id = fontID(n);
+	unique_lock<shared_timed_mutex> lock(_mutex);  // lookupFontID updates the memoized result
+	int id = lookupFontID(n);
 	return (id < 0) ? nullptr : _fonts[id].get();
 }
 
 
 Font* FontManager::getFont (const string &name) const {
-	int id = fontID(name);
-	if (id < 0)
+	shared_lock<shared_timed_mutex> lock(_mutex);
+	auto it = _name2id.find(name);
+	if (it == _name2id.end())
 		return nullptr;
-	return _fonts[id].get();
+	return _fonts[it->second].get();
 }
 
 
 Font* FontManager::getFont (const string &name, double ptsize) {
-	int id = fontID(name, ptsize);
+	shared_lock<shared_timed_mutex> lock(_mutex);
+	int id = lookupNativeFontID(name, ptsize);
 	if (id < 0)
 		return nullptr;
 	return _fonts[id].get();
@@ -153,6 +188,7 @@ Font* FontManager::getFont (const string &name, double ptsize) {
 
 
 Font* FontManager::getFontById (int id) const {
+	shared_lock<shared_timed_mutex> lock(_mutex);
 	if (id < 0 || size_t(id) >= _fonts.size())
 		return nullptr;
 	return _fonts[id].get();
@@ -161,6 +197,7 @@ Font* FontManager::getFontById (int id) const {
 
 /** Returns the current active virtual font. */
 const VirtualFont* FontManager::getVF () const {
+	shared_lock<shared_timed_mutex> lock(_mutex);
 	return _vfStack.empty() ? nullptr : _vfStack.top();
 }
 
@@ -196,7 +233,8 @@ static unique_ptr<Font> create_font (const string &filename, const string &fontn
  *  @param[in] ssize scaled size in PS point units
  *  @return id of registered font */
 int FontManager::registerFont (uint32_t fontnum, const string &name, uint32_t checksum, double dsize, double ssize) {
-	int id = fontID(fontnum);
+	unique_lock<shared_timed_mutex> lock(_mutex);
+	int id = lookupFontID(fontnum);
 	if (id >= 0)
 		return id;
 
@@ -246,6 +284,7 @@ int FontManager::registerFont (uint32_t fontnum, const string &name, uint32_t ch
 		_name2id.emplace(name, newid);
 	}
 	_fonts.push_back(std::move(newfont));
+	_font2id.emplace(_fonts.back().get(), newid);
 	if (_vfStack.empty())  // register font referenced in dvi file?
 		_num2id[fontnum] = newid;
 	else {  // register font referenced in vf file
@@ -254,6 +293,7 @@ int FontManager::registerFont (uint32_t fontnum, const string &name, uint32_t ch
 		_vfFirstFontNumMap.emplace(vf, fontnum);
 		_vfFirstFontMap.emplace(vf, _fonts.back().get());
 	}
+	_lastLookupValid = false;  // number mapping changed
 	return newid;
 }
 
@@ -281,7 +321,8 @@ int FontManager::registerFont (uint32_t fontnum, const string &filename, double
  *  @param[in] color global font color
  *  @return global font id */
 int FontManager::registerFont (uint32_t fontnum, const string &filename, int fontIndex, double ptsize, const FontStyle &style, Color color) {
-	int id = fontID(fontnum);
+	unique_lock<shared_timed_mutex> lock(_mutex);
+	int id = lookupFontID(fontnum);
 	if (id >= 0)
 		return id;
 
@@ -319,7 +360,9 @@ int FontManager::registerFont (uint32_t fontnum, const string &filename, int fon
 		_name2id.emplace(fontname, newid);
 	}
 	_fonts.push_back(std::move(newfont));
+	_font2id.emplace(_fonts.back().get(), newid);
 	_num2id[fontnum] = newid;
+	_lastLookupValid = false;  // number mapping changed
 	return newid;
 }
 
@@ -339,21 +382,23 @@ int FontManager::registerFont (const string &fname, string fontname, double ptsi
 	}
 	else if (!FileSystem::exists(fname) || (fontname.empty() && (fontname = FontEngine::instance().getPSName(fname)).empty()))
 		return -1;
-	int id = fontID(fontname, ptsize);
+	unique_lock<shared_timed_mutex> lock(_mutex);
+	int id = lookupNativeFontID(fontname, ptsize);
 	if (id >= 0)
 		return id;
 	unique_ptr<NativeFont> nativeFont;
-	id = fontID(fontname);
-	if (id < 0) {
+	auto it = _name2id.find(fontname);
+	if (it == _name2id.end()) {
 		nativeFont = util::make_unique<NativeFontImpl>(fname, fontname, ptsize);
 		_name2id.emplace(std::move(fontname), int(_fonts.size()));
 	}
 	else {
-		auto *nf = font_cast<NativeFont*>(getFontById(id));
+		auto *nf = font_cast<NativeFont*>(_fonts[it->second].get());
 		nativeFont = unique_ptr<NativeFont>(nf->clone(ptsize, FontStyle(), Color::BLACK));
 	}
 	id = int(_fonts.size());
 	_fonts.push_back(std::move(nativeFont));
+	_font2id.emplace(_fonts.back().get(), id);
 	return id;
 }
 
@@ -362,15 +407,21 @@ int FontManager::registerFont (const string &fname, string fontname, double ptsi
  *  This method must be called before processing a VF character.
  *  @param[in] vf virtual font */
 void FontManager::enterVF (VirtualFont *vf) {
-	if (vf)
+	if (vf) {
+		unique_lock<shared_timed_mutex> lock(_mutex);
 		_vfStack.push(vf);
+		_lastLookupValid = false;  // font numbers now refer to the entered VF
+	}
 }
 
 
 /** Leaves a previously entered virtual font frame. */
 void FontManager::leaveVF () {
-	if (!_vfStack.empty())
+	unique_lock<shared_timed_mutex> lock(_mutex);
+	if (!_vfStack.empty()) {
 		_vfStack.pop();
+		_lastLookupValid = false;  // font numbers now refer to the outer context
+	}
 }
 
 
@@ -378,12 +429,14 @@ void FontManager::leaveVF () {
  * @param[in] c character code
  * @param[in] dvi DVI commands that describe character c */
 void FontManager::assignVFChar (int c, vector<char> &&dvi) {
+	shared_lock<shared_timed_mutex> lock(_mutex);  // the stack is read, only the VF object is modified
 	if (!_vfStack.empty())
 		_vfStack.top()->assignChar(c, std::move(dvi));
 }
 
 
 void FontManager::addUsedChar (const Font &font, int c) {
+	unique_lock<shared_timed_mutex> lock(_mutex);
 	_usedChars[font.uniqueFont()].insert(c);
 	if (!SVGTree::USE_FONTS)
 		_usedChars[&font].insert(c);
@@ -392,11 +445,24 @@ void FontManager::addUsedChar (const Font &font, int c) {
 
 
 void FontManager::resetUsedChars () {
+	unique_lock<shared_timed_mutex> lock(_mutex);
 	_usedChars.clear();
 	_usedFonts.clear();
 }
 
 
+/** Drops the mapping from DVI font numbers to font IDs. This function must be
+ *  called before reconverting a modified DVI file in the same process since the
+ *  font numbers might refer to different fonts there. The fonts themselves stay
+ *  registered and are looked up by name when the new font definitions are read,
+ *  so already loaded font data is reused. */
+void FontManager::resetFontNumbers () {
+	unique_lock<shared_timed_mutex> lock(_mutex);
+	_num2id.clear();
+	_lastLookupValid = false;
+}
+
+
 ostream& FontManager::write (ostream &os, Font *font, int level) {
 #if 0
 	if (font) {
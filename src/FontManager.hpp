@@ -22,8 +22,10 @@
 #define FONTMANAGER_HPP
 
 #include <memory>
+#include <mutex>
 #include <ostream>
 #include <set>
+#include <shared_mutex>
 #include <string>
 #include <stack>
 #include <unordered_map>
@@ -41,10 +43,14 @@ class VirtualFont;
  *  DVI and VF files use local font numbers to reference fonts. For SVG output
  *  we need a single list with unique IDs of all physical fonts. Characters of
  *  virtual fonts are completely replaced by their DVI description so they don't
- *  appear anywhere in the output. */
+ *  appear anywhere in the output.
+ *  After the prescan phase the font registry is read-mostly: lookups may be
+ *  performed from concurrent worker threads and only take a shared lock, while
+ *  registrations of fonts discovered later go through an exclusive slow path. */
 class FontManager {
 	using CharMap = std::unordered_map<const Font*, std::set<int>>;
 	using FontSet = std::unordered_set<const Font*>;
+	using Font2IdMap = std::unordered_map<const Font*, int>;
 	using Num2IdMap = std::unordered_map<uint32_t, int>;
 	using Name2IdMap = std::unordered_map<std::string, int>;
 	using VfNum2IdMap = std::unordered_map<const VirtualFont*, Num2IdMap>;
@@ -75,6 +81,10 @@ class FontManager {
 		void assignVFChar (int c, std::vector<char> &&dvi);
 		void addUsedChar (const Font &font, int c);
 		void resetUsedChars ();
+		void resetFontNumbers ();
+		// The following accessors return references into the registry. They must
+		// only be used while no other thread registers fonts or characters.
+		const std::vector<std::unique_ptr<Font>>& getFonts () const {return _fonts;}
 		CharMap& getUsedChars ()  {return _usedChars;}
 		FontSet& getUsedFonts ()  {return _usedFonts;}
 		std::ostream& write (std::ostream &os, Font *font=nullptr, int level=0);
@@ -83,10 +93,20 @@ class FontManager {
 		FontManager () =default;
 
 	private:
+		int lookupFontID (int n) const;
+		int lookupNativeFontID (std::string name, double ptsize) const;
+
+	private:
+		/// protects the font registry; C++14 lacks std::shared_mutex, hence the timed variant
+		mutable std::shared_timed_mutex _mutex;
 		std::vector<std::unique_ptr<Font>> _fonts; ///< all registered Fonts
 		Num2IdMap      _num2id;    ///< DVI font number -> fontID
 		Name2IdMap     _name2id;   ///< fontname -> fontID
+		Font2IdMap     _font2id;   ///< font pointer -> fontID
 		VfNum2IdMap    _vfnum2id;
+		mutable int _lastLookupNum=0;        ///< font number of the most recent ID lookup
+		mutable int _lastLookupID=-1;        ///< result of the most recent ID lookup
+		mutable bool _lastLookupValid=false; ///< true if the most recent lookup result is still valid
 		VfStack        _vfStack;   ///< stack of currently processed virtual fonts
 		VfFirstFontNumMap _vfFirstFontNumMap; ///< VF -> local font number of first font defined in VF
 		VfFirstFontMap _vfFirstFontMap;       ///< VF -> first font defined
@@ -22,20 +22,32 @@
 #include <cstring>
 #include <fstream>
 #include <limits>
+#include <sstream>
 #include <vector>
 #include "CMap.hpp"
 #include "Directory.hpp"
 #include "FileFinder.hpp"
 #include "FilePath.hpp"
+#include "FileSystem.hpp"
+#include "Font.hpp"
 #include "FontManager.hpp"
 #include "FontMap.hpp"
 #include "MapLine.hpp"
 #include "Message.hpp"
+#include "StreamReader.hpp"
+#include "StreamWriter.hpp"
 #include "Subfont.hpp"
+#include "XXHashFunction.hpp"
 #include "utility.hpp"
 
 using namespace std;
 
+const uint8_t MAPCACHE_FORMAT_VERSION = 1;
+
+// Minimum size (in bytes) a map file must have to get a binary cache
+// representation. Caching tiny files wouldn't save any time.
+const uint64_t MIN_CACHEABLE_MAPFILE_SIZE = 4096;
+
 /** Returns the singleton instance. */
 FontMap& FontMap::instance() {
 	static FontMap fontmap;
@@ -49,10 +61,16 @@ FontMap& FontMap::instance() {
  *  @param[in,out] includedFilesRef pointer to sequence of (nested) file paths currently being included
  *  @return true if file could be opened */
 bool FontMap::read (const string &fname, FontMap::Mode mode, vector<string> *includedFilesRef) {
+	if (readFromCache(fname, mode))
+		return true;
 	ifstream ifs(fname);
 	if (!ifs)
 		return false;
 
+	// Collect the parsed lines of bigger map files, like pdftex.map, so that
+	// they can be restored from a compact binary representation on subsequent runs.
+	bool cacheworthy = !PhysicalFont::CACHE_PATH.empty() && FileSystem::filesize(fname) >= MIN_CACHEABLE_MAPFILE_SIZE;
+	vector<MapLine> maplines;
 	unique_ptr<vector<string>> includedFilesStore;
 	int lineNumber = 1;
 	while (ifs) {
@@ -63,11 +81,17 @@ bool FontMap::read (const string &fname, FontMap::Mode mode, vector<string> *inc
 			else if (c != '#') {
 				MapLine mapline(ifs);
 				apply(mapline, mode);
+				if (cacheworthy)
+					maplines.push_back(std::move(mapline));
 			}
 			else {
 				char line[256];
 				ifs.getline(line, 256);
 				if (strncmp(line, "#include ", 9) == 0 || strncmp(line, "#includefirst ", 14) == 0) {
+					// the resulting entries depend on the contents of other files, so
+					// this file can't be represented by a standalone cache file
+					cacheworthy = false;
+					maplines.clear();
 					FilePath path(fname);
 					if (!includedFilesRef && !includedFilesStore) {  // not yet inside an include chain?
 						includedFilesStore = util::make_unique<vector<string>>();
@@ -83,16 +107,23 @@ bool FontMap::read (const string &fname, FontMap::Mode mode, vector<string> *inc
 			lineNumber++;
 		}
 		catch (const MapLineException &e) {
+			// don't cache files containing invalid lines to preserve the warnings
+			cacheworthy = false;
+			maplines.clear();
 			Message::wstream(true) << FilePath(fname).shorterAbsoluteOrRelative()
 				<< ", line " << lineNumber << ": " << e.what() << '\n';
 		}
 		catch (const SubfontException &e) {
+			cacheworthy = false;
+			maplines.clear();
 			Message::wstream(true) << FilePath(e.filename()).shorterAbsoluteOrRelative();
 			if (e.lineno() > 0)
 				Message::wstream(false) << ", line " << e.lineno();
 			Message::wstream(false) << e.what() << '\n';
 		}
 	}
+	if (cacheworthy)
+		writeCache(fname, maplines);
 	return true;
 }
 
@@ -113,6 +144,118 @@ bool FontMap::read (const string &fname, char modechar, vector<string> *included
 }
 
 
+static void write_uint64 (StreamWriter &sw, HashFunction &hashfunc, uint64_t val) {
+	sw.writeUnsigned(uint32_t(val >> 32), 4, hashfunc);
+	sw.writeUnsigned(uint32_t(val & 0xFFFFFFFF), 4, hashfunc);
+}
+
+
+static uint64_t read_uint64 (StreamReader &sr) {
+	uint64_t val = uint64_t(sr.readUnsigned(4)) << 32;
+	return val | sr.readUnsigned(4);
+}
+
+
+static void write_double (StreamWriter &sw, HashFunction &hashfunc, double val) {
+	uint64_t bits;
+	memcpy(&bits, &val, sizeof(bits));
+	write_uint64(sw, hashfunc, bits);
+}
+
+
+static double read_double (StreamReader &sr) {
+	uint64_t bits = read_uint64(sr);
+	double val;
+	memcpy(&val, &bits, sizeof(val));
+	return val;
+}
+
+
+/** Returns the path of the binary cache file assigned to a given map file. */
+string FontMap::cacheFilePath (const string &fname) {
+	FilePath path(fname);
+	XXH64HashFunction hashfunc(path.absolute());
+	ostringstream oss;
+	oss << PhysicalFont::CACHE_PATH << '/' << path.filename() << '-' << hex << hashfunc.digestValue() << ".bin";
+	return oss.str();
+}
+
+
+/** Tries to restore the entries of a map file from its binary cache representation.
+ *  The cached data is only applied if its checksum is valid and if it still refers
+ *  to the current contents of the map file.
+ *  @param[in] fname path/name of the map file to be read
+ *  @param[in] mode selects how to integrate the map file entries into the global map tree
+ *  @return true if the cached entries have been applied */
+bool FontMap::readFromCache (const string &fname, Mode mode) {
+	if (PhysicalFont::CACHE_PATH.empty())
+		return false;
+	ifstream ifs(cacheFilePath(fname), ios::binary);
+	if (!ifs)
+		return false;
+	StreamReader sr(ifs);
+	if (sr.readUnsigned(1) != MAPCACHE_FORMAT_VERSION)
+		return false;
+	uint32_t checksum = sr.readUnsigned(4);
+	XXH32HashFunction hashfunc;
+	hashfunc.update(ifs);
+	if (hashfunc.digestValue() != checksum)
+		return false;
+	ifs.clear();
+	ifs.seekg(5);  // continue reading after the checksum
+	if (sr.readString() != FilePath(fname).absolute())
+		return false;
+	if (int64_t(read_uint64(sr)) != FileSystem::mtime(fname) || read_uint64(sr) != FileSystem::filesize(fname))
+		return false;  // map file has changed? => cached data is stale
+	auto numlines = sr.readUnsigned(4);
+	while (numlines-- > 0) {
+		string texname = sr.readString();
+		string sfdname = sr.readString();
+		string psname = sr.readString();
+		string fontfname = sr.readString();
+		string encname = sr.readString();
+		int fontindex = sr.readSigned(4);
+		double slant = read_double(sr);
+		double bold = read_double(sr);
+		double extend = read_double(sr);
+		MapLine mapline(std::move(texname), sfdname, std::move(psname), std::move(fontfname), std::move(encname), fontindex, slant, bold, extend);
+		apply(mapline, mode);
+	}
+	return true;
+}
+
+
+/** Writes the binary representation of a parsed map file to the cache directory.
+ *  @param[in] fname path/name of the map file the entries were read from
+ *  @param[in] maplines parsed map lines to be cached */
+void FontMap::writeCache (const string &fname, const vector<MapLine> &maplines) const {
+	ofstream ofs(cacheFilePath(fname), ios::binary);
+	if (!ofs)
+		return;
+	StreamWriter sw(ofs);
+	XXH32HashFunction hashfunc;
+	sw.writeUnsigned(MAPCACHE_FORMAT_VERSION, 1);
+	sw.writeUnsigned(0, 4);  // space for checksum to be written below
+	sw.writeString(FilePath(fname).absolute(), hashfunc, true);
+	write_uint64(sw, hashfunc, uint64_t(FileSystem::mtime(fname)));
+	write_uint64(sw, hashfunc, FileSystem::filesize(fname));
+	sw.writeUnsigned(uint32_t(maplines.size()), 4, hashfunc);
+	for (const MapLine &mapline : maplines) {
+		sw.writeString(mapline.texname(), hashfunc, true);
+		sw.writeString(mapline.sfd() ? mapline.sfd()->name() : "", hashfunc, true);
+		sw.writeString(mapline.psname(), hashfunc, true);
+		sw.writeString(mapline.fontfname(), hashfunc, true);
+		sw.writeString(mapline.encname(), hashfunc, true);
+		sw.writeSigned(mapline.fontindex(), 4, hashfunc);
+		write_double(sw, hashfunc, mapline.slant());
+		write_double(sw, hashfunc, mapline.bold());
+		write_double(sw, hashfunc, mapline.extend());
+	}
+	ofs.seekp(1);
+	sw.writeUnsigned(hashfunc.digestValue(), 4);  // patch checksum of the data written
+}
+
+
 /** Evaluates an #include statement and processes the contents of the included map file.
  *  @param[in] line parameters of #include statement (optional mode character and file name/path
  *  @param[in] includingFile path of file containing the #include statement
@@ -72,6 +72,9 @@ class FontMap {
 		FontMap () =default;
 		void include (std::string line, const FilePath &includingFile, std::vector<std::string> &includedFiles);
 		void includefirst (std::string line, const FilePath &includingFile, std::vector<std::string> &includedFiles);
+		bool readFromCache (const std::string &fname, Mode mode);
+		void writeCache (const std::string &fname, const std::vector<MapLine> &maplines) const;
+		static std::string cacheFilePath (const std::string &fname);
 
 	private:
 		std::unordered_map<std::string,std::unique_ptr<Entry>> _entries;
@@ -23,6 +23,7 @@
 #include "FileFinder.hpp"
 #include "FontMetrics.hpp"
 #include "JFM.hpp"
+#include "MappedInputStream.hpp"
 #include "OFM.hpp"
 #include "utility.hpp"
 
@@ -42,11 +43,15 @@ unique_ptr<FontMetrics> FontMetrics::read (const string &fontname) {
 	const char *path = FileFinder::instance().lookup(fontname + ".ofm", false);
 	if (!path)
 		path = FileFinder::instance().lookup(fontname + ".tfm");
-	ifstream ifs(path, ios::binary);
-	if (ifs) {
-		auto id = read_uint16(ifs);
+	if (!path)
+		return metrics;
+	unique_ptr<istream> is = util::make_unique<MappedInputStream>(path);
+	if (!*is)  // file not mappable? fall back to buffered reading
+		is = util::make_unique<ifstream>(path, ios::binary);
+	if (*is) {
+		auto id = read_uint16(*is);
 		if (id == 0) {   // OFM?
-			auto ofmLevel = read_uint16(ifs);
+			auto ofmLevel = read_uint16(*is);
 			if (ofmLevel == 0)
 				metrics = util::make_unique<OFM0>();
 			else if (ofmLevel == 1)
@@ -58,7 +63,9 @@ unique_ptr<FontMetrics> FontMetrics::read (const string &fontname) {
 			metrics = util::make_unique<JFM>();
 		else
 			metrics = util::make_unique<TFM>();
-		metrics->read(ifs);
+		istream &stream = *is;
+		metrics->assignStream(std::move(is));  // allows the reader to defer decoding the metric tables
+		metrics->read(stream);
 	}
 	return metrics;
 }
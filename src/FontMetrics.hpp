@@ -48,6 +48,17 @@ struct FontMetrics {
 	virtual bool isJFM () const {return false;}
 	virtual bool isOFM () const {return false;}
 	static std::unique_ptr<FontMetrics> read (const std::string &fontname);
+
+	/** Passes the ownership of the stream the metrics are read from to this object.
+	 *  If the object owns the stream, it may keep it open and defer the decoding
+	 *  of the metric tables until their values are actually accessed. */
+	void assignStream (std::unique_ptr<std::istream> is) {_is = std::move(is);}
+
+	protected:
+		std::istream* ownedStream () const {return _is.get();}
+
+	private:
+		std::unique_ptr<std::istream> _is;  ///< stream assigned to this object (may be nullptr)
 };
 
 
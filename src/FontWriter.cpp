@@ -27,6 +27,7 @@
 using namespace std;
 
 bool FontWriter::AUTOHINT_FONTS = false;
+int FontWriter::COMPRESSION_LEVEL = 11;
 
 const array<FontWriter::FontFormatInfo, 4> FontWriter::_formatInfos {{
 	{FontWriter::FontFormat::SVG, "image/svg+xml", "svg", "svg"},
@@ -70,6 +71,9 @@ vector<string> FontWriter::supportedFormats () {
 // dummy functions used if WOFF support is disabled
 FontWriter::FontWriter (const PhysicalFont &font) : _currentFont(font) {}
 std::string FontWriter::createFontFile (FontFormat format, const set<int> &charcodes, GFGlyphTracer::Callback *cb) const {return "";}
+std::string FontWriter::createTTF (const set<int> &charcodes, GFGlyphTracer::Callback *cb) const {return "";}
+std::string FontWriter::convertTTF (FontFormat format, const std::string &ttfname) const {return "";}
+std::string FontWriter::cssFontFaceRule (FontFormat format, const std::string &ttfname) const {return "";}
 bool FontWriter::writeCSSFontFace (FontFormat format, const set<int> &charcodes, ostream &os, GFGlyphTracer::Callback *cb) const {return false;}
 #else
 #include <cmath>
@@ -83,14 +87,52 @@ bool FontWriter::writeCSSFontFace (FontFormat format, const set<int> &charcodes,
 #include "Glyph.hpp"
 #include "ttf/TTFAutohint.hpp"
 #include "ttf/TTFWriter.hpp"
+#include "XXHashFunction.hpp"
 
 using namespace ttf;
 
+/** Returns the path of the cache file assigned to the autohinted variant of a font,
+ *  or an empty string if the font cache is disabled.
+ *  @param[in] fontname name of the font
+ *  @param[in] ttfdata unhinted TTF data the hinted variant is created from */
+static string hinted_cache_path (const string &fontname, const string &ttfdata) {
+	if (PhysicalFont::CACHE_PATH.empty())
+		return "";
+	XXH64HashFunction hashfunc(ttfdata);
+	ostringstream oss;
+	oss << PhysicalFont::CACHE_PATH << '/' << fontname << "-hinted-" << hex << hashfunc.digestValue() << ".ttf";
+	return oss.str();
+}
+
+
+/** Tries to replace TTF data with its hinted variant stored in the font cache.
+ *  Since the hash of the unhinted data is part of the cache file name, a present
+ *  file always refers to the current font and glyph subset.
+ *  @param[in] cachepath path of the cache file ("" if caching is disabled)
+ *  @param[in,out] ttfdata TTF data to be replaced
+ *  @return true if the cached data has been applied */
+static bool read_hinted_font (const string &cachepath, string &ttfdata) {
+	if (cachepath.empty())
+		return false;
+	ifstream ifs(cachepath, ios::binary);
+	if (!ifs)
+		return false;
+	ostringstream oss;
+	oss << ifs.rdbuf();
+	if (oss.str().empty())
+		return false;
+	ttfdata = oss.str();
+	return true;
+}
+
+
 bool FontWriter::createTTFFile (const std::string &ttfname, const PhysicalFont &font, const set<int> &charcodes, GFGlyphTracer::Callback *cb) const {
 	TTFWriter ttfWriter(font, charcodes);
 	if (cb)
 		ttfWriter.setTracerCallback(*cb);
-	bool ok = ttfWriter.writeTTF(ttfname);
+	ostringstream oss;
+	bool ok = ttfWriter.writeTTF(oss);
+	string ttfdata = oss.str();
 	if (ok && AUTOHINT_FONTS) {
 		TTFAutohint autohinter;
 		if (!autohinter.available()) {
@@ -101,56 +143,105 @@ bool FontWriter::createTTFFile (const std::string &ttfname, const PhysicalFont &
 			}
 		}
 		else {
-			string tmpname = ttfname+"-ah";
-			try {
-				int errnum = autohinter.autohint(ttfname, tmpname, true);
-				if (errnum == 0) {  // success?
-					FileSystem::remove(ttfname);
-					FileSystem::rename(tmpname, ttfname);
-				}
-				else {
+			// The autohinter processes the entire font, which can take a while. Since the
+			// unhinted TTF data created for a given font and glyph subset is identical on
+			// every run, the hinted fonts are cached keyed by a hash of the unhinted data.
+			string cachepath = hinted_cache_path(_font.name(), ttfdata);
+			if (!read_hinted_font(cachepath, ttfdata)) {
+				int errnum = autohinter.autohint(ttfdata, true);
+				if (errnum) {  // failed? keep the unhinted TTF data
 					Message::wstream(true) << "failed to autohint font '" << _font.name() << "'";
 					string msg = autohinter.lastErrorMessage();
 					if (!msg.empty())
 						Message::wstream() << " (" << msg << ")";
-					// keep the unhinted TTF
-					FileSystem::remove(tmpname);
 				}
-			}
-			catch (MessageException &e) {
-				Message::wstream(true) << e.what() << '\n';
-				FileSystem::remove(tmpname);
+				else if (!cachepath.empty()) {
+					ofstream cacheOfs(cachepath, ios::binary);
+					cacheOfs.write(ttfdata.data(), streamsize(ttfdata.size()));
+				}
 			}
 		}
 	}
+	if (ok) {
+		ofstream ofs(ttfname, ios::binary);
+		ok = bool(ofs.write(ttfdata.data(), streamsize(ttfdata.size())));
+	}
 	return ok;
 }
 
 
+/** Creates a temporary TTF file containing a given set of glyphs mapped to their
+ *  Unicode points. This function must be called from the main thread since the
+ *  glyph tracing it involves accesses shared state like the font cache.
+ * @param[in] charcodes character codes of the glyphs to be considered
+ * @param[in] cb callback object that allows to react to events triggered by the glyph tracer
+ * @return name of the created TTF file */
+string FontWriter::createTTF (const set<int> &charcodes, GFGlyphTracer::Callback *cb) const {
+	string ttfname = FileSystem::tmpdir()+_font.name()+"-tmp.ttf";
+	if (!createTTFFile(ttfname, _font, charcodes, cb))
+		throw FontWriterException("failed writing ttf file "+ttfname);
+	return ttfname;
+}
+
+
+/** Converts a previously created TTF file to the target font format and removes
+ *  the TTF file afterwards. Since only local data is involved, this function may
+ *  be executed concurrently for different fonts.
+ * @param[in] format target font format
+ * @param[in] ttfname name of the TTF file to be converted
+ * @return name of the font file in the target format */
+string FontWriter::convertTTF (FontFormat format, const string &ttfname) const {
+	if (format == FontFormat::TTF)
+		return ttfname;
+	string targetname = ttfname.substr(0, ttfname.length()-3)+fontFormatInfo(format)->formatstr_short;
+	bool ok = true;
+	if (format == FontFormat::WOFF)
+		ok = TTFWriter::convertTTFToWOFF(ttfname, targetname);
+	else if (format == FontFormat::WOFF2)
+		TTFWriter::convertTTFToWOFF2(ttfname, targetname);
+	if (!PhysicalFont::KEEP_TEMP_FILES)
+		FileSystem::remove(ttfname);
+	if (!ok)
+		throw FontWriterException("failed writing "+string(fontFormatInfo(format)->formatstr_short)+ " file " + targetname);
+	return targetname;
+}
+
+
 /** Creates a font file containing a given set of glyphs mapped to their Unicode points.
  * @param[in] format target font format
  * @param[in] charcodes character codes of the glyphs to be considered
  * @param[in] cb callback object that allows to react to events triggered by the glyph tracer
  * @return name of the created font file */
 string FontWriter::createFontFile (FontFormat format, const set<int> &charcodes, GFGlyphTracer::Callback *cb) const {
-	string tmpdir = FileSystem::tmpdir();
-	string basename = tmpdir+_font.name()+"-tmp";
-	string ttfname = basename+".ttf";
-	string targetname = basename+"."+fontFormatInfo(format)->formatstr_short;
-	bool ok = createTTFFile(ttfname, _font, charcodes, cb);
-	if (ok) {
-		if (format == FontFormat::WOFF || format == FontFormat::WOFF2) {
-			if (format == FontFormat::WOFF)
-				ok = TTFWriter::convertTTFToWOFF(ttfname, targetname);
-			else
-				TTFWriter::convertTTFToWOFF2(ttfname, targetname);
-			if (!PhysicalFont::KEEP_TEMP_FILES)
-				FileSystem::remove(ttfname);
-		}
-	}
-	if (!ok)
-		throw FontWriterException("failed writing "+string(fontFormatInfo(format)->formatstr_short)+ " file " + targetname);
-	return targetname;
+	return convertTTF(format, createTTF(charcodes, cb));
+}
+
+
+/** Returns a CSS font-face rule that contains the data of a given TTF file converted
+ *  to the target font format. The temporary font files are removed afterwards.
+ *  In contrast to writeCSSFontFace, no glyph tracing is involved here, so this
+ *  function may be executed concurrently for different fonts.
+ * @param[in] format target font format
+ * @param[in] ttfname name of the TTF file providing the font data
+ * @return the font-face rule, or an empty string on failure */
+string FontWriter::cssFontFaceRule (FontFormat format, const string &ttfname) const {
+	const FontFormatInfo *info = fontFormatInfo(format);
+	if (!info)
+		return "";
+	string filename = convertTTF(format, ttfname);
+	ifstream ifs(filename, ios::binary);
+	if (!ifs)
+		return "";
+	ostringstream oss;
+	oss << "@font-face{"
+		<< "font-family:" << _font.name() << ';'
+		<< "src:url(data:" << info->mimetype << ";base64,";
+	util::base64_copy(ifs, oss);
+	oss << ") format('" << info->formatstr_long << "');}\n";
+	ifs.close();
+	if (!PhysicalFont::KEEP_TEMP_FILES)
+		FileSystem::remove(filename);
+	return oss.str();
 }
 
 
@@ -161,22 +252,13 @@ string FontWriter::createFontFile (FontFormat format, const set<int> &charcodes,
  * @param[in] cb callback object that allows to react to events triggered by the glyph tracer
  * @return true on success */
 bool FontWriter::writeCSSFontFace (FontFormat format, const set<int> &charcodes, ostream &os, GFGlyphTracer::Callback *cb) const {
-	if (const FontFormatInfo *info = fontFormatInfo(format)) {
-		string filename = createFontFile(format, charcodes, cb);
-		ifstream ifs(filename, ios::binary);
-		if (ifs) {
-			os << "@font-face{"
-				<< "font-family:" << _font.name() << ';'
-				<< "src:url(data:" << info->mimetype << ";base64,";
-			util::base64_copy(ifs, os);
-			os << ") format('" << info->formatstr_long << "');}\n";
-			ifs.close();
-			if (!PhysicalFont::KEEP_TEMP_FILES)
-				FileSystem::remove(filename);
-			return true;
-		}
-	}
-	return false;
+	if (!fontFormatInfo(format))
+		return false;
+	string cssRule = cssFontFaceRule(format, createTTF(charcodes, cb));
+	if (cssRule.empty())
+		return false;
+	os << cssRule;
+	return true;
 }
 
 #endif // !DISABLE_WOFF
@@ -34,10 +34,14 @@ class FontWriter {
 	public:
 		enum class FontFormat {UNKNOWN, SVG, TTF, WOFF, WOFF2};
 		static bool AUTOHINT_FONTS;
+		static int COMPRESSION_LEVEL;  ///< compression level (0-11) applied when creating WOFF/WOFF2 fonts
 
 	public:
 		explicit FontWriter (const PhysicalFont &font) : _font(font) {}
 		std::string createFontFile (FontFormat format, const std::set<int> &charcodes, GFGlyphTracer::Callback *cb=nullptr) const;
+		std::string createTTF (const std::set<int> &charcodes, GFGlyphTracer::Callback *cb=nullptr) const;
+		std::string convertTTF (FontFormat format, const std::string &ttfname) const;
+		std::string cssFontFaceRule (FontFormat format, const std::string &ttfname) const;
 		bool writeCSSFontFace (FontFormat format, const std::set<int> &charcodes, std::ostream &os, GFGlyphTracer::Callback *cb=nullptr) const;
 		static FontFormat toFontFormat (std::string formatstr);
 		static std::vector<std::string> supportedFormats ();
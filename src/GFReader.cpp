@@ -116,13 +116,56 @@ bool GFReader::executeChar (uint8_t c) {
 	auto it = _charInfoMap.find(c);
 	if (_in && it != _charInfoMap.end()) {
 		_in.seekg(it->second.location);
-		while (executeCommand() != 69);  // execute all commands until eoc is reached
+		// execute all commands until eoc is reached; sequences of painting
+		// commands inside the character definition are decoded in one pass
+		while (executeCommand() != 69) {
+			if (_insideCharDef)
+				decodeRuns();
+		}
 		return true;
 	}
 	return false;
 }
 
 
+/** Decodes contiguous sequences of the painting commands paint_0...paint3,
+ *  skip0...skip3, and new_row_0...new_row_164, which make up almost the entire
+ *  byte stream of a character definition. Handling them in a tight loop avoids
+ *  the per-command dispatch overhead of executeCommand(), and the pixel runs are
+ *  painted directly into the word-organized bitmap as they are decoded. The
+ *  method returns as soon as a non-painting command is found, which is then
+ *  processed by executeCommand() as usual. */
+void GFReader::decodeRuns () {
+	int opcode;
+	while ((opcode = _in.peek()) >= 0) {
+		if (opcode <= 66) {            // paint_0...paint3: paint/skip a horizontal run of pixels
+			_in.get();
+			int32_t n = opcode <= 63 ? opcode : int32_t(readUnsigned(opcode-63));
+			if (_penDown)  // set pixels?
+				_bitmap.setBits(_y, _x, n);
+			_x += n;
+			_penDown = !_penDown;  // invert pen state
+		}
+		else if (opcode >= 70 && opcode <= 73) {  // skip0...skip3: skip rows
+			_in.get();
+			_y -= opcode == 70 ? 1 : int32_t(readUnsigned(opcode-70))+1;
+			_x = _minX;
+			_penDown = false;
+			SignalHandler::instance().check();  // check once per row rather than once per command
+		}
+		else if (opcode >= 74 && opcode <= 238) { // new_row_0...new_row_164: start next row at column opcode-74
+			_in.get();
+			_x = _minX + opcode-74;
+			_y--;
+			_penDown = true;
+			SignalHandler::instance().check();
+		}
+		else  // non-painting command => let executeCommand() dispatch it
+			break;
+	}
+}
+
+
 bool GFReader::executeAllChars () {
 	_in.clear();
 	if (_charInfoMap.empty())
@@ -130,7 +173,10 @@ bool GFReader::executeAllChars () {
 	_in.clear();
 	if (_in) {
 		_in.seekg(0);
-		while (executeCommand() != 248); // execute all commands until postamble is reached
+		while (executeCommand() != 248) {  // execute all commands until postamble is reached
+			if (_insideCharDef)
+				decodeRuns();
+		}
 		return true;
 	}
 	return false;
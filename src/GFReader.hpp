@@ -71,6 +71,7 @@ class GFReader {
 		uint32_t readUnsigned (int bytes);
 		std::string readString (int len);
 		int executeCommand ();
+		void decodeRuns ();
 		std::istream& getInputStream () const {return _in;}
 
 		void cmdPre (int);
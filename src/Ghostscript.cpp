@@ -321,6 +321,21 @@ int Ghostscript::set_stdio (Stdin in, Stdout out, Stderr err) {
 }
 
 
+/** Sets the poll callback function which Ghostscript calls periodically
+ *  during longer operations. A non-zero return value of the callback
+ *  interrupts the interpreter, e.g. to enforce a page deadline.
+ * @param[in] poll pointer to poll handler */
+int Ghostscript::set_poll (Poll poll) {
+#if defined(HAVE_LIBGS)
+	return gsapi_set_poll(_inst, poll);
+#else
+	if (auto fn = LOAD_SYMBOL(gsapi_set_poll))
+		return fn(_inst, poll);
+	return 0;
+#endif
+}
+
+
 /** Initializes Ghostscript with a set of optional parameters. This
  *  method is called by the constructor and should not be used elsewhere.
  *  @param[in] argc number of paramters
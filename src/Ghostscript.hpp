@@ -42,6 +42,7 @@ struct Ghostscript {
 	using Stdin  = int (GSDLLCALLPTR)(void *caller, char *buf, int len);
 	using Stdout = int (GSDLLCALLPTR)(void *caller, const char *str, int len);
 	using Stderr = int (GSDLLCALLPTR)(void *caller, const char *str, int len);
+	using Poll   = int (GSDLLCALLPTR)(void *caller);
 
 	Ghostscript () {}
 	Ghostscript (int argc, const char **argv, void *caller=0) {}
@@ -51,6 +52,7 @@ struct Ghostscript {
 	int revision () const {return 0;}
 	std::string revisionstr () {return "";}
 	int set_stdio (Stdin in, Stdout out, Stderr err) {return 0;}
+	int set_poll (Poll poll) {return 0;}
 	int run_string_begin (int user_errors, int *pexit_code) {return 0;}
 	int run_string_continue (const char *str, unsigned int length, int user_errors, int *pexit_code) {return 0;}
 	int run_string_end (int user_errors, int *pexit_code) {return 0;}
@@ -70,6 +72,7 @@ class Ghostscript
 		using Stdin  = int (GSDLLCALLPTR)(void *caller, char *buf, int len);
 		using Stdout = int (GSDLLCALLPTR)(void *caller, const char *str, int len);
 		using Stderr = int (GSDLLCALLPTR)(void *caller, const char *str, int len);
+		using Poll   = int (GSDLLCALLPTR)(void *caller);
 
 	public:
 		Ghostscript ();
@@ -82,6 +85,7 @@ class Ghostscript
 		int revision () const;
 		std::string revisionstr ();
 		int set_stdio (Stdin in, Stdout out, Stderr err);
+		int set_poll (Poll poll);
 		int run_string_begin (int user_errors, int *pexit_code);
 		int run_string_continue (const char *str, unsigned int length, int user_errors, int *pexit_code);
 		int run_string_end (int user_errors, int *pexit_code);
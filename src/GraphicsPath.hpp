@@ -24,10 +24,10 @@
 #include <array>
 #include <cctype>
 #include <cmath>
-#include <deque>
+#include <cstdint>
 #include <ostream>
 #include <type_traits>
-#include <mpark/variant.hpp>
+#include <vector>
 #include "BoundingBox.hpp"
 #include "EllipticalArc.hpp"
 #include "Matrix.hpp"
@@ -162,7 +162,6 @@ operator != (const Cmd1 &cmd1, const Cmd2 &cmd2) {
 
 }  // namespace gp
 
-
 template <typename T>
 class GraphicsPath {
 	friend class PathClipper;
@@ -186,14 +185,6 @@ class GraphicsPath {
 			return str;
 		}
 
-		static std::string to_param_str (const Point &p, double sx, double sy, double dx, double dy, bool leadingSpace) {
-			return to_param_str(p.x(), sx, dx, leadingSpace) + to_param_str(p.y(), sy, dy, true);
-		}
-
-		static std::string to_param_str (const Point &p, const Point &prev, double sx, double sy, double dx, double dy, bool leadingSpace) {
-			return to_param_str(p.x()-prev.x(), sx, dx, leadingSpace) + to_param_str(p.y()-prev.y(), sy, dy, true);
-		}
-
 		using MoveTo = gp::MoveTo<T>;
 		using LineTo = gp::LineTo<T>;
 		using CubicTo = gp::CubicTo<T>;
@@ -201,16 +192,48 @@ class GraphicsPath {
 		using ArcTo = gp::ArcTo<T>;
 		using ClosePath = gp::ClosePath<T>;
 
-		/// Variant representing a single path command
-		using CommandVariant = mpark::variant<MoveTo, LineTo, CubicTo, QuadTo, ArcTo, ClosePath>;
+		/// Opcodes identifying the path commands in the opcode sequence
+		enum class CommandType : uint8_t {MOVETO, LINETO, QUADTO, CUBICTO, ARCTO, CLOSEPATH};
+
+		/** Shape parameters of an arc segment. They are kept in a separate array so that
+		 *  the common commands consist of an opcode plus their point coordinates only.
+		 *  The end point of an arc is stored in the coordinate array like those of the
+		 *  other commands. */
+		struct ArcParams {
+			T rx, ry;          ///< length of the semi-major and semi-minor axes
+			double xrotation;  ///< rotation of the semi-major axis in degrees
+			bool largeArcFlag; ///< if true, the longer arc from start to end point is chosen, else the shorter one
+			bool sweepFlag;    ///< if true, arc is drawn in direction of positive angles, else the opposite direction
+
+			bool operator == (const ArcParams &arc) const {
+				return rx == arc.rx
+					&& ry == arc.ry
+					&& xrotation == arc.xrotation
+					&& largeArcFlag == arc.largeArcFlag
+					&& sweepFlag == arc.sweepFlag;
+			}
+		};
+
+		/// Returns the number of coordinate values belonging to a command of the given type.
+		static size_t coordCount (CommandType type) {
+			switch (type) {
+				case CommandType::QUADTO    : return 4;
+				case CommandType::CUBICTO   : return 6;
+				case CommandType::CLOSEPATH : return 0;
+				default                     : return 2;  // MOVETO, LINETO, ARCTO
+			}
+		}
 
-		class IterationVisitor;
+		/// Returns the point whose coordinates are stored at the given position of the coordinate array.
+		Point pointAt (size_t coordPos) const {
+			return Point(_coords[coordPos], _coords[coordPos+1]);
+		}
 
 	public:
 		/** Base class providing several template methods being called when executing
 		 *  GraphicsPath::iterate(). */
 		class IterationActions {
-			friend class IterationVisitor;
+			friend class GraphicsPath;
 			public:
 				virtual ~IterationActions () =default;
 				virtual void moveto (const Point &p) {}
@@ -250,8 +273,8 @@ class GraphicsPath {
 
 		class WriteActions : public IterationActions {
 			public:
-				WriteActions (std::ostream &os, bool rel, double sx, double sy, double dx, double dy)
-					: _os(os), _relative(rel), _sx(sx), _sy(sy), _dx(dx), _dy(dy) {}
+				WriteActions (std::string &str, bool rel, double sx, double sy, double dx, double dy)
+					: _str(str), _relative(rel), _sx(sx), _sy(sy), _dx(dx), _dy(dy) {}
 
 				void moveto (const Point &p) override  {write('M', {p});}
 				void lineto (const Point &p) override  {write('L', {p});}
@@ -261,7 +284,7 @@ class GraphicsPath {
 				void quadto (const Point &p1, const Point &p2) override {write('Q', {p1, p2});}
 				void cubicto (const Point &p1, const Point &p2) override {write('S', {p1, p2});}
 				void cubicto (const Point &p1, const Point &p2, const Point &p3) override {write('C', {p1, p2, p3});}
-				void closepath () override {_os << (_relative ? 'z' : 'Z');}
+				void closepath () override {_str += (_relative ? 'z' : 'Z');}
 
 				void arcto (T rx, T ry, double angle, bool largeArcFlag, bool sweepFlag, const Point &p) override {
 					Point diff = p-this->currentPoint();
@@ -282,158 +305,62 @@ class GraphicsPath {
 							rx = arc.rx();
 							ry = arc.ry();
 						}
-						_os << (_relative ? 'a' : 'A')
-							 << to_param_str(rx, 1.0, 0, false)
-							 << to_param_str(ry, 1.0, 0, true)
-							 << to_param_str(angle, 1.0, 0, true)
-							 << ' ' << (largeArcFlag ? 1 : 0)
-							 << ' ' << (sweepFlag ? 1 : 0);
-						if (_relative)
-							_os << to_param_str(p, this->currentPoint(), _sx, _sy, _dx, _dy, true);
-						else
-							_os << to_param_str(p, _sx, _sy, _dx, _dy, true);
+						_str += (_relative ? 'a' : 'A');
+						_str += to_param_str(rx, 1.0, 0, false);
+						_str += to_param_str(ry, 1.0, 0, true);
+						_str += to_param_str(angle, 1.0, 0, true);
+						_str += ' ';
+						_str += (largeArcFlag ? '1' : '0');
+						_str += ' ';
+						_str += (sweepFlag ? '1' : '0');
+						if (_relative) {
+							_str += to_param_str(p.x()-this->currentPoint().x(), _sx, _dx, true);
+							_str += to_param_str(p.y()-this->currentPoint().y(), _sy, _dy, true);
+						}
+						else {
+							_str += to_param_str(p.x(), _sx, _dx, true);
+							_str += to_param_str(p.y(), _sy, _dy, true);
+						}
 					}
 				}
 
 			protected:
+				/** Appends a command character and its point parameters to the output string.
+				 *  The coordinate values are appended one at a time so that no concatenated
+				 *  temporary strings exceeding the small-string buffer are created. */
 				void write (char cmdchar, std::initializer_list<Point> points) const {
 					int count=0;
 					if (_relative) {
-						_os << char(tolower(cmdchar));
-						for (const Point &p : points)
-							_os << to_param_str(p, this->currentPoint(), _sx, _sy, _dx, _dy, count++ > 0);
+						_str += char(tolower(cmdchar));
+						for (const Point &p : points) {
+							_str += to_param_str(p.x()-this->currentPoint().x(), _sx, _dx, count++ > 0);
+							_str += to_param_str(p.y()-this->currentPoint().y(), _sy, _dy, true);
+						}
 					}
 					else {
-						_os << cmdchar;
-						for (const Point &p : points)
-							_os << to_param_str(p, _sx, _sy, _dx, _dy, count++ > 0);
+						_str += cmdchar;
+						for (const Point &p : points) {
+							_str += to_param_str(p.x(), _sx, _dx, count++ > 0);
+							_str += to_param_str(p.y(), _sy, _dy, true);
+						}
 					}
 				}
 
 				void write (char cmdchar, T val, T relval, double s, double d) const {
+					_str += _relative ? char(tolower(cmdchar)) : cmdchar;
 					if (_relative)
-						_os << char(tolower(cmdchar)) << to_param_str(val, relval, s, d, false);
+						_str += to_param_str(val, relval, s, d, false);
 					else
-						_os << cmdchar << to_param_str(val, s, d, false);
+						_str += to_param_str(val, s, d, false);
 				}
 
 			private:
-				std::ostream &_os;  ///< write output to this stream
+				std::string &_str;  ///< append the SVG commands to this string
 				bool _relative;     ///< if true, use relative coordinates in path commands
 				double _sx, _sy;    ///< horizontal and vertical scaling factors
 				double _dx, _dy;    ///< horizontal and vertical translation values
 		};
 
-		///////////////////////////////////////////////////////////////////////////////
-
-		/** Calls the corresponding template method of an Action object for the current path command.
-		 *  If parameter 'useShortCmds' is true, the visitor operators check whether a command
-		 *  can be shortened due to special cases, e.g. horizontal or vertical lines, smooth
-		 *  curve connections etc. Otherwise, the full command templates are triggered. */
-		class IterationVisitor {
-			public:
-				IterationVisitor (IterationActions &actions, bool useShortCmds, double eps=1e-7)
-					: _actions(actions), _shortCommandsActive(useShortCmds), _eps(eps) {}
-
-				void setPrevCommand (const CommandVariant &prevCommand) {
-					_prevCommand = &prevCommand;
-				}
-
-				void operator () (const MoveTo &cmd) {
-					_actions.moveto(cmd.points[0]);
-					_actions._startPoint = _actions._currentPoint = cmd.points[0];
-				}
-
-				void operator () (const LineTo &cmd) {
-					Point diff = abs(_actions._currentPoint-cmd.points[0]);
-					if (diff.x() >= _eps || diff.y() >= _eps) {
-						if (!_shortCommandsActive)
-							_actions.lineto(cmd.points[0]);
-						else {
-							if (diff.x() < _eps)
-								_actions.vlineto(cmd.points[0].y());
-							else if (diff.y() < _eps)
-								_actions.hlineto(cmd.points[0].x());
-							else
-								_actions.lineto(cmd.points[0]);
-						}
-					}
-					_actions._currentPoint = cmd.points[0];
-				}
-
-				void operator () (const CubicTo &cmd) {
-					bool smooth=false;
-					if (_shortCommandsActive) {
-						if (auto *prevCubic = mpark::get_if<CubicTo>(_prevCommand)) {
-							Point diff = abs(cmd.points[0] - prevCubic->points[2]*T(2) + prevCubic->points[1]);
-							if ((smooth = (diff.x() < _eps && diff.y() < _eps)))
-								_actions.cubicto(cmd.points[1], cmd.points[2]);
-						}
-					}
-					if (!smooth)
-						_actions.cubicto(cmd.points[0], cmd.points[1], cmd.points[2]);
-					_actions._currentPoint = cmd.points[2];
-				}
-
-				void operator () (const QuadTo &cmd) {
-					bool smooth=false;
-					if (_shortCommandsActive) {
-						if (auto *prevQuad = mpark::get_if<QuadTo>(_prevCommand)) {
-							Point diff = abs(cmd.points[0] - prevQuad->points[1] * T(2) + prevQuad->points[0]);
-							if ((smooth = (diff.x() < _eps && diff.y() < _eps)))  // is reflection?
-								_actions.quadto(cmd.points[1]);
-						}
-					}
-					if (!smooth)
-						_actions.quadto(cmd.points[0], cmd.points[1]);
-					_actions._currentPoint = cmd.points[1];
-				}
-
-				void operator () (const ClosePath &cmd) {
-					_actions.closepath();
-					_actions._currentPoint = _actions._startPoint;
-				}
-
-				void operator () (const ArcTo &cmd) {
-					_actions.arcto(cmd.rx, cmd.ry, cmd.xrotation, cmd.largeArcFlag, cmd.sweepFlag, cmd.points[0]);
-					_actions._currentPoint = cmd.points[0];
-				}
-
-			private:
-				IterationActions &_actions;
-				bool _shortCommandsActive=false;
-				double _eps=1e-7;
-				const CommandVariant *_prevCommand=nullptr;
-		};
-
-		///////////////////////////////////////////////////////////////////////////////
-
-		/** Transforms all Point parameters of a path command. */
-		class TransformVisior {
-			public:
-				explicit TransformVisior (const Matrix &m) : matrix(m) {}
-
-				template <typename Cmd>	void operator () (Cmd &cmd) {
-					Point cp = cmd.point(cmd.numPoints()-1);
-					cmd.transform(matrix, _currentPoint);
-					_currentPoint = cp;
-				}
-
-				void operator () (MoveTo &cmd) {
-					Point cp = cmd.point(0);
-					cmd.transform(matrix, _currentPoint);
-					_startPoint = _currentPoint = cp;
-				}
-
-				void operator () (ClosePath &cmd) {
-					_currentPoint = _startPoint;
-				}
-
-			private:
-				const Matrix &matrix;
-				Point _startPoint, _currentPoint;  ///< untransformed start end current point
-		};
-
 	public:
 		explicit GraphicsPath (WindingRule wr=WindingRule::NON_ZERO) : _windingRule(wr) {}
 
@@ -441,17 +368,35 @@ class GraphicsPath {
 		WindingRule windingRule () const     {return _windingRule;}
 
 		void clear () {
-			_commands.clear();
+			_opcodes.clear();
+			_coords.clear();
+			_arcs.clear();
+		}
+
+		/** Preallocates storage for a number of additional path commands and
+		 *  coordinate values to avoid reallocations while building the path.
+		 *  @param[in] numCommands expected number of additional path commands
+		 *  @param[in] numCoords expected number of additional coordinate values */
+		void reserve (size_t numCommands, size_t numCoords) {
+			_opcodes.reserve(_opcodes.size()+numCommands);
+			_coords.reserve(_coords.size()+numCoords);
 		}
 
 		/// Returns true if the path is empty, i.e. there is nothing to draw
 		bool empty () const {
-			return _commands.empty();
+			return _opcodes.empty();
+		}
+
+		/// Returns the number of bytes allocated to store the path data.
+		size_t memSize () const {
+			return _opcodes.capacity()*sizeof(CommandType)
+				+ _coords.capacity()*sizeof(T)
+				+ _arcs.capacity()*sizeof(ArcParams);
 		}
 
 		/// Returns the number of path commands used to describe the path.
 		size_t size () const {
-			return _commands.size();
+			return _opcodes.size();
 		}
 
 		const Point& startPoint () const {return _startPoint;}
@@ -459,7 +404,9 @@ class GraphicsPath {
 
 		/// Insert another path at the beginning of this one.
 		void prepend (const GraphicsPath &path) {
-			_commands.insert(_commands.begin(), path._commands.begin(), path._commands.end());
+			_opcodes.insert(_opcodes.begin(), path._opcodes.begin(), path._opcodes.end());
+			_coords.insert(_coords.begin(), path._coords.begin(), path._coords.end());
+			_arcs.insert(_arcs.begin(), path._arcs.begin(), path._arcs.end());
 		}
 
 		void moveto (const T &x, const T &y) {
@@ -468,10 +415,15 @@ class GraphicsPath {
 
 		void moveto (const Point &p) {
 			// avoid sequences of several MOVETOs; always use latest
-			if (_commands.empty() || !mpark::get_if<MoveTo>(&_commands.back()))
-				_commands.emplace_back(MoveTo{p});
-			else
-				mpark::get<MoveTo>(_commands.back()).points[0] = p;
+			if (_opcodes.empty() || _opcodes.back() != CommandType::MOVETO) {
+				_opcodes.push_back(CommandType::MOVETO);
+				_coords.push_back(p.x());
+				_coords.push_back(p.y());
+			}
+			else {
+				_coords[_coords.size()-2] = p.x();
+				_coords[_coords.size()-1] = p.y();
+			}
 			_startPoint = _finalPoint = p;
 		}
 
@@ -480,7 +432,9 @@ class GraphicsPath {
 		}
 
 		void lineto (const Point &p) {
-			_commands.emplace_back(LineTo{p});
+			_opcodes.push_back(CommandType::LINETO);
+			_coords.push_back(p.x());
+			_coords.push_back(p.y());
 			_finalPoint = p;
 		}
 
@@ -490,7 +444,11 @@ class GraphicsPath {
 
 		/** Creates a quadratic Bézier segment. */
 		void quadto (const Point &p1, const Point &p2) {
-			_commands.emplace_back(QuadTo{p1, p2});
+			_opcodes.push_back(CommandType::QUADTO);
+			_coords.push_back(p1.x());
+			_coords.push_back(p1.y());
+			_coords.push_back(p2.x());
+			_coords.push_back(p2.y());
 			_finalPoint = p2;
 		}
 
@@ -500,9 +458,9 @@ class GraphicsPath {
 		 *  point. */
 		void quadto (const Point &p2) {
 			Point p1;
-			if (!_commands.empty()) {
-				if (auto qto = mpark::get_if<QuadTo>(&_commands.back()))
-					p1 = _finalPoint*T(2) - qto->point(0);  // reflect previous control point at current point
+			if (!_opcodes.empty()) {
+				if (_opcodes.back() == CommandType::QUADTO)
+					p1 = _finalPoint*T(2) - pointAt(_coords.size()-4);  // reflect previous control point at current point
 				else                  // previous command isn't a quadto?
 					p1 = _finalPoint;  // => use current point as control point
 			}
@@ -515,7 +473,13 @@ class GraphicsPath {
 
 		/** Creates a cubic Bézier segment. */
 		void cubicto (const Point &p1, const Point &p2, const Point &p3) {
-			_commands.emplace_back(CubicTo{p1, p2, p3});
+			_opcodes.push_back(CommandType::CUBICTO);
+			_coords.push_back(p1.x());
+			_coords.push_back(p1.y());
+			_coords.push_back(p2.x());
+			_coords.push_back(p2.y());
+			_coords.push_back(p3.x());
+			_coords.push_back(p3.y());
 			_finalPoint = p3;
 		}
 
@@ -525,9 +489,9 @@ class GraphicsPath {
 		 *  point at the connection point. */
 		void cubicto (const Point &p2, const Point &p3) {
 			Point p1;
-			if (!_commands.empty()) {
-				if (auto cto = mpark::get_if<CubicTo>(&_commands.back()))
-					p1 = _finalPoint*T(2) - cto->point(1);  // reflect previous control point at current point
+			if (!_opcodes.empty()) {
+				if (_opcodes.back() == CommandType::CUBICTO)
+					p1 = _finalPoint*T(2) - pointAt(_coords.size()-4);  // reflect previous control point at current point
 				else                  // previous command isn't a cubicto?
 					p1 = _finalPoint;  // => use current point as control point
 			}
@@ -535,14 +499,17 @@ class GraphicsPath {
 		}
 
 		void closepath () {
-			if (!_commands.empty() && !mpark::get_if<ClosePath>(&_commands.back())) {
-				_commands.emplace_back(ClosePath{});
+			if (!_opcodes.empty() && _opcodes.back() != CommandType::CLOSEPATH) {
+				_opcodes.push_back(CommandType::CLOSEPATH);
 				_finalPoint = _startPoint;
 			}
 		}
 
 		void arcto (T rx, T ry, double angle, bool laf, bool sweep, const Point &p) {
-			_commands.emplace_back(ArcTo{rx, ry, angle, laf, sweep, p});
+			_opcodes.push_back(CommandType::ARCTO);
+			_coords.push_back(p.x());
+			_coords.push_back(p.y());
+			_arcs.push_back(ArcParams{rx < 0 ? -rx : rx, ry < 0 ? -ry : ry, angle, laf, sweep});
 			_finalPoint = p;
 		}
 
@@ -551,37 +518,59 @@ class GraphicsPath {
 		 *	 in the glyph's outline description. All open paths are automatically closed by the renderer.
 		 *	 This method detects all open paths and adds the missing closePath statement. */
 		void closeOpenSubPaths () {
-			CommandVariant *prevCmd = nullptr;
-			for (auto it=_commands.begin(); it != _commands.end(); ++it) {
-				if (mpark::get_if<MoveTo>(&*it) && prevCmd && !mpark::get_if<ClosePath>(prevCmd)) {
-					prevCmd = &*it;
-					it = _commands.insert(it, ClosePath{})+1;
+			for (size_t i=1; i < _opcodes.size(); i++) {
+				if (_opcodes[i] == CommandType::MOVETO && _opcodes[i-1] != CommandType::CLOSEPATH) {
+					// a closepath command doesn't carry any coordinates, so only the
+					// opcode sequence must be changed
+					_opcodes.insert(_opcodes.begin()+i, CommandType::CLOSEPATH);
+					i++;
 				}
-				else
-					prevCmd = &*it;
 			}
-			if (!_commands.empty() && !mpark::get_if<ClosePath>(&_commands.back()))
+			if (!_opcodes.empty() && _opcodes.back() != CommandType::CLOSEPATH)
 				closepath();
 		}
 
 		/** Removes redundant path commands commands. Currently, only removes movetos. */
 		void removeRedundantCommands () {
 			// remove trailing moveto commands
-			while (!_commands.empty() && mpark::get_if<MoveTo>(&_commands.back()))
-				_commands.pop_back();
-			// resolve intermediate sequences of moveto commands
-			auto it=_commands.begin();
-			if (it == _commands.end())
-				return;
-			auto prev = it++;
-			while (it != _commands.end()) {
-				if (!mpark::get_if<MoveTo>(&*prev) || !mpark::get_if<MoveTo>(&*it))
-					prev = it++;
+			while (!_opcodes.empty() && _opcodes.back() == CommandType::MOVETO) {
+				_opcodes.pop_back();
+				_coords.resize(_coords.size()-2);
+			}
+			// resolve intermediate sequences of moveto commands, keeping only the last one of each run
+			size_t wop=0, wcoord=0, rcoord=0;
+			for (size_t i=0; i < _opcodes.size(); i++) {
+				CommandType op = _opcodes[i];
+				size_t count = coordCount(op);
+				if (op == CommandType::MOVETO && i+1 < _opcodes.size() && _opcodes[i+1] == CommandType::MOVETO)
+					rcoord += count;  // drop leading moveto of a sequence
 				else {
-					prev = _commands.erase(prev);  // remove leading MOVETO and advance 'prev' to 'it'
-					++it;
+					_opcodes[wop++] = op;
+					for (size_t k=0; k < count; k++)
+						_coords[wcoord++] = _coords[rcoord++];
 				}
 			}
+			_opcodes.resize(wop);
+			_coords.resize(wcoord);
+		}
+
+		/** Creates the SVG path data, i.e. the value of the "d" attribute, describing the path.
+		 *  The returned string is preallocated based on the number of commands and coordinates
+		 *  so that the drawing commands are formatted directly into the final buffer.
+		 *  @param[in] relative if true, create relative rather than absolute coordinate values
+		 *  @param[in] sx horizontal scale factor
+		 *  @param[in] sy vertical scale factor
+		 *  @param[in] dx horizontal translation in PS point units
+		 *  @param[in] dy vertical translation in PS point units
+		 *  @return the SVG drawing commands describing the path */
+		std::string svgPathData (bool relative, double sx=1.0, double sy=1.0, double dx=0.0, double dy=0.0) const {
+			std::string str;
+			// estimated capacity: one character per command, about 8 characters per coordinate
+			// value ("-123.456" plus separator), and the shape parameters of the arc segments
+			str.reserve(_opcodes.size() + 8*_coords.size() + 24*_arcs.size());
+			WriteActions actions(str, relative, sx, sy, dx, dy);
+			iterate(actions, true);
+			return str;
 		}
 
 		/** Writes the path data as SVG path drawing command to a given output stream.
@@ -592,26 +581,36 @@ class GraphicsPath {
 		 *  @param[in] dx horizontal translation in PS point units
 		 *  @param[in] dy vertical translation in PS point units */
 		void writeSVG (std::ostream &os, bool relative, double sx=1.0, double sy=1.0, double dx=0.0, double dy=0.0) const {
-			WriteActions actions(os, relative, sx, sy, dx, dy);
-			iterate(actions, true);
+			os << svgPathData(relative, sx, sy, dx, dy);
 		}
 
-		/** Computes the bounding box of the current path.
+		/** Computes the bounding box of the current path. Since all point coordinates,
+		 *  including the Bézier control points, contribute to the box, it can be
+		 *  accumulated in a single bulk pass over the coordinate array. Only arc
+		 *  segments require an additional walk along the command sequence to embed
+		 *  their extents.
 		 *  @param[out] bbox the computed bounding box */
 		BoundingBox computeBBox () const {
 			BoundingBox bbox;
-			struct BBoxActions : IterationActions {
-				explicit BBoxActions (BoundingBox &bb) : bbox(bb) {}
-				void moveto (const Point &p) override {bbox.embed(p);}
-				void lineto (const Point &p) override {bbox.embed(p);}
-				void quadto (const Point &p1, const Point &p2) override {bbox.embed(p1); bbox.embed(p2);}
-				void cubicto (const Point &p1, const Point &p2, const Point &p3) override {bbox.embed(p1); bbox.embed(p2); bbox.embed(p3);}
-				void arcto (T rx, T ry, double angle, bool laf, bool sweep, const Point &p) override {
-					bbox.embed(EllipticalArc(this->currentPoint(), double(rx), double(ry), angle, laf, sweep, p).getBBox());
+			bbox.embed(_coords);
+			if (!_arcs.empty()) {
+				size_t coordPos=0, arcPos=0;
+				Point startPoint, currentPoint;
+				for (CommandType op : _opcodes) {
+					if (op == CommandType::ARCTO) {
+						const ArcParams &params = _arcs[arcPos++];
+						bbox.embed(EllipticalArc(currentPoint, double(params.rx), double(params.ry), params.xrotation, params.largeArcFlag, params.sweepFlag, pointAt(coordPos)).getBBox());
+					}
+					if (op == CommandType::CLOSEPATH)
+						currentPoint = startPoint;
+					else {
+						currentPoint = pointAt(coordPos + coordCount(op) - 2);
+						if (op == CommandType::MOVETO)
+							startPoint = currentPoint;
+					}
+					coordPos += coordCount(op);
 				}
-				BoundingBox &bbox;
-			} actions(bbox);
-			iterate(actions, false);
+			}
 			return bbox;
 		}
 
@@ -641,36 +640,75 @@ class GraphicsPath {
 				explicit ArcActions (GraphicsPath &path) : ModificationActions(path) {}
 				void arcto (T rx, T ry, double angle, bool largeArcFlag, bool sweepFlag, const Point &p) override {
 					EllipticalArc arc(this->currentPoint(), rx, ry, angle, largeArcFlag, sweepFlag, p);
-					std::vector<CommandVariant> cmds;
+					std::vector<CubicTo> cmds;
 					for (const CubicBezier &bezier : arc.approximate())
-						cmds.emplace_back(CubicTo{bezier.point(1), bezier.point(2), bezier.point(3)});
+						cmds.emplace_back(CubicTo{Point(bezier.point(1)), Point(bezier.point(2)), Point(bezier.point(3))});
 					this->path().replace(this->commandPos(), cmds);
 				}
 			} actions(*this);
 			iterate(actions);
 		}
 
-		/** Transforms the path according to a given Matrix.
+		/** Transforms the path according to a given Matrix. Since the point coordinates
+		 *  are stored in a contiguous array, they are processed in a single flat pass
+		 *  the compiler can vectorize. Only the shape parameters of arc segments require
+		 *  a preceding walk over the command sequence.
 		 *  @param[in] matrix Matrix describing the affine transformation */
 		void transform (const Matrix &matrix) {
-			TransformVisior visior(matrix);
-			for (CommandVariant &command : _commands)
-				mpark::visit(visior, command);
+			if (!_arcs.empty())
+				transformArcParams(matrix);
+			const double a = matrix.get(0, 0), b = matrix.get(0, 1), c = matrix.get(0, 2);
+			const double d = matrix.get(1, 0), e = matrix.get(1, 1), f = matrix.get(1, 2);
+			for (size_t i=0; i < _coords.size(); i+=2) {
+				double x = _coords[i], y = _coords[i+1];
+				Point p(DPair(a*x + b*y + c, d*x + e*y + f));
+				_coords[i] = p.x();
+				_coords[i+1] = p.y();
+			}
 		}
 
+	protected:
+		/** Updates the shape parameters of all arc segments according to a given
+		 *  transformation matrix. The point coordinates, including the arc end
+		 *  points, are left untouched. */
+		void transformArcParams (const Matrix &matrix) {
+			size_t coordPos=0, arcPos=0;
+			Point startPoint, currentPoint;
+			for (CommandType op : _opcodes) {
+				if (op == CommandType::ARCTO) {
+					ArcParams &params = _arcs[arcPos++];
+					EllipticalArc arc(currentPoint, double(params.rx), double(params.ry), math::deg2rad(params.xrotation), params.largeArcFlag, params.sweepFlag, pointAt(coordPos));
+					arc.transform(matrix);
+					params.rx = arc.rx();
+					params.ry = arc.ry();
+					params.xrotation = math::rad2deg(arc.rotationAngle());
+					params.largeArcFlag = arc.largeArc();
+					params.sweepFlag = arc.sweepPositive();
+				}
+				if (op == CommandType::CLOSEPATH)
+					currentPoint = startPoint;
+				else {
+					currentPoint = pointAt(coordPos + coordCount(op) - 2);
+					if (op == CommandType::MOVETO)
+						startPoint = currentPoint;
+				}
+				coordPos += coordCount(op);
+			}
+		}
+
+	public:
+
 		/** Returns true if this path equals another one, i.e. it consists the same sequence
 		 *  of commands and coordinates. */
 		bool operator == (const GraphicsPath &path) const {
-			if (size() != path.size())
-				return false;
-			return std::equal(_commands.begin(), _commands.end(), path._commands.begin());
+			return _opcodes == path._opcodes
+				&& _coords == path._coords
+				&& _arcs == path._arcs;
 		}
 
 		/** Returns true if this path differs from another one (command-wise). */
 		bool operator != (const GraphicsPath &path) const {
-			if (size() != path.size())
-				return true;
-			return !std::equal(_commands.begin(), _commands.end(), path._commands.begin());
+			return !(*this == path);
 		}
 
 		/** Iterates over all commands defining this path and calls the corresponding template methods.
@@ -682,47 +720,168 @@ class GraphicsPath {
 		 *  @param[in] optimize if true, shorthand drawing commands (hlineto, vlineto,...) are considered */
 		void iterate (IterationActions &actions, bool optimize) const {
 			double eps = XMLString::DECIMAL_PLACES > 0 ? std::pow(10, -XMLString::DECIMAL_PLACES) : 1e-7;
-			IterationVisitor visitor(actions, optimize, eps);
-			for (const CommandVariant &cmd : _commands) {
+			size_t coordPos=0, arcPos=0, prevCoordPos=0;
+			CommandType prevOp = CommandType::CLOSEPATH;  // no shorthand for the first command
+			for (CommandType op : _opcodes) {
 				if (actions.quit())
 					break;
-				mpark::visit(visitor, cmd);
-				visitor.setPrevCommand(cmd);
+				executeCommand(actions, op, coordPos, arcPos, prevOp, prevCoordPos, optimize, eps);
+				if (op == CommandType::ARCTO)
+					arcPos++;
+				prevOp = op;
+				prevCoordPos = coordPos;
+				coordPos += coordCount(op);
 			}
 			actions.finished();
 		}
 
 	protected:
-		/** Replaces a command by a sequence of other ones.
+		/** Executes a single path command by calling the corresponding action methods.
+		 *  If parameter 'optimize' is true, it's checked whether a command can be
+		 *  shortened due to special cases, e.g. horizontal or vertical lines, smooth
+		 *  curve connections etc. Otherwise, the full command templates are triggered.
+		 *  All data of the current command is read before the action methods are
+		 *  invoked, so the latter may safely modify the path.
+		 *  @param[in] actions template methods called for the current command
+		 *  @param[in] op opcode of the current command
+		 *  @param[in] coordPos position of the command's coordinates in the coordinate array
+		 *  @param[in] arcPos position of the command's shape parameters in the arc array
+		 *  @param[in] prevOp opcode of the preceding command
+		 *  @param[in] prevCoordPos position of the preceding command's coordinates
+		 *  @param[in] optimize if true, shorthand drawing commands (hlineto, vlineto,...) are considered
+		 *  @param[in] eps threshold below which two coordinate values are considered equal */
+		void executeCommand (IterationActions &actions, CommandType op, size_t coordPos, size_t arcPos, CommandType prevOp, size_t prevCoordPos, bool optimize, double eps) const {
+			switch (op) {
+				case CommandType::MOVETO: {
+					Point p = pointAt(coordPos);
+					actions.moveto(p);
+					actions._startPoint = actions._currentPoint = p;
+					break;
+				}
+				case CommandType::LINETO: {
+					Point p = pointAt(coordPos);
+					Point diff = abs(actions._currentPoint-p);
+					if (diff.x() >= eps || diff.y() >= eps) {
+						if (!optimize)
+							actions.lineto(p);
+						else {
+							if (diff.x() < eps)
+								actions.vlineto(p.y());
+							else if (diff.y() < eps)
+								actions.hlineto(p.x());
+							else
+								actions.lineto(p);
+						}
+					}
+					actions._currentPoint = p;
+					break;
+				}
+				case CommandType::QUADTO: {
+					Point p1 = pointAt(coordPos), p2 = pointAt(coordPos+2);
+					bool smooth=false;
+					if (optimize && prevOp == CommandType::QUADTO) {
+						Point diff = abs(p1 - pointAt(prevCoordPos+2)*T(2) + pointAt(prevCoordPos));
+						if ((smooth = (diff.x() < eps && diff.y() < eps)))  // is reflection?
+							actions.quadto(p2);
+					}
+					if (!smooth)
+						actions.quadto(p1, p2);
+					actions._currentPoint = p2;
+					break;
+				}
+				case CommandType::CUBICTO: {
+					Point p1 = pointAt(coordPos), p2 = pointAt(coordPos+2), p3 = pointAt(coordPos+4);
+					bool smooth=false;
+					if (optimize && prevOp == CommandType::CUBICTO) {
+						Point diff = abs(p1 - pointAt(prevCoordPos+4)*T(2) + pointAt(prevCoordPos+2));
+						if ((smooth = (diff.x() < eps && diff.y() < eps)))
+							actions.cubicto(p2, p3);
+					}
+					if (!smooth)
+						actions.cubicto(p1, p2, p3);
+					actions._currentPoint = p3;
+					break;
+				}
+				case CommandType::ARCTO: {
+					ArcParams params = _arcs[arcPos];
+					Point p = pointAt(coordPos);
+					actions.arcto(params.rx, params.ry, params.xrotation, params.largeArcFlag, params.sweepFlag, p);
+					actions._currentPoint = p;
+					break;
+				}
+				case CommandType::CLOSEPATH:
+					actions.closepath();
+					actions._currentPoint = actions._startPoint;
+					break;
+			}
+		}
+
+		/** Replaces the command at a given position by a sequence of cubic Bézier curves.
 		 *  @param[in] pos position of command to replace (0-based)
 		 *  @param[in] cmds commands to insert */
-		void replace (int pos, const std::vector<CommandVariant> &cmds) {
-			auto it = _commands.end();
-			if (!_commands.empty()) {
-				it = _commands.begin()+pos;
-				it = _commands.erase(it);
+		void replace (int pos, const std::vector<CubicTo> &cmds) {
+			size_t coordPos=0, arcPos=0;
+			for (int i=0; i < pos; i++) {
+				coordPos += coordCount(_opcodes[i]);
+				if (_opcodes[i] == CommandType::ARCTO)
+					arcPos++;
+			}
+			// remove the command together with its coordinates and shape parameters
+			CommandType op = _opcodes[pos];
+			_coords.erase(_coords.begin()+coordPos, _coords.begin()+coordPos+coordCount(op));
+			if (op == CommandType::ARCTO)
+				_arcs.erase(_arcs.begin()+arcPos);
+			_opcodes.erase(_opcodes.begin()+pos);
+			// insert the replacement commands
+			_opcodes.insert(_opcodes.begin()+pos, cmds.size(), CommandType::CUBICTO);
+			std::vector<T> coords;
+			coords.reserve(6*cmds.size());
+			for (const CubicTo &cmd : cmds) {
+				for (int i=0; i < 3; i++) {
+					coords.push_back(cmd.point(i).x());
+					coords.push_back(cmd.point(i).y());
+				}
 			}
-			_commands.insert(it, cmds.begin(), cmds.end());
+			_coords.insert(_coords.begin()+coordPos, coords.begin(), coords.end());
+			_modified = true;
 		}
 
 		/** Iterates over all commands of the path and calls the corresponding template methods.
 		 *  In contrast to the public iterate() method, this one allows to modify the command sequence.
 		 *  @param[in] actions template methods called by each iteration step */
 		void iterate (ModificationActions &actions) {
-			IterationVisitor visitor(actions, false);
-			// no iterators here since they may be invalidated during path modifications
-			for (size_t i=0; i < _commands.size(); i++) {
+			size_t coordPos=0, arcPos=0;
+			for (size_t i=0; i < _opcodes.size(); i++) {
 				if (actions.quit())
 					break;
 				actions._commandPos = i;
-				mpark::visit(visitor, _commands[i]);
-				visitor.setPrevCommand(_commands[i]);
+				CommandType op = _opcodes[i];
+				executeCommand(actions, op, coordPos, arcPos, CommandType::CLOSEPATH, 0, false, 1e-7);
+				if (!_modified) {
+					if (op == CommandType::ARCTO)
+						arcPos++;
+					coordPos += coordCount(op);
+				}
+				else {
+					// the action modified the command sequence; recompute the cursor
+					// positions for the next iteration step
+					_modified = false;
+					coordPos = arcPos = 0;
+					for (size_t k=0; k <= i && k < _opcodes.size(); k++) {
+						coordPos += coordCount(_opcodes[k]);
+						if (_opcodes[k] == CommandType::ARCTO)
+							arcPos++;
+					}
+				}
 			}
 			actions.finished();
 		}
 
 	private:
-		std::deque<CommandVariant> _commands; ///< sequence of path commands
+		std::vector<CommandType> _opcodes; ///< opcode sequence of the path commands
+		std::vector<T> _coords;            ///< contiguous array holding the point coordinates of all commands
+		std::vector<ArcParams> _arcs;      ///< shape parameters of the arc commands in path order
+		bool _modified=false;              ///< set if the command sequence was changed during an iteration
 		WindingRule _windingRule = WindingRule::NON_ZERO;
 		Point _startPoint; ///< start point of final sub-path
 		Point _finalPoint; ///< final point reached by last command in path
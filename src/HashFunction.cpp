@@ -34,7 +34,7 @@ vector<string> HashFunction::supportedAlgorithms () {
 	return vector<string> {
 		"md5", "xxh32", "xxh64",
 #ifdef ENABLE_XXH128
-		"xxh128"
+		"xxh3", "xxh128"
 #endif
 	};
 }
@@ -48,7 +48,7 @@ bool HashFunction::isSupportedAlgorithm (const std::string &algo) {
 
 
 /** Creates a hash function for a given algorithm name/identifier.
- *  The following names are currently supported: md5, xxh32, xxh64. */
+ *  The following names are currently supported: md5, xxh32, xxh64, xxh3, xxh128. */
 unique_ptr<HashFunction> HashFunction::create (const string &name) {
 	string lowerName = util::tolower(name);
 	if (lowerName == "md5")
@@ -58,6 +58,8 @@ unique_ptr<HashFunction> HashFunction::create (const string &name) {
 	if (lowerName == "xxh64")
 		return util::make_unique<XXH64HashFunction>();
 #ifdef ENABLE_XXH128
+	if (lowerName == "xxh3")
+		return util::make_unique<XXH3HashFunction>();
 	if (lowerName == "xxh128")
 		return util::make_unique<XXH128HashFunction>();
 #endif
@@ -37,6 +37,7 @@ class HashFunction {
 		virtual void update (const std::vector<uint8_t> &data) =0;
 		virtual std::vector<uint8_t> digestBytes () const =0;
 		void update (std::istream &is);
+		void update (const uint8_t *data, size_t length) {update(reinterpret_cast<const char*>(data), length);}
 		std::string digestString () const;
 		static std::vector<std::string> supportedAlgorithms ();
 		static bool isSupportedAlgorithm (const std::string &algo);
@@ -29,6 +29,7 @@ class SpecialActions;
 
 class HtmlSpecialHandler : public SpecialHandler {
 	public:
+		bool requiresPreprocessing () const override {return true;}
 		void preprocess (const std::string &prefix, std::istream &is, SpecialActions &actions) override;
 		bool process (const std::string &prefix, std::istream &is, SpecialActions &actions) override;
 		const char* info () const override {return "hyperref specials";}
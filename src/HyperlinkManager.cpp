@@ -102,9 +102,18 @@ void HyperlinkManager::createLink (string uri, SpecialActions &actions) {
 		}
 	}
 	if (!_base.empty() && uri.find("://") != string::npos) {
-		if (*_base.rbegin() != '/' && uri[0] != '/' && uri[0] != '#')
-			uri = "/" + uri;
-		uri = _base + uri;
+		// The same absolute targets are usually referenced over and over again,
+		// so keep the resolved URIs around instead of recombining them with the
+		// base URL on every link.
+		auto it = _resolvedUris.find(uri);
+		if (it == _resolvedUris.end()) {
+			string resolved = _base;
+			if (*_base.rbegin() != '/' && uri[0] != '/' && uri[0] != '#')
+				resolved += '/';
+			resolved += uri;
+			it = _resolvedUris.emplace(std::move(uri), std::move(resolved)).first;
+		}
+		uri = it->second;
 	}
 	auto anchorNode = util::make_unique<SVGElement>("a");
 	anchorNode->addAttribute("xlink:href", uri);
@@ -123,6 +132,7 @@ void HyperlinkManager::closeAnchor (SpecialActions &actions) {
 		_depthThreshold = 0;
 	}
 	_anchorType = AnchorType::NONE;
+	_markerRect = _coverRect = nullptr;  // don't merge boxes of different links
 }
 
 
@@ -139,31 +149,60 @@ void HyperlinkManager::checkNewLine (SpecialActions &actions) {
 }
 
 
+/** Checks whether two boxes share the same horizontal extent and touch or overlap
+ *  vertically, i.e. whether their union is again a rectangle. If so, the first box
+ *  is replaced by the union of both boxes.
+ *  @param[in,out] box box to be extended
+ *  @param[in] addbox box to be merged into the first one
+ *  @param[in] tolerance maximum vertical gap allowed between the two boxes
+ *  @return true if the boxes have been merged */
+static bool merge_boxes (BoundingBox &box, const BoundingBox &addbox, double tolerance) {
+	if (box.minX() != addbox.minX() || box.maxX() != addbox.maxX())
+		return false;
+	if (addbox.minY() > box.maxY()+tolerance || box.minY() > addbox.maxY()+tolerance)
+		return false;
+	box.embed(addbox);
+	return true;
+}
+
+
 /** Marks a single rectangular area of the linked part of the document with a line or
  *  a box so that it's noticeable by the user. Additionally, an invisible rectangle is
  *  placed over this area in order to avoid flickering of the mouse cursor when moving
- *  it over the hyperlinked area. */
+ *  it over the hyperlinked area. If the area continues the previously marked fragment
+ *  of the same link, the rectangles created for that fragment are extended rather
+ *  than adding further ones. */
 void HyperlinkManager::markLinkedBox (SpecialActions &actions) {
 	const BoundingBox &bbox = actions.bbox("{anchor}");
 	if (bbox.width() > 0 && bbox.height() > 0) {  // does the bounding box extend in both dimensions?
 		if (MARKER_TYPE != MarkerType::NONE) {
 			const double linewidth = _linewidth >= 0 ? _linewidth : min(0.5, bbox.height()/15);
-			auto rect = util::make_unique<SVGElement>("rect");
 			double x = bbox.minX();
 			double y = bbox.maxY()+linewidth;
 			double w = bbox.width();
 			double h = linewidth;
 			const Color strokeColor = COLORSOURCE == ColorSource::DEFAULT ? actions.getStrokeColor() : LINK_LINECOLOR;
 			const Color fillColor = COLORSOURCE == ColorSource::DEFAULT ? actions.getFillColor() : LINK_LINECOLOR;
-			if (MARKER_TYPE == MarkerType::LINE)
-				rect->setFillColor(fillColor);
-			else {
+			if (MARKER_TYPE != MarkerType::LINE) {
 				const double offset = _linewidth < 0 ? linewidth : 0 ;
 				x -= offset;
 				y = bbox.minY()-offset;
 				w += 2*offset;
 				h += bbox.height()+offset;
-				if (MARKER_TYPE == MarkerType::BGCOLOR) {
+			}
+			bool extendable = _markerRect
+				&& linewidth == _markerLinewidth
+				&& strokeColor == _markerStrokeColor
+				&& fillColor == _markerFillColor;
+			if (extendable && merge_boxes(_markerBox, BoundingBox(x, y, x+w, y+h), linewidth)) {
+				_markerRect->addAttribute("y", _markerBox.minY());
+				_markerRect->addAttribute("height", _markerBox.height());
+			}
+			else {
+				auto rect = util::make_unique<SVGElement>("rect");
+				if (MARKER_TYPE == MarkerType::LINE)
+					rect->setFillColor(fillColor);
+				else if (MARKER_TYPE == MarkerType::BGCOLOR) {
 					rect->setFillColor(LINK_BGCOLOR);
 					if (COLORSOURCE != ColorSource::DEFAULT) {
 						rect->setStrokeColor(strokeColor);
@@ -175,12 +214,17 @@ void HyperlinkManager::markLinkedBox (SpecialActions &actions) {
 					rect->setStrokeColor(strokeColor);
 					rect->setStrokeWidth(linewidth);
 				}
+				rect->addAttribute("x", x);
+				rect->addAttribute("y", y);
+				rect->addAttribute("width", w);
+				rect->addAttribute("height", h);
+				_markerRect = rect.get();
+				_markerBox = BoundingBox(x, y, x+w, y+h);
+				_markerLinewidth = linewidth;
+				_markerStrokeColor = strokeColor;
+				_markerFillColor = fillColor;
+				actions.svgTree().prependToPage(std::move(rect));
 			}
-			rect->addAttribute("x", x);
-			rect->addAttribute("y", y);
-			rect->addAttribute("width", w);
-			rect->addAttribute("height", h);
-			actions.svgTree().prependToPage(std::move(rect));
 			if (MARKER_TYPE == MarkerType::BOX || MARKER_TYPE == MarkerType::BGCOLOR) {
 				// slightly enlarge the boxed area
 				x -= linewidth/2;
@@ -193,14 +237,24 @@ void HyperlinkManager::markLinkedBox (SpecialActions &actions) {
 		// Create an invisible rectangle around the linked area so that it's easier to access.
 		// This is only necessary when using paths rather than real text elements together with fonts.
 		if (!SVGTree::USE_FONTS) {
-			auto rect = util::make_unique<SVGElement>("rect");
-			rect->addAttribute("x", bbox.minX());
-			rect->addAttribute("y", bbox.minY());
-			rect->addAttribute("width", bbox.width());
-			rect->addAttribute("height", bbox.height());
-			rect->setFillColor(Color::WHITE);
-			rect->setFillOpacity(OpacityAlpha(0, 0));
-			actions.svgTree().appendToPage(std::move(rect));
+			// Fragments of a multi-line link are covered by a single rectangle as long as
+			// their union stays rectangular; successive lines may be up to a line height apart.
+			if (_coverRect && merge_boxes(_coverBox, bbox, min(bbox.height(), _coverBox.height()))) {
+				_coverRect->addAttribute("y", _coverBox.minY());
+				_coverRect->addAttribute("height", _coverBox.height());
+			}
+			else {
+				auto rect = util::make_unique<SVGElement>("rect");
+				rect->addAttribute("x", bbox.minX());
+				rect->addAttribute("y", bbox.minY());
+				rect->addAttribute("width", bbox.width());
+				rect->addAttribute("height", bbox.height());
+				rect->setFillColor(Color::WHITE);
+				rect->setFillOpacity(OpacityAlpha(0, 0));
+				_coverRect = rect.get();
+				_coverBox = bbox;
+				actions.svgTree().appendToPage(std::move(rect));
+			}
 		}
 	}
 }
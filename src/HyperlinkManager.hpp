@@ -23,10 +23,12 @@
 
 #include <string>
 #include <unordered_map>
+#include "BoundingBox.hpp"
 #include "Color.hpp"
 #include "SpecialActions.hpp"
 
 class SpecialActions;
+class SVGElement;
 
 class HyperlinkManager {
 	struct NamedAnchor {
@@ -54,6 +56,7 @@ class HyperlinkManager {
 		void createViews (unsigned pageno, SpecialActions &actions);
 		void setBaseUrl (const std::string &base) {_base = base;}
 		void setLineWidth (double w) {_linewidth = w;}
+		void reset () {_anchorType = AnchorType::NONE; _namedAnchors.clear(); _resolvedUris.clear(); _markerRect = _coverRect = nullptr;}
 		static HyperlinkManager& instance ();
 		static bool setLinkMarker (const std::string &marker);
 		static void setDefaultLinkColor (Color color);
@@ -74,6 +77,14 @@ class HyperlinkManager {
 		double _linewidth=-1;       ///< line width of link marker (-1 => compute individual value per link)
 		std::string _base;          ///< base URL that is prepended to all relative targets
 		NamedAnchors _namedAnchors; ///< information about all named anchors processed
+		std::unordered_map<std::string,std::string> _resolvedUris;  ///< memoized results of applying the base URL to absolute targets
+		SVGElement *_markerRect=nullptr; ///< marker rectangle of the preceding fragment of the active link
+		SVGElement *_coverRect=nullptr;  ///< invisible rectangle covering the preceding fragment of the active link
+		BoundingBox _markerBox;     ///< area covered by _markerRect
+		BoundingBox _coverBox;      ///< area covered by _coverRect
+		double _markerLinewidth=0;  ///< line width used to create _markerRect
+		Color _markerStrokeColor;   ///< stroke color used to create _markerRect
+		Color _markerFillColor;     ///< fill color used to create _markerRect
 };
 
 #endif
@@ -19,10 +19,13 @@
 *************************************************************************/
 
 #include <config.h>
+#include <chrono>
 #include <fstream>
 #include <sstream>
 #include "Calculator.hpp"
 #include "DvisvgmSpecialHandler.hpp"
+#include "FileSystem.hpp"
+#include "FontCache.hpp"
 #include "ImageToSVG.hpp"
 #include "Message.hpp"
 #include "MessageException.hpp"
@@ -33,9 +36,13 @@
 #include "System.hpp"
 #include "utility.hpp"
 #include "version.hpp"
+#include "XXHashFunction.hpp"
 
 using namespace std;
 
+string ImageToSVG::RESULT_STORE_DIR;
+string ImageToSVG::OPTIONS_HASH;
+
 
 ImageToSVG::ImageToSVG (std::string fname, SVGOutputBase &out)
 	: _fname(std::move(fname)), _out(out), _gsVersion(Ghostscript().revision())
@@ -43,6 +50,85 @@ ImageToSVG::ImageToSVG (std::string fname, SVGOutputBase &out)
 }
 
 
+/** Returns the path of the result store entry assigned to a page of the image
+ *  file, or an empty string if the result store is disabled. The entries are
+ *  addressed by the contents of the source file, the page number, the program
+ *  version, and the hash of the command-line options affecting the SVG output,
+ *  so changing any of them leads to a fresh conversion. */
+string ImageToSVG::resultStorePath (int pageno) const {
+	if (RESULT_STORE_DIR.empty())
+		return "";
+	if (_fileDigest.empty()) {
+		ifstream ifs(_fname, ios::binary);
+		if (!ifs)
+			return "";
+		XXH64HashFunction hashfunc;
+		hashfunc.update(ifs);
+		_fileDigest = hashfunc.digestString();
+	}
+	XXH64HashFunction hashfunc(string(PROGRAM_VERSION)+_fileDigest+imageFormat()+to_string(pageno)+OPTIONS_HASH);
+	return RESULT_STORE_DIR+"/img-"+hashfunc.digestString()+".svg";
+}
+
+
+/** Copies a previously stored conversion result of the current image page to
+ *  the SVG output, which replaces the Ghostscript pass entirely.
+ *  @param[in] pageno number of the page to convert
+ *  @param[in] storePath path of the result store entry
+ *  @return true if a stored result was found and copied successfully */
+bool ImageToSVG::copyStoredResult (int pageno, const string &storePath) {
+	ifstream ifs(storePath, ios::binary);
+	if (!ifs)
+		return false;
+	Message::mstream().indent(0);
+	Message::mstream(false, Message::MC_PAGE_NUMBER) << "reusing stored conversion result of " << imageFormat() << " file\n";
+	Message::mstream().indent(1);
+	_currentPageNumber = pageno;
+	ostream &os = _out.getPageStream(pageno, totalPageCount());
+	os << ifs.rdbuf();
+	bool success = bool(os);
+	string svgfname = _out.filepath(pageno, totalPageCount()).shorterAbsoluteOrRelative();
+	_out.finish();
+	if (svgfname.empty())
+		svgfname = "<stdout>";
+	if (!success)
+		Message::wstream() << "failed to write output to " << svgfname << '\n';
+	else {
+		Message::mstream(false, Message::MC_PAGE_WRITTEN) << "output written to " << svgfname << '\n';
+		if (!_userMessage.empty())
+			Message::ustream(true) << expandText(_userMessage) << "\n";
+		if (FontCache::MAX_DISK_SIZE > 0)
+			FileSystem::touch(storePath);  // record access time for LRU eviction
+	}
+	return success;
+}
+
+
+/** Writes the serialized SVG tree to the result store. The entry is created
+ *  through a uniquely named temporary file and renamed afterwards, so concurrent
+ *  processes sharing the store never see partially written entries.
+ *  @param[in] storePath path of the result store entry */
+void ImageToSVG::storeResult (const string &storePath) const {
+	using namespace std::chrono;
+	auto now_ms = duration_cast<milliseconds>(system_clock::now().time_since_epoch()).count();
+	ostringstream oss;
+	oss << storePath << '-' << hex << XXH64HashFunction(to_string(now_ms)).digestValue();
+	const string tmpPath = oss.str();
+	bool ok;
+	{
+		ofstream ofs(tmpPath, ios::binary);
+		ok = ofs && _svg.write(ofs);
+	}
+	if (ok && !FileSystem::rename(tmpPath, storePath)) {
+		// rename can't replace existing files on Windows
+		FileSystem::remove(storePath);
+		ok = FileSystem::rename(tmpPath, storePath);
+	}
+	if (!ok)
+		FileSystem::remove(tmpPath);
+}
+
+
 void ImageToSVG::checkGSAndFileFormat () {
 	if (!_gsVersion)
 		throw MessageException("Ghostscript is required to process "+imageFormat()+" files");
@@ -53,6 +139,9 @@ void ImageToSVG::checkGSAndFileFormat () {
 
 void ImageToSVG::convert (int pageno) {
 	checkGSAndFileFormat();
+	const string storePath = resultStorePath(pageno);
+	if (!storePath.empty() && copyStoredResult(pageno, storePath))
+		return;
 	BoundingBox bbox = imageBBox();
 	if (bbox.valid() && (bbox.width() == 0 || bbox.height() == 0))
 		Message::wstream(true) << "bounding box of " << imageFormat() << " file is empty\n";
@@ -109,6 +198,9 @@ void ImageToSVG::writeSVG (int pageno) {
 			string msg = expandText(_userMessage);
 			Message::ustream(true) << msg << "\n";
 		}
+		const string storePath = resultStorePath(pageno);
+		if (!storePath.empty())
+			storeResult(storePath);
 	}
 	_bbox.invalidate();
 	_svg.reset();
@@ -207,7 +299,11 @@ Matrix ImageToSVG::getUserMatrix (const BoundingBox &bbox) const {
 		// add constants for length units to calculator
 		for (const auto &unit : Length::getUnits())
 			calc.setVariable(unit.first, Length(1, unit.second).pt());
-		matrix.set(_transCmds, calc);
+		// compile the command string once and only re-evaluate the argument
+		// expressions with the current variable values per page
+		if (!_transPipeline)
+			_transPipeline = util::make_unique<Matrix::Pipeline>(_transCmds);
+		matrix = _transPipeline->evaluate(calc);
 	}
 	return matrix;
 }
@@ -36,13 +36,16 @@ class ImageToSVG : protected SpecialActions {
 		virtual void convert (int pageno);
 		void convert (int firstPage, int lastPage, std::pair<int,int> *pageinfo);
 		void convert (const std::string &rangestr, std::pair<int,int> *pageinfo);
-		void setPageTransformation (const std::string &transCmds) {_transCmds = transCmds;}
+		void setPageTransformation (const std::string &transCmds) {_transCmds = transCmds; _transPipeline.reset();}
 		void setUserMessage (const std::string &msg) {_userMessage = msg;}
 		std::string filename () const {return _fname;}
 		PSInterpreter& psInterpreter () const {return _psHandler.psInterpreter();}
 		virtual bool isSinglePageFormat () const =0;
 		virtual int totalPageCount () const =0;
 
+		static std::string RESULT_STORE_DIR; ///< directory of the conversion result store (empty=disabled)
+		static std::string OPTIONS_HASH;     ///< hash of the command-line options affecting the SVG output
+
 	protected:
 		virtual void checkGSAndFileFormat ();
 		Matrix getUserMatrix (const BoundingBox &bbox) const;
@@ -81,6 +84,10 @@ class ImageToSVG : protected SpecialActions {
 		SVGTree _svg;
 
 	private:
+		std::string resultStorePath (int pageno) const;
+		bool copyStoredResult (int pageno, const std::string &storePath);
+		void storeResult (const std::string &storePath) const;
+
 		std::string _fname;   ///< name of image file
 		SVGOutputBase &_out;
 		double _x=0, _y=0;
@@ -89,6 +96,8 @@ class ImageToSVG : protected SpecialActions {
 		mutable PsSpecialHandler _psHandler;
 		int _gsVersion=0;         ///< Ghostscript version found
 		std::string _transCmds;   ///< transformation commands
+		mutable std::string _fileDigest;  ///< hash digest of the image file contents (computed on first use)
+		mutable std::unique_ptr<Matrix::Pipeline> _transPipeline;  ///< compiled transformation commands (created on first use)
 		std::string _userMessage; ///< message printed after conversion
 };
 
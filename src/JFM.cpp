@@ -54,17 +54,18 @@ void JFM::read (istream &is) {
 
 	setCharRange(bc, ec);
 	readHeader(reader);
-	is.seekg(28+lh*4);
-	readTables(reader, nt, nw, nh, nd, ni);
-	is.seekg(4*(lf-np));
-	readParameters(reader, np);   // JFM files provide 9 parameters but we don't need all of them
+	_nt = nt;
+	// JFM files provide 9 parameters but we don't need all of them
+	setTableInfo(28+4*streamoff(lh), 4*streamoff(lf-np), nw, nh, nd, ni, np);
+	if (&is != ownedStream())  // stream not kept open beyond this call?
+		decodeTables(is);       // decode the tables immediately
 }
 
 
-void JFM::readTables (StreamReader &reader, int nt, int nw, int nh, int nd, int ni) {
+void JFM::readTables (StreamReader &reader) const {
 	// determine smallest charcode with chartype > 0
 	uint32_t minchar=0xFFFFFFFF, maxchar=0;
-	for (int i=0; i < nt; i++) {
+	for (int i=0; i < _nt; i++) {
 		// support new JFM spec by texjporg
 		uint32_t c = reader.readUnsigned(2);
 		c += 0x10000 * reader.readUnsigned(1);
@@ -78,8 +79,8 @@ void JFM::readTables (StreamReader &reader, int nt, int nw, int nh, int nd, int
 	if (minchar <= maxchar) {
 		_minchar = minchar;
 		_charTypeTable.resize(maxchar-minchar+1, 0);
-		reader.seek(-nt*4, ios::cur);
-		for (int i=0; i < nt; i++) {
+		reader.seek(-_nt*4, ios::cur);
+		for (int i=0; i < _nt; i++) {
 			// support new JFM spec by texjporg
 			uint32_t c = reader.readUnsigned(2);
 			c += 0x10000 * reader.readUnsigned(1);
@@ -88,11 +89,12 @@ void JFM::readTables (StreamReader &reader, int nt, int nw, int nh, int nd, int
 				_charTypeTable[c-minchar] = t;
 		}
 	}
-	TFM::readTables(reader, nw, nh, nd, ni);
+	TFM::readTables(reader);
 }
 
 
 size_t JFM::charIndex (int c) const {
+	ensureTables();
 	uint8_t chartype = 0;
 	if (!_charTypeTable.empty() && uint32_t(c) >= _minchar && uint32_t(c) < _minchar+_charTypeTable.size())
 		chartype = _charTypeTable[c-_minchar];
@@ -31,17 +31,18 @@ class JFM : public TFM {
 		void read (std::istream &is) override;
 		bool verticalLayout () const  override {return _vertical;}
 		bool isJFM () const override {return true;}
-		uint32_t minChar () const {return _minchar;}
-		uint32_t maxChar () const {return static_cast<uint32_t>(_minchar+_charTypeTable.size()-1);}
+		uint32_t minChar () const {ensureTables(); return _minchar;}
+		uint32_t maxChar () const {ensureTables(); return static_cast<uint32_t>(_minchar+_charTypeTable.size()-1);}
 
 	protected:
-		void readTables (StreamReader &reader, int nt, int nw, int nh, int nd, int ni);
+		void readTables (StreamReader &reader) const override;
 		size_t charIndex (int c) const override;
 
 	private:
-		uint32_t _minchar=0;   ///< character code of first entry in character type table
-		bool _vertical=false;  ///< true if metrics refer to vertical text layout
-		std::vector<uint8_t> _charTypeTable;
+		uint16_t _nt=0;                ///< number of entries in the character type table
+		mutable uint32_t _minchar=0;   ///< character code of first entry in character type table
+		bool _vertical=false;          ///< true if metrics refer to vertical text layout
+		mutable std::vector<uint8_t> _charTypeTable;
 };
 
 #endif
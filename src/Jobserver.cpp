@@ -0,0 +1,166 @@
+/*************************************************************************
+** Jobserver.cpp                                                        **
+**                                                                      **
+** This file is part of dvisvgm -- a fast DVI to SVG converter          **
+** Copyright (C) 2005-2024 Martin Gieseking <martin.gieseking@uos.de>   **
+**                                                                      **
+** This program is free software; you can redistribute it and/or        **
+** modify it under the terms of the GNU General Public License as       **
+** published by the Free Software Foundation; either version 3 of       **
+** the License, or (at your option) any later version.                  **
+**                                                                      **
+** This program is distributed in the hope that it will be useful, but  **
+** WITHOUT ANY WARRANTY; without even the implied warranty of           **
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the         **
+** GNU General Public License for more details.                         **
+**                                                                      **
+** You should have received a copy of the GNU General Public License    **
+** along with this program; if not, see <http://www.gnu.org/licenses/>. **
+*************************************************************************/
+
+#include <config.h>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include "Jobserver.hpp"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+bool Jobserver::ENABLED = false;
+
+
+/** Looks for a jobserver advertised in environment variable MAKEFLAGS. */
+Jobserver::Jobserver () {
+	if (const char *makeflags = getenv("MAKEFLAGS"))
+		parseMakeflags(makeflags);
+}
+
+
+Jobserver::~Jobserver () {
+#ifndef _WIN32
+	if (_ownsFDs) {
+		close(_readfd);
+		close(_writefd);
+	}
+#endif
+}
+
+
+/** Returns the singleton jobserver object. */
+Jobserver& Jobserver::instance () {
+	static Jobserver jobserver;
+	return jobserver;
+}
+
+
+/** Extracts the jobserver descriptors from the contents of MAKEFLAGS. Both the
+ *  traditional pipe style (--jobserver-auth=R,W and its older spelling
+ *  --jobserver-fds=R,W) and the fifo style of make >= 4.4
+ *  (--jobserver-auth=fifo:PATH) are recognized.
+ *  @param[in] flags contents of environment variable MAKEFLAGS
+ *  @return true if a usable jobserver was found */
+bool Jobserver::parseMakeflags (const string &flags) {
+#ifndef _WIN32
+	istringstream iss(flags);
+	string word;
+	while (iss >> word) {
+		string arg;
+		for (const char *prefix : {"--jobserver-auth=", "--jobserver-fds="}) {
+			if (word.compare(0, strlen(prefix), prefix) == 0) {
+				arg = word.substr(strlen(prefix));
+				break;
+			}
+		}
+		if (arg.empty())
+			continue;
+		if (arg.compare(0, 5, "fifo:") == 0) {
+			string path = arg.substr(5);
+			int readfd = open(path.c_str(), O_RDONLY|O_NONBLOCK);
+			int writefd = open(path.c_str(), O_WRONLY);
+			if (readfd >= 0 && writefd >= 0) {
+				_readfd = readfd;
+				_writefd = writefd;
+				_ownsFDs = true;
+				return true;
+			}
+			if (readfd >= 0)
+				close(readfd);
+			if (writefd >= 0)
+				close(writefd);
+		}
+		else {
+			size_t commapos = arg.find(',');
+			if (commapos != string::npos) {
+				try {
+					int readfd = stoi(arg.substr(0, commapos));
+					int writefd = stoi(arg.substr(commapos+1));
+					// the descriptors are only inherited if make considers the command
+					// a recursive invocation (prefixed with '+'); check they are open
+					if (readfd >= 0 && writefd >= 0
+							&& fcntl(readfd, F_GETFD) != -1 && fcntl(writefd, F_GETFD) != -1) {
+						_readfd = readfd;
+						_writefd = writefd;
+						return true;
+					}
+				}
+				catch (logic_error &) {
+					// malformed descriptor numbers => no jobserver
+				}
+			}
+		}
+	}
+#endif
+	return false;
+}
+
+
+/** Returns true if token requests are enabled and a jobserver is present. */
+bool Jobserver::active () const {
+	return ENABLED && _readfd >= 0;
+}
+
+
+/** Tries to acquire up to a given number of job tokens without blocking.
+ *  Each token entitles the process to run one additional worker thread.
+ *  @param[in] maxTokens maximum number of tokens to acquire
+ *  @return number of tokens actually acquired */
+size_t Jobserver::acquireTokens (size_t maxTokens) {
+	size_t numTokens = 0;
+#ifndef _WIN32
+	if (active()) {
+		lock_guard<mutex> lock(_mutex);
+		while (numTokens < maxTokens) {
+			struct pollfd pfd = {_readfd, POLLIN, 0};
+			if (poll(&pfd, 1, 0) <= 0 || !(pfd.revents & POLLIN))
+				break;
+			char token;
+			if (read(_readfd, &token, 1) != 1)
+				break;
+			numTokens++;
+		}
+	}
+#endif
+	return numTokens;
+}
+
+
+/** Returns previously acquired job tokens to the jobserver.
+ *  @param[in] numTokens number of tokens to release */
+void Jobserver::releaseTokens (size_t numTokens) {
+#ifndef _WIN32
+	if (_writefd >= 0 && numTokens > 0) {
+		lock_guard<mutex> lock(_mutex);
+		while (numTokens-- > 0) {
+			char token = '+';
+			if (write(_writefd, &token, 1) != 1)
+				break;
+		}
+	}
+#endif
+}
@@ -0,0 +1,57 @@
+/*************************************************************************
+** Jobserver.hpp                                                        **
+**                                                                      **
+** This file is part of dvisvgm -- a fast DVI to SVG converter          **
+** Copyright (C) 2005-2024 Martin Gieseking <martin.gieseking@uos.de>   **
+**                                                                      **
+** This program is free software; you can redistribute it and/or        **
+** modify it under the terms of the GNU General Public License as       **
+** published by the Free Software Foundation; either version 3 of       **
+** the License, or (at your option) any later version.                  **
+**                                                                      **
+** This program is distributed in the hope that it will be useful, but  **
+** WITHOUT ANY WARRANTY; without even the implied warranty of           **
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the         **
+** GNU General Public License for more details.                         **
+**                                                                      **
+** You should have received a copy of the GNU General Public License    **
+** along with this program; if not, see <http://www.gnu.org/licenses/>. **
+*************************************************************************/
+
+#ifndef JOBSERVER_HPP
+#define JOBSERVER_HPP
+
+#include <cstddef>
+#include <mutex>
+#include <string>
+
+/** Client of the GNU make jobserver protocol. When dvisvgm runs as part of a
+ *  parallel make build, the jobserver pipe advertised in MAKEFLAGS holds the
+ *  build's global parallelism budget. Each additional worker thread beyond the
+ *  implicit job slot of the process requires a token acquired from the pipe,
+ *  which is returned once the worker has finished. This way the internal
+ *  parallelism cooperates with the surrounding build instead of oversubscribing
+ *  the host. */
+class Jobserver {
+	public:
+		Jobserver (const Jobserver&) =delete;
+		~Jobserver ();
+		static Jobserver& instance ();
+		bool active () const;
+		size_t acquireTokens (size_t maxTokens);
+		void releaseTokens (size_t numTokens);
+
+		static bool ENABLED;  ///< if true, tokens are requested from the jobserver found in MAKEFLAGS
+
+	protected:
+		Jobserver ();
+		bool parseMakeflags (const std::string &flags);
+
+	private:
+		int _readfd=-1;        ///< read end of the jobserver pipe (-1 = no jobserver found)
+		int _writefd=-1;       ///< write end of the jobserver pipe
+		bool _ownsFDs=false;   ///< true if the descriptors were opened by this class (fifo style)
+		std::mutex _mutex;     ///< serializes the token transfers
+};
+
+#endif
@@ -44,6 +44,17 @@ MapLine::MapLine (string str) : MapLine() {
 }
 
 
+/** Constructs a MapLine object from already parsed field values, e.g. restored
+ *  from the binary representation of a map file. No tokenization is involved. */
+MapLine::MapLine (string texname, const string &sfdname, string psname, string fontfname, string encname, int fontindex, double slant, double bold, double extend)
+	: _texname(std::move(texname)), _psname(std::move(psname)), _fontfname(std::move(fontfname)), _encname(std::move(encname)),
+	  _fontindex(fontindex), _slant(slant), _bold(bold), _extend(extend)
+{
+	if (!sfdname.empty())
+		_sfd = SubfontDefinition::lookup(sfdname);
+}
+
+
 // Some of the following functions have been derived from the dvipdfmx source file fontmap.c:
 // http://cvs.ktug.or.kr/viewcvs/dvipdfmx/src/fontmap.c?revision=1.43&view=markup
 
@@ -40,6 +40,8 @@ class MapLine {
 	public:
 		explicit MapLine (std::istream &is);
 		explicit MapLine (std::string str);
+		MapLine (std::string texname, const std::string &sfdname, std::string psname, std::string fontfname,
+			std::string encname, int fontindex, double slant, double bold, double extend);
 		const std::string& texname () const   {return _texname;}
 		const std::string& psname () const    {return _psname;}
 		const std::string& fontfname () const {return _fontfname;}
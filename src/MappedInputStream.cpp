@@ -0,0 +1,101 @@
+/*************************************************************************
+** MappedInputStream.cpp                                                **
+**                                                                      **
+** This file is part of dvisvgm -- a fast DVI to SVG converter          **
+** Copyright (C) 2005-2024 Martin Gieseking <martin.gieseking@uos.de>   **
+**                                                                      **
+** This program is free software; you can redistribute it and/or        **
+** modify it under the terms of the GNU General Public License as       **
+** published by the Free Software Foundation; either version 3 of       **
+** the License, or (at your option) any later version.                  **
+**                                                                      **
+** This program is distributed in the hope that it will be useful, but  **
+** WITHOUT ANY WARRANTY; without even the implied warranty of           **
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the         **
+** GNU General Public License for more details.                         **
+**                                                                      **
+** You should have received a copy of the GNU General Public License    **
+** along with this program; if not, see <http://www.gnu.org/licenses/>. **
+*************************************************************************/
+
+#include <config.h>
+#include "MappedInputStream.hpp"
+
+#ifdef HAVE_SYS_MMAN_H
+#	include <fcntl.h>
+#	include <sys/mman.h>
+#	include <sys/stat.h>
+#	include <unistd.h>
+#endif
+
+using namespace std;
+
+
+/** Assigns the memory region the buffer operates on.
+ *  @param[in] data start of the memory region
+ *  @param[in] size number of bytes in the region */
+void MappedStreamBuffer::assign (const char *data, size_t size) {
+	char *begin = const_cast<char*>(data);  // the get area is never written to
+	setg(begin, begin, begin+size);
+}
+
+
+MappedStreamBuffer::pos_type MappedStreamBuffer::seekoff (off_type off, ios_base::seekdir dir, ios_base::openmode mode) {
+	if (!(mode & ios_base::in) || !eback())
+		return pos_type(off_type(-1));
+	off_type base=0;
+	switch (dir) {
+		case ios_base::cur: base = gptr()-eback(); break;
+		case ios_base::end: base = egptr()-eback(); break;
+		default           : base = 0;
+	}
+	off_type newpos = base+off;
+	if (newpos < 0 || newpos > egptr()-eback())
+		return pos_type(off_type(-1));
+	setg(eback(), eback()+newpos, egptr());
+	return pos_type(newpos);
+}
+
+
+MappedStreamBuffer::pos_type MappedStreamBuffer::seekpos (pos_type pos, ios_base::openmode mode) {
+	return seekoff(off_type(pos), ios_base::beg, mode);
+}
+
+////////////////////////////////////////////////////////////////
+
+/** Tries to map the given file into memory. On failure, the failbit
+ *  of the stream is set and mapped() returns false.
+ *  @param[in] fname name/path of the file to map */
+MappedInputStream::MappedInputStream (const string &fname) : istream(nullptr) {
+#ifdef HAVE_SYS_MMAN_H
+	int fd = open(fname.c_str(), O_RDONLY);
+	if (fd >= 0) {
+		struct stat statbuf;
+		if (fstat(fd, &statbuf) == 0 && S_ISREG(statbuf.st_mode) && statbuf.st_size > 0) {
+			void *addr = mmap(nullptr, statbuf.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+			if (addr != MAP_FAILED) {
+				_data = static_cast<const char*>(addr);
+				_size = statbuf.st_size;
+#ifdef MADV_SEQUENTIAL
+				madvise(addr, _size, MADV_SEQUENTIAL);
+#endif
+			}
+		}
+		close(fd);
+	}
+#endif
+	if (_data) {
+		_streambuf.assign(_data, _size);
+		rdbuf(&_streambuf);
+	}
+	else
+		setstate(ios_base::failbit);
+}
+
+
+MappedInputStream::~MappedInputStream () {
+#ifdef HAVE_SYS_MMAN_H
+	if (_data)
+		munmap(const_cast<char*>(_data), _size);
+#endif
+}
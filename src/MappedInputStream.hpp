@@ -0,0 +1,80 @@
+/*************************************************************************
+** MappedInputStream.hpp                                                **
+**                                                                      **
+** This file is part of dvisvgm -- a fast DVI to SVG converter          **
+** Copyright (C) 2005-2024 Martin Gieseking <martin.gieseking@uos.de>   **
+**                                                                      **
+** This program is free software; you can redistribute it and/or        **
+** modify it under the terms of the GNU General Public License as       **
+** published by the Free Software Foundation; either version 3 of       **
+** the License, or (at your option) any later version.                  **
+**                                                                      **
+** This program is distributed in the hope that it will be useful, but  **
+** WITHOUT ANY WARRANTY; without even the implied warranty of           **
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the         **
+** GNU General Public License for more details.                         **
+**                                                                      **
+** You should have received a copy of the GNU General Public License    **
+** along with this program; if not, see <http://www.gnu.org/licenses/>. **
+*************************************************************************/
+
+#ifndef MAPPEDINPUTSTREAM_HPP
+#define MAPPEDINPUTSTREAM_HPP
+
+#include <istream>
+#include <streambuf>
+#include <string>
+
+/** Stream buffer that reads directly from a contiguous memory region.
+ *  Since the complete data is present in memory, all read and seek
+ *  operations come down to simple pointer arithmetics. */
+class MappedStreamBuffer : public std::streambuf {
+	public:
+		MappedStreamBuffer () =default;
+		void assign (const char *data, size_t size);
+
+	protected:
+		pos_type seekoff (off_type off, std::ios_base::seekdir dir, std::ios_base::openmode mode) override;
+		pos_type seekpos (pos_type pos, std::ios_base::openmode mode) override;
+		std::streamsize showmanyc () override {return egptr()-gptr();}
+};
+
+
+/** Input stream reading from a read-only file mapped into memory.
+ *  In contrast to file streams, the data is accessed without any
+ *  intermediate buffer copies, and random seeks, e.g. when jumping
+ *  between the bop offsets of a DVI file, are plain pointer updates.
+ *  If the platform doesn't support memory mapping or if mapping the
+ *  file fails, the stream is put into an invalid state and the caller
+ *  should fall back to a regular file stream. */
+class MappedInputStream : public std::istream {
+	public:
+		explicit MappedInputStream (const std::string &fname);
+		MappedInputStream (const MappedInputStream&) =delete;
+		~MappedInputStream () override;
+		bool mapped () const  {return _data != nullptr;}
+		size_t size () const  {return _size;}
+		const char* data () const {return _data;}
+
+	private:
+		MappedStreamBuffer _streambuf;
+		const char *_data=nullptr;  ///< start of the mapped memory region
+		size_t _size=0;             ///< number of mapped bytes
+};
+
+
+/** Input stream reading from a caller-provided memory buffer, e.g. DVI data
+ *  received over the network. The buffer isn't copied but read in place, so
+ *  it must stay valid and unchanged until the stream is destroyed. */
+class MemoryInputStream : public std::istream {
+	public:
+		MemoryInputStream (const char *data, size_t size) : std::istream(&_streambuf) {
+			_streambuf.assign(data, size);
+		}
+		MemoryInputStream (const MemoryInputStream&) =delete;
+
+	private:
+		MappedStreamBuffer _streambuf;
+};
+
+#endif
@@ -151,30 +151,87 @@ Matrix& Matrix::set (const string &cmds, Calculator &calc) {
 }
 
 
+/** Multiplies this matrix M in place with a translation matrix T: M := T*M.
+ *  Since T only differs from the identity in its third column, the product is
+ *  fused into the matrix directly without creating temporary matrix objects. */
 Matrix& Matrix::translate (double tx, double ty) {
 	if (tx != 0 || ty != 0) {
-		TranslationMatrix t(tx, ty);
-		lmultiply(t);
+		for (int j=0; j < 3; j++) {
+			_values[0][j] += tx*_values[2][j];
+			_values[1][j] += ty*_values[2][j];
+		}
 	}
 	return *this;
 }
 
 
+/** Multiplies this matrix M in place with a scaling matrix S: M := S*M.
+ *  The product only scales the top two rows, so it's fused into the matrix
+ *  directly without creating temporary matrix objects. */
 Matrix& Matrix::scale (double sx, double sy) {
 	if (sx != 1 || sy != 1) {
-		ScalingMatrix s(sx, sy);
-		lmultiply(s);
+		for (int j=0; j < 3; j++) {
+			_values[0][j] *= sx;
+			_values[1][j] *= sy;
+		}
 	}
 	return *this;
 }
 
 
 /** Multiplies this matrix by ((cos d, -sin d, 0), (sin d, cos d, 0), (0,0,1)) that
- *  describes an anti-clockwise rotation by d degrees.
+ *  describes an anti-clockwise rotation by d degrees. The product only combines
+ *  the top two rows, so it's fused into the matrix directly.
  *  @param[in] deg rotation angle in degrees */
 Matrix& Matrix::rotate (double deg) {
-	RotationMatrix r(deg);
-	lmultiply(r);
+	double c = cos(deg2rad(deg));
+	double s = sin(deg2rad(deg));
+	for (int j=0; j < 3; j++) {
+		double v0 = _values[0][j];
+		double v1 = _values[1][j];
+		_values[0][j] = c*v0 - s*v1;
+		_values[1][j] = s*v0 + c*v1;
+	}
+	return *this;
+}
+
+
+/** Multiplies this matrix M in place with a translation matrix T applied on the
+ *  right side: M := M*T. The product only changes the third column of the matrix. */
+Matrix& Matrix::rtranslate (double tx, double ty) {
+	if (tx != 0 || ty != 0) {
+		for (int i=0; i < 3; i++)
+			_values[i][2] += tx*_values[i][0] + ty*_values[i][1];
+	}
+	return *this;
+}
+
+
+/** Multiplies this matrix M in place with a scaling matrix S applied on the
+ *  right side: M := M*S. The product only scales the first two columns. */
+Matrix& Matrix::rscale (double sx, double sy) {
+	if (sx != 1 || sy != 1) {
+		for (int i=0; i < 3; i++) {
+			_values[i][0] *= sx;
+			_values[i][1] *= sy;
+		}
+	}
+	return *this;
+}
+
+
+/** Multiplies this matrix M in place with a rotation matrix R applied on the
+ *  right side: M := M*R. The product only combines the first two columns.
+ *  @param[in] deg rotation angle in degrees */
+Matrix& Matrix::rrotate (double deg) {
+	double c = cos(deg2rad(deg));
+	double s = sin(deg2rad(deg));
+	for (int i=0; i < 3; i++) {
+		double v0 = _values[i][0];
+		double v1 = _values[i][1];
+		_values[i][0] = c*v0 + s*v1;
+		_values[i][1] = c*v1 - s*v0;
+	}
 	return *this;
 }
 
@@ -188,9 +245,9 @@ Matrix& Matrix::xskewByAngle (double deg) {
 
 Matrix& Matrix::xskewByRatio (double xyratio) {
 	if (xyratio != 0) {
-		double v[] = {1, xyratio};
-		Matrix t(v, 2);
-		lmultiply(t);
+		// fused product with ((1, xyratio, 0), (0,1,0), (0,0,1)) on the left side
+		for (int j=0; j < 3; j++)
+			_values[0][j] += xyratio*_values[1][j];
 	}
 	return *this;
 }
@@ -205,9 +262,9 @@ Matrix& Matrix::yskewByAngle (double deg) {
 
 Matrix& Matrix::yskewByRatio (double xyratio) {
 	if (xyratio != 0) {
-		double v[] = {1, 0, 0, xyratio};
-		Matrix t(v, 4);
-		lmultiply(t);
+		// fused product with ((1,0,0), (xyratio, 1, 0), (0,0,1)) on the left side
+		for (int j=0; j < 3; j++)
+			_values[1][j] += xyratio*_values[0][j];
 	}
 	return *this;
 }
@@ -236,10 +293,22 @@ Matrix& Matrix::transpose () {
 /** Multiplies this matrix M with matrix tm (tm is the factor on the right side): M := M * tm */
 Matrix& Matrix::rmultiply (const Matrix &tm) {
 	Matrix ret;
-	for (int i=0; i < 3; i++)
-		for (int j=0; j < 3; j++)
-			for (int k=0; k < 3; k++)
-				ret._values[i][j] += _values[i][k] * tm._values[k][j];
+	if (isAffine() && tm.isAffine()) {
+		// affine special case: since the bottom rows are (0, 0, 1),
+		// only the top two rows must be computed
+		for (int i=0; i < 2; i++) {
+			for (int j=0; j < 3; j++)
+				ret._values[i][j] = _values[i][0]*tm._values[0][j] + _values[i][1]*tm._values[1][j];
+			ret._values[i][2] += _values[i][2];
+		}
+		ret._values[2][2] = 1;
+	}
+	else {
+		for (int i=0; i < 3; i++)
+			for (int j=0; j < 3; j++)
+				for (int k=0; k < 3; k++)
+					ret._values[i][j] += _values[i][k] * tm._values[k][j];
+	}
 	return *this = ret;
 }
 
@@ -247,10 +316,21 @@ Matrix& Matrix::rmultiply (const Matrix &tm) {
 /** Multiplies this matrix M with matrix tm (tm is the factor on the left side): M := tm * M */
 Matrix& Matrix::lmultiply (const Matrix &tm) {
 	Matrix ret;
-	for (int i=0; i < 3; i++)
-		for (int j=0; j < 3; j++)
-			for (int k=0; k < 3; k++)
-				ret._values[i][j] += tm._values[i][k] * _values[k][j];
+	if (isAffine() && tm.isAffine()) {
+		// affine special case (see rmultiply)
+		for (int i=0; i < 2; i++) {
+			for (int j=0; j < 3; j++)
+				ret._values[i][j] = tm._values[i][0]*_values[0][j] + tm._values[i][1]*_values[1][j];
+			ret._values[i][2] += tm._values[i][2];
+		}
+		ret._values[2][2] = 1;
+	}
+	else {
+		for (int i=0; i < 3; i++)
+			for (int j=0; j < 3; j++)
+				for (int k=0; k < 3; k++)
+					ret._values[i][j] += tm._values[i][k] * _values[k][j];
+	}
 	return *this = ret;
 }
 
@@ -347,14 +427,13 @@ bool Matrix::isTranslation (double &tx, double &ty) const {
 }
 
 
-/** Gets a parameter for the transformation command.
+/** Gets a parameter expression of a transformation command.
  *  @param[in] is parameter chars are read from this stream
- *  @param[in] calc parameters can be arithmetic expressions, so we need a calculator to evaluate them
- *  @param[in] def default value if parameter is optional
+ *  @param[out] expr compiled argument expression
  *  @param[in] optional true if parameter is optional
  *  @param[in] leadingComma true if first non-blank must be a comma
- *  @return value of argument */
-static double getArgument (istream &is, Calculator &calc, double def, bool optional, bool leadingComma) {
+ *  @return true if an argument was present */
+static bool get_argument_expr (istream &is, Calculator::Expression &expr, bool optional, bool leadingComma) {
 	is >> ws;
 	if (!optional && leadingComma && is.peek() != ',')
 		throw ParserException("',' expected");
@@ -362,62 +441,122 @@ static double getArgument (istream &is, Calculator &calc, double def, bool optio
 		is.get();         // skip comma
 		optional = false; // now we expect a parameter
 	}
-	string expr;
+	string exprstr;
 	while (!isupper(is.peek()) && is.peek() != ',' && is)
-		expr += (char)is.get();
-	if (expr.length() == 0) {
+		exprstr += (char)is.get();
+	if (exprstr.length() == 0) {
 		if (optional)
-			return def;
-		else
-			throw ParserException("parameter expected");
+			return false;
+		throw ParserException("parameter expected");
 	}
-	return calc.eval(expr);
+	expr = Calculator::compile(exprstr);
+	return true;
 }
 
 
-Matrix Matrix::parse (istream &is, Calculator &calc) {
-	Matrix ret(1);
+/** Parses a sequence of transformation commands and compiles it into a
+ *  list of commands with precompiled argument expressions.
+ *  @param[in] is commands are read from this stream */
+Matrix::Pipeline::Pipeline (istream &is) {
 	while (is) {
 		is >> ws;
 		int cmd = is.get();
+		Command command;
+		command.type = char(cmd);
+		Calculator::Expression expr;
 		switch (cmd) {
+			case 'T':
+			case 'S':
+			case 'R': {
+				get_argument_expr(is, expr, false, false);
+				command.args.push_back(std::move(expr));
+				int optargs = (cmd == 'R' ? 2 : 1);
+				// if an optional argument is missing, all subsequent ones are too
+				while (optargs-- > 0 && get_argument_expr(is, expr, true, true))
+					command.args.push_back(std::move(expr));
+				break;
+			}
+			case 'F': {
+				int c = is.get();
+				if (c != 'H' && c != 'V')
+					throw ParserException("'H' or 'V' expected");
+				command.type = char(c);
+				get_argument_expr(is, expr, false, false);
+				command.args.push_back(std::move(expr));
+				break;
+			}
+			case 'K': {
+				int c = is.get();
+				if (c != 'X' && c != 'Y')
+					throw ParserException("transformation command 'K' must be followed by 'X' or 'Y'");
+				command.type = char(c);
+				get_argument_expr(is, expr, false, false);
+				command.args.push_back(std::move(expr));
+				break;
+			}
+			case 'M': {
+				for (int i=0; i < 6; i++) {
+					if (!get_argument_expr(is, expr, i!=0, i!=0))
+						break;
+					command.args.push_back(std::move(expr));
+				}
+				break;
+			}
+			default:
+				throw ParserException("transformation command expected (found '" + string(1, cmd) + "' instead)");
+		}
+		_commands.push_back(std::move(command));
+	}
+}
+
+
+Matrix::Pipeline::Pipeline (const string &cmds) {
+	istringstream iss;
+	iss.str(cmds);
+	*this = Pipeline(iss);
+}
+
+
+/** Applies the compiled transformation commands with the current variable
+ *  bindings of a given Calculator and returns the resulting matrix.
+ *  @param[in] calc calculator object providing the variable values
+ *  @return the combined transformation matrix */
+Matrix Matrix::Pipeline::evaluate (const Calculator &calc) const {
+	Matrix ret(1);
+	for (const Command &command : _commands) {
+		const vector<Calculator::Expression> &args = command.args;
+		switch (command.type) {
 			case 'T': {
-				double tx = getArgument(is, calc, 0, false, false);
-				double ty = getArgument(is, calc, 0, true, true);
+				double tx = args[0].evaluate(calc);
+				double ty = args.size() > 1 ? args[1].evaluate(calc) : 0;
 				ret.translate(tx, ty);
 				break;
 			}
 			case 'S': {
-				double sx = getArgument(is, calc, 1, false, false);
-				double sy = getArgument(is, calc, sx, true, true );
+				double sx = args[0].evaluate(calc);
+				double sy = args.size() > 1 ? args[1].evaluate(calc) : sx;
 				ret.scale(sx, sy);
 				break;
 			}
 			case 'R': {
-				double a = getArgument(is, calc, 0, false, false);
-				double x = getArgument(is, calc, calc.getVariable("ux")+calc.getVariable("w")/2, true, true);
-				double y = getArgument(is, calc, calc.getVariable("uy")+calc.getVariable("h")/2, true, true);
+				double a = args[0].evaluate(calc);
+				double x = args.size() > 1 ? args[1].evaluate(calc) : calc.getVariable("ux")+calc.getVariable("w")/2;
+				double y = args.size() > 2 ? args[2].evaluate(calc) : calc.getVariable("uy")+calc.getVariable("h")/2;
 				ret.translate(-x, -y);
 				ret.rotate(a);
 				ret.translate(x, y);
 				break;
 			}
-			case 'F': {
-				int c = is.get();
-				if (c != 'H' && c != 'V')
-					throw ParserException("'H' or 'V' expected");
-				double a = getArgument(is, calc, 0, false, false);
-				ret.flip(c == 'H', a);
+			case 'H':
+			case 'V':
+				ret.flip(command.type == 'H', args[0].evaluate(calc));
 				break;
-			}
-			case 'K': {
-				int c = is.get();
-				if (c != 'X' && c != 'Y')
-					throw ParserException("transformation command 'K' must be followed by 'X' or 'Y'");
-				double a = getArgument(is, calc, 0, false, false);
+			case 'X':
+			case 'Y': {
+				double a = args[0].evaluate(calc);
 				if (std::abs(cos(deg2rad(a))) < numeric_limits<double>::epsilon())
 					throw ParserException("illegal skewing angle: " + util::to_string(a) + " degrees");
-				if (c == 'X')
+				if (command.type == 'X')
 					ret.xskewByAngle(a);
 				else
 					ret.yskewByAngle(a);
@@ -426,7 +565,7 @@ Matrix Matrix::parse (istream &is, Calculator &calc) {
 			case 'M': {
 				double v[9];
 				for (int i=0; i < 6; i++)
-					v[i] = getArgument(is, calc, i%4 ? 0 : 1, i!=0, i!=0);
+					v[i] = size_t(i) < args.size() ? args[i].evaluate(calc) : (i%4 ? 0 : 1);
 				// third row (0, 0, 1)
 				v[6] = v[7] = 0;
 				v[8] = 1;
@@ -434,14 +573,17 @@ Matrix Matrix::parse (istream &is, Calculator &calc) {
 				ret.lmultiply(tm);
 				break;
 			}
-			default:
-				throw ParserException("transformation command expected (found '" + string(1, cmd) + "' instead)");
 		}
 	}
 	return ret;
 }
 
 
+Matrix Matrix::parse (istream &is, Calculator &calc) {
+	return Pipeline(is).evaluate(calc);
+}
+
+
 Matrix Matrix::parse (const string &cmds, Calculator &calc) {
 	istringstream iss;
 	iss.str(cmds);
@@ -549,17 +691,17 @@ Matrix Matrix::parseSVGTransform (const string &transform) {
 			if (ne_angle(fmod(params[0], 360), 0)) {
 				bool translate = ne(params[1], 0) || ne(params[2], 0);
 				if (translate)
-					matrix.rmultiply(TranslationMatrix(params[1], params[2]));
-				matrix.rmultiply(RotationMatrix(params[0]));
+					matrix.rtranslate(params[1], params[2]);
+				matrix.rrotate(params[0]);
 				if (translate)
-					matrix.rmultiply(TranslationMatrix(-params[1], -params[2]));
+					matrix.rtranslate(-params[1], -params[2]);
 			}
 		}
 		else if (parse_transform_cmd(iss, "scale", 1, 2, params)) {
 			if (params.size() == 1)
 				params.push_back(params[0]);
 			if (ne(params[0], 1) || ne(params[1], 1))
-				matrix.rmultiply(ScalingMatrix(params[0], params[1]));
+				matrix.rscale(params[0], params[1]);
 		}
 		else if (parse_transform_cmd(iss, "skewX", 1, 1, params)) {
 			if (ne_angle(fmod(abs(params[0])-90, 180), 0))
@@ -573,7 +715,7 @@ Matrix Matrix::parseSVGTransform (const string &transform) {
 			if (params.size() == 1)
 				params.push_back(0);
 			if (ne(params[0], 0) || ne(params[1], 0))
-				matrix.rmultiply(TranslationMatrix(params[0], params[1]));
+				matrix.rtranslate(params[0], params[1]);
 		}
 		else {  // invalid command
 			string cmd;
@@ -25,6 +25,7 @@
 #include <istream>
 #include <string>
 #include <vector>
+#include "Calculator.hpp"
 #include "MessageException.hpp"
 #include "Pair.hpp"
 
@@ -33,13 +34,31 @@ struct ParserException : public MessageException {
 	explicit ParserException (const std::string &msg) : MessageException(msg) {}
 };
 
-class Calculator;
-
 class Matrix {
 	friend double det (const Matrix &m);
 	friend double det (const Matrix &m, int row, int col);
 
 	public:
+		/** Compiled form of a transformation command string as accepted by parse().
+		 *  The command sequence and its arithmetic arguments are parsed only once;
+		 *  evaluate() applies them with the current variable bindings of a
+		 *  Calculator, e.g. once per page. */
+		class Pipeline {
+			public:
+				Pipeline () =default;
+				explicit Pipeline (const std::string &cmds);
+				explicit Pipeline (std::istream &is);
+				Matrix evaluate (const Calculator &calc) const;
+				bool empty () const {return _commands.empty();}
+
+			private:
+				struct Command {
+					char type;  ///< single char identifying the transformation command
+					std::vector<Calculator::Expression> args;  ///< explicitly given argument expressions
+				};
+				std::vector<Command> _commands;
+		};
+
 		Matrix () {set(0);}
 		Matrix (double d);
 		Matrix (const std::string &cmds, Calculator &calc);
@@ -61,6 +80,9 @@ class Matrix {
 		Matrix& scale (double sx, double sy);
 		Matrix& scale (const DPair &p)       {return scale(p.x(), p.y());}
 		Matrix& rotate (double deg);
+		Matrix& rtranslate (double tx, double ty);
+		Matrix& rscale (double sx, double sy);
+		Matrix& rrotate (double deg);
 		Matrix& xskewByAngle (double deg);
 		Matrix& yskewByAngle (double deg);
 		Matrix& xskewByRatio (double xyratio);
@@ -72,6 +94,7 @@ class Matrix {
 		bool operator == (const Matrix &m) const;
 		bool operator != (const Matrix &m) const;
 		bool isIdentity() const;
+		bool isAffine () const {return _values[2][0] == 0 && _values[2][1] == 0 && _values[2][2] == 1;}
 		bool isTranslation (double &tx, double &ty) const;
 		std::string toSVG () const;
 		std::ostream& write (std::ostream &os) const;
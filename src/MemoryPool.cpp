@@ -0,0 +1,92 @@
+/*************************************************************************
+** MemoryPool.cpp                                                       **
+**                                                                      **
+** This file is part of dvisvgm -- a fast DVI to SVG converter          **
+** Copyright (C) 2005-2024 Martin Gieseking <martin.gieseking@uos.de>   **
+**                                                                      **
+** This program is free software; you can redistribute it and/or        **
+** modify it under the terms of the GNU General Public License as       **
+** published by the Free Software Foundation; either version 3 of       **
+** the License, or (at your option) any later version.                  **
+**                                                                      **
+** This program is distributed in the hope that it will be useful, but  **
+** WITHOUT ANY WARRANTY; without even the implied warranty of           **
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the         **
+** GNU General Public License for more details.                         **
+**                                                                      **
+** You should have received a copy of the GNU General Public License    **
+** along with this program; if not, see <http://www.gnu.org/licenses/>. **
+*************************************************************************/
+
+#include "MemoryPool.hpp"
+#include "MemoryStats.hpp"
+#include "utility.hpp"
+
+using namespace std;
+
+constexpr size_t MemoryPool::BLOCK_GRANULARITY;
+constexpr size_t MemoryPool::MAX_BLOCK_SIZE;
+constexpr size_t MemoryPool::CHUNK_SIZE;
+
+
+/** Rounds a requested object size up to the block size it's served from.
+ *  @param[in] size number of bytes requested
+ *  @return corresponding block size */
+size_t MemoryPool::blockSize (size_t size) {
+	return (size+BLOCK_GRANULARITY-1)/BLOCK_GRANULARITY*BLOCK_GRANULARITY;
+}
+
+
+/** Allocates a block of memory for an object of the given size. Requests
+ *  exceeding the maximum block size are forwarded to operator new.
+ *  @param[in] size number of bytes to allocate
+ *  @return pointer to the allocated block */
+void* MemoryPool::alloc (size_t size) {
+	size = blockSize(size);
+	if (MemoryStats::ENABLED)
+		MemoryStats::add(MemoryStats::Unit::XML, size);
+	if (size > MAX_BLOCK_SIZE)
+		return ::operator new(size);
+	FreeBlock* &head = _freeLists[size/BLOCK_GRANULARITY-1];
+	if (head) {
+		FreeBlock *block = head;
+		head = block->next;
+		return block;
+	}
+	return allocFromChunk(size);
+}
+
+
+/** Releases a block of memory previously returned by alloc(). Blocks served
+ *  by the pool are pushed onto the free list matching their size so that they
+ *  can be handed out again without requesting new memory from the system.
+ *  @param[in] ptr pointer to the block to release
+ *  @param[in] size number of bytes requested when the block was allocated */
+void MemoryPool::dealloc (void *ptr, size_t size) noexcept {
+	size = blockSize(size);
+	if (MemoryStats::ENABLED)
+		MemoryStats::sub(MemoryStats::Unit::XML, size);
+	if (size > MAX_BLOCK_SIZE)
+		::operator delete(ptr);
+	else {
+		FreeBlock* &head = _freeLists[size/BLOCK_GRANULARITY-1];
+		auto block = static_cast<FreeBlock*>(ptr);
+		block->next = head;
+		head = block;
+	}
+}
+
+
+/** Carves a block out of the current memory chunk. If the remaining space of
+ *  the chunk is too small, a new chunk is allocated first.
+ *  @param[in] size block size (multiple of BLOCK_GRANULARITY)
+ *  @return pointer to the allocated block */
+void* MemoryPool::allocFromChunk (size_t size) {
+	if (_chunkPos+size > CHUNK_SIZE) {
+		_chunks.emplace_back(util::make_unique<char[]>(CHUNK_SIZE));
+		_chunkPos = 0;
+	}
+	void *block = _chunks.back().get()+_chunkPos;
+	_chunkPos += size;
+	return block;
+}
@@ -0,0 +1,89 @@
+/*************************************************************************
+** MemoryPool.hpp                                                       **
+**                                                                      **
+** This file is part of dvisvgm -- a fast DVI to SVG converter          **
+** Copyright (C) 2005-2024 Martin Gieseking <martin.gieseking@uos.de>   **
+**                                                                      **
+** This program is free software; you can redistribute it and/or        **
+** modify it under the terms of the GNU General Public License as       **
+** published by the Free Software Foundation; either version 3 of       **
+** the License, or (at your option) any later version.                  **
+**                                                                      **
+** This program is distributed in the hope that it will be useful, but  **
+** WITHOUT ANY WARRANTY; without even the implied warranty of           **
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the         **
+** GNU General Public License for more details.                         **
+**                                                                      **
+** You should have received a copy of the GNU General Public License    **
+** along with this program; if not, see <http://www.gnu.org/licenses/>. **
+*************************************************************************/
+
+#ifndef MEMORYPOOL_HPP
+#define MEMORYPOOL_HPP
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+/** Simple pool allocator for small objects of varying size that are created
+ *  and destroyed in large numbers, like the nodes of the XML tree. The pool
+ *  carves the objects out of bigger memory chunks and recycles released
+ *  blocks through per-size free lists. This avoids the bookkeeping overhead
+ *  of allocating each object separately on the heap and keeps objects
+ *  created together close to each other in memory. Each thread uses its own
+ *  pool instance so that no synchronization is required. */
+class MemoryPool {
+	public:
+		MemoryPool () =default;
+		MemoryPool (const MemoryPool&) =delete;
+		void* alloc (size_t size);
+		void dealloc (void *ptr, size_t size) noexcept;
+
+		/** Returns the pool instance of the current thread. The pools are never
+		 *  destructed since pooled objects owned by statically allocated objects,
+		 *  like the special handlers, may be released after the destruction of
+		 *  thread-local variables. The per-thread memory is reclaimed by the OS
+		 *  at program exit. */
+		static MemoryPool& instance () {
+			static thread_local MemoryPool *pool = new MemoryPool;
+			return *pool;
+		}
+
+	protected:
+		static size_t blockSize (size_t size);
+		void* allocFromChunk (size_t size);
+
+	private:
+		struct FreeBlock {
+			FreeBlock *next;  ///< next free block of the same size
+		};
+		static constexpr size_t BLOCK_GRANULARITY = 16;    ///< sizes are rounded up to multiples of this value
+		static constexpr size_t MAX_BLOCK_SIZE = 256;      ///< maximum block size served by the pool
+		static constexpr size_t CHUNK_SIZE = 64*1024;      ///< number of bytes allocated per chunk
+		std::vector<std::unique_ptr<char[]>> _chunks;      ///< chunks of memory the blocks are carved out of
+		size_t _chunkPos=CHUNK_SIZE;                       ///< offset of the first unused byte in the current chunk
+		FreeBlock* _freeLists[MAX_BLOCK_SIZE/BLOCK_GRANULARITY] = {};  ///< heads of the free lists, one per block size
+};
+
+
+/** STL-compatible allocator that serves the storage of containers from the
+ *  thread-local MemoryPool. This allows containers with many small buffers,
+ *  like the attribute vectors of the XML elements, to recycle their storage
+ *  through the pool's free lists rather than the general heap. */
+template <typename T>
+class PoolAllocator {
+	public:
+		using value_type = T;
+		PoolAllocator () =default;
+		template <typename U> PoolAllocator (const PoolAllocator<U>&) noexcept {}
+		T* allocate (size_t n)                 {return static_cast<T*>(MemoryPool::instance().alloc(n*sizeof(T)));}
+		void deallocate (T *ptr, size_t n) noexcept {MemoryPool::instance().dealloc(ptr, n*sizeof(T));}
+};
+
+template <typename T, typename U>
+inline bool operator == (const PoolAllocator<T>&, const PoolAllocator<U>&) noexcept {return true;}
+
+template <typename T, typename U>
+inline bool operator != (const PoolAllocator<T>&, const PoolAllocator<U>&) noexcept {return false;}
+
+#endif
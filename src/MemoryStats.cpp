@@ -0,0 +1,103 @@
+/*************************************************************************
+** MemoryStats.cpp                                                      **
+**                                                                      **
+** This file is part of dvisvgm -- a fast DVI to SVG converter          **
+** Copyright (C) 2005-2024 Martin Gieseking <martin.gieseking@uos.de>   **
+**                                                                      **
+** This program is free software; you can redistribute it and/or        **
+** modify it under the terms of the GNU General Public License as       **
+** published by the Free Software Foundation; either version 3 of       **
+** the License, or (at your option) any later version.                  **
+**                                                                      **
+** This program is distributed in the hope that it will be useful, but  **
+** WITHOUT ANY WARRANTY; without even the implied warranty of           **
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the         **
+** GNU General Public License for more details.                         **
+**                                                                      **
+** You should have received a copy of the GNU General Public License    **
+** along with this program; if not, see <http://www.gnu.org/licenses/>. **
+*************************************************************************/
+
+#include "MemoryStats.hpp"
+
+using namespace std;
+
+bool MemoryStats::ENABLED = false;
+bool MemoryStats::REPORT = false;
+constexpr size_t MemoryStats::NUM_UNITS;
+MemoryStats::Counter MemoryStats::_counters[MemoryStats::NUM_UNITS];
+const char* const MemoryStats::_names[MemoryStats::NUM_UNITS] = {"xml", "glyphs", "ps", "clipper", "process"};
+
+
+/** Updates the peak value of a counter if its current value exceeds it.
+ *  @param[in] counter counter to update
+ *  @param[in] current current number of bytes held by the subsystem */
+void MemoryStats::updatePeak (Counter &counter, size_t current) {
+	size_t peak = counter.peak.load(memory_order_relaxed);
+	while (current > peak && !counter.peak.compare_exchange_weak(peak, current, memory_order_relaxed));
+}
+
+
+/** Records an increase of a subsystem's allocation size.
+ *  @param[in] unit subsystem the bytes belong to
+ *  @param[in] bytes number of bytes allocated */
+void MemoryStats::add (Unit unit, size_t bytes) {
+	Counter &counter = _counters[size_t(unit)];
+	updatePeak(counter, counter.current.fetch_add(bytes, memory_order_relaxed)+bytes);
+}
+
+
+/** Records a decrease of a subsystem's allocation size.
+ *  @param[in] unit subsystem the bytes belong to
+ *  @param[in] bytes number of bytes released */
+void MemoryStats::sub (Unit unit, size_t bytes) {
+	_counters[size_t(unit)].current.fetch_sub(bytes, memory_order_relaxed);
+}
+
+
+/** Records the absolute allocation size of a subsystem. Used by subsystems
+ *  that reuse a single buffer rather than allocating and releasing objects.
+ *  @param[in] unit subsystem the bytes belong to
+ *  @param[in] bytes number of bytes currently allocated */
+void MemoryStats::set (Unit unit, size_t bytes) {
+	Counter &counter = _counters[size_t(unit)];
+	counter.current.store(bytes, memory_order_relaxed);
+	updatePeak(counter, bytes);
+}
+
+
+/** Returns the total number of bytes currently held by all accounted subsystems.
+ *  The sampled resident set size is excluded since it covers the whole process
+ *  and would distort the memory budget derived from the subsystem allocations. */
+size_t MemoryStats::currentTotal () {
+	size_t total=0;
+	for (size_t i=0; i < NUM_UNITS; i++) {
+		if (Unit(i) != Unit::PROCESS)
+			total += _counters[i].current.load(memory_order_relaxed);
+	}
+	return total;
+}
+
+
+/** Writes the recorded sizes as tab-separated lines of the form
+ *  "label<TAB>subsystem<TAB>current<TAB>peak" (in bytes) so that the output
+ *  can easily be processed by scripts tracking the values across pages and
+ *  program versions.
+ *  @param[in] os stream the table is written to
+ *  @param[in] label first field of each line, e.g. a page number */
+void MemoryStats::write (ostream &os, const string &label) {
+	for (size_t i=0; i < NUM_UNITS; i++) {
+		os << label << '\t' << _names[i]
+			<< '\t' << _counters[i].current.load(memory_order_relaxed)
+			<< '\t' << _counters[i].peak.load(memory_order_relaxed) << '\n';
+	}
+}
+
+
+/** Resets all current and peak values to zero. */
+void MemoryStats::reset () {
+	for (Counter &counter : _counters) {
+		counter.current.store(0, memory_order_relaxed);
+		counter.peak.store(0, memory_order_relaxed);
+	}
+}
@@ -0,0 +1,72 @@
+/*************************************************************************
+** MemoryStats.hpp                                                      **
+**                                                                      **
+** This file is part of dvisvgm -- a fast DVI to SVG converter          **
+** Copyright (C) 2005-2024 Martin Gieseking <martin.gieseking@uos.de>   **
+**                                                                      **
+** This program is free software; you can redistribute it and/or        **
+** modify it under the terms of the GNU General Public License as       **
+** published by the Free Software Foundation; either version 3 of       **
+** the License, or (at your option) any later version.                  **
+**                                                                      **
+** This program is distributed in the hope that it will be useful, but  **
+** WITHOUT ANY WARRANTY; without even the implied warranty of           **
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the         **
+** GNU General Public License for more details.                         **
+**                                                                      **
+** You should have received a copy of the GNU General Public License    **
+** along with this program; if not, see <http://www.gnu.org/licenses/>. **
+*************************************************************************/
+
+#ifndef MEMORYSTATS_HPP
+#define MEMORYSTATS_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <ostream>
+#include <string>
+
+/** Collects the number of bytes held by the memory-intensive subsystems of
+ *  the converter, like the XML trees and the cached glyph outlines. Each
+ *  subsystem reports changes of its allocation size, and the current as well
+ *  as the peak number of bytes are accumulated per subsystem. The values can
+ *  be printed as a machine-readable table at page boundaries and after all
+ *  conversions have finished. Since only selected containers are accounted,
+ *  the listed sizes don't add up to the total memory usage of the process.
+ *  As a reference, the resident set size of the whole process is sampled at
+ *  the page boundaries and reported as pseudo-subsystem "process". */
+class MemoryStats {
+	public:
+		/// Subsystems whose memory usage is recorded separately.
+		enum class Unit {
+			XML,      ///< nodes and attributes of the XML trees (served by the MemoryPool)
+			GLYPHS,   ///< glyph outlines cached by the FontCache objects
+			PS,       ///< line buffer collecting the output of the PostScript interpreter
+			CLIPPER,  ///< flattened polygons processed by the polygon clipper
+			PROCESS,  ///< resident set size of the whole process, sampled at page boundaries
+		};
+
+		static void add (Unit unit, size_t bytes);
+		static void sub (Unit unit, size_t bytes);
+		static void set (Unit unit, size_t bytes);
+		static size_t currentTotal ();
+		static void write (std::ostream &os, const std::string &label);
+		static void reset ();
+
+		static bool ENABLED;  ///< if false, no sizes are recorded
+		static bool REPORT;   ///< if true, the recorded sizes are printed at page boundaries and at the end of the run
+
+	private:
+		struct Counter;
+		static void updatePeak (Counter &counter, size_t current);
+
+		struct Counter {
+			std::atomic<size_t> current{0};  ///< number of bytes currently held by the subsystem
+			std::atomic<size_t> peak{0};     ///< maximum number of bytes held at a time
+		};
+		static constexpr size_t NUM_UNITS = 5;
+		static Counter _counters[NUM_UNITS];           ///< one counter per subsystem
+		static const char* const _names[NUM_UNITS];    ///< subsystem names used in the output
+};
+
+#endif
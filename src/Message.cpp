@@ -22,12 +22,18 @@
 #include <cstdlib>
 #include <cstring>
 #include <iostream>
+#include <mutex>
 #include <unordered_map>
 #include "Message.hpp"
 #include "Terminal.hpp"
 
 using namespace std;
 
+// Serializes the terminal output of all message streams. Each string or character
+// passed to operator << is written atomically, so messages emitted by concurrent
+// conversion threads can't interleave within a chunk.
+static mutex messageMutex;
+
 MessageStream::MessageStream (std::ostream &os) noexcept
 	: _os(&os), _nl(true)
 {
@@ -82,6 +88,7 @@ void MessageStream::putChar (char c, ostream &os) {
 
 MessageStream& MessageStream::operator << (const char *str) {
 	if (_os && str) {
+		lock_guard<mutex> lock(messageMutex);
 		const char *first = str;
 		while (*first) {
 			const char *last = strchr(first, '\n');
@@ -104,8 +111,10 @@ MessageStream& MessageStream::operator << (const char *str) {
 
 
 MessageStream& MessageStream::operator << (const char &c) {
-	if (_os)
+	if (_os) {
+		lock_guard<mutex> lock(messageMutex);
 		putChar(c, *_os);
+	}
 	return *this;
 }
 
@@ -127,6 +136,7 @@ void MessageStream::outdent (bool all) {
 
 void MessageStream::clearline () {
 	if (_os) {
+		lock_guard<mutex> lock(messageMutex);
 		int cols = Terminal::columns();
 		*_os << '\r' << string(cols ? cols-1 : 79, ' ') << '\r';
 		_nl = true;
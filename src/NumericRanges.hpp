@@ -22,16 +22,51 @@
 #define NUMERICRANGES_HPP
 
 #include <algorithm>
-#include <list>
 #include <utility>
+#include <vector>
 
+/** Compact set of numeric values represented by a sorted vector of disjoint,
+ *  non-adjacent intervals. Besides iterating the intervals themselves, the
+ *  contained values can be traversed one by one with a ValueIterator. */
 template <class T>
 class NumericRanges {
 	public:
 		using Range = std::pair<T,T>;
-		using Container = std::list<Range>;
+		using Container = std::vector<Range>;
 		using ConstIterator = typename Container::const_iterator;
 
+		/** Iterates over the single values contained in the ranges. */
+		class ValueIterator {
+			friend class NumericRanges;
+			public:
+				T operator * () const {return _value;}
+
+				ValueIterator& operator ++ () {
+					if (_value < _rangeIt->second)
+						++_value;
+					else if (++_rangeIt != _endIt)
+						_value = _rangeIt->first;
+					return *this;
+				}
+
+				bool operator == (const ValueIterator &it) const {
+					return _rangeIt == it._rangeIt && (_rangeIt == _endIt || _value == it._value);
+				}
+
+				bool operator != (const ValueIterator &it) const {return !(*this == it);}
+
+			protected:
+				ValueIterator (ConstIterator rangeIt, ConstIterator endIt) : _rangeIt(rangeIt), _endIt(endIt) {
+					if (_rangeIt != _endIt)
+						_value = _rangeIt->first;
+				}
+
+			private:
+				ConstIterator _rangeIt;  ///< range the current value belongs to
+				ConstIterator _endIt;    ///< end iterator of the range container
+				T _value{};              ///< current value
+		};
+
 	public:
 		void addRange (T value)          {addRange(value, value);}
 		void addRange (T first, T last);
@@ -39,6 +74,8 @@ class NumericRanges {
 		size_t size () const             {return _ranges.size();}
 		ConstIterator begin () const     {return _ranges.begin();}
 		ConstIterator end () const       {return _ranges.end();}
+		ValueIterator valuesBegin () const {return ValueIterator(_ranges.begin(), _ranges.end());}
+		ValueIterator valuesEnd () const   {return ValueIterator(_ranges.end(), _ranges.end());}
 		const Container& ranges () const {return _ranges;}
 
 	private:
@@ -53,55 +90,35 @@ template <class T>
 void NumericRanges<T>::addRange (T first, T last) {
 	if (first > last)
 		std::swap(first, last);
-	auto it = _ranges.begin();
-	while (it != _ranges.end() && first > it->first+1 && first > it->second+1)
-		++it;
-	if (it == _ranges.end() || last < it->first-1 || first > it->second+1)
-		it = _ranges.insert(it, Range(first, last));
-	else if ((first < it->first && last >= it->first-1) || (first <= it->second+1 && last > it->second)) {
+	// find the first range that overlaps or touches [first, last]
+	auto it = std::lower_bound(_ranges.begin(), _ranges.end(), first,
+		[](const Range &range, T value) {
+			return range.second < value && value-range.second > 1;
+		});
+	if (it == _ranges.end() || (last < it->first && it->first-last > 1))
+		_ranges.insert(it, Range(first, last));  // new range is disjoint from and not adjacent to any existing one
+	else {
+		// merge the new range and all subsequent ranges overlapping or touching it into *it
 		it->first = std::min(it->first, first);
 		it->second = std::max(it->second, last);
-	}
-	// merge adjacent ranges
-	if (it != _ranges.end()) {
-		auto l = it;
-		auto r = it;
-		if (l == _ranges.begin())
-			l = _ranges.end();
-		else
-			--l;
-		++r;
-		bool l_modified = false;
-		bool r_modified = false;
-		if (l != _ranges.end() && l->second >= it->first-1) {
-			l->first = std::min(l->first, it->first);
-			l->second = std::max(l->second, it->second);
-			l_modified = true;
-		}
-		if (r != _ranges.end() && r->first <= it->second+1) {
-			r->first = std::min(r->first, it->first);
-			r->second = std::max(r->second, it->second);
-			r_modified = true;
-		}
-		if (l_modified || r_modified) {
-			_ranges.erase(it);
-			if (l_modified && r_modified && l->second >= r->first-1) {
-				l->first = std::min(l->first, r->first);
-				l->second = std::max(l->second, r->second);
-				_ranges.erase(r);
-			}
+		auto succ = it+1;
+		while (succ != _ranges.end() && (succ->first <= it->second || succ->first-it->second == 1)) {
+			it->second = std::max(it->second, succ->second);
+			++succ;
 		}
+		_ranges.erase(it+1, succ);
 	}
 }
 
 
+/** Returns true if a given value is covered by one of the ranges. */
 template <class T>
 bool NumericRanges<T>::valueExists (T value) const {
-	auto it = std::lower_bound(_ranges.begin(), _ranges.end(), Range(value, 0),
-		[](const Range &r1, const Range &r2) {
-			return r1.first < r2.first;
+	auto it = std::lower_bound(_ranges.begin(), _ranges.end(), value,
+		[](const Range &range, T val) {
+			return range.second < val;
 		});
-	return (it != _ranges.end() && it->first <= value && it->second >= value);
+	return (it != _ranges.end() && it->first <= value);
 }
 
 
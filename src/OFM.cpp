@@ -21,6 +21,7 @@
 #include <cstdint>
 #include <string>
 #include "Length.hpp"
+#include "MappedInputStream.hpp"
 #include "OFM.hpp"
 
 using namespace std;
@@ -71,6 +72,7 @@ OFM::FileDimensions OFM::read (istream &is, uint32_t maxNumWidths) {
 		_firstChar = dim.bc;  // smallest character code in font
 		_lastChar = dim.ec;   // largest character code in font
 		_vertical = (dim.dir > 0);
+		_dim = dim;
 	}
 	return dim;
 }
@@ -83,36 +85,91 @@ void OFM::readHeader (StreamReader &reader) {
 }
 
 
-/** Reads a sequence of values and stores them in a vector.
+/** Reads a sequence of values and stores them in a table.
  *  @param[in] reader the TFM data is read from this object
- *  @param[out] words vector taking the read words
+ *  @param[out] table takes the read words
  *  @param[in] n number of entries to read */
-static void read_words (StreamReader &reader, vector<FixWord> &words, size_t n) {
-	words.resize(n);
+static void read_words (StreamReader &reader, BEWordView &table, size_t n) {
+	vector<uint32_t> words(n);
 	for (size_t i=0; i < n; i++)
-		words[i] = reader.readSigned(4);
+		words[i] = reader.readUnsigned(4);
+	table.assign(std::move(words));
 }
 
 
-/** Reads and stores the required OFM tables (characters widths, heights, depths, ...). */
-void OFM::readTables (StreamReader &reader, const FileDimensions &dim) {
-	read_words(reader, _widthTable, dim.nw);
-	read_words(reader, _heightTable, dim.nh);
-	read_words(reader, _depthTable, dim.nd);
-	read_words(reader, _italicTable, dim.ni);
-	reader.skip(8*dim.nl + 4*dim.nk + 8*dim.ne);
-	read_words(reader, _params, min(dim.np, 7u));  // we only need params 0-6
+/** Reads and stores the required OFM tables (characters widths, heights, depths, ...).
+ *  Expects the stream pointer to be located on the first byte of the width table. */
+void OFM::readTables (StreamReader &reader) const {
+	read_words(reader, _widthTable, _dim.nw);
+	read_words(reader, _heightTable, _dim.nh);
+	read_words(reader, _depthTable, _dim.nd);
+	read_words(reader, _italicTable, _dim.ni);
+	reader.skip(8*_dim.nl + 4*_dim.nk + 8*_dim.ne);
+	readParameters(reader);
+}
+
+
+/** Reads the font parameters. Expects the stream pointer to be located
+ *  on the first byte of the param section. */
+void OFM::readParameters (StreamReader &reader) const {
+	auto np = min(_dim.np, 7u);  // we only need params 0-6
+	_params.resize(np);
+	for (uint32_t i=0; i < np; i++)
+		_params[i] = reader.readSigned(4);
 	_params.resize(7, 0);   // ensure 7 parameters
-	for (FixWord h : _heightTable)
-		_ascent = max(_ascent, h);
-	for (FixWord d : _depthTable)
-		_descent = max(_descent, d);
+}
+
+
+/** Reads and decodes the char-info entries and metric tables. If the metrics are
+ *  read from a memory-mapped file, the width, height, depth, and italic correction
+ *  tables are accessed directly in the read-only mapping rather than being copied
+ *  to private heap memory, so that concurrent processes evaluating the same metric
+ *  file share the physical pages.
+ *  @param[in] is stream to read the table data from */
+void OFM::decodeTables (istream &is) const {
+	is.clear();
+	StreamReader reader(is);
+	const char *mapdata = nullptr;
+	if (auto mis = dynamic_cast<const MappedInputStream*>(&is)) {
+		size_t tableBytes = charInfoBytes() + 4*size_t(_dim.nw+_dim.nh+_dim.nd+_dim.ni);
+		if (mis->mapped() && mis->size() >= size_t(_charInfoPos)+tableBytes)
+			mapdata = mis->data();
+	}
+	is.seekg(_charInfoPos);  // move to char info table
+	readCharInfos(reader, mapdata ? mapdata+_charInfoPos : nullptr);
+	streamoff tablesPos = _charInfoPos + streamoff(charInfoBytes());
+	if (!mapdata) {
+		is.seekg(tablesPos);
+		readTables(reader);
+	}
+	else {
+		const char *p = mapdata+tablesPos;
+		_widthTable.assign(p, _dim.nw);   p += 4*_dim.nw;
+		_heightTable.assign(p, _dim.nh);  p += 4*_dim.nh;
+		_depthTable.assign(p, _dim.nd);   p += 4*_dim.nd;
+		_italicTable.assign(p, _dim.ni);  p += 4*_dim.ni;
+		is.seekg(tablesPos + streamoff(4*size_t(_dim.nw+_dim.nh+_dim.nd+_dim.ni) + 8*_dim.nl + 4*_dim.nk + 8*_dim.ne));
+		readParameters(reader);
+	}
+	for (size_t i=0; i < _heightTable.size(); i++)
+		_ascent = max(_ascent, FixWord(int32_t(_heightTable[i])));
+	for (size_t i=0; i < _depthTable.size(); i++)
+		_descent = max(_descent, FixWord(int32_t(_depthTable[i])));
+	_tablesRead = true;
+}
+
+
+/** Ensures that the metric tables have been decoded. */
+void OFM::ensureTables () const {
+	if (!_tablesRead && ownedStream())
+		decodeTables(*ownedStream());
 }
 
 
 /** Returns the character index for a given character or -1 if
  *  the OFM file doesn't contain information on the character. */
 size_t OFM::charIndex (int c) const {
+	ensureTables();
 	uint32_t chr=c;
 	if (chr < _firstChar || chr > _lastChar || size_t(chr-_firstChar) >= numCharInfos())
 		return -1;
@@ -125,7 +182,7 @@ double OFM::getCharWidth (int c) const {
 	auto cindex = charIndex(c);
 	if (cindex == size_t(-1))
 		return 0;
-	return double(_widthTable[widthIndex(cindex)])*_designSize;
+	return double(FixWord(int32_t(_widthTable[widthIndex(cindex)])))*_designSize;
 }
 
 
@@ -134,7 +191,7 @@ double OFM::getCharHeight (int c) const {
 	auto cindex = charIndex(c);
 	if (cindex == size_t(-1))
 		return 0;
-	return double(_heightTable[heightIndex(cindex)])*_designSize;
+	return double(FixWord(int32_t(_heightTable[heightIndex(cindex)])))*_designSize;
 }
 
 
@@ -143,7 +200,7 @@ double OFM::getCharDepth (int c) const {
 	auto cindex = charIndex(c);
 	if (cindex == size_t(-1))
 		return 0;
-	return double(_depthTable[depthIndex(cindex)])*_designSize;
+	return double(FixWord(int32_t(_depthTable[depthIndex(cindex)])))*_designSize;
 }
 
 
@@ -152,29 +209,33 @@ double OFM::getItalicCorr (int c) const {
 	auto cindex = charIndex(c);
 	if (cindex == size_t(-1))
 		return 0;
-	return double(_italicTable[italicIndex(cindex)])*_designSize;
+	return double(FixWord(int32_t(_italicTable[italicIndex(cindex)])))*_designSize;
 }
 
 /** Returns the optimal space width between words in bp units. */
 double OFM::getSpace () const {
+	ensureTables();
 	return _params.empty() ? 0 : double(_params[1])*_designSize;
 }
 
 
 /** Returns the amount of glue stretching between words in bp units. */
 double OFM::getSpaceStretch () const {
+	ensureTables();
 	return _params.empty() ? 0 : double(_params[2])*_designSize;
 }
 
 
 /** Returns the amount of glue shrinking between words in bp units. */
 double OFM::getSpaceShrink () const {
+	ensureTables();
 	return _params.empty() ? 0 : double(_params[3])*_designSize;
 }
 
 
 /** Returns the size of one EM unit in bp units. */
 double OFM::getQuad () const {
+	ensureTables();
 	if (_params.empty() || _params[5] == 0)
 		return _designSize;
 	return double(_params[5])*_designSize;
@@ -191,20 +252,23 @@ void OFM0::read (std::istream &is) {
 		throw FontMetricException("inconsistent table size values");
 	StreamReader sr(is);
 	readHeader(sr);
-	sr.seek(56 + dim.lh*4);  // move to char info table
-	readCharInfos(sr);
-	readTables(sr, dim);
+	setCharInfoPos(56 + 4*streamoff(dim.lh));
+	if (&is != ownedStream())  // stream not kept open beyond this call?
+		decodeTables(is);       // decode the tables immediately
 }
 
 
 /** Reads and stores the required data from the char-info section.
  *  Expects the stream pointer to be located on the first byte of the first char-info entry. */
-void OFM0::readCharInfos (StreamReader &reader) {
-	auto numChars = _lastChar-_firstChar+1;
-	_charInfos.resize(numChars);
-	for (size_t i=0; i < numChars; i++) {
-		_charInfos[i] = uint64_t(reader.readUnsigned(4)) << 32;
-		_charInfos[i] |= reader.readUnsigned(4);
+void OFM0::readCharInfos (StreamReader &reader, const char *mapdata) const {
+	size_t numChars = _lastChar-_firstChar+1;
+	if (mapdata)  // file mapped into memory? => access the entries in place
+		_charInfos.assign(mapdata, 2*numChars);
+	else {
+		vector<uint32_t> words(2*numChars);
+		for (uint32_t &word : words)
+			word = reader.readUnsigned(4);
+		_charInfos.assign(std::move(words));
 	}
 }
 
@@ -232,15 +296,17 @@ void OFM1::read (std::istream &is) {
 	if (29 + dim.lh + _ncw + dim.nw + dim.nh + dim.nd + dim.ni +2*dim.nl + dim.nk + 2*dim.ne + dim.np + sum != dim.lf)
 		throw FontMetricException("inconsistent table size values");
 	readHeader(sr);
-	sr.seek(4*nco);  // move to char info table
-	readCharInfos(sr);
-	readTables(sr, dim);
+	setCharInfoPos(4*streamoff(nco));
+	if (&is != ownedStream())  // stream not kept open beyond this call?
+		decodeTables(is);       // decode the tables immediately
 }
 
 
-/** Reads and stores the required data from the char-info section.
+/** Reads and stores the required data from the char-info section. Since the
+ *  entries are run-length encoded, they must be expanded into private memory
+ *  and can't be accessed in the file mapping directly.
  *  Expects the stream pointer to be located on the first byte of the first char-info entry. */
-void OFM1::readCharInfos (StreamReader &reader) {
+void OFM1::readCharInfos (StreamReader &reader, const char*) const {
 	auto numCharInfos = _ncw/(3 + _npc/2);  // number of char info entries in file
 	auto numChars = _lastChar-_firstChar+1;
 	size_t numCharsRead=0;
@@ -26,6 +26,32 @@
 #include "FontMetrics.hpp"
 #include "StreamReader.hpp"
 
+
+/** Provides read-only access to a sequence of contiguous big-endian 32-bit words.
+ *  The words are either accessed directly in the memory-mapped metric file, so that
+ *  concurrent processes evaluating the same file share the physical pages, or held
+ *  in a privately decoded copy if no file mapping is available. */
+class BEWordView {
+	public:
+		void assign (const char *data, size_t n) {_data = data; _size = n; _words.clear();}
+		void assign (std::vector<uint32_t> &&words) {_words = std::move(words); _data = nullptr; _size = _words.size();}
+		size_t size () const {return _size;}
+		bool empty () const  {return _size == 0;}
+
+		uint32_t operator [] (size_t n) const {
+			if (!_data)
+				return _words[n];
+			auto p = reinterpret_cast<const unsigned char*>(_data)+4*n;
+			return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | p[3];
+		}
+
+	private:
+		const char *_data=nullptr;    ///< start of the mapped word sequence (nullptr if _words is used)
+		size_t _size=0;               ///< number of 32-bit words
+		std::vector<uint32_t> _words; ///< privately owned words if no mapping is available
+};
+
+
 class OFM : public FontMetrics {
 	public:
 		virtual int level () const =0;
@@ -35,8 +61,8 @@ class OFM : public FontMetrics {
 		uint32_t lastChar () const override    {return _lastChar;}
 		bool verticalLayout () const  override {return _vertical;}
 		double getDesignSize () const override {return _designSize;}
-		double getAscent () const override     {return double(_ascent)*_designSize;}
-		double getDescent () const override    {return double(_descent)*_designSize;}
+		double getAscent () const override     {ensureTables(); return double(_ascent)*_designSize;}
+		double getDescent () const override    {ensureTables(); return double(_descent)*_designSize;}
 		double getCharWidth (int c) const override;
 		double getCharHeight (int c) const override;
 		double getCharDepth (int c) const override;
@@ -67,8 +93,14 @@ class OFM : public FontMetrics {
 
 		FileDimensions read (std::istream &is, uint32_t maxNumWidths);
 		void readHeader (StreamReader &reader);
-		void readTables (StreamReader &reader, const FileDimensions &dim);
+		void readTables (StreamReader &reader) const;
+		void readParameters (StreamReader &reader) const;
+		void decodeTables (std::istream &is) const;
+		void ensureTables () const;
+		void setCharInfoPos (std::streamoff pos) {_charInfoPos = pos; _tablesRead = false;}
 		size_t charIndex (int c) const;
+		virtual void readCharInfos (StreamReader &reader, const char *mapdata) const =0;
+		virtual size_t charInfoBytes () const =0;
 		virtual size_t numCharInfos () const =0;
 		virtual size_t widthIndex (size_t n) const =0;
 		virtual size_t heightIndex (size_t n) const =0;
@@ -79,12 +111,15 @@ class OFM : public FontMetrics {
 		uint32_t _checksum=0;
 		uint32_t _firstChar=0, _lastChar=0;
 		double _designSize=0;  ///< design size of the font in PS points (72bp = 1in)
-		std::vector<FixWord> _widthTable;    ///< character widths in design size units
-		std::vector<FixWord> _heightTable;   ///< character height in design size units
-		std::vector<FixWord> _depthTable;    ///< character depth in design size units
-		std::vector<FixWord> _italicTable;   ///< italic corrections in design size units
-		std::vector<FixWord> _params;        ///< values of the OFM's param section
-		FixWord _ascent=0, _descent=0;       ///< max. height and depth
+		FileDimensions _dim;   ///< file offsets and table sizes read from the preamble
+		std::streamoff _charInfoPos=0;  ///< file offset of the char-info table
+		mutable bool _tablesRead=true;  ///< true if the metric tables have been decoded
+		mutable BEWordView _widthTable;    ///< character widths in design size units
+		mutable BEWordView _heightTable;   ///< character height in design size units
+		mutable BEWordView _depthTable;    ///< character depth in design size units
+		mutable BEWordView _italicTable;   ///< italic corrections in design size units
+		mutable std::vector<FixWord> _params;        ///< values of the OFM's param section
+		mutable FixWord _ascent=0, _descent=0;       ///< max. height and depth
 		bool _vertical=false;     ///< true if metrics refer to vertical text layout
 };
 
@@ -95,15 +130,16 @@ class OFM0 : public OFM {
 		int level () const override {return 0;}
 
 	protected:
-		void readCharInfos (StreamReader &reader);
-		size_t numCharInfos () const override {return _charInfos.size();}
-		size_t widthIndex (size_t n) const override  {return (_charInfos[n] >> 48) & 0xFFFF;}
-		size_t heightIndex (size_t n) const override {return (_charInfos[n] >> 40) & 0xFF;}
-		size_t depthIndex (size_t n) const override  {return (_charInfos[n] >> 32) & 0xFF;}
-		size_t italicIndex (size_t n) const override {return (_charInfos[n] >> 24) & 0xFF;}
+		void readCharInfos (StreamReader &reader, const char *mapdata) const override;
+		size_t charInfoBytes () const override {return 8*(size_t(_lastChar)-_firstChar+1);}
+		size_t numCharInfos () const override {return _charInfos.size()/2;}
+		size_t widthIndex (size_t n) const override  {return (_charInfos[2*n] >> 16) & 0xFFFF;}
+		size_t heightIndex (size_t n) const override {return (_charInfos[2*n] >> 8) & 0xFF;}
+		size_t depthIndex (size_t n) const override  {return _charInfos[2*n] & 0xFF;}
+		size_t italicIndex (size_t n) const override {return (_charInfos[2*n+1] >> 24) & 0xFF;}
 
 	private:
-		std::vector<uint64_t>  _charInfos;
+		mutable BEWordView _charInfos;  ///< pairs of 32-bit words forming the char-info entries
 };
 
 
@@ -119,7 +155,8 @@ class OFM1 : public OFM {
 		int level () const override {return 1;}
 
 	protected:
-		void readCharInfos (StreamReader &reader);
+		void readCharInfos (StreamReader &reader, const char *mapdata) const override;
+		size_t charInfoBytes () const override {return 4*size_t(_ncw);}
 		size_t numCharInfos () const override {return _charInfos.size();}
 		size_t widthIndex (size_t n) const override  {return _charInfos[n].widthIndex;}
 		size_t heightIndex (size_t n) const override {return _charInfos[n].heightIndex;}
@@ -129,7 +166,7 @@ class OFM1 : public OFM {
 	private:
 		uint32_t _ncw=0;
 		uint32_t _npc=0;
-		std::vector<CharInfo> _charInfos;
+		mutable std::vector<CharInfo> _charInfos;
 };
 
 #endif
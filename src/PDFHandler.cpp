@@ -21,6 +21,7 @@
 #include <fstream>
 #include <iterator>
 #include <limits>
+#include <regex>
 #include <sstream>
 #include "FilePath.hpp"
 #include "FileSystem.hpp"
@@ -166,20 +167,21 @@ unique_ptr<SVGElement> PDFHandler::convert (const string &fname, int pageno, uni
 	auto closefunc = std::bind(&PDFHandler::elementClosed, this, std::placeholders::_1);
 	xmlParser.setNotifyFuncs(openfunc, closefunc);
 	xmlParser.setRootElement(nullptr);
-	string xmlfname = FileSystem::tmpdir()+FilePath(fname, FilePath::PT_FILE).filename()+"-"+ to_string(_pageno)+".xml";
-	mutool("draw -Ftrace -o"+xmlfname+" "+_fname+" "+to_string(_pageno));
-	ifstream ifs(xmlfname);
-	xmlParser.parse(ifs);
-	ifs.close();
-	// remove trace XML
-	if (!PhysicalFont::KEEP_TEMP_FILES)
-		FileSystem::remove(xmlfname);
+	string xml = mutool("draw -Ftrace -o- "+_fname+" "+to_string(_pageno));
+	if (PhysicalFont::KEEP_TEMP_FILES) {
+		string xmlfname = FileSystem::tmpdir()+FilePath(fname, FilePath::PT_FILE).filename()+"-"+ to_string(_pageno)+".xml";
+		ofstream ofs(xmlfname);
+		ofs << xml;
+	}
+	istringstream iss(xml);
+	xmlParser.parse(iss);
 	return finishPage();
 }
 
 
 void PDFHandler::initFile (const string &fname) {
 	finishFile();
+	_showCache.clear();
 	_fname = FilePath(fname, FilePath::PT_FILE).absolute();
 	_fname = "\"" + _fname + "\"";
 	_numPages = parse_value<int>(mtShow("trailer/Root/Pages/Count"));
@@ -384,9 +386,7 @@ static unique_ptr<SVGElement> create_path_element (XMLElement *srcPathElement, b
 		if (bbox)
 			*bbox = path.computeBBox();
 		pathElement = util::make_unique<SVGElement>("path");
-		ostringstream oss;
-		path.writeSVG(oss, SVGTree::RELATIVE_PATH_CMDS);
-		pathElement->addAttribute("d", oss.str());
+		pathElement->addAttribute("d", path.svgPathData(SVGTree::RELATIVE_PATH_CMDS));
 		string colorspace = parse_attr_value<string>(srcPathElement, "colorspace");
 		string color = parse_attr_value<string>(srcPathElement, "color");
 		if (!stroke) {  // create path for filling?
@@ -478,11 +478,11 @@ void PDFHandler::doClipPath (XMLElement *trcClipPathElement) {
 		string id = "cp"+to_string(_numClipPath++);
 		auto clipPathElement = util::make_unique<SVGElement>("clipPath");
 		clipPathElement->addAttribute("id", id);
+		clipPathElement->append(std::move(pathElement));
+		XMLElement *stored = _svg->appendUniqueToDefs(std::move(clipPathElement));
 		auto groupElement = util::make_unique<SVGElement>("g");
-		_clipPathStack.emplace(std::move(id), groupElement.get());
+		_clipPathStack.emplace(stored->getAttributeValue("id"), groupElement.get());
 		groupElement->setClipPathUrl(_clipPathStack.top().id);
-		clipPathElement->append(std::move(pathElement));
-		_svg->appendToDefs(std::move(clipPathElement));
 		_svg->pushPageContext(std::move(groupElement));
 	}
 }
@@ -573,7 +573,7 @@ void PDFHandler::doFillImage (XMLElement *trcFillImageElement) {
 			auto useElement = create_use_element(0, 0, imgID);
 			useElement->setOpacity(OpacityAlpha(alpha));
 			Matrix matrix = parse_attr_value<Matrix>(trcFillImageElement, "transform");
-			matrix.rmultiply(ScalingMatrix(1/w, 1/h));
+			matrix.rscale(1/w, 1/h);
 			useElement->setTransform(matrix);
 			if (!_clipPathStack.empty())
 				useElement->setClipPathUrl(_clipPathStack.top().id);
@@ -722,10 +722,8 @@ static unique_ptr<SVGElement> rect_path_elem (const vector<double> &coords) {
 	path.lineto(coords[2], coords[3]);
 	path.lineto(coords[0], coords[3]);
 	path.closepath();
-	ostringstream oss;
-	path.writeSVG(oss, SVGTree::RELATIVE_PATH_CMDS);
 	auto pathElement = util::make_unique<SVGElement>("path");
-	pathElement->addAttribute("d", oss.str());
+	pathElement->addAttribute("d", path.svgPathData(SVGTree::RELATIVE_PATH_CMDS));
 	return pathElement;
 }
 
@@ -851,6 +849,41 @@ string PDFHandler::mtShow (const string &fname, const string &path, const Search
 	return mutool(cmd, pattern);
 }
 
+
+/** Applies a search/replace pattern to a string and returns the concatenated
+ *  replacements of all matches, i.e. the same filtering Process::run performs
+ *  on the output of a subprocess. */
+static string apply_pattern (const string &str, const SearchPattern &pattern) {
+	if (pattern.search.empty())
+		return str;
+	string result;
+	regex re(pattern.search);
+	for (auto it = sregex_iterator(str.begin(), str.end(), re); it != sregex_iterator(); ++it)
+		result += it->format(pattern.replace, regex_constants::format_no_copy);
+	return result;
+}
+
+
+/** Retrieves data from the PDF file currently processed. The query results are
+ *  cached for the lifetime of the document, so that each of them leads to at most
+ *  one mutool invocation per file regardless of how many pages request it, e.g.
+ *  the font name lookups performed when collecting the objects of a page.
+ *  @param[in] path path expression locating the requested data
+ *  @param[in] fmtmode flag specifying the output format
+ *  @return mutool output, result of the query */
+string PDFHandler::mtShow (const string &path, char fmtmode) const {
+	string key = fmtmode+path;
+	auto it = _showCache.find(key);
+	if (it == _showCache.end())
+		it = _showCache.emplace(std::move(key), mtShow(_fname, path, fmtmode)).first;
+	return it->second;
+}
+
+
+string PDFHandler::mtShow (const string &path, const SearchPattern &pattern, char fmtmode) const {
+	return apply_pattern(mtShow(path, fmtmode), pattern);
+}
+
 #if 0
 int main (int argc, char *argv[]) {
 	if (argc < 2)
@@ -66,10 +66,8 @@ class PDFHandler {
 		static std::string mtExtract (const std::string &fname, const SearchPattern &pattern);
 		static std::string mtShow (const std::string &fname, const std::string &path, char fmtmode= 'b');
 		static std::string mtShow (const std::string &fname, const std::string &path, const SearchPattern &pattern, char fmtmode= 'b');
-		std::string mtShow (const std::string &path, char fmtmode= 'b') const {return mtShow(_fname, path, fmtmode);}
-		std::string mtShow (const std::string &path, const SearchPattern &pattern, char fmtmode= 'b') const {
-			return mtShow(_fname, path, pattern, fmtmode);
-		}
+		std::string mtShow (const std::string &path, char fmtmode= 'b') const;
+		std::string mtShow (const std::string &path, const SearchPattern &pattern, char fmtmode= 'b') const;
 		void initFile (const std::string &fname);
 		void finishFile ();
 		void initPage (int pageno, std::unique_ptr<SVGElement> context);
@@ -93,6 +91,7 @@ class PDFHandler {
 		std::string _fname;
 		int _pageno=0;
 		int _numPages=0;
+		mutable std::map<std::string,std::string> _showCache;  ///< cached results of "mutool show" queries on the current file
 		std::map<int,std::string> _extractedFiles;
 		std::map<std::string,ObjID> _objDict;    ///< object names => object IDs
 		std::vector<std::string> _imgSeq;
@@ -0,0 +1,108 @@
+/*************************************************************************
+** PNGImage.cpp                                                         **
+**                                                                      **
+** This file is part of dvisvgm -- a fast DVI to SVG converter          **
+** Copyright (C) 2005-2024 Martin Gieseking <martin.gieseking@uos.de>   **
+**                                                                      **
+** This program is free software; you can redistribute it and/or        **
+** modify it under the terms of the GNU General Public License as       **
+** published by the Free Software Foundation; either version 3 of       **
+** the License, or (at your option) any later version.                  **
+**                                                                      **
+** This program is distributed in the hope that it will be useful, but  **
+** WITHOUT ANY WARRANTY; without even the implied warranty of           **
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the         **
+** GNU General Public License for more details.                         **
+**                                                                      **
+** You should have received a copy of the GNU General Public License    **
+** along with this program; if not, see <http://www.gnu.org/licenses/>. **
+*************************************************************************/
+
+#include <sstream>
+#include <zlib.h>
+#include "PNGImage.hpp"
+#include "StreamWriter.hpp"
+#include "ZLibOutputStream.hpp"
+
+using namespace std;
+
+
+/** Creates an image of the given size with all pixels set to transparent black.
+ *  @param[in] width width of the image in pixels
+ *  @param[in] height height of the image in pixels */
+PNGImage::PNGImage (int width, int height)
+	: _width(max(1, width)), _height(max(1, height)),
+	  _pixels(size_t(_width)*size_t(_height)*4, 0)
+{
+}
+
+
+/** Assigns an opaque color to a single pixel. Coordinates outside
+ *  the image area are silently ignored.
+ *  @param[in] x horizontal pixel coordinate (0 denotes the leftmost column)
+ *  @param[in] y vertical pixel coordinate (0 denotes the topmost row)
+ *  @param[in] color color to assign to the pixel */
+void PNGImage::setPixel (int x, int y, const Color &color) {
+	if (x >= 0 && x < _width && y >= 0 && y < _height) {
+		double r, g, b;
+		color.getRGB(r, g, b);
+		uint8_t *pixel = &_pixels[(size_t(y)*_width + x)*4];
+		pixel[0] = uint8_t(r*255+0.5);
+		pixel[1] = uint8_t(g*255+0.5);
+		pixel[2] = uint8_t(b*255+0.5);
+		pixel[3] = 0xff;
+	}
+}
+
+
+/** Writes a single PNG chunk consisting of the data length, the chunk type,
+ *  the data bytes, and a CRC32 checksum computed over type and data.
+ *  @param[in] os stream the chunk is written to
+ *  @param[in] type four-character chunk type, e.g. "IHDR"
+ *  @param[in] data payload of the chunk */
+static void write_chunk (ostream &os, const char *type, const string &data) {
+	StreamWriter writer(os);
+	writer.writeUnsigned(uint32_t(data.length()), 4);
+	writer.writeString(type);
+	writer.writeString(data);
+	uint32_t crc = crc32(0, nullptr, 0);
+	crc = crc32(crc, reinterpret_cast<const Bytef*>(type), 4);
+	crc = crc32(crc, reinterpret_cast<const Bytef*>(data.data()), uInt(data.length()));
+	writer.writeUnsigned(crc, 4);
+}
+
+
+/** Writes the image in PNG format (8 bits per component, color type RGBA)
+ *  to the given output stream.
+ *  @param[in] os stream to write the PNG data to
+ *  @return true on success */
+bool PNGImage::write (ostream &os) const {
+	static const char signature[8] = {'\x89', 'P', 'N', 'G', '\r', '\n', '\x1a', '\n'};
+	os.write(signature, 8);
+	// image header (IHDR): width, height, bit depth 8, color type 6 (RGBA),
+	// deflate compression, no filter heuristics, no interlacing
+	ostringstream ihdr;
+	StreamWriter writer(ihdr);
+	writer.writeUnsigned(uint32_t(_width), 4);
+	writer.writeUnsigned(uint32_t(_height), 4);
+	writer.writeUnsigned(8, 1);
+	writer.writeUnsigned(6, 1);
+	writer.writeUnsigned(0, 3);
+	write_chunk(os, "IHDR", ihdr.str());
+	// image data (IDAT): zlib-compressed rows, each preceded by filter type 0
+	ostringstream idat;
+	try {
+		ZLibOutputStream zos(idat, ZLIB_DEFLATE, 9);
+		for (int y=0; y < _height; y++) {
+			zos.put('\0');  // no filter applied to this row
+			zos.write(reinterpret_cast<const char*>(&_pixels[size_t(y)*_width*4]), streamsize(_width)*4);
+		}
+		zos.close();
+	}
+	catch (ZLibException &e) {
+		return false;
+	}
+	write_chunk(os, "IDAT", idat.str());
+	write_chunk(os, "IEND", "");
+	return bool(os);
+}
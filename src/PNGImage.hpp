@@ -0,0 +1,45 @@
+/*************************************************************************
+** PNGImage.hpp                                                         **
+**                                                                      **
+** This file is part of dvisvgm -- a fast DVI to SVG converter          **
+** Copyright (C) 2005-2024 Martin Gieseking <martin.gieseking@uos.de>   **
+**                                                                      **
+** This program is free software; you can redistribute it and/or        **
+** modify it under the terms of the GNU General Public License as       **
+** published by the Free Software Foundation; either version 3 of       **
+** the License, or (at your option) any later version.                  **
+**                                                                      **
+** This program is distributed in the hope that it will be useful, but  **
+** WITHOUT ANY WARRANTY; without even the implied warranty of           **
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the         **
+** GNU General Public License for more details.                         **
+**                                                                      **
+** You should have received a copy of the GNU General Public License    **
+** along with this program; if not, see <http://www.gnu.org/licenses/>. **
+*************************************************************************/
+
+#ifndef PNGIMAGE_HPP
+#define PNGIMAGE_HPP
+
+#include <cstdint>
+#include <ostream>
+#include <vector>
+#include "Color.hpp"
+
+/** Simple RGBA raster image that can be written in PNG format.
+ *  All pixels are initially transparent; setting a pixel makes it opaque. */
+class PNGImage {
+	public:
+		PNGImage (int width, int height);
+		int width () const  {return _width;}
+		int height () const {return _height;}
+		void setPixel (int x, int y, const Color &color);
+		bool write (std::ostream &os) const;
+
+	private:
+		int _width;   ///< width of the image in pixels
+		int _height;  ///< height of the image in pixels
+		std::vector<uint8_t> _pixels;  ///< RGBA components, row by row from top to bottom
+};
+
+#endif
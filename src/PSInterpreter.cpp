@@ -26,9 +26,13 @@
 #include "FileFinder.hpp"
 #include "FileSystem.hpp"
 #include "InputReader.hpp"
+#include "MemoryStats.hpp"
 #include "Message.hpp"
 #include "PSInterpreter.hpp"
+#include "PageTimeout.hpp"
 #include "SignalHandler.hpp"
+#include "Timing.hpp"
+#include "Tracepoints.hpp"
 #include "utility.hpp"
 
 using namespace std;
@@ -42,7 +46,45 @@ PSInterpreter::PSInterpreter (PSActions *actions)
 }
 
 
+/** Ensures the interpreter is completely initialized. Waits for a background
+ *  initialization started by initAsync() or, if none is pending, performs the
+ *  initialization synchronously. */
 void PSInterpreter::init () {
+	joinAsyncInit(true);
+	if (!_initialized)
+		initVM();
+}
+
+
+/** Starts the Ghostscript initialization, including the execution of the prologue
+ *  code, in a background thread, so that the fixed startup costs overlap the
+ *  document processing preceding the first PostScript special. Calling this
+ *  function is optional; execute() initializes the interpreter on demand. */
+void PSInterpreter::initAsync () {
+	if (!_initialized && !_initFuture.valid() && _gs.revision() > 0)
+		_initFuture = async(launch::async, [this] {initVM();});
+}
+
+
+/** Waits for a pending background initialization to finish.
+ *  @param[in] rethrow if true, errors that occurred during the initialization are
+ *  propagated; otherwise, they're dropped here, and the next synchronous init()
+ *  call repeats the initialization and reports the error in the usual place */
+void PSInterpreter::joinAsyncInit (bool rethrow) {
+	if (_initFuture.valid()) {
+		auto initFuture = std::move(_initFuture);
+		try {
+			initFuture.get();
+		}
+		catch (...) {
+			if (rethrow)
+				throw;
+		}
+	}
+}
+
+
+void PSInterpreter::initVM () {
 	if (!_initialized) {
 		vector<const char*> gsargs {
 			"gs",                // dummy name
@@ -72,11 +114,30 @@ void PSInterpreter::init () {
 		}
 		_gs.init(gsargs.size(), gsargs.data(), this);
 		_gs.set_stdio(input, output, error);
+		_gs.set_poll(poll);
 		_initialized = true;
 		// Before executing any random PS code redefine some operators and run
 		// initializing PS code. This cannot be done in the constructor because we
 		// need the completely initialized PSInterpreter object here.
 		execute(PSDEFS);
+		// snapshot the VM state right after the prologue so that it can be
+		// restored later on without re-executing the setup code
+		execute("/@vmsnapshot save def ");
+	}
+}
+
+
+/** Restores the VM state snapshot taken right after the execution of the prologue
+ *  code (PSDEFS). This drops all PostScript definitions made afterwards, e.g. by a
+ *  previously processed document, without destroying the Ghostscript instance and
+ *  without re-executing the setup code. */
+void PSInterpreter::resetVMState () {
+	joinAsyncInit(false);
+	if (_initialized && _mode != PS_QUIT) {
+		// reset the operand, dictionary, and graphics state stacks first so that no
+		// objects created after the snapshot survive and invalidate the restore;
+		// :grestoreall denotes the original operator not triggering any actions
+		execute("clear cleardictstack :grestoreall @vmsnapshot restore/@vmsnapshot save def ");
 	}
 }
 
@@ -116,6 +177,8 @@ bool PSInterpreter::execute (const char *str, size_t len, bool flush) {
 	if (_mode == PS_QUIT)
 		return false;
 
+	DVISVGM_PROBE1(gs_exec, len);
+	Timing::Scope timer("ghostscript");
 	int status=0;
 	if (_mode == PS_NONE) {
 		_gs.run_string_begin(0, &status);
@@ -178,6 +241,16 @@ bool PSInterpreter::executeRaw (const string &str, int n) {
 }
 
 
+/** This callback function is invoked periodically by Ghostscript during longer
+ *  operations. Returning a non-zero value interrupts the interpreter, which is
+ *  used to abort PostScript code that exceeds the deadline of the current page.
+ *  @param[in] inst pointer to calling instance of PSInterpreter
+ *  @return non-zero if the execution should be interrupted */
+int GSDLLCALL PSInterpreter::poll (void *inst) {
+	return PageTimeout::expired() ? -1 : 0;
+}
+
+
 /** This callback function handles input from stdin to Ghostscript. Currently not needed.
  *  @param[in] inst pointer to calling instance of PSInterpreter
  *  @param[in] buf takes the read characters
@@ -241,6 +314,8 @@ int GSDLLCALL PSInterpreter::output (void *inst, const char *buf, int len) {
 					size_t currsize = linebuf.size();
 					linebuf.resize(currsize+linelength);
 					memcpy(&linebuf[currsize], first, linelength);
+					if (MemoryStats::ENABLED)
+						MemoryStats::set(MemoryStats::Unit::PS, linebuf.capacity());
 				}
 			}
 		}
@@ -316,28 +391,27 @@ void PSInterpreter::callActions (InputReader &in) {
 				}
 			}
 			else {
-				// collect parameters
-				vector<string> params;
+				// collect parameters; the values are parsed directly from the input
+				// buffer to avoid creating an intermediate string for every coordinate
+				vector<double> v;
 				int pcount = it->second.pcount;
+				double val=0;
 				if (pcount < 0) {       // variable number of parameters?
-					in.skipSpace();
-					while (!in.eof()) {  // read all available parameters
-						params.push_back(in.getString());
-						in.skipSpace();
-					}
+					while (!in.eof() && in.parseDouble(val))  // read all available parameters
+						v.push_back(val);
 				}
 				else {   // fix number of parameters
+					v.reserve(pcount);
 					for (int i=0; i < pcount; i++) {
-						in.skipSpace();
-						params.push_back(in.getString());
+						val = 0;
+						in.parseDouble(val);
+						v.push_back(val);
 					}
 				}
-				// convert parameter strings to doubles
-				vector<double> v(params.size());
-				transform(params.begin(), params.end(), v.begin(), [](const string &str) {
-					return stod(str);
-				});
-				// call operator handler
+				// call operator handler; attribute the time spent in it to a stage named
+				// after the operator so that the timing report shows the frequency and
+				// cost distribution of the single callbacks
+				Timing::Scope timer(Timing::ENABLED ? "ps:"+it->first : string());
 				(_actions->*it->second.handler)(v);
 				_actions->executed();
 			}
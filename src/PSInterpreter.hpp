@@ -22,6 +22,7 @@
 #define PSINTERPRETER_HPP
 
 #include <cstring>
+#include <future>
 #include <istream>
 #include <string>
 #include <vector>
@@ -106,6 +107,8 @@ class PSInterpreter {
 		bool execute (const std::string &str, bool flush=true) {return execute(str.c_str(), flush);}
 		bool execute (std::istream &is, bool flush=true);
 		bool executeRaw (const std::string &str, int n);
+		void initAsync ();
+		void resetVMState ();
 		bool active () const                   {return _mode != PS_QUIT;}
 		void limit (size_t max_bytes)          {_bytesToRead = max_bytes;}
 		PSActions* setActions (PSActions *actions);
@@ -121,10 +124,13 @@ class PSInterpreter {
 
 	protected:
 		void init ();
+		void initVM ();
+		void joinAsyncInit (bool rethrow);
 		// callback functions
 		static int GSDLLCALL input (void *inst, char *buf, int len);
 		static int GSDLLCALL output (void *inst, const char *buf, int len);
 		static int GSDLLCALL error (void *inst, const char *buf, int len);
+		static int GSDLLCALL poll (void *inst);
 
 		void checkStatus (int status);
 		void callActions (InputReader &cib);
@@ -138,6 +144,7 @@ class PSInterpreter {
 		std::string _errorMessage;         ///< text of error message
 		bool _inError=false;               ///< true if scanning error message
 		bool _initialized=false;           ///< true if PSInterpreter has been completely initialized
+		std::future<void> _initFuture;     ///< pending background initialization started by initAsync()
 		std::vector<std::string> _rawData; ///< raw data received
 		static const char *PSDEFS;         ///< initial PostScript definitions
 };
@@ -81,8 +81,9 @@ unique_ptr<XMLElement> PSTilingPattern::createPatternNode () const {
 	}
 	if (auto clip = createClipNode())
 		pattern->append(std::move(clip));
-	pattern->append(std::move(_groupNode));
-	_groupNode.reset();
+	// append a copy of the group node and keep the original, so the pattern can be
+	// re-emitted on subsequent pages without regenerating its cell geometry
+	pattern->append(util::static_unique_ptr_cast<XMLElement>(_groupNode->clone()));
 	return pattern;
 }
 
@@ -112,9 +113,14 @@ unique_ptr<XMLElement> PSTilingPattern::createGroupNode () const {
 }
 
 
+/** Appends the definition of this pattern to the defs section of the current page.
+ *  Since each page requires its own defs, the pattern element is emitted once per
+ *  page it's used on; repeated applications on the same page are no-ops. */
 void PSTilingPattern::apply (SpecialActions &actions) {
-	PSPattern::apply(actions);
-	_groupNode.reset();
+	if (int(actions.getCurrentPageNumber()) != _appliedPage) {
+		PSPattern::apply(actions);
+		_appliedPage = int(actions.getCurrentPageNumber());
+	}
 }
 
 
@@ -129,7 +135,7 @@ PSColoredTilingPattern::PSColoredTilingPattern (int id, BoundingBox &bbox, Matri
 /////////////////////////////////////////////////////////////////////////////
 
 PSUncoloredTilingPattern::PSUncoloredTilingPattern (int id, BoundingBox &bbox, Matrix &matrix, double xstep, double ystep)
-	: PSTilingPattern(id, bbox, matrix, xstep, ystep), _applied()
+	: PSTilingPattern(id, bbox, matrix, xstep, ystep)
 {
 }
 
@@ -143,12 +149,16 @@ string PSUncoloredTilingPattern::svgID () const {
 
 
 /** Appends the definition of this pattern with the current color applied
- *  to the "def" section of the SVG tree. */
+ *  to the "def" section of the SVG tree. Each color variant is emitted once
+ *  per page it's used on. */
 void PSUncoloredTilingPattern::apply (SpecialActions &actions) {
+	if (int(actions.getCurrentPageNumber()) != _appliedPage) {
+		// the defs are page-local => re-emit the color variants used on the new page
+		_colors.clear();
+		_appliedPage = int(actions.getCurrentPageNumber());
+	}
 	auto it=_colors.find(_currentColor);
 	if (it == _colors.end()) {
-		if (_applied)
-			setGroupNode(util::static_unique_ptr_cast<XMLElement>(getGroupNode()->clone()));
 		// assign current color to the pattern graphic
 		vector<XMLElement*> colored_elems;
 		for (const char *attrName : {"fill", "stroke"}) {
@@ -161,7 +171,6 @@ void PSUncoloredTilingPattern::apply (SpecialActions &actions) {
 		}
 		PSPattern::apply(actions);
 		_colors.insert(_currentColor);
-		_applied = true;
 	}
 }
 
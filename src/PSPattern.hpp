@@ -67,11 +67,14 @@ class PSTilingPattern : public PSPattern {
 		virtual XMLElement* getGroupNode () const    {return _groupNodePtr;}
 		virtual void setGroupNode (std::unique_ptr<XMLElement> node);
 
+	protected:
+		int _appliedPage=-1;  ///< number of the page the pattern definition was most recently appended to
+
 	private:
 		BoundingBox _bbox;           ///< bounding box of the tile graphics
 		Matrix _matrix;              ///< tile transformation
 		double _xstep, _ystep;       ///< horizontal and vertical distance between neighboured tiles
-		mutable std::unique_ptr<XMLElement> _groupNode;  ///< group containing the drawing elements
+		std::unique_ptr<XMLElement> _groupNode;  ///< group containing the drawing elements
 		XMLElement *_groupNodePtr; ///< keeps a pointer to the group node even after moving _groupNode to the SVGTree
 };
 
@@ -93,9 +96,8 @@ class PSUncoloredTilingPattern final : public PSTilingPattern {
 		std::unique_ptr<XMLElement> createClipNode () const override;
 
 	private:
-		std::set<Color> _colors;  ///< colors this pattern has already been drawn with
+		std::set<Color> _colors;  ///< colors this pattern has already been drawn with on the current page
 		Color _currentColor;      ///< current color to be applied
-		bool _applied;  ///< has pattern with current group node already been applied to the SVG tree?
 };
 
 #endif
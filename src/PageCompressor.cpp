@@ -0,0 +1,94 @@
+/*************************************************************************
+** PageCompressor.cpp                                                   **
+**                                                                      **
+** This file is part of dvisvgm -- a fast DVI to SVG converter          **
+** Copyright (C) 2005-2024 Martin Gieseking <martin.gieseking@uos.de>   **
+**                                                                      **
+** This program is free software; you can redistribute it and/or        **
+** modify it under the terms of the GNU General Public License as       **
+** published by the Free Software Foundation; either version 3 of       **
+** the License, or (at your option) any later version.                  **
+**                                                                      **
+** This program is distributed in the hope that it will be useful, but  **
+** WITHOUT ANY WARRANTY; without even the implied warranty of           **
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the         **
+** GNU General Public License for more details.                         **
+**                                                                      **
+** You should have received a copy of the GNU General Public License    **
+** along with this program; if not, see <http://www.gnu.org/licenses/>. **
+*************************************************************************/
+
+#include <config.h>
+#include <algorithm>
+#ifdef HAVE_LIBDEFLATE
+#include <libdeflate.h>
+#endif
+#include "PageCompressor.hpp"
+#include "utility.hpp"
+#include "ZLibOutputStream.hpp"
+
+using namespace std;
+
+/** Whole-buffer compressor based on zlib. It produces the same gzip streams
+ *  as ZLibOutputBuffer but processes the data in a single deflate call. */
+class ZLibPageCompressor : public PageCompressor {
+	public:
+		string name () const override {return "zlib";}
+
+		string compress (const string &data, int zipLevel) const override {
+			z_stream zstream;
+			zstream.zalloc = Z_NULL;
+			zstream.zfree = Z_NULL;
+			zstream.opaque = Z_NULL;
+			zipLevel = max(1, min(9, zipLevel));
+			if (deflateInit2(&zstream, zipLevel, Z_DEFLATED, 15+ZLIB_GZIP, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+				throw ZLibException("failed to initialize deflate compression");
+			string zdata(deflateBound(&zstream, uLong(data.size())), '\0');
+			zstream.next_in = const_cast<Bytef*>(reinterpret_cast<const Bytef*>(data.data()));
+			zstream.avail_in = static_cast<uInt>(data.size());
+			zstream.next_out = reinterpret_cast<Bytef*>(&zdata[0]);
+			zstream.avail_out = static_cast<uInt>(zdata.size());
+			int ret = deflate(&zstream, Z_FINISH);
+			deflateEnd(&zstream);
+			if (ret != Z_STREAM_END)
+				throw ZLibException("error during data compression");
+			zdata.resize(zdata.size()-zstream.avail_out);
+			return zdata;
+		}
+};
+
+
+#ifdef HAVE_LIBDEFLATE
+
+/** Whole-buffer compressor based on libdeflate which compresses significantly
+ *  faster than zlib at comparable compression ratios. */
+class LibdeflatePageCompressor : public PageCompressor {
+	public:
+		string name () const override {return "libdeflate";}
+
+		string compress (const string &data, int zipLevel) const override {
+			zipLevel = max(1, min(9, zipLevel));
+			struct libdeflate_compressor *compressor = libdeflate_alloc_compressor(zipLevel);
+			if (!compressor)
+				throw ZLibException("failed to initialize deflate compression");
+			string zdata(libdeflate_gzip_compress_bound(compressor, data.size()), '\0');
+			size_t zsize = libdeflate_gzip_compress(compressor, data.data(), data.size(), &zdata[0], zdata.size());
+			libdeflate_free_compressor(compressor);
+			if (zsize == 0)
+				throw ZLibException("error during data compression");
+			zdata.resize(zsize);
+			return zdata;
+		}
+};
+
+#endif // HAVE_LIBDEFLATE
+
+
+/** Creates a compressor providing the fastest deflate implementation available. */
+unique_ptr<PageCompressor> PageCompressor::create () {
+#ifdef HAVE_LIBDEFLATE
+	return util::make_unique<LibdeflatePageCompressor>();
+#else
+	return util::make_unique<ZLibPageCompressor>();
+#endif
+}
@@ -0,0 +1,41 @@
+/*************************************************************************
+** PageCompressor.hpp                                                   **
+**                                                                      **
+** This file is part of dvisvgm -- a fast DVI to SVG converter          **
+** Copyright (C) 2005-2024 Martin Gieseking <martin.gieseking@uos.de>   **
+**                                                                      **
+** This program is free software; you can redistribute it and/or        **
+** modify it under the terms of the GNU General Public License as       **
+** published by the Free Software Foundation; either version 3 of       **
+** the License, or (at your option) any later version.                  **
+**                                                                      **
+** This program is distributed in the hope that it will be useful, but  **
+** WITHOUT ANY WARRANTY; without even the implied warranty of           **
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the         **
+** GNU General Public License for more details.                         **
+**                                                                      **
+** You should have received a copy of the GNU General Public License    **
+** along with this program; if not, see <http://www.gnu.org/licenses/>. **
+*************************************************************************/
+
+#ifndef PAGECOMPRESSOR_HPP
+#define PAGECOMPRESSOR_HPP
+
+#include <memory>
+#include <string>
+
+/** Common base class of compressors that process a complete data buffer in
+ *  a single step. In contrast to the streaming classes of ZLibOutputStream.hpp,
+ *  the whole-buffer interface also admits deflate implementations that don't
+ *  support incremental input but compress considerably faster than zlib.
+ *  Since the SVG pages are serialized to memory before being written, their
+ *  final size is known and the page data can be handed over at once. */
+class PageCompressor {
+	public:
+		virtual ~PageCompressor () =default;
+		virtual std::string name () const =0;
+		virtual std::string compress (const std::string &data, int zipLevel) const =0;
+		static std::unique_ptr<PageCompressor> create ();
+};
+
+#endif
@@ -0,0 +1,107 @@
+/*************************************************************************
+** PageHashIndex.cpp                                                    **
+**                                                                      **
+** This file is part of dvisvgm -- a fast DVI to SVG converter          **
+** Copyright (C) 2005-2024 Martin Gieseking <martin.gieseking@uos.de>   **
+**                                                                      **
+** This program is free software; you can redistribute it and/or        **
+** modify it under the terms of the GNU General Public License as       **
+** published by the Free Software Foundation; either version 3 of       **
+** the License, or (at your option) any later version.                  **
+**                                                                      **
+** This program is distributed in the hope that it will be useful, but  **
+** WITHOUT ANY WARRANTY; without even the implied warranty of           **
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the         **
+** GNU General Public License for more details.                         **
+**                                                                      **
+** You should have received a copy of the GNU General Public License    **
+** along with this program; if not, see <http://www.gnu.org/licenses/>. **
+*************************************************************************/
+
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include "FileSystem.hpp"
+#include "PageHashIndex.hpp"
+#include "utility.hpp"
+
+using namespace std;
+
+constexpr const char *FORMAT_ID = "dvisvgm-hash-index";
+constexpr int FORMAT_VERSION = 1;
+
+
+/** Reads the index data from the file assigned to this object. Entries based
+ *  on a different hash algorithm are dropped since their hashes can't be
+ *  compared to the currently computed ones.
+ *  @return true if the index file was present and evaluated successfully */
+bool PageHashIndex::read () {
+	ifstream ifs(_path);
+	if (!ifs)
+		return false;
+	string id, algo;
+	int version=0;
+	ifs >> id >> version >> algo;
+	if (id != FORMAT_ID || version != FORMAT_VERSION || algo != _algo)
+		return false;
+	lock_guard<mutex> lock(_mutex);
+	string line;
+	getline(ifs, line);  // skip rest of header line
+	while (getline(ifs, line)) {
+		auto fields = util::split(line, "\t");
+		if (fields.size() == 4) {
+			// skip lines with a malformed page number, e.g. due to manual edits of the index file
+			char *end;
+			unsigned long pageno = strtoul(fields[0].c_str(), &end, 10);
+			if (end != fields[0].c_str() && *end == '\0')
+				_entries[unsigned(pageno)] = Entry{fields[1], fields[2], fields[3]};
+		}
+	}
+	return true;
+}
+
+
+/** Writes the collected index data to the file assigned to this object.
+ *  @return true on success */
+bool PageHashIndex::write () const {
+	lock_guard<mutex> lock(_mutex);
+	ofstream ofs(_path);
+	if (!ofs)
+		return false;
+	ofs << FORMAT_ID << ' ' << FORMAT_VERSION << ' ' << _algo << '\n';
+	for (const auto &entry : _entries)
+		ofs << entry.first << '\t' << entry.second.dviHash << '\t' << entry.second.optHash << '\t' << entry.second.fname << '\n';
+	return bool(ofs);
+}
+
+
+/** Returns true if the recorded hashes of a page match the given ones and
+ *  the previously written SVG file still exists, i.e. the conversion of the
+ *  page can be skipped.
+ *  @param[in] pageno number of page to look up
+ *  @param[in] dviHash current hash of the DVI page data
+ *  @param[in] optHash current hash of the SVG-related command-line options */
+bool PageHashIndex::unchanged (unsigned pageno, const string &dviHash, const string &optHash) const {
+	lock_guard<mutex> lock(_mutex);
+	auto it = _entries.find(pageno);
+	return it != _entries.end()
+		&& it->second.dviHash == dviHash
+		&& it->second.optHash == optHash
+		&& FileSystem::exists(it->second.fname);
+}
+
+
+/** Returns the name of the SVG file recorded for a given page, or an empty
+ *  string if there's no entry for that page. */
+string PageHashIndex::filename (unsigned pageno) const {
+	lock_guard<mutex> lock(_mutex);
+	auto it = _entries.find(pageno);
+	return it != _entries.end() ? it->second.fname : "";
+}
+
+
+/** Adds or replaces the index entry of a given page. */
+void PageHashIndex::update (unsigned pageno, const string &dviHash, const string &optHash, const string &fname) {
+	lock_guard<mutex> lock(_mutex);
+	_entries[pageno] = Entry{dviHash, optHash, fname};
+}
@@ -0,0 +1,57 @@
+/*************************************************************************
+** PageHashIndex.hpp                                                    **
+**                                                                      **
+** This file is part of dvisvgm -- a fast DVI to SVG converter          **
+** Copyright (C) 2005-2024 Martin Gieseking <martin.gieseking@uos.de>   **
+**                                                                      **
+** This program is free software; you can redistribute it and/or        **
+** modify it under the terms of the GNU General Public License as       **
+** published by the Free Software Foundation; either version 3 of       **
+** the License, or (at your option) any later version.                  **
+**                                                                      **
+** This program is distributed in the hope that it will be useful, but  **
+** WITHOUT ANY WARRANTY; without even the implied warranty of           **
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the         **
+** GNU General Public License for more details.                         **
+**                                                                      **
+** You should have received a copy of the GNU General Public License    **
+** along with this program; if not, see <http://www.gnu.org/licenses/>. **
+*************************************************************************/
+
+#ifndef PAGEHASHINDEX_HPP
+#define PAGEHASHINDEX_HPP
+
+#include <map>
+#include <mutex>
+#include <string>
+
+/** Keeps track of the page and options hashes of previously generated SVG files.
+ *  The collected data is stored in a sidecar file so that consecutive runs of
+ *  dvisvgm can skip the conversion of pages whose DVI contents and SVG-related
+ *  command-line options haven't changed. */
+class PageHashIndex {
+	public:
+		struct Entry {
+			std::string dviHash;  ///< hash of the DVI page data
+			std::string optHash;  ///< hash of the SVG-related command-line options
+			std::string fname;    ///< name of the generated SVG file
+		};
+
+	public:
+		PageHashIndex (std::string path, std::string algo)
+			: _path(std::move(path)), _algo(std::move(algo)) {}
+		bool read ();
+		bool write () const;
+		bool unchanged (unsigned pageno, const std::string &dviHash, const std::string &optHash) const;
+		std::string filename (unsigned pageno) const;
+		void update (unsigned pageno, const std::string &dviHash, const std::string &optHash, const std::string &fname);
+		const std::string& path () const {return _path;}
+
+	private:
+		std::string _path;  ///< path of the index file
+		std::string _algo;  ///< name of the hash algorithm the stored hashes are based on
+		std::map<unsigned, Entry> _entries;
+		mutable std::mutex _mutex;
+};
+
+#endif
@@ -98,11 +98,9 @@ PageRanges PageRanges::filter (FilterFunc filterFunc) const {
 	if (filterFunc == nullptr)
 		newRanges = *this;
 	else {
-		for (const auto &range : *this) {
-			for (int i=range.first; i <= range.second; i++)
-				if (filterFunc(i))
-					newRanges.addRange(i, i);
-		}
+		for (auto it = valuesBegin(); it != valuesEnd(); ++it)
+			if (filterFunc(*it))
+				newRanges.addRange(*it);
 	}
 	return newRanges;
 }
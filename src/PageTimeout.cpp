@@ -0,0 +1,59 @@
+/*************************************************************************
+** PageTimeout.cpp                                                      **
+**                                                                      **
+** This file is part of dvisvgm -- a fast DVI to SVG converter          **
+** Copyright (C) 2005-2024 Martin Gieseking <martin.gieseking@uos.de>   **
+**                                                                      **
+** This program is free software; you can redistribute it and/or        **
+** modify it under the terms of the GNU General Public License as       **
+** published by the Free Software Foundation; either version 3 of       **
+** the License, or (at your option) any later version.                  **
+**                                                                      **
+** This program is distributed in the hope that it will be useful, but  **
+** WITHOUT ANY WARRANTY; without even the implied warranty of           **
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the         **
+** GNU General Public License for more details.                         **
+**                                                                      **
+** You should have received a copy of the GNU General Public License    **
+** along with this program; if not, see <http://www.gnu.org/licenses/>. **
+*************************************************************************/
+
+#include <config.h>
+#include "PageTimeout.hpp"
+
+using namespace std;
+
+double PageTimeout::SECONDS = 0;
+bool PageTimeout::_active = false;
+chrono::steady_clock::time_point PageTimeout::_deadline;
+
+
+/** Starts the deadline for the page about to be processed. Without a
+ *  configured page timeout, the function has no effect. */
+void PageTimeout::start () {
+	if (SECONDS > 0) {
+		_deadline = chrono::steady_clock::now() + chrono::microseconds(int64_t(SECONDS*1e6));
+		_active = true;
+	}
+}
+
+
+/** Stops the deadline after the page has been processed. */
+void PageTimeout::stop () {
+	_active = false;
+}
+
+
+/** Returns true if a deadline is active and the current page has exceeded it. */
+bool PageTimeout::expired () {
+	return _active && chrono::steady_clock::now() > _deadline;
+}
+
+
+/** Throws a TimeoutException if the current page has exceeded its deadline. */
+void PageTimeout::check () {
+	if (expired()) {
+		_active = false;  // report the expiration only once per page
+		throw TimeoutException("page conversion time exceeded "+to_string(SECONDS)+" seconds");
+	}
+}
@@ -0,0 +1,53 @@
+/*************************************************************************
+** PageTimeout.hpp                                                      **
+**                                                                      **
+** This file is part of dvisvgm -- a fast DVI to SVG converter          **
+** Copyright (C) 2005-2024 Martin Gieseking <martin.gieseking@uos.de>   **
+**                                                                      **
+** This program is free software; you can redistribute it and/or        **
+** modify it under the terms of the GNU General Public License as       **
+** published by the Free Software Foundation; either version 3 of       **
+** the License, or (at your option) any later version.                  **
+**                                                                      **
+** This program is distributed in the hope that it will be useful, but  **
+** WITHOUT ANY WARRANTY; without even the implied warranty of           **
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the         **
+** GNU General Public License for more details.                         **
+**                                                                      **
+** You should have received a copy of the GNU General Public License    **
+** along with this program; if not, see <http://www.gnu.org/licenses/>. **
+*************************************************************************/
+
+#ifndef PAGETIMEOUT_HPP
+#define PAGETIMEOUT_HPP
+
+#include <chrono>
+#include "MessageException.hpp"
+
+struct TimeoutException : public MessageException {
+	explicit TimeoutException (const std::string &msg) : MessageException(msg) {}
+};
+
+/** Deadline applied to the conversion of a single page. A runaway page,
+ *  e.g. one whose special contains an infinite PostScript loop, would
+ *  otherwise hang the conversion forever and cost all completed pages of
+ *  the document. The deadline is started before the execution of each page
+ *  and checked from the DVI command loop as well as from the Ghostscript
+ *  poll callback, so both DVI-level and PostScript-level loops are caught.
+ *  On expiration, the offending page is aborted and replaced by a
+ *  placeholder while the conversion continues with the next page. */
+class PageTimeout {
+	public:
+		static void start ();
+		static void stop ();
+		static bool expired ();
+		static void check ();
+
+		static double SECONDS;  ///< maximal conversion time per page (0 = unlimited)
+
+	private:
+		static bool _active;    ///< true while a page governed by the deadline is being processed
+		static std::chrono::steady_clock::time_point _deadline;  ///< point in time the current page expires
+};
+
+#endif
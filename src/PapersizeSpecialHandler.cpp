@@ -65,17 +65,26 @@ void PapersizeSpecialHandler::storePaperSize (unsigned pageno, Length width, Len
 
 /** Applies the previously recorded size to a given page. */
 void PapersizeSpecialHandler::applyPaperSize (unsigned pageno, SpecialActions &actions) {
-	// find page n >= pageno that contains a papersize special
-	auto lb_it = lower_bound(_pageSizes.begin(), _pageSizes.end(), PageSize(pageno, DoublePair()),
-		[](const PageSize &ps1, const PageSize &ps2) {
-			// order PageSize objects by page number
-			return ps1.first < ps2.first;
-		});
 	auto it = _pageSizes.end();
-	if (lb_it != _pageSizes.end() && lb_it->first == pageno)
-		it = lb_it;                        // if current page contains a papersize special, use it
-	else if (lb_it != _pageSizes.begin()) // no papersize special on current page?
-		it = lb_it-1;                      // => use the one on the nearest preceding page
+	if (_pageSizes.size() == 1) {
+		// Since storePaperSize() drops repetitions of the same size, documents using
+		// a single global papersize are represented by just one entry. Skip the search
+		// for page-specific entries in this common case.
+		if (_pageSizes.front().first <= pageno)
+			it = _pageSizes.begin();
+	}
+	else {
+		// find page n >= pageno that contains a papersize special
+		auto lb_it = lower_bound(_pageSizes.begin(), _pageSizes.end(), PageSize(pageno, DoublePair()),
+			[](const PageSize &ps1, const PageSize &ps2) {
+				// order PageSize objects by page number
+				return ps1.first < ps2.first;
+			});
+		if (lb_it != _pageSizes.end() && lb_it->first == pageno)
+			it = lb_it;                        // if current page contains a papersize special, use it
+		else if (lb_it != _pageSizes.begin()) // no papersize special on current page?
+			it = lb_it-1;                      // => use the one on the nearest preceding page
+	}
 	if (it == _pageSizes.end())
 		Message::wstream(true) << "no valid papersize special found\n";
 	else {
@@ -31,6 +31,7 @@ class PapersizeSpecialHandler : public SpecialHandler {
 	using PageSize = std::pair<unsigned,DoublePair>;   // page number -> (width, height)
 
 	public:
+		bool requiresPreprocessing () const override {return true;}
 		void preprocess (const std::string &prefix, std::istream &is, SpecialActions &actions) override;
 		bool process (const std::string &prefix, std::istream &is, SpecialActions &actions) override;
 		const char* info () const override {return "special to set the page size";}
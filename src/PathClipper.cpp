@@ -18,8 +18,14 @@
 ** along with this program; if not, see <http://www.gnu.org/licenses/>. **
 *************************************************************************/
 
+#include <algorithm>
 #include <cmath>
+#include <future>
+#include <numeric>
+#include <thread>
+#include <unordered_map>
 #include "Bezier.hpp"
+#include "MemoryStats.hpp"
 #include "PathClipper.hpp"
 
 using namespace std;
@@ -31,6 +37,11 @@ using CurvedPath = PathClipper::CurvedPath;
 
 const int SCALE_FACTOR = 1000;
 
+/** Minimum total number of subject vertices required to intersect the polygon
+ *  groups in parallel. Smaller paths are processed sequentially since the cost
+ *  of the additional threads would outweigh the benefit. */
+const size_t MIN_SIZE_FOR_THREADING = 20000;
+
 inline cInt to_cInt (double x) {
 	return static_cast<cInt>(lround(x*SCALE_FACTOR));
 }
@@ -310,6 +321,141 @@ inline PolyFillType polyFillType (CurvedPath::WindingRule wr) {
 }
 
 
+/** Bounding box of a single polygon in clipper coordinates. */
+struct PolygonBBox {
+	cInt minx=0, miny=0, maxx=0, maxy=0;
+};
+
+
+static PolygonBBox bounding_box (const Polygon &polygon) {
+	PolygonBBox bbox;
+	if (!polygon.empty()) {
+		bbox.minx = bbox.maxx = polygon[0].X;
+		bbox.miny = bbox.maxy = polygon[0].Y;
+		for (const IntPoint &p : polygon) {
+			bbox.minx = min(bbox.minx, p.X);
+			bbox.miny = min(bbox.miny, p.Y);
+			bbox.maxx = max(bbox.maxx, p.X);
+			bbox.maxy = max(bbox.maxy, p.Y);
+		}
+	}
+	return bbox;
+}
+
+
+/** Partitions the polygons of a flattened path into groups so that the bounding
+ *  boxes of polygons belonging to different groups don't overlap. The partition
+ *  is computed with a union-find structure fed by a plane sweep along the x-axis.
+ *  @param[in] polygons polygons to partition
+ *  @return vector of groups, each holding the indexes of its member polygons */
+static vector<vector<size_t>> disjoint_polygon_groups (const Polygons &polygons) {
+	size_t numPolygons = polygons.size();
+	vector<PolygonBBox> bboxes(numPolygons);
+	for (size_t i=0; i < numPolygons; i++)
+		bboxes[i] = bounding_box(polygons[i]);
+	vector<size_t> parent(numPolygons);
+	iota(parent.begin(), parent.end(), 0);
+	auto find = [&parent](size_t i) {
+		while (parent[i] != i) {
+			parent[i] = parent[parent[i]];  // halve the path for subsequent lookups
+			i = parent[i];
+		}
+		return i;
+	};
+	// sweep over the polygons ordered by the left edge of their bounding box and
+	// unite all pairs whose boxes overlap
+	vector<size_t> order(numPolygons);
+	iota(order.begin(), order.end(), 0);
+	sort(order.begin(), order.end(), [&bboxes](size_t a, size_t b) {return bboxes[a].minx < bboxes[b].minx;});
+	vector<size_t> active;  // polygons whose x-range contains the current sweep position
+	for (size_t index : order) {
+		const PolygonBBox &bbox = bboxes[index];
+		size_t pos=0;
+		for (size_t activeIndex : active) {
+			if (bboxes[activeIndex].maxx >= bbox.minx) {  // x-ranges still overlapping?
+				active[pos++] = activeIndex;
+				if (bbox.miny <= bboxes[activeIndex].maxy && bboxes[activeIndex].miny <= bbox.maxy)
+					parent[find(activeIndex)] = find(index);
+			}
+		}
+		active.resize(pos);
+		active.push_back(index);
+	}
+	// collect the members of each group preserving their original order
+	vector<vector<size_t>> groups;
+	unordered_map<size_t, size_t> groupIndexes;  // maps group root to index into 'groups'
+	for (size_t i=0; i < numPolygons; i++) {
+		size_t root = find(i);
+		auto it = groupIndexes.find(root);
+		if (it == groupIndexes.end()) {
+			it = groupIndexes.emplace(root, groups.size()).first;
+			groups.emplace_back();
+		}
+		groups[it->second].push_back(i);
+	}
+	return groups;
+}
+
+
+/** Tries to intersect a flattened subject path with a clip path in parallel.
+ *  The subject polygons are partitioned into groups with pairwise disjoint bounding
+ *  boxes. Since the polygons of one group can't affect the winding numbers inside
+ *  the regions covered by the other groups, each group can be intersected with the
+ *  clip path independently, and the partial results just need to be concatenated.
+ *  This speeds up the clipping of large paths consisting of many separate contours,
+ *  e.g. those created by plotting tools.
+ *  @param[in] subject flattened subject path
+ *  @param[in] clip flattened clip path
+ *  @param[in] subjectFill fill type of the subject path
+ *  @param[in] clipFill fill type of the clip path
+ *  @param[out] result the reconstructed intersection of the two paths
+ *  @return false if the subject path is too small to benefit from threading or
+ *          consists of a single group only; the caller must then fall back to
+ *          the sequential computation */
+bool PathClipper::intersectParallel (const Polygons &subject, const Polygons &clip, PolyFillType subjectFill, PolyFillType clipFill, CurvedPath &result) {
+	size_t numPoints=0;
+	for (const Polygon &polygon : subject)
+		numPoints += polygon.size();
+	unsigned numThreads = max(1u, thread::hardware_concurrency());
+	if (numPoints < MIN_SIZE_FOR_THREADING || subject.size() < 2 || numThreads < 2)
+		return false;
+	vector<vector<size_t>> groups = disjoint_polygon_groups(subject);
+	if (groups.size() < 2)
+		return false;
+	// distribute the groups round-robin over the available threads
+	size_t numTasks = min(size_t(numThreads), groups.size());
+	vector<Polygons> taskPolygons(numTasks);
+	for (size_t i=0; i < groups.size(); i++)
+		for (size_t index : groups[i])
+			taskPolygons[i%numTasks].push_back(subject[index]);
+	auto intersectTask = [&clip, subjectFill, clipFill](const Polygons &polygons) {
+		Clipper clipper;
+		clipper.AddPaths(polygons, ptSubject, true);
+		clipper.AddPaths(clip, ptClip, true);
+		clipper.ZFillFunction(callback);
+		Polygons flattenedPath;
+		clipper.Execute(ctIntersection, flattenedPath, subjectFill, clipFill);
+		return flattenedPath;
+	};
+	vector<future<Polygons>> futures;
+	for (size_t i=1; i < numTasks; i++)
+		futures.emplace_back(async(launch::async, intersectTask, cref(taskPolygons[i])));
+	reconstruct(intersectTask(taskPolygons[0]), result);
+	for (auto &fut : futures)
+		reconstruct(fut.get(), result);
+	return true;
+}
+
+
+/** Returns the number of bytes allocated to store a set of flattened polygons. */
+static size_t mem_size (const ClipperLib::Paths &polygons) {
+	size_t bytes = polygons.capacity()*sizeof(ClipperLib::Path);
+	for (const auto &polygon : polygons)
+		bytes += polygon.capacity()*sizeof(IntPoint);
+	return bytes;
+}
+
+
 /** Combines two curved paths by applying a boolean operation on them.
  *  @param[in] op operation to perform
  *  @param[in] p1 first curved path
@@ -318,17 +464,24 @@ inline PolyFillType polyFillType (CurvedPath::WindingRule wr) {
 CurvedPath PathClipper::combine (ClipType op, const CurvedPath &p1, const CurvedPath &p2) {
 	CurvedPath result;
 	if (p1.size() > 1 && p2.size() > 1) {
-		Clipper clipper;
-		Polygons polygons;
-		flatten(p1, polygons);
-		clipper.AddPaths(polygons, ptSubject, true);
-		polygons.clear();
-		flatten(p2, polygons);
-		clipper.AddPaths(polygons, ptClip, true);
-		clipper.ZFillFunction(callback);
-		Polygons flattenedPath;
-		clipper.Execute(op, flattenedPath, polyFillType(p1.windingRule()), polyFillType(p2.windingRule()));
-		reconstruct(flattenedPath, result);
+		Polygons subject, clip;
+		flatten(p1, subject);
+		flatten(p2, clip);
+		if (MemoryStats::ENABLED)
+			MemoryStats::set(MemoryStats::Unit::CLIPPER, mem_size(subject)+mem_size(clip));
+		PolyFillType subjectFill = polyFillType(p1.windingRule());
+		PolyFillType clipFill = polyFillType(p2.windingRule());
+		if (op != ctIntersection || !intersectParallel(subject, clip, subjectFill, clipFill, result)) {
+			Clipper clipper;
+			clipper.AddPaths(subject, ptSubject, true);
+			clipper.AddPaths(clip, ptClip, true);
+			clipper.ZFillFunction(callback);
+			Polygons flattenedPath;
+			clipper.Execute(op, flattenedPath, subjectFill, clipFill);
+			if (MemoryStats::ENABLED)
+				MemoryStats::set(MemoryStats::Unit::CLIPPER, mem_size(subject)+mem_size(clip)+mem_size(flattenedPath));
+			reconstruct(flattenedPath, result);
+		}
 	}
 	return result;
 }
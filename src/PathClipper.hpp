@@ -41,6 +41,7 @@ class PathClipper {
 
 	protected:
 		CurvedPath combine (ClipperLib::ClipType op, const CurvedPath &p1, const CurvedPath &p2);
+		bool intersectParallel (const ClipperLib::Paths &subject, const ClipperLib::Paths &clip, ClipperLib::PolyFillType subjectFill, ClipperLib::PolyFillType clipFill, CurvedPath &result);
 		void flatten (const CurvedPath &gp, ClipperLib::Paths &polygons);
 		void reconstruct (const ClipperLib::Path &polygon, CurvedPath &path);
 		void reconstruct (const ClipperLib::Paths &polygons, CurvedPath &path);
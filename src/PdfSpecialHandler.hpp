@@ -27,6 +27,7 @@ class StreamInputReader;
 
 class PdfSpecialHandler : public SpecialHandler {
 	public:
+		bool requiresPreprocessing () const override {return true;}
 		void preprocess (const std::string &prefix, std::istream &is, SpecialActions &actions) override;
 		bool process (const std::string &prefix, std::istream &is, SpecialActions &actions) override;
 		const char* info () const override {return "PDF hyperlink, font map, and pagesize specials";}
@@ -24,11 +24,13 @@
 	#include <csignal>
 	#include <cstring>
 	#include <fcntl.h>
+	#include <spawn.h>
 	#include <sys/wait.h>
 	#include <unistd.h>
 #endif
 
 #include <cstdlib>
+#include <future>
 #include <regex>
 #include "FileSystem.hpp"
 #include "Process.hpp"
@@ -44,7 +46,7 @@ class Subprocess {
 		enum class State {RUNNING, FINISHED, FAILED};
 
 	public:
-		Subprocess () : _rdbuf(4096) {}
+		Subprocess () : _rdbuf(65536) {}  // large capture buffer to keep the number of pipe reads low
 		Subprocess (const Subprocess&) =delete;
 		Subprocess (Subprocess&&) =delete;
 		~Subprocess ();
@@ -131,6 +133,35 @@ bool Process::run (string *out, const SearchPattern &pattern, PipeFlags flags) {
 }
 
 
+/** Runs several processes concurrently and waits until all of them have finished.
+ *  The completion callback is invoked in the context of the calling thread for
+ *  each process in the order given by the vector, i.e. the callbacks don't have
+ *  to be synchronized against each other.
+ *  @param[in] processes the processes to run
+ *  @param[in] callback invoked for each completed process together with its exit state and output
+ *  @param[in] flags defines which output streams of the subprocesses are captured
+ *  @return true if all processes terminated properly */
+bool Process::runConcurrently (const vector<Process*> &processes, const CompletionCallback &callback, PipeFlags flags) {
+	vector<future<pair<bool,string>>> futures;
+	futures.reserve(processes.size());
+	for (Process *proc : processes) {
+		futures.push_back(async(launch::async, [proc, flags] {
+			string out;
+			bool ok = proc->run(&out, flags);
+			return make_pair(ok, std::move(out));
+		}));
+	}
+	bool ok = true;
+	for (size_t i=0; i < futures.size(); i++) {
+		pair<bool,string> result = futures[i].get();
+		ok &= result.first;
+		if (callback)
+			callback(*processes[i], result.first, result.second);
+	}
+	return ok;
+}
+
+
 /** Runs the process in the given working directory and waits until it's finished.
  *  @param[in] dir working directory
  *  @param[out] out takes the output written to stdout by the executed process
@@ -268,6 +299,8 @@ Subprocess::State Subprocess::state () {
 
 #else  // !_WIN32
 
+extern char **environ;
+
 Subprocess::~Subprocess () {
 	if (_readfd >= 0)
 		close(_readfd);
@@ -343,32 +376,51 @@ bool Subprocess::run (const string &cmd, string paramstr, Process::PipeFlags fla
 	if (cmd.empty() || pipe(pipefd) < 0)
 		return false;
 
-	_pid = fork();
-	if (_pid < 0) {
+	vector<const char*> params;
+	params.push_back(cmd.c_str());
+	split_paramstr(paramstr, params);
+	params.push_back(nullptr);  // trailing null pointer marks end of parameter list
+	if (params[0][0] == '/')    // absolute path to executable?
+		params[0] = strrchr(params[0], '/')+1;  // filename of executable
+
+	// Create the child process with posix_spawn instead of fork/exec. This avoids
+	// duplicating the address space of the calling process, which is expensive if
+	// the converter already occupies a lot of memory when a helper program is run.
+	posix_spawn_file_actions_t actions;
+	posix_spawn_file_actions_init(&actions);
+	if (flags & Process::PF_STDOUT)
+		posix_spawn_file_actions_adddup2(&actions, pipefd[1], STDOUT_FILENO);
+	else
+		posix_spawn_file_actions_addopen(&actions, STDOUT_FILENO, "/dev/null", O_WRONLY, 0);
+	if (flags & Process::PF_STDERR)
+		posix_spawn_file_actions_adddup2(&actions, pipefd[1], STDERR_FILENO);
+	else
+		posix_spawn_file_actions_addopen(&actions, STDERR_FILENO, "/dev/null", O_WRONLY, 0);
+	posix_spawn_file_actions_addclose(&actions, pipefd[0]);
+	posix_spawn_file_actions_addclose(&actions, pipefd[1]);
+
+	posix_spawnattr_t attr;
+	posix_spawnattr_init(&attr);
+	short spawnflags = POSIX_SPAWN_SETSIGMASK;
+#ifdef POSIX_SPAWN_USEVFORK
+	spawnflags |= POSIX_SPAWN_USEVFORK;  // don't copy the page tables of the parent
+#endif
+	sigset_t sigmask;
+	sigemptyset(&sigmask);
+	sigaddset(&sigmask, SIGINT);  // child process is supposed to ignore ctrl-c events
+	posix_spawnattr_setsigmask(&attr, &sigmask);
+	posix_spawnattr_setflags(&attr, spawnflags);
+
+	int result = posix_spawnp(&_pid, cmd.c_str(), &actions, &attr, const_cast<char* const*>(params.data()), environ);
+	posix_spawnattr_destroy(&attr);
+	posix_spawn_file_actions_destroy(&actions);
+	close(pipefd[1]);  // close write end of pipe
+	if (result != 0) {
+		_pid = -1;
 		close(pipefd[0]);
-		close(pipefd[1]);
 		return false;
 	}
-	if (_pid == 0) {   // child process
-		int devnull = open("/dev/null", O_WRONLY);
-		dup2((flags & Process::PF_STDOUT) ? pipefd[1] : devnull, STDOUT_FILENO);  // redirect stdout to the pipe
-		dup2((flags & Process::PF_STDERR) ? pipefd[1] : devnull, STDERR_FILENO);  // redirect stdout to the pipe
-		close(pipefd[0]);
-		close(pipefd[1]);
-		close(devnull);
-
-		vector<const char*> params;
-		params.push_back(cmd.c_str());
-		split_paramstr(paramstr, params);
-		params.push_back(nullptr);  // trailing null pointer marks end of parameter list
-		signal(SIGINT, SIG_IGN);    // child process is supposed to ignore ctrl-c events
-		if (params[0][0] == '/')    // absolute path to executable?
-			params[0] = strrchr(params[0], '/')+1;  // filename of executable
-		execvp(cmd.c_str(), const_cast<char* const*>(params.data()));
-		exit(1);
-	}
 	_readfd = pipefd[0];
-	close(pipefd[1]);  // close write end of pipe
 	return true;
 }
 
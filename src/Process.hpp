@@ -21,7 +21,9 @@
 #ifndef PROCESS_HPP
 #define PROCESS_HPP
 
+#include <functional>
 #include <string>
+#include <vector>
 
 struct SearchPattern {
 	SearchPattern () =default;
@@ -41,12 +43,16 @@ class Process {
 	public:
 		enum PipeFlags {PF_STDOUT=1, PF_STDERR=2};
 
+		/** Called for each process completed by runConcurrently. */
+		using CompletionCallback = std::function<void (Process &proc, bool success, const std::string &out)>;
+
 		Process (std::string cmd, std::string paramstr);
 		Process (const Process &orig) =delete;
 		Process (Process &&orig) =delete;
 		bool run (std::string *out=nullptr, PipeFlags flags=PF_STDOUT);
 		bool run (const std::string &dir, std::string *out=nullptr, PipeFlags flags=PF_STDOUT);
 		bool run (std::string *out, const SearchPattern &pattern, PipeFlags flags=PF_STDOUT);
+		static bool runConcurrently (const std::vector<Process*> &processes, const CompletionCallback &callback=CompletionCallback(), PipeFlags flags=PF_STDOUT);
 
 	private:
 		std::string _cmd;
@@ -22,32 +22,50 @@
 #include <cmath>
 #include <memory>
 #include <sstream>
+#include "DVIToSVG.hpp"
 #include "FileFinder.hpp"
 #include "FilePath.hpp"
 #include "FileSystem.hpp"
 #include "Message.hpp"
 #include "PathClipper.hpp"
+#include "PNGImage.hpp"
 #include "PSPattern.hpp"
 #include "PSPreviewHandler.hpp"
 #include "PsSpecialHandler.hpp"
+#include "RunStats.hpp"
 #include "SpecialActions.hpp"
 #include "SVGElement.hpp"
 #include "TensorProductPatch.hpp"
 #include "TriangularPatch.hpp"
 #include "utility.hpp"
+#include "XXHashFunction.hpp"
 
 using namespace std;
 
 
 bool PsSpecialHandler::COMPUTE_CLIPPATHS_INTERSECTIONS = false;
+int PsSpecialHandler::SHADING_MAX_SEGMENTS = 0;
+bool PsSpecialHandler::SHADING_MESH_GRADIENTS = false;
 bool PsSpecialHandler::SHADING_SEGMENT_OVERLAP = false;
 int PsSpecialHandler::SHADING_SEGMENT_SIZE = 20;
 double PsSpecialHandler::SHADING_SIMPLIFY_DELTA = 0.01;
 string PsSpecialHandler::BITMAP_FORMAT;
 
 
-PsSpecialHandler::PsSpecialHandler () : _psi(this), _previewHandler(_psi)
+/** Returns the process-wide PostScript interpreter. The Ghostscript session is kept
+ *  alive across documents: instead of spawning a new instance and re-executing the
+ *  prologue code for each conversion, the VM state is reset to the post-prologue
+ *  snapshot whenever a new handler attaches to the session. */
+PSInterpreter& PsSpecialHandler::sharedInterpreter () {
+	static PSInterpreter psi;
+	return psi;
+}
+
+
+PsSpecialHandler::PsSpecialHandler () : _psi(sharedInterpreter()), _previewHandler(_psi)
 {
+	_psi.resetVMState();  // drop definitions left behind by a previously processed document
+	_psi.setActions(this);
 	_psi.setImageDevice(BITMAP_FORMAT);
 }
 
@@ -129,21 +147,26 @@ void PsSpecialHandler::enterBodySection () {
 }
 
 
-/** Move PS graphic position to current DVI location. */
+/** Move PS graphic position to current DVI location. The moveto doesn't produce
+ *  any callback output, so the snippet is not flushed here; it's processed together
+ *  with the special code that follows. */
 void PsSpecialHandler::moveToDVIPos () {
 	if (_actions) {
 		const double x = _actions->getX();
 		const double y = _actions->getY();
 		ostringstream oss;
 		oss << '\n' << x << ' ' << y << " moveto ";
-		_psi.execute(oss.str());
+		_psi.execute(oss.str(), false);
 		_currentpoint = DPair(x, y);
 	}
 }
 
 
 /** Executes a PS snippet and optionally synchronizes the DVI cursor position
- *  with the current PS point.
+ *  with the current PS point. The snippet itself is fed to the interpreter
+ *  without an intermediate flush so that each special requires only a single
+ *  synchronization point: either the final position query issued here or a
+ *  flushed postamble sent by the caller.
  *  @param[in] is  stream to read the PS code from
  *  @param[in] updatePos if true, move the DVI drawing position to the current PS point */
 void PsSpecialHandler::executeAndSync (istream &is, bool updatePos) {
@@ -155,7 +178,7 @@ void PsSpecialHandler::executeAndSync (istream &is, bool updatePos) {
 		oss << '\n' << r << ' ' << g << ' ' << b << " setrgbcolor ";
 		_psi.execute(oss.str(), false);
 	}
-	_psi.execute(is);
+	_psi.execute(is, false);
 	if (updatePos) {
 		// retrieve current PS position (stored in _currentpoint)
 		_psi.execute("\nquerypos ");
@@ -206,9 +229,11 @@ bool PsSpecialHandler::process (const string &prefix, istream &is, SpecialAction
 		enterBodySection();
 
 	if (prefix == "\"" || prefix == "pst:") {
-		// read and execute literal PostScript code (isolated by a wrapping save/restore pair)
+		// read and execute literal PostScript code (isolated by a wrapping save/restore pair);
+		// the preamble and the special code are batched with the flushed postamble so that
+		// the interpreter output is only synchronized once per special
 		moveToDVIPos();
-		_psi.execute("\n@beginspecial @setspecial ");
+		_psi.execute("\n@beginspecial @setspecial ", false);
 		executeAndSync(is, false);
 		_psi.execute("\n@endspecial ");
 	}
@@ -253,7 +278,7 @@ bool PsSpecialHandler::process (const string &prefix, istream &is, SpecialAction
 			else {
 				// no move to DVI position here
 				if (code != "[end]") // PS array?
-					_psi.execute(code);
+					_psi.execute(code, false);
 				executeAndSync(is, true);
 			}
 		}
@@ -368,7 +393,7 @@ void PsSpecialHandler::imgfile (FileType filetype, const string &fname, const ma
 		bbox.transform(imgNode.matrix);
 		_actions->embed(bbox);
 		// insert element containing the image data
-		imgNode.matrix.rmultiply(TranslationMatrix(-llx, -lly));  // move lower left corner of image to origin
+		imgNode.matrix.rtranslate(-llx, -lly);  // move lower left corner of image to origin
 		imgNode.element->setTransform(imgNode.matrix);
 		_actions->svgTree().appendToPage(std::move(imgNode.element));
 	}
@@ -454,8 +479,11 @@ PsSpecialHandler::ImageNode PsSpecialHandler::createPSNode (const string &fname,
 		auto clippath = util::make_unique<SVGElement>("clipPath");
 		clippath->addAttribute("id", "imgclip"+ to_string(_imgClipCount));
 		clippath->append(bbox.createSVGPath());
-		imgnode.element->setClipPathUrl("imgclip" + to_string(_imgClipCount++));
-		_actions->svgTree().appendToDefs(std::move(clippath));
+		XMLElement *clipPtr = clippath.get();
+		XMLElement *stored = _actions->svgTree().appendUniqueToDefs(std::move(clippath));
+		if (stored == clipPtr)  // new clip path appended, i.e. its id is now in use?
+			_imgClipCount++;
+		imgnode.element->setClipPathUrl(stored->getAttributeValue("id"));
 	}
 	_xmlnode = nullptr;   // append following elements to page group again
 	return imgnode;
@@ -491,8 +519,11 @@ PsSpecialHandler::ImageNode PsSpecialHandler::createPDFNode (const string &fname
 				auto clippath = util::make_unique<SVGElement>("clipPath");
 				clippath->addAttribute("id", "imgclip" + to_string(_imgClipCount));
 				clippath->append(bbox.createSVGPath());
-				imgnode.element->setClipPathUrl("imgclip" + to_string(_imgClipCount++));
-				_actions->svgTree().appendToDefs(std::move(clippath));
+				XMLElement *clipPtr = clippath.get();
+				XMLElement *stored = _actions->svgTree().appendUniqueToDefs(std::move(clippath));
+				if (stored == clipPtr)  // new clip path appended, i.e. its id is now in use?
+					_imgClipCount++;
+				imgnode.element->setClipPathUrl(stored->getAttributeValue("id"));
 			}
 		}
 	}
@@ -532,7 +563,10 @@ static bool transform_box_extents (const Matrix &matrix, double &w, double &h, d
 
 void PsSpecialHandler::dviBeginPage (unsigned int pageno, SpecialActions &actions) {
 	_psi.execute("/@imgbase("+image_base_path(actions)+")store\n"); // path and basename of image files
-	_imgClipCount = 0;
+	// restart the image clip path numbering per page unless all pages end up in
+	// the same document, where the IDs must stay unique across pages
+	if (!DVIToSVG::COMBINE_PAGES)
+		_imgClipCount = 0;
 }
 
 
@@ -733,10 +767,8 @@ void PsSpecialHandler::stroke (vector<double> &p) {
 		bbox = _path.computeBBox();
 		bbox.expand(_linewidth/2);
 
-		ostringstream oss;
-		_path.writeSVG(oss, SVGTree::RELATIVE_PATH_CMDS);
 		path = util::make_unique<SVGElement>("path");
-		path->addAttribute("d", oss.str());
+		path->addAttribute("d", _path.svgPathData(SVGTree::RELATIVE_PATH_CMDS));
 		path->setStrokeColor(_actions->getStrokeColor());
 		path->setNoFillColor();
 		path->setStrokeWidth(_linewidth);
@@ -780,10 +812,8 @@ void PsSpecialHandler::fill (vector<double> &p, bool evenodd) {
 	if (_clipStack.prependedPath())
 		_path.prepend(*_clipStack.prependedPath());
 
-	ostringstream oss;
-	_path.writeSVG(oss, SVGTree::RELATIVE_PATH_CMDS);
 	auto path = util::make_unique<SVGElement>("path");
-	path->addAttribute("d", oss.str());
+	path->addAttribute("d", _path.svgPathData(SVGTree::RELATIVE_PATH_CMDS));
 	if (_pattern)
 		path->setFillPatternUrl(XMLString(_pattern->svgID()));
 	else if (_actions->getFillColor() != Color::BLACK || _makingPattern)
@@ -902,6 +932,7 @@ void PsSpecialHandler::makepattern (vector<double> &p) {
 			// pattern definition completed
 			_xmlnode = _savenode;
 			_savenode = nullptr;
+			_droppedPatternNode.reset();  // discard geometry regenerated for an already cached pattern
 			_makingPattern = false;
 			break;
 		case 1: {  // tiling pattern
@@ -914,14 +945,31 @@ void PsSpecialHandler::makepattern (vector<double> &p) {
 			Matrix matrix = create_matrix(p, 9);
 			matrix.lmultiply(_actions->getMatrix());
 
-			unique_ptr<PSTilingPattern> pattern;
-			if (paint_type == 1)
-				pattern = util::make_unique<PSColoredTilingPattern>(id, bbox, matrix, xstep, ystep);
-			else
-				pattern = util::make_unique<PSUncoloredTilingPattern>(id, bbox, matrix, xstep, ystep);
-			_savenode = _xmlnode;
-			_xmlnode = pattern->getContainerNode();  // insert the following SVG elements into this node
-			_patterns[id] = std::move(pattern);
+			// key identifying the pattern definition by its parameters
+			ostringstream oss;
+			for (int i=1; i <= 8; i++)
+				oss << p[i] << ',';
+			oss << matrix.toSVG();
+			auto patternIt = _patterns.find(id);
+			if (patternIt != _patterns.end() && _patternKeys[id] == oss.str()) {
+				// Identical pattern already created, e.g. by the preceding pages of a
+				// document that re-defines its patterns on every page. Keep the cached
+				// cell geometry and drop the elements the repeated definition creates.
+				_droppedPatternNode = util::make_unique<XMLElement>("g");
+				_savenode = _xmlnode;
+				_xmlnode = _droppedPatternNode.get();
+			}
+			else {
+				unique_ptr<PSTilingPattern> pattern;
+				if (paint_type == 1)
+					pattern = util::make_unique<PSColoredTilingPattern>(id, bbox, matrix, xstep, ystep);
+				else
+					pattern = util::make_unique<PSUncoloredTilingPattern>(id, bbox, matrix, xstep, ystep);
+				_savenode = _xmlnode;
+				_xmlnode = pattern->getContainerNode();  // insert the following SVG elements into this node
+				_patterns[id] = std::move(pattern);
+				_patternKeys[id] = oss.str();
+			}
 			_makingPattern = true;
 			break;
 		}
@@ -982,11 +1030,24 @@ void PsSpecialHandler::clip (vector<double>&, bool evenodd) {
  *  computed by intersecting the current one with the given path.
  *  @param[in] path path used to restrict the clipping region
  *  @param[in] evenodd true: use even-odd fill algorithm, false: use nonzero fill algorithm */
+/** Computes a hash value of a pair of clip-path operands derived from their SVG
+ *  representations and winding rules. */
+static uint64_t clip_operands_hash (const GraphicsPath<double> &path1, const GraphicsPath<double> &path2) {
+	string str = path1.svgPathData(false);
+	str += XMLString(int(path1.windingRule()));
+	str += '|';
+	str += path2.svgPathData(false);
+	str += XMLString(int(path2.windingRule()));
+	return XXH64HashFunction(str.data(), str.length()).digestValue();
+}
+
+
 void PsSpecialHandler::clip (Path path, bool evenodd) {
 	// when this method is called, _path contains the clipping path
 	if (path.empty() || !_actions)
 		return;
 
+	RunStats::count(RunStats::Counter::CLIP_PATHS);
 	Path::WindingRule windingRule = evenodd ? Path::WindingRule::EVEN_ODD : Path::WindingRule::NON_ZERO;
 	path.setWindingRule(windingRule);
 
@@ -997,22 +1058,27 @@ void PsSpecialHandler::clip (Path path, bool evenodd) {
 
 	int oldID = _clipStack.topID();
 
-	ostringstream oss;
+	string pathdata;
 	bool pathReplaced;
 	if (!COMPUTE_CLIPPATHS_INTERSECTIONS || oldID < 1) {
 		pathReplaced = _clipStack.replace(path);
-		path.writeSVG(oss, SVGTree::RELATIVE_PATH_CMDS);
+		pathdata = path.svgPathData(SVGTree::RELATIVE_PATH_CMDS);
 	}
 	else {
-		// compute the intersection of the current clipping path with the current graphics path
+		// compute the intersection of the current clipping path with the current graphics
+		// path; identical operand pairs recur on every page of documents that re-apply
+		// the same clips, so the computed results are cached
 		const Path *oldPath = _clipStack.path();
-		Path intersectedPath = PathClipper().intersect(*oldPath, path);
-		pathReplaced = _clipStack.replace(intersectedPath);
-		intersectedPath.writeSVG(oss, SVGTree::RELATIVE_PATH_CMDS);
+		uint64_t hash = clip_operands_hash(*oldPath, path);
+		auto it = _clipIntersections.find(hash);
+		if (it == _clipIntersections.end())
+			it = _clipIntersections.emplace(hash, PathClipper().intersect(*oldPath, path)).first;
+		pathReplaced = _clipStack.replace(it->second);
+		pathdata = it->second.svgPathData(SVGTree::RELATIVE_PATH_CMDS);
 	}
 	if (pathReplaced) {
 		auto pathElem = util::make_unique<SVGElement>("path");
-		pathElem->addAttribute("d", oss.str());
+		pathElem->addAttribute("d", std::move(pathdata));
 		pathElem->setClipRule(evenodd ? SVGElement::FR_EVENODD : SVGElement::FR_NONZERO);
 
 		int newID = _clipStack.topID();
@@ -1151,10 +1217,8 @@ class ShadingCallback : public ShadingPatch::Callback {
 				path.transform(_actions.getMatrix());
 
 			// draw a single patch segment
-			ostringstream oss;
-			path.writeSVG(oss, SVGTree::RELATIVE_PATH_CMDS);
 			auto pathElem = util::make_unique<SVGElement>("path");
-			pathElem->addAttribute("d", oss.str());
+			pathElem->addAttribute("d", path.svgPathData(SVGTree::RELATIVE_PATH_CMDS));
 			pathElem->setFillColor(color);
 			_group->append(std::move(pathElem));
 		}
@@ -1165,34 +1229,207 @@ class ShadingCallback : public ShadingPatch::Callback {
 };
 
 
+/** Creates an SVG mesh gradient from a shading patch and adds a path filled with
+ *  it to the output instead of approximating the patch with many flat-colored
+ *  segments. The mesh gradients introduced with SVG 2 represent the patch control
+ *  points directly, which avoids the costly subdivision and shrinks the generated
+ *  files considerably. However, not all SVG renderers support them yet. */
+void PsSpecialHandler::createMeshGradient (const ShadingPatch &patch) {
+	ShadingPatch::MeshData mesh = patch.getMeshData();
+	string id = "meshgrad"+XMLString(++_meshGradientCount);
+	auto gradient = util::make_unique<XMLElement>("meshgradient");
+	gradient->addAttribute("id", id);
+	gradient->addAttribute("gradientUnits", "userSpaceOnUse");
+	gradient->addAttribute("x", XMLString(mesh.startPoint.x()));
+	gradient->addAttribute("y", XMLString(mesh.startPoint.y()));
+	if (!_actions->getMatrix().isIdentity())
+		gradient->addAttribute("gradientTransform", _actions->getMatrix().toSVG());
+	auto row = util::make_unique<XMLElement>("meshrow");
+	auto meshpatch = util::make_unique<XMLElement>("meshpatch");
+	for (const ShadingPatch::MeshData::Stop &stop : mesh.stops) {
+		auto stopElem = util::make_unique<XMLElement>("stop");
+		stopElem->addAttribute("path", stop.pathData);
+		stopElem->addAttribute("stop-color", stop.color.svgColorString());
+		meshpatch->append(std::move(stopElem));
+	}
+	row->append(std::move(meshpatch));
+	gradient->append(std::move(row));
+	_actions->svgTree().appendToDefs(std::move(gradient));
+
+	// fill the patch area with the gradient
+	GraphicsPath<double> boundary = patch.getBoundaryPath();
+	if (!_actions->getMatrix().isIdentity())
+		boundary.transform(_actions->getMatrix());
+	auto pathElem = util::make_unique<SVGElement>("path");
+	pathElem->addAttribute("d", boundary.svgPathData(SVGTree::RELATIVE_PATH_CMDS));
+	pathElem->setFillPatternUrl(id);
+	if (_clipStack.topID() > 0)
+		pathElem->setClipPathUrl("clip"+XMLString(_clipStack.topID()));
+	if (_xmlnode)
+		_xmlnode->append(std::move(pathElem));
+	else
+		_actions->svgTree().appendToPage(std::move(pathElem));
+}
+
+
+/** Returns true if approximating the given patches is expected to produce more
+ *  path segments than allowed by SHADING_MAX_SEGMENTS. */
+static bool exceeds_segment_limit (const vector<unique_ptr<ShadingPatch>> &patches) {
+	if (PsSpecialHandler::SHADING_MAX_SEGMENTS <= 0 || PsSpecialHandler::SHADING_MESH_GRADIENTS)
+		return false;
+	int segments=0;
+	for (const unique_ptr<ShadingPatch> &patch : patches) {
+		segments += patch->estimatedSegments(PsSpecialHandler::SHADING_SEGMENT_SIZE);
+		if (segments > PsSpecialHandler::SHADING_MAX_SEGMENTS)
+			return true;
+	}
+	return false;
+}
+
+
+/** Fills the quadrilateral given by four corner points with a color.
+ *  Since the rasterization iterates over cells smaller than a pixel, it's
+ *  sufficient to fill the bounding box of the corner points. */
+static void fill_quad (PNGImage &png, const DPair (&corners)[4], const Color &color) {
+	double minx = corners[0].x(), maxx = corners[0].x();
+	double miny = corners[0].y(), maxy = corners[0].y();
+	for (int i=1; i < 4; i++) {
+		minx = min(minx, corners[i].x());
+		maxx = max(maxx, corners[i].x());
+		miny = min(miny, corners[i].y());
+		maxy = max(maxy, corners[i].y());
+	}
+	for (int y=max(0, int(miny)); y <= min(png.height()-1, int(maxy)); y++)
+		for (int x=max(0, int(minx)); x <= min(png.width()-1, int(maxx)); x++)
+			png.setPixel(x, y, color);
+}
+
+
+/** Renders a mesh of shading patches to a bitmap and adds it as a base64-encoded
+ *  image element to the SVG tree. In contrast to the default approximation, whose
+ *  number of path elements grows with the complexity of the mesh, the size of the
+ *  bitmap representation only depends on the area covered by the mesh. Thus, it's
+ *  used as a fallback to keep the output size bounded if a mesh would produce an
+ *  excessive number of segments (option --grad-limit).
+ *  @param[in] patches the shading patches to be rasterized */
+void PsSpecialHandler::rasterizeShadingMesh (const vector<unique_ptr<ShadingPatch>> &patches) {
+	// compute the bounding box of the entire mesh in user-space coordinates
+	Matrix matrix = _actions->getMatrix();
+	BoundingBox bbox;
+	for (const unique_ptr<ShadingPatch> &patch : patches) {
+		BoundingBox patchBox = patch->getBBox();
+		patchBox.transform(matrix);
+		bbox.embed(patchBox);
+	}
+	if (_clipStack.path())
+		bbox.intersect(_clipStack.path()->computeBBox());
+	if (bbox.width() < 0.001 || bbox.height() < 0.001)
+		return;
+	// render at 2 pixels per point (144 dpi) but limit the total image size
+	const int MAX_SIZE = 4096;  // maximum width/height of the bitmap in pixels
+	double scale = min(2.0, MAX_SIZE/max(bbox.width(), bbox.height()));
+	PNGImage png(int(ceil(bbox.width()*scale)), int(ceil(bbox.height()*scale)));
+	// map the patch coordinates to pixel coordinates of the bitmap
+	Matrix pixelMatrix = matrix;
+	pixelMatrix.lmultiply(TranslationMatrix(-bbox.minX(), -bbox.minY()));
+	pixelMatrix.lmultiply(ScalingMatrix(scale, scale));
+	for (const unique_ptr<ShadingPatch> &patch : patches) {
+		BoundingBox patchBox = patch->getBBox();
+		patchBox.transform(pixelMatrix);
+		// choose the sampling density so that adjacent grid points are less
+		// than a pixel apart, i.e. the filled cells overlap each other
+		int gridsize = 2*int(ceil(max(patchBox.width(), patchBox.height())))+2;
+		gridsize = min(gridsize, 2*MAX_SIZE);
+		const bool triangular = (patch->psShadingType() == 4 || patch->psShadingType() == 5);
+		const double inc = 1.0/gridsize;
+		for (int i=0; i < gridsize; i++) {
+			double u1 = i*inc, u2 = (i+1)*inc;
+			for (int j=0; j < gridsize; j++) {
+				double v1 = j*inc, v2 = (j+1)*inc;
+				if (triangular && u1+v1 >= 1)
+					break;  // the domain of triangular patches is limited to u+v <= 1
+				DPair corners[4] = {
+					pixelMatrix*patch->valueAt(u1, v1),
+					pixelMatrix*patch->valueAt(u2, v1),
+					pixelMatrix*patch->valueAt(u2, min(v2, triangular ? 1-u2 : 1.0)),
+					pixelMatrix*patch->valueAt(u1, min(v2, triangular ? 1-u1 : 1.0))
+				};
+				fill_quad(png, corners, patch->colorAt((u1+u2)/2, (v1+v2)/2));
+			}
+		}
+	}
+	string fname = image_base_path(*_actions)+"shading"+to_string(++_shadingImageCount)+".png";
+	ofstream ofs(fname, ios::binary);
+	if (!ofs || !png.write(ofs)) {
+		Message::wstream(true) << "failed to create shading bitmap file " << fname << "\n";
+		return;
+	}
+	ofs.close();
+	auto image = util::make_unique<XMLElement>("image");
+	image->addAttribute("x", XMLString(bbox.minX()));
+	image->addAttribute("y", XMLString(bbox.minY()));
+	image->addAttribute("width", XMLString(bbox.width()));
+	image->addAttribute("height", XMLString(bbox.height()));
+	image->addAttribute("preserveAspectRatio", "none");
+	// To prevent memory issues, only add the filename to the href attribute and tag it by '@'
+	// for later base64 encoding.
+	image->addAttribute("@xlink:href", "data:image/png;base64,"+fname);
+	// if set, assign clipping path to image
+	if (_clipStack.path()) {
+		auto group = util::make_unique<SVGElement>("g");
+		group->setClipPathUrl("clip"+XMLString(_clipStack.topID()));
+		group->append(std::move(image));
+		image = std::move(group);  // handle the entire group as image to add
+	}
+	if (_xmlnode)
+		_xmlnode->append(std::move(image));
+	else {
+		_actions->svgTree().appendToPage(std::move(image));
+		_actions->embed(bbox);
+	}
+}
+
+
 /** Handle all patch meshes whose patches and their connections can be processed sequentially.
  *  This comprises free-form triangular, Coons, and tensor-product patch meshes. */
 void PsSpecialHandler::processSequentialPatchMesh (int shadingTypeID, ColorSpace colorSpace, VectorIterator<double> &it) {
-	unique_ptr<ShadingPatch> previousPatch;
+	vector<unique_ptr<ShadingPatch>> patches;
+	ShadingPatch *previousPatch = nullptr;
 	while (it.valid()) {
 		int edgeflag = static_cast<int>(*it++);
 		vector<DPair> points;
 		vector<Color> colors;
 		unique_ptr<ShadingPatch> patch = ShadingPatch::create(shadingTypeID, colorSpace);
 		read_patch_data(*patch, edgeflag, it, points, colors);
-		patch->setPoints(points, edgeflag, previousPatch.get());
-		patch->setColors(colors, edgeflag, previousPatch.get());
-		ShadingCallback callback(*_actions, _xmlnode, _clipStack.topID());
+		patch->setPoints(points, edgeflag, previousPatch);
+		patch->setColors(colors, edgeflag, previousPatch);
+		previousPatch = patch.get();
+		patches.push_back(std::move(patch));
+	}
+	if (exceeds_segment_limit(patches)) {
+		rasterizeShadingMesh(patches);
+		return;
+	}
+	for (const unique_ptr<ShadingPatch> &patch : patches) {
+		if (SHADING_MESH_GRADIENTS)
+			createMeshGradient(*patch);
+		else {
+			ShadingCallback callback(*_actions, _xmlnode, _clipStack.topID());
 #if 0
-		if (bgcolorGiven) {
-			// fill whole patch area with given background color
-			GraphicsPath<double> outline = patch->getBoundaryPath();
-			callback.patchSegment(outline, bgcolor);
-		}
+			if (bgcolorGiven) {
+				// fill whole patch area with given background color
+				GraphicsPath<double> outline = patch->getBoundaryPath();
+				callback.patchSegment(outline, bgcolor);
+			}
 #endif
-		patch->approximate(SHADING_SEGMENT_SIZE, SHADING_SEGMENT_OVERLAP, SHADING_SIMPLIFY_DELTA, callback);
+			patch->approximate(SHADING_SEGMENT_SIZE, SHADING_SEGMENT_OVERLAP, SHADING_SIMPLIFY_DELTA, callback);
+		}
 		if (!_xmlnode) {
 			// update bounding box
 			BoundingBox bbox = patch->getBBox();
 			bbox.transform(_actions->getMatrix());
 			_actions->embed(bbox);
 		}
-		previousPatch = std::move(patch);
 	}
 }
 
@@ -1219,8 +1456,7 @@ void PsSpecialHandler::processLatticeTriangularPatchMesh (ColorSpace colorSpace,
 		vertex.point.y(*it++);
 		vertex.color.set(colorSpace, it);
 	}
-	LatticeTriangularPatch patch(colorSpace);
-	ShadingCallback callback(*_actions, _xmlnode, _clipStack.topID());
+	vector<unique_ptr<ShadingPatch>> patches;
 	while (it.valid()) {
 		// read next row
 		for (int i=0; i < verticesPerRow; i++) {
@@ -1233,16 +1469,29 @@ void PsSpecialHandler::processLatticeTriangularPatchMesh (ColorSpace colorSpace,
 		for (int i=0; i < verticesPerRow-1; i++) {
 			const PatchVertex &v1 = (*rowptr1)[i], &v2 = (*rowptr1)[i+1];
 			const PatchVertex &v3 = (*rowptr2)[i], &v4 = (*rowptr2)[i+1];
-			patch.setPoints(v1.point, v2.point, v3.point);
-			patch.setColors(v1.color, v2.color, v3.color);
-			patch.approximate(SHADING_SEGMENT_SIZE, SHADING_SEGMENT_OVERLAP, SHADING_SIMPLIFY_DELTA, callback);
-
-			patch.setPoints(v2.point, v3.point, v4.point);
-			patch.setColors(v2.color, v3.color, v4.color);
-			patch.approximate(SHADING_SEGMENT_SIZE, SHADING_SEGMENT_OVERLAP, SHADING_SIMPLIFY_DELTA, callback);
+			auto patch = util::make_unique<LatticeTriangularPatch>(colorSpace);
+			patch->setPoints(v1.point, v2.point, v3.point);
+			patch->setColors(v1.color, v2.color, v3.color);
+			patches.push_back(std::move(patch));
+
+			patch = util::make_unique<LatticeTriangularPatch>(colorSpace);
+			patch->setPoints(v2.point, v3.point, v4.point);
+			patch->setColors(v2.color, v3.color, v4.color);
+			patches.push_back(std::move(patch));
 		}
 		swap(rowptr1, rowptr2);
 	}
+	if (exceeds_segment_limit(patches))
+		rasterizeShadingMesh(patches);
+	else if (SHADING_MESH_GRADIENTS) {
+		for (const unique_ptr<ShadingPatch> &patch : patches)
+			createMeshGradient(*patch);
+	}
+	else {
+		ShadingCallback callback(*_actions, _xmlnode, _clipStack.topID());
+		for (const unique_ptr<ShadingPatch> &patch : patches)
+			patch->approximate(SHADING_SEGMENT_SIZE, SHADING_SEGMENT_OVERLAP, SHADING_SIMPLIFY_DELTA, callback);
+	}
 }
 
 
@@ -1269,8 +1518,7 @@ void PsSpecialHandler::setmatrix (vector<double> &p) {
 void PsSpecialHandler::scale (vector<double> &p) {
 	if (_actions) {
 		Matrix m = _actions->getMatrix();
-		ScalingMatrix s(p[0], p[1]);
-		m.rmultiply(s);
+		m.rscale(p[0], p[1]);
 		_actions->setMatrix(m);
 	}
 }
@@ -1279,8 +1527,7 @@ void PsSpecialHandler::scale (vector<double> &p) {
 void PsSpecialHandler::translate (vector<double> &p) {
 	if (_actions) {
 		Matrix m = _actions->getMatrix();
-		TranslationMatrix t(p[0], p[1]);
-		m.rmultiply(t);
+		m.rtranslate(p[0], p[1]);
 		_actions->setMatrix(m);
 	}
 }
@@ -1289,8 +1536,7 @@ void PsSpecialHandler::translate (vector<double> &p) {
 void PsSpecialHandler::rotate (vector<double> &p) {
 	if (_actions) {
 		Matrix m = _actions->getMatrix();
-		RotationMatrix r(p[0]);
-		m.rmultiply(r);
+		m.rrotate(p[0]);
 		_actions->setMatrix(m);
 	}
 }
@@ -25,6 +25,7 @@
 #include <set>
 #include <stack>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include "GraphicsPath.hpp"
 #include "PDFHandler.hpp"
@@ -35,6 +36,7 @@
 #include "SpecialHandler.hpp"
 
 class PSPattern;
+class ShadingPatch;
 class SVGElement;
 class XMLElement;
 
@@ -91,6 +93,7 @@ class PsSpecialHandler : public SpecialHandler, protected PSActions {
 	public:
 		PsSpecialHandler ();
 		~PsSpecialHandler () override;
+		bool requiresPreprocessing () const override {return true;}
 		void preprocess (const std::string &prefix, std::istream &is, SpecialActions &actions) override;
 		bool process (const std::string &prefix, std::istream &is, SpecialActions &actions) override;
 		const char* info () const override {return "dvips PostScript specials";}
@@ -100,9 +103,12 @@ class PsSpecialHandler : public SpecialHandler, protected PSActions {
 		void setDviScaleFactor (double dvi2bp) override {_previewHandler.setDviScaleFactor(dvi2bp);}
 		void enterBodySection ();
 		PSInterpreter& psInterpreter () {return _psi;}
+		static PSInterpreter& sharedInterpreter ();
 
 	public:
 		static bool COMPUTE_CLIPPATHS_INTERSECTIONS;
+		static int SHADING_MAX_SEGMENTS;
+		static bool SHADING_MESH_GRADIENTS;
 		static bool SHADING_SEGMENT_OVERLAP;
 		static int SHADING_SEGMENT_SIZE;
 		static double SHADING_SIMPLIFY_DELTA;
@@ -124,6 +130,8 @@ class PsSpecialHandler : public SpecialHandler, protected PSActions {
 		void clip (Path path, bool evenodd);
 		void processSequentialPatchMesh (int shadingTypeID, ColorSpace cspace, VectorIterator<double> &it);
 		void processLatticeTriangularPatchMesh (ColorSpace colorSpace, VectorIterator<double> &it);
+		void createMeshGradient (const ShadingPatch &patch);
+		void rasterizeShadingMesh (const std::vector<std::unique_ptr<ShadingPatch>> &patches);
 
 		/// scale given value by current PS scale factors
 		double scale (double v) const {return v*(_sx*(1-_cos*_cos) + _sy*_cos*_cos);}
@@ -176,7 +184,7 @@ class PsSpecialHandler : public SpecialHandler, protected PSActions {
 		void executed () override;
 
 	private:
-		PSInterpreter _psi;
+		PSInterpreter &_psi;  ///< reference to the persistent interpreter session
 		PDFHandler _pdfHandler;
 		SpecialActions *_actions=nullptr;
 		PSPreviewHandler _previewHandler;  ///< extracts information generated by the preview package
@@ -198,9 +206,18 @@ class PsSpecialHandler : public SpecialHandler, protected PSActions {
 		double _dashoffset;                ///< current dash offset
 		std::vector<double> _dashpattern;
 		ClippingStack _clipStack;
+		/** Caches the results of the clip-path intersections computed by the Clipper
+		 *  library, keyed by a combined hash of the two operand paths. Documents that
+		 *  re-apply identical clips on every page (e.g. beamer templates) thus compute
+		 *  each intersection only once per session. */
+		std::unordered_map<uint64_t, Path> _clipIntersections;
 		int _imgClipCount=0;               ///< current number of clip paths assigned to images
+		int _meshGradientCount=0;          ///< number of mesh gradients created so far (not reset per page to keep the IDs unique)
+		int _shadingImageCount=0;          ///< number of bitmap files created for rasterized shadings
 		bool _makingPattern=false;         ///< true if executing makepattern operator
 		std::map<int, std::unique_ptr<PSPattern>> _patterns;
+		std::map<int, std::string> _patternKeys;  ///< definition parameters of the cached patterns
+		std::unique_ptr<XMLElement> _droppedPatternNode;  ///< absorbs the cell geometry regenerated for already cached patterns
 		PSTilingPattern *_pattern;         ///< current pattern
 		bool _patternEnabled;              ///< true if active color space is a pattern
 		std::string _pdfProc;              ///< tool to process PDF files ("gs" or "mutool")
@@ -25,6 +25,7 @@
 class PsSpecialHandlerProxy : public SpecialHandler {
 	public:
 		explicit PsSpecialHandlerProxy (bool pswarning) : _pswarning(pswarning) {}
+		bool requiresPreprocessing () const override {return true;}
 		void preprocess (const std::string &prefix, std::istream &is, SpecialActions &actions) override;
 		bool process (const std::string &prefix, std::istream &is, SpecialActions &actions) override;
 		const char* name () const override {return "ps";}
@@ -80,6 +80,7 @@ void RangeMap::addRange (uint32_t cmin, uint32_t cmax, uint32_t vmin) {
 	if (cmin > cmax)
 		swap(cmin, cmax);
 
+	_dirtyKeys = true;
 	Range range(cmin, cmax, vmin);
 	if (_ranges.empty())
 		_ranges.push_back(std::move(range));
@@ -156,18 +157,31 @@ void RangeMap::adaptNeighbors (Ranges::iterator it) {
  *  @param[in] c find range that contains this value
  *  @return index of the range found, or -1 if range was not found */
 int RangeMap::lookup (uint32_t c) const {
-	// simple binary search
-	int left=0, right=_ranges.size()-1;
-	while (left <= right) {
-		int mid = (left+right)/2;
-		if (c < _ranges[mid].min())
-			right = mid-1;
-		else if (c > _ranges[mid].max())
-			left = mid+1;
-		else
-			return mid;
+	// Check the range found by the preceding lookup first since consecutive
+	// character codes usually belong to the same range.
+	if (!_dirtyKeys && _lastPos < _ranges.size()) {
+		const Range &lastRange = _ranges[_lastPos];
+		if (c >= lastRange.min() && c <= lastRange.max())
+			return int(_lastPos);
 	}
-	return -1;
+	if (_dirtyKeys) {  // ranges changed since the last search?
+		_minKeys.clear();
+		_minKeys.reserve(_ranges.size());
+		for (const Range &range : _ranges)
+			_minKeys.push_back(range.min());
+		_dirtyKeys = false;
+		_lastPos = 0;
+	}
+	// binary search over the packed keys for the last range with min <= c;
+	// the ranges are disjoint, so only its upper bound must be verified
+	auto it = upper_bound(_minKeys.begin(), _minKeys.end(), c);
+	if (it == _minKeys.begin())
+		return -1;
+	auto pos = size_t(it-_minKeys.begin())-1;
+	if (c > _ranges[pos].max())
+		return -1;
+	_lastPos = pos;
+	return int(pos);
 }
 
 
@@ -120,7 +120,7 @@ class RangeMap {
 		size_t numRanges () const              {return _ranges.size();}
 		size_t numValues () const;
 		bool empty () const                    {return _ranges.empty();}
-		void clear ()                          {_ranges.clear();}
+		void clear ()                          {_ranges.clear(); _minKeys.clear(); _dirtyKeys=true; _lastPos=0;}
 		const Range& getRange (size_t n) const {return _ranges[n];}
 		Iterator begin () const                {return Iterator(*this, _ranges.begin());}
 		Iterator end () const                  {return Iterator(*this, _ranges.end());}
@@ -133,6 +133,12 @@ class RangeMap {
 
 	private:
 		Ranges _ranges;
+		/** Packed copy of the range minima used for the binary search in lookup().
+		 *  Keeping the keys in a contiguous array reduces the number of cache lines
+		 *  touched per search compared to probing the Range objects directly. */
+		mutable std::vector<uint32_t> _minKeys;
+		mutable bool _dirtyKeys=true;  ///< true if _minKeys must be rebuilt before the next search
+		mutable size_t _lastPos=0;     ///< index of the range found by the last lookup
 };
 
 
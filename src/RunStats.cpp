@@ -0,0 +1,46 @@
+/*************************************************************************
+** RunStats.cpp                                                         **
+**                                                                      **
+** This file is part of dvisvgm -- a fast DVI to SVG converter          **
+** Copyright (C) 2005-2024 Martin Gieseking <martin.gieseking@uos.de>   **
+**                                                                      **
+** This program is free software; you can redistribute it and/or        **
+** modify it under the terms of the GNU General Public License as       **
+** published by the Free Software Foundation; either version 3 of       **
+** the License, or (at your option) any later version.                  **
+**                                                                      **
+** This program is distributed in the hope that it will be useful, but  **
+** WITHOUT ANY WARRANTY; without even the implied warranty of           **
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the         **
+** GNU General Public License for more details.                         **
+**                                                                      **
+** You should have received a copy of the GNU General Public License    **
+** along with this program; if not, see <http://www.gnu.org/licenses/>. **
+*************************************************************************/
+
+#include "RunStats.hpp"
+
+using namespace std;
+
+bool RunStats::ENABLED = false;
+constexpr size_t RunStats::NUM_COUNTERS;
+atomic<size_t> RunStats::_counters[RunStats::NUM_COUNTERS];
+
+const char* const RunStats::_names[RunStats::NUM_COUNTERS] = {
+	"specials", "glyphtraces", "cachehits", "cachemisses", "clippaths", "xmlnodes"
+};
+
+
+/** Writes the collected event counts as tab-separated lines of the form
+ *  "counter<TAB>value" so that the output can easily be processed by scripts. */
+void RunStats::write (ostream &os) {
+	for (size_t i=0; i < NUM_COUNTERS; i++)
+		os << _names[i] << '\t' << _counters[i].load(memory_order_relaxed) << '\n';
+}
+
+
+/** Resets all event counters to zero. */
+void RunStats::reset () {
+	for (auto &counter : _counters)
+		counter.store(0, memory_order_relaxed);
+}
@@ -0,0 +1,54 @@
+/*************************************************************************
+** RunStats.hpp                                                         **
+**                                                                      **
+** This file is part of dvisvgm -- a fast DVI to SVG converter          **
+** Copyright (C) 2005-2024 Martin Gieseking <martin.gieseking@uos.de>   **
+**                                                                      **
+** This program is free software; you can redistribute it and/or        **
+** modify it under the terms of the GNU General Public License as       **
+** published by the Free Software Foundation; either version 3 of       **
+** the License, or (at your option) any later version.                  **
+**                                                                      **
+** This program is distributed in the hope that it will be useful, but  **
+** WITHOUT ANY WARRANTY; without even the implied warranty of           **
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the         **
+** GNU General Public License for more details.                         **
+**                                                                      **
+** You should have received a copy of the GNU General Public License    **
+** along with this program; if not, see <http://www.gnu.org/licenses/>. **
+*************************************************************************/
+
+#ifndef RUNSTATS_HPP
+#define RUNSTATS_HPP
+
+#include <atomic>
+#include <ostream>
+
+/** Counts selected events of a conversion run, like the number of processed
+ *  specials, traced glyphs, or created XML nodes. The counters are bumped on
+ *  hot code paths, so they use relaxed atomic increments and are only active
+ *  if the statistics have been requested. The collected values can be printed
+ *  as a machine-readable table afterwards to track them across documents and
+ *  dvisvgm versions. */
+class RunStats {
+	public:
+		enum class Counter {SPECIALS, GLYPH_TRACES, CACHE_HITS, CACHE_MISSES, CLIP_PATHS, XML_NODES};
+
+		/** Increments an event counter. */
+		static void count (Counter counter) {
+			if (ENABLED)
+				_counters[static_cast<size_t>(counter)].fetch_add(1, std::memory_order_relaxed);
+		}
+
+		static void write (std::ostream &os);
+		static void reset ();
+
+		static bool ENABLED;  ///< if false, no events are counted
+
+	private:
+		static constexpr size_t NUM_COUNTERS = 6;
+		static std::atomic<size_t> _counters[NUM_COUNTERS];  ///< event counts indexed by Counter value
+		static const char* const _names[NUM_COUNTERS];       ///< counter names used in the output
+};
+
+#endif
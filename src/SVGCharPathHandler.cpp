@@ -18,7 +18,6 @@
 ** along with this program; if not, see <http://www.gnu.org/licenses/>. **
 *************************************************************************/
 
-#include <sstream>
 #include "Font.hpp"
 #include "FontManager.hpp"
 #include "SVGCharPathHandler.hpp"
@@ -118,7 +117,7 @@ void SVGCharPathHandler::appendUseElement (uint32_t c, double x, double y, const
 	auto useNode = util::make_unique<SVGElement>("use");
 	useNode->addAttribute("x", x);
 	useNode->addAttribute("y", y);
-	useNode->addAttribute("xlink:href", id);
+	useNode->addAttribute("xlink:href", std::move(id));
 	useNode->setFillOpacity(_opacity->blendMode()); // add blend mode style here because it's not inheritable
 	useNode->setTransform(matrix);
 	contextNode()->append(std::move(useNode));
@@ -131,10 +130,11 @@ void SVGCharPathHandler::appendPathElement (uint32_t c, double x, double y, cons
 	if (pf && pf->getGlyph(c, glyph, nullptr)) {
 		double sx = pf->scaledSize()/pf->unitsPerEm();
 		double sy = -sx;
-		ostringstream oss;
-		glyph.writeSVG(oss, _relativePathCommands, sx, sy, x, y);
+		glyph.writeSVG(_pathStream, _relativePathCommands, sx, sy, x, y);
+		string pathdata;
+		_pathStream.swap_vector(pathdata);  // move outline data from stream buffer and reset the stream
 		auto glyphNode = util::make_unique<SVGElement>("path");
-		glyphNode->addAttribute("d", oss.str());
+		glyphNode->addAttribute("d", std::move(pathdata));
 		glyphNode->setTransform(matrix);
 		contextNode()->append(std::move(glyphNode));
 	}
@@ -21,6 +21,8 @@
 #ifndef SVGCHARPATHHANDLER_HPP
 #define SVGCHARPATHHANDLER_HPP
 
+#include <string>
+#include <vectorstream.hpp>
 #include "SVGCharHandler.hpp"
 
 /** Creates SVG path elements for all characters. */
@@ -41,6 +43,7 @@ class SVGCharPathHandler : public SVGCharHandler {
 		bool _relativePathCommands;      ///< if true, create relative rather than absolute SVG path commands
 		SVGElement *_groupNode=nullptr;  ///< current group node taking the path elements
 		CharProperty<Color> _fontColor=Color::BLACK;  ///< color of current font
+		ovectorstream<std::string> _pathStream;  ///< reusable stream buffer taking the glyph outline data
 };
 
 #endif
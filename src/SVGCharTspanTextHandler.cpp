@@ -70,7 +70,7 @@ void SVGCharTspanTextHandler::appendChar (uint32_t c, double x, double y) {
 			_ychanged = false;
 		}
 	}
-	contextNode()->append(XMLString(_font.get()->unicode(c), false));
+	contextNode()->appendUnicodeChar(_font.get()->unicode(c));
 }
 
 
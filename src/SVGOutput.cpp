@@ -19,6 +19,7 @@
 *************************************************************************/
 
 #include <algorithm>
+#include <chrono>
 #include <cmath>
 #include <fstream>
 #include <iomanip>
@@ -27,12 +28,18 @@
 #include "Calculator.hpp"
 #include "FileSystem.hpp"
 #include "Message.hpp"
+#include "PageCompressor.hpp"
 #include "SVGOutput.hpp"
 #include "utility.hpp"
 #include "ZLibOutputStream.hpp"
+#include "ZLibParallelOutputStream.hpp"
 
 using namespace std;
 
+int SVGOutput::ZIP_THREADS = 1;
+bool SVGOutput::ZIP_RSYNCABLE = false;
+bool SVGOutput::PAGE_FRAMES = false;
+
 
 SVGOutput::SVGOutput (const string &base, string pattern, int zipLevel)
 	: _path(base), _pattern(std::move(pattern)), _stdout(base.empty()), _zipLevel(zipLevel)
@@ -40,6 +47,16 @@ SVGOutput::SVGOutput (const string &base, string pattern, int zipLevel)
 }
 
 
+SVGOutput::~SVGOutput () {
+	try {
+		waitForPendingWrites();
+	}
+	catch (MessageException &e) {
+		Message::estream(true) << e.what() << '\n';
+	}
+}
+
+
 /** Returns an output stream for the given page.
  *  @param[in] page number of current page
  *  @param[in] numPages total number of pages in the DVI file
@@ -48,6 +65,18 @@ SVGOutput::SVGOutput (const string &base, string pattern, int zipLevel)
 ostream& SVGOutput::getPageStream (int page, int numPages, const HashTriple &hashes) const {
 	FilePath path = filepath(page, numPages, hashes);
 	if (path.empty()) {
+		if (PAGE_FRAMES) {
+			// collect the page data in a buffer; finish() emits the framed record
+			// once the payload size is known
+			if (page != _page) {
+				_page = page;
+				_bufNumPages = numPages;
+				_bufhashes = hashes;
+				_bufpath = FilePath();
+				_bufptr = util::make_unique<ostringstream>();
+			}
+			return *_bufptr;
+		}
 		if (_zipLevel == 0) {
 			_osptr.reset();
 			return cout;
@@ -56,19 +85,176 @@ ostream& SVGOutput::getPageStream (int page, int numPages, const HashTriple &has
 		if (_setmode(_fileno(stdout), _O_BINARY) == -1)
 			throw MessageException("can't open stdout in binary mode");
 #endif
-		return *(_osptr = util::make_unique<ZLibOutputStream>(cout, ZLIB_GZIP, _zipLevel));
+		if (ZIP_THREADS > 1 && !ZIP_RSYNCABLE)
+			return *(_osptr = util::make_unique<ZLibParallelOutputStream>(cout, _zipLevel, ZIP_THREADS));
+		return *(_osptr = util::make_unique<ZLibOutputStream>(cout, ZLIB_GZIP, _zipLevel, ZIP_RSYNCABLE));
 	}
 	if (page == _page)
-		return *_osptr;
+		return _bufptr ? static_cast<ostream&>(*_bufptr) : *_osptr;
 
 	_page = page;
+	// Collect the page data in a buffer that's written (and optionally compressed)
+	// by a background task started in finish(). This way, the next page can already
+	// be converted while the previous ones hit the disk. The buffer also keeps the
+	// serialized page available for re-emission to further targets (reemitPage).
+	// Several page buffers may be in flight at a time, so the conversion never
+	// stalls on the write latency of a single file; the number of buffers is
+	// limited to keep the memory usage bounded.
+	throttlePendingWrites();
+	_bufptr = util::make_unique<ostringstream>();
+	_bufpath = path;
+	return *_bufptr;
+}
+
+
+static void write_page_data_unchecked (const string &data, const FilePath &path, int zipLevel);
+
+
+/** Writes serialized page data to a file, either plain or gzip-compressed.
+ *  If the write fails or is interrupted, the partially written file is removed.
+ *  @param[in] data serialized SVG data to write
+ *  @param[in] path path of file to write
+ *  @param[in] zipLevel compression level (0 = no compression) */
+static void write_page_data (const string &data, const FilePath &path, int zipLevel) {
+	try {
+		write_page_data_unchecked(data, path, zipLevel);
+	}
+	catch (...) {
+		FileSystem::remove(path.absolute());
+		throw;
+	}
+}
+
+
+/** Performs the actual write of the page data without cleaning up on failure. */
+static void write_page_data_unchecked (const string &data, const FilePath &path, int zipLevel) {
+	if (zipLevel > 0 && SVGOutput::ZIP_RSYNCABLE) {
+		// The rsyncable chunking requires the sequential deflate state, so it takes
+		// precedence over the parallel and one-shot compressors.
+		ZLibOutputFileStream zipstream(path.absolute(), ZLIB_GZIP, zipLevel, true);
+		zipstream.write(data.data(), streamsize(data.size()));
+		if (!zipstream)
+			throw MessageException("can't write file "+path.shorterAbsoluteOrRelative());
+	}
+	else if (zipLevel > 0 && SVGOutput::ZIP_THREADS > 1) {
+		ZLibParallelOutputFileStream zipstream(path.absolute(), zipLevel, SVGOutput::ZIP_THREADS);
+		zipstream.write(data.data(), streamsize(data.size()));
+		if (!zipstream)
+			throw MessageException("can't write file "+path.shorterAbsoluteOrRelative());
+	}
+	else if (zipLevel > 0) {
+		// The page data is complete at this point, so the whole buffer can be
+		// handed to the compressor at once rather than streamed through zlib.
+		string zdata = PageCompressor::create()->compress(data, zipLevel);
+		ofstream ofs(path.absolute(), ios::binary);
+		ofs.write(zdata.data(), streamsize(zdata.size()));
+		if (!ofs)
+			throw MessageException("can't write file "+path.shorterAbsoluteOrRelative());
+	}
+	else {
+		ofstream ofs(path.absolute());
+		ofs.write(data.data(), streamsize(data.size()));
+		if (!ofs)
+			throw MessageException("can't write file "+path.shorterAbsoluteOrRelative());
+	}
+}
+
+
+/** Finishes the output of the current page. If the page data was collected in a
+ *  buffer, a background task is started that writes (and optionally compresses) it
+ *  without delaying the conversion of the following page. The serialized data is
+ *  kept in memory so that it can be re-emitted to further targets afterwards. */
+void SVGOutput::finish () {
+	if (_bufptr && _bufpath.empty()) {
+		// framed stdout mode: the buffered page is emitted immediately so that
+		// downstream consumers can start processing it right away
+		writePageFrame();
+		_bufptr.reset();
+	}
+	else if (_bufptr) {
+		_pageData = std::make_shared<string>(_bufptr->str());
+		auto buffer = _pageData;
+		FilePath path = _bufpath;
+		int zipLevel = _zipLevel;
+		_pendingWrites.push_back(async(launch::async, [buffer, path, zipLevel] {
+			write_page_data(*buffer, path, zipLevel);
+		}));
+		_bufptr.reset();
+	}
+	_osptr.reset();
+}
+
+
+/** Writes the buffered page as a framed record to stdout. Each record consists
+ *  of a single header line of the form
+ *    dvisvgm-page: page=<n> pages=<total> [hash=<hash>] [encoding=gzip] length=<bytes>
+ *  followed by exactly <bytes> bytes of (optionally gzip-compressed) SVG data and
+ *  a trailing newline. The records are emitted in page order as soon as a page has
+ *  been serialized, so consumers reading from a pipe can process each page while
+ *  the following ones are still being converted. */
+void SVGOutput::writePageFrame () const {
+#ifdef _WIN32
+	// the payload length counts bytes, so the newline translation of the Windows
+	// text mode must be switched off; required for compressed payloads anyway
+	if (_setmode(_fileno(stdout), _O_BINARY) == -1)
+		throw MessageException("can't open stdout in binary mode");
+#endif
+	_pageData = std::make_shared<string>(_bufptr->str());
+	string data = *_pageData;
 	if (_zipLevel > 0)
-		_osptr = util::make_unique<ZLibOutputFileStream>(path.absolute(), ZLIB_GZIP, _zipLevel);
-	else
-		_osptr = util::make_unique<ofstream>(path.absolute());
-	if (!_osptr)
-		throw MessageException("can't open file "+path.shorterAbsoluteOrRelative()+" for writing");
-	return *_osptr;
+		data = PageCompressor::create()->compress(data, _zipLevel);
+	cout << "dvisvgm-page: page=" << _page << " pages=" << _bufNumPages;
+	if (!_bufhashes.empty())
+		cout << " hash=" << _bufhashes.cmbHash();
+	if (_zipLevel > 0)
+		cout << " encoding=gzip";
+	cout << " length=" << data.length() << '\n';
+	cout.write(data.data(), streamsize(data.length()));
+	cout.put('\n');
+	// flush the record so that piped consumers receive the page without delay
+	cout.flush();
+}
+
+
+/** Writes the most recently finished page to an additional file without re-running
+ *  the conversion pipeline. Since the serialized page data is retained after finish(),
+ *  the re-emission is a plain (optionally compressed) byte copy, i.e. neither the DVI
+ *  processing nor the font embedding or optimization steps are repeated.
+ *  @param[in] path path of file to write
+ *  @param[in] zipLevel compression level applied to this target (0 = no compression) */
+void SVGOutput::reemitPage (const FilePath &path, int zipLevel) const {
+	if (!_pageData)
+		throw MessageException("no page data available for re-emission");
+	waitForPendingWrites();
+	write_page_data(*_pageData, path, zipLevel);
+}
+
+
+/** Waits until all background tasks writing finished pages have completed.
+ *  Exceptions thrown while compressing or writing the data are rethrown
+ *  here in the context of the calling thread. */
+void SVGOutput::waitForPendingWrites () const {
+	while (!_pendingWrites.empty()) {
+		_pendingWrites.front().get();
+		_pendingWrites.pop_front();
+	}
+}
+
+
+/** Reaps the write tasks already completed and, if the maximum number of
+ *  concurrently pending writes is still exceeded, waits for the oldest one.
+ *  This limits the number of page buffers kept in memory while the converter
+ *  thread only blocks if the writers can't keep up. */
+void SVGOutput::throttlePendingWrites () const {
+	const size_t MAX_PENDING_WRITES = 4;
+	while (!_pendingWrites.empty() && _pendingWrites.front().wait_for(chrono::seconds(0)) == future_status::ready) {
+		_pendingWrites.front().get();
+		_pendingWrites.pop_front();
+	}
+	while (_pendingWrites.size() >= MAX_PENDING_WRITES) {
+		_pendingWrites.front().get();
+		_pendingWrites.pop_front();
+	}
 }
 
 
@@ -177,7 +363,10 @@ string SVGOutput::expandFormatString (string str, int page, int numPages, const
 
 
 /** Returns true if methods 'filename' and 'getPageStream' ignore the hash
- *  parameter because it's not requested in the filename pattern. */
+ *  parameter because it's neither requested in the filename pattern nor
+ *  propagated through the headers of the framed stdout records. */
 bool SVGOutput::ignoresHashes () const {
-	return _stdout || (!_pattern.empty() && _pattern.find("%h") == string::npos);
+	if (_stdout)
+		return !PAGE_FRAMES;
+	return !_pattern.empty() && _pattern.find("%h") == string::npos;
 }
@@ -21,11 +21,15 @@
 #ifndef SVGOUTPUT_HPP
 #define SVGOUTPUT_HPP
 
+#include <deque>
+#include <future>
 #include <memory>
 #include <ostream>
+#include <sstream>
 #include <string>
 #include "FilePath.hpp"
 
+class BoundingBox;
 
 struct SVGOutputBase {
 	class HashTriple {
@@ -47,6 +51,9 @@ struct SVGOutputBase {
 	virtual ~SVGOutputBase () =default;
 	virtual std::ostream& getPageStream (int page, int numPages, const HashTriple &hashes=HashTriple()) const =0;
 	virtual FilePath filepath (int page, int numPages, const HashTriple &hashes= HashTriple()) const =0;
+	/** Announces the bounding box of a page before its stream is requested.
+	 *  Sinks passing the page data on together with metadata can pick it up here. */
+	virtual void setPageBBox (int page, const BoundingBox &bbox) {}
 	virtual void finish () =0;
 	virtual bool ignoresHashes () const {return true;}
 };
@@ -54,18 +61,27 @@ struct SVGOutputBase {
 
 class SVGOutput : public SVGOutputBase {
 	public:
+		static int ZIP_THREADS;     ///< number of threads used for gzip compression (1 = single-threaded zlib)
+		static bool ZIP_RSYNCABLE;  ///< if true, reset the deflate state at content-defined boundaries
+		static bool PAGE_FRAMES;    ///< if true, write the pages as length-prefixed records to stdout
+
 		SVGOutput () =default;
 		explicit SVGOutput (const std::string &base) : SVGOutput(base, "", 0) {}
 		SVGOutput (const std::string &base, const std::string &pattern) : SVGOutput(base, pattern, 0) {}
 		SVGOutput (const std::string &base, std::string pattern, int zipLevel);
+		~SVGOutput () override;
 		std::ostream& getPageStream (int page, int numPages, const HashTriple &hash=HashTriple()) const override;
 		FilePath filepath (int page, int numPages, const HashTriple &hash=HashTriple()) const override;
-		void finish () override {_osptr.reset();}
+		void finish () override;
 		bool ignoresHashes () const override;
 		void setFileNumbers (int fileNumber, int fileCount) {_fileNumber = fileNumber; _fileCount = fileCount;}
+		void reemitPage (const FilePath &path, int zipLevel) const;
 
 	protected:
 		std::string expandFormatString (std::string str, int page, int numPages, const HashTriple &hashes) const;
+		void waitForPendingWrites () const;
+		void throttlePendingWrites () const;
+		void writePageFrame () const;
 
 	private:
 		FilePath _path;
@@ -76,6 +92,12 @@ class SVGOutput : public SVGOutputBase {
 		int _fileCount=1;     ///< number of files in sequence
 		mutable int _page=-1; ///< number of current page being written
 		mutable std::unique_ptr<std::ostream> _osptr;
+		mutable std::unique_ptr<std::ostringstream> _bufptr;  ///< collects the data of the current page
+		mutable FilePath _bufpath;                ///< path of the file the buffered page data is written to
+		mutable int _bufNumPages=0;               ///< total number of pages, kept for the frame header
+		mutable HashTriple _bufhashes;            ///< hashes of the buffered page, kept for the frame header
+		mutable std::deque<std::future<void>> _pendingWrites;  ///< handles of the background tasks writing the finished pages
+		mutable std::shared_ptr<std::string> _pageData;  ///< serialized data of the most recently finished page, kept for re-emission
 };
 
 #endif
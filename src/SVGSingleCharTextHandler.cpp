@@ -26,7 +26,7 @@ using namespace std;
 void SVGSingleCharTextHandler::appendChar (uint32_t c, double x, double y) {
 	const Font *font = _font.get();
 	auto textNode = createTextNode(x, y);
-	textNode->append(XMLString(font->unicode(c), false));
+	textNode->appendUnicodeChar(font->unicode(c));
 	// Apply color changes only if the color differs from black and if the font color itself is black.
 	// Glyphs from non-black fonts (e.g. defined in a XeTeX document) can't change their color.
 	if (font->color() == Color::BLACK && (_fillColor.get() != Color::BLACK || (SVGElement::USE_CURRENTCOLOR && SVGElement::CURRENTCOLOR == Color::BLACK)))
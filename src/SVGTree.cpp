@@ -32,6 +32,7 @@
 #include "SVGTree.hpp"
 #include "XMLDocument.hpp"
 #include "XMLString.hpp"
+#include "XXHashFunction.hpp"
 
 using namespace std;
 
@@ -45,6 +46,7 @@ bool SVGTree::MERGE_CHARS=true;
 bool SVGTree::ADD_COMMENTS=false;
 bool SVGTree::EMBED_BITMAP_DATA = false;
 double SVGTree::ZOOM_FACTOR=1.0;
+bool SVGTree::FLUSH_PAGE_NODES=false;
 
 
 SVGTree::SVGTree () : _charHandler(SVGCharHandlerFactory::createHandler()) {
@@ -63,6 +65,9 @@ void SVGTree::reset () {
 	_doc.setRootNode(std::move(rootNode));
 	_page = _defs = nullptr;
 	_styleCDataNode = nullptr;
+	_glyphPathMap.clear();
+	_defsHashMap.clear();
+	_containsText = false;
 }
 
 
@@ -133,6 +138,7 @@ void SVGTree::newPage (int pageno) {
 	_root->append(std::move(pageNode));
 	_defsContextStack = stack<SVGElement*>();
 	_pageContextStack = stack<SVGElement*>();
+	_pageNodeCount = 0;
 }
 
 
@@ -147,10 +153,68 @@ void SVGTree::appendToDefs (unique_ptr<XMLNode> node) {
 }
 
 
+/** Computes a hash value of an element's XML representation where the id attribute
+ *  is not taken into account, i.e. two elements that differ only by their id
+ *  attribute get the same hash value. */
+static uint64_t content_hash (XMLElement *elem) {
+	string id;
+	if (const char *idval = elem->getAttributeValue("id"))
+		id = idval;
+	elem->removeAttribute("id");
+	ostringstream oss;
+	elem->write(oss);
+	uint64_t value = XXH64HashFunction(oss.str().data(), oss.str().length()).digestValue();
+	if (!id.empty())
+		elem->addAttribute("id", id);
+	return value;
+}
+
+
+/** Appends an element to the section of definitions unless a structurally identical
+ *  one (ignoring the id attributes) is already present there. In the latter case,
+ *  the new element is dropped. Callers must reference the returned element, e.g. by
+ *  its id attribute, rather than the appended one.
+ *  @param[in] elem element to be appended
+ *  @return pointer to the element present in the defs section after the call */
+XMLElement* SVGTree::appendUniqueToDefs (unique_ptr<XMLElement> elem) {
+	XMLElement *elemPtr = elem.get();
+	if (!_defsContextStack.empty()) {  // don't unify elements of nested defs contexts
+		appendToDefs(std::move(elem));
+		return elemPtr;
+	}
+	auto state = _defsHashMap.emplace(content_hash(elemPtr), elemPtr);
+	if (!state.second)  // identical element already present?
+		return state.first->second;
+	appendToDefs(std::move(elem));
+	return elemPtr;
+}
+
+
+/** Number of completed nodes that must have been added to the page element
+ *  before they are flushed by appendToPage if FLUSH_PAGE_NODES is enabled. */
+constexpr size_t MIN_FLUSH_NODES = 1000;
+
 void SVGTree::appendToPage (unique_ptr<XMLNode> node) {
 	SVGElement *parent = _pageContextStack.empty() ? _page : _pageContextStack.top();
 	parent->append(std::move(node));
 	_charHandler->setInitialContextNode(parent);
+	if (FLUSH_PAGE_NODES && _pageContextStack.empty() && ++_pageNodeCount >= MIN_FLUSH_NODES) {
+		flushPageNodes();
+		_pageNodeCount = 0;
+	}
+}
+
+
+/** Serializes the structurally complete children of the page element and
+ *  replaces them with a single text node holding their XML representation.
+ *  This keeps the memory footprint of pages with a large number of graphics
+ *  elements low while leaving the generated SVG output unchanged. The last
+ *  child is retained since further nodes may still be attached to it. The
+ *  method does nothing while a page context, e.g. an anchor element created
+ *  by a hyperref special, is still open. */
+void SVGTree::flushPageNodes () {
+	if (_page && _pageContextStack.empty())
+		_page->collapseChildren(_page->lastChild());
 }
 
 
@@ -172,13 +236,28 @@ void SVGTree::transformPage (const Matrix &usermatrix) {
  *  @param[in] font font to extract the glyph from
  *  @param[in] cb pointer to callback object for sending feedback to the glyph tracer (may be 0)
  *  @return pointer to element node if glyph exists, 0 otherwise */
-static unique_ptr<XMLElement> createGlyphNode (int c, const PhysicalFont &font, GFGlyphTracer::Callback *cb) {
-	Glyph glyph;
-	if (!font.getGlyph(c, glyph, cb) || (!SVGTree::USE_FONTS && !SVGTree::CREATE_USE_ELEMENTS))
-		return nullptr;
-
-	double sx=1.0, sy=1.0;
-	double upem = font.unitsPerEm();
+unique_ptr<XMLElement> SVGTree::createGlyphNode (int c, const PhysicalFont &font, GFGlyphTracer::Callback *cb) {
+	int fontID = FontManager::instance().fontID(&font);
+	auto cacheIt = _glyphDrawingsMap.find(pair<int,int>(fontID, c));
+	if (cacheIt == _glyphDrawingsMap.end()) {
+		// glyph not serialized yet: trace its outline and create the drawing commands
+		Glyph glyph;
+		if (!font.getGlyph(c, glyph, cb) || (!SVGTree::USE_FONTS && !SVGTree::CREATE_USE_ELEMENTS))
+			return nullptr;
+		GlyphDrawing drawing;
+		double sx=1.0, sy=1.0;
+		if (!SVGTree::USE_FONTS) {
+			sx = font.scaledSize()/font.unitsPerEm();
+			sy = -sx;
+			// Different fonts may provide identical glyph outlines, e.g. re-encoded variants
+			// of the same base font. Hash the canonical outline (in font units) so that an
+			// already present path element can be referenced rather than repeated.
+			drawing.hash = XXH64HashFunction(glyph.svgPathData(false, 1.0, 1.0)).digestValue();
+		}
+		drawing.pathdata = glyph.svgPathData(SVGTree::RELATIVE_PATH_CMDS, sx, sy);
+		cacheIt = _glyphDrawingsMap.emplace(pair<int,int>(fontID, c), std::move(drawing)).first;
+	}
+	const GlyphDrawing &drawing = cacheIt->second;
 	unique_ptr<XMLElement> glyphNode;
 	if (SVGTree::USE_FONTS) {
 		double extend = font.style() ? font.style()->extend : 1;
@@ -191,14 +270,23 @@ static unique_ptr<XMLElement> createGlyphNode (int c, const PhysicalFont &font,
 			glyphNode->addAttribute("glyph-name", name);
 	}
 	else {
+		string id = "g"+to_string(fontID)+"-"+to_string(c);
+		double sx = font.scaledSize()/font.unitsPerEm();
+		auto it = _glyphPathMap.find(drawing.hash);
+		if (it != _glyphPathMap.end()) {
+			glyphNode = util::make_unique<XMLElement>("use");
+			glyphNode->addAttribute("id", id);
+			glyphNode->addAttribute("xlink:href", "#"+it->second.first);
+			double scale = sx/it->second.second;
+			if (scale != 1.0)
+				glyphNode->addAttribute("transform", "scale("+XMLString(scale)+")");
+			return glyphNode;
+		}
+		_glyphPathMap.emplace(drawing.hash, pair<string,double>(id, sx));
 		glyphNode = util::make_unique<XMLElement>("path");
-		glyphNode->addAttribute("id", "g"+to_string(FontManager::instance().fontID(&font))+"-"+to_string(c));
-		sx = font.scaledSize()/upem;
-		sy = -sx;
+		glyphNode->addAttribute("id", id);
 	}
-	ostringstream oss;
-	glyph.writeSVG(oss, SVGTree::RELATIVE_PATH_CMDS, sx, sy);
-	glyphNode->addAttribute("d", oss.str());
+	glyphNode->addAttribute("d", drawing.pathdata);
 	return glyphNode;
 }
 
@@ -220,32 +308,37 @@ static string font_info (const Font &font) {
 }
 
 
-void SVGTree::appendFontStyles (const unordered_set<const Font*> &fonts) {
-	if (CREATE_CSS && USE_FONTS && !fonts.empty() && _page) {
-		map<int, const Font*> sortmap;
-		for (const Font *font : fonts)
-			if (!font_cast<const VirtualFont*>(font))   // skip virtual fonts
-				sortmap[FontManager::instance().fontID(font)] = font;
-		ostringstream style;
-		// add font style definitions in ascending order
-		for (auto &idfontpair : sortmap) {
-			if (CREATE_CSS) {
-				style << "text.f"     << idfontpair.first << ' '
-					<< "{font-family:" << idfontpair.second->name()
-					<< ";font-size:"   << XMLString(idfontpair.second->scaledSize()) << "px";
-				if (idfontpair.second->color() != Color::BLACK)
-					style << ";fill:" << idfontpair.second->color().svgColorString();
-				style << '}';
-				if (ADD_COMMENTS) {
-					string info = font_info(*idfontpair.second);
-					if (!info.empty())
-						style << " /* " << info << " */";
-				}
-				style << '\n';
-			}
+/** Returns the CSS rules that assign the font family, size, and color to the
+ *  text classes referenced by the text elements of the generated SVG pages.
+ *  @param[in] fonts fonts the style rules are created for */
+string SVGTree::fontStyleCSS (const unordered_set<const Font*> &fonts) {
+	map<int, const Font*> sortmap;
+	for (const Font *font : fonts)
+		if (!font_cast<const VirtualFont*>(font))   // skip virtual fonts
+			sortmap[FontManager::instance().fontID(font)] = font;
+	ostringstream style;
+	// add font style definitions in ascending order
+	for (auto &idfontpair : sortmap) {
+		style << "text.f"     << idfontpair.first << ' '
+			<< "{font-family:" << idfontpair.second->name()
+			<< ";font-size:"   << XMLString(idfontpair.second->scaledSize()) << "px";
+		if (idfontpair.second->color() != Color::BLACK)
+			style << ";fill:" << idfontpair.second->color().svgColorString();
+		style << '}';
+		if (ADD_COMMENTS) {
+			string info = font_info(*idfontpair.second);
+			if (!info.empty())
+				style << " /* " << info << " */";
 		}
-		styleCDataNode()->append(style.str());
+		style << '\n';
 	}
+	return style.str();
+}
+
+
+void SVGTree::appendFontStyles (const unordered_set<const Font*> &fonts) {
+	if (CREATE_CSS && USE_FONTS && !fonts.empty() && _page)
+		styleCDataNode()->append(fontStyleCSS(fonts));
 }
 
 
@@ -346,6 +439,51 @@ void SVGTree::popPageContext () {
 }
 
 
+/** Removes all children of an element that were appended after a given node.
+ *  @param[in] parent element whose trailing children are removed
+ *  @param[in] lastKept last child node to be kept (nullptr = remove all children) */
+static void remove_appended_children (XMLElement *parent, XMLNode *lastKept) {
+	if (parent) {
+		while (parent->lastChild() && parent->lastChild() != lastKept)
+			XMLElement::detach(parent->lastChild());
+	}
+}
+
+
+/** Records the current insertion points of the page and defs subtrees so that
+ *  nodes added afterwards can be removed again by rollbackTo(). The recorded
+ *  positions stay valid as long as the referenced nodes aren't detached or
+ *  serialized early, i.e. FLUSH_PAGE_NODES must be disabled while checkpoints
+ *  are in use. */
+SVGTree::Checkpoint SVGTree::createCheckpoint () const {
+	Checkpoint checkpoint;
+	checkpoint.pageContextDepth = _pageContextStack.size();
+	checkpoint.defsContextDepth = _defsContextStack.size();
+	if (SVGElement *pageTarget = _pageContextStack.empty() ? _page : _pageContextStack.top())
+		checkpoint.lastPageChild = pageTarget->lastChild();
+	if (SVGElement *defsTarget = _defsContextStack.empty() ? _defs : _defsContextStack.top())
+		checkpoint.lastDefsChild = defsTarget->lastChild();
+	return checkpoint;
+}
+
+
+/** Removes the nodes added to the page and defs subtrees since a checkpoint was
+ *  taken, e.g. the partial output of a special handler that bailed out with an
+ *  exception. Graphics state updates applied in the meantime, like color or
+ *  transformation changes, are not reverted.
+ *  @param[in] checkpoint position information recorded by createCheckpoint() */
+void SVGTree::rollbackTo (const Checkpoint &checkpoint) {
+	while (_pageContextStack.size() > checkpoint.pageContextDepth)
+		_pageContextStack.pop();
+	while (_defsContextStack.size() > checkpoint.defsContextDepth)
+		_defsContextStack.pop();
+	SVGElement *pageTarget = _pageContextStack.empty() ? _page : _pageContextStack.top();
+	remove_appended_children(pageTarget, checkpoint.lastPageChild);
+	remove_appended_children(_defsContextStack.empty() ? _defs : _defsContextStack.top(), checkpoint.lastDefsChild);
+	_charHandler->setInitialContextNode(pageTarget);
+}
+
+
 XMLCData* SVGTree::styleCDataNode () {
 	if (!_styleCDataNode) {
 		auto styleNode = util::make_unique<XMLElement>("style");
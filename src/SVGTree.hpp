@@ -25,6 +25,7 @@
 #include <memory>
 #include <set>
 #include <stack>
+#include <unordered_map>
 #include <unordered_set>
 #include "Color.hpp"
 #include "FontWriter.hpp"
@@ -46,19 +47,38 @@ class SVGTree {
 		SVGTree ();
 		void reset ();
 		bool write (std::ostream &os) const {return bool(_doc.write(os));}
+		/** Transfers the ownership of the current document to the caller, e.g. to write
+		 *  it in the background while this tree is already populated with the next page.
+		 *  Raw node pointers taken before the call stay valid for the moved document. */
+		XMLDocument detachDocument () {return std::move(_doc);}
 		void newPage (int pageno);
 		void appendToDefs (std::unique_ptr<XMLNode> node);
+		XMLElement* appendUniqueToDefs (std::unique_ptr<XMLElement> elem);
 		void appendToPage (std::unique_ptr<XMLNode> node);
 		void prependToPage (std::unique_ptr<XMLNode> node);
 		void appendToDoc (std::unique_ptr<XMLNode> node)  {_doc.append(std::move(node));}
 		void appendToRoot (std::unique_ptr<XMLNode> node) {_root->append(std::move(node));}
-		void appendChar (int c, double x, double y) {_charHandler->appendChar(c, x, y);}
+		void appendChar (int c, double x, double y) {_containsText = true; _charHandler->appendChar(c, x, y);}
 		void appendFontStyles (const std::unordered_set<const Font*> &fonts);
+		static std::string fontStyleCSS (const std::unordered_set<const Font*> &fonts);
+		void appendStyleData (std::string data) {styleCDataNode()->append(std::move(data));}
 		void append (const PhysicalFont &font, const std::set<int> &chars, GFGlyphTracer::Callback *callback=nullptr);
+		void flushPageNodes ();
 		void pushDefsContext (std::unique_ptr<SVGElement> node);
 		void popDefsContext ();
 		void pushPageContext (std::unique_ptr<SVGElement> node);
 		void popPageContext ();
+
+		/** Position information recorded by createCheckpoint() that allows to remove
+		 *  the nodes added to the page and defs subtrees afterwards (see rollbackTo). */
+		struct Checkpoint {
+			XMLNode *lastPageChild=nullptr;  ///< last child of the current page context element
+			XMLNode *lastDefsChild=nullptr;  ///< last child of the current defs context element
+			size_t pageContextDepth=0;       ///< depth of the page context stack
+			size_t defsContextDepth=0;       ///< depth of the defs context stack
+		};
+		Checkpoint createCheckpoint () const;
+		void rollbackTo (const Checkpoint &checkpoint);
 		void setBBox (const BoundingBox &bbox);
 		void setFont (int id, const Font &font);
 		std::pair<int,const Font*> getFontPair () const;
@@ -75,12 +95,14 @@ class SVGTree {
 		Color getStrokeColor () const       {return _charHandler->getStrokeColor();}
 		const Opacity& getOpacity () const  {return _charHandler->getOpacity();}
 		const Matrix& getMatrix () const    {return _charHandler->getMatrix();}
+		bool containsText () const          {return _containsText;}
 		XMLElement* rootNode () const       {return _root;}
 		XMLElement* defsNode () const       {return _defs;}
 		XMLElement* pageNode () const       {return _page;}
+		XMLCData* styleCDataNode ();
 
 	protected:
-		XMLCData* styleCDataNode ();
+		std::unique_ptr<XMLElement> createGlyphNode (int c, const PhysicalFont &font, GFGlyphTracer::Callback *cb);
 
 	public:
 		static bool USE_FONTS;           ///< if true, create font references and don't draw paths directly
@@ -92,14 +114,33 @@ class SVGTree {
 		static bool ADD_COMMENTS;        ///< add comments with additional information
 		static double ZOOM_FACTOR;       ///< factor applied to width/height attribute
 		static bool EMBED_BITMAP_DATA;   ///< if true, bitmaps are embedded into the SVG document
+		static bool FLUSH_PAGE_NODES;    ///< serialize finished parts of the current page early to reduce memory usage?
 
 	private:
+		struct GlyphDrawing {
+			uint64_t hash=0;       ///< hash of the canonicalized outline (only used if font support is disabled)
+			std::string pathdata;  ///< serialized SVG drawing commands of the glyph outline
+		};
+
 		XMLDocument _doc;
 		SVGElement *_root=nullptr, *_page=nullptr, *_defs=nullptr;
 		XMLCData *_styleCDataNode=nullptr;
 		std::unique_ptr<SVGCharHandler> _charHandler;
 		std::stack<SVGElement*> _defsContextStack;
 		std::stack<SVGElement*> _pageContextStack;
+		size_t _pageNodeCount=0;  ///< number of completed page nodes added since the last flush
+		bool _containsText=false;  ///< true if any characters were appended to the document since the last reset
+		/** Maps the hash of a canonicalized glyph outline to the ID and scale factor of the
+		 *  path element that already represents the outline in the current document. */
+		std::unordered_map<uint64_t, std::pair<std::string,double>> _glyphPathMap;
+		/** Maps the content hash of an element in the defs section to the element itself
+		 *  in order to share structurally identical entries (ignoring their id attributes). */
+		std::unordered_map<uint64_t, XMLElement*> _defsHashMap;
+		/** Caches the serialized outline data of the glyphs used in the document, keyed by
+		 *  font ID and character code. The serialization parameters don't change during a
+		 *  run, so multi-page documents can reuse the strings generated for previous pages
+		 *  instead of retracing and reserializing the entire glyph set per page. */
+		std::map<std::pair<int,int>, GlyphDrawing> _glyphDrawingsMap;
 };
 
 #endif
@@ -18,6 +18,8 @@
 ** along with this program; if not, see <http://www.gnu.org/licenses/>. **
 *************************************************************************/
 
+#include <algorithm>
+#include <cmath>
 #include <sstream>
 #include "ShadingPatch.hpp"
 #include "TensorProductPatch.hpp"
@@ -26,6 +28,42 @@
 
 using namespace std;
 
+double ShadingPatch::LOD = 1;
+
+
+/** Returns the Euclidean distance of two colors in the current color space. */
+static double color_distance (const Color &c1, const Color &c2) {
+	valarray<double> diff = c1.getDoubleValues()-c2.getDoubleValues();
+	return sqrt((diff*diff).sum());
+}
+
+
+/** Computes the number of segments per row/column actually required to approximate
+ *  this patch. The grid size requested on the command line is treated as an upper
+ *  bound; patches with little color variation or a small geometric extent get along
+ *  with correspondingly fewer segments, so that flat or tiny patches don't expand
+ *  to thousands of path elements.
+ *  @param[in] gridsize maximal number of segments per row/column
+ *  @param[in] colors corner colors of the patch
+ *  @return number of segments per row/column to be used */
+int ShadingPatch::adaptedGridsize (int gridsize, const ColorVec &colors) const {
+	if (LOD <= 0)  // adaptive subdivision disabled?
+		return gridsize;
+	// maximum color deviation between any two corners of the patch
+	double maxDistance = 0;
+	for (size_t i=0; i < colors.size(); i++)
+		for (size_t j=i+1; j < colors.size(); j++)
+			maxDistance = max(maxDistance, color_distance(colors[i], colors[j]));
+	// number of segments required to keep the color difference between adjacent
+	// segments below a single 8-bit quantization step (scaled by the LOD factor)
+	int colorSegments = int(ceil(maxDistance*255*LOD));
+	// limit the segment size to roughly one output unit (bp) since finer
+	// subdivisions of small patches aren't visible
+	BoundingBox bbox = getBBox();
+	int sizeSegments = int(ceil(max(bbox.width(), bbox.height())*LOD));
+	return max(1, min(gridsize, min(colorSegments, sizeSegments)));
+}
+
 
 /** Factory method: Creates a shading patch object depending on the given PostScript shading type. */
 unique_ptr<ShadingPatch> ShadingPatch::create (int psShadingType, Color::ColorSpace cspace) {
@@ -22,6 +22,8 @@
 #define SHADINGPATCH_HPP
 
 #include <memory>
+#include <string>
+#include <vector>
 #include "Color.hpp"
 #include "GraphicsPath.hpp"
 #include "MessageException.hpp"
@@ -34,6 +36,18 @@ class ShadingPatch {
 			virtual void patchSegment (GraphicsPath<double> &path, const Color &color) =0;
 		};
 
+		/** Geometry and color data of a patch arranged for emitting an SVG mesh
+		 *  gradient, i.e. the corner colors and the edge curves connecting the
+		 *  corners in clockwise order, starting at the first corner point. */
+		struct MeshData {
+			struct Stop {
+				std::string pathData;  ///< SVG path data of the edge leading to the next corner
+				Color color;           ///< color at the starting corner of the edge
+			};
+			DPair startPoint;         ///< first corner point of the patch
+			std::vector<Stop> stops;
+		};
+
 		using PointVec = std::vector<DPair>;
 		using ColorVec = std::vector<Color>;
 
@@ -41,9 +55,13 @@ class ShadingPatch {
 		explicit ShadingPatch (Color::ColorSpace colorSpace) : _colorspace(colorSpace) {}
 		virtual ~ShadingPatch () =default;
 		virtual int psShadingType () const =0;
+		virtual DPair valueAt (double u, double v) const =0;
+		virtual Color colorAt (double u, double v) const =0;
 		virtual void approximate (int gridsize, bool overlap, double delta, Callback &callback) const =0;
+		virtual int estimatedSegments (int gridsize) const =0;
 		virtual BoundingBox getBBox () const =0;
 		virtual GraphicsPath<double> getBoundaryPath () const =0;
+		virtual MeshData getMeshData () const =0;
 		virtual void setPoints (const PointVec &points, int edgeflag, ShadingPatch *patch) =0;
 		virtual void setColors (const ColorVec &colors, int edgeflag, ShadingPatch *patch) =0;
 		virtual int numPoints (int edgeflag) const =0;
@@ -51,9 +69,13 @@ class ShadingPatch {
 		Color::ColorSpace colorSpace () const {return _colorspace;}
 		static std::unique_ptr<ShadingPatch> create (int psShadingType, Color::ColorSpace cspace);
 
+	public:
+		static double LOD;  ///< level-of-detail factor applied to the adaptive patch subdivision (0 disables it)
+
 	protected:
 		using ColorGetter = void (Color::*)(std::valarray<double> &va) const;
 		using ColorSetter = void (Color::*)(const std::valarray<double> &va);
+		int adaptedGridsize (int gridsize, const ColorVec &colors) const;
 
 	private:
 		Color::ColorSpace _colorspace;  ///< color space used to compute the shading values
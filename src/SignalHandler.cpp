@@ -27,7 +27,9 @@
 
 using namespace std;
 
-volatile bool SignalHandler::_break = false;
+// The flag is a lock-free atomic so that it can be set from the signal handler
+// and polled from all processing threads without further synchronization.
+atomic<bool> SignalHandler::_break{false};
 
 /** Helper class that encapsulates the system-specific parts of
  *  registering and handling CTRL-C (SIGINT) events. */
@@ -87,16 +89,8 @@ void SignalHandler::stop () {
 }
 
 
-/** Checks for incoming signals and throws an exception if CTRL-C was caught.
- *  @throw SignalException */
-void SignalHandler::check () {
-	if (_break)
-		throw SignalException();
-}
-
-
 void SignalHandler::trigger (bool notify) {
-	_break = true;
+	_break.store(true, memory_order_relaxed);
 	if (notify)
 		check();
 }
@@ -104,7 +98,7 @@ void SignalHandler::trigger (bool notify) {
 
 /** This function is called on CTRL-C signals. */
 void SignalHandler::callback (int) {
-	_break = true;
+	_break.store(true, memory_order_relaxed);
 }
 
 
@@ -21,6 +21,7 @@
 #ifndef SIGNALHANDLER_HPP
 #define SIGNALHANDLER_HPP
 
+#include <atomic>
 #include <exception>
 #include <memory>
 
@@ -36,17 +37,29 @@ class SignalHandler {
 		static SignalHandler& instance ();
 		bool start ();
 		void stop ();
-		void check ();
 		void trigger (bool notify);
 		bool active () const {return _active;}
 
+		/** Checks for incoming signals and throws an exception if CTRL-C was caught.
+		 *  The check is a single relaxed atomic load, so it's cheap enough to be
+		 *  called from the hot loops of all processing threads.
+		 *  @throw SignalException */
+		void check () {
+			if (_break.load(std::memory_order_relaxed))
+				throw SignalException();
+		}
+
+		/** Returns true if CTRL-C was caught. In contrast to check(), this method
+		 *  doesn't throw and can be used in contexts that must not raise exceptions. */
+		bool aborted () const {return _break.load(std::memory_order_relaxed);}
+
 	protected:
 		SignalHandler ();
 		static void callback (int signal);
 
 	private:
-		bool _active=false;          ///< true if listening for signals
-		static volatile bool _break; ///< true if signal has been caught
+		bool _active=false;               ///< true if listening for signals
+		static std::atomic<bool> _break;  ///< true if signal has been caught
 		class Impl;
 		std::unique_ptr<Impl> _impl; ///< system-specific data/functions
 };
@@ -20,7 +20,9 @@
 
 #include <fstream>
 #include <iostream>
+#include <limits>
 #include "FileSystem.hpp"
+#include "MappedInputStream.hpp"
 #include "Message.hpp"
 #include "MessageException.hpp"
 #include "SourceInput.hpp"
@@ -108,27 +110,162 @@ bool TemporaryFile::close () {
 
 ////////////////////////////////////////////////////////////////
 
+/** Returns the current absolute read position of the stream buffer. */
+size_t StdinStreamBuffer::position () {
+	if (!spilled())
+		return gptr()-eback();
+	return size_t(_filebuf.pubseekoff(0, ios_base::cur, ios_base::in)) - (egptr()-gptr());
+}
+
+
+/** Reads further data from stdin until the memory buffer contains at least
+ *  'size' bytes, the memory threshold is exceeded, or stdin is exhausted.
+ *  If the threshold is exceeded, the complete data is spilled to the
+ *  temporary file.
+ *  @param[in] size requested minimum buffer size
+ *  @param[in] pos current read position to preserve across a potential spill */
+void StdinStreamBuffer::fillBuffer (size_t size, size_t pos) {
+	while (!_stdinDrained && _buffer.size() < size && _buffer.size() <= _maxBufferSize) {
+		char chunk[16384];
+		cin.read(chunk, sizeof(chunk));
+		_buffer.insert(_buffer.end(), chunk, chunk+cin.gcount());
+		if (!cin)
+			_stdinDrained = true;
+	}
+	if (_buffer.size() > _maxBufferSize)
+		spillToFile(pos);
+}
+
+
+/** Writes the buffered data and the remaining portion of stdin to the
+ *  temporary file, and redirects all further read operations to that file.
+ *  @return true on success */
+bool StdinStreamBuffer::spillToFile () {
+	return spilled() || spillToFile(position());
+}
+
+
+bool StdinStreamBuffer::spillToFile (size_t pos) {
+	if (spilled())
+		return true;
+	if (!_tmpfile.create() || !_tmpfile.write(_buffer.data(), _buffer.size()))
+		return false;
+	_filesize = _buffer.size();
+	while (!_stdinDrained) {
+		char chunk[16384];
+		cin.read(chunk, sizeof(chunk));
+		if (!_tmpfile.write(chunk, cin.gcount()))
+			return false;
+		_filesize += cin.gcount();
+		if (!cin)
+			_stdinDrained = true;
+	}
+	vector<char>().swap(_buffer);  // release the memory buffer
+	if (!_filebuf.open(_tmpfile.path(), ios_base::in|ios_base::binary))
+		return false;
+	_filebuf.pubseekpos(pos, ios_base::in);
+	setg(_chunk, _chunk, _chunk);
+	return true;
+}
+
+
+StdinStreamBuffer::int_type StdinStreamBuffer::underflow () {
+	if (gptr() < egptr())
+		return traits_type::to_int_type(*gptr());
+	if (!spilled()) {
+		size_t pos = gptr()-eback();
+		fillBuffer(pos+1, pos);
+		if (!spilled()) {
+			if (pos >= _buffer.size())
+				return traits_type::eof();
+			char *base = _buffer.data();
+			setg(base, base+pos, base+_buffer.size());
+			return traits_type::to_int_type(*gptr());
+		}
+	}
+	streamsize count = _filebuf.sgetn(_chunk, sizeof(_chunk));
+	if (count <= 0)
+		return traits_type::eof();
+	setg(_chunk, _chunk, _chunk+count);
+	return traits_type::to_int_type(*gptr());
+}
+
+
+StdinStreamBuffer::pos_type StdinStreamBuffer::seekoff (off_type off, ios_base::seekdir dir, ios_base::openmode mode) {
+	if (!(mode & ios_base::in))
+		return pos_type(off_type(-1));
+	off_type base=0;
+	switch (dir) {
+		case ios_base::cur:
+			base = position();
+			break;
+		case ios_base::end:
+			// the total stream size is required here, so ensure stdin is drained
+			if (!spilled())
+				fillBuffer(numeric_limits<size_t>::max(), gptr()-eback());
+			base = spilled() ? _filesize : _buffer.size();
+			break;
+		default:
+			base = 0;
+	}
+	off_type newpos = base+off;
+	if (newpos < 0)
+		return pos_type(off_type(-1));
+	return seekpos(pos_type(newpos), mode);
+}
+
+
+StdinStreamBuffer::pos_type StdinStreamBuffer::seekpos (pos_type pos, ios_base::openmode mode) {
+	auto target = size_t(off_type(pos));
+	if (!spilled()) {
+		fillBuffer(target, gptr()-eback());
+		if (!spilled()) {
+			if (target > _buffer.size())
+				return pos_type(off_type(-1));
+			char *base = _buffer.data();
+			setg(base, base+target, base+_buffer.size());
+			return pos;
+		}
+	}
+	if (target > _filesize || _filebuf.pubseekpos(pos, ios_base::in) == pos_type(off_type(-1)))
+		return pos_type(off_type(-1));
+	setg(_chunk, _chunk, _chunk);
+	return pos;
+}
+
+////////////////////////////////////////////////////////////////
+
+SourceInput::SourceInput (const string &fname) : _fname(fname) {}
+SourceInput::~SourceInput () =default;
+
+
 istream& SourceInput::getInputStream (bool showMessages) {
+	if (_mis && _mis->mapped())
+		return *_mis;
+	if (_sis)
+		return *_sis;
 	if (!_ifs.is_open()) {
-		if (!_fname.empty())
+		if (!_fname.empty()) {
+			// prefer reading through a memory-mapped region to avoid
+			// buffer copies and to speed up random accesses
+			_mis = util::make_unique<MappedInputStream>(_fname);
+			if (_mis->mapped())
+				return *_mis;
+			_mis.reset();
 			_ifs.open(_fname, ios::binary);
+		}
 		else {
 #ifdef _WIN32
 			if (_setmode(_fileno(stdin), _O_BINARY) == -1)
 				throw MessageException("can't open stdin in binary mode");
 #endif
-			if (!_tmpfile.create())
-				throw MessageException("can't create temporary file for writing");
 			if (showMessages)
 				Message::mstream() << "reading from " << getMessageFileName() << '\n';
-			char buf[1024];
-			while (cin) {
-				cin.read(buf, 1024);
-				size_t count = cin.gcount();
-				if (!_tmpfile.write(buf, count))
-					throw MessageException("failed to write data to temporary file");
-			}
-			_ifs.open(_tmpfile.path(), ios::binary);
+			// buffer the incoming data in memory so that reading can start
+			// before stdin is exhausted; the data is only spilled to a
+			// temporary file if it exceeds the memory threshold
+			_sis = util::make_unique<StdinInputStream>(_tmpfile);
+			return *_sis;
 		}
 	}
 	return _ifs;
@@ -145,6 +282,11 @@ string SourceInput::getMessageFileName () const {
 }
 
 
-string SourceInput::getFilePath () const {
+/** Returns the path of a file containing the input data. If the data was
+ *  piped to stdin and is still held in memory, it's written to the
+ *  temporary file first. */
+string SourceInput::getFilePath () {
+	if (_sis && !_sis->writeToFile())
+		throw MessageException("failed to write data to temporary file");
 	return _tmpfile.path().empty() ? _fname : _tmpfile.path();
 }
@@ -22,7 +22,13 @@
 #define SOURCEINPUT_HPP
 
 #include <fstream>
+#include <istream>
+#include <memory>
+#include <streambuf>
 #include <string>
+#include <vector>
+
+class MappedInputStream;
 
 
 /** Helper class to handle temporary files. */
@@ -41,17 +47,71 @@ class TemporaryFile {
 };
 
 
+/** Stream buffer that reads data piped to stdin. The incoming bytes are
+ *  buffered in memory on demand so that reading can start while the data
+ *  is still arriving. Only if the amount of data exceeds a given threshold,
+ *  the complete stream is spilled to a temporary file and all further read
+ *  operations are redirected to that file. */
+class StdinStreamBuffer : public std::streambuf {
+	public:
+		static constexpr size_t DEFAULT_MAX_BUFFER_SIZE = 64*1024*1024;
+
+		explicit StdinStreamBuffer (TemporaryFile &tmpfile, size_t maxBufferSize=DEFAULT_MAX_BUFFER_SIZE)
+			: _tmpfile(tmpfile), _maxBufferSize(maxBufferSize) {}
+		bool spillToFile ();
+
+	protected:
+		int_type underflow () override;
+		pos_type seekoff (off_type off, std::ios_base::seekdir dir, std::ios_base::openmode mode) override;
+		pos_type seekpos (pos_type pos, std::ios_base::openmode mode) override;
+		std::streamsize showmanyc () override {return egptr()-gptr();}
+		bool spilled () const {return _filebuf.is_open();}
+		size_t position ();
+		void fillBuffer (size_t size, size_t pos);
+		bool spillToFile (size_t pos);
+
+	private:
+		TemporaryFile &_tmpfile;    ///< takes the data if it exceeds the memory threshold
+		size_t _maxBufferSize;      ///< maximum number of bytes buffered in memory
+		std::vector<char> _buffer;  ///< data read from stdin so far
+		bool _stdinDrained=false;   ///< true if stdin is exhausted
+		std::filebuf _filebuf;      ///< read channel of the temporary file after spilling
+		size_t _filesize=0;         ///< number of bytes written to the temporary file
+		char _chunk[16384];         ///< get area used after spilling to the temporary file
+};
+
+
+/** Input stream reading data piped to stdin. In contrast to writing the
+ *  complete stream to a temporary file ahead of the conversion, the data
+ *  is buffered in memory so that processing can begin before stdin is
+ *  exhausted, and small inputs never touch the disk. */
+class StdinInputStream : public std::istream {
+	public:
+		explicit StdinInputStream (TemporaryFile &tmpfile) : std::istream(nullptr), _streambuf(tmpfile) {
+			rdbuf(&_streambuf);
+		}
+		StdinInputStream (const StdinInputStream&) =delete;
+		bool writeToFile () {return _streambuf.spillToFile();}
+
+	private:
+		StdinStreamBuffer _streambuf;
+};
+
+
 class SourceInput {
 	public:
-		explicit SourceInput (const std::string &fname) : _fname(fname) {}
+		explicit SourceInput (const std::string &fname);
+		~SourceInput ();
 		std::istream& getInputStream (bool showMessages=false);
 		std::string getFileName () const;
 		std::string getMessageFileName () const;
-		std::string getFilePath () const;
+		std::string getFilePath ();
 
 	private:
 		const std::string &_fname; ///< name of file to read from
-		TemporaryFile _tmpfile;    ///< temporary file used when reading from stdin
+		TemporaryFile _tmpfile;    ///< temporary file used when the stdin data must be present on disk
+		std::unique_ptr<MappedInputStream> _mis;  ///< memory-mapped input used for regular files
+		std::unique_ptr<StdinInputStream> _sis;   ///< buffered input used when reading from stdin
 		std::ifstream _ifs;
 };
 
@@ -35,6 +35,7 @@ class SpecialHandler {
 		virtual const char* name () const =0;
 		virtual std::vector<const char*> prefixes () const =0;
 		virtual void setDviScaleFactor (double dvi2bp) {}
+		virtual bool requiresPreprocessing () const {return false;}
 		virtual void preprocess (const std::string &prefix, std::istream &is, SpecialActions &actions) {}
 		virtual bool process (const std::string &prefix, std::istream &is, SpecialActions &actions) =0;
 		virtual void dviPreprocessingFinished () {}
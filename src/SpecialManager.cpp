@@ -18,12 +18,16 @@
 ** along with this program; if not, see <http://www.gnu.org/licenses/>. **
 *************************************************************************/
 
+#include <chrono>
 #include <iomanip>
 #include <map>
 #include <sstream>
+#include "RunStats.hpp"
 #include "SpecialActions.hpp"
 #include "SpecialHandler.hpp"
 #include "SpecialManager.hpp"
+#include "Timing.hpp"
+#include "Tracepoints.hpp"
 
 using namespace std;
 
@@ -36,6 +40,69 @@ SpecialManager& SpecialManager::instance() {
 }
 
 
+/** Adds a prefix to the trie and assigns a handler to its final node. */
+void SpecialManager::PrefixTrie::insert (const char *prefix, SpecialHandler *handler) {
+	size_t node = 0;
+	for (const char *p = prefix; *p; p++) {
+		size_t next = 0;
+		for (size_t childIndex : _nodes[node].children) {
+			if (_nodes[childIndex].cc == *p) {
+				next = childIndex;
+				break;
+			}
+		}
+		if (next == 0) {
+			_nodes.emplace_back(Node(*p));
+			next = _nodes.size()-1;
+			_nodes[node].children.push_back(next);
+		}
+		node = next;
+	}
+	_nodes[node].handler = handler;
+}
+
+
+/** Removes the handler assigned to a prefix. The trie nodes themselves are kept. */
+void SpecialManager::PrefixTrie::remove (const char *prefix) {
+	size_t node = 0;
+	for (const char *p = prefix; *p; p++) {
+		size_t next = 0;
+		for (size_t childIndex : _nodes[node].children) {
+			if (_nodes[childIndex].cc == *p) {
+				next = childIndex;
+				break;
+			}
+		}
+		if (next == 0)
+			return;
+		node = next;
+	}
+	_nodes[node].handler = nullptr;
+}
+
+
+/** Looks up the handler assigned to a prefix given by a character sequence.
+ *  @param[in] str pointer to the first character of the prefix
+ *  @param[in] len number of characters the prefix consists of
+ *  @return pointer to the registered handler, nullptr if there is none */
+SpecialHandler* SpecialManager::PrefixTrie::find (const char *str, size_t len) const {
+	size_t node = 0;
+	for (size_t i=0; i < len; i++) {
+		size_t next = 0;
+		for (size_t childIndex : _nodes[node].children) {
+			if (_nodes[childIndex].cc == str[i]) {
+				next = childIndex;
+				break;
+			}
+		}
+		if (next == 0)
+			return nullptr;
+		node = next;
+	}
+	return _nodes[node].handler;
+}
+
+
 /** Remove all registered handlers. */
 void SpecialManager::unregisterHandlers () {
 	_handlerPool.clear();
@@ -50,7 +117,7 @@ void SpecialManager::registerHandler (unique_ptr<SpecialHandler> handler) {
 	if (handler) {
 		// get array of prefixes this handler is responsible for
 		for (const char *prefix : handler->prefixes())
-			_handlersByPrefix[prefix] = handler.get();
+			_handlersByPrefix.insert(prefix, handler.get());
 		_handlerPool.emplace_back(std::move(handler));
 	}
 }
@@ -92,7 +159,7 @@ void SpecialManager::unregisterHandler (SpecialHandler *handler) {
 		});
 		if (it != _handlerPool.end()) {
 			for (const char *prefix : handler->prefixes())
-				_handlersByPrefix.erase(prefix);
+				_handlersByPrefix.remove(prefix);
 			_handlerPool.erase(it);
 		}
 	}
@@ -103,10 +170,7 @@ void SpecialManager::unregisterHandler (SpecialHandler *handler) {
  *  @param[in] prefix the special prefix, e.g. "color" or "em"
  *  @return in case of success: pointer to handler, 0 otherwise */
 SpecialHandler* SpecialManager::findHandlerByPrefix (const string &prefix) const {
-	auto it = _handlersByPrefix.find(prefix);
-	if (it != _handlersByPrefix.end())
-		return it->second;
-	return nullptr;
+	return _handlersByPrefix.find(prefix.c_str(), prefix.length());
 }
 
 
@@ -122,24 +186,52 @@ SpecialHandler* SpecialManager::findHandlerByName (const string &name) const {
 }
 
 
-static string extract_prefix (istream &is) {
-	int c;
-	string prefix;
-	while (isalnum(c=is.get()))
-		prefix += char(c);
-	if (ispunct(c)) // also add separation character to identifying prefix
-		prefix += char(c);
-	if (prefix == "ps:" && is.peek() == ':')
-		prefix += char(is.get());
-	return prefix;
+/** Returns the length of the prefix that identifies the handler of a special.
+ *  The prefix consists of a sequence of alphanumeric characters, optionally
+ *  followed by a single separating punctuation character ("ps::" is treated
+ *  specially). The function only inspects the character buffer of the special
+ *  and doesn't create any temporary objects. */
+static size_t prefix_length (const string &special) {
+	size_t len = 0;
+	while (len < special.length() && isalnum(static_cast<unsigned char>(special[len])))
+		len++;
+	if (len < special.length() && ispunct(static_cast<unsigned char>(special[len]))) {
+		len++;  // also add separation character to identifying prefix
+		if (len == 3 && special[3] == ':' && special.compare(0, 3, "ps:") == 0)
+			len++;
+	}
+	return len;
+}
+
+
+/** Returns the stream position where the parameters of a special start,
+ *  i.e. the prefix plus a potential separation character that doesn't
+ *  belong to the prefix itself. */
+static size_t params_pos (const string &special, size_t prefixlen) {
+	if (prefixlen < special.length() && (prefixlen == 0 || !ispunct(static_cast<unsigned char>(special[prefixlen-1]))))
+		return prefixlen+1;  // skip the separation character that terminated the prefix
+	return prefixlen;
+}
+
+
+/** Returns true if any of the registered handlers collects data in a
+ *  preprocessing step, i.e. the DVI file must be scanned before the
+ *  actual conversion starts. */
+bool SpecialManager::preprocessingRequired () const {
+	for (const auto &handler : _handlerPool)
+		if (handler->requiresPreprocessing())
+			return true;
+	return false;
 }
 
 
 void SpecialManager::preprocess (const string &special, SpecialActions &actions) const {
-	istringstream iss(special);
-	const string prefix = extract_prefix(iss);
-	if (SpecialHandler *handler = findHandlerByPrefix(prefix))
-		handler->preprocess(prefix, iss, actions);
+	size_t prefixlen = prefix_length(special);
+	if (SpecialHandler *handler = _handlersByPrefix.find(special.c_str(), prefixlen)) {
+		istringstream iss(special);
+		iss.seekg(streamoff(params_pos(special, prefixlen)));
+		handler->preprocess(special.substr(0, prefixlen), iss, actions);
+	}
 }
 
 
@@ -150,12 +242,25 @@ void SpecialManager::preprocess (const string &special, SpecialActions &actions)
  *  @return true if the special could be processed successfully
  *  @throw SpecialException in case of errors during special processing */
 bool SpecialManager::process (const string &special, double dvi2bp, SpecialActions &actions) const {
-	istringstream iss(special);
-	const string prefix = extract_prefix(iss);
+	size_t prefixlen = prefix_length(special);
 	bool success=false;
-	if (SpecialHandler *handler = findHandlerByPrefix(prefix)) {
+	if (SpecialHandler *handler = _handlersByPrefix.find(special.c_str(), prefixlen)) {
+		RunStats::count(RunStats::Counter::SPECIALS);
+		DVISVGM_PROBE2(special_dispatch, handler->name(), special.length());
+		Timing::Scope timer("specials");
+		Timing::Scope handlerTimer(Timing::ENABLED || Timing::TRACING ? "specials:"+string(handler->name()) : string());
+		auto startTime = chrono::steady_clock::now();
+		istringstream iss(special);
+		iss.seekg(streamoff(params_pos(special, prefixlen)));
 		handler->setDviScaleFactor(dvi2bp);
-		success = handler->process(prefix, iss, actions);
+		success = handler->process(special.substr(0, prefixlen), iss, actions);
+		if (Timing::ENABLED) {
+			// attribute the time spent in the handler (including synchronous Ghostscript
+			// calls) to the special itself so that single pathological specials show up
+			// in the hotspot section of the timing report
+			double seconds = chrono::duration<double>(chrono::steady_clock::now()-startTime).count();
+			Timing::addHotspot(actions.getCurrentPageNumber(), special.substr(0, 80), seconds);
+		}
 	}
 	return success;
 }
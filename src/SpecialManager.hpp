@@ -25,7 +25,6 @@
 #include <memory>
 #include <ostream>
 #include <string>
-#include <unordered_map>
 #include <vector>
 #include "SpecialHandler.hpp"
 #include "utility.hpp"
@@ -35,7 +34,26 @@ class SpecialActions;
 class SpecialManager {
 	private:
 		using HandlerPool = std::vector<std::unique_ptr<SpecialHandler>>;
-		using HandlerMap = std::unordered_map<std::string,SpecialHandler*>;
+
+		/** Maps special prefixes to their handlers. The prefixes are organized in
+		 *  a trie so that a lookup can walk the raw character buffer of a special
+		 *  without creating temporary objects or hashing the prefix string. */
+		class PrefixTrie {
+			public:
+				void insert (const char *prefix, SpecialHandler *handler);
+				void remove (const char *prefix);
+				void clear ()  {_nodes.assign(1, Node('\0'));}
+				SpecialHandler* find (const char *str, size_t len) const;
+
+			private:
+				struct Node {
+					explicit Node (char c) : cc(c) {}
+					char cc;                          ///< character assigned to the node
+					SpecialHandler *handler=nullptr;  ///< handler registered for the prefix ending at this node
+					std::vector<size_t> children;     ///< indexes of the child nodes
+				};
+				std::vector<Node> _nodes = {Node('\0')};  ///< the trie nodes, entry 0 is the root
+		};
 
 	public:
 		SpecialManager (const SpecialManager &) =delete;
@@ -53,6 +71,7 @@ class SpecialManager {
 		void registerHandlers (std::vector<std::unique_ptr<SpecialHandler>> &handlers, const char *ignorelist);
 		void unregisterHandler (SpecialHandler *handler);
 		void unregisterHandlers ();
+		bool preprocessingRequired () const;
 		void preprocess (const std::string &special, SpecialActions &actions) const;
 		bool process (const std::string &special, double dvi2bp, SpecialActions &actions) const;
 		void notifyPreprocessingFinished () const;
@@ -67,8 +86,8 @@ class SpecialManager {
 		SpecialHandler* findHandlerByPrefix (const std::string &prefix) const;
 
 	private:
-		HandlerPool _handlerPool;      ///< stores pointers to all handlers
-		HandlerMap _handlersByPrefix;  ///< pointers to handlers for corresponding prefixes
+		HandlerPool _handlerPool;        ///< stores pointers to all handlers
+		PrefixTrie _handlersByPrefix;    ///< pointers to handlers for corresponding prefixes
 };
 
 #endif
@@ -38,11 +38,14 @@ istream& StreamReader::replaceStream (istream &in) {
  *  @param[in] bytes number of bytes to read (max. 4)
  *  @return read integer */
 uint32_t StreamReader::readUnsigned (int bytes) {
+	// fetch all bytes with a single read operation instead of issuing
+	// one get() per byte, which reduces the stream overhead significantly
+	char buf[4];
+	_is->read(buf, min(4, bytes));
+	auto count = size_t(_is->gcount());
 	uint32_t ret = 0;
-	for (bytes--; bytes >= 0 && !_is->eof(); bytes--) {
-		auto b = uint32_t(_is->get());
-		ret |= b << (8*bytes);
-	}
+	for (size_t i=0; i < count; i++)
+		ret |= uint32_t(uint8_t(buf[i])) << (8*(bytes-1-int(i)));
 	return ret;
 }
 
@@ -62,11 +65,12 @@ uint32_t StreamReader::readUnsigned (int n, HashFunction &hashfunc) {
  *  @param[in] bytes number of bytes to read (max. 4)
  *  @return read integer */
 int32_t StreamReader::readSigned (int bytes) {
-	auto ret = uint32_t(_is->get());
-	if (ret & 128)        // negative value?
-		ret |= 0xffffff00;
-	for (bytes-=2; bytes >= 0 && !_is->eof(); bytes--)
-		ret = (ret << 8) | _is->get();
+	char buf[4];
+	_is->read(buf, min(4, bytes));
+	auto count = size_t(_is->gcount());
+	auto ret = uint32_t(count > 0 ? int32_t(int8_t(buf[0])) : -1);  // sign-extend the leading byte
+	for (size_t i=1; i < count; i++)
+		ret = (ret << 8) | uint8_t(buf[i]);
 	return int32_t(ret);
 }
 
@@ -100,9 +104,9 @@ string StreamReader::readString () {
  *  @return the string read */
 string StreamReader::readString (HashFunction &hashfunc, bool finalZero) {
 	string ret = readString();
-	hashfunc.update(ret.data(), ret.length());
-	if (finalZero)
-		hashfunc.update(nullptr, 1);
+	// ret.data() is null-terminated, so the final 0-byte can be included
+	// by extending the hashed range by one character
+	hashfunc.update(ret.data(), ret.length() + (finalZero ? 1 : 0));
 	return ret;
 }
 
@@ -146,6 +150,24 @@ vector<uint8_t> StreamReader::readBytes (int n, HashFunction &hashfunc) {
 }
 
 
+/** Reads a sequence of n 4-byte big-endian words with a single block read
+ *  and decodes them from the internal buffer. Words that can't be read
+ *  completely due to EOF are set to 0.
+ *  @param[in] n number of words to read
+ *  @return the words read */
+vector<uint32_t> StreamReader::readWords (size_t n) {
+	vector<char> buf(4*n);
+	_is->read(buf.data(), streamsize(buf.size()));
+	auto complete = size_t(_is->gcount())/4;
+	vector<uint32_t> words(n);
+	for (size_t i=0; i < complete; i++) {
+		auto *bytes = reinterpret_cast<const uint8_t*>(buf.data())+4*i;
+		words[i] = (uint32_t(bytes[0]) << 24) | (uint32_t(bytes[1]) << 16) | (uint32_t(bytes[2]) << 8) | bytes[3];
+	}
+	return words;
+}
+
+
 vector<char> StreamReader::readBytesAsChars (int n) {
 	vector<char> chars(n);
 	if (n > 0)
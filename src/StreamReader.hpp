@@ -47,6 +47,7 @@ class StreamReader {
 		std::vector<uint8_t> readBytes (int n);
 		std::vector<uint8_t> readBytes (int n, HashFunction &hash);
 		std::vector<char> readBytesAsChars (int n);
+		std::vector<uint32_t> readWords (size_t n);
 		int readByte ()                 {return _is->get();}
 		int readByte (HashFunction &hashfunc);
 		void seek (std::streampos pos, std::ios::seekdir dir) {_is->seekg(pos, dir);}
@@ -24,13 +24,25 @@
 #include <limits>
 #include <memory>
 #include "FileFinder.hpp"
+#include "FilePath.hpp"
+#include "FileSystem.hpp"
+#include "Font.hpp"
 #include "Message.hpp"
+#include "StreamReader.hpp"
+#include "StreamWriter.hpp"
 #include "Subfont.hpp"
 #include "utility.hpp"
+#include "XXHashFunction.hpp"
 
 
 using namespace std;
 
+const uint8_t SFDCACHE_FORMAT_VERSION = 1;
+
+// Only cache .sfd files of a certain minimum size. Parsing smaller files
+// doesn't take long enough to benefit from a binary representation.
+const uint64_t MIN_CACHEABLE_SFDFILE_SIZE = 4096;
+
 // helper functions
 
 static int skip_mapping_data (istream &is);
@@ -41,6 +53,8 @@ static bool scan_line (const char *line, int lineno, vector<uint16_t> &mapping,
  *  @param[in] name name of subfont definition
  *  @param[in] fpath path to corresponding .sfd file*/
 SubfontDefinition::SubfontDefinition (string name, const char *fpath) : _sfname(std::move(name)) {
+	if (readFromCache(fpath))
+		return;
 	// read all subfont IDs from the .sfd file but skip the mapping data
 	ifstream is(fpath);
 	while (is) {
@@ -60,6 +74,109 @@ SubfontDefinition::SubfontDefinition (string name, const char *fpath) : _sfname(
 			}
 		}
 	}
+	writeCache(fpath);
+}
+
+
+static void write_uint64 (StreamWriter &sw, HashFunction &hashfunc, uint64_t val) {
+	sw.writeUnsigned(uint32_t(val >> 32), 4, hashfunc);
+	sw.writeUnsigned(uint32_t(val & 0xFFFFFFFF), 4, hashfunc);
+}
+
+
+static uint64_t read_uint64 (StreamReader &sr) {
+	uint64_t val = uint64_t(sr.readUnsigned(4)) << 32;
+	return val | sr.readUnsigned(4);
+}
+
+
+/** Returns the path of the binary cache file assigned to a given .sfd file. */
+static string cache_file_path (const char *fpath) {
+	FilePath path(fpath);
+	XXH64HashFunction hashfunc(path.absolute());
+	ostringstream oss;
+	oss << PhysicalFont::CACHE_PATH << '/' << path.filename() << '-' << hex << hashfunc.digestValue() << ".bin";
+	return oss.str();
+}
+
+
+/** Tries to restore the subfonts and their mapping tables from the binary cache
+ *  representation of the .sfd file. The cached data is only used if its checksum
+ *  is valid and if it still refers to the current contents of the file.
+ *  @param[in] fpath path to the .sfd file the cache entry was created from
+ *  @return true if the subfont data was restored from the cache */
+bool SubfontDefinition::readFromCache (const char *fpath) {
+	if (PhysicalFont::CACHE_PATH.empty())
+		return false;
+	ifstream ifs(cache_file_path(fpath), ios::binary);
+	if (!ifs)
+		return false;
+	StreamReader sr(ifs);
+	if (sr.readUnsigned(1) != SFDCACHE_FORMAT_VERSION)
+		return false;
+	uint32_t checksum = sr.readUnsigned(4);
+	XXH32HashFunction hashfunc;
+	hashfunc.update(ifs);
+	if (hashfunc.digestValue() != checksum)
+		return false;
+	ifs.clear();
+	ifs.seekg(5);  // continue reading after the checksum
+	if (sr.readString() != FilePath(fpath).absolute())
+		return false;
+	if (int64_t(read_uint64(sr)) != FileSystem::mtime(fpath) || read_uint64(sr) != FileSystem::filesize(fpath))
+		return false;  // .sfd file has changed? => cached data is stale
+	auto numSubfonts = sr.readUnsigned(4);
+	while (numSubfonts-- > 0) {
+		string id = sr.readString();
+		auto state = _subfonts.emplace(id, unique_ptr<Subfont>());
+		if (state.second)
+			state.first->second = unique_ptr<Subfont>(new Subfont(*this, state.first->first));
+		Subfont *subfont = state.first->second.get();
+		subfont->_mapping.resize(256);
+		for (uint16_t &value : subfont->_mapping)
+			value = uint16_t(sr.readUnsigned(2));
+	}
+	return true;
+}
+
+
+/** Writes the binary representation of the subfont data to the cache directory.
+ *  Since the cache file must be complete, the mapping tables of all subfonts are
+ *  parsed at this point rather than on demand. Malformed .sfd files are left to
+ *  the lazy parser so that their errors keep being reported when the broken
+ *  subfont is actually used.
+ *  @param[in] fpath path to the .sfd file the data was read from */
+void SubfontDefinition::writeCache (const char *fpath) const {
+	if (PhysicalFont::CACHE_PATH.empty() || FileSystem::filesize(fpath) < MIN_CACHEABLE_SFDFILE_SIZE)
+		return;
+	for (const auto &strsfpair : _subfonts) {
+		try {
+			if (!strsfpair.second->read())
+				return;
+		}
+		catch (SubfontException &) {
+			strsfpair.second->_mapping.clear();  // drop partially filled table
+			return;
+		}
+	}
+	ofstream ofs(cache_file_path(fpath), ios::binary);
+	if (!ofs)
+		return;
+	StreamWriter sw(ofs);
+	XXH32HashFunction hashfunc;
+	sw.writeUnsigned(SFDCACHE_FORMAT_VERSION, 1);
+	sw.writeUnsigned(0, 4);  // space for checksum to be written below
+	sw.writeString(FilePath(fpath).absolute(), hashfunc, true);
+	write_uint64(sw, hashfunc, uint64_t(FileSystem::mtime(fpath)));
+	write_uint64(sw, hashfunc, FileSystem::filesize(fpath));
+	sw.writeUnsigned(uint32_t(_subfonts.size()), 4, hashfunc);
+	for (const auto &strsfpair : _subfonts) {
+		sw.writeString(strsfpair.first, hashfunc, true);
+		for (uint16_t value : strsfpair.second->_mapping)
+			sw.writeUnsigned(value, 2, hashfunc);
+	}
+	ofs.seekp(1);
+	sw.writeUnsigned(hashfunc.digestValue(), 4);  // patch checksum of the data written
 }
 
 
@@ -50,6 +50,9 @@ class SubfontDefinition {
 		SubfontDefinition (std::string name, const char *fpath);
 
 	private:
+		bool readFromCache (const char *fpath);
+		void writeCache (const char *fpath) const;
+
 		std::string _sfname; ///< name of subfont
 		Subfonts _subfonts;  ///< all subfonts defined in the corresponding .sfd file
 };
@@ -19,7 +19,9 @@
 *************************************************************************/
 
 #include <config.h>
+#include <algorithm>
 #include <ctime>
+#include <thread>
 #include "System.hpp"
 
 #if defined (HAVE_SYS_TIME_H)
@@ -28,6 +30,17 @@
 #include <sys/timeb.h>
 #endif
 
+#if defined (__linux__)
+#include <cstdio>
+#include <sched.h>
+#include <unistd.h>
+#elif defined (__APPLE__)
+#include <mach/mach.h>
+#elif defined (_WIN32)
+#include <windows.h>
+#include <psapi.h>
+#endif
+
 
 using namespace std;
 
@@ -47,3 +60,56 @@ double System::time () {
 	return double(myclock)/CLOCKS_PER_SEC;
 #endif
 }
+
+
+/** Returns the number of CPUs the process is allowed to run on. In contrast
+ *  to std::thread::hardware_concurrency(), the CPU affinity mask assigned to
+ *  the process (e.g. by taskset or a container runtime) is taken into account,
+ *  so the result reflects the parallelism actually available. */
+int System::numberOfCPUs () {
+#if defined (__linux__)
+	cpu_set_t cpuset;
+	if (sched_getaffinity(0, sizeof(cpuset), &cpuset) == 0)
+		return max(1, CPU_COUNT(&cpuset));
+#elif defined (_WIN32)
+	DWORD_PTR processMask, systemMask;
+	if (GetProcessAffinityMask(GetCurrentProcess(), &processMask, &systemMask)) {
+		int count = 0;
+		for (; processMask; processMask >>= 1)
+			count += int(processMask & 1);
+		if (count > 0)
+			return count;
+	}
+#endif
+	return max(1u, thread::hardware_concurrency());
+}
+
+
+/** Returns the current resident set size of the process in bytes, i.e. the
+ *  amount of physical memory it occupies. If the value can't be determined
+ *  on the current platform, 0 is returned. */
+size_t System::processMemory () {
+#if defined (__linux__)
+	size_t result=0;
+	if (FILE *file = fopen("/proc/self/statm", "r")) {
+		unsigned long totalPages, residentPages;
+		if (fscanf(file, "%lu %lu", &totalPages, &residentPages) == 2)
+			result = size_t(residentPages)*size_t(sysconf(_SC_PAGESIZE));
+		fclose(file);
+	}
+	return result;
+#elif defined (__APPLE__)
+	mach_task_basic_info info;
+	mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+	if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, reinterpret_cast<task_info_t>(&info), &count) == KERN_SUCCESS)
+		return size_t(info.resident_size);
+	return 0;
+#elif defined (_WIN32)
+	PROCESS_MEMORY_COUNTERS pmc;
+	if (GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc)))
+		return size_t(pmc.WorkingSetSize);
+	return 0;
+#else
+	return 0;
+#endif
+}
@@ -21,9 +21,13 @@
 #ifndef SYSTEM_HPP
 #define SYSTEM_HPP
 
+#include <cstddef>
+
 namespace System
 {
 	double time ();
+	int numberOfCPUs ();
+	size_t processMemory ();
 }
 
 #endif
@@ -28,15 +28,14 @@
 using namespace std;
 
 
-/** Reads a sequence of n TFM words (4 Bytes each).
+/** Reads a sequence of n TFM words (4 Bytes each) in a single block operation.
  *  @param[in]  reader the TFM data is read from this object
  *  @param[out] v the read words
  *  @param[in]  n number of words to be read */
 template <typename T>
 static void read_words (StreamReader &reader, vector<T> &v, unsigned n) {
-	v.resize(n);
-	for (unsigned i=0; i < n; i++)
-		v[i] = reader.readUnsigned(4);
+	vector<uint32_t> words = reader.readWords(n);
+	v.assign(words.begin(), words.end());
 }
 
 
@@ -64,10 +63,44 @@ void TFM::read (istream &is) {
 	_firstChar = bc;
 	_lastChar = ec;
 	readHeader(reader);
-	is.seekg(24+lh*4);  // move to char info table
-	readTables(reader, nw, nh, nd, ni);
-	is.seekg(4*(lf-np));  // move to param section
-	readParameters(reader, np);
+	setTableInfo(24+4*streamoff(lh), 4*streamoff(lf-np), nw, nh, nd, ni, np);
+	if (&is != ownedStream())  // stream not kept open beyond this call?
+		decodeTables(is);       // decode the tables immediately
+}
+
+
+/** Records the file positions and sizes of the metric tables and marks them
+ *  as not yet decoded. If the metrics object owns the stream it was created
+ *  from, the actual decoding is deferred until a table value is accessed. */
+void TFM::setTableInfo (streamoff tablesPos, streamoff paramsPos, int nw, int nh, int nd, int ni, int np) {
+	_tablesPos = tablesPos;
+	_paramsPos = paramsPos;
+	_nw = uint16_t(nw);
+	_nh = uint16_t(nh);
+	_nd = uint16_t(nd);
+	_ni = uint16_t(ni);
+	_np = uint16_t(np);
+	_tablesRead = false;
+}
+
+
+/** Reads and decodes the metric tables and font parameters.
+ *  @param[in] is stream to read the table data from */
+void TFM::decodeTables (istream &is) const {
+	is.clear();
+	is.seekg(_tablesPos);  // move to char info table
+	StreamReader reader(is);
+	readTables(reader);
+	is.seekg(_paramsPos);  // move to param section
+	readParameters(reader, _np);
+	_tablesRead = true;
+}
+
+
+/** Ensures that the metric tables have been decoded. */
+void TFM::ensureTables () const {
+	if (!_tablesRead && ownedStream())
+		decodeTables(*ownedStream());
 }
 
 
@@ -77,12 +110,12 @@ void TFM::readHeader (StreamReader &reader) {
 }
 
 
-void TFM::readTables (StreamReader &reader, int nw, int nh, int nd, int ni) {
+void TFM::readTables (StreamReader &reader) const {
 	read_words(reader, _charInfoTable, _lastChar-_firstChar+1);
-	read_words(reader, _widthTable, nw);
-	read_words(reader, _heightTable, nh);
-	read_words(reader, _depthTable, nd);
-	read_words(reader, _italicTable, ni);
+	read_words(reader, _widthTable, _nw);
+	read_words(reader, _heightTable, _nh);
+	read_words(reader, _depthTable, _nd);
+	read_words(reader, _italicTable, _ni);
 	for (FixWord h : _heightTable)
 		_ascent = max(_ascent, h);
 	for (FixWord d : _depthTable)
@@ -93,7 +126,7 @@ void TFM::readTables (StreamReader &reader, int nw, int nh, int nd, int ni) {
 /** Read the values from the param section of the TFM file.
  *  @param[in] reader read from this stream
  *  @param[in] np number of paramaters to read */
-void TFM::readParameters (StreamReader &reader, int np) {
+void TFM::readParameters (StreamReader &reader, int np) const {
 	_params.resize(7);
 	np = min(np, 7);
 	for (int i=0; i < np; i++)
@@ -105,24 +138,28 @@ void TFM::readParameters (StreamReader &reader, int np) {
 
 /** Returns the optimal space width between words (in PS point units). */
 double TFM::getSpace () const {
+	ensureTables();
 	return _params.empty() ? 0 : double(_params[1])*_designSize;
 }
 
 
 /** Returns the amount of glue stretching between words (in PS point units). */
 double TFM::getSpaceStretch () const {
+	ensureTables();
 	return _params.empty() ? 0 : double(_params[2])*_designSize;
 }
 
 
 /** Returns the amount of glue shrinking between words (in PS point units). */
 double TFM::getSpaceShrink () const {
+	ensureTables();
 	return _params.empty() ? 0 : double(_params[3])*_designSize;
 }
 
 
 /** Returns the size of one EM unit (in PS point units). */
 double TFM::getQuad () const {
+	ensureTables();
 	if (_params.empty() || _params[5] == 0)
 		return _designSize;
 	return double(_params[5])*_designSize;
@@ -133,6 +170,7 @@ double TFM::getQuad () const {
  *  @param[in] c character whose index is retrieved
  *  @return table index for character c, or -1 if there's no entry */
 size_t TFM::charIndex (int c) const {
+	ensureTables();
 	if (c < _firstChar || c > _lastChar || size_t(c-_firstChar) >= _charInfoTable.size())
 		return -1;
 	return c-_firstChar;
@@ -43,8 +43,8 @@ class TFM : public FontMetrics {
 		double getSpaceStretch () const override;
 		double getSpaceShrink () const override;
 		double getQuad () const override;
-		double getAscent () const override     {return double(_ascent)*_designSize;}
-		double getDescent () const override    {return double(_descent)*_designSize;}
+		double getAscent () const override     {ensureTables(); return double(_ascent)*_designSize;}
+		double getDescent () const override    {ensureTables(); return double(_descent)*_designSize;}
 		bool verticalLayout () const override  {return false;}
 		uint32_t getChecksum () const override {return _checksum;}
 		uint32_t firstChar () const override   {return _firstChar;}
@@ -52,8 +52,11 @@ class TFM : public FontMetrics {
 
 	protected:
 		void readHeader (StreamReader &reader);
-		void readTables (StreamReader &reader, int nw, int nh, int nd, int ni);
-		void readParameters (StreamReader &reader, int np);
+		virtual void readTables (StreamReader &reader) const;
+		void readParameters (StreamReader &reader, int np) const;
+		void setTableInfo (std::streamoff tablesPos, std::streamoff paramsPos, int nw, int nh, int nd, int ni, int np);
+		void decodeTables (std::istream &is) const;
+		void ensureTables () const;
 		virtual size_t charIndex (int c) const;
 		void setCharRange (int firstchar, int lastchar) {_firstChar=firstchar; _lastChar=lastchar;}
 
@@ -61,13 +64,17 @@ class TFM : public FontMetrics {
 		uint32_t _checksum=0;
 		uint16_t _firstChar=0, _lastChar=0;
 		double _designSize=0;  ///< design size of the font in PS points (72bp = 1in)
-		std::vector<uint32_t>  _charInfoTable;
-		std::vector<FixWord> _widthTable;    ///< character widths in design size units
-		std::vector<FixWord> _heightTable;   ///< character height in design size units
-		std::vector<FixWord> _depthTable;    ///< character depth in design size units
-		std::vector<FixWord> _italicTable;   ///< italic corrections in design size units
-		std::vector<FixWord> _params;        ///< values of the TFM's param section
-		FixWord _ascent=0, _descent=0;       ///< max. height and depth
+		std::streamoff _tablesPos=0;  ///< file offset of the char-info table
+		std::streamoff _paramsPos=0;  ///< file offset of the param section
+		uint16_t _nw=0, _nh=0, _nd=0, _ni=0, _np=0;  ///< sizes of the metric tables
+		mutable bool _tablesRead=true;  ///< true if the metric tables have been decoded
+		mutable std::vector<uint32_t>  _charInfoTable;
+		mutable std::vector<FixWord> _widthTable;    ///< character widths in design size units
+		mutable std::vector<FixWord> _heightTable;   ///< character height in design size units
+		mutable std::vector<FixWord> _depthTable;    ///< character depth in design size units
+		mutable std::vector<FixWord> _italicTable;   ///< italic corrections in design size units
+		mutable std::vector<FixWord> _params;        ///< values of the TFM's param section
+		mutable FixWord _ascent=0, _descent=0;       ///< max. height and depth
 };
 
 #endif
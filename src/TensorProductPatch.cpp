@@ -18,8 +18,10 @@
 ** along with this program; if not, see <http://www.gnu.org/licenses/>. **
 *************************************************************************/
 
+#include <sstream>
 #include <valarray>
 #include "TensorProductPatch.hpp"
+#include "XMLString.hpp"
 
 using namespace std;
 
@@ -180,6 +182,34 @@ GraphicsPath<double> TensorProductPatch::getBoundaryPath () const {
 }
 
 
+/** Returns the SVG path data of a cubic Bézier edge leading to the next patch corner. */
+static string cubic_edge (const DPair &p1, const DPair &p2, const DPair &p3) {
+	ostringstream oss;
+	oss << 'C' << XMLString(p1.x()) << ' ' << XMLString(p1.y())
+		<< ' '  << XMLString(p2.x()) << ' ' << XMLString(p2.y())
+		<< ' '  << XMLString(p3.x()) << ' ' << XMLString(p3.y());
+	return oss.str();
+}
+
+
+/** Returns the corner colors and boundary curves of the patch arranged for SVG
+ *  mesh gradients. Since these only support Coons patches, the four inner control
+ *  points, which slightly affect the shading of proper tensor product patches,
+ *  can't be represented and are dropped. */
+ShadingPatch::MeshData TensorProductPatch::getMeshData () const {
+	MeshData mesh;
+	mesh.startPoint = _points[0][0];
+	mesh.stops.resize(4);
+	// edge curves in boundary order, each colored with the color of its starting
+	// corner, i.e. P(0,0), P(0,1), P(1,1), and P(1,0)
+	mesh.stops[0] = {cubic_edge(_points[0][1], _points[0][2], _points[0][3]), _colors[0]};
+	mesh.stops[1] = {cubic_edge(_points[1][3], _points[2][3], _points[3][3]), _colors[2]};
+	mesh.stops[2] = {cubic_edge(_points[3][2], _points[3][1], _points[3][0]), _colors[3]};
+	mesh.stops[3] = {cubic_edge(_points[2][0], _points[1][0], _points[0][0]), _colors[1]};
+	return mesh;
+}
+
+
 /** Computes the bicubically interpolated isoparametric Bézier curve P(u,t) that
  *  runs "vertically" from P(u,0) to P(u,1) through the patch P.
  *  @param[in] u "horizontal" parameter in the range from 0 to 1
@@ -328,6 +358,7 @@ void TensorProductPatch::approximate (int gridsize, bool overlap, double delta,
 		callback.patchSegment(path, _colors[0]);
 	}
 	else {
+		gridsize = adaptedGridsize(gridsize, {_colors[0], _colors[1], _colors[2], _colors[3]});
 		const double inc = 1.0/gridsize;
 		// collect curves dividing the patch into several columns (curved vertical stripes)
 		vector<CubicBezier> vbeziers(gridsize+1);
@@ -346,6 +377,17 @@ void TensorProductPatch::approximate (int gridsize, bool overlap, double delta,
 }
 
 
+/** Returns the approximate number of segments approximate() creates for a given grid size,
+ *  taking the adaptive reduction of the subdivision into account.
+ *  @param[in] gridsize number of segments per row/column */
+int TensorProductPatch::estimatedSegments (int gridsize) const {
+	if (_colors[0] == _colors[1] && _colors[1] == _colors[2] && _colors[2] == _colors[3])
+		return 1;  // monochromatic patches are represented by their boundary path only
+	gridsize = adaptedGridsize(gridsize, {_colors[0], _colors[1], _colors[2], _colors[3]});
+	return gridsize*gridsize;
+}
+
+
 BoundingBox TensorProductPatch::getBBox () const {
 	BoundingBox bbox;
 	CubicBezier bezier;
@@ -45,15 +45,17 @@ class TensorProductPatch : public ShadingPatch {
 		int psShadingType() const override {return 7;}
 		void setPoints (const PointVec &points, int edgeflag, ShadingPatch *patch) override;
 		void setColors (const ColorVec &colors, int edgeflag, ShadingPatch *patch) override;
-		virtual DPair valueAt (double u, double v) const;
-		Color colorAt (double u, double v) const;
+		DPair valueAt (double u, double v) const override;
+		Color colorAt (double u, double v) const override;
 		CubicBezier horizontalCurve (double v) const;
 		CubicBezier verticalCurve (double u) const;
 		GraphicsPath<double> getBoundaryPath () const override;
+		MeshData getMeshData () const override;
 		void subpatch (double u1, double u2, double v1, double v2, TensorProductPatch &patch) const;
 		DPair blossomValue (double u1, double u2, double u3, double v1, double v2, double v3) const;
 		DPair blossomValue (double u[3], double v[3]) const {return blossomValue(u[0], u[1], u[2], v[0], v[1], v[2]);}
 		void approximate (int gridsize, bool overlap, double delta, Callback &callback) const override;
+		int estimatedSegments (int gridsize) const override;
 		BoundingBox getBBox () const override;
 		int numPoints (int edgeflag) const override {return edgeflag == 0 ? 16 : 12;}
 		int numColors (int edgeflag) const override {return edgeflag == 0 ? 4 : 2;}
@@ -0,0 +1,206 @@
+/*************************************************************************
+** TextTemplate.cpp                                                     **
+**                                                                      **
+** This file is part of dvisvgm -- a fast DVI to SVG converter          **
+** Copyright (C) 2005-2024 Martin Gieseking <martin.gieseking@uos.de>   **
+**                                                                      **
+** This program is free software; you can redistribute it and/or        **
+** modify it under the terms of the GNU General Public License as       **
+** published by the Free Software Foundation; either version 3 of       **
+** the License, or (at your option) any later version.                  **
+**                                                                      **
+** This program is distributed in the hope that it will be useful, but  **
+** WITHOUT ANY WARRANTY; without even the implied warranty of           **
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the         **
+** GNU General Public License for more details.                         **
+**                                                                      **
+** You should have received a copy of the GNU General Public License    **
+** along with this program; if not, see <http://www.gnu.org/licenses/>. **
+*************************************************************************/
+
+#include <algorithm>
+#include <iterator>
+#include "SpecialActions.hpp"
+#include "TextTemplate.hpp"
+#include "utility.hpp"
+#include "XMLString.hpp"
+
+using namespace std;
+
+/** Names of the constants that can be referenced by {?name} macros. */
+static const char* CONSTANT_NAMES[] = {
+	"x", "y", "color", "fillcolor", "strokecolor", "matrix", "nl", "pageno", "svgfile", "svgpath"
+};
+
+
+/** Tries to parse a {?cmyk(c,m,y,k)} macro at position 'start' of a string.
+ *  @param[in] str string to parse
+ *  @param[in] start position of the leading "{?"
+ *  @param[out] cmykstr the "cmyk(...)" part of the macro in case of success
+ *  @return position directly after the macro, 0 if the macro is malformed */
+static size_t parse_cmyk (const string &str, size_t start, string &cmykstr) {
+	size_t pos = start+7;  // position after "{?cmyk("
+	for (int i=0; i < 3; i++) {  // three comma-terminated components
+		size_t len = 0;
+		while (pos+len < str.length() && (isdigit(str[pos+len]) || str[pos+len] == '.'))
+			len++;
+		if (len == 0 || pos+len >= str.length() || str[pos+len] != ',')
+			return 0;
+		pos += len+1;
+	}
+	// fourth component consisting of a single character
+	if (pos+2 >= str.length() || (!isdigit(str[pos]) && str[pos] != '.') || str[pos+1] != ')' || str[pos+2] != '}')
+		return 0;
+	cmykstr = str.substr(start+2, pos-start);  // "cmyk(...)" including the closing parenthesis
+	return pos+3;
+}
+
+
+/** Compiles the text into a sequence of literal and macro segments. */
+void TextTemplate::compile () const {
+	_segments.clear();
+	string literal;       // pending literal text
+	bool bboxAllowed = true;  // no {?bbox ...} macros after a malformed one
+	bool exprAllowed = true;  // no {?(...)} macros after an unterminated one
+	size_t pos = 0;
+	auto flush_literal = [&]() {
+		if (!literal.empty()) {
+			_segments.emplace_back(Segment::Type::LITERAL, std::move(literal));
+			literal.clear();
+		}
+	};
+	while (pos < _text.length()) {
+		size_t start = _text.find("{?", pos);
+		if (start == string::npos) {
+			literal += _text.substr(pos);
+			break;
+		}
+		literal += _text.substr(pos, start-pos);
+		pos = start+2;  // continue behind "{?" if no macro is recognized
+		if (exprAllowed && _text.compare(start+2, 1, "(") == 0) {
+			size_t right = _text.find(")}", start+2);
+			if (right == string::npos)
+				exprAllowed = false;
+			else {
+				string exprstr = _text.substr(start+3, right-start-3);
+				if (!util::normalize_space(exprstr).empty()) {  // drop empty expressions like {?( )}
+					flush_literal();
+					_segments.emplace_back(Segment::Type::EXPRESSION, exprstr);
+					try {
+						_segments.back().expr = Calculator::compile(exprstr);
+					}
+					catch (CalculatorException &e) {
+						_segments.pop_back();
+						throw SpecialException(string(e.what())+" in '{?("+exprstr+")}'");
+					}
+				}
+				pos = right+2;
+			}
+		}
+		else if (_text.compare(start+2, 5, "bbox ") == 0) {
+			size_t endpos = start+7;
+			while (endpos < _text.length() && isalnum(_text[endpos]))
+				endpos++;
+			if (endpos == _text.length() || _text[endpos] != '}')
+				bboxAllowed = false;
+			else if (bboxAllowed) {
+				flush_literal();
+				_segments.emplace_back(Segment::Type::BBOX, _text.substr(start+7, endpos-start-7));
+				pos = endpos+1;
+			}
+		}
+		else if (_text.compare(start+2, 5, "cmyk(") == 0) {
+			string cmykstr;
+			if (size_t endpos = parse_cmyk(_text, start, cmykstr)) {
+				literal += Color(cmykstr).rgbString();  // constant value, fold into the literal text
+				pos = endpos;
+			}
+		}
+		else {
+			size_t endpos = start+2;
+			while (endpos < _text.length() && isalnum(_text[endpos]))
+				endpos++;
+			if (endpos > start+2 && endpos < _text.length() && _text[endpos] == '}') {
+				string name = _text.substr(start+2, endpos-start-2);
+				if (find_if(begin(CONSTANT_NAMES), end(CONSTANT_NAMES), [&](const char *n) {return name == n;}) != end(CONSTANT_NAMES)) {
+					flush_literal();
+					_segments.emplace_back(Segment::Type::CONSTANT, std::move(name));
+					pos = endpos+1;
+				}
+			}
+		}
+		if (pos == start+2)
+			literal += "{?";  // no macro recognized, keep the text as is
+	}
+	if (!literal.empty())
+		_segments.emplace_back(Segment::Type::LITERAL, std::move(literal));
+	_compiled = true;
+}
+
+
+inline string get_color_string (SpecialActions &actions, Color (SpecialActions::*getColor)() const) {
+	return SVGElement::USE_CURRENTCOLOR && SVGElement::CURRENTCOLOR == (actions.*getColor)()
+		? "currentColor"
+		: (actions.*getColor)().svgColorString();
+}
+
+
+/** Returns the current value of a constant that can be referenced by {?name} macros. */
+static string constant_value (const string &name, SpecialActions &actions) {
+	if (name == "x")
+		return XMLString(actions.getX());
+	if (name == "y")
+		return XMLString(actions.getY());
+	if (name == "color" || name == "fillcolor")
+		return get_color_string(actions, &SpecialActions::getFillColor);
+	if (name == "strokecolor")
+		return get_color_string(actions, &SpecialActions::getStrokeColor);
+	if (name == "matrix")
+		return actions.getMatrix().toSVG();
+	if (name == "nl")
+		return "\n";
+	if (name == "pageno")
+		return to_string(actions.getCurrentPageNumber());
+	if (name == "svgfile")
+		return actions.getSVGFilePath(actions.getCurrentPageNumber()).relative();
+	if (name == "svgpath")
+		return actions.getSVGFilePath(actions.getCurrentPageNumber()).absolute();
+	return "";
+}
+
+
+/** Expands the macros embedded in the text and returns the result. The text
+ *  is compiled on the first call; further expansions reuse the segments.
+ *  @param[in] actions interface to the world outside the special handler
+ *  @return the expanded text */
+string TextTemplate::expand (SpecialActions &actions) const {
+	if (!_compiled)
+		compile();
+	string ret;
+	for (const Segment &segment : _segments) {
+		switch (segment.type) {
+			case Segment::Type::LITERAL:
+				ret += segment.text;
+				break;
+			case Segment::Type::CONSTANT:
+				ret += constant_value(segment.text, actions);
+				break;
+			case Segment::Type::BBOX:
+				ret += actions.bbox(segment.text).svgViewBoxString();
+				break;
+			case Segment::Type::EXPRESSION: {
+				Calculator calc;
+				calc.setVariable("x", actions.getX());
+				calc.setVariable("y", actions.getY());
+				try {
+					ret += XMLString(segment.expr.evaluate(calc));
+				}
+				catch (CalculatorException &e) {
+					throw SpecialException(string(e.what())+" in '{?("+segment.text+")}'");
+				}
+				break;
+			}
+		}
+	}
+	return ret;
+}
@@ -0,0 +1,59 @@
+/*************************************************************************
+** TextTemplate.hpp                                                     **
+**                                                                      **
+** This file is part of dvisvgm -- a fast DVI to SVG converter          **
+** Copyright (C) 2005-2024 Martin Gieseking <martin.gieseking@uos.de>   **
+**                                                                      **
+** This program is free software; you can redistribute it and/or        **
+** modify it under the terms of the GNU General Public License as       **
+** published by the Free Software Foundation; either version 3 of       **
+** the License, or (at your option) any later version.                  **
+**                                                                      **
+** This program is distributed in the hope that it will be useful, but  **
+** WITHOUT ANY WARRANTY; without even the implied warranty of           **
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the         **
+** GNU General Public License for more details.                         **
+**                                                                      **
+** You should have received a copy of the GNU General Public License    **
+** along with this program; if not, see <http://www.gnu.org/licenses/>. **
+*************************************************************************/
+
+#ifndef TEXTTEMPLATE_HPP
+#define TEXTTEMPLATE_HPP
+
+#include <string>
+#include <vector>
+#include "Calculator.hpp"
+
+class SpecialActions;
+
+/** Text with embedded {?...} macros that are replaced by their current values
+ *  on expansion. The text is compiled once into a sequence of literal spans
+ *  and macro slots, so that repeated expansions (e.g. of an SVG fragment put
+ *  on every page) only concatenate the spans and the formatted macro values
+ *  without re-scanning the text. */
+class TextTemplate {
+	public:
+		TextTemplate () =default;
+		explicit TextTemplate (std::string text) : _text(std::move(text)) {}
+		std::string expand (SpecialActions &actions) const;
+		const std::string& text () const {return _text;}
+		bool empty () const              {return _text.empty();}
+
+	protected:
+		void compile () const;
+
+	private:
+		struct Segment {
+			enum class Type {LITERAL, CONSTANT, BBOX, EXPRESSION};
+			Segment (Type t, std::string str) : type(t), text(std::move(str)) {}
+			Type type;
+			std::string text;  ///< literal text, constant name, box name, or expression string
+			Calculator::Expression expr;  ///< compiled expression if type == EXPRESSION
+		};
+		std::string _text;      ///< the unexpanded text
+		mutable bool _compiled=false;
+		mutable std::vector<Segment> _segments;  ///< compiled form of the text
+};
+
+#endif
@@ -0,0 +1,138 @@
+/*************************************************************************
+** ThreadPool.cpp                                                       **
+**                                                                      **
+** This file is part of dvisvgm -- a fast DVI to SVG converter          **
+** Copyright (C) 2005-2024 Martin Gieseking <martin.gieseking@uos.de>   **
+**                                                                      **
+** This program is free software; you can redistribute it and/or        **
+** modify it under the terms of the GNU General Public License as       **
+** published by the Free Software Foundation; either version 3 of       **
+** the License, or (at your option) any later version.                  **
+**                                                                      **
+** This program is distributed in the hope that it will be useful, but  **
+** WITHOUT ANY WARRANTY; without even the implied warranty of           **
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the         **
+** GNU General Public License for more details.                         **
+**                                                                      **
+** You should have received a copy of the GNU General Public License    **
+** along with this program; if not, see <http://www.gnu.org/licenses/>. **
+*************************************************************************/
+
+#include <algorithm>
+#include "Jobserver.hpp"
+#include "System.hpp"
+#include "ThreadPool.hpp"
+
+#if defined (__linux__)
+#include <pthread.h>
+#include <sched.h>
+#elif defined (_WIN32)
+#include <windows.h>
+#endif
+
+using namespace std;
+
+vector<int> ThreadPool::AFFINITY_CPUS;
+
+
+/** Creates the pool and starts its worker threads.
+ *  @param[in] numThreads number of worker threads to start (at least 1)
+ *  @param[in] maxQueuedTasks maximum number of tasks waiting in the queue (0 = unlimited) */
+ThreadPool::ThreadPool (size_t numThreads, size_t maxQueuedTasks)
+	: _maxQueuedTasks(maxQueuedTasks)
+{
+	numThreads = max(size_t(1), numThreads);
+	// When cooperating with a make jobserver, the process itself holds one
+	// implicit job slot; each additional worker requires an acquired token.
+	if (numThreads > 1 && Jobserver::instance().active()) {
+		_jobserverTokens = Jobserver::instance().acquireTokens(numThreads-1);
+		numThreads = 1+_jobserverTokens;
+	}
+	_threads.reserve(numThreads);
+	for (size_t i=0; i < numThreads; i++) {
+		_threads.emplace_back(&ThreadPool::workerLoop, this);
+		if (!AFFINITY_CPUS.empty())
+			bindThreadToCPU(_threads.back(), AFFINITY_CPUS[i % AFFINITY_CPUS.size()]);
+	}
+}
+
+
+/** Waits until all queued tasks have been processed and joins the workers. */
+ThreadPool::~ThreadPool () {
+	{
+		lock_guard<mutex> lock(_mutex);
+		_quit = true;
+	}
+	_taskAvailable.notify_all();
+	for (thread &worker : _threads)
+		worker.join();
+	Jobserver::instance().releaseTokens(_jobserverTokens);
+}
+
+
+/** Appends a task to the queue and returns a future that becomes ready once
+ *  a worker has finished the task. Exceptions thrown by the task are captured
+ *  and rethrown when the future is queried. If the queue is bounded and full,
+ *  the call blocks until a slot becomes available.
+ *  @param[in] task function to execute on a worker thread
+ *  @return future signaling the completion of the task */
+future<void> ThreadPool::enqueue (function<void ()> task) {
+	packaged_task<void ()> packagedTask(std::move(task));
+	future<void> taskFuture = packagedTask.get_future();
+	{
+		unique_lock<mutex> lock(_mutex);
+		if (_maxQueuedTasks > 0)
+			_spaceAvailable.wait(lock, [this] {return _tasks.size() < _maxQueuedTasks;});
+		_tasks.push_back(std::move(packagedTask));
+	}
+	_taskAvailable.notify_one();
+	return taskFuture;
+}
+
+
+/** Processes queued tasks until the pool is destroyed and the queue is empty. */
+void ThreadPool::workerLoop () {
+	for (;;) {
+		packaged_task<void ()> task;
+		{
+			unique_lock<mutex> lock(_mutex);
+			_taskAvailable.wait(lock, [this] {return _quit || !_tasks.empty();});
+			if (_tasks.empty())  // no further tasks and pool is being destroyed?
+				return;
+			task = std::move(_tasks.front());
+			_tasks.pop_front();
+		}
+		_spaceAvailable.notify_one();
+		task();
+	}
+}
+
+
+/** Returns the number of worker threads suited to process a given number of
+ *  tasks, i.e. the available parallelism limited by the amount of work. If the
+ *  workers are bound to a set of CPUs, no more threads than CPUs are created.
+ *  @param[in] numTasks number of tasks to be processed */
+size_t ThreadPool::preferredThreadCount (size_t numTasks) {
+	size_t numCPUs = AFFINITY_CPUS.empty() ? size_t(System::numberOfCPUs()) : AFFINITY_CPUS.size();
+	return max(size_t(1), min(numTasks, numCPUs));
+}
+
+
+/** Binds a worker thread to a single CPU so that the operating system doesn't
+ *  migrate it, e.g. between performance and efficiency cores or across sockets.
+ *  On platforms without support for thread affinities, the binding is skipped.
+ *  @param[in] thread thread to bind
+ *  @param[in] cpu number of the CPU the thread is bound to
+ *  @return true on success */
+bool ThreadPool::bindThreadToCPU (std::thread &thread, int cpu) {
+#if defined (__linux__)
+	cpu_set_t cpuset;
+	CPU_ZERO(&cpuset);
+	CPU_SET(cpu, &cpuset);
+	return pthread_setaffinity_np(thread.native_handle(), sizeof(cpuset), &cpuset) == 0;
+#elif defined (_WIN32)
+	return SetThreadAffinityMask(static_cast<HANDLE>(thread.native_handle()), DWORD_PTR(1) << cpu) != 0;
+#else
+	return false;
+#endif
+}
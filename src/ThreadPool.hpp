@@ -0,0 +1,63 @@
+/*************************************************************************
+** ThreadPool.hpp                                                       **
+**                                                                      **
+** This file is part of dvisvgm -- a fast DVI to SVG converter          **
+** Copyright (C) 2005-2024 Martin Gieseking <martin.gieseking@uos.de>   **
+**                                                                      **
+** This program is free software; you can redistribute it and/or        **
+** modify it under the terms of the GNU General Public License as       **
+** published by the Free Software Foundation; either version 3 of       **
+** the License, or (at your option) any later version.                  **
+**                                                                      **
+** This program is distributed in the hope that it will be useful, but  **
+** WITHOUT ANY WARRANTY; without even the implied warranty of           **
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the         **
+** GNU General Public License for more details.                         **
+**                                                                      **
+** You should have received a copy of the GNU General Public License    **
+** along with this program; if not, see <http://www.gnu.org/licenses/>. **
+*************************************************************************/
+
+#ifndef THREADPOOL_HPP
+#define THREADPOOL_HPP
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/** Pool of worker threads processing queued tasks in submission order.
+ *  All parallelized processing stages share this class instead of spawning
+ *  their own threads. The queue can optionally be bounded so that producers
+ *  creating tasks faster than the workers consume them are throttled rather
+ *  than buffering an unlimited amount of pending work. */
+class ThreadPool {
+	public:
+		explicit ThreadPool (size_t numThreads, size_t maxQueuedTasks=0);
+		ThreadPool (const ThreadPool&) =delete;
+		ThreadPool (ThreadPool&&) =delete;
+		~ThreadPool ();
+		std::future<void> enqueue (std::function<void ()> task);
+		size_t numThreads () const {return _threads.size();}
+		static size_t preferredThreadCount (size_t numTasks);
+
+		static std::vector<int> AFFINITY_CPUS;  ///< CPUs the workers are bound to (empty = no binding)
+
+	private:
+		static bool bindThreadToCPU (std::thread &thread, int cpu);
+		void workerLoop ();
+
+		std::vector<std::thread> _threads;
+		std::deque<std::packaged_task<void ()>> _tasks; ///< tasks waiting to be picked up by a worker
+		std::mutex _mutex;                       ///< serializes access to the task queue
+		std::condition_variable _taskAvailable;  ///< signals workers that a task was queued
+		std::condition_variable _spaceAvailable; ///< signals producers that a queue slot was freed
+		size_t _maxQueuedTasks;    ///< maximum number of waiting tasks (0 = unlimited)
+		size_t _jobserverTokens=0; ///< number of job tokens held for the additional workers
+		bool _quit=false;          ///< workers quit after draining the queue if set
+};
+
+#endif
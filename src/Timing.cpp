@@ -0,0 +1,242 @@
+/*************************************************************************
+** Timing.cpp                                                           **
+**                                                                      **
+** This file is part of dvisvgm -- a fast DVI to SVG converter          **
+** Copyright (C) 2005-2024 Martin Gieseking <martin.gieseking@uos.de>   **
+**                                                                      **
+** This program is free software; you can redistribute it and/or        **
+** modify it under the terms of the GNU General Public License as       **
+** published by the Free Software Foundation; either version 3 of       **
+** the License, or (at your option) any later version.                  **
+**                                                                      **
+** This program is distributed in the hope that it will be useful, but  **
+** WITHOUT ANY WARRANTY; without even the implied warranty of           **
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the         **
+** GNU General Public License for more details.                         **
+**                                                                      **
+** You should have received a copy of the GNU General Public License    **
+** along with this program; if not, see <http://www.gnu.org/licenses/>. **
+*************************************************************************/
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <thread>
+#include <vector>
+#include "Timing.hpp"
+
+using namespace std;
+
+bool Timing::ENABLED = false;
+bool Timing::TRACING = false;
+constexpr size_t Timing::MAX_HOTSPOTS;
+constexpr double Timing::OUTLIER_SIGMA;
+map<string, Timing::Entry> Timing::_entries;
+map<unsigned, Timing::PageStats> Timing::_pageStats;
+vector<Timing::Hotspot> Timing::_hotspots;
+vector<Timing::TraceEvent> Timing::_traceEvents;
+mutex Timing::_mutex;
+
+/** Point in time all trace-event timestamps refer to. */
+static const chrono::steady_clock::time_point TRACE_EPOCH = chrono::steady_clock::now();
+
+
+/** Adds a measured duration to a pipeline stage.
+ *  @param[in] stage name of the stage
+ *  @param[in] seconds duration to add */
+void Timing::add (const string &stage, double seconds) {
+	lock_guard<mutex> lock(_mutex);
+	Entry &entry = _entries[stage];
+	entry.seconds += seconds;
+	entry.count++;
+}
+
+
+/** Adds a measured duration to a stage of a single page. Except for the page
+ *  execution itself, the duration also enters the aggregated stage table.
+ *  @param[in] pageno number of the page the duration is attributed to
+ *  @param[in] stage name of the stage
+ *  @param[in] seconds duration to add */
+void Timing::addPageStage (unsigned pageno, string stage, double seconds) {
+	// the per-page trace spans carry the page number in their name
+	if (stage.compare(0, 5, "page:") == 0)
+		stage = "execute";
+	if (stage != "execute")  // stage "pages" already accumulates the execution times
+		add(stage, seconds);
+	lock_guard<mutex> lock(_mutex);
+	_pageStats[pageno].stageSeconds[stage] += seconds;
+}
+
+
+/** Records the number of XML nodes the optimized tree of a page consists of. */
+void Timing::setPageElements (unsigned pageno, long long count) {
+	lock_guard<mutex> lock(_mutex);
+	_pageStats[pageno].elements = count;
+}
+
+
+/** Records the number of bytes written for a page. */
+void Timing::setPageOutputSize (unsigned pageno, long long bytes) {
+	lock_guard<mutex> lock(_mutex);
+	_pageStats[pageno].bytes = bytes;
+}
+
+
+/** Records a single expensive operation attributed to a page. Only the
+ *  MAX_HOTSPOTS most expensive operations are kept; operations taking less
+ *  than a millisecond are dropped right away since they can't be the reason
+ *  for a slow conversion.
+ *  @param[in] pageno number of the page the operation belongs to
+ *  @param[in] description short description of the operation
+ *  @param[in] seconds duration of the operation */
+void Timing::addHotspot (unsigned pageno, string description, double seconds) {
+	if (seconds < 0.001)
+		return;
+	// replace control characters so that the description stays on a single line
+	for (char &c : description) {
+		if (c >= 0 && c < 0x20)
+			c = ' ';
+	}
+	lock_guard<mutex> lock(_mutex);
+	auto it = lower_bound(_hotspots.begin(), _hotspots.end(), seconds, [](const Hotspot &hotspot, double secs) {
+		return hotspot.seconds > secs;
+	});
+	if (it == _hotspots.end() && _hotspots.size() >= MAX_HOTSPOTS)
+		return;
+	_hotspots.insert(it, Hotspot{pageno, std::move(description), seconds});
+	if (_hotspots.size() > MAX_HOTSPOTS)
+		_hotspots.pop_back();
+}
+
+
+/** Records a measured code section as a trace event for the JSON timeline.
+ *  @param[in] stage name of the stage the section belongs to
+ *  @param[in] start point in time the measurement started
+ *  @param[in] end point in time the measurement ended */
+void Timing::addTraceEvent (const string &stage, chrono::steady_clock::time_point start, chrono::steady_clock::time_point end) {
+	TraceEvent event;
+	event.stage = stage;
+	event.start = chrono::duration_cast<chrono::microseconds>(start-TRACE_EPOCH).count();
+	event.duration = chrono::duration_cast<chrono::microseconds>(end-start).count();
+	lock_guard<mutex> lock(_mutex);
+	// number the threads in the order they record their first event so that
+	// each of them gets its own lane in the timeline viewers
+	static map<thread::id, int> threadNumbers;
+	auto it = threadNumbers.emplace(this_thread::get_id(), int(threadNumbers.size())).first;
+	event.thread = it->second;
+	_traceEvents.push_back(std::move(event));
+}
+
+
+/** Returns the threshold above which a value is considered an outlier, i.e.
+ *  the median of the given values plus OUTLIER_SIGMA standard deviations.
+ *  @param[in] values sample values; the vector is reordered by the function */
+double Timing::outlierThreshold (vector<double> &values) {
+	nth_element(values.begin(), values.begin()+values.size()/2, values.end());
+	double median = values[values.size()/2];
+	double sum=0;
+	for (double value : values)
+		sum += value;
+	double mean = sum/double(values.size());
+	double variance=0;
+	for (double value : values)
+		variance += (value-mean)*(value-mean);
+	return median + OUTLIER_SIGMA*sqrt(variance/double(values.size()));
+}
+
+
+/** Writes the accumulated times as tab-separated lines of the form
+ *  "stage<TAB>calls<TAB>seconds" so that the output can easily be processed
+ *  by scripts tracking the values across program versions. Below the table,
+ *  the pages whose conversion time or output size exceeds the document's
+ *  median by more than OUTLIER_SIGMA standard deviations are reported as lines
+ *  "slowpage<TAB>page<TAB>seconds<TAB>elements<TAB>bytes<TAB>dominant stage"
+ *  and "bigpage" lines of the same layout, respectively.
+ *  Finally, the most expensive single operations are printed as
+ *  lines of the form "hotspot<TAB>page<TAB>seconds<TAB>description". */
+void Timing::write (ostream &os) {
+	lock_guard<mutex> lock(_mutex);
+	ios::fmtflags osflags(os.flags());
+	os << fixed << setprecision(6);
+	for (const auto &stageEntryPair : _entries)
+		os << stageEntryPair.first << '\t' << stageEntryPair.second.count << '\t' << stageEntryPair.second.seconds << '\n';
+	if (_pageStats.size() >= 3) {  // with fewer pages, median and deviation aren't meaningful
+		auto page_seconds = [](const PageStats &stats) {
+			double seconds=0;
+			for (const auto &stageSecondsPair : stats.stageSeconds)
+				seconds += stageSecondsPair.second;
+			return seconds;
+		};
+		auto dominant_stage = [](const PageStats &stats) {
+			auto it = max_element(stats.stageSeconds.begin(), stats.stageSeconds.end(),
+				[](const pair<const string, double> &p1, const pair<const string, double> &p2) {
+					return p1.second < p2.second;
+				});
+			return it != stats.stageSeconds.end() ? it->first : string();
+		};
+		vector<double> times, sizes;
+		for (const auto &pageStatsPair : _pageStats) {
+			times.push_back(page_seconds(pageStatsPair.second));
+			sizes.push_back(double(pageStatsPair.second.bytes));
+		}
+		double timeThreshold = outlierThreshold(times);
+		double sizeThreshold = outlierThreshold(sizes);
+		for (const auto &pageStatsPair : _pageStats) {
+			const PageStats &stats = pageStatsPair.second;
+			double seconds = page_seconds(stats);
+			if (seconds > timeThreshold) {
+				os << "slowpage\t" << pageStatsPair.first << '\t' << seconds << '\t' << stats.elements
+					<< '\t' << stats.bytes << '\t' << dominant_stage(stats) << '\n';
+			}
+			if (stats.bytes > 0 && double(stats.bytes) > sizeThreshold) {
+				os << "bigpage\t" << pageStatsPair.first << '\t' << seconds << '\t' << stats.elements
+					<< '\t' << stats.bytes << '\t' << dominant_stage(stats) << '\n';
+			}
+		}
+	}
+	for (const Hotspot &hotspot : _hotspots)
+		os << "hotspot\t" << hotspot.pageno << '\t' << hotspot.seconds << '\t' << hotspot.description << '\n';
+	os.flags(osflags);
+}
+
+
+/** Writes the recorded trace events as a JSON timeline in the trace-event
+ *  format so that the file can be loaded into chrome://tracing or Perfetto.
+ *  Each event becomes a complete span ("ph":"X") placed on the lane of the
+ *  thread it was recorded on.
+ *  @param[in] fname name of the file to write
+ *  @return true if the file was written successfully */
+bool Timing::writeTraceFile (const string &fname) {
+	ofstream ofs(fname);
+	if (!ofs)
+		return false;
+	lock_guard<mutex> lock(_mutex);
+	ofs << "{\"traceEvents\":[";
+	bool first=true;
+	for (const TraceEvent &event : _traceEvents) {
+		if (!first)
+			ofs << ',';
+		first = false;
+		// the stage names consist of plain identifier characters only, so they
+		// don't require any JSON escaping
+		ofs << "\n{\"name\":\"" << event.stage << "\","
+			<< "\"ph\":\"X\","
+			<< "\"ts\":" << event.start << ','
+			<< "\"dur\":" << event.duration << ','
+			<< "\"pid\":1,"
+			<< "\"tid\":" << event.thread << '}';
+	}
+	ofs << "\n]}\n";
+	return bool(ofs);
+}
+
+
+/** Removes all accumulated times, page data, hotspots, and recorded trace events. */
+void Timing::reset () {
+	lock_guard<mutex> lock(_mutex);
+	_entries.clear();
+	_pageStats.clear();
+	_hotspots.clear();
+	_traceEvents.clear();
+}
@@ -0,0 +1,128 @@
+/*************************************************************************
+** Timing.hpp                                                           **
+**                                                                      **
+** This file is part of dvisvgm -- a fast DVI to SVG converter          **
+** Copyright (C) 2005-2024 Martin Gieseking <martin.gieseking@uos.de>   **
+**                                                                      **
+** This program is free software; you can redistribute it and/or        **
+** modify it under the terms of the GNU General Public License as       **
+** published by the Free Software Foundation; either version 3 of       **
+** the License, or (at your option) any later version.                  **
+**                                                                      **
+** This program is distributed in the hope that it will be useful, but  **
+** WITHOUT ANY WARRANTY; without even the implied warranty of           **
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the         **
+** GNU General Public License for more details.                         **
+**                                                                      **
+** You should have received a copy of the GNU General Public License    **
+** along with this program; if not, see <http://www.gnu.org/licenses/>. **
+*************************************************************************/
+
+#ifndef TIMING_HPP
+#define TIMING_HPP
+
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/** Collects the time spent in the single stages of the conversion pipeline,
+ *  like the processing of specials, the creation of font glyphs, and the
+ *  serialization of the SVG tree. The measured stages are scattered across the
+ *  processing of a page and may nest, so their durations don't necessarily add
+ *  up to the total conversion time. All times are accumulated per stage name
+ *  and can be printed as a machine-readable table afterwards. Optionally, the
+ *  single measurements are additionally kept as trace events which can be
+ *  written as a JSON timeline in the trace-event format understood by
+ *  chrome://tracing and Perfetto. */
+class Timing {
+	public:
+		/** Measures the time elapsed between construction and destruction of the
+		 *  object and adds it to the stage given to the constructor. A scope
+		 *  created with an empty stage name doesn't record anything, which allows
+		 *  to build dynamic stage names only if the timings are enabled. If a
+		 *  page number > 0 is given, the elapsed time is additionally attributed
+		 *  to that page for the per-page outlier report. */
+		class Scope {
+			public:
+				explicit Scope (std::string stage, unsigned pageno=0) : _stage(std::move(stage)), _pageno(pageno) {
+					if ((ENABLED || TRACING) && !_stage.empty())
+						_start = std::chrono::steady_clock::now();
+				}
+				~Scope () {
+					if (!_stage.empty() && (ENABLED || TRACING)) {
+						auto end = std::chrono::steady_clock::now();
+						if (ENABLED) {
+							double seconds = std::chrono::duration<double>(end-_start).count();
+							if (_pageno > 0)
+								addPageStage(_pageno, _stage, seconds);
+							else
+								add(_stage, seconds);
+						}
+						if (TRACING)
+							addTraceEvent(_stage, _start, end);
+					}
+				}
+
+			private:
+				std::string _stage;  ///< name of the stage the elapsed time is added to
+				unsigned _pageno;    ///< if > 0, number of the page the time is attributed to
+				std::chrono::steady_clock::time_point _start;  ///< point in time the measurement started
+		};
+
+		static void add (const std::string &stage, double seconds);
+		static void addPageStage (unsigned pageno, std::string stage, double seconds);
+		static void setPageElements (unsigned pageno, long long count);
+		static void setPageOutputSize (unsigned pageno, long long bytes);
+		static void addHotspot (unsigned pageno, std::string description, double seconds);
+		static void addTraceEvent (const std::string &stage, std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end);
+		static void write (std::ostream &os);
+		static bool writeTraceFile (const std::string &fname);
+		static void reset ();
+
+		static bool ENABLED;  ///< if false, no times are recorded
+		static bool TRACING;  ///< if true, the single measurements are kept as trace events
+
+	private:
+		struct Entry {
+			double seconds=0;  ///< accumulated time spent in the stage
+			unsigned count=0;  ///< number of measurements taken
+		};
+
+		/** A single expensive operation, like the processing of a pathological
+		 *  special, attributed to the page it was executed on. */
+		struct Hotspot {
+			unsigned pageno;          ///< number of the page the operation belongs to
+			std::string description;  ///< short description, e.g. the first bytes of the special
+			double seconds;           ///< duration of the operation
+		};
+
+		/** Data recorded for a single page, used to spot pages whose conversion
+		 *  time or output size deviates strongly from the rest of the document. */
+		struct PageStats {
+			std::map<std::string, double> stageSeconds;  ///< time spent per stage while converting the page
+			long long elements=0;  ///< number of XML nodes of the optimized page tree
+			long long bytes=0;     ///< size of the written output file in bytes
+		};
+
+		/** A single timed code section, kept for the trace-event timeline. */
+		struct TraceEvent {
+			std::string stage;   ///< name of the measured stage
+			long long start;     ///< microseconds elapsed since program start
+			long long duration;  ///< duration of the event in microseconds
+			int thread;          ///< number of the thread the event was recorded on
+		};
+		static double outlierThreshold (std::vector<double> &values);
+
+		static constexpr size_t MAX_HOTSPOTS = 10;     ///< number of most expensive operations kept
+		static constexpr double OUTLIER_SIGMA = 2;     ///< number of standard deviations above the median marking an outlier
+		static std::map<std::string, Entry> _entries;  ///< accumulated times mapped by stage name
+		static std::map<unsigned, PageStats> _pageStats;  ///< per-page data mapped by page number
+		static std::vector<Hotspot> _hotspots;         ///< most expensive operations, sorted by descending duration
+		static std::vector<TraceEvent> _traceEvents;   ///< chronologically recorded trace events
+		static std::mutex _mutex;  ///< protects the entries if stages run on multiple threads
+};
+
+#endif
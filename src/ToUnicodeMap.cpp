@@ -75,7 +75,25 @@ static bool is_less_or_equal (uint32_t a, uint32_t b) {return a <= b;}
 static bool is_greater_or_equal (uint32_t a, uint32_t b) {return a >= b;}
 
 
+/** Returns an iterator to the first range of 'used_ucps' that intersects the
+ *  codepoint interval [first, last], or the end iterator if there is none.
+ *  @param[in] first lower bound of the interval to check
+ *  @param[in] last upper bound of the interval to check
+ *  @param[in] used_ucps Unicode points already in use */
+static NumericRanges<uint32_t>::ConstIterator find_used_range (uint32_t first, uint32_t last, const NumericRanges<uint32_t> &used_ucps) {
+	auto it = used_ucps.begin();
+	while (it != used_ucps.end() && it->second < first)
+		++it;
+	return (it != used_ucps.end() && it->first <= last) ? it : used_ucps.end();
+}
+
+
 /** Adds index to Unicode mappings for a given range of character indexes.
+ *  Blocks of consecutive codepoints not in use yet are mapped at once by
+ *  single range entries, so that the number of operations depends on the
+ *  number of codepoint ranges rather than on the number of characters.
+ *  Only characters whose preferred codepoints are already taken are
+ *  resolved individually.
  *  @param[in] minIndex lower bound of range to fill
  *  @param[in] maxIndex upper bound of range to fill
  *  @param[in] ucp first Unicode point to add (if possible)
@@ -92,12 +110,33 @@ bool ToUnicodeMap::fillRange (uint32_t minIndex, uint32_t maxIndex, uint32_t ucp
 			inc = -1;
 			cmp = is_greater_or_equal;
 		}
-		for (uint32_t i=first; cmp(i, last); i += inc) {
-			if (!fix_codepoint(ucp, used_ucps, ascending))
-				return false;
-			else {
+		uint32_t i=first;
+		while (cmp(i, last)) {
+			// number of characters not mapped yet
+			uint32_t remaining = ascending ? last-i+1 : i-last+1;
+			// length of the codepoint block starting at ucp, clipped at the bounds of the codepoint space
+			uint32_t blocklen = ascending ? min(remaining, numeric_limits<uint32_t>::max()-ucp+1) : min(remaining, ucp+1);
+			uint32_t blockmin = ascending ? ucp : ucp-blocklen+1;
+			auto it = find_used_range(blockmin, blockmin+blocklen-1, used_ucps);
+			if (it != used_ucps.end()) {
+				// keep only the codepoints preceding the first one already in use
+				blocklen = ascending ? (it->first > ucp ? it->first-ucp : 0) : (it->second < ucp ? ucp-it->second : 0);
+			}
+			if (blocklen > 0) {
+				// map the whole block of unused codepoints at once
+				uint32_t indexmin = ascending ? i : i-blocklen+1;
+				blockmin = ascending ? ucp : ucp-blocklen+1;
+				addRange(indexmin, indexmin+blocklen-1, blockmin);
+				used_ucps.addRange(blockmin, blockmin+blocklen-1);
+				i = ascending ? i+blocklen : i-blocklen;
+				ucp = ascending ? ucp+blocklen : ucp-blocklen;
+			}
+			else {  // preferred codepoint already in use => resolve this character separately
+				if (!fix_codepoint(ucp, used_ucps, ascending))
+					return false;
 				addRange(i, i, ucp);
 				used_ucps.addRange(ucp);
+				i += inc;
 				ucp += inc;  // preferred Unicode point for the next character of the current range
 			}
 		}
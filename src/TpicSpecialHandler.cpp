@@ -37,6 +37,7 @@ using namespace std;
 
 
 TpicSpecialHandler::TpicSpecialHandler () {
+	_points.reserve(64);
 	reset();
 }
 
@@ -47,7 +48,7 @@ void TpicSpecialHandler::dviEndPage (unsigned pageno, SpecialActions&) {
 
 
 void TpicSpecialHandler::reset () {
-	_points.clear();
+	_points.clear();  // keeps the capacity for the points of the next figure
 	_penwidth = 1.0;
 	_grayLevel = -1.0; // no fill
 }
@@ -128,14 +129,15 @@ void TpicSpecialHandler::drawLines (double ddist, SpecialActions &actions) {
 				else
 					elem->setFillColor(fillColor(false));
 			}
-			vector<DPair> points;
+			_shiftedPoints.clear();
+			_shiftedPoints.reserve(_points.size());
 			for (const DPair &p : _points) {
 				double x = p.x()+actions.getX();
 				double y = p.y()+actions.getY();
-				points.emplace_back(x, y);
+				_shiftedPoints.emplace_back(x, y);
 				actions.embed(DPair(x, y));
 			}
-			elem->setPoints(points);
+			elem->setPoints(_shiftedPoints);
 			add_stroke_attribs(elem.get(), _penwidth, Color::BLACK, ddist);
 		}
 		actions.svgTree().appendToPage(std::move(elem));
@@ -161,31 +163,29 @@ void TpicSpecialHandler::drawSplines (double ddist, SpecialActions &actions) {
 		}
 		else {
 			DPair p(actions.getX(), actions.getY());
-			GraphicsPath<double> path;
-			path.moveto(p+_points[0]);
+			_path.clear();
+			_path.moveto(p+_points[0]);
 			DPair mid = p+_points[0]+(_points[1]-_points[0])/2.0;
-			path.lineto(mid);
+			_path.lineto(mid);
 			actions.embed(p+_points[0]);
 			for (size_t i=1; i < numPoints-1; i++) {
 				const DPair p0 = p+_points[i-1];
 				const DPair p1 = p+_points[i];
 				const DPair p2 = p+_points[i+1];
 				mid = p1+(p2-p1)/2.0;
-				path.quadto(p1, mid);
+				_path.quadto(p1, mid);
 				actions.embed(mid);
 				actions.embed((p0+p1*6.0+p2)/8.0, _penwidth);
 			}
 			if (_points[0] == _points[numPoints-1])  // closed path?
-				path.closepath();
+				_path.closepath();
 			else {
-				path.lineto(p+_points[numPoints-1]);
+				_path.lineto(p+_points[numPoints-1]);
 				actions.embed(p+_points[numPoints-1]);
 			}
 			auto pathElem = util::make_unique<SVGElement>("path");
 			pathElem->setNoFillColor();
-			ostringstream oss;
-			path.writeSVG(oss, SVGTree::RELATIVE_PATH_CMDS);
-			pathElem->addAttribute("d", oss.str());
+			pathElem->addAttribute("d", _path.svgPathData(SVGTree::RELATIVE_PATH_CMDS));
 			add_stroke_attribs(pathElem.get(), _penwidth, _dviColor, ddist);
 			actions.svgTree().appendToPage(std::move(pathElem));
 		}
@@ -212,17 +212,15 @@ void TpicSpecialHandler::drawArc (double cx, double cy, double rx, double ry, do
 			elem = create_ellipse_element(cx, cy, rx, ry);
 		else {
 			EllipticalArc arc(DPair(cx, cy), rx, ry, 0, -angle1, math::normalize_0_2pi(angle2-angle1));
-			GraphicsPath<double> path;
-			path.moveto(arc.startPoint());
-			path.arcto(rx, ry, 0, arc.largeArc(), arc.sweepPositive(), arc.endPoint());
+			_path.clear();
+			_path.moveto(arc.startPoint());
+			_path.arcto(rx, ry, 0, arc.largeArc(), arc.sweepPositive(), arc.endPoint());
 			if (_grayLevel >= 0)
-				path.closepath();
+				_path.closepath();
 			else
 				closed = false;
 			elem = util::make_unique<SVGElement>("path");
-			ostringstream oss;
-			path.writeSVG(oss, SVGTree::RELATIVE_PATH_CMDS);
-			elem->addAttribute("d", oss.str());
+			elem->addAttribute("d", _path.svgPathData(SVGTree::RELATIVE_PATH_CMDS));
 		}
 		if (_penwidth > 0) {
 			elem->setStrokeWidth(_penwidth);
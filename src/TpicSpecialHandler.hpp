@@ -22,6 +22,7 @@
 #define TPICSPECIALHANDLER_HPP
 
 #include <list>
+#include "GraphicsPath.hpp"
 #include "Pair.hpp"
 #include "SpecialHandler.hpp"
 
@@ -48,6 +49,8 @@ class TpicSpecialHandler : public SpecialHandler {
 		double _penwidth;  ///< pen width in PS point units
 		double _grayLevel; ///< [0,1]; 0=white, 1=black, if < 0, we don't fill anything
 		std::vector<DPair> _points;
+		std::vector<DPair> _shiftedPoints;  ///< reusable buffer for points shifted to the DVI position
+		GraphicsPath<double> _path;         ///< reusable path object; keeps its capacity across figures
 		Color _dviColor;   ///< current DVI color
 };
 
@@ -0,0 +1,44 @@
+/*************************************************************************
+** Tracepoints.hpp                                                      **
+**                                                                      **
+** This file is part of dvisvgm -- a fast DVI to SVG converter          **
+** Copyright (C) 2005-2024 Martin Gieseking <martin.gieseking@uos.de>   **
+**                                                                      **
+** This program is free software; you can redistribute it and/or        **
+** modify it under the terms of the GNU General Public License as       **
+** published by the Free Software Foundation; either version 3 of       **
+** the License, or (at your option) any later version.                  **
+**                                                                      **
+** This program is distributed in the hope that it will be useful, but  **
+** WITHOUT ANY WARRANTY; without even the implied warranty of           **
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the         **
+** GNU General Public License for more details.                         **
+**                                                                      **
+** You should have received a copy of the GNU General Public License    **
+** along with this program; if not, see <http://www.gnu.org/licenses/>. **
+*************************************************************************/
+
+#ifndef TRACEPOINTS_HPP
+#define TRACEPOINTS_HPP
+
+#include <config.h>
+
+// Optional USDT (user-level statically defined tracing) probes placed on the
+// hot paths of the conversion pipeline. They allow to attach perf/bpftrace to
+// a running dvisvgm process and to measure live latency distributions without
+// recompiling or restarting it. The probes are only compiled in if configure
+// option --enable-tracepoints is given; otherwise the macros expand to nothing
+// and don't cost anything. All probes use the provider name "dvisvgm".
+
+#ifdef ENABLE_TRACEPOINTS
+#include <sys/sdt.h>
+#define DVISVGM_PROBE(name)          DTRACE_PROBE(dvisvgm, name)
+#define DVISVGM_PROBE1(name, a1)     DTRACE_PROBE1(dvisvgm, name, a1)
+#define DVISVGM_PROBE2(name, a1, a2) DTRACE_PROBE2(dvisvgm, name, a1, a2)
+#else
+#define DVISVGM_PROBE(name)
+#define DVISVGM_PROBE1(name, a1)
+#define DVISVGM_PROBE2(name, a1, a2)
+#endif
+
+#endif
@@ -18,7 +18,9 @@
 ** along with this program; if not, see <http://www.gnu.org/licenses/>. **
 *************************************************************************/
 
+#include <sstream>
 #include "TriangularPatch.hpp"
+#include "XMLString.hpp"
 
 using namespace std;
 
@@ -144,6 +146,7 @@ void TriangularPatch::approximate (int gridsize, bool overlap, double delta, Cal
 		callback.patchSegment(path, _colors[0]);
 	}
 	else {
+		gridsize = adaptedGridsize(gridsize, {_colors[0], _colors[1], _colors[2]});
 		const double inc = 1.0/gridsize;
 		for (double u1=0; u1 < 1; u1=snap(u1+inc)) {
 			double u2 = snap(u1+inc);
@@ -177,6 +180,17 @@ void TriangularPatch::approximate (int gridsize, bool overlap, double delta, Cal
 }
 
 
+/** Returns the approximate number of segments approximate() creates for a given grid size,
+ *  taking the adaptive reduction of the subdivision into account.
+ *  @param[in] gridsize number of segments per row/column */
+int TriangularPatch::estimatedSegments (int gridsize) const {
+	if (_colors[0] == _colors[1] && _colors[1] == _colors[2])
+		return 1;  // monochromatic patches are represented by their boundary path only
+	gridsize = adaptedGridsize(gridsize, {_colors[0], _colors[1], _colors[2]});
+	return gridsize*gridsize;
+}
+
+
 GraphicsPath<double> TriangularPatch::getBoundaryPath () const {
 	GraphicsPath<double> path;
 	path.clear();
@@ -188,6 +202,29 @@ GraphicsPath<double> TriangularPatch::getBoundaryPath () const {
 }
 
 
+/** Returns the SVG path data of a straight edge leading to the next patch corner. */
+static string line_edge (const DPair &p) {
+	ostringstream oss;
+	oss << 'L' << XMLString(p.x()) << ' ' << XMLString(p.y());
+	return oss.str();
+}
+
+
+/** Returns the corner colors and boundary lines of the patch arranged for SVG
+ *  mesh gradients. Since these require four-sided patches, the triangle is mapped
+ *  to a degenerate Coons patch whose third edge has zero length. */
+ShadingPatch::MeshData TriangularPatch::getMeshData () const {
+	MeshData mesh;
+	mesh.startPoint = _points[0];
+	mesh.stops.resize(4);
+	mesh.stops[0] = {line_edge(_points[1]), _colors[0]};
+	mesh.stops[1] = {line_edge(_points[2]), _colors[1]};
+	mesh.stops[2] = {line_edge(_points[2]), _colors[2]};
+	mesh.stops[3] = {line_edge(_points[0]), _colors[2]};
+	return mesh;
+}
+
+
 BoundingBox TriangularPatch::getBBox () const {
 	BoundingBox bbox;
 	bbox.embed(_points[0]);
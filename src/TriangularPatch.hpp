@@ -31,15 +31,17 @@ class TriangularPatch : public ShadingPatch {
 		explicit TriangularPatch (Color::ColorSpace cspace) : ShadingPatch(cspace) {}
 		TriangularPatch (const PointVec &points, const ColorVec &colors, Color::ColorSpace cspace, int edgeflag, TriangularPatch *patch);
 		int psShadingType() const override {return 4;}
-		DPair valueAt (double u, double v) const;
-		Color colorAt (double u, double v) const;
+		DPair valueAt (double u, double v) const override;
+		Color colorAt (double u, double v) const override;
 		void setPoints (const PointVec &points, int edgeflag, ShadingPatch *patch) override;
 		void setPoints (const DPair &p1, const DPair &p2, const DPair &p3);
 		void setColors (const ColorVec &colors, int edgeflag, ShadingPatch *patch) override;
 		void setColors (const Color &c1, const Color &c2, const Color &c3);
 		void approximate (int gridsize, bool overlap, double delta, Callback &listener) const override;
+		int estimatedSegments (int gridsize) const override;
 		BoundingBox getBBox () const override;
 		GraphicsPath<double> getBoundaryPath () const override;
+		MeshData getMeshData () const override;
 		int numPoints (int edgeflag) const override {return edgeflag == 0 ? 3 : 1;}
 		int numColors (int edgeflag) const override {return edgeflag == 0 ? 3 : 1;}
 
@@ -96,30 +96,32 @@ uint32_t Unicode::charToCodepoint (uint32_t c, bool permitSpace) {
  *  @return  utf8 sequence consisting of 1-4 bytes */
 string Unicode::utf8 (int32_t cp) {
 	string utf8;
-	if (cp >= 0) {
-		if (cp < 0x80)
-			utf8 += char(cp);
-		else if (cp < 0x800) {
-			utf8 += char(0xC0 + (cp >> 6));
-			utf8 += char(0x80 + (cp & 0x3F));
-		}
-		else if (cp < 0x10000) {
-			utf8 += char(0xE0 + (cp >> 12));
-			utf8 += char(0x80 + ((cp >> 6) & 0x3F));
-			utf8 += char(0x80 + (cp & 0x3F));
-		}
-		else if (cp < 0x110000) {
-			utf8 += char(0xF0 + (cp >> 18));
-			utf8 += char(0x80 + ((cp >> 12) & 0x3F));
-			utf8 += char(0x80 + ((cp >> 6) & 0x3F));
-			utf8 += char(0x80 + (cp & 0x3F));
-		}
-		// UTF-8 does not support codepoints >= 0x110000
-	}
+	appendUTF8(cp, utf8);
 	return utf8;
 }
 
 
+/** Appends the UTF-8 encoding of a Unicode point to a string. In contrast to
+ *  utf8(), no temporary string is created per codepoint, and the length of the
+ *  byte sequence is computed without branching, so the function is also suited
+ *  to encode long character runs directly into an output buffer.
+ *  @param[in] cp code point to encode
+ *  @param[in,out] target string the UTF-8 bytes are appended to */
+void Unicode::appendUTF8 (int32_t cp, string &target) {
+	if (cp < 0 || cp >= 0x110000)  // UTF-8 does not support negative codepoints or those >= 0x110000
+		return;
+	int len = 1 + (cp >= 0x80) + (cp >= 0x800) + (cp >= 0x10000);  // number of bytes of the sequence
+	static constexpr uint8_t leadbyte[5] = {0, 0x00, 0xC0, 0xE0, 0xF0};
+	char buf[4];
+	for (int i=len-1; i > 0; i--) {  // fill the continuation bytes from right to left
+		buf[i] = char(0x80 | (cp & 0x3F));
+		cp >>= 6;
+	}
+	buf[0] = char(leadbyte[len] | cp);
+	target.append(buf, len);
+}
+
+
 uint32_t Unicode::utf8ToCodepoint (const string &utf8) {
 	auto len = utf8.length();
 	if (len > 0) {
@@ -28,6 +28,7 @@ struct Unicode {
 	static bool isValidCodepoint (uint32_t code);
 	static uint32_t charToCodepoint (uint32_t c, bool permitSpace=false);
 	static std::string utf8 (int32_t c);
+	static void appendUTF8 (int32_t c, std::string &target);
 	static uint32_t utf8ToCodepoint (const std::string &utf8);
 	static uint32_t fromSurrogate (uint32_t high, uint32_t low);
 	static uint32_t fromSurrogate (uint32_t cp);
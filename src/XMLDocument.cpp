@@ -51,12 +51,14 @@ void XMLDocument::setRootNode (unique_ptr<XMLElement> root) {
 
 ostream& XMLDocument::write (ostream &os) const {
 	if (_rootElement) { // no root element => no output
-		os << "<?xml version='1.0' encoding='UTF-8'?>\n";
+		XMLOutputBuffer out(os);
+		out.put("<?xml version='1.0' encoding='UTF-8'?>\n");
 		for (const auto &node : _nodes) {
-			node->write(os);
-			os << '\n';
+			node->serialize(out);
+			out.put('\n');
 		}
-		_rootElement->write(os);
+		_rootElement->serialize(out);
+		out.flush();
 	}
 	return os;
 }
@@ -22,8 +22,11 @@
 #include <fstream>
 #include <list>
 #include <map>
+#include <mutex>
 #include <sstream>
+#include <unordered_set>
 #include "FileSystem.hpp"
+#include "Unicode.hpp"
 #include "utility.hpp"
 #include "XMLNode.hpp"
 #include "XMLString.hpp"
@@ -124,11 +127,60 @@ bool XMLElement::empty (bool ignoreWhitespace) const {
 }
 
 
-void XMLElement::addAttribute (const string &name, const string &value) {
+/** Maps an attribute name to a unique, immutable string object so that names
+ *  can be compared by address rather than by value. Since SVG uses a small fixed
+ *  vocabulary of attribute names, almost all lookups are served by a pre-populated
+ *  constant pool without locking. Names missing there go to a mutex-protected
+ *  overflow pool, which keeps the function safe for concurrent worker threads.
+ *  @param[in] name attribute name to intern
+ *  @return pointer to the pooled string object representing the name */
+const string* XMLElement::Attribute::intern (const string &name) {
+	static const unordered_set<string> svgNames = {
+		"@@xlink:href", "@xlink:href", "ascent", "class", "clip-path", "clip-rule", "cx", "cy", "d",
+		"descent", "fill", "fill-opacity", "fill-rule", "font-family", "font-size", "glyph-name",
+		"glyph-orientation-vertical", "height", "horiz-adv-x", "id", "mask", "maskUnits", "offset",
+		"opacity", "opaque", "overflow", "patternTransform", "patternUnits", "points", "r", "rx", "ry",
+		"stop-color", "stop-opacity", "stroke", "stroke-dasharray", "stroke-dashoffset", "stroke-linecap",
+		"stroke-linejoin", "stroke-miterlimit", "stroke-opacity", "stroke-width", "style", "transform",
+		"type", "unicode", "units-per-em", "version", "vert-adv-y", "viewBox", "width", "writing-mode",
+		"x", "x1", "x2", "xlink:href", "xlink:title", "xmlns", "xmlns:xlink", "y", "y1", "y2"
+	};
+	auto it = svgNames.find(name);
+	if (it != svgNames.end())
+		return &*it;
+	static unordered_set<string> otherNames;
+	static mutex mtx;
+	lock_guard<mutex> lock(mtx);
+	return &*otherNames.insert(name).first;
+}
+
+
+/** Maps an attribute value to a shared string object. Short values, like class
+ *  names, color keywords, or reference URLs, recur across many elements, so they
+ *  are pooled and shared by all attributes with the same value. Longer values,
+ *  e.g. path data, are mostly unique and therefore kept unpooled to prevent the
+ *  pool from growing unboundedly. The pooled strings are never released; like
+ *  the interned attribute names, they persist until the program exits.
+ *  @param[in] value attribute value to look up
+ *  @return pointer to the shared string object holding the value */
+shared_ptr<const string> XMLElement::Attribute::internValue (string value) {
+	const size_t MAX_POOLED_LENGTH = 32;
+	if (value.length() > MAX_POOLED_LENGTH)
+		return make_shared<const string>(std::move(value));
+	static unordered_set<string> pool;
+	static mutex mtx;
+	lock_guard<mutex> lock(mtx);
+	const string &pooledValue = *pool.insert(std::move(value)).first;
+	// return a non-owning pointer to the pooled string which is never destructed
+	return shared_ptr<const string>(shared_ptr<const string>(), &pooledValue);
+}
+
+
+void XMLElement::addAttribute (const string &name, string value) {
 	if (Attribute *attr = getAttribute(name))
-		attr->value = value;
+		attr->setValue(std::move(value));
 	else
-		_attributes.emplace_back(name, value);
+		_attributes.emplace_back(name, std::move(value));
 }
 
 
@@ -138,8 +190,9 @@ void XMLElement::addAttribute (const string &name, double value) {
 
 
 void XMLElement::removeAttribute (const std::string &name) {
+	const string *iname = Attribute::intern(name);
 	_attributes.erase(find_if(_attributes.begin(), _attributes.end(), [&](const Attribute &attr) {
-		return attr.name == name;
+		return attr._name == iname;
 	}));
 }
 
@@ -199,12 +252,35 @@ XMLNode* XMLElement::append (unique_ptr<XMLNode> child) {
  *  appended there, otherwise a new text node is created.
  *  @param[in] str string to be appended
  *  @return raw pointer to the text node the string was appended to */
-XMLNode* XMLElement::append (const string &str) {
+XMLNode* XMLElement::append (string str) {
 	XMLText *last;
 	if (!empty() && (last = _lastChild->toText()))
 		last->append(str);
 	else
-		insertLast(util::make_unique<XMLText>(str));
+		insertLast(util::make_unique<XMLText>(std::move(str)));
+	return _lastChild;
+}
+
+
+/** Appends a single Unicode character to the element. The character is UTF-8
+ *  encoded directly into the trailing text node, which is created if necessary,
+ *  so no temporary string has to be allocated per character. XML special
+ *  characters are replaced by their entity references.
+ *  @param[in] cp codepoint of the character to append
+ *  @return raw pointer to the text node the character was appended to */
+XMLNode* XMLElement::appendUnicodeChar (uint32_t cp) {
+	XMLText *last = empty() ? nullptr : _lastChild->toText();
+	if (!last) {
+		insertLast(util::make_unique<XMLText>(""));
+		last = _lastChild->toText();
+	}
+	switch (cp) {
+		case '<' : last->append("&lt;"); break;
+		case '&' : last->append("&amp;"); break;
+		case '"' : last->append("&quot;"); break;
+		case '\'': last->append("&apos;"); break;
+		default  : last->appendCodepoint(cp);
+	}
 	return _lastChild;
 }
 
@@ -261,6 +337,73 @@ XMLNode* XMLElement::insertAfter (unique_ptr<XMLNode> child, XMLNode *sibling) {
 }
 
 
+/** Unlinks a sequence of adjacent sibling nodes [first, last] from its parent
+ *  element. Only the boundary links are modified; the links inside the sequence
+ *  stay untouched, so the operation doesn't depend on the sequence length.
+ *  @param[in] first first node of the sequence
+ *  @param[in] last last node of the sequence
+ *  @return unique pointer to the first node which transitively owns the rest of the sequence */
+unique_ptr<XMLNode> XMLElement::detachRange (XMLNode *first, XMLNode *last) {
+	XMLElement *parent = first->parent()->toElement();
+	XMLNode *prev = first->prev();
+	unique_ptr<XMLNode> headOwner = prev ? std::move(prev->_next) : std::move(parent->_firstChild);
+	unique_ptr<XMLNode> tail = std::move(last->_next);
+	if (tail)
+		tail->prev(prev);
+	else
+		parent->_lastChild = prev;
+	if (prev)
+		prev->_next = std::move(tail);
+	else
+		parent->_firstChild = std::move(tail);
+	first->prev(nullptr);
+	for (XMLNode *node=first; node; node=node->next())
+		node->parent(nullptr);
+	return headOwner;
+}
+
+
+/** Links a detached sequence of sibling nodes [first, last] into the list of
+ *  child nodes, placing it after a given child, or at the beginning if 'sibling'
+ *  is a null pointer. Besides the boundary links, only the parent pointers of
+ *  the sequence are updated.
+ *  @param[in] first first node of the sequence (incl. ownership of the successors)
+ *  @param[in] last last node of the sequence
+ *  @param[in] sibling the sequence is inserted after this child node
+ *  @return raw pointer to the first inserted node */
+XMLNode* XMLElement::insertRange (unique_ptr<XMLNode> first, XMLNode *last, XMLNode *sibling) {
+	XMLNode *firstPtr = first.get();
+	for (XMLNode *node=firstPtr; node; node=node->next())
+		node->parent(this);
+	unique_ptr<XMLNode> &head = sibling ? sibling->_next : _firstChild;
+	last->_next = std::move(head);
+	if (last->_next)
+		last->_next->prev(last);
+	else
+		_lastChild = last;
+	first->prev(sibling);
+	head = std::move(first);
+	return firstPtr;
+}
+
+
+/** Moves all child nodes of a given element into this one by a single splice
+ *  operation, inserting them after a given child node, or at the beginning if
+ *  'sibling' is a null pointer. In contrast to moving the children one by one,
+ *  the sibling chain is relinked as a whole, so that only the parent pointers
+ *  of the moved nodes have to be updated.
+ *  @param[in] source element whose children are moved (empty afterwards)
+ *  @param[in] sibling the children are inserted after this child node
+ *  @return raw pointer to the first inserted node, or nullptr if there was nothing to move */
+XMLNode* XMLElement::spliceChildren (XMLElement *source, XMLNode *sibling) {
+	if (!source || source->empty() || (sibling && sibling->parent() != this))
+		return nullptr;
+	XMLNode *last = source->_lastChild;
+	auto first = detachRange(source->firstChild(), last);
+	return insertRange(std::move(first), last, sibling);
+}
+
+
 /** Moves a sequence of child nodes to a new element of a given name and inserts
  *  this (wrapper) element at the former position of the first node of the sequence.
  *  Example: wrap 3 child nodes of element a with b:
@@ -275,14 +418,9 @@ XMLElement* XMLElement::wrap (XMLNode *first, XMLNode *last, const string &name)
 	XMLElement *parent = first->parent()->toElement();
 	XMLNode *prev = first->prev();
 	auto wrapper = util::make_unique<XMLElement>(name);
-	if (last)
-		last = last->next();
-	XMLNode *child = first;
-	while (child && child != last) {
-		XMLNode *next = child->next();
-		wrapper->insertLast(detach(child));
-		child = next;
-	}
+	if (!last)
+		last = parent->lastChild();
+	wrapper->insertRange(detachRange(first, last), last, nullptr);
 	XMLElement *ret = wrapper.get();
 	if (prev)
 		parent->insertAfter(std::move(wrapper), prev);
@@ -305,12 +443,7 @@ XMLNode* XMLElement::unwrap (XMLElement *element) {
 	XMLElement *parent = element->parent()->toElement();
 	XMLNode *prev = element->prev();
 	auto detachedElement = util::static_unique_ptr_cast<XMLElement>(detach(element));
-	if (detachedElement->empty())
-		return nullptr;
-	XMLNode *firstChild = detachedElement->firstChild();
-	while (auto child = detach(detachedElement->firstChild()))
-		prev = parent->insertAfter(std::move(child), prev);
-	return firstChild;
+	return parent->spliceChildren(detachedElement.get(), prev);
 }
 
 
@@ -376,23 +509,42 @@ XMLElement* XMLElement::getFirstDescendant (const char *name, const char *attrNa
 }
 
 
-ostream& XMLElement::write (ostream &os) const {
-	os << '<' << _name;
+/** Writes the XML representation of the node to an output stream. The data is
+ *  collected in a large buffer and written to the stream in big chunks to avoid
+ *  the per-token overhead of the stream's formatted output operations. */
+ostream& XMLNode::write (ostream &os) const {
+	XMLOutputBuffer out(os);
+	serialize(out);
+	out.flush();
+	return os;
+}
+
+
+void XMLElement::serialize (XMLOutputBuffer &out) const {
+	out.put('<');
+	out.put(_name);
 	for (const auto &attrib : _attributes) {
-		os << ' ';
-		if (attrib.name.front() != '@')
-			os << attrib.name << "='" << attrib.value << '\'';
+		out.put(' ');
+		if (attrib.name().front() != '@') {
+			out.put(attrib.name());
+			out.put("='");
+			out.put(attrib.value());
+			out.put('\'');
+		}
 		else {
-			bool keep = (attrib.name.size() > 1 && attrib.name[1] == '@');
-			os << attrib.name.substr(keep ? 2 : 1) << "='";
-			auto pos = attrib.value.find("base64,");
+			bool keep = (attrib.name().size() > 1 && attrib.name()[1] == '@');
+			out.put(attrib.name().substr(keep ? 2 : 1));
+			out.put("='");
+			auto pos = attrib.value().find("base64,");
 			if (pos == string::npos)
-				os << attrib.value;
+				out.put(attrib.value());
 			else {
-				os << attrib.value.substr(0, pos+7);
-				string fname = attrib.value.substr(pos+7);
+				out.put(attrib.value().substr(0, pos+7));
+				string fname = attrib.value().substr(pos+7);
 				ifstream ifs(fname, ios::binary);
 				if (ifs) {
+					// the encoded file data bypasses the buffer and goes directly to the stream
+					ostream &os = out.os();
 					os << '\n';
 					util::base64_copy(ifs, os, 200);
 					ifs.close();
@@ -400,27 +552,59 @@ ostream& XMLElement::write (ostream &os) const {
 						FileSystem::remove(fname);
 				}
 			}
-			os << "'";
+			out.put('\'');
 		}
 	}
 	if (empty())
-		os << "/>";
+		out.put("/>");
 	else {
-		os << '>';
-		// Insert newlines around children except text nodes. According to the
-		// SVG specification, pure whitespace nodes are ignored by the SVG renderer.
-		if (WRITE_NEWLINES && name() != "text" && !_firstChild->toText())
-			os << '\n';
-		for (XMLNode *child = _firstChild.get(); child; child = child->next()) {
-			child->write(os);
-			if (!child->toText()) {
-				if (WRITE_NEWLINES && name() != "text" && (!child->next() || !child->next()->toText()))
-					os << '\n';
+		out.put('>');
+		if (!WRITE_NEWLINES) {
+			// compact mode: write the children without any formatting whitespace
+			for (XMLNode *child = _firstChild.get(); child; child = child->next())
+				child->serialize(out);
+		}
+		else {
+			// Insert newlines around children except text nodes. According to the
+			// SVG specification, pure whitespace nodes are ignored by the SVG renderer.
+			// The decision is made once per element rather than per child node.
+			bool breakLines = (name() != "text");
+			if (breakLines && !_firstChild->toText())
+				out.put('\n');
+			for (XMLNode *child = _firstChild.get(); child; child = child->next()) {
+				child->serialize(out);
+				if (breakLines && !child->toText() && (!child->next() || !child->next()->toText()))
+					out.put('\n');
 			}
 		}
-		os << "</" << _name << '>';
+		out.put("</");
+		out.put(_name);
+		out.put('>');
 	}
-	return os;
+}
+
+
+/** Serializes all child nodes preceding a given one and replaces them with a
+ *  single text node that contains their XML representation. Since the text node
+ *  also keeps the line breaks write() would have put around the removed nodes,
+ *  collapsing doesn't change the serialized form of the element. It just reduces
+ *  the amount of memory required to store already finished parts of the tree.
+ *  @param[in] stopNode first child node excluded from collapsing; if nullptr, all children are processed */
+void XMLElement::collapseChildren (XMLNode *stopNode) {
+	if (!_firstChild || _firstChild.get() == stopNode)
+		return;
+	ostringstream oss;
+	bool breakLines = WRITE_NEWLINES && name() != "text";
+	if (breakLines && !_firstChild->toText())
+		oss << '\n';
+	while (_firstChild && _firstChild.get() != stopNode) {
+		XMLNode *child = _firstChild.get();
+		child->write(oss);
+		if (breakLines && !child->toText() && (!child->next() || !child->next()->toText()))
+			oss << '\n';
+		detach(child);
+	}
+	prepend(util::make_unique<XMLText>(oss.str()));
 }
 
 
@@ -435,22 +619,24 @@ bool XMLElement::hasAttribute (const string &name) const {
  *  @return attribute value or 0 if attribute doesn't exist */
 const char* XMLElement::getAttributeValue (const std::string& name) const {
 	if (const Attribute *attr = getAttribute(name))
-		return attr->value.c_str();
+		return attr->value().c_str();
 	return nullptr;
 }
 
 
 XMLElement::Attribute* XMLElement::getAttribute (const string &name) {
+	const string *iname = Attribute::intern(name);
 	auto it = find_if(_attributes.begin(), _attributes.end(), [&](const Attribute &attr) {
-		return attr.name == name;
+		return attr._name == iname;
 	});
 	return it != _attributes.end() ? &(*it) : nullptr;
 }
 
 
 const XMLElement::Attribute* XMLElement::getAttribute (const string &name) const {
+	const string *iname = Attribute::intern(name);
 	auto it = find_if(_attributes.begin(), _attributes.end(), [&](const Attribute &attr) {
-		return attr.name == name;
+		return attr._name == iname;
 	});
 	return it != _attributes.end() ? &(*it) : nullptr;
 }
@@ -465,17 +651,18 @@ bool XMLElement::Attribute::inheritable () const {
 	// clip-path is not inheritable but can be moved to the parent element as long as
 	// no child gets an different clip-path attribute
 	// https://www.w3.org/TR/SVG11/styling.html#Inheritance
-	static const char *names[] = {
-			"clip-path", "clip-rule", "color", "color-interpolation", "color-interpolation-filters", "color-profile",
-			"color-rendering", "direction", "fill", "fill-opacity", "fill-rule", "font", "font-family", "font-size",
-			"font-size-adjust", "font-stretch", "font-style", "font-variant", "font-weight", "glyph-orientation-horizontal",
-			"glyph-orientation-vertical", "letter-spacing", "paint-order", "stroke", "stroke-dasharray", "stroke-dashoffset",
-			"stroke-linecap", "stroke-linejoin", "stroke-miterlimit", "stroke-opacity", "stroke-width", "transform",
-			"visibility", "word-spacing", "writing-mode"
+	static const unordered_set<const string*> names = {
+			intern("clip-path"), intern("clip-rule"), intern("color"), intern("color-interpolation"),
+			intern("color-interpolation-filters"), intern("color-profile"), intern("color-rendering"),
+			intern("direction"), intern("fill"), intern("fill-opacity"), intern("fill-rule"), intern("font"),
+			intern("font-family"), intern("font-size"), intern("font-size-adjust"), intern("font-stretch"),
+			intern("font-style"), intern("font-variant"), intern("font-weight"), intern("glyph-orientation-horizontal"),
+			intern("glyph-orientation-vertical"), intern("letter-spacing"), intern("paint-order"), intern("stroke"),
+			intern("stroke-dasharray"), intern("stroke-dashoffset"), intern("stroke-linecap"), intern("stroke-linejoin"),
+			intern("stroke-miterlimit"), intern("stroke-opacity"), intern("stroke-width"), intern("transform"),
+			intern("visibility"), intern("word-spacing"), intern("writing-mode")
 	};
-	return binary_search(std::begin(names), std::end(names), name, [](const string &name1, const string &name2) {
-		return name1 < name2;
-	});
+	return names.find(_name) != names.end();
 }
 
 
@@ -506,6 +693,12 @@ void XMLText::append (const string &str) {
 }
 
 
+/** Appends the UTF-8 encoding of a Unicode character to the text. */
+void XMLText::appendCodepoint (uint32_t cp) {
+	Unicode::appendUTF8(int32_t(cp), _text);
+}
+
+
 void XMLText::prepend (unique_ptr<XMLNode> node) {
 	if (XMLText *textNode = node->toText())
 		_text = textNode->_text + _text;
@@ -518,10 +711,12 @@ const XMLText* XMLText::toWSNode () const {
 
 /////////////////////////////////////////////////////////////////////
 
-ostream& XMLCData::write (ostream &os) const {
-	if (!_data.empty())
-		os << "<![CDATA[" << _data << "]]>";
-	return os;
+void XMLCData::serialize (XMLOutputBuffer &out) const {
+	if (!_data.empty()) {
+		out.put("<![CDATA[");
+		out.put(_data);
+		out.put("]]>");
+	}
 }
 
 
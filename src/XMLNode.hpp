@@ -27,6 +27,8 @@
 #include <ostream>
 #include <string>
 #include <vector>
+#include "MemoryPool.hpp"
+#include "RunStats.hpp"
 #include "utility.hpp"
 
 class XMLCData;
@@ -34,6 +36,53 @@ class XMLComment;
 class XMLElement;
 class XMLText;
 
+/** Collects the serialized XML data in a large reusable buffer and writes it to
+ *  the assigned output stream in megabyte chunks. This avoids the per-token
+ *  overhead of the stream's formatted output operations when serializing
+ *  documents consisting of many nodes. */
+class XMLOutputBuffer {
+	public:
+		explicit XMLOutputBuffer (std::ostream &os) : _os(os) {_buffer.reserve(BUFFER_SIZE);}
+		~XMLOutputBuffer () {flush();}
+
+		void put (char c) {
+			_buffer.push_back(c);
+			if (_buffer.size() >= BUFFER_SIZE)
+				flush();
+		}
+
+		void put (const char *str) {
+			_buffer.append(str);
+			if (_buffer.size() >= BUFFER_SIZE)
+				flush();
+		}
+
+		void put (const std::string &str) {
+			_buffer.append(str);
+			if (_buffer.size() >= BUFFER_SIZE)
+				flush();
+		}
+
+		/** Flushes the buffer and returns the target stream for direct output. */
+		std::ostream& os () {
+			flush();
+			return _os;
+		}
+
+		void flush () {
+			if (!_buffer.empty()) {
+				_os.write(_buffer.data(), std::streamsize(_buffer.size()));
+				_buffer.clear();
+			}
+		}
+
+	private:
+		static constexpr size_t BUFFER_SIZE = 1024*1024;
+		std::ostream &_os;
+		std::string _buffer;
+};
+
+
 class XMLNode {
 	friend class XMLElement;
 
@@ -43,13 +92,14 @@ class XMLNode {
 	}
 
 	public:
-		XMLNode () =default;
-		XMLNode (const XMLNode &node) : _next(nullptr) {}
+		XMLNode () {RunStats::count(RunStats::Counter::XML_NODES);}
+		XMLNode (const XMLNode &node) : _next(nullptr) {RunStats::count(RunStats::Counter::XML_NODES);}
 		XMLNode (XMLNode &&node) noexcept : _parent(node._parent), _prev(node._prev), _next(std::move(node._next)) {}
 		virtual ~XMLNode () =default;
 		virtual std::unique_ptr<XMLNode> clone () const =0;
 		virtual void clear () =0;
-		virtual std::ostream& write (std::ostream &os) const =0;
+		virtual void serialize (XMLOutputBuffer &out) const =0;
+		std::ostream& write (std::ostream &os) const;
 		virtual const XMLElement* toElement () const {return nullptr;}
 		virtual const XMLText* toText () const       {return nullptr;}
 		virtual const XMLText* toWSNode () const     {return nullptr;}
@@ -64,6 +114,12 @@ class XMLNode {
 		XMLNode* next () const    {return _next.get();}
 		XMLElement* nextElement () const;
 
+		// Since a page may consist of hundreds of thousands of nodes that are created
+		// and destroyed together, the node objects are taken from a memory pool rather
+		// than being allocated on the heap one by one.
+		void* operator new (size_t size) {return MemoryPool::instance().alloc(size);}
+		void operator delete (void *ptr, size_t size) noexcept {MemoryPool::instance().dealloc(ptr, size);}
+
 		static bool KEEP_ENCODED_FILES;
 
 	protected:
@@ -118,12 +174,26 @@ class ConstXMLNodeIterator {
 class XMLElement : public XMLNode {
 	public:
 		struct Attribute {
-			Attribute (std::string nam, std::string val) : name(std::move(nam)), value(std::move(val)) {}
+			Attribute (const std::string &name, std::string val) : _name(intern(name)), _value(internValue(std::move(val))) {}
 			bool inheritable () const;
-			std::string name;
-			std::string value;
+			const std::string& name () const {return *_name;}
+			const std::string& value () const {return *_value;}
+			void setValue (std::string val) {_value = internValue(std::move(val));}
+
+			/** Returns true if this and the given attribute have equal values.
+			 *  Attributes sharing a pooled value are detected by pointer equality. */
+			bool hasSameValue (const Attribute &attr) const {
+				return _value == attr._value || *_value == *attr._value;
+			}
+			static const std::string* intern (const std::string &name);
+
+			private:
+				static std::shared_ptr<const std::string> internValue (std::string value);
+				friend class XMLElement;
+				const std::string *_name;  ///< interned attribute name, unique per name
+				std::shared_ptr<const std::string> _value;  ///< attribute value, shared among attributes with equal pooled values
 		};
-		using Attributes = std::vector<Attribute>;
+		using Attributes = std::vector<Attribute, PoolAllocator<Attribute>>;
 		static bool WRITE_NEWLINES;  ///< insert line breaks after element tags?
 
 	public:
@@ -133,22 +203,25 @@ class XMLElement : public XMLNode {
 		~XMLElement () override;
 		std::unique_ptr<XMLNode> clone () const override {return util::make_unique<XMLElement>(*this);}
 		void clear () override;
-		void addAttribute (const std::string &name, const std::string &value);
+		void addAttribute (const std::string &name, std::string value);
 		void addAttribute (const std::string &name, double value);
 		void removeAttribute (const std::string &name);
 		XMLNode* append (std::unique_ptr<XMLNode> child);
-		XMLNode* append (const std::string &str);
+		XMLNode* append (std::string str);
+		XMLNode* appendUnicodeChar (uint32_t cp);
 		XMLNode* prepend (std::unique_ptr<XMLNode> child);
 		XMLNode* insertAfter (std::unique_ptr<XMLNode> child, XMLNode *sibling);
 		XMLNode* insertBefore (std::unique_ptr<XMLNode> child, XMLNode *sibling);
+		XMLNode* spliceChildren (XMLElement *source, XMLNode *sibling=nullptr);
 		bool hasAttribute (const std::string &name) const;
 		const char* getAttributeValue (const std::string &name) const;
 		bool getDescendants (const char *name, const char *attrName, std::vector<XMLElement*> &descendants) const;
 		XMLElement* getFirstDescendant (const char *name, const char *attrName, const char *attrValue) const;
 		XMLNode* firstChild () const {return _firstChild.get();}
 		XMLNode* lastChild () const {return _lastChild;}
-		std::ostream& write (std::ostream &os) const override;
+		void collapseChildren (XMLNode *stopNode=nullptr);
 		bool empty (bool ignoreWhitespace=false) const;
+		void serialize (XMLOutputBuffer &out) const override;
 		Attributes& attributes () {return _attributes;}
 		const Attributes& attributes () const {return _attributes;}
 		XMLNodeIterator begin () {return XMLNodeIterator(_firstChild.get());}
@@ -167,10 +240,12 @@ class XMLElement : public XMLNode {
 		Attribute* getAttribute (const std::string &name);
 		XMLNode* insertFirst (std::unique_ptr<XMLNode> child);
 		XMLNode* insertLast (std::unique_ptr<XMLNode> child);
+		static std::unique_ptr<XMLNode> detachRange (XMLNode *first, XMLNode *last);
+		XMLNode* insertRange (std::unique_ptr<XMLNode> first, XMLNode *last, XMLNode *sibling);
 
 	private:
 		std::string _name;     // element name (<name a1="v1" .. an="vn">...</name>)
-		std::vector<Attribute> _attributes;
+		Attributes _attributes;
 		std::unique_ptr<XMLNode> _firstChild;  ///< pointer to first child node (incl. ownership)
 		XMLNode *_lastChild=nullptr;  ///< pointer to last child node
 };
@@ -184,8 +259,9 @@ class XMLText : public XMLNode {
 		void append (std::unique_ptr<XMLNode> node);
 		void append (std::unique_ptr<XMLText> node);
 		void append (const std::string &str);
+		void appendCodepoint (uint32_t cp);
 		void prepend (std::unique_ptr<XMLNode> node);
-		std::ostream& write (std::ostream &os) const override {return os << _text;}
+		void serialize (XMLOutputBuffer &out) const override {out.put(_text);}
 		const std::string& getText () const {return _text;}
 		const XMLText* toText () const override {return this;}
 		const XMLText* toWSNode () const override;
@@ -200,7 +276,7 @@ class XMLComment : public XMLNode {
 		explicit XMLComment (std::string str) : _text(std::move(str)) {}
 		std::unique_ptr<XMLNode> clone () const override {return util::make_unique<XMLComment>(*this);}
 		void clear () override {_text.clear();}
-		std::ostream& write (std::ostream &os) const override {return os << "<!--" << _text << "-->";}
+		void serialize (XMLOutputBuffer &out) const override {out.put("<!--"); out.put(_text); out.put("-->");}
 		const XMLComment* toComment () const override {return this;}
 
 	private:
@@ -215,7 +291,7 @@ class XMLCData : public XMLNode {
 		std::unique_ptr<XMLNode> clone () const override {return util::make_unique<XMLCData>(*this);}
 		void clear () override                {_data.clear();}
 		void append (std::string &&str);
-		std::ostream& write (std::ostream &os) const override;
+		void serialize (XMLOutputBuffer &out) const override;
 		const XMLCData* toCData () const override {return this;}
 
 	private:
@@ -18,11 +18,21 @@
 ** along with this program; if not, see <http://www.gnu.org/licenses/>. **
 *************************************************************************/
 
-#include "InputReader.hpp"
+#include <cctype>
+#include <cstring>
 #include "XMLParser.hpp"
 
 using namespace std;
 
+static inline bool is_space (char c) {return isspace(static_cast<unsigned char>(c)) != 0;}
+
+/** Moves a position pointer to the next non-whitespace character. */
+static inline const char* skip_space (const char *p, const char *end) {
+	while (p != end && is_space(*p))
+		++p;
+	return p;
+}
+
 XMLElement* XMLParser::setRootElement (XMLElement *root) {
 	_elementStack.clear();
 	if (root)
@@ -177,48 +187,75 @@ XMLElement* XMLParser::finishPushContext (unique_ptr<XMLElement> elem) {
 }
 
 
-/** Processes an opening element tag.
+/** Processes an opening element tag. The tag data is scanned in place, i.e. the
+ *  element name and the attribute values are the only strings created while
+ *  tokenizing the tag since they outlive the parsing process as part of the
+ *  generated element node.
  *  @param[in] tag tag without leading and trailing angle brackets */
 XMLElement* XMLParser::openElement (const string &tag) {
-	StringInputBuffer ib(tag);
-	BufferInputReader ir(ib);
-	string name = ir.getString("/ \t\n\r");
-	ir.skipSpace();
-	unique_ptr<XMLElement> elemNode{createElementPtr(name)};
-	map<string, string> attribs;
-	if (ir.parseAttributes(attribs, true, "\"'")) {
-		for (const auto &attrpair : attribs)
-			elemNode->addAttribute(attrpair.first, attrpair.second);
+	const char *p = tag.data();
+	const char *end = p+tag.length();
+	const char *first = p;
+	while (p != end && *p > 0 && *p != '/' && !is_space(*p))
+		++p;
+	unique_ptr<XMLElement> elemNode{createElementPtr(string(first, p))};
+	// parse the attributes, a sequence of key-value pairs of the form KEY=VALUE or KEY="VALUE"
+	for (;;) {
+		p = skip_space(p, end);
+		if (p == end || !isalpha(static_cast<unsigned char>(*p)))  // first character of attribute name must be a letter
+			break;
+		first = p++;
+		while (p != end && (isalnum(static_cast<unsigned char>(*p)) || strchr("-:._", *p)))
+			++p;
+		const char *nameEnd = p;
+		p = skip_space(p, end);
+		if (p != end && *p == '=') {
+			p = skip_space(p+1, end);
+			if (p != end && (*p == '"' || *p == '\'')) {
+				char quote = *p++;
+				const char *valBegin = p;
+				while (p != end && *p != quote)
+					++p;
+				elemNode->addAttribute(string(first, nameEnd), string(valBegin, p));
+				if (p != end)  // skip closing quote character
+					++p;
+			}
+		}
 	}
-	ir.skipSpace();
 	XMLElement *elemPtr = elemNode.get();
-	if (ir.peek() == '/')       // end of empty element tag
+	if (p != end && *p == '/')  // end of empty element tag
 		appendNode(std::move(elemNode));
-	else if (ir.peek() < 0)   // end of opening tag
+	else if (p == end)          // end of opening tag
 		_elementStack.push_back(finishPushContext(std::move(elemNode)));
 	else
-		throw XMLParserException("'>' or '/>' expected at end of opening tag <"+name);
+		throw XMLParserException("'>' or '/>' expected at end of opening tag <"+elemPtr->name());
 	if (_notifyElementOpened)
 		_notifyElementOpened(elemPtr);
-	if (ir.peek() == '/' && _notifyElementClosed)
+	if (p != end && *p == '/' && _notifyElementClosed)
 		_notifyElementClosed(elemPtr);
 	return elemPtr;
 }
 
 
-/** Processes a closing element tag.
+/** Processes a closing element tag. Like openElement, this function scans the
+ *  tag data in place and only materializes the name string when required for
+ *  an error message.
  *  @param[in] tag tag without leading and trailing angle brackets */
 void XMLParser::closeElement (const string &tag) {
-	StringInputBuffer ib(tag);
-	BufferInputReader ir(ib);
-	string name = ir.getString(" \t\n\r");
-	ir.skipSpace();
-	if (ir.peek() >= 0)
-		throw XMLParserException("'>' expected at end of closing tag </"+name);
+	const char *p = skip_space(tag.data(), tag.data()+tag.length());
+	const char *end = tag.data()+tag.length();
+	const char *first = p;
+	while (p != end && *p > 0 && !is_space(*p))
+		++p;
+	const char *nameEnd = p;
+	p = skip_space(p, end);
+	if (p != end)
+		throw XMLParserException("'>' expected at end of closing tag </"+string(first, nameEnd));
 	if (_elementStack.size() <= 1)
-		throw XMLParserException("spurious closing tag </" + name + ">");
-	if (_elementStack.back()->name() != name)
-		throw XMLParserException("expected </" + _elementStack.back()->name() + "> but found </" + name + ">");
+		throw XMLParserException("spurious closing tag </" + string(first, nameEnd) + ">");
+	const string &topName = _elementStack.back()->name();
+	if (topName.compare(0, string::npos, first, nameEnd-first) != 0)
+		throw XMLParserException("expected </" + topName + "> but found </" + string(first, nameEnd) + ">");
 	finishPopContext();
 	if (_notifyElementClosed)
 		_notifyElementClosed(_elementStack.back());
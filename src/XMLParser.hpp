@@ -42,6 +42,10 @@ class XMLParser {
 		void parse (std::istream &is);
 		void parse (std::string xml, bool finish=false);
 		void finish ();
+
+		/** Returns true if the parser is waiting for further input to complete
+		 *  currently open elements or a partially received tag. */
+		bool pending () const {return _elementStack.size() > 1 || !_xmlbuf.empty();}
 		void setNotifyFuncs (NotifyFunc notifyElementOpened, NotifyFunc notifyElementClosed);
 
 	protected:
@@ -82,6 +82,59 @@ static inline double round (double x, int n) {
 }
 
 
+/** Writes the decimal representation of a double with up to six decimal places
+ *  directly into a caller-supplied buffer, which must provide at least 32 bytes.
+ *  Trailing zeros, a trailing dot, and a leading zero before the dot are omitted,
+ *  e.g. -0.5 => "-.5". The caller must ensure |x| < 1e12 so that the fixed-point
+ *  representation fits into an int64_t.
+ *  @param[in] x value to convert
+ *  @param[in] buf buffer taking the string representation
+ *  @return pointer to the terminating zero written to the buffer */
+static char* double_to_chars (double x, char *buf) {
+	char *p = buf;
+	if (std::signbit(x)) {
+		*p++ = '-';
+		x = -x;
+	}
+	// split the value before scaling to keep the fractional multiplication precise
+	auto ipart = static_cast<int64_t>(x);
+	auto fpart = static_cast<int>(llround((x-double(ipart))*1000000.0));
+	if (fpart == 1000000) {  // fractional part rounded up to the next integer?
+		ipart++;
+		fpart = 0;
+	}
+	if (ipart == 0) {
+		if (fpart == 0)
+			*p++ = '0';
+	}
+	else {
+		char digits[20];
+		int n=0;
+		while (ipart > 0) {
+			digits[n++] = char('0'+ipart%10);
+			ipart /= 10;
+		}
+		while (n > 0)
+			*p++ = digits[--n];
+	}
+	if (fpart > 0) {
+		char digits[6];
+		for (int i=5; i >= 0; i--) {
+			digits[i] = char('0'+fpart%10);
+			fpart /= 10;
+		}
+		int len=6;
+		while (digits[len-1] == '0')
+			len--;
+		*p++ = '.';
+		for (int i=0; i < len; i++)
+			*p++ = digits[i];
+	}
+	*p = 0;
+	return p;
+}
+
+
 XMLString::XMLString (double x) {
 	if (DECIMAL_PLACES > 0) {
 		// don't use fixed and setprecision() manipulators here to avoid
@@ -90,8 +143,14 @@ XMLString::XMLString (double x) {
 	}
 	if (std::abs(x) < 1e-6)
 		x = 0;
-	assign(util::to_string(x));
-	auto pos = find("0.");
-	if (pos != string::npos && (pos == 0 || at(pos-1) == '-'))
-		erase(pos, 1);
+	if (std::abs(x) < 1e12) {
+		char buf[32];
+		assign(buf, double_to_chars(x, buf)-buf);
+	}
+	else {  // fall back to generic formatting for huge values
+		assign(util::to_string(x));
+		auto pos = find("0.");
+		if (pos != string::npos && (pos == 0 || at(pos-1) == '-'))
+			erase(pos, 1);
+	}
 }
@@ -29,7 +29,7 @@
 #define ENABLE_XXH128
 #endif
 
-template <int HASH_SIZE>
+template <int HASH_SIZE, int VARIANT=0>
 struct XXHInterface {
 };
 
@@ -56,6 +56,18 @@ struct XXHInterface<8> {
 };
 
 #ifdef ENABLE_XXH128
+// SIMD-optimized 64-bit variant of the XXH3 algorithm family
+template<>
+struct XXHInterface<8,3> {
+	using State = XXH3_state_t;
+	using Digest = XXH64_hash_t;
+	static constexpr auto createState = &XXH3_createState;
+	static constexpr auto freeState = &XXH3_freeState;
+	static constexpr auto reset = &XXH3_64bits_reset_withSeed;
+	static constexpr auto update = &XXH3_64bits_update;
+	static constexpr auto digest = &XXH3_64bits_digest;
+};
+
 template<>
 struct XXHInterface<16> {
 	using State = XXH3_state_t;
@@ -69,9 +81,9 @@ struct XXHInterface<16> {
 #endif
 
 /** Implements the HashFunction class for the xxHash algorithms. */
-template <int HASH_BYTES>
+template <int HASH_BYTES, int VARIANT=0>
 class XXHashFunction : public HashFunction {
-	using Interface = XXHInterface<HASH_BYTES>;
+	using Interface = XXHInterface<HASH_BYTES, VARIANT>;
 	public:
 		XXHashFunction () : _state(Interface::createState()) {Interface::reset(_state, 0);}
 		XXHashFunction (const char *data, size_t length) : XXHashFunction() {update(data, length);}
@@ -101,6 +113,7 @@ using XXH32HashFunction = XXHashFunction<4>;
 using XXH64HashFunction = XXHashFunction<8>;
 
 #ifdef ENABLE_XXH128
+using XXH3HashFunction = XXHashFunction<8,3>;
 using XXH128HashFunction = XXHashFunction<16>;
 
 template<>
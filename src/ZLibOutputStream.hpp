@@ -42,8 +42,8 @@ class ZLibOutputBuffer : public std::streambuf {
 	public:
 		ZLibOutputBuffer () =default;
 
-		ZLibOutputBuffer (std::streambuf *sbuf, ZLibCompressionFormat format, int zipLevel) {
-			open(sbuf, format, zipLevel);
+		ZLibOutputBuffer (std::streambuf *sbuf, ZLibCompressionFormat format, int zipLevel, bool rsyncable=false) {
+			open(sbuf, format, zipLevel, rsyncable);
 		}
 
 		~ZLibOutputBuffer () override {
@@ -54,8 +54,9 @@ class ZLibOutputBuffer : public std::streambuf {
 		 *  @param[in] sink stream buffer taking the compressed data
 		 *  @param[in] format compression format (deflate or gzip)
 		 *  @param[in] zipLevel compression level (1-9)
+		 *  @param[in] rsyncable if true, the deflate state is reset at content-defined boundaries
 		 *  @return true if buffer is ready for writing */
-		bool open (std::streambuf *sink, ZLibCompressionFormat format, int zipLevel) {
+		bool open (std::streambuf *sink, ZLibCompressionFormat format, int zipLevel, bool rsyncable=false) {
 			if (sink) {
 				_inbuf.reserve(4096);
 				_zbuf.resize(4096);
@@ -65,6 +66,17 @@ class ZLibOutputBuffer : public std::streambuf {
 				zipLevel = std::max(1, std::min(9, zipLevel));
 				if (deflateInit2(&_zstream, zipLevel, Z_DEFLATED, 15+format, 8, Z_DEFAULT_STRATEGY) != Z_OK)
 					throw ZLibException("failed to initialize deflate compression");
+				_rsyncable = rsyncable;
+				if (rsyncable) {
+					_window.assign(RSYNC_WINDOW, 0);
+					_windowPos = _windowFill = 0;
+					_rollhash = 0;
+					// factor removing the contribution of the byte leaving the window,
+					// i.e. HASH_BASE^RSYNC_WINDOW (mod 2^32)
+					_outFactor = 1;
+					for (size_t i=0; i < RSYNC_WINDOW; i++)
+						_outFactor *= HASH_BASE;
+				}
 				_sink = sink;
 				_opened = true;
 			}
@@ -85,6 +97,8 @@ class ZLibOutputBuffer : public std::streambuf {
 				if (_inbuf.size() == _inbuf.capacity())
 					flush(Z_NO_FLUSH);
 				_inbuf.push_back(static_cast<unsigned char>(c));
+				if (_rsyncable)
+					updateRollingHash(static_cast<unsigned char>(c));
 			}
 			return c;
 		}
@@ -95,6 +109,32 @@ class ZLibOutputBuffer : public std::streambuf {
 		}
 
 	protected:
+		/** Updates the polynomial rolling hash over the last RSYNC_WINDOW input
+		 *  bytes and resets the deflate state whenever the hash hits the boundary
+		 *  condition. Since the boundaries depend on the window content only,
+		 *  identical input far behind a local change compresses to identical bytes
+		 *  again, so tools like rsync only need to transfer the changed chunks.
+		 *  This resembles gzip's --rsyncable option, but uses a polynomial hash
+		 *  instead of a plain byte sum, which also triggers reliably on the highly
+		 *  repetitive byte patterns of SVG path data. */
+		void updateRollingHash (unsigned char c) {
+			_rollhash = _rollhash*HASH_BASE + c;
+			if (_windowFill < RSYNC_WINDOW)
+				_windowFill++;
+			else
+				_rollhash -= _outFactor*_window[_windowPos];
+			_window[_windowPos] = c;
+			_windowPos = (_windowPos+1) % RSYNC_WINDOW;
+			// check the top BOUNDARY_BITS bits of the scrambled hash; the low bits of
+			// the product aren't sufficiently mixed since they only depend on the low
+			// bits of the hash value
+			if (_windowFill == RSYNC_WINDOW && (_rollhash*MIX_FACTOR) >> (32-BOUNDARY_BITS) == 0) {
+				flush(Z_FULL_FLUSH);
+				_windowFill = _windowPos = 0;
+				_rollhash = 0;
+			}
+		}
+
 		/** Compresses the chunk of data present in the input buffer
 		 *  and writes it to the assigned output stream.
 		 *  @param[in] flushmode flush mode of deflate function (Z_NO_FLUSH or Z_FINISH)
@@ -131,10 +171,21 @@ class ZLibOutputBuffer : public std::streambuf {
 		}
 
 	private:
+		static constexpr size_t RSYNC_WINDOW = 4096;       ///< number of input bytes the rolling hash covers
+		static constexpr unsigned HASH_BASE = 257;         ///< base of the polynomial rolling hash (mod 2^32)
+		static constexpr unsigned MIX_FACTOR = 2654435761u; ///< Knuth's multiplicative constant scrambling the hash bits
+		static constexpr unsigned BOUNDARY_BITS = 13;      ///< boundary probability 2^-13 per byte => chunks of 8 KB on average
+
 		z_stream _zstream;
 		std::streambuf *_sink = nullptr;  ///< target buffer where the compressded data is flushed to
 		std::vector<Bytef> _inbuf;  ///< buffer holding a chunk of data to be compressed
 		std::vector<Bytef> _zbuf;   ///< buffer holding a chunk of compressed data
+		std::vector<Bytef> _window; ///< circular buffer holding the input bytes covered by the rolling hash
+		size_t _windowPos = 0;      ///< position the next input byte is placed at
+		size_t _windowFill = 0;     ///< number of valid bytes in the window
+		unsigned _rollhash = 0;     ///< polynomial rolling hash over the window bytes
+		unsigned _outFactor = 1;    ///< HASH_BASE^RSYNC_WINDOW (mod 2^32)
+		bool _rsyncable = false;    ///< if true, reset the deflate state at content-defined boundaries
 		bool _opened = false;       ///< true if ready to process the incoming data correctly
 };
 
@@ -143,14 +194,14 @@ class ZLibOutputStream : private ZLibOutputBuffer, public std::ostream {
 	public:
 		ZLibOutputStream () : std::ostream(this) {}
 
-		ZLibOutputStream (std::ostream &os, ZLibCompressionFormat format, int zipLevel)
-			: ZLibOutputBuffer(os.rdbuf(), format, zipLevel), std::ostream(this) {}
+		ZLibOutputStream (std::ostream &os, ZLibCompressionFormat format, int zipLevel, bool rsyncable=false)
+			: ZLibOutputBuffer(os.rdbuf(), format, zipLevel, rsyncable), std::ostream(this) {}
 
 		~ZLibOutputStream () override {close();}
 
-		bool open (std::ostream &os, ZLibCompressionFormat format, int zipLevel) {
+		bool open (std::ostream &os, ZLibCompressionFormat format, int zipLevel, bool rsyncable=false) {
 			ZLibOutputBuffer::close();
-			return ZLibOutputBuffer::open(os.rdbuf(), format, zipLevel);
+			return ZLibOutputBuffer::open(os.rdbuf(), format, zipLevel, rsyncable);
 		}
 
 		void close () {
@@ -161,12 +212,12 @@ class ZLibOutputStream : private ZLibOutputBuffer, public std::ostream {
 
 class ZLibOutputFileStream : public ZLibOutputStream {
 	public:
-		ZLibOutputFileStream (const std::string &fname, ZLibCompressionFormat format, int zipLevel)
+		ZLibOutputFileStream (const std::string &fname, ZLibCompressionFormat format, int zipLevel, bool rsyncable=false)
 			: _ofs(fname, std::ios::binary)
 		{
 			if (_ofs) {
 				if (_ofs.rdbuf())
-					open(_ofs, format, zipLevel);
+					open(_ofs, format, zipLevel, rsyncable);
 				else
 					_ofs.close();
 			}
@@ -0,0 +1,245 @@
+/*************************************************************************
+** ZLibParallelOutputStream.hpp                                         **
+**                                                                      **
+** This file is part of dvisvgm -- a fast DVI to SVG converter          **
+** Copyright (C) 2005-2024 Martin Gieseking <martin.gieseking@uos.de>   **
+**                                                                      **
+** This program is free software; you can redistribute it and/or        **
+** modify it under the terms of the GNU General Public License as       **
+** published by the Free Software Foundation; either version 3 of       **
+** the License, or (at your option) any later version.                  **
+**                                                                      **
+** This program is distributed in the hope that it will be useful, but  **
+** WITHOUT ANY WARRANTY; without even the implied warranty of           **
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the         **
+** GNU General Public License for more details.                         **
+**                                                                      **
+** You should have received a copy of the GNU General Public License    **
+** along with this program; if not, see <http://www.gnu.org/licenses/>. **
+*************************************************************************/
+
+#ifndef ZLIBPARALLELOUTPUTSTREAM_HPP
+#define ZLIBPARALLELOUTPUTSTREAM_HPP
+
+#include <algorithm>
+#include <deque>
+#include <future>
+#include "ZLibOutputStream.hpp"
+
+/** Stream buffer that gzip-compresses the incoming data using multiple
+ *  threads. The data is split into fixed-size blocks which are deflated
+ *  independently by concurrent tasks and concatenated in order of arrival,
+ *  similar to the approach applied by pigz: each block except the last one
+ *  ends with an empty stored block (sync flush) so that the concatenation
+ *  of all blocks forms a single valid deflate stream. The block CRCs are
+ *  merged with crc32_combine() to get the checksum of the gzip trailer. */
+class ZLibParallelOutputBuffer : public std::streambuf {
+	public:
+		static constexpr size_t BLOCK_SIZE = 1024*1024;  ///< number of uncompressed bytes per block
+
+		ZLibParallelOutputBuffer () =default;
+
+		ZLibParallelOutputBuffer (std::streambuf *sbuf, int zipLevel, int numThreads) {
+			open(sbuf, zipLevel, numThreads);
+		}
+
+		~ZLibParallelOutputBuffer () override {
+			close();
+		}
+
+		/** Opens the buffer for writing and emits the gzip header.
+		 *  @param[in] sink stream buffer taking the compressed data
+		 *  @param[in] zipLevel compression level (1-9)
+		 *  @param[in] numThreads maximum number of concurrent compression tasks
+		 *  @return true if buffer is ready for writing */
+		bool open (std::streambuf *sink, int zipLevel, int numThreads) {
+			if (sink) {
+				_zipLevel = std::max(1, std::min(9, zipLevel));
+				_numThreads = std::max(1, numThreads);
+				_block.reserve(BLOCK_SIZE);
+				_crc = crc32(0, Z_NULL, 0);
+				_total = 0;
+				// gzip header: magic, deflate method, no flags/mtime/extra flags, OS=unix
+				static const unsigned char header[10] = {0x1f, 0x8b, 0x08, 0, 0, 0, 0, 0, 0, 0x03};
+				sink->sputn(reinterpret_cast<const char*>(header), 10);
+				_sink = sink;
+				_opened = true;
+			}
+			return _opened;
+		}
+
+		/** Flushes the remaining data, finishes the compression process, and
+		 *  closes the buffer so that further output doesn't reach the sink. */
+		void close () {
+			if (_opened) {
+				submitBlock(true);
+				while (!_pending.empty()) {
+					emitBlock(_pending.front().get());
+					_pending.pop_front();
+				}
+				// gzip trailer: CRC32 and size of the uncompressed data (little-endian)
+				unsigned char trailer[8];
+				for (int i=0; i < 4; i++) {
+					trailer[i] = static_cast<unsigned char>(_crc >> (8*i));
+					trailer[i+4] = static_cast<unsigned char>(_total >> (8*i));
+				}
+				_sink->sputn(reinterpret_cast<char*>(trailer), 8);
+				_sink = nullptr;
+				_opened = false;
+			}
+		}
+
+		int_type overflow (int_type c) override {
+			if (c == traits_type::eof())
+				close();
+			else {
+				_block.push_back(static_cast<unsigned char>(c));
+				if (_block.size() >= BLOCK_SIZE)
+					submitBlock(false);
+			}
+			return c;
+		}
+
+		std::streamsize xsputn (const char *buf, std::streamsize count) override {
+			auto *bytes = reinterpret_cast<const unsigned char*>(buf);
+			std::streamsize left = count;
+			while (left > 0) {
+				auto n = std::min(size_t(left), BLOCK_SIZE-_block.size());
+				_block.insert(_block.end(), bytes, bytes+n);
+				bytes += n;
+				left -= n;
+				if (_block.size() >= BLOCK_SIZE)
+					submitBlock(false);
+			}
+			return count;
+		}
+
+		int sync () override {
+			submitBlock(false);
+			while (!_pending.empty()) {
+				emitBlock(_pending.front().get());
+				_pending.pop_front();
+			}
+			return _sink ? _sink->pubsync() : 0;
+		}
+
+	protected:
+		struct CompressedBlock {
+			std::vector<unsigned char> zdata;  ///< deflated block data
+			unsigned long crc=0;               ///< CRC32 of the uncompressed block data
+			size_t size=0;                     ///< number of uncompressed bytes
+		};
+
+		/** Deflates a single block of data. Executed by the worker tasks.
+		 *  @param[in] data uncompressed block data
+		 *  @param[in] zipLevel compression level (1-9)
+		 *  @param[in] last if true, the deflate stream is finished, otherwise it ends with a sync flush
+		 *  @throws ZLibException if compression failed */
+		static CompressedBlock compressBlock (std::vector<unsigned char> data, int zipLevel, bool last) {
+			CompressedBlock block;
+			block.crc = crc32(0, data.data(), static_cast<uInt>(data.size()));
+			block.size = data.size();
+			z_stream zstream;
+			zstream.zalloc = Z_NULL;
+			zstream.zfree = Z_NULL;
+			zstream.opaque = Z_NULL;
+			// negative window size => raw deflate stream without zlib header/trailer
+			if (deflateInit2(&zstream, zipLevel, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+				throw ZLibException("failed to initialize deflate compression");
+			zstream.next_in = data.data();
+			zstream.avail_in = static_cast<uInt>(data.size());
+			int flushmode = last ? Z_FINISH : Z_SYNC_FLUSH;
+			size_t pos=0;
+			do {
+				block.zdata.resize(pos+16384);
+				zstream.next_out = block.zdata.data()+pos;
+				zstream.avail_out = 16384;
+				if (deflate(&zstream, flushmode) == Z_STREAM_ERROR) {
+					deflateEnd(&zstream);
+					throw ZLibException("stream error during data compression");
+				}
+				pos = block.zdata.size()-zstream.avail_out;
+			} while (zstream.avail_out == 0);
+			block.zdata.resize(pos);
+			deflateEnd(&zstream);
+			return block;
+		}
+
+		/** Passes the current input block to a background compression task.
+		 *  If the maximum number of concurrent tasks is already reached, the
+		 *  oldest one is finished and its result written to the sink first.
+		 *  @param[in] last true if no further data follows the current block */
+		void submitBlock (bool last) {
+			if (_block.empty() && !last)
+				return;
+			while (_pending.size() >= _numThreads) {
+				emitBlock(_pending.front().get());
+				_pending.pop_front();
+			}
+			int zipLevel = _zipLevel;
+			_pending.push_back(std::async(std::launch::async, [zipLevel, last](std::vector<unsigned char> &&data) {
+				return compressBlock(std::move(data), zipLevel, last);
+			}, std::move(_block)));
+			_block.clear();  // ensure defined state of the moved-from vector
+			_block.reserve(BLOCK_SIZE);
+		}
+
+		/** Writes a compressed block to the sink and updates the trailer data. */
+		void emitBlock (const CompressedBlock &block) {
+			_sink->sputn(reinterpret_cast<const char*>(block.zdata.data()), std::streamsize(block.zdata.size()));
+			_crc = crc32_combine(_crc, block.crc, long(block.size));
+			_total += block.size;
+		}
+
+	private:
+		std::streambuf *_sink = nullptr;  ///< target buffer where the compressed data is flushed to
+		int _zipLevel = Z_DEFAULT_COMPRESSION;  ///< compression level applied to each block
+		size_t _numThreads = 1;           ///< maximum number of concurrent compression tasks
+		std::vector<unsigned char> _block;  ///< uncompressed block currently being filled
+		std::deque<std::future<CompressedBlock>> _pending;  ///< compression tasks in flight, in block order
+		unsigned long _crc = 0;  ///< combined CRC32 of all data written so far
+		size_t _total = 0;       ///< total number of uncompressed bytes written so far
+		bool _opened = false;    ///< true if ready to process the incoming data correctly
+};
+
+
+class ZLibParallelOutputStream : private ZLibParallelOutputBuffer, public std::ostream {
+	public:
+		ZLibParallelOutputStream () : std::ostream(this) {}
+
+		ZLibParallelOutputStream (std::ostream &os, int zipLevel, int numThreads)
+			: ZLibParallelOutputBuffer(os.rdbuf(), zipLevel, numThreads), std::ostream(this) {}
+
+		~ZLibParallelOutputStream () override {close();}
+
+		bool open (std::ostream &os, int zipLevel, int numThreads) {
+			ZLibParallelOutputBuffer::close();
+			return ZLibParallelOutputBuffer::open(os.rdbuf(), zipLevel, numThreads);
+		}
+
+		void close () {
+			ZLibParallelOutputBuffer::close();
+		}
+};
+
+
+class ZLibParallelOutputFileStream : public ZLibParallelOutputStream {
+	public:
+		ZLibParallelOutputFileStream (const std::string &fname, int zipLevel, int numThreads)
+			: _ofs(fname, std::ios::binary)
+		{
+			if (_ofs) {
+				if (_ofs.rdbuf())
+					open(_ofs, zipLevel, numThreads);
+				else
+					_ofs.close();
+			}
+		}
+
+		~ZLibParallelOutputFileStream () override {close();}
+
+	private:
+		std::ofstream _ofs;
+};
+
+#endif
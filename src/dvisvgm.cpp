@@ -20,13 +20,16 @@
 
 #include <config.h>
 #include <algorithm>
+#include <chrono>
 #include <clipper.hpp>
 #include <fstream>
 #include <iostream>
 #include <potracelib.h>
 #include <sstream>
+#include <thread>
 #include <vector>
 #include <zlib.h>
+#include "Benchmark.hpp"
 #include "CommandLine.hpp"
 #include "DVIToSVG.hpp"
 #include "DVIToSVGActions.hpp"
@@ -35,21 +38,32 @@
 #include "FileSystem.hpp"
 #include "Font.hpp"
 #include "FontEngine.hpp"
+#include "FontManager.hpp"
 #include "Ghostscript.hpp"
 #include "HashFunction.hpp"
 #include "HyperlinkManager.hpp"
+#include "Jobserver.hpp"
+#include "MemoryStats.hpp"
 #include "Message.hpp"
+#include "PageRanges.hpp"
 #include "PageSize.hpp"
+#include "PageTimeout.hpp"
 #include "PDFHandler.hpp"
 #include "PDFToSVG.hpp"
 #include "PSInterpreter.hpp"
 #include "PsSpecialHandler.hpp"
+#include "RunStats.hpp"
+#include "ShadingPatch.hpp"
 #include "SignalHandler.hpp"
 #include "SourceInput.hpp"
+#include "SpecialManager.hpp"
 #include "optimizer/SVGOptimizer.hpp"
 #include "SVGOutput.hpp"
 #include "System.hpp"
+#include "ThreadPool.hpp"
+#include "Timing.hpp"
 #include "ttf/TTFWriter.hpp"
+#include "XMLNode.hpp"
 #include "XMLParser.hpp"
 #include "XXHashFunction.hpp"
 #include "utility.hpp"
@@ -109,13 +123,18 @@ static void set_libgs (CommandLine &args) {
 
 
 static bool set_cache_dir (const CommandLine &args) {
-	if (args.cacheOpt.given() && !args.cacheOpt.value().empty()) {
-		if (args.cacheOpt.value() == "none")
+	FontCache::MAX_DISK_SIZE = uint64_t(args.cacheLimitOpt.value())*1024*1024;
+	const string &cacheArg = args.cacheOpt.value();
+	const bool showCache = args.cacheOpt.given() && (cacheArg.empty() || cacheArg == "show");
+	const bool exportCache = args.cacheOpt.given() && cacheArg.compare(0, 7, "export:") == 0;
+	const bool importCache = args.cacheOpt.given() && cacheArg.compare(0, 7, "import:") == 0;
+	if (args.cacheOpt.given() && !cacheArg.empty() && !showCache && !exportCache && !importCache) {
+		if (cacheArg == "none")
 			PhysicalFont::CACHE_PATH.clear();
-		else if (FileSystem::exists(args.cacheOpt.value()))
-			PhysicalFont::CACHE_PATH = args.cacheOpt.value();
+		else if (FileSystem::exists(cacheArg))
+			PhysicalFont::CACHE_PATH = cacheArg;
 		else
-			Message::wstream(true) << "cache directory '" << args.cacheOpt.value() << "' does not exist (caching disabled)\n";
+			Message::wstream(true) << "cache directory '" << cacheArg << "' does not exist (caching disabled)\n";
 	}
 	else {
 		string &cachepath = PhysicalFont::CACHE_PATH;
@@ -137,17 +156,33 @@ static bool set_cache_dir (const CommandLine &args) {
 		if (!FileSystem::exists(cachepath))
 			FileSystem::mkdir(cachepath);
 	}
-	if (args.cacheOpt.given() && args.cacheOpt.value().empty()) {
+	if (exportCache || importCache) {
+		const string archivename = cacheArg.substr(7);
+		if (archivename.empty())
+			Message::wstream(true) << "no archive filename given in option --cache\n";
+		else if (PhysicalFont::CACHE_PATH.empty())
+			Message::wstream(true) << "no cache directory available\n";
+		else if (exportCache)
+			FontCache::exportArchive(PhysicalFont::CACHE_PATH, archivename, cout);
+		else
+			FontCache::importArchive(archivename, PhysicalFont::CACHE_PATH, cout);
+		return false;
+	}
+	if (showCache) {
 		cout << "cache directory: " << (PhysicalFont::CACHE_PATH.empty() ? "(none)" : PhysicalFont::CACHE_PATH) << '\n';
 		try {
-			if (!PhysicalFont::CACHE_PATH.empty())
+			if (!PhysicalFont::CACHE_PATH.empty()) {
 				FontCache::fontinfo(PhysicalFont::CACHE_PATH, cout, true);
+				FontCache::trim(PhysicalFont::CACHE_PATH, &cout);
+			}
 		}
 		catch (StreamReaderException &e) {
 			Message::wstream(true) << "failed reading cache data\n";
 		}
 		return false;
 	}
+	if (!PhysicalFont::CACHE_PATH.empty())
+		FileFinder::instance().enableLookupCache(PhysicalFont::CACHE_PATH);
 	return true;
 }
 
@@ -287,6 +322,12 @@ static void print_version (bool extended) {
 
 
 static void init_fontmap (const CommandLine &cmdline) {
+	// the map files only need to be parsed once per process, even if multiple
+	// files are converted or the conversion is repeated in watch mode
+	static bool initialized = false;
+	if (initialized)
+		return;
+	initialized = true;
 	string mapseq;
 	if (cmdline.fontmapOpt.given())
 		mapseq = cmdline.fontmapOpt.value();
@@ -325,10 +366,12 @@ static string svg_options_hash (const CommandLine &cmdline) {
 }
 
 
-static bool list_page_hashes (const CommandLine &cmdline, DVIToSVG &dvisvg) {
+static bool list_page_hashes (const CommandLine &cmdline, DVIToSVG &dvisvg, const string &inputfile) {
 	if (cmdline.pageHashesOpt.given()) {
 		DVIToSVG::PAGE_HASH_SETTINGS.setParameters(cmdline.pageHashesOpt.value());
 		DVIToSVG::PAGE_HASH_SETTINGS.setOptionHash(svg_options_hash(cmdline));
+		if (DVIToSVG::PAGE_HASH_SETTINGS.isSet(DVIToSVG::HashSettings::P_INDEX))
+			DVIToSVG::PAGE_HASH_SETTINGS.setIndexPath(inputfile+".hashes");
 		if (DVIToSVG::PAGE_HASH_SETTINGS.isSet(DVIToSVG::HashSettings::P_LIST)) {
 			dvisvg.listHashes(cmdline.pageOpt.value(), cout);
 			return true;
@@ -338,6 +381,41 @@ static bool list_page_hashes (const CommandLine &cmdline, DVIToSVG &dvisvg) {
 }
 
 
+/** Parses a comma-separated list of CPU numbers and ranges as passed to
+ *  option --affinity, e.g. "0,2-5,8".
+ *  @param[in] str string to parse
+ *  @return numbers of the listed CPUs */
+static vector<int> parse_cpu_list (const string &str) {
+	vector<int> cpus;
+	istringstream iss(str);
+	string entry;
+	while (getline(iss, entry, ',')) {
+		size_t dashpos = entry.find('-');
+		try {
+			size_t charsRead;
+			int first = stoi(entry, &charsRead);
+			int last = first;
+			if (dashpos != string::npos) {
+				size_t charsRead2;
+				last = stoi(entry.substr(dashpos+1), &charsRead2);
+				if (charsRead != dashpos || dashpos+1+charsRead2 != entry.length())
+					throw invalid_argument(entry);
+			}
+			else if (charsRead != entry.length())
+				throw invalid_argument(entry);
+			if (first < 0 || last < first)
+				throw invalid_argument(entry);
+			for (int cpu=first; cpu <= last; cpu++)
+				cpus.push_back(cpu);
+		}
+		catch (logic_error &) {  // covers invalid_argument and out_of_range
+			throw CL::CommandLineException("invalid argument '"+str+"' supplied for option --affinity");
+		}
+	}
+	return cpus;
+}
+
+
 static void set_variables (const CommandLine &cmdline) {
 	Message::COLORIZE = cmdline.colorOpt.given();
 	if (cmdline.progressOpt.given()) {
@@ -362,22 +440,87 @@ static void set_variables (const CommandLine &cmdline) {
 		msg += ")";
 		throw CL::CommandLineException(msg);
 	}
+	FontWriter::COMPRESSION_LEVEL = max(0, min(11, cmdline.fontCompressionOpt.value()));
 	SVGTree::CREATE_USE_ELEMENTS = cmdline.noFontsOpt.value() < 1;
 	SVGTree::ZOOM_FACTOR = cmdline.zoomOpt.value();
 	SVGTree::RELATIVE_PATH_CMDS = cmdline.relativeOpt.given();
 	SVGTree::MERGE_CHARS = !cmdline.noMergeOpt.given();
 	SVGTree::ADD_COMMENTS = cmdline.commentsOpt.given();
+	XMLElement::WRITE_NEWLINES = !cmdline.compactOpt.given();
 	DVIToSVG::TRACE_MODE = cmdline.traceAllOpt.given() ? (cmdline.traceAllOpt.value() ? 'a' : 'm') : 0;
+	if (cmdline.affinityOpt.given())
+		ThreadPool::AFFINITY_CPUS = parse_cpu_list(cmdline.affinityOpt.value());
+	Jobserver::ENABLED = cmdline.jobserverOpt.given();
+	DVIToSVG::NUM_JOBS = cmdline.jobsOpt.given() && cmdline.jobsOpt.value() == 0
+		? unsigned(System::numberOfCPUs())
+		: max(1u, cmdline.jobsOpt.value());
+	DVIToSVG::COMBINE_PAGES = cmdline.multipageOpt.given();
+	if (cmdline.fontCssOpt.given()) {
+		if (!SVGTree::USE_FONTS || !SVGTree::CREATE_CSS || SVGTree::FONT_FORMAT == FontWriter::FontFormat::SVG)
+			Message::wstream(true) << "option --font-css ignored since it requires CSS font styles and a web font format\n";
+		else if (DVIToSVG::COMBINE_PAGES)
+			Message::wstream(true) << "option --font-css ignored since --multipage embeds the fonts only once anyway\n";
+		else
+			DVIToSVG::FONT_CSS_FILE = cmdline.fontCssOpt.value();
+	}
+	if (cmdline.manifestOpt.given()) {
+		if (!cmdline.pageHashesOpt.given())
+			Message::wstream(true) << "option --manifest ignored since it requires --page-hashes\n";
+		else if (DVIToSVG::COMBINE_PAGES)
+			Message::wstream(true) << "option --manifest ignored since --multipage doesn't create one file per page\n";
+		else
+			DVIToSVG::PAGE_MANIFEST_FILE = cmdline.manifestOpt.value();
+	}
+	if (cmdline.bundleOpt.given()) {
+		if (cmdline.stdoutOpt.given())
+			Message::wstream(true) << "option --bundle ignored since the output is written to stdout\n";
+		else if (DVIToSVG::COMBINE_PAGES)
+			Message::wstream(true) << "option --bundle ignored since --multipage creates a single self-contained file\n";
+		else {
+			string dirname = cmdline.bundleOpt.value();
+			if (!FileSystem::exists(dirname) && !FileSystem::mkdir(dirname))
+				throw CL::CommandLineException("can't create bundle directory '"+dirname+"'");
+			// The pages, the shared font CSS, and the index are located in the same
+			// directory, so the fonts are embedded only once per document and the
+			// bundle can be published or packed without a further deduplication pass.
+			if (DVIToSVG::FONT_CSS_FILE.empty() && SVGTree::USE_FONTS && SVGTree::CREATE_CSS && SVGTree::FONT_FORMAT != FontWriter::FontFormat::SVG)
+				DVIToSVG::FONT_CSS_FILE = dirname+"/fonts.css";
+			if (DVIToSVG::PAGE_MANIFEST_FILE.empty())
+				DVIToSVG::PAGE_MANIFEST_FILE = dirname+"/index.json";
+		}
+	}
+	SVGOutput::ZIP_THREADS = cmdline.zipThreadsOpt.given() && cmdline.zipThreadsOpt.value() == 0
+		? System::numberOfCPUs()
+		: max(1, cmdline.zipThreadsOpt.value());
+	SVGOutput::ZIP_RSYNCABLE = cmdline.zipRsyncableOpt.given();
+	if (cmdline.pageFramesOpt.given()) {
+		if (!cmdline.stdoutOpt.given())
+			Message::wstream(true) << "option --page-frames ignored since it requires --stdout\n";
+		else
+			SVGOutput::PAGE_FRAMES = true;
+	}
+	PageTimeout::SECONDS = max(0.0, cmdline.timeoutOpt.value());
 	Message::LEVEL = cmdline.verbosityOpt.value();
+	Timing::ENABLED = cmdline.timingsOpt.given();
+	Timing::TRACING = cmdline.timingsOpt.given() && !cmdline.timingsOpt.value().empty();
+	DVIToSVG::MAX_MEMORY_BYTES = size_t(cmdline.maxMemoryOpt.value())*1024*1024;
+	DVIToSVGActions::ISOLATE_SPECIALS = cmdline.isolateSpecialsOpt.given();
+	DVIToSVG::PREFETCH_FONTS = cmdline.prefetchFontsOpt.given();
+	MemoryStats::REPORT = cmdline.memStatsOpt.given();
+	MemoryStats::ENABLED = MemoryStats::REPORT || DVIToSVG::MAX_MEMORY_BYTES > 0;
+	RunStats::ENABLED = cmdline.runStatsOpt.given();
 	PhysicalFont::EXACT_BBOX = cmdline.exactBboxOpt.given();
 	PhysicalFont::KEEP_TEMP_FILES = cmdline.keepOpt.given();
 	PhysicalFont::METAFONT_MAG = max(1.0, cmdline.magOpt.value());
 	XMLString::DECIMAL_PLACES = max(0, min(6, cmdline.precisionOpt.value()));
 	XMLNode::KEEP_ENCODED_FILES = cmdline.keepOpt.given();
 	PsSpecialHandler::COMPUTE_CLIPPATHS_INTERSECTIONS = cmdline.clipjoinOpt.given();
+	PsSpecialHandler::SHADING_MAX_SEGMENTS = max(0, cmdline.gradLimitOpt.value());
+	PsSpecialHandler::SHADING_MESH_GRADIENTS = cmdline.gradMeshOpt.given();
 	PsSpecialHandler::SHADING_SEGMENT_OVERLAP = cmdline.gradOverlapOpt.given();
 	PsSpecialHandler::SHADING_SEGMENT_SIZE = max(1, cmdline.gradSegmentsOpt.value());
 	PsSpecialHandler::SHADING_SIMPLIFY_DELTA = cmdline.gradSimplifyOpt.value();
+	ShadingPatch::LOD = max(0.0, cmdline.gradLodOpt.value());
 	PsSpecialHandler::BITMAP_FORMAT = util::tolower(cmdline.bitmapFormatOpt.value());
 #ifdef TTFDEBUG
 	ttf::TTFWriter::CREATE_PS_GLYPH_OUTLINES = cmdline.debugGlyphsOpt.given();
@@ -402,6 +545,19 @@ static void set_variables (const CommandLine &cmdline) {
 			throw CL::CommandLineException(msg);
 		}
 	}
+	if (cmdline.streamPagesOpt.given()) {
+		// early serialized page parts are no longer accessible to the optimizer modules
+		if (cmdline.optimizeOpt.given() && cmdline.optimizeOpt.value() != "none")
+			Message::wstream(true) << "option --stream-pages ignored since it conflicts with --optimize\n";
+		else if (cmdline.isolateSpecialsOpt.given()) {
+			// early serialization invalidates the rollback points taken before the execution of a special
+			Message::wstream(true) << "option --stream-pages ignored since it conflicts with --isolate-specials\n";
+		}
+		else {
+			SVGTree::FLUSH_PAGE_NODES = true;
+			SVGOptimizer::MODULE_SEQUENCE = "none";
+		}
+	}
 }
 
 
@@ -418,6 +574,116 @@ static void timer_message (double start_time, const pair<int,int> *pageinfo) {
 }
 
 
+/** Splits a set of page ranges into at most 'parts' contiguous chunks of almost
+ *  equal size, and returns the corresponding page range strings.
+ *  @param[in] ranges page ranges to split
+ *  @param[in] parts number of chunks to create
+ *  @return the range strings describing the chunks */
+static vector<string> split_page_ranges (const PageRanges &ranges, unsigned parts) {
+	vector<int> pages;
+	for (auto it = ranges.valuesBegin(); it != ranges.valuesEnd(); ++it)
+		pages.push_back(*it);
+	parts = max(1u, min(parts, static_cast<unsigned>(pages.size())));
+	vector<string> rangeStrings;
+	size_t start=0;
+	for (unsigned i=0; i < parts; i++) {
+		size_t count = pages.size()/parts + (i < pages.size()%parts ? 1 : 0);
+		size_t end = start+count;
+		string rangestr;
+		for (size_t first=start; first < end;) {
+			size_t last = first;
+			while (last+1 < end && pages[last+1] == pages[last]+1)
+				last++;
+			if (!rangestr.empty())
+				rangestr += ',';
+			rangestr += to_string(pages[first]);
+			if (last > first)
+				rangestr += '-'+to_string(pages[last]);
+			first = last+1;
+		}
+		rangeStrings.push_back(std::move(rangestr));
+		start = end;
+	}
+	return rangeStrings;
+}
+
+
+/** Returns the output filename pattern to be used for the conversion. In bundle
+ *  mode, the (default) pattern is prefixed with the bundle directory so that all
+ *  page files end up next to the shared assets and the index file. */
+static string output_pattern (const CommandLine &cmdline) {
+	string pattern = cmdline.outputOpt.value();
+	if (cmdline.bundleOpt.given() && !cmdline.stdoutOpt.given() && !DVIToSVG::COMBINE_PAGES) {
+		if (pattern.empty())
+			pattern = "%f-%p";
+		pattern = cmdline.bundleOpt.value()+"/"+pattern;
+	}
+	return pattern;
+}
+
+
+/** Converts the selected pages of a DVI file using multiple worker threads.
+ *  The pages are split into contiguous subranges each of which is processed by a
+ *  separate DVIToSVG instance reading from its own file stream. Since several of
+ *  the involved components are process-wide singletons, the page execution itself
+ *  is still serialized by DVIToSVG, while the SVG serialization and the output
+ *  compression run concurrently.
+ *  @param[in] dvipath path of the DVI file to convert
+ *  @param[in] outbase base name used to construct the output file names
+ *  @param[in] numPages total number of pages present in the DVI file
+ *  @param[in] fnameIndex number of the input file being processed
+ *  @param[in] cmdline command-line options
+ *  @param[out] pageinfo (number of converted pages, number of total pages) */
+static void convert_dvi_parallel (const string &dvipath, const string &outbase, unsigned numPages, size_t fnameIndex, const CommandLine &cmdline, pair<int,int> *pageinfo) {
+	PageRanges ranges;
+	if (!ranges.parse(cmdline.pageOpt.value(), numPages))
+		throw MessageException("invalid page range format");
+	vector<thread> threads;
+	mutex mtx;
+	exception_ptr exptr;
+	int convertedPages=0;
+	// If a make jobserver governs the parallelism budget, the process holds one
+	// implicit job slot; each additional conversion thread requires a token.
+	unsigned numJobs = DVIToSVG::NUM_JOBS;
+	size_t jobserverTokens = 0;
+	if (numJobs > 1 && Jobserver::instance().active()) {
+		jobserverTokens = Jobserver::instance().acquireTokens(numJobs-1);
+		numJobs = unsigned(1+jobserverTokens);
+	}
+	for (const string &rangestr : split_page_ranges(ranges, numJobs)) {
+		threads.emplace_back([&,rangestr]() {
+			try {
+				ifstream ifs(dvipath, ios::binary);
+				SVGOutput out(outbase, output_pattern(cmdline), cmdline.zipOpt.given() ? cmdline.zipOpt.value() : 0);
+				out.setFileNumbers(fnameIndex+1, cmdline.filenames().size());
+				DVIToSVG dvi2svg(ifs, out);
+				dvi2svg.setPageTransformation(get_transformation_string(cmdline));
+				dvi2svg.setPageSize(cmdline.bboxOpt.value());
+				dvi2svg.setUserMessage(cmdline.messageOpt.value());
+				pair<int,int> info;
+				dvi2svg.convert(rangestr, &info);
+				lock_guard<mutex> lock(mtx);
+				convertedPages += info.first;
+			}
+			catch (...) {
+				lock_guard<mutex> lock(mtx);
+				if (!exptr)
+					exptr = current_exception();
+			}
+		});
+	}
+	for (thread &t : threads)
+		t.join();
+	Jobserver::instance().releaseTokens(jobserverTokens);
+	if (exptr)
+		rethrow_exception(exptr);
+	if (pageinfo) {
+		pageinfo->first = convertedPages;
+		pageinfo->second = numPages;
+	}
+}
+
+
 static void convert_file (size_t fnameIndex, const CommandLine &cmdline) {
 	const char *suffix = cmdline.epsOpt.given() ? "eps" : cmdline.pdfOpt.given() ? "pdf" : "dvi";
 	string inputfile = ensure_suffix(cmdline.filenames()[fnameIndex], suffix);
@@ -428,7 +694,7 @@ static void convert_file (size_t fnameIndex, const CommandLine &cmdline) {
 	double start_time = System::time();
 	set_variables(cmdline);
 	SVGOutput out(cmdline.stdoutOpt.given() ? "" : srcin.getFileName(),
-					  cmdline.outputOpt.value(),
+					  output_pattern(cmdline),
 					  cmdline.zipOpt.given() ? cmdline.zipOpt.value() : 0);
 	out.setFileNumbers(fnameIndex+1, cmdline.filenames().size());
 	pair<int,int> pageinfo;
@@ -437,6 +703,10 @@ static void convert_file (size_t fnameIndex, const CommandLine &cmdline) {
 				cmdline.epsOpt.given()
 				? static_cast<ImageToSVG*>(new EPSToSVG(srcin.getFilePath(), out))
 				: static_cast<ImageToSVG*>(new PDFToSVG(srcin.getFilePath(), out)));
+		if (cmdline.cacheResultsOpt.given() && !PhysicalFont::CACHE_PATH.empty()) {
+			ImageToSVG::RESULT_STORE_DIR = PhysicalFont::CACHE_PATH;
+			ImageToSVG::OPTIONS_HASH = svg_options_hash(cmdline);
+		}
 		img2svg->setPageTransformation(get_transformation_string(cmdline));
 		img2svg->setUserMessage(cmdline.messageOpt.value());
 		img2svg->convert(cmdline.pageOpt.value(), &pageinfo);
@@ -445,7 +715,7 @@ static void convert_file (size_t fnameIndex, const CommandLine &cmdline) {
 	else {
 		init_fontmap(cmdline);
 		DVIToSVG dvi2svg(srcin.getInputStream(), out);
-		if (!list_page_hashes(cmdline, dvi2svg)) {
+		if (!list_page_hashes(cmdline, dvi2svg, inputfile)) {
 			const char *ignore_specials = nullptr;
 			if (cmdline.noSpecialsOpt.given())
 				ignore_specials = cmdline.noSpecialsOpt.value().empty() ? "*" : cmdline.noSpecialsOpt.value().c_str();
@@ -453,13 +723,73 @@ static void convert_file (size_t fnameIndex, const CommandLine &cmdline) {
 			dvi2svg.setPageTransformation(get_transformation_string(cmdline));
 			dvi2svg.setPageSize(cmdline.bboxOpt.value());
 			dvi2svg.setUserMessage(cmdline.messageOpt.value());
-			dvi2svg.convert(cmdline.pageOpt.value(), &pageinfo);
+			if (DVIToSVG::NUM_JOBS > 1 && !cmdline.stdoutOpt.given() && !srcin.getFileName().empty())
+				convert_dvi_parallel(srcin.getFilePath(), srcin.getFileName(), dvi2svg.numberOfPages(), fnameIndex, cmdline, &pageinfo);
+			else
+				dvi2svg.convert(cmdline.pageOpt.value(), &pageinfo);
 			timer_message(start_time, &pageinfo);
 		}
 	}
 }
 
 
+/** Converts the input file and reconverts it each time it has been modified.
+ *  The function keeps the process alive until it's interrupted by Ctrl-C, so
+ *  the startup costs (loading the Ghostscript library, setting up kpathsea,
+ *  reading the font map files) are only paid once, and fonts already loaded by
+ *  the FontManager are reused across the conversions. Combined with option
+ *  --page-hashes=...,index, only the modified pages are reconverted.
+ *  @param[in] cmdline command-line arguments the conversions are based on */
+static void watch_input_file (const CommandLine &cmdline) {
+	if (cmdline.filenames().size() != 1 || cmdline.filenames()[0].empty())
+		throw MessageException("option --watch requires a single input file");
+	if (cmdline.stdoutOpt.given())
+		throw MessageException("options --watch and --stdout can't be used together");
+	const string fname = ensure_suffix(cmdline.filenames()[0], cmdline.epsOpt.given() ? "eps" : cmdline.pdfOpt.given() ? "pdf" : "dvi");
+	int64_t mtime=0;
+	for (;;) {
+		int64_t currentMtime = FileSystem::mtime(fname);
+		if (currentMtime != mtime && FileSystem::exists(fname)) {
+			mtime = currentMtime;
+			// drop the document-specific state left behind by the previous conversion
+			FontManager::instance().resetFontNumbers();
+			HyperlinkManager::instance().reset();
+			SpecialManager::instance().unregisterHandlers();
+			try {
+				convert_file(0, cmdline);
+			}
+			catch (MessageException &e) {
+				// keep watching; the file may have been picked up in an incomplete
+				// state while TeX was still writing it
+				Message::estream() << e.what() << '\n';
+			}
+			if (Timing::ENABLED) {
+				Timing::write(cout);
+				if (Timing::TRACING && !Timing::writeTraceFile(cmdline.timingsOpt.value()))
+					Message::wstream(true) << "failed to write timing trace file '" << cmdline.timingsOpt.value() << "'\n";
+				Timing::reset();
+			}
+			if (MemoryStats::REPORT) {
+				MemoryStats::write(cout, "total");
+				MemoryStats::reset();
+			}
+			if (RunStats::ENABLED) {
+				RunStats::write(cout);
+				RunStats::reset();
+			}
+			if (SVGOptimizer::STATS) {
+				SVGOptimizer::writeStats(cout);
+				SVGOptimizer::resetStats();
+			}
+			Message::mstream().indent(0);
+			Message::mstream(true) << "watching " << fname << " for changes (press Ctrl-C to quit)\n";
+		}
+		this_thread::sleep_for(chrono::milliseconds(250));
+		SignalHandler::instance().check();
+	}
+}
+
+
 int main (int argc, char *argv[]) {
 	try {
 		CommandLine cmdline;
@@ -488,6 +818,16 @@ int main (int argc, char *argv[]) {
 		check_bbox(cmdline.bboxOpt.value());
 		if (!HyperlinkManager::setLinkMarker(cmdline.linkmarkOpt.value()))
 			Message::wstream(true) << "invalid argument '"+cmdline.linkmarkOpt.value()+"' supplied for option --linkmark\n";
+		if (cmdline.benchOpt.given()) {
+			Benchmark::Parameters params;
+			if (!Benchmark::parseParameters(cmdline.benchOpt.value(), params))
+				throw MessageException("invalid benchmark parameters '"+cmdline.benchOpt.value()+"'");
+			set_variables(cmdline);
+			init_fontmap(cmdline);
+			SignalHandler::instance().start();
+			Benchmark(params).run(cout);
+			return 0;
+		}
 		if (cmdline.stdinOpt.given() || cmdline.singleDashGiven()) {
 			if (!cmdline.filenames().empty())
 				throw MessageException("option - or --stdin can't be used together with a filename");
@@ -497,9 +837,47 @@ int main (int argc, char *argv[]) {
 			throw MessageException("no input file given");
 
 		SignalHandler::instance().start();
-		size_t numFiles = cmdline.epsOpt.given() ? cmdline.filenames().size() : 1;
-		for (size_t i=0; i < numFiles; i++)
-			convert_file(i, cmdline);
+#ifndef DISABLE_GS
+		if (!cmdline.noSpecialsOpt.given()) {
+			// warm up the PS interpreter in the background so that the fixed
+			// Ghostscript startup costs overlap the document processing
+			// preceding the first PostScript special
+			PsSpecialHandler::sharedInterpreter().initAsync();
+		}
+#endif
+		if (cmdline.watchOpt.given())
+			watch_input_file(cmdline);
+		else {
+			size_t numFiles = cmdline.filenames().size();
+			if (numFiles > 1 && cmdline.stdoutOpt.given())
+				throw MessageException("option --stdout can't be used when converting multiple files");
+			for (size_t i=0; i < numFiles; i++) {
+				if (i > 0) {
+					// drop the document-specific state left behind by the previous conversion;
+					// the shared read-only state (font maps, loaded fonts, kpathsea lookups,
+					// and the Ghostscript instance) stays warm across the files
+					FontManager::instance().resetFontNumbers();
+					HyperlinkManager::instance().reset();
+					SpecialManager::instance().unregisterHandlers();
+				}
+				convert_file(i, cmdline);
+			}
+			if (Timing::ENABLED) {
+				Timing::write(cout);
+				if (Timing::TRACING && !Timing::writeTraceFile(cmdline.timingsOpt.value()))
+					Message::wstream(true) << "failed to write timing trace file '" << cmdline.timingsOpt.value() << "'\n";
+			}
+			if (MemoryStats::REPORT)
+				MemoryStats::write(cout, "total");
+			if (RunStats::ENABLED)
+				RunStats::write(cout);
+			if (SVGOptimizer::STATS)
+				SVGOptimizer::writeStats(cout);
+			if (!PhysicalFont::CACHE_PATH.empty()) {
+				FontCache::updateStatistics(PhysicalFont::CACHE_PATH);
+				FontCache::trim(PhysicalFont::CACHE_PATH);
+			}
+		}
 	}
 	catch (DVIException &e) {
 		Message::estream() << "\nDVI error: " << e.what() << '\n';
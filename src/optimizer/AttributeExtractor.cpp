@@ -24,27 +24,18 @@
 
 using namespace std;
 
-/** Constructs a new run object for an attribute and a sequence of sibling nodes.
- *  @param[in] attr attribute to look for
- *  @param[in] first first element of node sequence to scan */
-AttributeExtractor::AttributeRun::AttributeRun (const Attribute &attr, XMLElement *first) {
-	_length = 1;
-	_first = first;
-	for (_last=_first->next(); _last; _last=_last->next()) {
-		if (_last->toText() || _last->toCData())  // don't include text/CDATA nodes
-			break;
-		if (XMLElement *childElem = _last->toElement()) {
-			if (!groupable(*childElem))
-				break;
-			const char *val = childElem->getAttributeValue(attr.name);
-			if (val && val == attr.value)
-				++_length;
-			else
-				break;
-		}
+/** Constructs a new run object from its first element and its precomputed length.
+ *  @param[in] first first element of the run
+ *  @param[in] length number of elements the run consists of */
+AttributeExtractor::AttributeRun::AttributeRun (XMLElement *first, int length) {
+	_length = length;
+	_first = _last = first;
+	while (--length > 0) {
+		XMLNode *node = _last->next();
+		while (node && !node->toElement())  // skip comments and PIs between the run elements
+			node = node->next();
+		_last = node;
 	}
-	if (_first != _last && _last)
-		_last = _last->prev();
 }
 
 
@@ -67,6 +58,7 @@ void AttributeExtractor::execute (XMLElement *context, bool recurse) {
 				execute(elem, true);
 		}
 	}
+	computeRunLengths(context);
 	for (XMLNode *child=context->firstChild(); child; child=child->next()) {
 		if (XMLElement *elem = child->toElement())
 			child = extractAttribute(elem);
@@ -74,6 +66,48 @@ void AttributeExtractor::execute (XMLElement *context, bool recurse) {
 }
 
 
+/** Computes the attribute run lengths of all child elements of a context node in a
+ *  single right-to-left pass, i.e. for each attribute of each groupable element the
+ *  number of adjacent elements (including the element itself) that share it. This
+ *  avoids rescanning the sibling sequence for every attribute of every element,
+ *  which gets expensive on wide sibling lists.
+ *  @param[in] context the run lengths of all children of this element are computed */
+void AttributeExtractor::computeRunLengths (XMLElement *context) {
+	XMLElement *nextElem = nullptr;  // successor of the current element inside the same run segment
+	for (XMLNode *child=context->lastChild(); child; child=child->prev()) {
+		if (child->toText() || child->toCData())  // runs must not span text/CDATA nodes
+			nextElem = nullptr;
+		else if (XMLElement *elem = child->toElement()) {
+			if (!groupable(*elem))
+				nextElem = nullptr;
+			else {
+				vector<int> &lengths = _runLengths[elem];
+				lengths.clear();
+				lengths.reserve(elem->attributes().size());
+				const vector<int> *nextLengths = nextElem ? &_runLengths[nextElem] : nullptr;
+				for (const Attribute &attr : elem->attributes()) {
+					int length = 1;
+					if (nextElem) {
+						// look up the attribute in the successor; the interned name
+						// pointers are unique, so it suffices to compare them
+						const auto &nextAttribs = nextElem->attributes();
+						for (size_t i=0; i < nextAttribs.size(); i++) {
+							if (&nextAttribs[i].name() == &attr.name()) {
+								if (nextAttribs[i].hasSameValue(attr))
+									length += (*nextLengths)[i];
+								break;
+							}
+						}
+					}
+					lengths.push_back(length);
+				}
+				nextElem = elem;
+			}
+		}
+	}
+}
+
+
 /** Looks for the first attribute not yet processed and tries to group it. If
  *  there is a sequence of adjacent sibling nodes N1,...,Nn with an identical inheritable
  *  attribute, the function creates a group element with this attribute and moves the
@@ -81,25 +115,31 @@ void AttributeExtractor::execute (XMLElement *context, bool recurse) {
  *  @param[in] elem first element of a node sequence with potentially identical attributes
  *  @return the new group element if attributes could be grouped, 'elem' otherwise  */
 XMLNode* AttributeExtractor::extractAttribute (XMLElement *elem) {
-	for (const auto &currentAttribute : elem->attributes()) {
+	auto lengthsIt = _runLengths.find(elem);
+	if (lengthsIt == _runLengths.end())  // no entry for non-groupable elements
+		return elem;
+	const vector<int> &lengths = lengthsIt->second;
+	const auto &attribs = elem->attributes();
+	for (size_t i=0; i < attribs.size(); i++) {
+		const Attribute &currentAttribute = attribs[i];
 		if (!currentAttribute.inheritable() || extracted(currentAttribute))
 			continue;
-		AttributeRun run(currentAttribute, elem);
-		if (run.length() >= MIN_RUN_LENGTH) {
+		if (lengths[i] >= MIN_RUN_LENGTH) {
+			AttributeRun run(elem, lengths[i]);
 			XMLElement::Attribute attrib = currentAttribute;
 			XMLElement *group = XMLElement::wrap(run.first(), run.last(), "g");
-			group->addAttribute(attrib.name, attrib.value);
+			group->addAttribute(attrib.name(), attrib.value());
 			// remove attribute from the grouped elements but keep it on elements with 'id' attribute
 			// since they can be referenced, and keep 'fill' attribute on animation elements
 			for (XMLNode *node : *group) {
 				XMLElement *elem = node->toElement();
 				if (elem && extractable(attrib, *elem))
-					elem->removeAttribute(attrib.name);
+					elem->removeAttribute(attrib.name());
 			}
 			// continue with children of the new group but ignore the just extracted attribute
-			_extractedAttributes.insert(attrib.name);
+			_extractedAttributes.insert(&attrib.name());
 			execute(group, false);
-			_extractedAttributes.erase(attrib.name);
+			_extractedAttributes.erase(&attrib.name());
 			return group;
 		}
 	}
@@ -130,7 +170,7 @@ bool AttributeExtractor::groupable (const XMLElement &elem) {
 bool AttributeExtractor::extractable (const Attribute &attrib, XMLElement &element) {
 	if (element.hasAttribute("id"))
 		return false;
-	if (attrib.name != "fill")
+	if (attrib.name() != "fill")
 		return true;
 	// the 'fill' attribute of animation elements has different semantics than
 	// that of graphics elements => don't extract it from animation nodes
@@ -148,5 +188,5 @@ bool AttributeExtractor::extractable (const Attribute &attrib, XMLElement &eleme
 /** Returns true if a given attribute was already extracted from the
  *  current run of elements. */
 bool AttributeExtractor::extracted (const Attribute &attr) const {
-	return _extractedAttributes.find(attr.name) != _extractedAttributes.end();
+	return _extractedAttributes.find(&attr.name()) != _extractedAttributes.end();
 }
@@ -22,6 +22,8 @@
 
 #include <set>
 #include <string>
+#include <unordered_map>
+#include <vector>
 #include "OptimizerModule.hpp"
 #include "../XMLNode.hpp"
 
@@ -32,7 +34,7 @@ class AttributeExtractor : public OptimizerModule {
 	/** Represents a range of adjacent nodes where all elements have a common attribute. */
 	struct AttributeRun {
 		public:
-			AttributeRun (const Attribute &attr, XMLElement *first);
+			AttributeRun (XMLElement *first, int length);
 			XMLNode* first () {return _first;}
 			XMLNode* last ()  {return _last;}
 			int length () const {return _length;}
@@ -43,18 +45,22 @@ class AttributeExtractor : public OptimizerModule {
 	};
 
 	public:
-		void execute (XMLElement*, XMLElement *context) override {execute(context, true);};
+		void execute (XMLElement*, XMLElement *context) override {execute(context, true); _runLengths.clear();};
 		const char* info () const override;
 		static bool groupable (const XMLElement &elem);
 		static bool extractable (const Attribute &attr, XMLElement &element);
 
 	protected:
 		void execute (XMLElement *context, bool recurse);
+		void computeRunLengths (XMLElement *context);
 		XMLNode* extractAttribute (XMLElement *elem);
 		bool extracted (const Attribute &attr) const;
 
 	private:
-		std::set<std::string> _extractedAttributes;
+		std::set<const std::string*> _extractedAttributes;  ///< interned names of the extracted attributes
+		/** Maps a groupable element to the run lengths of its attributes, i.e. entry i denotes
+		 *  the number of adjacent elements starting at this one that share attribute i. */
+		std::unordered_map<const XMLElement*, std::vector<int>> _runLengths;
 		static constexpr int MIN_RUN_LENGTH = 3;
 };
 
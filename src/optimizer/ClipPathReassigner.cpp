@@ -19,7 +19,6 @@
 *************************************************************************/
 
 #include <algorithm>
-#include <set>
 #include <sstream>
 #include "ClipPathReassigner.hpp"
 #include "../XMLNode.hpp"
@@ -69,30 +68,31 @@ void ClipPathReassigner::execute (XMLElement *defs, XMLElement *context) {
 		uint64_t hash = hash_value(clipPathElement);
 		clipPathMap[hash].push_back(clipPathElement); // put identical clipPath elements into a common vector
 	}
-	// replace clip path references
-	vector<XMLElement*> descendants;
-	defs->getDescendants(nullptr, "clip-path", descendants);
-	context->getDescendants(nullptr, "clip-path", descendants);
+	// map the IDs of the duplicates to the ID of the clipPath element kept in the document
+	map<string, string> idMap;
 	for (auto &mapEntry : clipPathMap) {
 		vector<XMLElement*> &identicalClipPathElements = mapEntry.second;
-		set<string> ids;
-		for (auto elem : identicalClipPathElements) {
-			if (const char *id = elem->getAttributeValue("id"))
-				ids.insert(id);
+		const char *keptId = identicalClipPathElements[0]->getAttributeValue("id");
+		if (!keptId)
+			continue;
+		for (auto it = identicalClipPathElements.begin()+1; it != identicalClipPathElements.end(); ++it) {
+			if (const char *id = (*it)->getAttributeValue("id"))
+				idMap.emplace(id, keptId);
 		}
-		for (auto it = descendants.begin(); it != descendants.end();) {
-			if (const char *clipPathRef = (*it)->getAttributeValue("clip-path")) {
-				if (ids.find(extract_id_from_url(clipPathRef)) == ids.end())
-					++it;
-				else {
-					(*it)->addAttribute("clip-path", string("url(#") + (*ids.begin()) + ")");
-					it = descendants.erase(it);  // no need to process this element again
-				}
-			}
+	}
+	// redirect all references to duplicate clip paths in a single pass
+	vector<XMLElement*> descendants;
+	defs->getDescendants(nullptr, "clip-path", descendants);
+	context->getDescendants(nullptr, "clip-path", descendants);
+	for (XMLElement *elem : descendants) {
+		if (const char *clipPathRef = elem->getAttributeValue("clip-path")) {
+			auto it = idMap.find(extract_id_from_url(clipPathRef));
+			if (it != idMap.end())
+				elem->addAttribute("clip-path", "url(#"+it->second+")");
 		}
 	}
 	// remove redundant clipPath elements
-	for (auto mapEntry : clipPathMap) {
+	for (auto &mapEntry : clipPathMap) {
 		auto it = mapEntry.second.begin();
 		for (++it; it != mapEntry.second.end(); ++it)
 			XMLElement::detach(*it);
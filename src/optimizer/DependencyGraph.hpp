@@ -21,113 +21,102 @@
 #ifndef DEPENDENCYGRAPH_HPP
 #define DEPENDENCYGRAPH_HPP
 
-#include <map>
-#include <memory>
-#include <set>
+#include <cstddef>
+#include <unordered_map>
 #include <vector>
-#include "../utility.hpp"
 
+/** Keeps track of dependencies between objects identified by unique keys.
+ *  Each node depends on at most one other node, so the graph forms a forest.
+ *  The nodes are stored in a flat vector addressed by a key-to-index map,
+ *  and removals only flag the affected nodes. Since the removal of a
+ *  dependency path stops at the first node already flagged, all operations
+ *  run in (amortized) constant time. */
 template <typename T>
 class DependencyGraph {
 	struct GraphNode {
-		explicit GraphNode (const T &k) : key(k), dependent() {}
-
-		void addDependee (GraphNode *node) {
-			if (node) {
-				node->dependent = this;
-				dependees.insert(node);
-			}
-		}
-
-		void unlinkDependees () {
-			for (GraphNode *dependee : dependees)
-				dependee->dependent = nullptr;
-			dependees.clear();
-		}
-
-		void unlinkDependee (GraphNode *dependee) {
-			auto it = dependees.find(dependee);
-			if (it != dependees.end()) {
-				(*it)->dependent = nullptr;
-				dependees.erase(it);
-			}
-		}
+		GraphNode (const T &k, int depIndex) : key(k), dependentIndex(depIndex) {}
 
 		T key;
-		GraphNode *dependent;
-		std::set<GraphNode*> dependees;
+		int dependentIndex;  ///< index of the node this one depends on (-1 if none)
+		bool removed=false;
 	};
 
-	using NodeMap = std::map<T, std::unique_ptr<GraphNode>>;
-
 	public:
 		/** Inserts a new isolated node into the dependency graph. */
 		void insert (const T &key) {
-			if (!contains(key))
-				_nodeMap.emplace(key, util::make_unique<GraphNode>(key));
+			int index = indexOf(key);
+			if (index < 0)
+				addNode(key, -1);
+			else if (_nodes[index].removed)
+				reviveNode(index, -1);
 		}
 
 		/** Inserts a new node to the graph and adds a dependency on an existing one to it.
 		 *  @param[in] key ID of new node to insert
 		 *  @param[in] dependantKey ID of node the new node should depend on */
 		void insert (const T &dependentKey, const T &key) {
-			if (!contains(key)) {
-				auto dependentIter = _nodeMap.find(dependentKey);
-				if (dependentIter != _nodeMap.end()) {
-					auto node = util::make_unique<GraphNode>(key);
-					dependentIter->second->addDependee(node.get());
-					_nodeMap.emplace(key, std::move(node));
-				}
-			}
+			int dependentIndex = indexOf(dependentKey);
+			if (dependentIndex < 0 || _nodes[dependentIndex].removed)
+				return;
+			int index = indexOf(key);
+			if (index < 0)
+				addNode(key, dependentIndex);
+			else if (_nodes[index].removed)
+				reviveNode(index, dependentIndex);
 		}
 
 		/** Removes a node and all its dependents from the graph. */
 		void removeDependencyPath (const T &key) {
-			auto it = _nodeMap.find(key);
-			if (it != _nodeMap.end()) {
-				for (GraphNode *node = it->second.get(); node;) {
-					GraphNode *dependent = node->dependent;
-					node->unlinkDependees();
-					if (dependent)
-						dependent->unlinkDependee(node);
-					_nodeMap.erase(node->key);
-					node = dependent;
-				}
+			for (int index = indexOf(key); index >= 0 && !_nodes[index].removed;) {
+				_nodes[index].removed = true;
+				--_numPresent;
+				index = _nodes[index].dependentIndex;
 			}
 		}
 
 		/** Returns the IDs of all nodes present in the graph. */
 		std::vector<T> getKeys () const {
 			std::vector<T> keys;
-			for (auto &entry : _nodeMap)
-				keys.emplace_back(entry.first);
+			keys.reserve(_numPresent);
+			for (const GraphNode &node : _nodes) {
+				if (!node.removed)
+					keys.emplace_back(node.key);
+			}
 			return keys;
 		}
 
-		bool contains (const T &value) const {
-			return _nodeMap.find(value) != _nodeMap.end();
+		bool contains (const T &key) const {
+			int index = indexOf(key);
+			return index >= 0 && !_nodes[index].removed;
 		}
 
 		bool empty () const {
-			return _nodeMap.empty();
+			return _numPresent == 0;
 		}
 
-#if 0
-		void writeDOT (std::ostream &os) const {
-			os << "digraph {\n";
-			for (auto it=_nodeMap.begin(); it != _nodeMap.end(); ++it) {
-				GraphNode *node = it->second;
-				if (node->dependent)
-					os << (node->key) << " -> " << (node->dependent->key) << ";\n";
-				else if (node->dependees.empty())
-					os << (node->key) << ";\n";
-			}
-			os << "}\n";
+	private:
+		/** Returns the index of the node with a given key (-1 if the key is unknown). */
+		int indexOf (const T &key) const {
+			auto it = _indexMap.find(key);
+			return it != _indexMap.end() ? it->second : -1;
 		}
-#endif
 
-	private:
-		NodeMap _nodeMap;
+		void addNode (const T &key, int dependentIndex) {
+			_indexMap.emplace(key, static_cast<int>(_nodes.size()));
+			_nodes.emplace_back(key, dependentIndex);
+			++_numPresent;
+		}
+
+		/** Reinserts a previously removed node with a new dependency. */
+		void reviveNode (int index, int dependentIndex) {
+			_nodes[index].dependentIndex = dependentIndex;
+			_nodes[index].removed = false;
+			++_numPresent;
+		}
+
+		std::unordered_map<T,int> _indexMap;  ///< maps the node keys to their index in the node vector
+		std::vector<GraphNode> _nodes;        ///< all nodes in order of insertion
+		std::size_t _numPresent=0;            ///< number of nodes not flagged as removed
 };
 
 #endif
@@ -114,21 +114,21 @@ void GroupCollapser::execute (XMLElement *context, int depth) {
 bool GroupCollapser::moveAttributes (XMLElement &source, XMLElement &dest) {
 	vector<string> movedAttributes;
 	for (const auto &attr : source.attributes()) {
-		if (attr.name == "transform") {
+		if (attr.name() == "transform") {
 			string transform;
 			if (const char *destvalue = dest.getAttributeValue("transform")) {
-				transform = destvalue+attr.value;
+				transform = destvalue+attr.value();
 				_transformCombined = true;
 			}
 			else {
-				transform = attr.value;
+				transform = attr.value();
 			}
 			dest.addAttribute("transform", transform);
 			movedAttributes.emplace_back("transform");
 		}
 		else if (attr.inheritable()) {
-			dest.addAttribute(attr.name, attr.value);
-			movedAttributes.emplace_back(attr.name);
+			dest.addAttribute(attr.name(), attr.value());
+			movedAttributes.emplace_back(attr.name());
 		}
 	}
 	for (const string &attrname : movedAttributes)
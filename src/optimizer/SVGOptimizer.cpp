@@ -20,8 +20,12 @@
 
 #include <algorithm>
 #include <array>
+#include <chrono>
+#include <iomanip>
 #include <map>
+#include <mutex>
 #include <set>
+#include <streambuf>
 #include "SVGOptimizer.hpp"
 #include "../SVGTree.hpp"
 
@@ -35,6 +39,65 @@
 using namespace std;
 
 string SVGOptimizer::MODULE_SEQUENCE;
+bool SVGOptimizer::STATS = false;
+
+
+/** Accumulated effect data of a single optimizer module. */
+struct ModuleStats {
+	unsigned runs=0;        ///< number of times the module was executed
+	double seconds=0;       ///< accumulated wall time spent in the module
+	long long nodeDiff=0;   ///< change of the number of XML nodes caused by the module
+	long long byteDiff=0;   ///< change of the serialized size caused by the module
+};
+
+static map<string, ModuleStats> moduleStatsMap;  ///< effect data mapped by module name
+static mutex statsMutex;  ///< protects the stats since pages may be optimized concurrently
+
+
+/** Stream buffer that doesn't store but only counts the characters written to it. */
+class CountingStreamBuffer : public streambuf {
+	public:
+		size_t count () const {return _count;}
+
+	protected:
+		int_type overflow (int_type c) override {
+			if (c != traits_type::eof())
+				_count++;
+			return c;
+		}
+
+		streamsize xsputn (const char*, streamsize n) override {
+			_count += size_t(n);
+			return n;
+		}
+
+	private:
+		size_t _count=0;
+};
+
+
+/** Returns the number of nodes of an XML subtree including its root node. */
+static long long count_nodes (const XMLNode *node) {
+	if (!node)
+		return 0;
+	long long count=1;
+	if (const XMLElement *elem = node->toElement()) {
+		for (const XMLNode *child=elem->firstChild(); child; child = child->next())
+			count += count_nodes(child);
+	}
+	return count;
+}
+
+
+/** Returns the number of bytes an XML subtree occupies when serialized. */
+static long long serialized_size (const XMLElement *elem) {
+	if (!elem)
+		return 0;
+	CountingStreamBuffer countingBuffer;
+	ostream os(&countingBuffer);
+	elem->write(os);
+	return static_cast<long long>(countingBuffer.count());
+}
 
 SVGOptimizer::SVGOptimizer (SVGTree *svg) : _svg(svg) {
 	// optimizer modules available to the user; must be listed in default order
@@ -49,43 +112,116 @@ SVGOptimizer::SVGOptimizer (SVGTree *svg) : _svg(svg) {
 
 
 void SVGOptimizer::execute () {
-	if (!_svg || MODULE_SEQUENCE == "none")
-		return;
+	if (_svg)
+		execute(_svg->defsNode(), _svg->pageNode());
+}
+
 
-	vector<string> names = util::split(MODULE_SEQUENCE, ",", true);
-	set<string> removedNames;
-	if (names.empty())
-		names.emplace_back("remove-clippaths"); // default behaviour of previous dvisvgm releases
-	else {
-		auto it = names.begin();
-		if (*it == "all" || (!it->empty() && it->at(0) == '-')) {
-			if (*it == "all")
-				it = names.erase(it);
-			// add names of all optimizer modules
-			for (const auto &moduleEntry : _moduleEntries) {
-				it = names.insert(it, moduleEntry.modname);
-				++it;
+static SVGOptimizer::ModuleSequence cachedSequence;  ///< parsed snapshot of MODULE_SEQUENCE
+static string cachedSequenceSource = "\n";  ///< value of MODULE_SEQUENCE the snapshot was created from
+static mutex sequenceMutex;  ///< protects the creation of the snapshot
+
+
+/** Returns the fully parsed, immutable form of MODULE_SEQUENCE. The module string
+ *  is expanded, validated, and resolved only when it has changed since the previous
+ *  call, so the per-page executions don't repeat the string processing. Since the
+ *  module string is only modified between conversions, concurrently optimized pages
+ *  all read the same unchanging snapshot. */
+const SVGOptimizer::ModuleSequence& SVGOptimizer::moduleSequence () const {
+	lock_guard<mutex> lock(sequenceMutex);
+	if (MODULE_SEQUENCE != cachedSequenceSource) {
+		cachedSequenceSource = MODULE_SEQUENCE;
+		cachedSequence.modnames.clear();
+		cachedSequence.recordStats = false;
+		if (MODULE_SEQUENCE != "none") {
+			vector<string> names = util::split(MODULE_SEQUENCE, ",", true);
+			set<string> removedNames;
+			// keyword "stats" enables the effect recording but doesn't denote a module
+			auto statsIt = find(names.begin(), names.end(), "stats");
+			if (statsIt != names.end()) {
+				cachedSequence.recordStats = true;
+				names.erase(statsIt);
+			}
+			if (names.empty())
+				names.emplace_back("remove-clippaths"); // default behaviour of previous dvisvgm releases
+			else {
+				auto it = names.begin();
+				if (*it == "all" || (!it->empty() && it->at(0) == '-')) {
+					if (*it == "all")
+						it = names.erase(it);
+					// add names of all optimizer modules
+					for (const auto &moduleEntry : _moduleEntries) {
+						it = names.insert(it, moduleEntry.modname);
+						++it;
+					}
+				}
+			}
+			// create sequence of module names to be executed
+			for (auto it=names.begin(); it != names.end();) {
+				if ((*it)[0] == '-') {
+					removedNames.insert(it->substr(1));
+					it = names.erase(it);
+				}
+				else {
+					if ((*it)[0] == '+')
+						*it = it->substr(1);
+					++it;
+				}
+			}
+			for (const string &name : names) {
+				if (removedNames.find(name) == removedNames.end() && getModule(name))
+					cachedSequence.modnames.emplace_back(name);
 			}
 		}
+		const vector<string> &modnames = cachedSequence.modnames;
+		GroupCollapser::COMBINE_TRANSFORMS = (find(modnames.begin(), modnames.end(), "simplify-transform") != modnames.end());
+		if (cachedSequence.recordStats)
+			STATS = true;
 	}
-	// create sequence of module names to be considered
-	for (auto it=names.begin(); it != names.end();) {
-		if ((*it)[0] == '-') {
-			removedNames.insert(it->substr(1));
-			it = names.erase(it);
-		}
-		else {
-			if ((*it)[0] == '+')
-				*it = it->substr(1);
-			++it;
-		}
+	return cachedSequence;
+}
+
+
+/** Runs the optimizer modules on the given defs and page subtrees. The modules only
+ *  access these two trees, so this function may run detached from the SVGTree the
+ *  elements originate from, e.g. on an already detached document.
+ *  @param[in] defs defs section of the SVG document, may be nullptr
+ *  @param[in] page group element containing the page contents */
+/** Runs the configured optimizer modules on a page subtree.
+ *  @param[in] defs defs section of the SVG document
+ *  @param[in] page root element of the page to optimize
+ *  @param[in] containsText false if the caller knows that the page doesn't contain
+ *    any text elements, allowing to skip the text simplification */
+void SVGOptimizer::execute (XMLElement *defs, XMLElement *page, bool containsText) {
+	const ModuleSequence &sequence = moduleSequence();
+	if (sequence.modnames.empty())
+		return;
+	long long nodesBefore=0, bytesBefore=0;
+	if (STATS) {
+		nodesBefore = count_nodes(defs)+count_nodes(page);
+		bytesBefore = serialized_size(defs)+serialized_size(page);
 	}
-	GroupCollapser::COMBINE_TRANSFORMS = (find(names.begin(), names.end(), "simplify-transform") != names.end());
-	// execute optimizer modules
-	for (const string &name: names) {
-		if (removedNames.find(name) == removedNames.end()) {
-			if (OptimizerModule *module = getModule(name))
-				module->execute(_svg->defsNode(), _svg->pageNode());
+	for (const string &name: sequence.modnames) {
+		// pages without any text characters can skip the text simplification entirely
+		if (name == "simplify-text" && !containsText)
+			continue;
+		OptimizerModule *module = getModule(name);
+		if (!STATS)
+			module->execute(defs, page);
+		else {
+			auto startTime = chrono::steady_clock::now();
+			module->execute(defs, page);
+			double seconds = chrono::duration<double>(chrono::steady_clock::now()-startTime).count();
+			long long nodesAfter = count_nodes(defs)+count_nodes(page);
+			long long bytesAfter = serialized_size(defs)+serialized_size(page);
+			lock_guard<mutex> lock(statsMutex);
+			ModuleStats &stats = moduleStatsMap[name];
+			stats.runs++;
+			stats.seconds += seconds;
+			stats.nodeDiff += nodesAfter-nodesBefore;
+			stats.byteDiff += bytesAfter-bytesBefore;
+			nodesBefore = nodesAfter;
+			bytesBefore = bytesAfter;
 		}
 	}
 }
@@ -117,13 +253,39 @@ bool SVGOptimizer::checkModuleString (string &namestr, vector<string> &unknownNa
 	for (string name : givenNames) {
 		if (name[0] == '-' || name[0] == '+')
 			name = name.substr(1);
-		if (!name.empty() && !getModule(name))
+		if (!name.empty() && name != "stats" && !getModule(name))
 			unknownNames.emplace_back(name);
 	}
 	return unknownNames.empty();
 }
 
 
+/** Writes the recorded per-module effect data as tab-separated lines of the
+ *  form "module<TAB>runs<TAB>seconds<TAB>nodediff<TAB>bytediff". Negative
+ *  deltas denote nodes/bytes removed by the module, so a module that costs
+ *  much time but saves few bytes on the given content is easy to spot. */
+void SVGOptimizer::writeStats (ostream &os) {
+	lock_guard<mutex> lock(statsMutex);
+	ios::fmtflags osflags(os.flags());
+	os << fixed << setprecision(6);
+	for (const auto &nameStatsPair : moduleStatsMap) {
+		os << nameStatsPair.first
+			<< '\t' << nameStatsPair.second.runs
+			<< '\t' << nameStatsPair.second.seconds
+			<< '\t' << nameStatsPair.second.nodeDiff
+			<< '\t' << nameStatsPair.second.byteDiff << '\n';
+	}
+	os.flags(osflags);
+}
+
+
+/** Removes all recorded per-module effect data. */
+void SVGOptimizer::resetStats () {
+	lock_guard<mutex> lock(statsMutex);
+	moduleStatsMap.clear();
+}
+
+
 OptimizerModule* SVGOptimizer::getModule (const string &name) const {
 	auto it = find_if(_moduleEntries.begin(), _moduleEntries.end(), [&](const ModuleEntry &entry) {
 		return entry.modname == name;
@@ -37,17 +37,32 @@ class SVGOptimizer {
 		std::string modname;
 		std::unique_ptr<OptimizerModule> module;
 	};
+	public:
+		/** Fully parsed, immutable form of MODULE_SEQUENCE. It contains the resolved
+		 *  names of the modules to be executed, i.e. the keywords "all", "stats", and
+		 *  "none" as well as the +/- prefixes and unknown names are already evaluated,
+		 *  so the per-page executions don't have to process the module string again. */
+		struct ModuleSequence {
+			std::vector<std::string> modnames;  ///< names of the modules to execute, in order
+			bool recordStats=false;             ///< true if keyword "stats" was present in the module string
+		};
+
 	public:
 		explicit SVGOptimizer (SVGTree *svg=nullptr);
 		explicit SVGOptimizer (SVGTree &svg) : SVGOptimizer(&svg) {}
 		void execute ();
+		void execute (XMLElement *defs, XMLElement *page, bool containsText=true);
 		void listModules (std::ostream &os) const;
 		bool checkModuleString (std::string &namestr, std::vector<std::string> &unknownNames) const;
+		static void writeStats (std::ostream &os);
+		static void resetStats ();
 
 		static std::string MODULE_SEQUENCE;
+		static bool STATS;  ///< if true, record the wall time and effect of each executed module
 
 	protected:
 		OptimizerModule* getModule (const std::string &name) const;
+		const ModuleSequence& moduleSequence () const;
 
 	private:
 		SVGTree *_svg;
@@ -31,58 +31,39 @@ const char* TextSimplifier::info () const {
 }
 
 
-/** Returns all common inheritable attributes of multiple elements. */
-static XMLElement::Attributes common_inheritable_attributes (const vector<XMLElement*> &elements) {
-	bool intersected=false;
-	XMLElement::Attributes commonAttribs;
-	for (const XMLElement *elem : elements) {
-		if (commonAttribs.empty()) {
-			if (intersected)
-				break;
-			for (const auto &attrib : elem->attributes()) {
+/** Collects the tspan children of a text element and computes their common
+ *  inheritable attributes in a single pass over the child nodes.
+ *  @param[in] textElement text element to check
+ *  @param[out] tspans the tspan children of the text element
+ *  @param[out] commonAttribs the inheritable attributes present with identical values in all tspans
+ *  @return false if the text element contains non-whitespace text nodes or elements other than tspans */
+static bool collect_tspans (XMLElement *textElement, vector<XMLElement*> &tspans, XMLElement::Attributes &commonAttribs) {
+	for (XMLNode *child : *textElement) {
+		if (child->toWSNode() || child->toComment())
+			continue;
+		XMLElement *childElement = child->toElement();
+		if (!childElement || childElement->name() != "tspan")
+			return false;
+		if (tspans.empty()) {
+			for (const auto &attrib : childElement->attributes()) {
 				if (attrib.inheritable())
 					commonAttribs.push_back(attrib);
 			}
 		}
-		else {
+		else if (!commonAttribs.empty()) {
+			// intersect the common attributes found so far with those of the current tspan
+			const XMLElement *constElement = childElement;
 			for (auto it = commonAttribs.begin(); it != commonAttribs.end();) {
-				auto *attrib = elem->getAttribute(it->name);
-				if (!attrib || attrib->value != it->value)
+				auto *attrib = constElement->getAttribute(it->name());
+				if (!attrib || !attrib->hasSameValue(*it))
 					it = commonAttribs.erase(it);
 				else
 					++it;
 			}
 		}
-		intersected = true;
-	}
-	return commonAttribs;
-}
-
-
-/** Returns all tspan elements of a text element if the latter doesn't contain
- *  any non-whitespace text nodes. Otherwise, the returned vector is empty.
- *  @param[in] textElement text element to check
- *  @return the tspan children of the text element */
-static vector<XMLElement*> get_tspans (XMLElement *textElement) {
-	vector<XMLElement*> tspans;
-	bool failed=false;
-	for (XMLNode *child : *textElement) {
-		if (child->toWSNode() || child->toComment())
-			continue;
-		if (child->toText())
-			failed = true;
-		else if (XMLElement *childElement = child->toElement()) {
-			if (childElement->name() != "tspan")
-				failed = true;
-			else
-				tspans.push_back(childElement);
-		}
-		if (failed) {
-			tspans.clear();
-			break;
-		}
+		tspans.push_back(childElement);
 	}
-	return tspans;
+	return true;
 }
 
 
@@ -90,16 +71,16 @@ void TextSimplifier::execute (XMLElement *context) {
 	if (!context)
 		return;
 	if (context->name() == "text") {
-		vector<XMLElement*> tspans = get_tspans(context);
-		vector<XMLElement::Attribute> attribs = common_inheritable_attributes(tspans);
-		if (!tspans.empty() && !attribs.empty()) {
+		vector<XMLElement*> tspans;
+		XMLElement::Attributes attribs;
+		if (collect_tspans(context, tspans, attribs) && !tspans.empty() && !attribs.empty()) {
 			// move all common tspan attributes to the parent text element
 			for (const auto &attr : attribs)
-				context->addAttribute(attr.name, attr.value);
+				context->addAttribute(attr.name(), attr.value());
 			// remove all common attributes from the tspan elements
 			for (XMLElement *tspan : tspans) {
 				for (const auto &attr : attribs)
-					tspan->removeAttribute(attr.name);
+					tspan->removeAttribute(attr.name());
 				// unwrap the tspan if there are no remaining attributes
 				if (tspan->attributes().empty())
 					XMLElement::unwrap(tspan);
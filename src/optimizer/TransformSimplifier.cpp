@@ -20,6 +20,7 @@
 
 #include <cmath>
 #include <cstdlib>
+#include <vector>
 #include "TransformSimplifier.hpp"
 #include "../Matrix.hpp"
 #include "../utility.hpp"
@@ -38,12 +39,25 @@ void TransformSimplifier::execute (XMLElement *context) {
 	if (!context)
 		return;
 	if (const char *transform = context->getAttributeValue("transform")) {
-		Matrix matrix = Matrix::parseSVGTransform(transform);
-		if (!incorporateTransform(context, matrix)) {
-			string decomp = decompose(matrix);
-			if (decomp.length() > matrix.toSVG().length())
-				context->addAttribute("transform", matrix.toSVG());
-			else {
+		// elements whose transform might be incorporated into other attributes must take the full path
+		bool incorporable = context->name() == "image" || context->name() == "rect"
+			|| context->name() == "text" || context->name() == "use";
+		auto cacheIt = incorporable ? _simplifiedTransforms.end() : _simplifiedTransforms.find(transform);
+		if (cacheIt != _simplifiedTransforms.end()) {
+			// reuse the simplified form computed for a previous identical transform attribute
+			if (cacheIt->second.empty())
+				context->removeAttribute("transform");
+			else
+				context->addAttribute("transform", cacheIt->second);
+		}
+		else {
+			Matrix matrix = Matrix::parseSVGTransform(transform);
+			if (!incorporateTransform(context, matrix)) {
+				string decomp = decompose(matrix);
+				string svg = matrix.toSVG();
+				if (decomp.length() > svg.length())
+					decomp = std::move(svg);
+				_simplifiedTransforms.emplace(transform, decomp);
 				if (decomp.empty())
 					context->removeAttribute("transform");
 				else
@@ -62,11 +76,43 @@ void TransformSimplifier::execute (XMLElement *context) {
 /** Tries to incorporate the translation and scaling components of the 'transform' attribute
  *  of a given element into the positional and/or size attributes of that element. If successful,
  *  the 'transform' attribute is either removed or simplified to a scale() matrix.
- *  Currently, only 'image' and 'rect' elements are considered.
+ *  Currently, 'image' and 'rect' elements are considered, and pure translations are additionally
+ *  folded into the coordinates of 'text' and 'use' elements.
  *  @param[in] elem element to check
  *  @param[in] matrix matrix representing the 'transform' attribute of the element
  *  @return true on success */
 bool TransformSimplifier::incorporateTransform (XMLElement *elem, const Matrix &matrix) {
+	double dx, dy;
+	if ((elem->name() == "text" || elem->name() == "use") && matrix.isTranslation(dx, dy)) {
+		vector<XMLElement*> elements {elem};
+		if (elem->name() == "text")
+			elem->getDescendants("tspan", nullptr, elements);
+		// ensure that all coordinate attributes consist of single numbers before changing any of them
+		for (const XMLElement *element : elements) {
+			for (const char *attrName : {"x", "y"}) {
+				if (const char *valstr = element->getAttributeValue(attrName)) {
+					char *end;
+					strtod(valstr, &end);
+					if (*end)
+						return false;
+				}
+			}
+		}
+		// fold the translation into the coordinates; the x/y attributes of tspans
+		// denote absolute positions and must be shifted as well if present
+		const double offsets[] = {dx, dy};
+		const char *attrNames[] = {"x", "y"};
+		for (XMLElement *element : elements) {
+			for (int i=0; i < 2; i++) {
+				if (const char *valstr = element->getAttributeValue(attrNames[i]))
+					element->addAttribute(attrNames[i], strtod(valstr, nullptr)+offsets[i]);
+				else if (element == elem && offsets[i] != 0)
+					element->addAttribute(attrNames[i], offsets[i]);
+			}
+		}
+		elem->removeAttribute("transform");
+		return true;
+	}
 	if ((elem->name() == "image" || elem->name() == "rect") && matrix.get(0, 1) == 0 && matrix.get(1, 0) == 0) {
 		double tx = matrix.get(0, 2);
 		double ty = matrix.get(1, 2);
@@ -21,6 +21,7 @@
 #pragma once
 
 #include <string>
+#include <unordered_map>
 #include "OptimizerModule.hpp"
 
 class Matrix;
@@ -34,4 +35,9 @@ class TransformSimplifier : public OptimizerModule {
 	protected:
 		bool incorporateTransform (XMLElement *elem, const Matrix &matrix);
 		std::string decompose (const Matrix &matrix);
+
+	private:
+		/** Maps the value of a processed transform attribute to its simplified form
+		 *  so that identical transforms are parsed and decomposed only once. */
+		std::unordered_map<std::string, std::string> _simplifiedTransforms;
 };
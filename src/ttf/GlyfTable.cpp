@@ -19,10 +19,12 @@
 *************************************************************************/
 
 #include <algorithm>
+#include <future>
 #include <limits>
 #include <cmath>
 #include <numeric>
 #include <sstream>
+#include <thread>
 #include "GlyfTable.hpp"
 #include "TTFWriter.hpp"
 #include "../Bezier.hpp"
@@ -192,10 +194,12 @@ void GlyfTable::write (ostream &os) const {
 	size_t offset = 0;
 	ttfWriter()->addGlyphOffset(0);
 	ttfWriter()->updateGlobalBbox(0, 0, 0, 0, 0);
+	vector<list<Contour>> contours = computeContours();
 	// iterate in ascending Unicode point order over all characters to be added to the TTF
+	size_t index = 0;
 	for (auto cp2charcode : ttfWriter()->getUnicodeCharMap()) {
 		ttfWriter()->addGlyphOffset(offset); // update loca table
-		offset += writeGlyphContours(os, cp2charcode.second);
+		offset += writeGlyphContours(os, cp2charcode.second, std::move(contours[index++]));
 	}
 	ttfWriter()->addGlyphOffset(offset);  // add extra offset after last valid one
 }
@@ -204,9 +208,19 @@ void GlyfTable::write (ostream &os) const {
 /** Writes the contour data of a single glyph to a given output stream.
  *  @param[in] os stream to write to
  *  @param[in] charcode character code of glyph in current font
+ *  @param[in] contours contours describing the glyph outline
  *  @return number of bytes written */
-size_t GlyfTable::writeGlyphContours (ostream &os, uint32_t charcode) const {
-	list<Contour> contours = computeContours(charcode);
+size_t GlyfTable::writeGlyphContours (ostream &os, uint32_t charcode, list<Contour> &&contours) const {
+#ifdef TTFDEBUG
+	if (TTFWriter::CREATE_PS_GLYPH_OUTLINES) {
+		ostringstream oss;
+		oss << "g-" << ttfWriter()->getFont().name() << '-';
+		oss << setw(4) << setfill('0') << charcode;
+		oss << ".eps";
+		ofstream ofs(oss.str());
+		writePS(ofs, contours, charcode);
+	}
+#endif
 	if (contours.empty()) {
 		ttfWriter()->updateGlobalBbox(charcode, 0, 0, 0, 0);
 		return 0;
@@ -349,35 +363,62 @@ struct GlyphToContourActions : Glyph::IterationActions {
 };
 
 
-/** Returns a sequence of contours describing the glyph of a given character.
- *  The contour points are stored with absolute coordinates. */
-list<Contour> GlyfTable::computeContours (uint32_t charcode) const {
+/** Converts the outline of a traced glyph to a sequence of contours
+ *  with absolute coordinates.
+ *  @param[in] glyph glyph outline that may still contain cubic Bézier curves
+ *  @param[in] scale factor to scale the glyph coordinates to font units
+ *  @return the resulting contours */
+static list<Contour> glyph_to_contours (const Glyph &glyph, double scale) {
 	list<Contour> contours;
-	Glyph glyph;
-	if (ttfWriter()->getFont().getGlyph(int(charcode), glyph, ttfWriter()->getTracerCallback())) {
-		if (!glyph.empty()) {
-			GlyphToContourActions actions(contours, ttfWriter()->unitsPerEmFactor());
-			glyph.iterate(actions, false);
-			for (auto it = contours.begin(); it != contours.end();) {
-				it->reverse();  // TTF contours must be clockwise-oriented
-				it->reduceNumberOfPoints();
-				if (it->numPoints() < 3)
-					it = contours.erase(it);
-				else
-					++it;
-			}
-		}
-#ifdef TTFDEBUG
-		if (TTFWriter::CREATE_PS_GLYPH_OUTLINES) {
-			string fontname = ttfWriter()->getFont().name();
-			ostringstream oss;
-			oss << "g-" << ttfWriter()->getFont().name() << '-';
-			oss << setw(4) << setfill('0') << charcode;
-			oss << ".eps";
-			ofstream ofs(oss.str());
-			writePS(ofs, contours, charcode);
+	if (!glyph.empty()) {
+		GlyphToContourActions actions(contours, scale);
+		glyph.iterate(actions, false);
+		for (auto it = contours.begin(); it != contours.end();) {
+			it->reverse();  // TTF contours must be clockwise-oriented
+			it->reduceNumberOfPoints();
+			if (it->numPoints() < 3)
+				it = contours.erase(it);
+			else
+				++it;
 		}
-#endif
+	}
+	return contours;
+}
+
+
+/** Returns the contours describing the glyphs of all characters to be added to
+ *  the TTF, in ascending Unicode point order. The contour points are stored with
+ *  absolute coordinates. Converting the cubic Bézier curves of the outlines to
+ *  quadratic ones is CPU-bound and independent per glyph, so the conversions are
+ *  distributed over the available cores. Retrieving the glyph outlines themselves
+ *  stays on the calling thread because the font engine isn't thread-safe. */
+vector<list<Contour>> GlyfTable::computeContours () const {
+	vector<Glyph> glyphs;
+	for (auto cp2charcode : ttfWriter()->getUnicodeCharMap()) {
+		Glyph glyph;
+		ttfWriter()->getFont().getGlyph(int(cp2charcode.second), glyph, ttfWriter()->getTracerCallback());
+		glyphs.push_back(std::move(glyph));
+	}
+	vector<list<Contour>> contours(glyphs.size());
+	const double scale = ttfWriter()->unitsPerEmFactor();
+	constexpr size_t MIN_GLYPHS_FOR_THREADING = 32;
+	size_t numTasks = min(size_t(max(1u, thread::hardware_concurrency())), glyphs.size());
+	if (numTasks < 2 || glyphs.size() < MIN_GLYPHS_FOR_THREADING) {
+		for (size_t i=0; i < glyphs.size(); i++)
+			contours[i] = glyph_to_contours(glyphs[i], scale);
+	}
+	else {
+		// distribute the glyphs round-robin over the available threads
+		auto convertTask = [&glyphs, &contours, scale, numTasks](size_t first) {
+			for (size_t i=first; i < glyphs.size(); i+=numTasks)
+				contours[i] = glyph_to_contours(glyphs[i], scale);
+		};
+		vector<future<void>> futures;
+		for (size_t i=1; i < numTasks; i++)
+			futures.emplace_back(async(launch::async, convertTask, i));
+		convertTask(0);
+		for (auto &fut : futures)
+			fut.get();
 	}
 	return contours;
 }
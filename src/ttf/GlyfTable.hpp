@@ -83,10 +83,9 @@ class GlyfTable : public TTFTable {
 		void write (std::ostream &os) const override;
 
 	protected:
-		std::vector<Contour> computeContours () const;
-		std::list<Contour> computeContours (uint32_t charcode) const;
+		std::vector<std::list<Contour>> computeContours () const;
 		static void computeBbox (const std::list<Contour> &contours, int &xmin, int &ymin, int &xmax, int &ymax);
-		size_t writeGlyphContours (std::ostream &os, uint32_t charcode) const;
+		size_t writeGlyphContours (std::ostream &os, uint32_t charcode, std::list<Contour> &&contours) const;
 //		Contour getNotDefContour () const;
 #ifdef TTFDEBUG
 		void writePS (std::ostream &os, const std::list<Contour> &contours, uint32_t charcode) const;
@@ -18,10 +18,7 @@
 ** along with this program; if not, see <http://www.gnu.org/licenses/>. **
 *************************************************************************/
 
-#include <fstream>
-#include <memory>
-#include "../MessageException.hpp"
-#include "../utility.hpp"
+#include <cstdlib>
 #include "TTFAutohint.hpp"
 
 using namespace std;
@@ -34,7 +31,7 @@ bool TTFAutohint::available () const {
 	return false;
 }
 
-int TTFAutohint::autohint (const string&, const string&, bool) {
+int TTFAutohint::autohint (string&, bool) {
 	return 0;
 }
 
@@ -85,12 +82,11 @@ bool TTFAutohint::available () const {
 }
 
 
-/** Runs ttfautohint on a given font file.
- *  @param[in] source name of TTF input file
- *  @param[in] target name of TTF output file
+/** Runs ttfautohint on TTF data present in memory.
+ *  @param[in,out] ttfData the TTF data to process; replaced with the hinted data on success
  *  @param[in] rehintIfSymbolFont if true, ttfautohint is run again with option "symbol" in case regular hinting is rejected.
  *  @return ttfautohint error code (0 = success) */
-int TTFAutohint::autohint (const string &source, const string &target, bool rehintIfSymbolFont) {
+int TTFAutohint::autohint (string &ttfData, bool rehintIfSymbolFont) {
 #ifdef HAVE_LIBTTFAUTOHINT
 	auto fn = &TTF_autohint;
 #else
@@ -99,32 +95,18 @@ int TTFAutohint::autohint (const string &source, const string &target, bool rehi
 	int ret=0;
 	if (fn) {
 		_lastErrorMessage = nullptr;
-		ifstream ifs(source, ios::binary|ios::ate);
-		if (!ifs)
-			throw MessageException("failed to open '"+source+"' for reading");
-		size_t inbufSize = ifs.tellg();
-		ifs.seekg(0, ios::beg);
-		auto inbuf = util::make_unique<char[]>(inbufSize);
-		if (!ifs.read(inbuf.get(), inbufSize))
-			throw MessageException("failed to read from '"+source+"'");
 		char *outbuf = nullptr;
 		size_t outbufSize;
 		ret = fn("in-buffer, in-buffer-len, out-buffer, out-buffer-len, default-script, error-string, alloc-func",
-			inbuf.get(), inbufSize, &outbuf, &outbufSize, "latn", &_lastErrorMessage, &std::malloc);
+			ttfData.data(), ttfData.size(), &outbuf, &outbufSize, "latn", &_lastErrorMessage, &std::malloc);
 		if (ret == TA_Err_Missing_Glyph && rehintIfSymbolFont) {
-			ifs.clear();
-			ifs.seekg(0, ios::beg);
 			std::free(outbuf);
+			outbuf = nullptr;
 			ret = fn("in-buffer, in-buffer-len, out-buffer, out-buffer-len, symbol, error-string, alloc-func",
-				inbuf.get(), inbufSize, &outbuf, &outbufSize, true, &_lastErrorMessage, &std::malloc);
-		}
-		if (ret == 0) {
-			ofstream ofs(target, ios::binary);
-			if (ofs)
-				ofs.write(outbuf, outbufSize);
-			else
-				throw MessageException("failed to open '"+target+"' for writing");
+				ttfData.data(), ttfData.size(), &outbuf, &outbufSize, true, &_lastErrorMessage, &std::malloc);
 		}
+		if (ret == 0)
+			ttfData.assign(outbuf, outbufSize);
 		std::free(outbuf);
 	}
 	return ret;
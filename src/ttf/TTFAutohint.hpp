@@ -38,7 +38,7 @@ class TTFAutohint
 		TTFAutohint ();
 		TTFAutohint (const TTFAutohint &ta) =delete;
 		bool available () const;
-		int autohint (const std::string &source, const std::string &target, bool rehintIfSymbolFont);
+		int autohint (std::string &ttfData, bool rehintIfSymbolFont);
 		std::string lastErrorMessage () const;
 		std::string version () const;
 
@@ -18,6 +18,7 @@
 ** along with this program; if not, see <http://www.gnu.org/licenses/>. **
 *************************************************************************/
 
+#include <algorithm>
 #include <vectorstream.hpp>
 #include <zlib.h>
 #include "TTFTable.hpp"
@@ -26,14 +27,34 @@ using namespace std;
 using namespace ttf;
 
 
+/** Computes the sum of the 32-bit big-endian words a data buffer consists of.
+ *  The buffer size must be a multiple of 4. The loop processes four words per
+ *  iteration using independent accumulators so that compilers can unroll and
+ *  vectorize the byte swapping and the summation.
+ *  @param[in] data buffer to process
+ *  @return the word sum modulo 2^32 */
+static uint32_t compute_checksum (const vector<char> &data) {
+	auto *bytes = reinterpret_cast<const uint8_t*>(data.data());
+	const size_t size = data.size();
+	uint32_t sum0=0, sum1=0, sum2=0, sum3=0;
+	size_t i=0;
+	for (; i+16 <= size; i+=16) {
+		sum0 += bytes[i]*0x1000000u + bytes[i+1]*0x10000u + bytes[i+2]*0x100u + bytes[i+3];
+		sum1 += bytes[i+4]*0x1000000u + bytes[i+5]*0x10000u + bytes[i+6]*0x100u + bytes[i+7];
+		sum2 += bytes[i+8]*0x1000000u + bytes[i+9]*0x10000u + bytes[i+10]*0x100u + bytes[i+11];
+		sum3 += bytes[i+12]*0x1000000u + bytes[i+13]*0x10000u + bytes[i+14]*0x100u + bytes[i+15];
+	}
+	for (; i < size; i+=4)
+		sum0 += bytes[i]*0x1000000u + bytes[i+1]*0x10000u + bytes[i+2]*0x100u + bytes[i+3];
+	return sum0+sum1+sum2+sum3;
+}
+
+
 TableBuffer::TableBuffer (uint32_t tag, vector<char> data)
 	: _tag(tag), _unpaddedSize(data.size()), _compressedSize(_unpaddedSize), _data(std::move(data))
 {
 	_data.resize((_unpaddedSize+3) & ~3, 0);  // ensure data.size() % 4 == 0
-	for (size_t i=0; i < paddedSize(); i+=4) {
-		auto *bytes = reinterpret_cast<const uint8_t*>(_data.data());
-		_checksum += bytes[i]*0x1000000 + bytes[i+1]*0x010000 + bytes[i+2]*0x0100 + bytes[i+3];
-	}
+	_checksum = compute_checksum(_data);
 }
 
 
@@ -57,8 +78,9 @@ string TableBuffer::name () const {
 
 /** Tries to compress the buffer data. If the size of the compressed buffer data is
  *  greater or equal than the size of the uncompressed data, the buffer stays uncompressed.
+ *  @param[in] level zlib compression level (0-9)
  *  @returns true if the data was compressed */
-void TableBuffer::compress () {
+void TableBuffer::compress (int level) {
 	if (_data.size() < 16)
 		return;
 	uLong compressedSize = compressBound(_data.size());
@@ -67,7 +89,7 @@ void TableBuffer::compress () {
 	// Only use the compressed data if it actually leads to a size reduction. Otherwise, use the original table data.
 	auto source = reinterpret_cast<const Bytef*>(_data.data());
 	auto target = reinterpret_cast<Bytef*>(&compressedData[0]);
-	if (compress2(target, &compressedSize, source, _unpaddedSize, Z_BEST_COMPRESSION) == Z_OK && compressedSize < _unpaddedSize) {
+	if (compress2(target, &compressedSize, source, _unpaddedSize, max(0, min(9, level))) == Z_OK && compressedSize < _unpaddedSize) {
 		_compressedSize = compressedSize;
 		_data = std::move(compressedData);
 		_data.resize((compressedSize+3) & ~3, 0);  // reduce buffer to padded compressed size
@@ -37,7 +37,7 @@ class TableBuffer {
 		uint32_t paddedSize () const {return uint32_t(_data.size());}
 		uint32_t compressedSize () const {return _compressedSize;}
 		uint32_t checksum () const {return _checksum;}
-		void compress ();
+		void compress (int level);
 		std::string name () const;
 
 		uint8_t getUInt8 (size_t offs) const {return _data[offs];}
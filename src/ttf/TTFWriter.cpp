@@ -18,14 +18,17 @@
 ** along with this program; if not, see <http://www.gnu.org/licenses/>. **
 *************************************************************************/
 
+#include <algorithm>
 #include <cmath>
 #include <iterator>
+#include <utility>
 #include <fstream>
 #include <list>
 #include <numeric>
 #include <woff2/encode.h>
 #include "TTFWriter.hpp"
 #include "../Font.hpp"
+#include "../FontWriter.hpp"
 #include "../utility.hpp"
 
 using namespace std;
@@ -47,10 +50,17 @@ TTFWriter::TTFWriter (const PhysicalFont &font, const set<int> &chars) :
 	}
 	for (TTFTable *table : _tables)
 		table->setTTFWriter(this);
-	for (uint32_t c : chars) {
-		uint32_t codepoint = font.unicode(c);
-		_unicodeCharMap.addRange(codepoint, codepoint, c);
-	}
+	// Collect the (codepoint, character code) pairs in a flat vector sorted by
+	// codepoints first. This way, each call of addRange() appends to or extends
+	// the last range of the map in constant time, while adding the codepoints in
+	// unsorted order would require linear-time inserts into the range vector.
+	vector<pair<uint32_t,uint32_t>> codepoints;
+	codepoints.reserve(chars.size());
+	for (uint32_t c : chars)
+		codepoints.emplace_back(font.unicode(c), c);
+	sort(codepoints.begin(), codepoints.end());
+	for (const auto &cppair : codepoints)
+		_unicodeCharMap.addRange(cppair.first, cppair.first, cppair.second);
 }
 
 
@@ -103,12 +113,28 @@ class TTFTableRecords : public TTFTable {
 };
 
 
+/** Assembles the font data in TrueType format in a single contiguous buffer.
+ *  The total font size is known once the table buffers are present, so the
+ *  buffer is allocated once and filled by sequential writes. */
+vector<char> TTFWriter::createTTFData () {
+	list<TableBuffer> buffers = createTableBuffers();
+	size_t ttfSize = std::accumulate(buffers.begin(), buffers.end(), size_t(0), [](size_t sum, const TableBuffer &buf) {
+		return sum + buf.paddedSize();
+	});
+	vector<char> ttfdata;
+	ttfdata.reserve(ttfSize);
+	for (; !buffers.empty(); buffers.pop_front()) {
+		const TableBuffer &buffer = buffers.front();
+		ttfdata.insert(ttfdata.end(), buffer._data.begin(), buffer._data.end());
+	}
+	return ttfdata;
+}
+
+
 /** Writes the font data in TrueType format to the given output stream. */
 bool TTFWriter::writeTTF (ostream &os) {
-	list<TableBuffer> buffers = createTableBuffers();
-	// write TTF data
-	for (; !buffers.empty(); buffers.pop_front())
-		buffers.front().write(os);
+	vector<char> ttfdata = createTTFData();
+	os.write(ttfdata.data(), streamsize(ttfdata.size()));
 	return true; // @@
 }
 
@@ -202,16 +228,18 @@ void TTFWriter::updateGlobalBbox (uint32_t c, int16_t xmin, int16_t ymin, int16_
 
 
 /** Converts TTF data to WOFF2 and writes the result to an output stream.
- *  @param[in] buffer contents of TTF file
+ *  @param[in] ttfdata pointer to the contents of a TTF file
+ *  @param[in] size number of bytes in the TTF data
  *  @param[in,out] os WOFF2 output stream
  *  @return true on success */
-static bool ttf_to_woff2 (const string &buffer, ostream &os) {
-	const uint8_t* input_data = reinterpret_cast<const uint8_t*>(buffer.data());
-	size_t output_size = woff2::MaxWOFF2CompressedSize(input_data, buffer.size());
+static bool ttf_to_woff2 (const char *ttfdata, size_t size, ostream &os) {
+	const uint8_t* input_data = reinterpret_cast<const uint8_t*>(ttfdata);
+	size_t output_size = woff2::MaxWOFF2CompressedSize(input_data, size);
 	string output(output_size, 0);
 	uint8_t* output_data = reinterpret_cast<uint8_t*>(&output[0]);
 	woff2::WOFF2Params params;
-	if (woff2::ConvertTTFToWOFF2(input_data, buffer.size(), output_data, &output_size, params)) {
+	params.brotli_quality = max(0, min(11, FontWriter::COMPRESSION_LEVEL));
+	if (woff2::ConvertTTFToWOFF2(input_data, size, output_data, &output_size, params)) {
 		output.resize(output_size);
 		copy(output.begin(), output.end(), ostream_iterator<uint8_t>(os));
 		return true;
@@ -222,10 +250,9 @@ static bool ttf_to_woff2 (const string &buffer, ostream &os) {
 
 /** Writes the font data in WOFF2 format to the given output stream. */
 bool TTFWriter::writeWOFF2 (ostream &os) {
-	ostringstream oss;
-	if (writeTTF(oss))
-		return ttf_to_woff2(oss.str(), os);
-	return false;
+	// hand the contiguous TTF data to the WOFF2 encoder without further copies
+	vector<char> ttfdata = createTTFData();
+	return ttf_to_woff2(ttfdata.data(), ttfdata.size(), os);
 }
 
 
@@ -246,7 +273,8 @@ bool TTFWriter::writeWOFF2 (const string &woff2name) {
 bool TTFWriter::convertTTFToWOFF2 (istream &is, ostream &os) {
 	ostringstream oss;
 	oss << is.rdbuf();
-	return ttf_to_woff2(oss.str(), os);
+	const string &ttfdata = oss.str();
+	return ttf_to_woff2(ttfdata.data(), ttfdata.size(), os);
 }
 
 
@@ -328,7 +356,7 @@ static bool ttf_to_woff (list<TableBuffer> &&buffers, ostream &os) {
 	buffers.pop_front();  // remove TTF header
 	buffers.pop_front();  // remove TTF table records
 	for (TableBuffer &buffer : buffers)
-		buffer.compress();
+		buffer.compress(min(9, FontWriter::COMPRESSION_LEVEL));  // zlib levels range from 0 to 9
 	size_t woffSize = std::accumulate(buffers.begin(), buffers.end(), size_t(0), [](size_t sum, const TableBuffer &buf) {
 		return sum + buf.paddedSize();
 	});
@@ -44,6 +44,7 @@ namespace ttf {
 class TTFWriter {
 	public:
 		TTFWriter (const PhysicalFont &font, const std::set<int> &chars);
+		std::vector<char> createTTFData ();
 		bool writeTTF (std::ostream &os);
 		bool writeWOFF (std::ostream &os);
 		bool writeWOFF2 (std::ostream &os);
@@ -260,6 +260,71 @@ bool util::read_double (istream &is, double &value) {
 }
 
 
+/** Encodes the contents of an input stream to Base64 and writes the result to
+ *  an output stream. The data is processed in buffered blocks rather than through
+ *  per-byte stream iterators, which speeds up the embedding of large amounts of
+ *  font and bitmap data considerably.
+ *  @param[in] is stream to read the data from
+ *  @param[in] os stream the encoded data is written to
+ *  @param[in] wrap if > 0, add a newline after the given number of characters written */
+void util::base64_copy (istream &is, ostream &os, int wrap) {
+	static const char *base64_chars = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+	constexpr size_t INBUFSIZE = 3*16384;  // multiple of 3 so that only the final block can end with a partial triplet
+	vector<char> inbuf(INBUFSIZE);
+	vector<char> outbuf;
+	outbuf.reserve(INBUFSIZE/3*4 + (wrap > 0 ? INBUFSIZE/3*4/wrap+1 : 0));
+	int count=0;  // number of characters written to the current line
+	auto emit = [&outbuf, &count, wrap](char c) {
+		if (wrap > 0 && ++count > wrap) {
+			count = 1;
+			outbuf.push_back('\n');
+		}
+		outbuf.push_back(c);
+	};
+	size_t numBytes;
+	do {
+		is.read(inbuf.data(), INBUFSIZE);
+		numBytes = size_t(is.gcount());
+		outbuf.clear();
+		auto *bytes = reinterpret_cast<const unsigned char*>(inbuf.data());
+		size_t i=0;
+		if (wrap <= 0) {  // fast path without line wrapping
+			for (; i+3 <= numBytes; i+=3) {
+				uint32_t n = (uint32_t(bytes[i]) << 16) | (uint32_t(bytes[i+1]) << 8) | bytes[i+2];
+				outbuf.push_back(base64_chars[(n >> 18) & 0x3f]);
+				outbuf.push_back(base64_chars[(n >> 12) & 0x3f]);
+				outbuf.push_back(base64_chars[(n >> 6) & 0x3f]);
+				outbuf.push_back(base64_chars[n & 0x3f]);
+			}
+		}
+		else {
+			for (; i+3 <= numBytes; i+=3) {
+				uint32_t n = (uint32_t(bytes[i]) << 16) | (uint32_t(bytes[i+1]) << 8) | bytes[i+2];
+				emit(base64_chars[(n >> 18) & 0x3f]);
+				emit(base64_chars[(n >> 12) & 0x3f]);
+				emit(base64_chars[(n >> 6) & 0x3f]);
+				emit(base64_chars[n & 0x3f]);
+			}
+		}
+		if (i < numBytes) {  // 1 or 2 bytes left => add padding
+			uint32_t n = uint32_t(bytes[i]) << 16;
+			int padding = 2;
+			if (i+1 < numBytes) {
+				n |= uint32_t(bytes[i+1]) << 8;
+				padding = 1;
+			}
+			for (int k=0; k <= 3-padding; k++) {
+				emit(char(base64_chars[(n >> 18) & 0x3f]));
+				n <<= 6;
+			}
+			while (padding--)
+				emit('=');
+		}
+		os.write(outbuf.data(), streamsize(outbuf.size()));
+	} while (numBytes == INBUFSIZE);
+}
+
+
 /** Returns the contents of a file.
  *  @param[in] fname name/path of the file */
 string util::read_file_contents (const string &fname) {
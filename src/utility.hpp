@@ -140,9 +140,7 @@ void base64_copy (InputIterator first, InputIterator last, OutputIterator dest,
 }
 
 
-inline void base64_copy (std::istream &is, std::ostream &os, int wrap=0) {
-	base64_copy(std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>(), std::ostreambuf_iterator<char>(os), wrap);
-}
+void base64_copy (std::istream &is, std::ostream &os, int wrap=0);
 
 
 /** Simple implementation mimicking std::make_unique introduced in C++14.
@@ -123,10 +123,15 @@ TEST(BezierTest, approximate) {
 	vector<double> times;
 	CubicBezier bezier(DPair(0,0), DPair(12,12), DPair(24,6), DPair(30,-5));
 	size_t size = bezier.approximate(0.1, points, &times);
-	double t[] = {0, 0.125, 0.25, 0.375, 0.5, 0.625, 0.75, 1};
+	double t[] = {
+		0, 0.0625, 0.125, 0.1875, 0.25, 0.3125, 0.375, 0.4375,
+		0.5, 0.5625, 0.625, 0.6875, 0.75, 0.8125, 0.875, 1
+	};
 	DPair p[] = {
-		DPair(0,0), DPair(4.488,3.681), DPair(8.906,5.828), DPair(13.183,6.591),
-		DPair(17.25,6.125), DPair(21.035,4.580), DPair(24.468,2.109), DPair(30,-5)
+		DPair(0,0), DPair(2.2485,2.0422), DPair(4.4883,3.6816), DPair(6.7104,4.9373),
+		DPair(8.9063,5.8281), DPair(11.0669,6.3733), DPair(13.1836,6.5918), DPair(15.2476,6.5027),
+		DPair(17.25,6.125), DPair(19.1821,5.4778), DPair(21.0352,4.5801), DPair(22.8003,3.4509),
+		DPair(24.4688,2.1094), DPair(26.0317,0.5745), DPair(27.4805,-1.1348), DPair(30,-5)
 	};
 	EXPECT_EQ(size, (size_t)sizeof(t)/sizeof(double));
 	EXPECT_EQ(points.size(), size);
@@ -46,18 +46,22 @@ TEST(BitmapTest, setBits) {
 	EXPECT_EQ(w, 5);
 	EXPECT_EQ(h, 1);
 
-	EXPECT_EQ(bitmap.rowPtr(3-3)[0], 0);
-	EXPECT_EQ(bitmap.rowPtr(3-3)[1], 0x7c);
+	vector<uint8_t> bytes;
+	int bpr = bitmap.copy(bytes);
+	EXPECT_EQ(bpr, 2);
+	EXPECT_EQ(bytes[(3-3)*bpr], 0);
+	EXPECT_EQ(bytes[(3-3)*bpr+1], 0x7c);
 
-	EXPECT_EQ(bitmap.rowPtr(10-3)[0], 0);
-	EXPECT_EQ(bitmap.rowPtr(10-3)[1], 0);
+	EXPECT_EQ(bytes[(10-3)*bpr], 0);
+	EXPECT_EQ(bytes[(10-3)*bpr+1], 0);
 	bitmap.setBits(10, -3, 10);
 	bitmap.getExtent(w, h);
 	EXPECT_EQ(w, 13);
 	EXPECT_EQ(h, 8);
 
-	EXPECT_EQ(bitmap.rowPtr(10-3)[0], 0x7f);
-	EXPECT_EQ(bitmap.rowPtr(10-3)[1], 0xe0);
+	bitmap.copy(bytes);
+	EXPECT_EQ(bytes[(10-3)*bpr], 0x7f);
+	EXPECT_EQ(bytes[(10-3)*bpr+1], 0xe0);
 }
 
 
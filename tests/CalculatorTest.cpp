@@ -65,6 +65,23 @@ TEST(CalculatorTest, variables) {
 }
 
 
+TEST(CalculatorTest, compile) {
+	Calculator calc;
+	Calculator::Expression expression = Calculator::compile("2a(1+2b)-a/2");
+	calc.setVariable("a", 1);
+	calc.setVariable("b", 3);
+	EXPECT_EQ(expression.evaluate(calc), 13.5);
+	calc.setVariable("a", 2);
+	calc.setVariable("b", 0.5);
+	EXPECT_EQ(expression.evaluate(calc), 7);
+	Calculator::Expression divByVar = Calculator::compile("1/a");
+	calc.setVariable("a", 4);
+	EXPECT_EQ(divByVar.evaluate(calc), 0.25);
+	calc.setVariable("a", 0);
+	ASSERT_THROW(divByVar.evaluate(calc), CalculatorException);
+}
+
+
 TEST(CalculatorTest, exceptions) {
 	Calculator calc;
 	ASSERT_THROW(calc.eval("2++3"), CalculatorException);
@@ -155,7 +155,7 @@ TEST(CommandLineTest, string_arg) {
 
 TEST(CommandLineTest, abbrev_long) {
 	CommandLine cmd;
-	const char *args[] = {"progname", "--pre=2", "--rot=-45.5", "--out=myfile.zyx", "--color"};
+	const char *args[] = {"progname", "--prec=2", "--rot=-45.5", "--out=myfile.zyx", "--color"};
 	char **argv = const_cast<char**>(args);
 	cmd.parse(5, argv);
 
@@ -106,12 +106,10 @@ TEST_F(EmSpecialTest, lines1) {
 	handler.processSpecial("linewidth 2bp");
 	for (int i=0; i < n; i++)
 		handler.processSpecial(string("line ")+XMLString(i)+", "+XMLString((i+1)%n));
+	handler.finishPage();
 	EXPECT_EQ(recorder.getPageXML(),
 		"<g id='page1'>\n"
-		"<line x1='0' y1='0' x2='10' y2='0' stroke-width='2' stroke='#000'/>\n"
-		"<line x1='10' y1='0' x2='10' y2='0' stroke-width='2' stroke='#000'/>\n"
-		"<line x1='10' y1='0' x2='0' y2='0' stroke-width='2' stroke='#000'/>\n"
-		"<line x1='0' y1='0' x2='0' y2='0' stroke-width='2' stroke='#000'/>\n"
+		"<path fill='none' stroke-width='2' stroke='#000' d='M0 0H10H0'/>\n"
 		"</g>"
 	);
 }
@@ -133,10 +131,7 @@ TEST_F(EmSpecialTest, lines2) {
 	handler.finishPage();
 	EXPECT_EQ(recorder.getPageXML(),
 		"<g id='page1'>\n"
-		"<line x1='0' y1='0' x2='10' y2='0' stroke-width='2' stroke='#000'/>\n"
-		"<line x1='10' y1='0' x2='10' y2='0' stroke-width='2' stroke='#000'/>\n"
-		"<line x1='10' y1='0' x2='0' y2='0' stroke-width='2' stroke='#000'/>\n"
-		"<line x1='0' y1='0' x2='0' y2='0' stroke-width='2' stroke='#000'/>\n"
+		"<path fill='none' stroke-width='2' stroke='#000' d='M0 0H10H0'/>\n"
 		"</g>"
 	);
 }
@@ -146,7 +141,8 @@ TEST_F(EmSpecialTest, pline) {
 	handler.processSpecial("point 1, 10, 10");
 	handler.processSpecial("point 2, 100, 100");
 	handler.processSpecial("line 1, 2, 10bp");
-	EXPECT_EQ(recorder.getPageXML(), "<g id='page1'>\n<line x1='10' y1='10' x2='100' y2='100' stroke-width='10' stroke='#000'/>\n</g>");
+	handler.finishPage();
+	EXPECT_EQ(recorder.getPageXML(), "<g id='page1'>\n<path fill='none' stroke-width='10' stroke='#000' d='M10 10L100 100'/>\n</g>");
 }
 
 
@@ -191,12 +187,13 @@ TEST_F(EmSpecialTest, lineto) {
 		handler.processSpecial("linewidth "+XMLString(2*i)+"bp");
 		handler.processSpecial(i == 0 ? "moveto" : "lineto");
 	}
+	handler.finishPage();
 	EXPECT_EQ(recorder.getPageXML(),
 		"<g id='page1'>\n"
-		"<line x1='0' y1='0' x2='10' y2='0' stroke-width='2' stroke='#f00'/>\n"
-		"<line x1='10' y1='0' x2='10' y2='0' stroke-width='4' stroke='#f00'/>\n"
-		"<line x1='10' y1='0' x2='0' y2='0' stroke-width='6' stroke='#f00'/>\n"
-		"<line x1='0' y1='0' x2='0' y2='0' stroke-width='8' stroke='#f00'/>\n"
+		"<path fill='none' stroke-width='2' stroke='#f00' d='M0 0H10'/>\n"
+		"<path fill='none' stroke-width='4' stroke='#f00' d='M10 0'/>\n"
+		"<path fill='none' stroke-width='6' stroke='#f00' d='M10 0H0'/>\n"
+		"<path fill='none' stroke-width='8' stroke='#f00' d='M0 0'/>\n"
 		"</g>"
 	);
 }
@@ -167,7 +167,48 @@ TEST_F(FontCacheTest, fontinfo2) {
 	ostringstream oss;
 	cache.fontinfo(cachedir, oss);
 	ASSERT_EQ(oss.str(),
-		"cache format version 5\n"
-		"testfont      2 glyphs        10 cmds          58 bytes  hash:3cb32ab6\n"
+		"cache format version 6\n"
+		"testfont      2 glyphs        10 cmds          66 bytes  hash:33a836f1\n"
 	);
 }
+
+
+TEST_F(FontCacheTest, archive) {
+	cache.setGlyph(1, glyph1);
+	cache.setGlyph(10, glyph2);
+	ASSERT_TRUE(cache.write("testfont", cachedir));
+
+	ostringstream oss;
+	string archivename = cachedir+"/cache.fgca";
+	ASSERT_TRUE(FontCache::exportArchive(cachedir, archivename, oss));
+	ASSERT_EQ(oss.str(), "1 cache file exported to "+archivename+"\n");
+
+	// fonts already present in the cache directory are not overwritten
+	oss.str("");
+	ASSERT_TRUE(FontCache::importArchive(archivename, cachedir, oss));
+	ASSERT_EQ(oss.str(),
+		"0 cache files imported\n"
+		"1 cache file skipped (already present)\n"
+	);
+
+	// importing the archive restores the removed cache file including its glyph data
+	FileSystem::remove(cachedir+"/testfont.fgd");
+	oss.str("");
+	ASSERT_TRUE(FontCache::importArchive(archivename, cachedir, oss));
+	ASSERT_EQ(oss.str(), "1 cache file imported\n");
+	cache.clear();
+	ASSERT_TRUE(cache.read("testfont", cachedir));
+	ASSERT_NE(cache.getGlyph(1), nullptr);
+	EXPECT_EQ(*cache.getGlyph(1), glyph1);
+	ASSERT_NE(cache.getGlyph(10), nullptr);
+	EXPECT_EQ(*cache.getGlyph(10), glyph2);
+
+	// a corrupted archive is rejected
+	ofstream invalidArchive(archivename, ios::binary);
+	invalidArchive << "invalid archive data";
+	invalidArchive.close();
+	oss.str("");
+	ASSERT_FALSE(FontCache::importArchive(archivename, cachedir, oss));
+	ASSERT_EQ(oss.str(), "invalid or incompatible cache archive "+archivename+"\n");
+	FileSystem::remove(archivename);
+}
@@ -0,0 +1,92 @@
+/*************************************************************************
+** MemoryPoolTest.cpp                                                   **
+**                                                                      **
+** This file is part of dvisvgm -- a fast DVI to SVG converter          **
+** Copyright (C) 2005-2024 Martin Gieseking <martin.gieseking@uos.de>   **
+**                                                                      **
+** This program is free software; you can redistribute it and/or        **
+** modify it under the terms of the GNU General Public License as       **
+** published by the Free Software Foundation; either version 3 of       **
+** the License, or (at your option) any later version.                  **
+**                                                                      **
+** This program is distributed in the hope that it will be useful, but  **
+** WITHOUT ANY WARRANTY; without even the implied warranty of           **
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the         **
+** GNU General Public License for more details.                         **
+**                                                                      **
+** You should have received a copy of the GNU General Public License    **
+** along with this program; if not, see <http://www.gnu.org/licenses/>. **
+*************************************************************************/
+
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include "MemoryPool.hpp"
+
+using namespace std;
+
+
+TEST(MemoryPoolTest, alloc) {
+	MemoryPool pool;
+	void *p1 = pool.alloc(24);
+	void *p2 = pool.alloc(24);
+	ASSERT_NE(p1, nullptr);
+	ASSERT_NE(p2, nullptr);
+	EXPECT_NE(p1, p2);
+	// blocks must be writable and not overlap
+	memset(p1, 0xaa, 24);
+	memset(p2, 0xbb, 24);
+	EXPECT_EQ(*static_cast<unsigned char*>(p1), 0xaa);
+	EXPECT_EQ(*static_cast<unsigned char*>(p2), 0xbb);
+	pool.dealloc(p1, 24);
+	pool.dealloc(p2, 24);
+}
+
+
+TEST(MemoryPoolTest, recycle) {
+	MemoryPool pool;
+	void *p1 = pool.alloc(40);
+	pool.dealloc(p1, 40);
+	// a released block of the same size class is handed out again
+	void *p2 = pool.alloc(33);
+	EXPECT_EQ(p1, p2);
+	// blocks of a different size class come from different memory
+	void *p3 = pool.alloc(16);
+	EXPECT_NE(p2, p3);
+	pool.dealloc(p2, 33);
+	pool.dealloc(p3, 16);
+}
+
+
+TEST(MemoryPoolTest, alignment) {
+	MemoryPool pool;
+	for (size_t size : {1u, 8u, 17u, 100u, 256u}) {
+		void *p = pool.alloc(size);
+		EXPECT_EQ(reinterpret_cast<uintptr_t>(p) % 16, 0u) << "size=" << size;
+		pool.dealloc(p, size);
+	}
+}
+
+
+TEST(MemoryPoolTest, oversized) {
+	MemoryPool pool;
+	// requests exceeding the maximum block size are forwarded to operator new
+	void *p = pool.alloc(10000);
+	ASSERT_NE(p, nullptr);
+	memset(p, 0xcc, 10000);
+	pool.dealloc(p, 10000);
+}
+
+
+TEST(MemoryPoolTest, massAlloc) {
+	MemoryPool pool;
+	vector<void*> blocks;
+	for (int i=0; i < 100000; i++)
+		blocks.push_back(pool.alloc(48));
+	for (void *p : blocks)
+		pool.dealloc(p, 48);
+	// all released blocks are available for reuse
+	for (int i=0; i < 100000; i++)
+		pool.alloc(48);
+}
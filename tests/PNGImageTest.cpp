@@ -0,0 +1,92 @@
+/*************************************************************************
+** PNGImageTest.cpp                                                     **
+**                                                                      **
+** This file is part of dvisvgm -- a fast DVI to SVG converter          **
+** Copyright (C) 2005-2024 Martin Gieseking <martin.gieseking@uos.de>   **
+**                                                                      **
+** This program is free software; you can redistribute it and/or        **
+** modify it under the terms of the GNU General Public License as       **
+** published by the Free Software Foundation; either version 3 of       **
+** the License, or (at your option) any later version.                  **
+**                                                                      **
+** This program is distributed in the hope that it will be useful, but  **
+** WITHOUT ANY WARRANTY; without even the implied warranty of           **
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the         **
+** GNU General Public License for more details.                         **
+**                                                                      **
+** You should have received a copy of the GNU General Public License    **
+** along with this program; if not, see <http://www.gnu.org/licenses/>. **
+*************************************************************************/
+
+#include <gtest/gtest.h>
+#include <sstream>
+#include <vector>
+#include <zlib.h>
+#include "PNGImage.hpp"
+
+using namespace std;
+
+
+/** Reads a big-endian 32-bit integer located at the given offset. */
+static uint32_t read_uint32 (const string &data, size_t offset) {
+	uint32_t value=0;
+	for (size_t i=0; i < 4; i++)
+		value = (value << 8) | uint8_t(data[offset+i]);
+	return value;
+}
+
+
+TEST(PNGImageTest, construct) {
+	PNGImage image(3, 2);
+	EXPECT_EQ(image.width(), 3);
+	EXPECT_EQ(image.height(), 2);
+	// degenerate dimensions are bumped to a single pixel
+	PNGImage tiny(0, -5);
+	EXPECT_EQ(tiny.width(), 1);
+	EXPECT_EQ(tiny.height(), 1);
+}
+
+
+TEST(PNGImageTest, write) {
+	PNGImage image(3, 2);
+	image.setPixel(0, 0, Color(1.0, 0.0, 0.0));
+	image.setPixel(2, 1, Color(0.0, 0.0, 1.0));
+	image.setPixel(-1, 0, Color(0.0, 1.0, 0.0));  // outside the image area, ignored
+	image.setPixel(0, 2, Color(0.0, 1.0, 0.0));   // outside the image area, ignored
+	ostringstream oss;
+	ASSERT_TRUE(image.write(oss));
+	string png = oss.str();
+	// check PNG signature
+	ASSERT_GT(png.length(), 8u);
+	EXPECT_EQ(png.substr(0, 8), string("\x89PNG\r\n\x1a\n", 8));
+	// check IHDR chunk: width 3, height 2, bit depth 8, color type 6 (RGBA)
+	ASSERT_EQ(png.substr(12, 4), "IHDR");
+	EXPECT_EQ(read_uint32(png, 8), 13u);
+	EXPECT_EQ(read_uint32(png, 16), 3u);
+	EXPECT_EQ(read_uint32(png, 20), 2u);
+	EXPECT_EQ(uint8_t(png[24]), 8);
+	EXPECT_EQ(uint8_t(png[25]), 6);
+	// check CRC of IHDR chunk
+	uint32_t crc = crc32(0, nullptr, 0);
+	crc = crc32(crc, reinterpret_cast<const Bytef*>(png.data()+12), 17);
+	EXPECT_EQ(read_uint32(png, 29), crc);
+	// check IDAT chunk: decompress and compare the pixel rows
+	ASSERT_EQ(png.substr(37, 4), "IDAT");
+	uint32_t idatSize = read_uint32(png, 33);
+	vector<uint8_t> rows(2*(1+3*4));  // two rows of 3 RGBA pixels, each preceded by a filter byte
+	uLongf rowsSize = rows.size();
+	ASSERT_EQ(uncompress(rows.data(), &rowsSize, reinterpret_cast<const Bytef*>(png.data()+41), idatSize), Z_OK);
+	ASSERT_EQ(rowsSize, rows.size());
+	EXPECT_EQ(rows[0], 0);  // filter type of first row
+	const uint8_t red[4] = {255, 0, 0, 255};
+	const uint8_t blue[4] = {0, 0, 255, 255};
+	for (int i=0; i < 4; i++) {
+		EXPECT_EQ(rows[1+i], red[i]) << "i=" << i;
+		EXPECT_EQ(rows[1+(1+3*4)+2*4+i], blue[i]) << "i=" << i;
+	}
+	// pixels that were never set must be transparent
+	EXPECT_EQ(rows[1+4+3], 0);
+	// check presence of IEND chunk at the end of the file
+	ASSERT_GE(png.length(), 57u+idatSize);
+	EXPECT_EQ(png.substr(49+idatSize, 4), "IEND");
+}
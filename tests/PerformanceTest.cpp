@@ -0,0 +1,167 @@
+/*************************************************************************
+** PerformanceTest.cpp                                                  **
+**                                                                      **
+** This file is part of dvisvgm -- a fast DVI to SVG converter          **
+** Copyright (C) 2005-2024 Martin Gieseking <martin.gieseking@uos.de>   **
+**                                                                      **
+** This program is free software; you can redistribute it and/or        **
+** modify it under the terms of the GNU General Public License as       **
+** published by the Free Software Foundation; either version 3 of       **
+** the License, or (at your option) any later version.                  **
+**                                                                      **
+** This program is distributed in the hope that it will be useful, but  **
+** WITHOUT ANY WARRANTY; without even the implied warranty of           **
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the         **
+** GNU General Public License for more details.                         **
+**                                                                      **
+** You should have received a copy of the GNU General Public License    **
+** along with this program; if not, see <http://www.gnu.org/licenses/>. **
+*************************************************************************/
+
+#include <gtest/gtest.h>
+#include <cstdlib>
+#include <functional>
+#include <new>
+#include <sstream>
+#include "FileSystem.hpp"
+#include "FontCache.hpp"
+#include "GraphicsPath.hpp"
+#include "GraphicsPathParser.hpp"
+#include "System.hpp"
+#include "XMLString.hpp"
+
+#ifndef BUILDDIR
+#define BUILDDIR "."
+#endif
+
+using namespace std;
+
+// The tests in this file guard against accidental algorithmic regressions
+// (e.g. an O(n^2) slip in a parser) rather than measuring exact speed. The
+// thresholds are therefore deliberately generous — an order of magnitude
+// above typical times on current hardware — and can be scaled further via
+// environment variable DVISVGM_PERF_SCALE for slow CI runners. Setting
+// DVISVGM_PERF_CALIBRATE=1 only prints the measured times without failing,
+// which helps to pick thresholds for new tests and machines.
+
+
+// Allocation counter used to audit the heap usage of the string formatting
+// code. The replaced operators forward to malloc/free and count each request,
+// so the tests below can verify that hot call sites keep their results within
+// the small-string buffer of std::string instead of falling back to the heap.
+static size_t numAllocations = 0;
+
+void* operator new (size_t size) {
+	++numAllocations;
+	if (void *ptr = std::malloc(size))
+		return ptr;
+	throw std::bad_alloc();
+}
+
+void operator delete (void *ptr) noexcept {std::free(ptr);}
+void operator delete (void *ptr, size_t) noexcept {std::free(ptr);}
+
+
+/** Runs a task and checks its wall time against a threshold (in seconds). */
+static void expect_duration_below (double threshold, const char *name, const function<void ()> &task) {
+	double scale = 1;
+	if (const char *scalestr = getenv("DVISVGM_PERF_SCALE"))
+		scale = max(1.0, atof(scalestr));
+	double start = System::time();
+	task();
+	double duration = System::time()-start;
+	cout << "[perf] " << name << ": " << duration << "s (threshold " << threshold*scale << "s)\n";
+	if (!getenv("DVISVGM_PERF_CALIBRATE"))
+		EXPECT_LT(duration, threshold*scale) << "performance regression in " << name;
+}
+
+
+TEST(PerformanceTest, pathParser) {
+	// parse a path string of about one megabyte
+	ostringstream oss;
+	oss << "M0 0";
+	for (int i=0; i < 30000; i++) {
+		oss << 'L' << i%1000 << ' ' << (i*7)%1000
+			 << 'C' << i%97 << ' ' << i%89 << ' ' << i%83 << ' ' << i%79 << ' ' << i%73 << ' ' << i%71
+			 << 'Q' << i%67 << ' ' << i%61 << ' ' << i%59 << ' ' << i%53;
+	}
+	oss << 'Z';
+	const string pathstr = oss.str();
+	ASSERT_GT(pathstr.length(), 1000000u);
+	expect_duration_below(2.0, "GraphicsPathParser, 1 MB path string", [&pathstr] {
+		GraphicsPathParser<double> parser;
+		auto path = parser.parse(pathstr);
+		EXPECT_FALSE(path.empty());
+	});
+}
+
+
+TEST(PerformanceTest, xmlString) {
+	// format a million doubles
+	expect_duration_below(2.5, "XMLString, 1M doubles", [] {
+		size_t totalLength=0;
+		for (int i=0; i < 1000000; i++)
+			totalLength += XMLString(i*0.12345).length();
+		EXPECT_GT(totalLength, 1000000u);
+	});
+}
+
+
+TEST(PerformanceTest, xmlStringAllocations) {
+	// Formatted numbers of typical magnitude fit into the small-string buffer
+	// of std::string, so converting them must not touch the heap at all.
+	size_t totalLength=0;
+	size_t count = numAllocations;
+	for (int i=0; i < 1000; i++) {
+		totalLength += XMLString(i*0.123).length();
+		totalLength += XMLString(i).length();
+	}
+	count = numAllocations-count;
+	cout << "[perf] XMLString, heap allocations for 2k short numbers: " << count << '\n';
+	EXPECT_EQ(count, 0u);
+	EXPECT_GT(totalLength, 4000u);
+}
+
+
+TEST(PerformanceTest, pathDataAllocations) {
+	// The SVG path data must be formatted directly into the preallocated result
+	// string; besides a few growth steps in case the size estimate is too small,
+	// no temporary heap strings may be created per path command.
+	GraphicsPath<double> path;
+	path.moveto(0, 0);
+	for (int i=1; i <= 1000; i++)
+		path.cubicto(i%23, i%7, i%11, i%13, i%17, i%19);
+	path.closepath();
+	size_t count = numAllocations;
+	string pathdata = path.svgPathData(true);
+	count = numAllocations-count;
+	cout << "[perf] GraphicsPath::svgPathData, heap allocations for 1000 curves: " << count << '\n';
+	EXPECT_LE(count, 5u);
+	EXPECT_GT(pathdata.length(), 5000u);
+}
+
+
+TEST(PerformanceTest, fontCacheRoundTrip) {
+	// write and read back a cache file containing 10k glyphs
+	const string cachedir = BUILDDIR"/data";
+	const bool created = !FileSystem::exists(cachedir) && FileSystem::mkdir(cachedir);
+	expect_duration_below(3.0, "FontCache, 10k glyph round trip", [&cachedir] {
+		FontCache cache;
+		for (int c=1; c <= 10000; c++) {
+			Glyph glyph;
+			glyph.moveto(c, 0);
+			glyph.lineto(c+10, 0);
+			glyph.cubicto(c+10, 10, c+20, 0, c+50, 50);
+			glyph.quadto(c+20, 40, c+20, 20);
+			glyph.closepath();
+			cache.setGlyph(c, glyph);
+		}
+		ASSERT_TRUE(cache.write("perftestfont", cachedir));
+		FontCache cache2;
+		ASSERT_TRUE(cache2.read("perftestfont", cachedir));
+		ASSERT_NE(cache2.getGlyph(10000), nullptr);
+	});
+	FileSystem::remove(cachedir+"/perftestfont.fgd");
+	if (created)
+		FileSystem::rmdir(cachedir);
+}
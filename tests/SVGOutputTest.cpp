@@ -133,9 +133,10 @@ TEST_F(SVGOutputTest, getPageStream) {
 		ostream &os = out.getPageStream(1, 10);
 		EXPECT_EQ(&os, &cout);
 	}{
+		// pages written to files are collected in a buffer first
 		SVGOutput out("SVGOutputTest.cpp", "%f-%p");
 		ostream *os1 = &out.getPageStream(1, 10);
-		EXPECT_TRUE(dynamic_cast<ofstream*>(os1));
+		EXPECT_TRUE(dynamic_cast<ostringstream*>(os1));
 		ostream *os2 = &out.getPageStream(1, 10);
 		EXPECT_EQ(os1, os2);
 	}
@@ -143,12 +144,53 @@ TEST_F(SVGOutputTest, getPageStream) {
 	{
 		SVGOutput out("SVGOutputTest.cpp", "%f-%p", 9);
 		ostream *os = &out.getPageStream(1, 10);
-		EXPECT_TRUE(dynamic_cast<ZLibOutputStream*>(os));
+		EXPECT_TRUE(dynamic_cast<ostringstream*>(os));
 	}
 	FileSystem::remove("SVGOutputTest-01.svgz");
 }
 
 
+TEST_F(SVGOutputTest, pageFrames) {
+	SVGOutput::PAGE_FRAMES = true;
+	ostringstream capture;
+	streambuf *coutbuf = cout.rdbuf(capture.rdbuf());
+	{
+		SVGOutput out("", "");
+		out.getPageStream(1, 2) << "<svg>page 1</svg>";
+		out.finish();
+		SVGOutput::HashTriple hashes("dvihash", "opthash", "cmbhash");
+		out.getPageStream(2, 2, hashes) << "<svg>page 2</svg>";
+		out.finish();
+	}
+	cout.rdbuf(coutbuf);
+	SVGOutput::PAGE_FRAMES = false;
+	string records = capture.str();
+	string record1 = "dvisvgm-page: page=1 pages=2 length=17\n<svg>page 1</svg>\n";
+	string record2 = "dvisvgm-page: page=2 pages=2 hash=cmbhash length=17\n<svg>page 2</svg>\n";
+	EXPECT_EQ(records, record1+record2);
+}
+
+
+TEST_F(SVGOutputTest, reemitPage) {
+	const string pageData = "<svg>page data</svg>";
+	{
+		SVGOutput out("SVGOutputTest.cpp", "%f-%p");
+		EXPECT_THROW(out.reemitPage(FilePath("SVGOutputTest-copy.svg"), 0), MessageException);
+		out.getPageStream(1, 10) << pageData;
+		out.finish();
+		out.reemitPage(FilePath("SVGOutputTest-copy.svg"), 0);
+	}
+	for (const char *fname : {"SVGOutputTest-01.svg", "SVGOutputTest-copy.svg"}) {
+		ifstream ifs(fname);
+		ASSERT_TRUE(bool(ifs)) << fname;
+		string contents((istreambuf_iterator<char>(ifs)), istreambuf_iterator<char>());
+		EXPECT_EQ(contents, pageData) << fname;
+	}
+	FileSystem::remove("SVGOutputTest-01.svg");
+	FileSystem::remove("SVGOutputTest-copy.svg");
+}
+
+
 TEST_F(SVGOutputTest, ignore) {
 	SVGOutput out("SVGOutputTest.cpp", "%x %y");
 	EXPECT_EQ(out.filepath(5, 9).relative(), "SVGOutputTest-5.svg");
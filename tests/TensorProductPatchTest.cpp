@@ -236,6 +236,22 @@ TEST_F(TensorProductPatchTest, boundaryPath) {
 }
 
 
+TEST_F(TensorProductPatchTest, meshData) {
+	ShadingPatch::MeshData mesh = _patch.getMeshData();
+	EXPECT_EQ(mesh.startPoint, DPair(10, 10));
+	ASSERT_EQ(mesh.stops.size(), 4u);
+	// the edges follow the boundary path, the colors belong to their starting corners
+	EXPECT_EQ(mesh.stops[0].pathData, "C20 0 50 30 70 20");
+	EXPECT_EQ(mesh.stops[0].color, Color(1.0, 0.0, 0.0));
+	EXPECT_EQ(mesh.stops[1].pathData, "C80 50 90 60 100 70");
+	EXPECT_EQ(mesh.stops[1].color, Color(1.0, 1.0, 0.0));
+	EXPECT_EQ(mesh.stops[2].pathData, "C70 100 20 100 10 70");
+	EXPECT_EQ(mesh.stops[2].color, Color(1.0, 0.0, 1.0));
+	EXPECT_EQ(mesh.stops[3].pathData, "C20 40 0 30 10 10");
+	EXPECT_EQ(mesh.stops[3].color, Color(0.0, 1.0, 0.0));
+}
+
+
 TEST_F(TensorProductPatchTest, subpatch) {
 	TensorProductPatch tpp;
 	_patch.subpatch(0, 0.5, 0, 0.5, tpp);
@@ -297,6 +313,16 @@ TEST_F(TensorProductPatchTest, approximate) {
 }
 
 
+TEST_F(TensorProductPatchTest, estimatedSegments) {
+	// monochromatic patches are represented by a single boundary path
+	vector<Color> colors(4);
+	TensorProductPatch tpp(_points, colors, Color::ColorSpace::RGB, 0, nullptr);
+	EXPECT_EQ(tpp.estimatedSegments(2), 1);
+	// the fixture patch is subdivided into the full 2x2 grid
+	EXPECT_EQ(_patch.estimatedSegments(2), 4);
+}
+
+
 TEST_F(TensorProductPatchTest, fail) {
 	// edge flag == 0
 	vector<DPair> points(15);
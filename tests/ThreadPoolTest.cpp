@@ -0,0 +1,74 @@
+/*************************************************************************
+** ThreadPoolTest.cpp                                                   **
+**                                                                      **
+** This file is part of dvisvgm -- a fast DVI to SVG converter          **
+** Copyright (C) 2005-2024 Martin Gieseking <martin.gieseking@uos.de>   **
+**                                                                      **
+** This program is free software; you can redistribute it and/or        **
+** modify it under the terms of the GNU General Public License as       **
+** published by the Free Software Foundation; either version 3 of       **
+** the License, or (at your option) any later version.                  **
+**                                                                      **
+** This program is distributed in the hope that it will be useful, but  **
+** WITHOUT ANY WARRANTY; without even the implied warranty of           **
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the         **
+** GNU General Public License for more details.                         **
+**                                                                      **
+** You should have received a copy of the GNU General Public License    **
+** along with this program; if not, see <http://www.gnu.org/licenses/>. **
+*************************************************************************/
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <stdexcept>
+#include "ThreadPool.hpp"
+
+using namespace std;
+
+
+TEST(ThreadPoolTest, enqueue) {
+	atomic<int> counter{0};
+	vector<future<void>> futures;
+	{
+		ThreadPool pool(4);
+		EXPECT_EQ(pool.numThreads(), 4u);
+		for (int i=0; i < 100; i++)
+			futures.push_back(pool.enqueue([&counter] {counter++;}));
+	}
+	// the pool destructor waits for all pending tasks
+	EXPECT_EQ(counter, 100);
+	for (future<void> &fut : futures) {
+		ASSERT_TRUE(fut.valid());
+		EXPECT_NO_THROW(fut.get());
+	}
+}
+
+
+TEST(ThreadPoolTest, bounded_queue) {
+	atomic<int> counter{0};
+	{
+		ThreadPool pool(2, 4);
+		for (int i=0; i < 50; i++)
+			pool.enqueue([&counter] {counter++;});
+	}
+	EXPECT_EQ(counter, 50);
+}
+
+
+TEST(ThreadPoolTest, exception) {
+	ThreadPool pool(1);
+	future<void> fut = pool.enqueue([] {throw runtime_error("failed");});
+	EXPECT_THROW(fut.get(), runtime_error);
+	// the worker must survive the exception and process further tasks
+	future<void> fut2 = pool.enqueue([] {});
+	EXPECT_NO_THROW(fut2.get());
+}
+
+
+TEST(ThreadPoolTest, preferredThreadCount) {
+	EXPECT_EQ(ThreadPool::preferredThreadCount(0), 1u);
+	EXPECT_EQ(ThreadPool::preferredThreadCount(1), 1u);
+	size_t count = ThreadPool::preferredThreadCount(10000);
+	EXPECT_GE(count, 1u);
+	EXPECT_LE(count, 10000u);
+}
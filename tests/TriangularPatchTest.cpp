@@ -131,6 +131,31 @@ TEST(TriangularPatchTest, boundaryPath) {
 }
 
 
+TEST(TriangularPatchTest, meshData) {
+	vector<DPair> points(3);
+	points[0] = DPair(0, 0);
+	points[1] = DPair(10, 0);
+	points[2] = DPair(0, 10);
+	vector<Color> colors(3);
+	colors[0] = Color(1.0, 0.0, 0.0);
+	colors[1] = Color(0.0, 1.0, 0.0);
+	colors[2] = Color(0.0, 0.0, 1.0);
+	TriangularPatch tp(points, colors, Color::ColorSpace::RGB, 0, 0);
+	ShadingPatch::MeshData mesh = tp.getMeshData();
+	EXPECT_EQ(mesh.startPoint, DPair(0, 0));
+	ASSERT_EQ(mesh.stops.size(), 4u);
+	EXPECT_EQ(mesh.stops[0].pathData, "L10 0");
+	EXPECT_EQ(mesh.stops[0].color, Color(1.0, 0.0, 0.0));
+	EXPECT_EQ(mesh.stops[1].pathData, "L0 10");
+	EXPECT_EQ(mesh.stops[1].color, Color(0.0, 1.0, 0.0));
+	// the third edge of the degenerate Coons patch has zero length
+	EXPECT_EQ(mesh.stops[2].pathData, "L0 10");
+	EXPECT_EQ(mesh.stops[2].color, Color(0.0, 0.0, 1.0));
+	EXPECT_EQ(mesh.stops[3].pathData, "L0 0");
+	EXPECT_EQ(mesh.stops[3].color, Color(0.0, 0.0, 1.0));
+}
+
+
 class Callback : public ShadingPatch::Callback {
 	public:
 		void patchSegment (GraphicsPath<double> &path, const Color &color) {
@@ -169,6 +194,21 @@ TEST(TriangularPatchTest, approximate) {
 }
 
 
+TEST(TriangularPatchTest, estimatedSegments) {
+	vector<DPair> points(3);
+	points[0] = DPair(0, 0);
+	points[1] = DPair(10, 0);
+	points[2] = DPair(0, 10);
+	vector<Color> colors(3);
+	TriangularPatch tp(points, colors, Color::ColorSpace::RGB, 0, 0);
+	// monochromatic patches are represented by a single boundary path
+	EXPECT_EQ(tp.estimatedSegments(2), 1);
+	tp.setColors(Color(1.0, 0.0, 0.0), Color(0.0, 1.0, 0.0), Color(0.0, 0.0, 1.0));
+	// the patch is subdivided into the full 2x2 grid
+	EXPECT_EQ(tp.estimatedSegments(2), 4);
+}
+
+
 TEST(TriangularPatchTest, fail) {
 	vector<DPair> points(3);
 	vector<Color> colors(3);
@@ -284,6 +284,62 @@ TEST(XMLNodeTest, insertAfter) {
 }
 
 
+static string serialized (const XMLElement &elem) {
+	ostringstream oss;
+	elem.write(oss);
+	string str = oss.str();
+	str.erase(remove(str.begin(), str.end(), '\n'), str.end());
+	return str;
+}
+
+
+TEST(XMLNodeTest, wrapUnwrap) {
+	XMLElement root("root");
+	root.append(util::make_unique<XMLElement>("child1"));
+	XMLNode *child2Ptr = root.append(util::make_unique<XMLElement>("child2"));
+	XMLNode *child3Ptr = root.append(util::make_unique<XMLElement>("child3"));
+	root.append(util::make_unique<XMLElement>("child4"));
+	XMLElement *group = XMLElement::wrap(child2Ptr, child3Ptr, "g");
+	ASSERT_NE(group, nullptr);
+	EXPECT_EQ(serialized(root), "<root><child1/><g><child2/><child3/></g><child4/></root>");
+	EXPECT_EQ(group->parent(), &root);
+	EXPECT_EQ(child2Ptr->parent(), group);
+	EXPECT_EQ(child3Ptr->parent(), group);
+	XMLNode *firstUnwrapped = XMLElement::unwrap(group);
+	EXPECT_EQ(firstUnwrapped, child2Ptr);
+	EXPECT_EQ(serialized(root), "<root><child1/><child2/><child3/><child4/></root>");
+	for (XMLNode *node=root.firstChild(); node; node=node->next()) {
+		EXPECT_EQ(node->parent(), &root);
+		if (node->prev()) {
+			EXPECT_EQ(node->prev()->next(), node);
+		}
+	}
+}
+
+
+TEST(XMLNodeTest, spliceChildren) {
+	XMLElement root("root");
+	XMLNode *child1Ptr = root.append(util::make_unique<XMLElement>("child1"));
+	root.append(util::make_unique<XMLElement>("child2"));
+	XMLElement source("source");
+	XMLNode *child3Ptr = source.append(util::make_unique<XMLElement>("child3"));
+	source.append(util::make_unique<XMLElement>("child4"));
+	EXPECT_EQ(root.spliceChildren(&source, child1Ptr), child3Ptr);
+	EXPECT_EQ(serialized(root), "<root><child1/><child3/><child4/><child2/></root>");
+	EXPECT_TRUE(source.empty());
+	// splicing an empty element moves nothing
+	EXPECT_EQ(root.spliceChildren(&source), nullptr);
+	// splice children to the beginning of the child list
+	XMLElement source2("source2");
+	source2.append(util::make_unique<XMLElement>("child5"));
+	EXPECT_NE(root.spliceChildren(&source2), nullptr);
+	EXPECT_EQ(serialized(root), "<root><child5/><child1/><child3/><child4/><child2/></root>");
+	for (XMLNode *node=root.firstChild(); node; node=node->next())
+		EXPECT_EQ(node->parent(), &root);
+	EXPECT_EQ(root.lastChild()->next(), nullptr);
+}
+
+
 TEST(XMLNodeTest, getDescendants) {
 	XMLElement root("root");
 	auto child1 = util::make_unique<XMLElement>("child");
@@ -372,6 +428,25 @@ TEST(XMLNodeTest, write) {
 }
 
 
+TEST(XMLNodeTest, writeCompact) {
+	XMLElement root("root");
+	auto child1 = util::make_unique<XMLElement>("child");
+	auto child2 = util::make_unique<XMLElement>("childX");
+	child2->append("text");
+	child1->append(std::move(child2));
+	root.append(std::move(child1));
+	root.append(util::make_unique<XMLElement>("child"));
+	XMLElement::WRITE_NEWLINES = false;
+	ostringstream oss;
+	root.write(oss);
+	XMLElement::WRITE_NEWLINES = true;
+	EXPECT_EQ(oss.str(), "<root><child><childX>text</childX></child><child/></root>");
+	oss.str("");
+	root.write(oss);
+	EXPECT_EQ(oss.str(), "<root>\n<child>\n<childX>text</childX>\n</child>\n<child/>\n</root>");
+}
+
+
 TEST(XMLNodeTest, cdata) {
 	XMLElement root("root");
 	auto cdataNode = util::make_unique<XMLCData>("text & <text>");
@@ -0,0 +1,38 @@
+#!/bin/bash
+# This file is part of the dvisvgm package and published under the
+# terms of the GNU General Public License version 3 or later.
+# See file COPYING for further details.
+# Copyright (C) 2009-2024 Martin Gieseking <martin.gieseking@uos.de>
+#
+# Converts a small corpus of representative input files and prints the wall
+# time and peak memory usage of each conversion together with the per-stage
+# times reported by dvisvgm --timings. The output consists of tab-separated
+# lines of the form "file<TAB>key<TAB>calls<TAB>value" so that the results
+# can be tracked across releases by scripts.
+
+files=(sample frktest sample_v2 sample_v3)
+state=0
+
+: ${srcdir:=.}
+dvisvgm=../src/dvisvgm
+timecmd=$(command -v /usr/bin/time)
+
+for f in ${files[@]}; do
+	infile=${srcdir}/data/$f.dvi
+	outfile=benchmark-$f.svg
+	if [ -n "$timecmd" ]; then
+		timings=$($timecmd -f "wall\t1\t%e\nmaxrss_kb\t1\t%M" $dvisvgm -v0 --timings -p1- -o$outfile $infile 2>&1)
+	else
+		timings=$($dvisvgm -v0 --timings -p1- -o$outfile $infile)
+	fi
+	if [ $? -ne 0 ]; then
+		echo "conversion of $f.dvi failed" >&2
+		state=1
+	else
+		echo "$timings" | while IFS= read -r line; do
+			echo -e "$f\t$line"
+		done
+	fi
+	rm -f $outfile benchmark-$f-*.svg
+done
+exit $state
@@ -0,0 +1,149 @@
+/*************************************************************************
+** geobench.cpp                                                         **
+**                                                                      **
+** This file is part of dvisvgm -- a fast DVI to SVG converter          **
+** Copyright (C) 2005-2024 Martin Gieseking <martin.gieseking@uos.de>   **
+**                                                                      **
+** This program is free software; you can redistribute it and/or        **
+** modify it under the terms of the GNU General Public License as       **
+** published by the Free Software Foundation; either version 3 of       **
+** the License, or (at your option) any later version.                  **
+**                                                                      **
+** This program is distributed in the hope that it will be useful, but  **
+** WITHOUT ANY WARRANTY; without even the implied warranty of           **
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the         **
+** GNU General Public License for more details.                         **
+**                                                                      **
+** You should have received a copy of the GNU General Public License    **
+** along with this program; if not, see <http://www.gnu.org/licenses/>. **
+*************************************************************************/
+
+// Micro-benchmarks for the geometric primitives (Pair, Matrix, Bezier,
+// GraphicsPath) that form the arithmetic substrate of every conversion.
+// Each benchmark runs its workload repeatedly until a minimum measurement
+// time is reached and prints the average time per workload execution in
+// nanoseconds. The numbers recorded on a reference machine are kept in
+// geobench-baseline.txt; rerun this program after changes to the geometry
+// classes or compiler upgrades and compare the results to detect
+// deoptimizations (e.g. inlining regressions).
+
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "Bezier.hpp"
+#include "GraphicsPath.hpp"
+#include "Matrix.hpp"
+#include "Pair.hpp"
+
+using namespace std;
+
+/** Global accumulator the benchmark results are fed into so that the
+ *  compiler can't discard the computations as dead code. */
+static volatile double _sink;
+
+
+/** Executes a benchmark workload repeatedly until a minimum amount of time
+ *  has been measured and prints the average execution time.
+ *  @param[in] name short description of the benchmark
+ *  @param[in] workload function object executing the code to be measured */
+template <typename Fn>
+static void benchmark (const string &name, Fn workload) {
+	using Clock = chrono::steady_clock;
+	const chrono::nanoseconds mintime = chrono::milliseconds(200);
+	uint64_t iterations = 1;
+	for (;;) {
+		auto start = Clock::now();
+		for (uint64_t i=0; i < iterations; i++)
+			workload();
+		chrono::nanoseconds elapsed = Clock::now()-start;
+		if (elapsed >= mintime) {
+			cout << left << setw(28) << name << right
+				<< setw(12) << iterations << " x"
+				<< setw(12) << fixed << setprecision(1)
+				<< double(elapsed.count())/double(iterations) << " ns\n";
+			return;
+		}
+		// estimate the number of iterations required to fill the measurement
+		// interval and add some headroom
+		uint64_t scale = 2;
+		if (elapsed.count() > 0)
+			scale = max(uint64_t(2), uint64_t(mintime.count()/elapsed.count()));
+		iterations *= scale;
+	}
+}
+
+
+/** Creates a closed sample path consisting of a mix of line, Bézier, and
+ *  arc segments as they typically occur in traced glyph outlines. */
+static GraphicsPath<double> create_sample_path (int segments) {
+	GraphicsPath<double> path;
+	path.moveto(0, 0);
+	for (int i=1; i <= segments; i++) {
+		switch (i % 4) {
+			case 0: path.lineto(i, i%7); break;
+			case 1: path.cubicto(i, i+1, i+2, i-1, i+3, i%5); break;
+			case 2: path.quadto(i, i+2, i+1, i%3); break;
+			case 3: path.arcto(5, 3, 30, false, true, GraphicsPath<double>::Point(i, i%2)); break;
+		}
+	}
+	path.closepath();
+	return path;
+}
+
+
+int main () {
+	benchmark("DPair arithmetic", [] {
+		DPair sum;
+		DPair p(1.25, -0.75);
+		for (int i=0; i < 100; i++)
+			sum += p*double(i) - p/double(i+1);
+		_sink = _sink + sum.x()+sum.y()+sum.length();
+	});
+
+	Matrix affine{1.5, 0.25, 10, -0.25, 1.5, 20};
+	benchmark("Matrix product (affine)", [&affine] {
+		Matrix m(1);
+		for (int i=0; i < 100; i++)
+			m.rmultiply(affine);
+		_sink = _sink + m.get(0, 0);
+	});
+
+	Matrix projective{1.5, 0.25, 10, -0.25, 1.5, 20, 0.01, 0.02, 1};
+	benchmark("Matrix product (projective)", [&projective] {
+		Matrix m(1);
+		for (int i=0; i < 100; i++)
+			m.rmultiply(projective);
+		_sink = _sink + m.get(0, 0);
+	});
+
+	benchmark("Matrix-point product", [&affine] {
+		DPair sum;
+		for (int i=0; i < 100; i++)
+			sum += affine * DPair(i, 100-i);
+		_sink = _sink + sum.x()+sum.y();
+	});
+
+	CubicBezier bezier(DPair(0, 0), DPair(10, 10), DPair(20, 10), DPair(30, -5));
+	benchmark("Bezier::approximate", [&bezier] {
+		vector<DPair> points;
+		bezier.approximate(0.01, points);
+		_sink = _sink + double(points.size());
+	});
+
+	GraphicsPath<double> path = create_sample_path(200);
+	benchmark("GraphicsPath::computeBBox", [&path] {
+		BoundingBox bbox = path.computeBBox();
+		_sink = _sink + bbox.width()+bbox.height();
+	});
+
+	benchmark("GraphicsPath::writeSVG", [&path] {
+		ostringstream oss;
+		path.writeSVG(oss, true);
+		_sink = _sink + double(oss.str().length());
+	});
+	return 0;
+}